@@ -0,0 +1,662 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This measures the simulation speed of a set of standard systems on the Reference and CPU platforms,
+ * using a range of thread counts on the CPU platform.  The systems are water boxes of several sizes
+ * with PME, a protein sized chain in implicit solvent (GBSAOBCForce), a Lennard-Jones fluid described
+ * with a CustomNonbondedForce, AMOEBA water, and RPMD water.  The smallest water box is also run with
+ * several different integrators.
+ *
+ * For each combination it reports the number of steps per second, and uses the Context's timing
+ * information to record the time spent in each operation, such as building the neighbor list, computing
+ * PME, and updating positions.  A summary is printed, and the full results are written as JSON so they
+ * can be compared between versions.
+ *
+ * The platforms are loaded as plugins, so the plugin directory must be specified if it is not the
+ * default one.  When running from the build directory, use "--plugins .".
+ *
+ * Usage: BenchmarkSystems [options]
+ *     --plugins dir         the directory to load plugins from
+ *     --platforms a,b       the platforms to benchmark (default Reference,CPU)
+ *     --threads a,b         the thread counts to use on the CPU platform (default powers of 2 up to the number of processors)
+ *     --systems a,b         the systems to benchmark (default all of them)
+ *     --seconds t           the minimum time to spend timing each combination (default 2)
+ *     --output file         the file to write the JSON results to (default benchmark.json)
+ */
+
+#ifdef WIN32
+  #define _USE_MATH_DEFINES // Needed to get M_PI
+#endif
+#include "openmm/BrownianIntegrator.h"
+#include "openmm/Context.h"
+#include "openmm/CustomIntegrator.h"
+#include "openmm/CustomNonbondedForce.h"
+#include "openmm/GBSAOBCForce.h"
+#include "openmm/HarmonicAngleForce.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/LangevinIntegrator.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/PeriodicTorsionForce.h"
+#include "openmm/Platform.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "openmm/internal/hardware.h"
+#include "openmm/internal/timer.h"
+#ifdef OPENMM_BENCHMARK_AMOEBA
+#include "openmm/AmoebaMultipoleForce.h"
+#include "openmm/AmoebaVdwForce.h"
+#endif
+#ifdef OPENMM_BENCHMARK_RPMD
+#include "openmm/RPMDIntegrator.h"
+#endif
+#include "sfmt/SFMT.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * A system to simulate, along with the integrator to simulate it with.
+ */
+struct Benchmark {
+    Benchmark() : system(NULL), numCopies(1) {
+    }
+    string name, integrator;
+    System* system;
+    vector<Vec3> positions;
+    double stepSize;
+    int numCopies;
+};
+
+/**
+ * The results of running one Benchmark on one Platform.
+ */
+struct Result {
+    string benchmark, integrator, platform;
+    int numAtoms, numThreads, steps;
+    double seconds, stepSize;
+    map<string, vector<double> > timing;
+};
+
+vector<string> splitList(const string& list) {
+    vector<string> items;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ','))
+        if (item.size() > 0)
+            items.push_back(item);
+    return items;
+}
+
+/**
+ * Add water molecules on a cubic lattice with random orientations, filling a box with
+ * moleculesPerSide^3 molecules at the density of liquid water.
+ */
+double addWaterLattice(int moleculesPerSide, double bondLength, double angle, System& system, vector<Vec3>& positions) {
+    const double spacing = 0.3104;
+    double boxSize = moleculesPerSide*spacing;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    Vec3 h1(bondLength, 0, 0);
+    Vec3 h2(bondLength*cos(angle), bondLength*sin(angle), 0);
+    for (int i = 0; i < moleculesPerSide; i++)
+        for (int j = 0; j < moleculesPerSide; j++)
+            for (int k = 0; k < moleculesPerSide; k++) {
+                system.addParticle(15.999);
+                system.addParticle(1.008);
+                system.addParticle(1.008);
+
+                // Rotate the molecule by a random rotation, built from a random unit quaternion.
+
+                double q[4], norm = 0;
+                for (int m = 0; m < 4; m++) {
+                    q[m] = genrand_real2(sfmt)-0.5;
+                    norm += q[m]*q[m];
+                }
+                norm = sqrt(norm);
+                double a = q[0]/norm, b = q[1]/norm, c = q[2]/norm, d = q[3]/norm;
+                Vec3 row1(a*a+b*b-c*c-d*d, 2*(b*c-a*d), 2*(b*d+a*c));
+                Vec3 row2(2*(b*c+a*d), a*a-b*b+c*c-d*d, 2*(c*d-a*b));
+                Vec3 row3(2*(b*d-a*c), 2*(c*d+a*b), a*a-b*b-c*c+d*d);
+                Vec3 oxygen((i+0.5)*spacing, (j+0.5)*spacing, (k+0.5)*spacing);
+                positions.push_back(oxygen);
+                positions.push_back(oxygen+Vec3(row1.dot(h1), row2.dot(h1), row3.dot(h1)));
+                positions.push_back(oxygen+Vec3(row1.dot(h2), row2.dot(h2), row3.dot(h2)));
+            }
+    return boxSize;
+}
+
+/**
+ * Create a box of rigid TIP3P water with PME.
+ */
+Benchmark createWaterBox(int moleculesPerSide, const string& integrator) {
+    Benchmark benchmark;
+    stringstream name;
+    name << "water-pme-" << moleculesPerSide*moleculesPerSide*moleculesPerSide;
+    benchmark.name = name.str();
+    benchmark.integrator = integrator;
+    benchmark.stepSize = 0.002;
+    System* system = new System();
+    benchmark.system = system;
+    const double bondLength = 0.09572, angle = 104.52*M_PI/180;
+    addWaterLattice(moleculesPerSide, bondLength, angle, *system, benchmark.positions);
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(0.9);
+    nonbonded->setEwaldErrorTolerance(5e-4);
+    system->addForce(nonbonded);
+    double hhDistance = 2*bondLength*sin(0.5*angle);
+    for (int i = 0; i < system->getNumParticles(); i += 3) {
+        nonbonded->addParticle(-0.834, 0.31507524, 0.635968);
+        nonbonded->addParticle(0.417, 1.0, 0.0);
+        nonbonded->addParticle(0.417, 1.0, 0.0);
+        nonbonded->addException(i, i+1, 0.0, 1.0, 0.0);
+        nonbonded->addException(i, i+2, 0.0, 1.0, 0.0);
+        nonbonded->addException(i+1, i+2, 0.0, 1.0, 0.0);
+        system->addConstraint(i, i+1, bondLength);
+        system->addConstraint(i, i+2, bondLength);
+        system->addConstraint(i+1, i+2, hhDistance);
+    }
+    return benchmark;
+}
+
+/**
+ * Create a protein sized chain of particles in implicit solvent.  The chain follows a serpentine path
+ * through a cubic lattice, so it is compact like a folded protein.  The positions are perturbed slightly
+ * so no angle is exactly linear.
+ */
+Benchmark createImplicitSolventChain(int particlesPerSide) {
+    Benchmark benchmark;
+    stringstream name;
+    name << "gbsa-chain-" << particlesPerSide*particlesPerSide*particlesPerSide;
+    benchmark.name = name.str();
+    benchmark.integrator = "Langevin";
+    benchmark.stepSize = 0.002;
+    System* system = new System();
+    benchmark.system = system;
+    const double spacing = 0.38;
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < particlesPerSide; i++)
+        for (int j = 0; j < particlesPerSide; j++)
+            for (int k = 0; k < particlesPerSide; k++) {
+                int y = (i%2 == 0 ? j : particlesPerSide-1-j);
+                int z = ((i*particlesPerSide+j)%2 == 0 ? k : particlesPerSide-1-k);
+                system->addParticle(12.0);
+                Vec3 offset(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5);
+                benchmark.positions.push_back(Vec3(i*spacing, y*spacing, z*spacing)+offset*0.05);
+            }
+    int numParticles = system->getNumParticles();
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffNonPeriodic);
+    nonbonded->setCutoffDistance(2.0);
+    system->addForce(nonbonded);
+    GBSAOBCForce* gbsa = new GBSAOBCForce();
+    gbsa->setNonbondedMethod(GBSAOBCForce::CutoffNonPeriodic);
+    gbsa->setCutoffDistance(2.0);
+    system->addForce(gbsa);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system->addForce(bonds);
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    system->addForce(angles);
+    PeriodicTorsionForce* torsions = new PeriodicTorsionForce();
+    system->addForce(torsions);
+    vector<pair<int, int> > bondPairs;
+    for (int i = 0; i < numParticles; i++) {
+        double charge = (i%4 == 0 ? 0.3 : (i%4 == 2 ? -0.3 : 0.0));
+        nonbonded->addParticle(charge, 0.34, 0.3);
+        gbsa->addParticle(charge, 0.17, 0.8);
+        if (i > 0) {
+            bonds->addBond(i-1, i, spacing, 50000.0);
+            bondPairs.push_back(make_pair(i-1, i));
+        }
+        if (i > 1) {
+            Vec3 d1 = benchmark.positions[i-2]-benchmark.positions[i-1];
+            Vec3 d2 = benchmark.positions[i]-benchmark.positions[i-1];
+            angles->addAngle(i-2, i-1, i, acos(d1.dot(d2)/sqrt(d1.dot(d1)*d2.dot(d2))), 200.0);
+        }
+        if (i > 2)
+            torsions->addTorsion(i-3, i-2, i-1, i, 3, 0.0, 2.0);
+    }
+    nonbonded->createExceptionsFromBonds(bondPairs, 0.8333, 0.5);
+    return benchmark;
+}
+
+/**
+ * Create a Lennard-Jones fluid whose interaction is defined with a CustomNonbondedForce.
+ */
+Benchmark createCustomNonbondedFluid(int particlesPerSide) {
+    Benchmark benchmark;
+    stringstream name;
+    name << "custom-lj-" << particlesPerSide*particlesPerSide*particlesPerSide;
+    benchmark.name = name.str();
+    benchmark.integrator = "Langevin";
+    benchmark.stepSize = 0.002;
+    System* system = new System();
+    benchmark.system = system;
+    const double spacing = 0.366;
+    double boxSize = particlesPerSide*spacing;
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    CustomNonbondedForce* nonbonded = new CustomNonbondedForce("4*eps*((sig/r)^12-(sig/r)^6); sig=0.5*(sig1+sig2); eps=sqrt(eps1*eps2)");
+    nonbonded->addPerParticleParameter("sig");
+    nonbonded->addPerParticleParameter("eps");
+    nonbonded->setNonbondedMethod(CustomNonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    nonbonded->setUseSwitchingFunction(true);
+    nonbonded->setSwitchingDistance(0.9);
+    system->addForce(nonbonded);
+    vector<double> params(2);
+    for (int i = 0; i < particlesPerSide; i++)
+        for (int j = 0; j < particlesPerSide; j++)
+            for (int k = 0; k < particlesPerSide; k++) {
+                system->addParticle(39.9);
+                params[0] = ((i+j+k)%2 == 0 ? 0.34 : 0.32);
+                params[1] = ((i+j+k)%2 == 0 ? 0.996 : 0.85);
+                nonbonded->addParticle(params);
+                benchmark.positions.push_back(Vec3((i+0.5)*spacing, (j+0.5)*spacing, (k+0.5)*spacing));
+            }
+    return benchmark;
+}
+
+#ifdef OPENMM_BENCHMARK_AMOEBA
+/**
+ * Create a box of AMOEBA water with PME and mutual polarization.
+ */
+Benchmark createAmoebaWaterBox(int moleculesPerSide) {
+    Benchmark benchmark;
+    stringstream name;
+    name << "amoeba-water-" << moleculesPerSide*moleculesPerSide*moleculesPerSide;
+    benchmark.name = name.str();
+    benchmark.integrator = "Langevin";
+    benchmark.stepSize = 0.0005;
+    System* system = new System();
+    benchmark.system = system;
+    const double bondLength = 0.09572, angle = 108.5*M_PI/180;
+    addWaterLattice(moleculesPerSide, bondLength, angle, *system, benchmark.positions);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system->addForce(bonds);
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    system->addForce(angles);
+    AmoebaMultipoleForce* multipoles = new AmoebaMultipoleForce();
+    multipoles->setNonbondedMethod(AmoebaMultipoleForce::PME);
+    multipoles->setPolarizationType(AmoebaMultipoleForce::Mutual);
+    multipoles->setCutoffDistance(0.7);
+    multipoles->setEwaldErrorTolerance(5e-4);
+    multipoles->setMutualInducedTargetEpsilon(1e-5);
+    system->addForce(multipoles);
+    AmoebaVdwForce* vdw = new AmoebaVdwForce();
+    vdw->setNonbondedMethod(AmoebaVdwForce::CutoffPeriodic);
+    vdw->setCutoff(0.9);
+    system->addForce(vdw);
+    vector<double> oxygenDipole(3, 0.0), hydrogenDipole(3, 0.0);
+    vector<double> oxygenQuadrupole(9, 0.0), hydrogenQuadrupole(9, 0.0);
+    oxygenDipole[2] = 7.5561214e-03;
+    oxygenQuadrupole[0] = 3.5403072e-04;
+    oxygenQuadrupole[4] = -3.9025708e-04;
+    oxygenQuadrupole[8] = 3.6226356e-05;
+    hydrogenDipole[0] = -2.0420949e-03;
+    hydrogenDipole[2] = -3.0787530e-03;
+    hydrogenQuadrupole[0] = -3.4284825e-05;
+    hydrogenQuadrupole[2] = -1.8948597e-06;
+    hydrogenQuadrupole[4] = -1.0024088e-04;
+    hydrogenQuadrupole[6] = -1.8948597e-06;
+    hydrogenQuadrupole[8] = 1.3452570e-04;
+    for (int i = 0; i < system->getNumParticles(); i += 3) {
+        bonds->addBond(i, i+1, bondLength, 221584.0);
+        bonds->addBond(i, i+2, bondLength, 221584.0);
+        angles->addAngle(i+1, i, i+2, angle, 142.5);
+        multipoles->addMultipole(-5.1966e-01, oxygenDipole, oxygenQuadrupole, AmoebaMultipoleForce::Bisector, i+1, i+2, -1, 0.39, 3.0698765e-01, 8.37e-04);
+        multipoles->addMultipole(2.5983e-01, hydrogenDipole, hydrogenQuadrupole, AmoebaMultipoleForce::ZThenX, i, i+2, -1, 0.39, 2.8135002e-01, 4.96e-04);
+        multipoles->addMultipole(2.5983e-01, hydrogenDipole, hydrogenQuadrupole, AmoebaMultipoleForce::ZThenX, i, i+1, -1, 0.39, 2.8135002e-01, 4.96e-04);
+        vector<int> molecule, oxygen, hydrogen1, hydrogen2;
+        molecule.push_back(i);
+        molecule.push_back(i+1);
+        molecule.push_back(i+2);
+        oxygen.push_back(i);
+        hydrogen1.push_back(i+1);
+        hydrogen2.push_back(i+2);
+        vector<int> hydrogens(molecule.begin()+1, molecule.end());
+        multipoles->setCovalentMap(i, AmoebaMultipoleForce::Covalent12, hydrogens);
+        multipoles->setCovalentMap(i+1, AmoebaMultipoleForce::Covalent12, oxygen);
+        multipoles->setCovalentMap(i+1, AmoebaMultipoleForce::Covalent13, hydrogen2);
+        multipoles->setCovalentMap(i+2, AmoebaMultipoleForce::Covalent12, oxygen);
+        multipoles->setCovalentMap(i+2, AmoebaMultipoleForce::Covalent13, hydrogen1);
+        for (int j = 0; j < 3; j++)
+            multipoles->setCovalentMap(i+j, AmoebaMultipoleForce::PolarizationCovalent11, molecule);
+        vdw->addParticle(i, 0.3405, 0.46024, 0.0);
+        vdw->addParticle(i, 0.2655, 0.056484, 0.91);
+        vdw->addParticle(i, 0.2655, 0.056484, 0.91);
+        for (int j = 0; j < 3; j++)
+            vdw->setParticleExclusions(i+j, molecule);
+    }
+    return benchmark;
+}
+#endif
+
+#ifdef OPENMM_BENCHMARK_RPMD
+/**
+ * Create a box of flexible water to simulate with ring polymer molecular dynamics.
+ */
+Benchmark createRpmdWaterBox(int moleculesPerSide, int numCopies) {
+    Benchmark benchmark;
+    stringstream name;
+    name << "rpmd-water-" << moleculesPerSide*moleculesPerSide*moleculesPerSide << "x" << numCopies;
+    benchmark.name = name.str();
+    benchmark.integrator = "RPMD";
+    benchmark.stepSize = 0.0005;
+    benchmark.numCopies = numCopies;
+    System* system = new System();
+    benchmark.system = system;
+    const double bondLength = 0.09572, angle = 104.52*M_PI/180;
+    addWaterLattice(moleculesPerSide, bondLength, angle, *system, benchmark.positions);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system->addForce(bonds);
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    system->addForce(angles);
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(0.9);
+    nonbonded->setEwaldErrorTolerance(5e-4);
+    system->addForce(nonbonded);
+    for (int i = 0; i < system->getNumParticles(); i += 3) {
+        bonds->addBond(i, i+1, bondLength, 462750.4);
+        bonds->addBond(i, i+2, bondLength, 462750.4);
+        angles->addAngle(i+1, i, i+2, angle, 836.8);
+        nonbonded->addParticle(-0.834, 0.31507524, 0.635968);
+        nonbonded->addParticle(0.417, 1.0, 0.0);
+        nonbonded->addParticle(0.417, 1.0, 0.0);
+        nonbonded->addException(i, i+1, 0.0, 1.0, 0.0);
+        nonbonded->addException(i, i+2, 0.0, 1.0, 0.0);
+        nonbonded->addException(i+1, i+2, 0.0, 1.0, 0.0);
+    }
+    return benchmark;
+}
+#endif
+
+vector<Benchmark> createBenchmarks() {
+    vector<Benchmark> benchmarks;
+    benchmarks.push_back(createWaterBox(6, "Langevin"));
+    benchmarks.push_back(createWaterBox(12, "Langevin"));
+    benchmarks.push_back(createWaterBox(18, "Langevin"));
+    benchmarks.push_back(createWaterBox(6, "Verlet"));
+    benchmarks.push_back(createWaterBox(6, "Brownian"));
+    benchmarks.push_back(createWaterBox(6, "CustomVelocityVerlet"));
+    benchmarks.push_back(createImplicitSolventChain(13));
+    benchmarks.push_back(createCustomNonbondedFluid(16));
+#ifdef OPENMM_BENCHMARK_AMOEBA
+    benchmarks.push_back(createAmoebaWaterBox(6));
+#endif
+#ifdef OPENMM_BENCHMARK_RPMD
+    benchmarks.push_back(createRpmdWaterBox(6, 8));
+#endif
+    return benchmarks;
+}
+
+Integrator* createIntegrator(const Benchmark& benchmark) {
+    const double temperature = 300.0, friction = 1.0;
+    if (benchmark.integrator == "Langevin")
+        return new LangevinIntegrator(temperature, friction, benchmark.stepSize);
+    if (benchmark.integrator == "Verlet")
+        return new VerletIntegrator(benchmark.stepSize);
+    if (benchmark.integrator == "Brownian")
+        return new BrownianIntegrator(temperature, 100.0, benchmark.stepSize);
+    if (benchmark.integrator == "CustomVelocityVerlet") {
+        CustomIntegrator* integrator = new CustomIntegrator(benchmark.stepSize);
+        integrator->addPerDofVariable("x1", 0);
+        integrator->addUpdateContextState();
+        integrator->addComputePerDof("v", "v+0.5*dt*f/m");
+        integrator->addComputePerDof("x", "x+dt*v");
+        integrator->addComputePerDof("x1", "x");
+        integrator->addConstrainPositions();
+        integrator->addComputePerDof("v", "v+0.5*dt*f/m+(x-x1)/dt");
+        integrator->addConstrainVelocities();
+        return integrator;
+    }
+#ifdef OPENMM_BENCHMARK_RPMD
+    if (benchmark.integrator == "RPMD")
+        return new RPMDIntegrator(benchmark.numCopies, temperature, friction, benchmark.stepSize);
+#endif
+    throw OpenMMException("Unknown integrator: "+benchmark.integrator);
+}
+
+/**
+ * Simulate a Benchmark on a Platform for at least the specified time, and record the results.
+ */
+Result runBenchmark(const Benchmark& benchmark, Platform& platform, int numThreads, double minSeconds) {
+    Integrator* integrator = createIntegrator(benchmark);
+    map<string, string> properties;
+    if (numThreads > 0) {
+        stringstream threads;
+        threads << numThreads;
+        properties["Threads"] = threads.str();
+    }
+    Result result;
+    try {
+        Context context(*benchmark.system, *integrator, platform, properties);
+#ifdef OPENMM_BENCHMARK_RPMD
+        if (benchmark.numCopies > 1) {
+            for (int i = 0; i < benchmark.numCopies; i++)
+                dynamic_cast<RPMDIntegrator*>(integrator)->setPositions(i, benchmark.positions);
+        }
+        else
+#endif
+        {
+            context.setPositions(benchmark.positions);
+            context.setVelocitiesToTemperature(300.0);
+        }
+
+        // Take a few steps before timing, so one time initialization is not included.
+
+        integrator->step(2);
+        context.setTimingEnabled(true);
+        context.resetTiming();
+        int steps = 0;
+        int batch = 1;
+        double start = getCurrentTime(), elapsed = 0.0;
+        while (elapsed < minSeconds) {
+            integrator->step(batch);
+            steps += batch;
+            elapsed = getCurrentTime()-start;
+            batch *= 2;
+        }
+        result.benchmark = benchmark.name;
+        result.integrator = benchmark.integrator;
+        result.platform = platform.getName();
+        result.numAtoms = benchmark.system->getNumParticles();
+        result.numThreads = numThreads;
+        result.steps = steps;
+        result.seconds = elapsed;
+        result.stepSize = benchmark.stepSize;
+        vector<string> operations = context.getTimedOperations();
+        for (int i = 0; i < (int) operations.size(); i++) {
+            int count;
+            double minTime, meanTime, maxTime;
+            context.getTimingStatistics(operations[i], count, minTime, meanTime, maxTime);
+            vector<double>& stats = result.timing[operations[i]];
+            stats.push_back(count);
+            stats.push_back(count*meanTime);
+            stats.push_back(minTime);
+            stats.push_back(meanTime);
+            stats.push_back(maxTime);
+        }
+    }
+    catch (...) {
+        delete integrator;
+        throw;
+    }
+    delete integrator;
+    return result;
+}
+
+string quote(const string& str) {
+    string quoted = "\"";
+    for (int i = 0; i < (int) str.size(); i++) {
+        if (str[i] == '"' || str[i] == '\\')
+            quoted += '\\';
+        quoted += str[i];
+    }
+    return quoted+"\"";
+}
+
+void writeJson(const vector<Result>& results, ostream& out) {
+    out.precision(8);
+    out << "{\n";
+    out << "  \"openmmVersion\": " << quote(Platform::getOpenMMVersion()) << ",\n";
+    out << "  \"processors\": " << getNumProcessors() << ",\n";
+    out << "  \"results\": [";
+    for (int i = 0; i < (int) results.size(); i++) {
+        const Result& r = results[i];
+        double stepsPerSecond = r.steps/r.seconds;
+        out << (i == 0 ? "\n" : ",\n") << "    {\n";
+        out << "      \"system\": " << quote(r.benchmark) << ",\n";
+        out << "      \"integrator\": " << quote(r.integrator) << ",\n";
+        out << "      \"platform\": " << quote(r.platform) << ",\n";
+        out << "      \"threads\": " << r.numThreads << ",\n";
+        out << "      \"atoms\": " << r.numAtoms << ",\n";
+        out << "      \"stepSize\": " << r.stepSize << ",\n";
+        out << "      \"steps\": " << r.steps << ",\n";
+        out << "      \"seconds\": " << r.seconds << ",\n";
+        out << "      \"stepsPerSecond\": " << stepsPerSecond << ",\n";
+        out << "      \"nsPerDay\": " << stepsPerSecond*r.stepSize*86400/1000 << ",\n";
+        out << "      \"timing\": {";
+        for (map<string, vector<double> >::const_iterator iter = r.timing.begin(); iter != r.timing.end(); ++iter) {
+            const vector<double>& stats = iter->second;
+            out << (iter == r.timing.begin() ? "\n" : ",\n");
+            out << "        " << quote(iter->first) << ": {\"count\": " << (int) stats[0] << ", \"total\": " << stats[1];
+            out << ", \"min\": " << stats[2] << ", \"mean\": " << stats[3] << ", \"max\": " << stats[4] << "}";
+        }
+        out << "\n      }\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    string pluginDir = Platform::getDefaultPluginsDirectory();
+    string outputFile = "benchmark.json";
+    vector<string> platformNames, systemNames;
+    vector<int> threadCounts;
+    double minSeconds = 2.0;
+    platformNames.push_back("Reference");
+    platformNames.push_back("CPU");
+    int numProcessors = getNumProcessors();
+    for (int numThreads = 1; numThreads < numProcessors; numThreads *= 2)
+        threadCounts.push_back(numThreads);
+    threadCounts.push_back(numProcessors);
+    for (int i = 1; i < argc; i += 2) {
+        string option = argv[i];
+        if (i+1 == argc) {
+            printf("No value specified for %s\n", option.c_str());
+            return 1;
+        }
+        string value = argv[i+1];
+        if (option == "--plugins")
+            pluginDir = value;
+        else if (option == "--platforms")
+            platformNames = splitList(value);
+        else if (option == "--systems")
+            systemNames = splitList(value);
+        else if (option == "--seconds")
+            minSeconds = atof(value.c_str());
+        else if (option == "--output")
+            outputFile = value;
+        else if (option == "--threads") {
+            vector<string> counts = splitList(value);
+            threadCounts.clear();
+            for (int j = 0; j < (int) counts.size(); j++)
+                threadCounts.push_back(atoi(counts[j].c_str()));
+        }
+        else {
+            printf("Unknown option: %s\n", option.c_str());
+            return 1;
+        }
+    }
+    Platform::loadPluginsFromDirectory(pluginDir);
+    vector<Platform*> platforms;
+    for (int i = 0; i < (int) platformNames.size(); i++) {
+        try {
+            platforms.push_back(&Platform::getPlatformByName(platformNames[i]));
+        }
+        catch (OpenMMException& ex) {
+            printf("Platform %s is not available.  Use --plugins to specify where to load it from.\n", platformNames[i].c_str());
+        }
+    }
+    vector<Benchmark> benchmarks = createBenchmarks();
+    vector<Result> results;
+    printf("%-22s %-22s %-10s %8s %8s %12s %12s\n", "System", "Integrator", "Platform", "Threads", "Atoms", "Steps/sec", "ns/day");
+    for (int i = 0; i < (int) benchmarks.size(); i++) {
+        const Benchmark& benchmark = benchmarks[i];
+        bool selected = systemNames.empty();
+        for (int j = 0; j < (int) systemNames.size(); j++)
+            if (benchmark.name == systemNames[j])
+                selected = true;
+        if (!selected)
+            continue;
+        for (int j = 0; j < (int) platforms.size(); j++) {
+            Platform* platform = platforms[j];
+            bool hasThreads = false;
+            const vector<string>& properties = platform->getPropertyNames();
+            for (int k = 0; k < (int) properties.size(); k++)
+                if (properties[k] == "Threads")
+                    hasThreads = true;
+            vector<int> threads = (hasThreads ? threadCounts : vector<int>(1, 0));
+            for (int k = 0; k < (int) threads.size(); k++) {
+                try {
+                    Result result = runBenchmark(benchmark, *platform, threads[k], minSeconds);
+                    results.push_back(result);
+                    double stepsPerSecond = result.steps/result.seconds;
+                    printf("%-22s %-22s %-10s %8d %8d %12.2f %12.3f\n", benchmark.name.c_str(), benchmark.integrator.c_str(),
+                            platform->getName().c_str(), threads[k], result.numAtoms, stepsPerSecond, stepsPerSecond*benchmark.stepSize*86400/1000);
+                    fflush(stdout);
+                }
+                catch (OpenMMException& ex) {
+                    printf("%-22s %-22s %-10s skipped: %s\n", benchmark.name.c_str(), benchmark.integrator.c_str(), platform->getName().c_str(), ex.what());
+                    break;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < (int) benchmarks.size(); i++)
+        delete benchmarks[i].system;
+    ofstream out(outputFile.c_str());
+    writeJson(results, out);
+    printf("\nResults written to %s\n", outputFile.c_str());
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This measures the latency of dispatching work to a ThreadPool: the time for execute() followed
+ * by waitForThreads() on a task that does no work, and the time for one extra synchronization
+ * point inside a task.  It compares the blocking and spin waiting modes.
+ *
+ * Usage: BenchmarkThreadPool [maxThreads [iterations]]
+ */
+
+#include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/hardware.h"
+#include "openmm/internal/timer.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace OpenMM;
+
+class EmptyTask : public ThreadPool::Task {
+public:
+    void execute(ThreadPool& pool, int threadIndex) {
+    }
+};
+
+class SyncTask : public ThreadPool::Task {
+public:
+    void execute(ThreadPool& pool, int threadIndex) {
+        pool.syncThreads();
+    }
+};
+
+/**
+ * Return the average time in microseconds for one execute()/waitForThreads() cycle.  If sync is true, the
+ * task also contains one synchronization point, which adds an extra waitForThreads()/resumeThreads() pair.
+ */
+double timeDispatch(ThreadPool& pool, int iterations, bool sync) {
+    EmptyTask emptyTask;
+    SyncTask syncTask;
+    ThreadPool::Task& task = (sync ? (ThreadPool::Task&) syncTask : (ThreadPool::Task&) emptyTask);
+    for (int i = 0; i < iterations/10; i++) {
+        pool.execute(task);
+        pool.waitForThreads();
+        if (sync) {
+            pool.resumeThreads();
+            pool.waitForThreads();
+        }
+    }
+    double start = getCurrentTime();
+    for (int i = 0; i < iterations; i++) {
+        pool.execute(task);
+        pool.waitForThreads();
+        if (sync) {
+            pool.resumeThreads();
+            pool.waitForThreads();
+        }
+    }
+    return 1e6*(getCurrentTime()-start)/iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = (argc > 1 ? atoi(argv[1]) : getNumProcessors());
+    int iterations = (argc > 2 ? atoi(argv[2]) : 20000);
+    printf("Latency in microseconds per task (%d iterations, %d processors)\n\n", iterations, getNumProcessors());
+    printf("%8s %14s %14s %14s %14s\n", "threads", "block", "spin", "block+sync", "spin+sync");
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        ThreadPool blockingPool(numThreads, false);
+        double blocking = timeDispatch(blockingPool, iterations, false);
+        double blockingSync = timeDispatch(blockingPool, iterations, true);
+        ThreadPool spinningPool(numThreads, true);
+        double spinning = timeDispatch(spinningPool, iterations, false);
+        double spinningSync = timeDispatch(spinningPool, iterations, true);
+        printf("%8d %14.2f %14.2f %14.2f %14.2f\n", numThreads, blocking, spinning, blockingSync, spinningSync);
+        if (numThreads < maxThreads && 2*numThreads > maxThreads)
+            numThreads = maxThreads/2;
+    }
+    return 0;
+}
@@ -0,0 +1,533 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This measures the speed of individual kernels of the CPU platform, driving them directly with
+ * generated inputs rather than through a Context, so a change in one kernel's performance is not
+ * hidden by the rest of the calculation.  The inputs are a periodic box of particles at the density of
+ * the atoms in liquid water, arranged as a perturbed lattice so no two are unreasonably close.
+ *
+ * Each kernel is run repeatedly for at least the specified time, and the average time is reported
+ * per atom, per interacting pair, per bond, or per evaluation as appropriate.
+ *
+ * Usage: BenchmarkCpuKernels [threads [seconds [atomsPerSide]]]
+ */
+
+#include "AlignedArray.h"
+#include "CpuBondForce.h"
+#include "CpuExclusions.h"
+#include "CpuLangevinDynamics.h"
+#include "CpuNeighborList.h"
+#include "CpuNonbondedForce.h"
+#include "CpuRandom.h"
+#include "CpuSETTLE.h"
+#include "ReferenceAngleBondIxn.h"
+#include "ReferenceSETTLEAlgorithm.h"
+#include "RealVec.h"
+#include "openmm/System.h"
+#include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/hardware.h"
+#include "openmm/internal/timer.h"
+#include "openmm/internal/vectorize.h"
+#include "lepton/CompiledExpression.h"
+#include "lepton/ExpressionProgram.h"
+#include "lepton/ParsedExpression.h"
+#include "lepton/Parser.h"
+#ifdef OPENMM_BENCHMARK_CPU_PME
+#include "CpuPmeKernels.h"
+#include "ReferencePlatform.h"
+#endif
+#include "sfmt/SFMT.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+bool isVec8Supported();
+bool isVec16Supported();
+CpuNonbondedForce* createCpuNonbondedForceVec4();
+CpuNonbondedForce* createCpuNonbondedForceVec8();
+CpuNonbondedForce* createCpuNonbondedForceVec16();
+
+/**
+ * A kernel to be timed.
+ */
+class BenchmarkedKernel {
+public:
+    virtual ~BenchmarkedKernel() {
+    }
+    virtual void run() = 0;
+};
+
+double minSeconds = 1.0;
+
+/**
+ * Run a kernel repeatedly for at least minSeconds, and print the average time per item in nanoseconds.
+ */
+void timeKernel(const string& name, BenchmarkedKernel& kernel, double itemsPerRun, const string& item) {
+    kernel.run();
+    int runs = 0;
+    int batch = 1;
+    double start = getCurrentTime(), elapsed = 0.0;
+    while (elapsed < minSeconds) {
+        for (int i = 0; i < batch; i++)
+            kernel.run();
+        runs += batch;
+        elapsed = getCurrentTime()-start;
+        batch *= 2;
+    }
+    printf("%-44s %12.3f ns/%s\n", name.c_str(), 1e9*elapsed/(runs*itemsPerRun), item.c_str());
+    fflush(stdout);
+}
+
+/**
+ * The generated particles that the kernels operate on.
+ */
+struct Particles {
+    int numAtoms;
+    float boxSize;
+    RealVec boxVectors[3];
+    AlignedArray<float> posq;
+    vector<RealVec> positions;
+    vector<pair<float, float> > params;
+};
+
+void createParticles(int atomsPerSide, Particles& particles) {
+    const double spacing = 0.215;
+    int numAtoms = atomsPerSide*atomsPerSide*atomsPerSide;
+    particles.numAtoms = numAtoms;
+    particles.boxSize = atomsPerSide*spacing;
+    particles.boxVectors[0] = RealVec(particles.boxSize, 0, 0);
+    particles.boxVectors[1] = RealVec(0, particles.boxSize, 0);
+    particles.boxVectors[2] = RealVec(0, 0, particles.boxSize);
+    particles.posq.resize(4*numAtoms);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < atomsPerSide; i++)
+        for (int j = 0; j < atomsPerSide; j++)
+            for (int k = 0; k < atomsPerSide; k++) {
+                RealVec pos((i+0.5)*spacing, (j+0.5)*spacing, (k+0.5)*spacing);
+                pos += RealVec(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5)*(0.4*spacing);
+                int index = particles.positions.size();
+                particles.positions.push_back(pos);
+                particles.posq[4*index] = (float) pos[0];
+                particles.posq[4*index+1] = (float) pos[1];
+                particles.posq[4*index+2] = (float) pos[2];
+                particles.posq[4*index+3] = (index%3 == 0 ? -0.8f : 0.4f);
+                particles.params.push_back(make_pair(0.5f*0.3f, 2.0f*sqrtf(0.6f)));
+            }
+}
+
+/**
+ * Count the pairs of particles that are within the cutoff distance of each other.
+ */
+double countPairs(const Particles& particles, double cutoff) {
+    double count = 0;
+    double cutoff2 = cutoff*cutoff;
+    double boxSize = particles.boxSize;
+    for (int i = 1; i < particles.numAtoms; i++)
+        for (int j = 0; j < i; j++) {
+            RealVec delta = particles.positions[i]-particles.positions[j];
+            for (int k = 0; k < 3; k++)
+                delta[k] -= floor(delta[k]/boxSize+0.5)*boxSize;
+            if (delta.dot(delta) < cutoff2)
+                count++;
+        }
+    return count;
+}
+
+class NeighborListKernel : public BenchmarkedKernel {
+public:
+    NeighborListKernel(CpuNeighborList& neighborList, Particles& particles, CpuExclusions& exclusions, float cutoff, ThreadPool& threads) :
+            neighborList(neighborList), particles(particles), exclusions(exclusions), cutoff(cutoff), threads(threads) {
+    }
+    void run() {
+        neighborList.computeNeighborList(particles.numAtoms, particles.posq, exclusions, particles.boxVectors, true, cutoff, threads);
+    }
+private:
+    CpuNeighborList& neighborList;
+    Particles& particles;
+    CpuExclusions& exclusions;
+    float cutoff;
+    ThreadPool& threads;
+};
+
+class NonbondedKernel : public BenchmarkedKernel {
+public:
+    NonbondedKernel(CpuNonbondedForce& nonbonded, Particles& particles, CpuExclusions& exclusions, ThreadPool& threads) :
+            nonbonded(nonbonded), particles(particles), exclusions(exclusions), threads(threads), threadForce(threads.getNumThreads()) {
+        for (int i = 0; i < (int) threadForce.size(); i++)
+            threadForce[i].resize(4*particles.numAtoms);
+    }
+    void run() {
+        double energy = 0;
+        nonbonded.calculateDirectIxn(particles.numAtoms, &particles.posq[0], particles.positions, particles.params, exclusions, threadForce, &energy, threads);
+    }
+private:
+    CpuNonbondedForce& nonbonded;
+    Particles& particles;
+    CpuExclusions& exclusions;
+    ThreadPool& threads;
+    vector<AlignedArray<float> > threadForce;
+};
+
+void benchmarkNonbonded(const string& name, CpuNonbondedForce* nonbonded, int blockSize, Particles& particles, double cutoff, double numPairs, ThreadPool& threads) {
+    CpuNeighborList neighborList(blockSize);
+    CpuExclusions exclusions(particles.numAtoms);
+    neighborList.computeNeighborList(particles.numAtoms, particles.posq, exclusions, particles.boxVectors, true, (float) cutoff, threads);
+    nonbonded->setUseCutoff((float) cutoff, neighborList, 78.3f);
+    nonbonded->setPeriodic(particles.boxVectors);
+    NonbondedKernel cutoffKernel(*nonbonded, particles, exclusions, threads);
+    timeKernel(name+" cutoff", cutoffKernel, numPairs, "pair");
+    int gridSize[3] = {48, 48, 48};
+    nonbonded->setUsePME(3.12f, gridSize);
+    NonbondedKernel ewaldKernel(*nonbonded, particles, exclusions, threads);
+    timeKernel(name+" Ewald", ewaldKernel, numPairs, "pair");
+    delete nonbonded;
+}
+
+class BondKernel : public BenchmarkedKernel {
+public:
+    BondKernel(CpuBondForce& bondForce, vector<RealVec>& positions, RealOpenMM** params, ReferenceBondIxn& ixn) :
+            bondForce(bondForce), positions(positions), params(params), ixn(ixn), forces(positions.size()) {
+    }
+    void run() {
+        RealOpenMM energy = 0;
+        bondForce.calculateForce(positions, params, forces, &energy, ixn);
+    }
+private:
+    CpuBondForce& bondForce;
+    vector<RealVec>& positions;
+    RealOpenMM** params;
+    ReferenceBondIxn& ixn;
+    vector<RealVec> forces;
+};
+
+void benchmarkAngles(Particles& particles, ThreadPool& threads) {
+    // Treat the lattice as a set of chains running along the x axis, and add an angle for every triple.
+
+    int numAngles = particles.numAtoms-2;
+    int** atoms = new int*[numAngles];
+    RealOpenMM** params = new RealOpenMM*[numAngles];
+    for (int i = 0; i < numAngles; i++) {
+        atoms[i] = new int[3];
+        params[i] = new RealOpenMM[2];
+        for (int j = 0; j < 3; j++)
+            atoms[i][j] = i+j;
+        params[i][0] = 1.9;
+        params[i][1] = 400.0;
+    }
+    CpuBondForce bondForce;
+    bondForce.initialize(particles.numAtoms, numAngles, 3, atoms, threads);
+    ReferenceAngleBondIxn ixn;
+    BondKernel kernel(bondForce, particles.positions, params, ixn);
+    timeKernel("CpuBondForce (HarmonicAngle)", kernel, numAngles, "angle");
+    for (int i = 0; i < numAngles; i++) {
+        delete[] atoms[i];
+        delete[] params[i];
+    }
+    delete[] atoms;
+    delete[] params;
+}
+
+class SettleKernel : public BenchmarkedKernel {
+public:
+    SettleKernel(CpuSETTLE& settle, vector<RealVec>& positions, vector<RealVec>& newPositions, vector<RealOpenMM>& inverseMasses) :
+            settle(settle), positions(positions), newPositions(newPositions), inverseMasses(inverseMasses) {
+    }
+    void run() {
+        vector<RealVec> constrained = newPositions;
+        settle.apply(positions, constrained, inverseMasses, 1e-5);
+    }
+private:
+    CpuSETTLE& settle;
+    vector<RealVec>& positions;
+    vector<RealVec>& newPositions;
+    vector<RealOpenMM>& inverseMasses;
+};
+
+class CopyKernel : public BenchmarkedKernel {
+public:
+    CopyKernel(vector<RealVec>& positions) : positions(positions) {
+    }
+    void run() {
+        vector<RealVec> copy = positions;
+    }
+private:
+    vector<RealVec>& positions;
+};
+
+void benchmarkSettle(int numMolecules, ThreadPool& threads) {
+    // Create rigid water molecules, and displace their atoms randomly to create positions to constrain.
+
+    const double bondLength = 0.09572, angle = 104.52*M_PI/180;
+    System system;
+    vector<int> atom1, atom2, atom3;
+    vector<RealOpenMM> distance1, distance2, masses, inverseMasses;
+    vector<RealVec> positions, newPositions;
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numMolecules; i++) {
+        double mass[] = {15.999, 1.008, 1.008};
+        for (int j = 0; j < 3; j++) {
+            system.addParticle(mass[j]);
+            masses.push_back(mass[j]);
+            inverseMasses.push_back(1.0/mass[j]);
+        }
+        atom1.push_back(3*i);
+        atom2.push_back(3*i+1);
+        atom3.push_back(3*i+2);
+        distance1.push_back(bondLength);
+        distance2.push_back(2*bondLength*sin(0.5*angle));
+        RealVec oxygen(0.31*(i%30), 0.31*((i/30)%30), 0.31*(i/900));
+        positions.push_back(oxygen);
+        positions.push_back(oxygen+RealVec(bondLength, 0, 0));
+        positions.push_back(oxygen+RealVec(bondLength*cos(angle), bondLength*sin(angle), 0));
+        for (int j = 0; j < 3; j++)
+            newPositions.push_back(positions[3*i+j]+RealVec(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5)*0.005);
+    }
+    ReferenceSETTLEAlgorithm referenceSettle(atom1, atom2, atom3, distance1, distance2, masses);
+    CpuSETTLE settle(system, referenceSettle, threads);
+
+    // Each run copies the unconstrained positions before constraining them, so time the copy separately
+    // and subtract it.
+
+    SettleKernel kernel(settle, positions, newPositions, inverseMasses);
+    timeKernel("CpuSETTLE (including copy)", kernel, numMolecules, "molecule");
+    CopyKernel copyKernel(newPositions);
+    timeKernel("CpuSETTLE copy only", copyKernel, numMolecules, "molecule");
+}
+
+class LangevinKernel : public BenchmarkedKernel {
+public:
+    LangevinKernel(CpuLangevinDynamics& dynamics, System& system, Particles& particles) : dynamics(dynamics), system(system),
+            positions(particles.positions), velocities(particles.numAtoms), forces(particles.numAtoms), masses(particles.numAtoms, 16.0) {
+    }
+    void run() {
+        dynamics.update(system, positions, velocities, forces, masses, 1e-5);
+    }
+private:
+    CpuLangevinDynamics& dynamics;
+    System& system;
+    vector<RealVec> positions, velocities, forces;
+    vector<RealOpenMM> masses;
+};
+
+void benchmarkLangevin(Particles& particles, ThreadPool& threads) {
+    System system;
+    for (int i = 0; i < particles.numAtoms; i++)
+        system.addParticle(16.0);
+    CpuRandom random;
+    random.initialize(0, threads.getNumThreads());
+    CpuLangevinDynamics dynamics(particles.numAtoms, 0.002, 1.0, 300.0, threads, random);
+    LangevinKernel kernel(dynamics, system, particles);
+    timeKernel("CpuLangevinDynamics update", kernel, particles.numAtoms, "atom");
+}
+
+#ifdef OPENMM_BENCHMARK_CPU_PME
+class PmeIO : public CalcPmeReciprocalForceKernel::IO {
+public:
+    PmeIO(float* posq) : posq(posq) {
+    }
+    float* getPosq() {
+        return posq;
+    }
+    void setForce(float* force) {
+    }
+private:
+    float* posq;
+};
+
+class PmeKernel : public BenchmarkedKernel {
+public:
+    PmeKernel(CpuCalcPmeReciprocalForceKernel& pme, Particles& particles) : pme(pme), io(&particles.posq[0]) {
+        for (int i = 0; i < 3; i++)
+            boxVectors[i] = Vec3(particles.boxVectors[i][0], particles.boxVectors[i][1], particles.boxVectors[i][2]);
+    }
+    void run() {
+        pme.beginComputation(io, boxVectors, false);
+        pme.finishComputation(io);
+    }
+private:
+    CpuCalcPmeReciprocalForceKernel& pme;
+    PmeIO io;
+    Vec3 boxVectors[3];
+};
+
+void benchmarkPme(Particles& particles, double cutoff, int numThreads) {
+    // Select alpha and the grid size the same way NonbondedForce does for an error tolerance of 5e-4.
+
+    ReferencePlatform platform;
+    CpuCalcPmeReciprocalForceKernel pme(CalcPmeReciprocalForceKernel::Name(), platform);
+    const double tol = 5e-4;
+    double alpha = sqrt(-log(2.0*tol))/cutoff;
+    int gridSize = max((int) ceil(2*alpha*particles.boxSize/(3*pow(tol, 0.2))), 5);
+    pme.initialize(gridSize, gridSize, gridSize, particles.numAtoms, alpha, numThreads);
+    double actualAlpha;
+    int nx, ny, nz;
+    pme.getPMEParameters(actualAlpha, nx, ny, nz);
+    PmeKernel kernel(pme, particles);
+    timeKernel("CPU PME reciprocal space", kernel, particles.numAtoms, "atom");
+
+    // Report the time spent on each phase, measured while running the kernel above.
+
+    vector<double> phaseTimes;
+    pme.getPhaseTimes(phaseTimes);
+    double totalTime = 0;
+    for (int i = 0; i < (int) phaseTimes.size(); i++)
+        totalTime += phaseTimes[i];
+    const char* phaseNames[] = {"spread charges", "forward FFT", "convolution", "backward FFT", "interpolate forces"};
+    if (totalTime > 0)
+        for (int i = 0; i < (int) phaseTimes.size(); i++)
+            printf("    %-40s %11.1f%% of PME time\n", phaseNames[i], 100*phaseTimes[i]/totalTime);
+    printf("    %-40s %8d x %d x %d\n", "grid size", nx, ny, nz);
+}
+#endif
+
+class ParsedExpressionKernel : public BenchmarkedKernel {
+public:
+    ParsedExpressionKernel(const Lepton::ParsedExpression& expression, const map<string, double>& variables) : expression(expression), variables(variables) {
+    }
+    void run() {
+        variables["r"] += 1e-9;
+        expression.evaluate(variables);
+    }
+private:
+    const Lepton::ParsedExpression& expression;
+    map<string, double> variables;
+};
+
+class ProgramKernel : public BenchmarkedKernel {
+public:
+    ProgramKernel(const Lepton::ExpressionProgram& program, const map<string, double>& variables) : program(program), variables(variables) {
+    }
+    void run() {
+        variables["r"] += 1e-9;
+        program.evaluate(variables);
+    }
+private:
+    const Lepton::ExpressionProgram& program;
+    map<string, double> variables;
+};
+
+class CompiledKernel : public BenchmarkedKernel {
+public:
+    CompiledKernel(Lepton::CompiledExpression& expression, const map<string, double>& variables) : expression(expression) {
+        for (map<string, double>::const_iterator iter = variables.begin(); iter != variables.end(); ++iter)
+            expression.getVariableReference(iter->first) = iter->second;
+        r = &expression.getVariableReference("r");
+    }
+    void run() {
+        *r += 1e-9;
+        expression.evaluate();
+    }
+private:
+    Lepton::CompiledExpression& expression;
+    double* r;
+};
+
+void benchmarkLepton() {
+    // This is the same form of expression a CustomNonbondedForce is typically used for.
+
+    Lepton::ParsedExpression expression = Lepton::Parser::parse("4*eps*((sig/r)^12-(sig/r)^6)+138.935456*q1*q2/r; sig=0.5*(sig1+sig2); eps=sqrt(eps1*eps2)").optimize();
+    map<string, double> variables;
+    variables["r"] = 0.5;
+    variables["sig1"] = 0.3;
+    variables["sig2"] = 0.32;
+    variables["eps1"] = 0.6;
+    variables["eps2"] = 0.4;
+    variables["q1"] = -0.8;
+    variables["q2"] = 0.4;
+    ParsedExpressionKernel treeKernel(expression, variables);
+    timeKernel("Lepton ParsedExpression (tree)", treeKernel, 1, "evaluation");
+    Lepton::ExpressionProgram program = expression.createProgram();
+    ProgramKernel programKernel(program, variables);
+    timeKernel("Lepton ExpressionProgram (interpreted)", programKernel, 1, "evaluation");
+    Lepton::CompiledExpression compiled = expression.createCompiledExpression();
+    CompiledKernel compiledKernel(compiled, variables);
+#ifdef LEPTON_USE_JIT
+    timeKernel("Lepton CompiledExpression (JIT)", compiledKernel, 1, "evaluation");
+#else
+    timeKernel("Lepton CompiledExpression (no JIT)", compiledKernel, 1, "evaluation");
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    if (!isVec4Supported()) {
+        printf("This CPU is not supported by the CPU platform.\n");
+        return 0;
+    }
+    int numThreads = (argc > 1 ? atoi(argv[1]) : getNumProcessors());
+    minSeconds = (argc > 2 ? atof(argv[2]) : 1.0);
+    int atomsPerSide = (argc > 3 ? atoi(argv[3]) : 23);
+    const double cutoff = 0.9;
+    ThreadPool threads(numThreads);
+    Particles particles;
+    createParticles(atomsPerSide, particles);
+    double numPairs = countPairs(particles, cutoff);
+    printf("%d atoms, %d threads, %.0f pairs within %g nm\n\n", particles.numAtoms, numThreads, numPairs, cutoff);
+
+    // Neighbor lists.
+
+    CpuExclusions exclusions(particles.numAtoms);
+    CpuNeighborList neighborList4(4);
+    NeighborListKernel neighborKernel4(neighborList4, particles, exclusions, (float) cutoff, threads);
+    timeKernel("CpuNeighborList (block size 4)", neighborKernel4, particles.numAtoms, "atom");
+    CpuNeighborList neighborList8(8);
+    NeighborListKernel neighborKernel8(neighborList8, particles, exclusions, (float) cutoff, threads);
+    timeKernel("CpuNeighborList (block size 8)", neighborKernel8, particles.numAtoms, "atom");
+
+    // Nonbonded interactions with every available vector width.
+
+    benchmarkNonbonded("CpuNonbondedForceVec4", createCpuNonbondedForceVec4(), 4, particles, cutoff, numPairs, threads);
+    if (isVec8Supported())
+        benchmarkNonbonded("CpuNonbondedForceVec8", createCpuNonbondedForceVec8(), 8, particles, cutoff, numPairs, threads);
+    if (isVec16Supported())
+        benchmarkNonbonded("CpuNonbondedForceVec16", createCpuNonbondedForceVec16(), 8, particles, cutoff, numPairs, threads);
+
+    // Other kernels.
+
+#ifdef OPENMM_BENCHMARK_CPU_PME
+    benchmarkPme(particles, cutoff, numThreads);
+#endif
+    benchmarkAngles(particles, threads);
+    benchmarkSettle(particles.numAtoms/3, threads);
+    benchmarkLangevin(particles, threads);
+    benchmarkLepton();
+    return 0;
+}
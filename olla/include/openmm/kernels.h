@@ -56,6 +56,7 @@
 #include "openmm/PeriodicTorsionForce.h"
 #include "openmm/RBTorsionForce.h"
 #include "openmm/NonbondedForce.h"
+#include "openmm/State.h"
 #include "openmm/System.h"
 #include "openmm/VariableLangevinIntegrator.h"
 #include "openmm/VariableVerletIntegrator.h"
@@ -172,6 +173,62 @@ public:
      * @param forces  on exit, this contains the forces
      */
     virtual void getForces(ContextImpl& context, std::vector<Vec3>& forces) = 0;
+    /**
+     * Copy positions, velocities, or forces for a set of particles into a buffer provided by the caller.
+     * The default implementation is built on getPositions(), getVelocities(), and getForces().  Platforms
+     * may override it to avoid creating intermediate copies.
+     *
+     * @param type       the data to retrieve: State::Positions, State::Velocities, or State::Forces
+     * @param buffer     on exit, the three components for the i'th requested particle are stored in
+     *                   buffer[i*stride], buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles.  This must be at least 3.
+     * @param particles  the indices of the particles to retrieve.  If this is empty, all particles are retrieved in order.
+     */
+    virtual void getParticleData(ContextImpl& context, State::DataType type, double* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Copy positions, velocities, or forces for a set of particles into a single precision buffer
+     * provided by the caller.  This is identical to the double precision version, except for the type of the buffer.
+     */
+    virtual void getParticleData(ContextImpl& context, State::DataType type, float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Set the positions or velocities of a set of particles from a buffer provided by the caller.
+     * The default implementation is built on getPositions(), setPositions(), getVelocities(), and
+     * setVelocities().  Platforms may override it to avoid creating intermediate copies.
+     *
+     * @param type       the data to set: State::Positions or State::Velocities
+     * @param buffer     the three components for the i'th particle are stored in buffer[i*stride],
+     *                   buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles.  This must be at least 3.
+     * @param particles  the indices of the particles to set.  If this is empty, all particles are set in order.
+     */
+    virtual void setParticleData(ContextImpl& context, State::DataType type, const double* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Set the positions or velocities of a set of particles from a single precision buffer provided by
+     * the caller.  This is identical to the double precision version, except for the type of the buffer.
+     */
+    virtual void setParticleData(ContextImpl& context, State::DataType type, const float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Compute, for every molecule, the displacement that translates its center into the first periodic box.
+     * The molecules are given in compressed form: the particles in molecule i are
+     * moleculeParticles[moleculeStart[i]] through moleculeParticles[moleculeStart[i+1]-1].
+     * The default implementation is built on getPositions() and getPeriodicBoxVectors().
+     *
+     * @param moleculeStart      the index in moleculeParticles of the first particle in each molecule.  This has
+     *                           one more element than the number of molecules.
+     * @param moleculeParticles  the particles in all molecules, grouped by molecule
+     * @param offsets            on exit, offsets[i] is the displacement to add to every particle in molecule i
+     */
+    virtual void computeMoleculeImages(ContextImpl& context, const std::vector<int>& moleculeStart, const std::vector<int>& moleculeParticles, std::vector<Vec3>& offsets);
+    /**
+     * Get the positions of all particles, with each molecule translated so that its center lies in the
+     * first periodic box.  The molecules are given in the same form as for computeMoleculeImages().
+     * The default implementation is built on getPositions() and computeMoleculeImages().
+     *
+     * @param moleculeStart      the index in moleculeParticles of the first particle in each molecule
+     * @param moleculeParticles  the particles in all molecules, grouped by molecule
+     * @param positions          on exit, this contains the translated particle positions
+     */
+    virtual void getPeriodicPositions(ContextImpl& context, const std::vector<int>& moleculeStart, const std::vector<int>& moleculeParticles, std::vector<Vec3>& positions);
     /**
      * Get the current periodic box vectors.
      *
@@ -200,6 +257,16 @@ public:
      * @param stream    an input stream the checkpoint data should be read from
      */
     virtual void loadCheckpoint(ContextImpl& context, std::istream& stream) = 0;
+    /**
+     * Load the platform data from a checkpoint that was written in the format used before checkpoints
+     * were divided into tagged sections.  The default implementation calls loadCheckpoint().  Platforms
+     * whose checkpoint data has changed since then should override this to read the old data.
+     * 
+     * @param stream    an input stream the checkpoint data should be read from
+     */
+    virtual void loadLegacyCheckpoint(ContextImpl& context, std::istream& stream) {
+        loadCheckpoint(context, stream);
+    }
 };
 
 /**
@@ -1243,8 +1310,9 @@ public:
      * @param gridz        the z size of the PME grid
      * @param numParticles the number of particles in the system
      * @param alpha        the Ewald blending parameter
+     * @param numThreads   the number of threads to use.  If this is 0, the kernel chooses a default.
      */
-    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha) = 0;
+    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, int numThreads) = 0;
     /**
      * Begin computing the force and energy.
      *
@@ -1269,6 +1337,18 @@ public:
      * @param nz      the number of grid points along the Z axis
      */
     virtual void getPMEParameters(double& alpha, int& nx, int& ny, int& nz) const = 0;
+    /**
+     * Get the total time that has been spent on each phase of the calculation since the kernel
+     * was initialized.  This is useful for profiling.  Implementations that do not measure
+     * this leave times empty.
+     * 
+     * @param times   on exit, contains the time in seconds spent on spreading charges, the forward
+     *                FFT, the reciprocal space convolution, the backward FFT, and interpolating
+     *                forces, in that order
+     */
+    virtual void getPhaseTimes(std::vector<double>& times) const {
+        times.clear();
+    }
 };
 
 /**
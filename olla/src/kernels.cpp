@@ -0,0 +1,128 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/kernels.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/MoleculeImages.h"
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+static void getData(UpdateStateDataKernel& kernel, ContextImpl& context, State::DataType type, vector<Vec3>& data) {
+    if (type == State::Positions)
+        kernel.getPositions(context, data);
+    else if (type == State::Velocities)
+        kernel.getVelocities(context, data);
+    else if (type == State::Forces)
+        kernel.getForces(context, data);
+    else
+        throw OpenMMException("getParticleData: Unsupported data type");
+}
+
+template <class T>
+static void copyToBuffer(const vector<Vec3>& data, T* buffer, int stride, const vector<int>& particles) {
+    int numParticles = (particles.size() == 0 ? data.size() : particles.size());
+    for (int i = 0; i < numParticles; i++) {
+        const Vec3& value = data[particles.size() == 0 ? i : particles[i]];
+        T* element = buffer+i*(size_t) stride;
+        element[0] = (T) value[0];
+        element[1] = (T) value[1];
+        element[2] = (T) value[2];
+    }
+}
+
+template <class T>
+static void copyFromBuffer(vector<Vec3>& data, const T* buffer, int stride, const vector<int>& particles) {
+    int numParticles = (particles.size() == 0 ? data.size() : particles.size());
+    for (int i = 0; i < numParticles; i++) {
+        const T* element = buffer+i*(size_t) stride;
+        data[particles.size() == 0 ? i : particles[i]] = Vec3(element[0], element[1], element[2]);
+    }
+}
+
+template <class T>
+static void setData(UpdateStateDataKernel& kernel, ContextImpl& context, State::DataType type, const T* buffer, int stride, const vector<int>& particles) {
+    vector<Vec3> data;
+    if (type == State::Positions) {
+        kernel.getPositions(context, data);
+        copyFromBuffer(data, buffer, stride, particles);
+        kernel.setPositions(context, data);
+    }
+    else if (type == State::Velocities) {
+        kernel.getVelocities(context, data);
+        copyFromBuffer(data, buffer, stride, particles);
+        kernel.setVelocities(context, data);
+    }
+    else
+        throw OpenMMException("setParticleData: Unsupported data type");
+}
+
+void UpdateStateDataKernel::getParticleData(ContextImpl& context, State::DataType type, double* buffer, int stride, const vector<int>& particles) {
+    vector<Vec3> data;
+    getData(*this, context, type, data);
+    copyToBuffer(data, buffer, stride, particles);
+}
+
+void UpdateStateDataKernel::getParticleData(ContextImpl& context, State::DataType type, float* buffer, int stride, const vector<int>& particles) {
+    vector<Vec3> data;
+    getData(*this, context, type, data);
+    copyToBuffer(data, buffer, stride, particles);
+}
+
+void UpdateStateDataKernel::setParticleData(ContextImpl& context, State::DataType type, const double* buffer, int stride, const vector<int>& particles) {
+    setData(*this, context, type, buffer, stride, particles);
+}
+
+void UpdateStateDataKernel::setParticleData(ContextImpl& context, State::DataType type, const float* buffer, int stride, const vector<int>& particles) {
+    setData(*this, context, type, buffer, stride, particles);
+}
+
+void UpdateStateDataKernel::computeMoleculeImages(ContextImpl& context, const vector<int>& moleculeStart, const vector<int>& moleculeParticles, vector<Vec3>& offsets) {
+    vector<Vec3> positions;
+    getPositions(context, positions);
+    Vec3 box[3];
+    getPeriodicBoxVectors(context, box[0], box[1], box[2]);
+    int numMolecules = moleculeStart.size()-1;
+    offsets.resize(numMolecules);
+    if (numMolecules > 0)
+        findMoleculeImages(&positions[0], box, moleculeStart, moleculeParticles, 0, numMolecules, &offsets[0], NULL);
+}
+
+void UpdateStateDataKernel::getPeriodicPositions(ContextImpl& context, const vector<int>& moleculeStart, const vector<int>& moleculeParticles, vector<Vec3>& positions) {
+    vector<Vec3> offsets;
+    computeMoleculeImages(context, moleculeStart, moleculeParticles, offsets);
+    getPositions(context, positions);
+    int numMolecules = moleculeStart.size()-1;
+    for (int i = 0; i < numMolecules; i++)
+        for (int j = moleculeStart[i]; j < moleculeStart[i+1]; j++)
+            positions[moleculeParticles[j]] += offsets[i];
+}
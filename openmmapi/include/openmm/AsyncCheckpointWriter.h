@@ -0,0 +1,114 @@
+#ifndef OPENMM_ASYNCCHECKPOINTWRITER_H_
+#define OPENMM_ASYNCCHECKPOINTWRITER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "Context.h"
+#include <iosfwd>
+#include <string>
+
+namespace OpenMM {
+
+/**
+ * An AsyncCheckpointWriter creates checkpoints of a Context without making the simulation wait
+ * for them to be written.  When you call createCheckpoint(), the checkpoint data is recorded into
+ * an in-memory buffer on the calling thread, so it exactly reflects the state of the Context at
+ * that moment.  Writing the buffer to the output stream is then done on a background thread,
+ * and the method returns immediately.  You can continue integrating while the write is in progress.
+ *
+ * Two buffers are used, so one checkpoint can be recorded while the previous one is still being
+ * written.  If you request a checkpoint while two writes are still pending, createCheckpoint()
+ * blocks until the older one finishes.
+ *
+ * Each call to createCheckpoint() returns an index identifying that checkpoint.  Pass it to
+ * isComplete() or waitForCompletion() to find out when the data has been fully written.  The
+ * output stream must remain valid until then.  Alternatively, call writeCheckpoint() to have
+ * the checkpoint written to a file, which the AsyncCheckpointWriter opens and closes itself.
+ * Deleting the AsyncCheckpointWriter waits for all pending writes to finish.
+ */
+
+class OPENMM_EXPORT AsyncCheckpointWriter {
+public:
+    class WriterData;
+    /**
+     * Create an AsyncCheckpointWriter.
+     *
+     * @param context    the Context to create checkpoints of
+     */
+    AsyncCheckpointWriter(Context& context);
+    ~AsyncCheckpointWriter();
+    /**
+     * Record a checkpoint of the Context's current state and begin writing it to a stream in the
+     * background.  The data written is identical to what Context::createCheckpoint() would produce.
+     *
+     * @param stream    an output stream the checkpoint data should be written to.  It must not be
+     *                  deleted or used for anything else until the write is complete.
+     * @return the index of the checkpoint, which can be passed to isComplete() or waitForCompletion()
+     */
+    int createCheckpoint(std::ostream& stream);
+    /**
+     * Record a checkpoint of the Context's current state and begin writing it to a file in the
+     * background.  The file is opened (replacing any existing file with the same name) before this
+     * method returns, and is closed once the write is complete.
+     *
+     * @param filename  the name of the file to write the checkpoint to
+     * @return the index of the checkpoint, which can be passed to isComplete() or waitForCompletion()
+     */
+    int writeCheckpoint(const std::string& filename);
+    /**
+     * Get whether a checkpoint has been completely written to its output stream.
+     *
+     * @param index     the index of the checkpoint, as returned by createCheckpoint()
+     */
+    bool isComplete(int index) const;
+    /**
+     * Block until a checkpoint has been completely written to its output stream.  If an error
+     * occurred while writing it, an exception is thrown.  Each error is only reported once.
+     *
+     * @param index     the index of the checkpoint, as returned by createCheckpoint()
+     */
+    void waitForCompletion(int index);
+    /**
+     * Block until all checkpoints that have been created so far have been completely written.  If
+     * an error occurred while writing any of them that has not already been reported, an exception
+     * is thrown.
+     */
+    void waitForAll();
+private:
+    int startWrite(std::ostream& stream, std::ostream* ownedStream);
+    Context& context;
+    WriterData* data;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_ASYNCCHECKPOINTWRITER_H_*/
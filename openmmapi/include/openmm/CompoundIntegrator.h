@@ -177,6 +177,14 @@ protected:
      * The implementation calls computeKineticEnergy() on whichever Integrator has been set as current.
      */
     double computeKineticEnergy();
+    /**
+     * Write the index of the current Integrator, followed by the checkpoint data of every Integrator.
+     */
+    void createCheckpoint(std::ostream& stream) const;
+    /**
+     * Load the data written by createCheckpoint().
+     */
+    void loadCheckpoint(std::istream& stream);
 private:
     int currentIntegrator;
     std::vector<Integrator*> integrators;
@@ -157,6 +157,83 @@ public:
      * contains the velocity of the i'th particle.
      */
     void setVelocities(const std::vector<Vec3>& velocities);
+    /**
+     * Copy the positions of particles (measured in nm) directly into a buffer provided by the caller.  This avoids
+     * the intermediate copies made by getState(), which can be significant for large systems.
+     *
+     * @param positions  on exit, the x, y, and z coordinates of the i'th requested particle are stored in
+     *                   positions[i*stride], positions[i*stride+1], and positions[i*stride+2].  The buffer must be
+     *                   large enough to hold all requested particles.
+     * @param stride     the number of elements between the start of consecutive particles.  The default value
+     *                   of 3 corresponds to a packed array.
+     * @param particles  the indices of the particles to retrieve.  If this is empty, all particles are retrieved in order.
+     */
+    void getPositions(double* positions, int stride=3, const std::vector<int>& particles=std::vector<int>()) const;
+    /**
+     * Copy the positions of particles (measured in nm) directly into a single precision buffer provided by the caller.
+     * This is identical to the double precision version, except for the type of the buffer.
+     */
+    void getPositions(float* positions, int stride=3, const std::vector<int>& particles=std::vector<int>()) const;
+    /**
+     * Set the positions of particles (measured in nm) directly from a buffer provided by the caller.  Like
+     * setPositions(const std::vector<Vec3>&), this does not enforce distance constraints.
+     *
+     * @param positions  the x, y, and z coordinates of the i'th particle are stored in positions[i*stride],
+     *                   positions[i*stride+1], and positions[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles.  The default value
+     *                   of 3 corresponds to a packed array.
+     * @param particles  the indices of the particles to set.  If this is empty, all particles in the System are set in order.
+     */
+    void setPositions(const double* positions, int stride=3, const std::vector<int>& particles=std::vector<int>());
+    /**
+     * Set the positions of particles (measured in nm) directly from a single precision buffer provided by the caller.
+     * This is identical to the double precision version, except for the type of the buffer.
+     */
+    void setPositions(const float* positions, int stride=3, const std::vector<int>& particles=std::vector<int>());
+    /**
+     * Copy the velocities of particles (measured in nm/picosecond) directly into a buffer provided by the caller.
+     * The arguments have the same meaning as for getPositions().
+     */
+    void getVelocities(double* velocities, int stride=3, const std::vector<int>& particles=std::vector<int>()) const;
+    /**
+     * Copy the velocities of particles (measured in nm/picosecond) directly into a single precision buffer provided
+     * by the caller.  The arguments have the same meaning as for getPositions().
+     */
+    void getVelocities(float* velocities, int stride=3, const std::vector<int>& particles=std::vector<int>()) const;
+    /**
+     * Set the velocities of particles (measured in nm/picosecond) directly from a buffer provided by the caller.
+     * The arguments have the same meaning as for setPositions().
+     */
+    void setVelocities(const double* velocities, int stride=3, const std::vector<int>& particles=std::vector<int>());
+    /**
+     * Set the velocities of particles (measured in nm/picosecond) directly from a single precision buffer provided
+     * by the caller.  The arguments have the same meaning as for setPositions().
+     */
+    void setVelocities(const float* velocities, int stride=3, const std::vector<int>& particles=std::vector<int>());
+    /**
+     * Compute the forces on particles (measured in kJ/mol/nm) and copy them directly into a buffer provided by the
+     * caller.  The arguments have the same meaning as for getPositions().
+     *
+     * @param groups     a set of bit flags for which force groups to include.  Group i will be included
+     *                   if (groups&(1<<i)) != 0.  The default value includes all groups.
+     */
+    void getForces(double* forces, int stride=3, const std::vector<int>& particles=std::vector<int>(), int groups=0xFFFFFFFF) const;
+    /**
+     * Compute the forces on particles (measured in kJ/mol/nm) and copy them directly into a single precision buffer
+     * provided by the caller.  The arguments have the same meaning as for getPositions().
+     *
+     * @param groups     a set of bit flags for which force groups to include.  Group i will be included
+     *                   if (groups&(1<<i)) != 0.  The default value includes all groups.
+     */
+    void getForces(float* forces, int stride=3, const std::vector<int>& particles=std::vector<int>(), int groups=0xFFFFFFFF) const;
+    /**
+     * Get the periodic image of each molecule that getState() would select when enforcePeriodicBox is true.
+     * This lets a caller wrap coordinates itself without retrieving a second, translated copy of the positions.
+     *
+     * @param offsets  on exit, offsets[i] is the displacement to add to every particle in the i'th molecule
+     *                 returned by getMolecules() to move the molecule's center into the first periodic box
+     */
+    void getMoleculeImages(std::vector<Vec3>& offsets) const;
     /**
      * Set the velocities of all particles in the System to random values chosen from a Boltzmann
      * distribution at a given temperature.
@@ -243,6 +320,11 @@ public:
      * guaranteed to be true, however, and should not be relied on.  For most purposes, however, the
      * internal state should be close enough to be reasonably considered equivalent.
      * 
+     * The checkpoint is divided into tagged sections.  In addition to the Platform's own data, the
+     * Integrator and any Forces that have internal state (such as the step counters and random number
+     * generators of barostats) each write a section of their own.  Sections that are not recognized
+     * are skipped when loading.  Checkpoints written in the older single block format can still be loaded.
+     * 
      * A checkpoint contains data that is highly specific to the Context from which it was created.
      * It depends on the details of the System, the Platform being used, and the hardware and software
      * of the computer it was created on.  If you try to load it on a computer with different hardware,
@@ -262,6 +344,48 @@ public:
      * belong to exactly one molecule.
      */
     const std::vector<std::vector<int> >& getMolecules() const;
+    /**
+     * Set whether the Context should record how much time is spent in each part of a
+     * calculation, such as computing each Force, updating the positions, and applying constraints.
+     * Platforms may record additional, more detailed operations.  Operations can be nested inside
+     * each other (for example, constraints are usually applied as part of the integrator update), so
+     * the times of all operations need not add up to the total time.  A Platform may also compute part of
+     * a Force's work as part of another operation: the CPU Platform, for example, computes bonded forces
+     * such as HarmonicAngleForce together in a single pass, so the times recorded for those Forces are
+     * close to zero.  The time for each Force is recorded under the name "Force <i>i</i> (group <i>g</i>)",
+     * where i is the index of the Force in the System and g is its force group.  Timing is disabled by default.
+     * While it is disabled, the cost of the instrumentation is negligible.
+     * 
+     * @param enabled   true if timing should be recorded
+     */
+    void setTimingEnabled(bool enabled);
+    /**
+     * Get whether the Context is recording timing information.
+     */
+    bool getTimingEnabled() const;
+    /**
+     * Get the names of all operations for which timing information has been recorded.
+     */
+    std::vector<std::string> getTimedOperations() const;
+    /**
+     * Get the timing information that has been recorded for an operation.  If the operation has
+     * never been recorded, the count and all times are 0.
+     * 
+     * @param operation  the name of the operation, as returned by getTimedOperations()
+     * @param[out] count      the number of times the operation was executed
+     * @param[out] minTime    the shortest time it took, measured in seconds
+     * @param[out] meanTime   the average time it took, measured in seconds
+     * @param[out] maxTime    the longest time it took, measured in seconds
+     */
+    void getTimingStatistics(const std::string& operation, int& count, double& minTime, double& meanTime, double& maxTime) const;
+    /**
+     * Get a table summarizing the timing information for all operations that have been recorded.
+     */
+    std::string getTimingReport() const;
+    /**
+     * Discard all timing information that has been recorded so far.
+     */
+    void resetTiming();
 private:
     friend class Force;
     friend class Platform;
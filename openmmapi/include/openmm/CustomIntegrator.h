@@ -548,6 +548,14 @@ protected:
      * Compute the kinetic energy of the system at the current time.
      */
     double computeKineticEnergy();
+    /**
+     * Write the values of all global and per-DOF variables to a checkpoint.
+     */
+    void createCheckpoint(std::ostream& stream) const;
+    /**
+     * Load the values of all global and per-DOF variables from a checkpoint.
+     */
+    void loadCheckpoint(std::istream& stream);
 private:
     class ComputationInfo;
     std::vector<std::string> globalNames;
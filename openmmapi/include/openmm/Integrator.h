@@ -34,6 +34,7 @@
 
 #include "State.h"
 #include "Vec3.h"
+#include <iosfwd>
 #include <map>
 #include <vector>
 #include "internal/windowsExport.h"
@@ -122,6 +123,22 @@ protected:
      * but the kinetic energy should be computed at the current time, not delayed by half a step.
      */
     virtual double computeKineticEnergy() = 0;
+    /**
+     * This is called while writing a checkpoint.  It should write any internal state of the
+     * Integrator that is not stored by the Platform, such as the current step size of a variable
+     * step size integrator.  The default implementation writes nothing.
+     *
+     * @param stream    an output stream the checkpoint data should be written to
+     */
+    virtual void createCheckpoint(std::ostream& stream) const {
+    }
+    /**
+     * This is called while loading a checkpoint.  It should read the data written by createCheckpoint().
+     *
+     * @param stream    an input stream the checkpoint data should be read from
+     */
+    virtual void loadCheckpoint(std::istream& stream) {
+    }
 private:
     double stepSize, constraintTol;
 };
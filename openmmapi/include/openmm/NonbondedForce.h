@@ -280,6 +280,19 @@ public:
      * @return the index of the exception that was added
      */
     int addException(int particle1, int particle2, double chargeProd, double sigma, double epsilon, bool replace = false);
+    /**
+     * Add many exceptions at once.  This is equivalent to calling addException() once for each element of the
+     * vectors, but is much faster when adding a large number of exceptions.
+     *
+     * @param pairs      each element specifies the indices of the two particles involved in one interaction
+     * @param chargeProd the scaled product of the atomic charges for each interaction, measured in units of the proton charge squared
+     * @param sigma      the sigma parameter of the Lennard-Jones potential for each interaction, measured in nm
+     * @param epsilon    the epsilon parameter of the Lennard-Jones potential for each interaction, measured in kJ/mol
+     * @param replace    determines the behavior if there is already an exception for the same two particles.  If true, the existing one is replaced.  If false,
+     *                   an exception is thrown.
+     */
+    void addExceptions(const std::vector<std::pair<int, int> >& pairs, const std::vector<double>& chargeProd, const std::vector<double>& sigma,
+            const std::vector<double>& epsilon, bool replace = false);
     /**
      * Get the force field parameters for an interaction that should be calculated differently from others.
      *
@@ -385,7 +398,6 @@ private:
     double cutoffDistance, switchingDistance, rfDielectric, ewaldErrorTol, alpha;
     bool useSwitchingFunction, useDispersionCorrection;
     int recipForceGroup, nx, ny, nz;
-    void addExclusionsToSet(const std::vector<std::set<int> >& bonded12, std::set<int>& exclusions, int baseParticle, int fromParticle, int currentLevel) const;
     std::vector<ParticleInfo> particles;
     std::vector<ExceptionInfo> exceptions;
     std::map<std::pair<int, int>, int> exceptionMap;
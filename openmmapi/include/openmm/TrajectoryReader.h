@@ -0,0 +1,110 @@
+#ifndef OPENMM_TRAJECTORYREADER_H_
+#define OPENMM_TRAJECTORYREADER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "Vec3.h"
+#include "internal/windowsExport.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * A TrajectoryReader reads frames from a trajectory file created by TrajectoryWriter.  Call readFrame()
+ * to advance to the next frame, then call getTime(), getPeriodicBoxVectors(), and getPositions() to
+ * retrieve its contents.
+ */
+
+class OPENMM_EXPORT TrajectoryReader {
+public:
+    /**
+     * Create a TrajectoryReader.  The file header is read from the stream immediately.
+     *
+     * @param stream    the input stream to read the trajectory from
+     */
+    TrajectoryReader(std::istream& stream);
+    /**
+     * Create a TrajectoryReader that reads from a file.  The file header is read immediately.
+     *
+     * @param filename  the name of the file to read the trajectory from
+     */
+    TrajectoryReader(const std::string& filename);
+    ~TrajectoryReader();
+    /**
+     * Get the number of particles in each frame.
+     */
+    int getNumParticles() const;
+    /**
+     * Get the precision with which coordinates are stored.
+     */
+    double getPrecision() const;
+    /**
+     * Read the next frame from the trajectory.
+     *
+     * @return true if a frame was read, or false if the end of the trajectory was reached
+     */
+    bool readFrame();
+    /**
+     * Get the simulation time (in ps) at which the most recently read frame was recorded.
+     */
+    double getTime() const;
+    /**
+     * Get the periodic box vectors of the most recently read frame.
+     *
+     * @param a      on exit, the first periodic box vector
+     * @param b      on exit, the second periodic box vector
+     * @param c      on exit, the third periodic box vector
+     */
+    void getPeriodicBoxVectors(Vec3& a, Vec3& b, Vec3& c) const;
+    /**
+     * Get the particle positions of the most recently read frame.
+     *
+     * @param positions  on exit, the particle positions
+     */
+    void getPositions(std::vector<Vec3>& positions) const;
+private:
+    void readHeader();
+    void checkFrame() const;
+    std::istream* stream;
+    std::istream* ownedStream;
+    int numParticles;
+    double precision, time;
+    bool hasFrame;
+    Vec3 box[3];
+    std::vector<Vec3> positions;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_TRAJECTORYREADER_H_*/
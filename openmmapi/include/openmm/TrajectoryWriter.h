@@ -0,0 +1,137 @@
+#ifndef OPENMM_TRAJECTORYWRITER_H_
+#define OPENMM_TRAJECTORYWRITER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "Context.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * A TrajectoryWriter records the particle positions from a Context to a compressed trajectory file.
+ * Instead of calling step() on the Integrator, call step() on the TrajectoryWriter.  It advances the
+ * simulation and records a frame every time the number of steps it has taken is a multiple of the
+ * reporting interval.  You also can record a frame at any time by calling writeFrame(), which is how
+ * code that drives the Integrator itself (such as a reporter in the Python application layer) should
+ * use it.
+ *
+ * Recording a frame only copies the positions, time, and periodic box vectors into a ring buffer,
+ * so it has little effect on the speed of the simulation.  The frames are compressed and written to
+ * the output stream on a background thread.  If the ring buffer fills up because frames are being
+ * recorded faster than they can be written, recording blocks until space is available.
+ *
+ * Coordinates are stored in a fixed precision format similar to XTC: they are rounded to the nearest
+ * multiple of 1/precision nm, and the differences between consecutive particles are entropy coded.
+ * The default precision of 1000 stores coordinates to within 0.0005 nm.  Use TrajectoryReader to read
+ * the resulting file.
+ *
+ * If you pass an output stream to the constructor, it must remain valid until the TrajectoryWriter is
+ * deleted.  Alternatively, pass a file name and the TrajectoryWriter opens and closes the file itself.
+ */
+
+class OPENMM_EXPORT TrajectoryWriter {
+public:
+    class WriterData;
+    /**
+     * Create a TrajectoryWriter.  The file header is written to the stream immediately.
+     *
+     * @param context      the Context whose trajectory should be recorded
+     * @param stream       the output stream to write the trajectory to
+     * @param interval     the interval (in time steps) at which to record frames
+     * @param particles    the indices of the particles to record.  If this is empty (the default), all
+     *                     particles are recorded.
+     * @param precision    coordinates are stored to the nearest multiple of 1/precision nm
+     * @param bufferSize   the maximum number of frames that can be waiting to be written
+     */
+    TrajectoryWriter(Context& context, std::ostream& stream, int interval, const std::vector<int>& particles=std::vector<int>(),
+            double precision=1000.0, int bufferSize=8);
+    /**
+     * Create a TrajectoryWriter that writes to a file.  The file is created (replacing any existing file
+     * with the same name) and the header is written to it immediately.
+     *
+     * @param context      the Context whose trajectory should be recorded
+     * @param filename     the name of the file to write the trajectory to
+     * @param interval     the interval (in time steps) at which to record frames
+     * @param particles    the indices of the particles to record.  If this is empty (the default), all
+     *                     particles are recorded.
+     * @param precision    coordinates are stored to the nearest multiple of 1/precision nm
+     * @param bufferSize   the maximum number of frames that can be waiting to be written
+     */
+    TrajectoryWriter(Context& context, const std::string& filename, int interval, const std::vector<int>& particles=std::vector<int>(),
+            double precision=1000.0, int bufferSize=8);
+    /**
+     * Wait for all recorded frames to be written, then delete the TrajectoryWriter.
+     */
+    ~TrajectoryWriter();
+    /**
+     * Get the interval (in time steps) at which frames are recorded.
+     */
+    int getInterval() const;
+    /**
+     * Get the precision with which coordinates are stored.
+     */
+    double getPrecision() const;
+    /**
+     * Get the number of frames that have been recorded.  Some of them may not yet have been written.
+     */
+    int getNumFrames() const;
+    /**
+     * Advance the simulation by calling step() on the Context's Integrator, recording a frame whenever the
+     * total number of steps taken through this method is a multiple of the interval.
+     *
+     * @param steps    the number of time steps to take
+     */
+    void step(int steps);
+    /**
+     * Record a frame with the current state of the Context.
+     */
+    void writeFrame();
+    /**
+     * Block until all frames that have been recorded so far have been written to the output stream.
+     * If an error occurred while writing, an exception is thrown.
+     */
+    void flush();
+private:
+    void initialize(std::ostream& stream, std::ostream* ownedStream, int bufferSize);
+    Context& context;
+    std::vector<int> particles;
+    int interval, currentStep, numFrames;
+    double precision;
+    WriterData* data;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_TRAJECTORYWRITER_H_*/
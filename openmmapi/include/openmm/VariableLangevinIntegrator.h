@@ -164,6 +164,14 @@ protected:
      * Compute the kinetic energy of the system at the current time.
      */
     double computeKineticEnergy();
+    /**
+     * Write the current step size to a checkpoint.
+     */
+    void createCheckpoint(std::ostream& stream) const;
+    /**
+     * Load the step size from a checkpoint.
+     */
+    void loadCheckpoint(std::istream& stream);
 private:
     double temperature, friction, errorTol;
     int randomNumberSeed;
@@ -0,0 +1,73 @@
+#ifndef OPENMM_COMPRESSEDCOORDINATES_H_
+#define OPENMM_COMPRESSEDCOORDINATES_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "windowsExport.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class implements the compressed coordinate encoding used by TrajectoryWriter and TrajectoryReader.
+ *
+ * Each coordinate is first rounded to a fixed precision and converted to an integer, as in the XTC format.
+ * Each particle's coordinates are then replaced by their difference from the previous particle's.  Consecutive
+ * particles are usually close together in space, so most differences are small.  Finally the differences are
+ * entropy coded with Golomb-Rice codes, choosing the best code parameter separately for each block of values.
+ */
+class OPENMM_EXPORT CompressedCoordinates {
+public:
+    /**
+     * Encode a set of coordinates.
+     *
+     * @param coords      the coordinates to encode
+     * @param numValues   the number of values in coords.  This must be a multiple of 3.
+     * @param precision   coordinates are rounded to the nearest multiple of 1/precision
+     * @param output      the encoded data is appended to this
+     */
+    static void encode(const double* coords, int numValues, double precision, std::vector<char>& output);
+    /**
+     * Decode a set of coordinates that was created by encode().
+     *
+     * @param data        the encoded data
+     * @param length      the number of bytes in data
+     * @param numValues   the number of values that were encoded
+     * @param precision   the precision that was passed to encode()
+     * @param coords      on exit, this contains the decoded coordinates
+     */
+    static void decode(const char* data, int length, int numValues, double precision, double* coords);
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_COMPRESSEDCOORDINATES_H_*/
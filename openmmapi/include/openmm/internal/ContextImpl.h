@@ -34,7 +34,9 @@
 
 #include "openmm/Kernel.h"
 #include "openmm/Platform.h"
+#include "openmm/State.h"
 #include "openmm/Vec3.h"
+#include "openmm/internal/TimingRecorder.h"
 #include <iosfwd>
 #include <map>
 #include <vector>
@@ -119,6 +121,37 @@ public:
      * @param forces  on exit, this contains the forces
      */
     void getForces(std::vector<Vec3>& forces);
+    /**
+     * Copy positions, velocities, or forces for a set of particles directly into a buffer provided by the caller.
+     * Forces are copied as they were last computed; this does not compute them.
+     *
+     * @param type       the data to retrieve: State::Positions, State::Velocities, or State::Forces
+     * @param buffer     on exit, the three components for the i'th requested particle are stored in
+     *                   buffer[i*stride], buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles.  This must be at least 3.
+     * @param particles  the indices of the particles to retrieve.  If this is empty, all particles are retrieved in order.
+     */
+    void getParticleData(State::DataType type, double* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Copy positions, velocities, or forces for a set of particles directly into a single precision buffer
+     * provided by the caller.
+     */
+    void getParticleData(State::DataType type, float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Set the positions or velocities of a set of particles directly from a buffer provided by the caller.
+     *
+     * @param type       the data to set: State::Positions or State::Velocities
+     * @param buffer     the three components for the i'th particle are stored in buffer[i*stride],
+     *                   buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles.  This must be at least 3.
+     * @param particles  the indices of the particles to set.  If this is empty, all particles are set in order.
+     */
+    void setParticleData(State::DataType type, const double* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Set the positions or velocities of a set of particles directly from a single precision buffer provided
+     * by the caller.
+     */
+    void setParticleData(State::DataType type, const float* buffer, int stride, const std::vector<int>& particles);
     /**
      * Get the set of all adjustable parameters and their values
      */
@@ -229,6 +262,30 @@ public:
      * same molecule if they are connected by constraints or bonds.
      */
     const std::vector<std::vector<int> >& getMolecules() const;
+    /**
+     * Get the molecules in compressed form.  The particles in molecule i are
+     * getMoleculeParticles()[getMoleculeStart()[i]] through getMoleculeParticles()[getMoleculeStart()[i+1]-1],
+     * listed in the same order as by getMolecules().
+     */
+    const std::vector<int>& getMoleculeStart() const;
+    /**
+     * Get the particles in all molecules, grouped by molecule.  See getMoleculeStart() for details.
+     */
+    const std::vector<int>& getMoleculeParticles() const;
+    /**
+     * Get the displacement that translates each molecule's center into the first periodic box.
+     *
+     * @param offsets  on exit, offsets[i] is the displacement to add to every particle in the i'th molecule
+     *                 returned by getMolecules()
+     */
+    void getMoleculeImages(std::vector<Vec3>& offsets);
+    /**
+     * Get the positions of all particles, with each molecule translated so that its center lies in the first
+     * periodic box.
+     *
+     * @param positions  on exit, this contains the translated particle positions
+     */
+    void getPeriodicPositions(std::vector<Vec3>& positions);
     /**
      * Create a checkpoint recording the current state of the Context.
      * 
@@ -253,19 +310,34 @@ public:
      * you should never call it.  It is exposed here because the same logic is useful to other classes too.
      */
     static std::vector<std::vector<int> > findMolecules(int numParticles, std::vector<std::vector<int> >& particleBonds);
+    /**
+     * Get the TimingRecorder in which the time spent on operations is recorded when timing is enabled.
+     * Integrators and Platforms can use it to record operations of their own.
+     */
+    TimingRecorder& getTimingRecorder() {
+        return timing;
+    }
+    const TimingRecorder& getTimingRecorder() const {
+        return timing;
+    }
 private:
     friend class Context;
+    void validateParticleData(int stride, const std::vector<int>& particles) const;
+    void loadLegacyCheckpoint(std::istream& stream);
     Context& owner;
     const System& system;
     Integrator& integrator;
     std::vector<ForceImpl*> forceImpls;
     std::map<std::string, double> parameters;
     mutable std::vector<std::vector<int> > molecules;
+    mutable std::vector<int> moleculeStart, moleculeParticles;
     bool hasInitializedForces, hasSetPositions, integratorIsDeleted;
     int lastForceGroups;
     Platform* platform;
     Kernel initializeForcesKernel, updateStateDataKernel, applyConstraintsKernel, virtualSitesKernel;
     void* platformData;
+    TimingRecorder timing;
+    std::vector<std::string> forceTimingNames;
 };
 
 } // namespace OpenMM
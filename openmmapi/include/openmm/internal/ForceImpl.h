@@ -33,6 +33,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "openmm/internal/windowsExport.h"
+#include <iosfwd>
 #include <map>
 #include <string>
 #include <utility>
@@ -104,6 +105,24 @@ public:
     virtual std::vector<std::pair<int, int> > getBondedParticles() const {
         return std::vector<std::pair<int, int> >(0);
     }
+    /**
+     * Write any internal state of this ForceImpl that is needed to continue a simulation exactly,
+     * such as the state of a random number generator, to a checkpoint.  The default implementation
+     * writes nothing.
+     *
+     * @param context    the context in which the system is being simulated
+     * @param stream     an output stream the checkpoint data should be written to
+     */
+    virtual void createCheckpoint(ContextImpl& context, std::ostream& stream) {
+    }
+    /**
+     * Load the internal state that was written by createCheckpoint().
+     *
+     * @param context    the context in which the system is being simulated
+     * @param stream     an input stream the checkpoint data should be read from
+     */
+    virtual void loadCheckpoint(ContextImpl& context, std::istream& stream) {
+    }
 };
 
 } // namespace OpenMM
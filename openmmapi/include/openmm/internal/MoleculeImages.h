@@ -0,0 +1,87 @@
+#ifndef OPENMM_MOLECULE_IMAGES_H_
+#define OPENMM_MOLECULE_IMAGES_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/Vec3.h"
+#include <cmath>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * Compute, for each molecule in a range, the displacement that translates its center into the
+ * first periodic box.  This is shared by the implementations of UpdateStateDataKernel on all
+ * platforms that store positions on the host, so every platform wraps molecules identically.
+ * It works with any vector type that provides the arithmetic operators of Vec3.
+ *
+ * @param positions          the positions of all particles
+ * @param boxVectors         the three periodic box vectors, in reduced form
+ * @param moleculeStart      the index in moleculeParticles of the first particle in each molecule.  This has
+ *                           one more element than the number of molecules.
+ * @param moleculeParticles  the particles in all molecules, grouped by molecule
+ * @param firstMolecule      the index of the first molecule to process
+ * @param lastMolecule       the index after the last molecule to process
+ * @param offsets            on exit, offsets[i] is the displacement to add to every particle in molecule i
+ * @param wrappedPositions   if this is not NULL, then on exit it contains the translated position of every
+ *                           particle in the processed molecules
+ */
+template <class VEC>
+void findMoleculeImages(const VEC* positions, const VEC* boxVectors, const std::vector<int>& moleculeStart, const std::vector<int>& moleculeParticles,
+        int firstMolecule, int lastMolecule, Vec3* offsets, Vec3* wrappedPositions) {
+    for (int i = firstMolecule; i < lastMolecule; i++) {
+        // Find the molecule center.
+
+        VEC center;
+        for (int j = moleculeStart[i]; j < moleculeStart[i+1]; j++)
+            center += positions[moleculeParticles[j]];
+        center *= 1.0/(moleculeStart[i+1]-moleculeStart[i]);
+
+        // Find the displacement to move it into the first periodic box.
+
+        VEC diff;
+        diff += boxVectors[2]*floor(center[2]/boxVectors[2][2]);
+        diff += boxVectors[1]*floor((center[1]-diff[1])/boxVectors[1][1]);
+        diff += boxVectors[0]*floor((center[0]-diff[0])/boxVectors[0][0]);
+        offsets[i] = Vec3(-diff[0], -diff[1], -diff[2]);
+        if (wrappedPositions != NULL)
+            for (int j = moleculeStart[i]; j < moleculeStart[i+1]; j++) {
+                int particle = moleculeParticles[j];
+                const VEC& pos = positions[particle];
+                wrappedPositions[particle] = Vec3(pos[0]-diff[0], pos[1]-diff[1], pos[2]-diff[2]);
+            }
+    }
+}
+
+} // namespace OpenMM
+
+#endif // OPENMM_MOLECULE_IMAGES_H_
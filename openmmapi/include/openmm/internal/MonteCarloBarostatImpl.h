@@ -58,9 +58,24 @@ public:
     }
     std::map<std::string, double> getDefaultParameters();
     std::vector<std::string> getKernelNames();
+    void createCheckpoint(ContextImpl& context, std::ostream& stream);
+    void loadCheckpoint(ContextImpl& context, std::istream& stream);
+    /**
+     * Identify the force groups whose energy can change when the coordinates are scaled by
+     * moving each molecule's center while leaving its internal geometry unchanged.  A group
+     * can be omitted only if every Force in it is a bonded force that does not use periodic
+     * boundary conditions and each of whose interactions lies entirely within one molecule.
+     * The energy of such a group is invariant under a barostat move, so it cancels out of the
+     * acceptance criterion.
+     *
+     * @param context    the context containing the barostat
+     * @return a set of flags with bit i set if force group i must be evaluated
+     */
+    static int findScaledEnergyGroups(ContextImpl& context);
 private:
     const MonteCarloBarostat& owner;
-    int step, numAttempted, numAccepted;
+    int step, numAttempted, numAccepted, energyGroups;
+    bool energyGroupsKnown;
     double volumeScale;
     OpenMM_SFMT::SFMT random;
     Kernel kernel;
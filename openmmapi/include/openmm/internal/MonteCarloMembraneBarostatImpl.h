@@ -58,9 +58,12 @@ public:
     }
     std::map<std::string, double> getDefaultParameters();
     std::vector<std::string> getKernelNames();
+    void createCheckpoint(ContextImpl& context, std::ostream& stream);
+    void loadCheckpoint(ContextImpl& context, std::istream& stream);
 private:
     const MonteCarloMembraneBarostat& owner;
-    int step, numAttempted[3], numAccepted[3];
+    int step, numAttempted[3], numAccepted[3], energyGroups;
+    bool energyGroupsKnown;
     double volumeScale[3];
     OpenMM_SFMT::SFMT random;
     Kernel kernel;
@@ -48,6 +48,15 @@ namespace OpenMM {
  * next syncThreads(), and the final call waits until they exit from the Task's execute() method.
  * After calling waitForThreads() to block at a synchronization point, the parent thread should
  * call resumeThreads() to instruct the worker threads to resume.
+ *
+ * By default, threads that are waiting (either workers waiting to be resumed, or the parent thread
+ * inside waitForThreads()) block on a condition variable.  Waking a blocked thread takes several
+ * microseconds, which can be a significant cost when a simulation executes many short tasks for
+ * every time step.  The pool can instead be created in spin waiting mode, in which waiting threads
+ * first spin for a limited time checking whether they can continue, and only block if the wait
+ * lasts longer than that.  This reduces latency, but only helps if every thread has a core to
+ * itself.  If there are more threads than cores, spinning threads take time away from the ones
+ * doing useful work.
  */
 class OPENMM_EXPORT ThreadPool {
 public:
@@ -58,13 +67,26 @@ public:
      *
      * @param numThreads  the number of worker threads to create.  If this is 0 (the default), the
      *                    number of threads is set equal to the number of logical CPU cores available
+     * @param spinWait    if true, waiting threads spin for a limited time before blocking
      */
-    ThreadPool(int numThreads=0);
+    ThreadPool(int numThreads=0, bool spinWait=false);
     ~ThreadPool();
     /**
      * Get the number of worker threads in the pool.
      */
     int getNumThreads() const;
+    /**
+     * Get whether waiting threads spin before blocking.
+     */
+    bool getSpinWait() const;
+    /**
+     * Bind each worker thread to a single logical processor, so the operating system will not migrate
+     * it to a different core.  Worker thread i is bound to processors[i%processors.size()].  This is
+     * currently only supported on Linux, and throws an exception on other operating systems.
+     *
+     * @param processors  the indices of the logical processors to bind the threads to
+     */
+    void setThreadAffinity(const std::vector<int>& processors);
     /**
      * Execute a Task in parallel on the worker threads.
      */
@@ -84,12 +106,14 @@ public:
      */
     void resumeThreads();
 private:
-    bool isDeleted;
+    class SpinState;
+    bool isDeleted, spinWait;
     int numThreads, waitCount;
     std::vector<pthread_t> thread;
     std::vector<ThreadData*> threadData;
     pthread_cond_t startCondition, endCondition;
     pthread_mutex_t lock;
+    SpinState* spinState;
 };
 
 /**
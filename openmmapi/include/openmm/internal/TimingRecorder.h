@@ -0,0 +1,148 @@
+#ifndef OPENMM_TIMING_RECORDER_H_
+#define OPENMM_TIMING_RECORDER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "windowsExport.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * A TimingRecorder accumulates the wall clock time spent in named operations, such as the
+ * calculation of each Force or the integrator's update of positions.  For each operation it
+ * records the number of times it was executed and the total, minimum, and maximum time.
+ *
+ * Timing is disabled by default.  While disabled, a Scope does nothing except check a flag, so
+ * instrumented code pays essentially no cost.  A TimingRecorder is not thread safe: it should
+ * only be used from the thread that invokes the Context's methods.
+ */
+class OPENMM_EXPORT TimingRecorder {
+public:
+    /**
+     * A Scope measures the time from its creation to its destruction and records it under an
+     * operation name.  If timing is disabled when the Scope is created, it records nothing.
+     */
+    class Scope {
+    public:
+        /**
+         * Begin timing an operation.
+         *
+         * @param recorder   the TimingRecorder to record the time in
+         * @param operation  the name of the operation being timed
+         */
+        Scope(TimingRecorder& recorder, const char* operation) : recorder(&recorder), operation(operation) {
+            start = (recorder.isEnabled() ? getCurrentTime() : -1.0);
+        }
+        /**
+         * Begin timing an operation.  This form accepts a NULL recorder, in which case nothing
+         * is recorded.
+         *
+         * @param recorder   the TimingRecorder to record the time in
+         * @param operation  the name of the operation being timed
+         */
+        Scope(TimingRecorder* recorder, const char* operation) : recorder(recorder), operation(operation) {
+            start = (recorder != NULL && recorder->isEnabled() ? getCurrentTime() : -1.0);
+        }
+        ~Scope() {
+            if (start >= 0.0)
+                recorder->record(operation, getCurrentTime()-start);
+        }
+    private:
+        TimingRecorder* recorder;
+        const char* operation;
+        double start;
+    };
+    TimingRecorder();
+    /**
+     * Get whether timing is currently enabled.
+     */
+    bool isEnabled() const {
+        return enabled;
+    }
+    /**
+     * Set whether timing is enabled.  Disabling timing does not discard the statistics that
+     * have already been recorded.
+     */
+    void setEnabled(bool enabled);
+    /**
+     * Record one execution of an operation.
+     *
+     * @param operation  the name of the operation
+     * @param time       the time it took, measured in seconds
+     */
+    void record(const std::string& operation, double time);
+    /**
+     * Get the names of all operations for which times have been recorded, in alphabetical order.
+     */
+    std::vector<std::string> getOperations() const;
+    /**
+     * Get the statistics that have been recorded for an operation.  If nothing has been recorded
+     * for it, count is set to 0 and all times are set to 0.
+     *
+     * @param operation  the name of the operation
+     * @param count      on exit, the number of times the operation was executed
+     * @param minTime    on exit, the shortest time it took, measured in seconds
+     * @param meanTime   on exit, the average time it took, measured in seconds
+     * @param maxTime    on exit, the longest time it took, measured in seconds
+     * @param totalTime  on exit, the total time spent on it, measured in seconds
+     */
+    void getStatistics(const std::string& operation, int& count, double& minTime, double& meanTime, double& maxTime, double& totalTime) const;
+    /**
+     * Create a table summarizing all operations, sorted from the largest total time to the smallest.
+     * Times are reported in milliseconds.
+     */
+    std::string createReport() const;
+    /**
+     * Discard all statistics that have been recorded.
+     */
+    void reset();
+    /**
+     * Get the current wall clock time, measured in seconds.
+     */
+    static double getCurrentTime();
+private:
+    struct Statistics {
+        Statistics() : count(0), total(0.0), min(0.0), max(0.0) {
+        }
+        int count;
+        double total, min, max;
+    };
+    bool enabled;
+    std::map<std::string, Statistics> statistics;
+};
+
+} // namespace OpenMM
+
+#endif // OPENMM_TIMING_RECORDER_H_
@@ -0,0 +1,113 @@
+#ifndef OPENMM_WORK_STEALING_RANGE_H_
+#define OPENMM_WORK_STEALING_RANGE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/ThreadPool.h"
+#include "windowsExport.h"
+
+namespace OpenMM {
+
+/**
+ * A WorkStealingRange hands out the indices [0, size) to the threads of a ThreadPool in chunks.
+ * The range is initially divided into one contiguous slice per thread, and each thread takes
+ * chunks from its own slice.  Once its slice is used up, it moves on to the slices of the other
+ * threads and takes whatever work remains there.
+ *
+ * Compared to having every thread increment a single shared counter, threads rarely compete for
+ * the same cache line, and each thread mostly processes neighboring indices, while the load is
+ * still balanced at the end.
+ *
+ * Call reset() on the master thread before starting a Task, then have each thread call
+ * getNextChunk() in a loop until it returns false.  Because threads only touch a range through
+ * getNextChunk(), a Task can process several independent ranges one after another without
+ * synchronizing the threads between them.
+ */
+class OPENMM_EXPORT WorkStealingRange {
+public:
+    WorkStealingRange();
+    ~WorkStealingRange();
+    /**
+     * Prepare to distribute a new range.  This must not be called while any thread is using the range.
+     *
+     * @param size        the number of indices to distribute
+     * @param grainSize   the number of indices a thread takes at once
+     * @param numThreads  the number of threads that will process the range
+     */
+    void reset(int size, int grainSize, int numThreads);
+    /**
+     * Get the next chunk of indices for a thread to process.
+     *
+     * @param threadIndex  the index of the thread requesting work
+     * @param start        on exit, the first index in the chunk
+     * @param end          on exit, one past the last index in the chunk
+     * @return true if a chunk was assigned, or false if no work remains
+     */
+    bool getNextChunk(int threadIndex, int& start, int& end);
+private:
+    class Slice;
+    char* memory;
+    Slice* slices;
+    int numSlices, maxSlices, grainSize;
+};
+
+/**
+ * This is the interface for the body of a loop executed by parallelFor().
+ */
+class OPENMM_EXPORT ParallelForBody {
+public:
+    virtual ~ParallelForBody() {
+    }
+    /**
+     * Process the indices [start, end).
+     *
+     * @param start        the first index to process
+     * @param end          one past the last index to process
+     * @param threadIndex  the index of the thread invoking this method
+     */
+    virtual void execute(int start, int end, int threadIndex) = 0;
+};
+
+/**
+ * Execute a loop over the indices [0, size) in parallel on the threads of a ThreadPool, distributing
+ * the work with a WorkStealingRange.  This blocks until the loop is complete.
+ *
+ * @param threads    the ThreadPool to execute the loop on
+ * @param size       the number of iterations
+ * @param grainSize  the number of iterations a thread takes at once
+ * @param body       the loop body
+ */
+OPENMM_EXPORT void parallelFor(ThreadPool& threads, int size, int grainSize, ParallelForBody& body);
+
+} // namespace OpenMM
+
+#endif // OPENMM_WORK_STEALING_RANGE_H_
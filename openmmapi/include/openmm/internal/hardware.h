@@ -95,6 +95,7 @@ static int getNumProcessors() {
 #else
 #if !defined(__ANDROID__) && !defined(__PNACL__)
     static void cpuid(int cpuInfo[4], int infoType){
+    // ECX is cleared so that leaves with subleaves (such as 7) report subleaf 0.
     #ifdef __LP64__
         __asm__ __volatile__ (
             "cpuid":
@@ -102,7 +103,7 @@ static int getNumProcessors() {
             "=b" (cpuInfo[1]),
             "=c" (cpuInfo[2]),
             "=d" (cpuInfo[3]) :
-            "a" (infoType)
+            "a" (infoType), "2" (0)
         );
     #else
         __asm__ __volatile__ (
@@ -114,7 +115,7 @@ static int getNumProcessors() {
             "=r" (cpuInfo[1]),
             "=c" (cpuInfo[2]),
             "=d" (cpuInfo[3]) :
-            "a" (infoType)
+            "a" (infoType), "2" (0)
         );
     #endif
     }
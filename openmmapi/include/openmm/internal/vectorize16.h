@@ -0,0 +1,277 @@
+#ifndef OPENMM_VECTORIZE16_H_
+#define OPENMM_VECTORIZE16_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "vectorize8.h"
+#include <immintrin.h>
+
+// This file defines classes and functions to simplify vectorizing code with AVX-512.  Comparisons
+// return a __mmask16 rather than a vector, so masks live in the dedicated mask registers and can be
+// combined with the ordinary bitwise operators.
+
+class ivec16;
+
+/**
+ * A sixteen element vector of floats.
+ */
+class fvec16 {
+public:
+    __m512 val;
+
+    fvec16() {}
+    fvec16(float v) : val(_mm512_set1_ps(v)) {}
+    fvec16(float v1, float v2, float v3, float v4, float v5, float v6, float v7, float v8, float v9, float v10, float v11, float v12, float v13, float v14, float v15, float v16) :
+        val(_mm512_set_ps(v16, v15, v14, v13, v12, v11, v10, v9, v8, v7, v6, v5, v4, v3, v2, v1)) {}
+    fvec16(const fvec8& lower, const fvec8& upper) :
+        val(_mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(lower)), _mm256_castps_pd(upper), 1))) {}
+    fvec16(__m512 v) : val(v) {}
+    fvec16(const float* v) : val(_mm512_loadu_ps(v)) {}
+    operator __m512() const {
+        return val;
+    }
+    fvec8 lowerVec() const {
+        return _mm512_castps512_ps256(val);
+    }
+    fvec8 upperVec() const {
+        return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(val), 1));
+    }
+    void store(float* v) const {
+        _mm512_storeu_ps(v, val);
+    }
+    fvec16 operator+(const fvec16& other) const {
+        return _mm512_add_ps(val, other);
+    }
+    fvec16 operator-(const fvec16& other) const {
+        return _mm512_sub_ps(val, other);
+    }
+    fvec16 operator*(const fvec16& other) const {
+        return _mm512_mul_ps(val, other);
+    }
+    fvec16 operator/(const fvec16& other) const {
+        return _mm512_div_ps(val, other);
+    }
+    void operator+=(const fvec16& other) {
+        val = _mm512_add_ps(val, other);
+    }
+    void operator-=(const fvec16& other) {
+        val = _mm512_sub_ps(val, other);
+    }
+    void operator*=(const fvec16& other) {
+        val = _mm512_mul_ps(val, other);
+    }
+    void operator/=(const fvec16& other) {
+        val = _mm512_div_ps(val, other);
+    }
+    fvec16 operator-() const {
+        return _mm512_sub_ps(_mm512_set1_ps(0.0f), val);
+    }
+    fvec16 operator&(const fvec16& other) const {
+        return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(val), _mm512_castps_si512(other)));
+    }
+    fvec16 operator|(const fvec16& other) const {
+        return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(val), _mm512_castps_si512(other)));
+    }
+    __mmask16 operator==(const fvec16& other) const {
+        return _mm512_cmp_ps_mask(val, other, _CMP_EQ_OQ);
+    }
+    __mmask16 operator!=(const fvec16& other) const {
+        return _mm512_cmp_ps_mask(val, other, _CMP_NEQ_OQ);
+    }
+    __mmask16 operator>(const fvec16& other) const {
+        return _mm512_cmp_ps_mask(val, other, _CMP_GT_OQ);
+    }
+    __mmask16 operator<(const fvec16& other) const {
+        return _mm512_cmp_ps_mask(val, other, _CMP_LT_OQ);
+    }
+    __mmask16 operator>=(const fvec16& other) const {
+        return _mm512_cmp_ps_mask(val, other, _CMP_GE_OQ);
+    }
+    __mmask16 operator<=(const fvec16& other) const {
+        return _mm512_cmp_ps_mask(val, other, _CMP_LE_OQ);
+    }
+    operator ivec16() const;
+};
+
+/**
+ * A sixteen element vector of ints.
+ */
+class ivec16 {
+public:
+    __m512i val;
+
+    ivec16() {}
+    ivec16(int v) : val(_mm512_set1_epi32(v)) {}
+    ivec16(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9, int v10, int v11, int v12, int v13, int v14, int v15, int v16) :
+        val(_mm512_set_epi32(v16, v15, v14, v13, v12, v11, v10, v9, v8, v7, v6, v5, v4, v3, v2, v1)) {}
+    ivec16(__m512i v) : val(v) {}
+    ivec16(const int* v) : val(_mm512_loadu_si512((const __m512i*) v)) {}
+    operator __m512i() const {
+        return val;
+    }
+    ivec8 lowerVec() const {
+        return _mm512_castsi512_si256(val);
+    }
+    ivec8 upperVec() const {
+        return _mm512_extracti64x4_epi64(val, 1);
+    }
+    void store(int* v) const {
+        _mm512_storeu_si512((__m512i*) v, val);
+    }
+    ivec16 operator+(const ivec16& other) const {
+        return _mm512_add_epi32(val, other);
+    }
+    ivec16 operator-(const ivec16& other) const {
+        return _mm512_sub_epi32(val, other);
+    }
+    ivec16 operator&(const ivec16& other) const {
+        return _mm512_and_si512(val, other);
+    }
+    ivec16 operator|(const ivec16& other) const {
+        return _mm512_or_si512(val, other);
+    }
+    operator fvec16() const;
+};
+
+// Conversion operators.
+
+inline fvec16::operator ivec16() const {
+    return _mm512_cvttps_epi32(val);
+}
+
+inline ivec16::operator fvec16() const {
+    return _mm512_cvtepi32_ps(val);
+}
+
+// Functions that operate on fvec16s.
+
+static inline fvec16 floor(const fvec16& v) {
+    return fvec16(_mm512_roundscale_ps(v.val, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+
+static inline fvec16 ceil(const fvec16& v) {
+    return fvec16(_mm512_roundscale_ps(v.val, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+}
+
+static inline fvec16 round(const fvec16& v) {
+    return fvec16(_mm512_roundscale_ps(v.val, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+
+static inline fvec16 min(const fvec16& v1, const fvec16& v2) {
+    return fvec16(_mm512_min_ps(v1.val, v2.val));
+}
+
+static inline fvec16 max(const fvec16& v1, const fvec16& v2) {
+    return fvec16(_mm512_max_ps(v1.val, v2.val));
+}
+
+static inline fvec16 abs(const fvec16& v) {
+    return fvec16(_mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v.val), _mm512_set1_epi32(0x7FFFFFFF))));
+}
+
+static inline fvec16 sqrt(const fvec16& v) {
+    return fvec16(_mm512_sqrt_ps(v.val));
+}
+
+static inline fvec16 rsqrt(const fvec16& v) {
+    // Initial estimate of rsqrt().  This is accurate to 14 bits, so a single iteration of
+    // Newton refinement gives full single precision.
+
+    fvec16 y(_mm512_rsqrt14_ps(v.val));
+    fvec16 x2 = v*0.5f;
+    y *= fvec16(1.5f)-x2*y*y;
+    return y;
+}
+
+/**
+ * Compute v1*v2+v3 with a single rounding.
+ */
+static inline fvec16 fmadd(const fvec16& v1, const fvec16& v2, const fvec16& v3) {
+    return fvec16(_mm512_fmadd_ps(v1.val, v2.val, v3.val));
+}
+
+/**
+ * Compute the sum of all elements.
+ */
+static inline float reduceAdd(const fvec16& v) {
+    return _mm512_reduce_add_ps(v.val);
+}
+
+/**
+ * Compute the sum of the elements selected by a mask.
+ */
+static inline float reduceAdd(const fvec16& v, __mmask16 mask) {
+    return _mm512_mask_reduce_add_ps(mask, v.val);
+}
+
+static inline float dot16(const fvec16& v1, const fvec16& v2) {
+    return reduceAdd(v1*v2);
+}
+
+/**
+ * Load the table elements table[index[0]], table[index[1]], etc. with a hardware gather.
+ */
+static inline fvec16 gather(const float* table, const ivec16& index) {
+    return fvec16(_mm512_i32gather_ps(index.val, table, 4));
+}
+
+// Functions that operate on masks.
+
+static inline bool any(__mmask16 mask) {
+    return (mask != 0);
+}
+
+// Mathematical operators involving a scalar and a vector.
+
+static inline fvec16 operator+(float v1, const fvec16& v2) {
+    return fvec16(v1)+v2;
+}
+
+static inline fvec16 operator-(float v1, const fvec16& v2) {
+    return fvec16(v1)-v2;
+}
+
+static inline fvec16 operator*(float v1, const fvec16& v2) {
+    return fvec16(v1)*v2;
+}
+
+static inline fvec16 operator/(float v1, const fvec16& v2) {
+    return fvec16(v1)/v2;
+}
+
+// Operations for blending fvec16s based on a mask.  Elements whose mask bit is set are taken from v2.
+
+static inline fvec16 blend(const fvec16& v1, const fvec16& v2, __mmask16 mask) {
+    return fvec16(_mm512_mask_blend_ps(mask, v1.val, v2.val));
+}
+
+#endif /*OPENMM_VECTORIZE16_H_*/
@@ -0,0 +1,197 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/AsyncCheckpointWriter.h"
+#include "openmm/OpenMMException.h"
+#include <fstream>
+#include <pthread.h>
+#include <set>
+#include <sstream>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * This holds the buffers and synchronization objects shared between the calling thread and the
+ * background thread.  Checkpoint i is recorded into buffer i%2.  numCreated is the number of
+ * checkpoints that have been recorded, and numWritten is the number that have been written.
+ * If the stream for a buffer was opened by writeCheckpoint(), ownedStream holds it so the
+ * background thread can delete it once the write is done.
+ */
+class AsyncCheckpointWriter::WriterData {
+public:
+    stringstream buffer[2];
+    ostream* stream[2];
+    ostream* ownedStream[2];
+    int numCreated, numWritten;
+    bool isDeleted;
+    set<int> failed;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t condition;
+};
+
+static void* writeThreadBody(void* args) {
+    AsyncCheckpointWriter::WriterData& data = *reinterpret_cast<AsyncCheckpointWriter::WriterData*>(args);
+    pthread_mutex_lock(&data.lock);
+    while (true) {
+        while (data.numWritten == data.numCreated && !data.isDeleted)
+            pthread_cond_wait(&data.condition, &data.lock);
+        if (data.numWritten == data.numCreated)
+            break;
+        
+        // Write the next checkpoint.  The lock is released while doing it, since this is the slow part.
+        
+        int index = data.numWritten;
+        stringstream& buffer = data.buffer[index%2];
+        ostream& stream = *data.stream[index%2];
+        ostream* ownedStream = data.ownedStream[index%2];
+        pthread_mutex_unlock(&data.lock);
+        bool success;
+        try {
+            stream << buffer.rdbuf();
+            stream.flush();
+            success = !stream.fail();
+        }
+        catch (...) {
+            success = false;
+        }
+        if (ownedStream != NULL)
+            delete ownedStream;
+        pthread_mutex_lock(&data.lock);
+        if (!success)
+            data.failed.insert(index);
+        data.numWritten++;
+        pthread_cond_broadcast(&data.condition);
+    }
+    pthread_mutex_unlock(&data.lock);
+    return 0;
+}
+
+AsyncCheckpointWriter::AsyncCheckpointWriter(Context& context) : context(context) {
+    data = new WriterData();
+    data->numCreated = 0;
+    data->numWritten = 0;
+    data->isDeleted = false;
+    pthread_mutex_init(&data->lock, NULL);
+    pthread_cond_init(&data->condition, NULL);
+    pthread_create(&data->thread, NULL, writeThreadBody, data);
+}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() {
+    pthread_mutex_lock(&data->lock);
+    data->isDeleted = true;
+    pthread_cond_broadcast(&data->condition);
+    pthread_mutex_unlock(&data->lock);
+    pthread_join(data->thread, NULL);
+    pthread_mutex_destroy(&data->lock);
+    pthread_cond_destroy(&data->condition);
+    delete data;
+}
+
+int AsyncCheckpointWriter::createCheckpoint(ostream& stream) {
+    return startWrite(stream, NULL);
+}
+
+int AsyncCheckpointWriter::writeCheckpoint(const string& filename) {
+    ofstream* file = new ofstream(filename.c_str(), ios_base::out | ios_base::binary);
+    if (!file->is_open()) {
+        delete file;
+        throw OpenMMException("AsyncCheckpointWriter: Unable to open file "+filename);
+    }
+    return startWrite(*file, file);
+}
+
+int AsyncCheckpointWriter::startWrite(ostream& stream, ostream* ownedStream) {
+    // Wait until a buffer is available.
+
+    pthread_mutex_lock(&data->lock);
+    while (data->numCreated-data->numWritten > 1)
+        pthread_cond_wait(&data->condition, &data->lock);
+    int index = data->numCreated;
+    pthread_mutex_unlock(&data->lock);
+
+    // Record the checkpoint.  The background thread never touches this buffer until numCreated
+    // is incremented below, so no lock is needed.
+
+    stringstream& buffer = data->buffer[index%2];
+    buffer.clear();
+    buffer.str("");
+    try {
+        context.createCheckpoint(buffer);
+    }
+    catch (...) {
+        delete ownedStream;
+        throw;
+    }
+
+    // Hand it off to the background thread.
+
+    pthread_mutex_lock(&data->lock);
+    data->stream[index%2] = &stream;
+    data->ownedStream[index%2] = ownedStream;
+    data->numCreated++;
+    pthread_cond_broadcast(&data->condition);
+    pthread_mutex_unlock(&data->lock);
+    return index;
+}
+
+bool AsyncCheckpointWriter::isComplete(int index) const {
+    pthread_mutex_lock(&data->lock);
+    bool complete = (index < data->numWritten);
+    pthread_mutex_unlock(&data->lock);
+    return complete;
+}
+
+void AsyncCheckpointWriter::waitForCompletion(int index) {
+    pthread_mutex_lock(&data->lock);
+    if (index < 0 || index >= data->numCreated) {
+        pthread_mutex_unlock(&data->lock);
+        throw OpenMMException("AsyncCheckpointWriter: Illegal checkpoint index");
+    }
+    while (index >= data->numWritten)
+        pthread_cond_wait(&data->condition, &data->lock);
+    bool failed = (data->failed.erase(index) > 0);
+    pthread_mutex_unlock(&data->lock);
+    if (failed)
+        throw OpenMMException("AsyncCheckpointWriter: Error writing checkpoint to stream");
+}
+
+void AsyncCheckpointWriter::waitForAll() {
+    pthread_mutex_lock(&data->lock);
+    while (data->numWritten < data->numCreated)
+        pthread_cond_wait(&data->condition, &data->lock);
+    bool failed = !data->failed.empty();
+    data->failed.clear();
+    pthread_mutex_unlock(&data->lock);
+    if (failed)
+        throw OpenMMException("AsyncCheckpointWriter: Error writing checkpoint to stream");
+}
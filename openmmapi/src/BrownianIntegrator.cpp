@@ -77,6 +77,7 @@ void BrownianIntegrator::step(int steps) {
     for (int i = 0; i < steps; ++i) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         kernel.getAs<IntegrateBrownianStepKernel>().execute(*context, *this);
     }
 }
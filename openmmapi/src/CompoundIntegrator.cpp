@@ -35,6 +35,7 @@
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/internal/AssertionUtilities.h"
 #include "openmm/kernels.h"
+#include <iostream>
 #include <string>
 
 using namespace OpenMM;
@@ -123,3 +124,17 @@ vector<string> CompoundIntegrator::getKernelNames() {
 double CompoundIntegrator::computeKineticEnergy() {
     return integrators[currentIntegrator]->computeKineticEnergy();
 }
+
+void CompoundIntegrator::createCheckpoint(std::ostream& stream) const {
+    stream.write((char*) &currentIntegrator, sizeof(int));
+    for (int i = 0; i < integrators.size(); i++)
+        integrators[i]->createCheckpoint(stream);
+}
+
+void CompoundIntegrator::loadCheckpoint(std::istream& stream) {
+    int index;
+    stream.read((char*) &index, sizeof(int));
+    setCurrentIntegrator(index);
+    for (int i = 0; i < integrators.size(); i++)
+        integrators[i]->loadCheckpoint(stream);
+}
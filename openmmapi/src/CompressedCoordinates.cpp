@@ -0,0 +1,206 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/CompressedCoordinates.h"
+#include "openmm/OpenMMException.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+// Values are coded in blocks of this size, each with its own Rice parameter.
+
+static const int BLOCK_SIZE = 32;
+
+// A value whose quotient is at least this large is stored directly instead of in unary.
+
+static const int ESCAPE_QUOTIENT = 16;
+
+static const int MAX_RICE_PARAMETER = 63;
+
+class BitWriter {
+public:
+    BitWriter(vector<char>& output) : output(output), current(0), numBits(0) {
+    }
+    void write(unsigned long long value, int bits) {
+        for (int i = 0; i < bits; i++) {
+            current |= ((value>>i)&1)<<numBits;
+            if (++numBits == 8)
+                flushByte();
+        }
+    }
+    void writeUnary(int count) {
+        for (int i = 0; i < count; i++)
+            write(1, 1);
+        write(0, 1);
+    }
+    void finish() {
+        if (numBits > 0)
+            flushByte();
+    }
+private:
+    void flushByte() {
+        output.push_back((char) current);
+        current = 0;
+        numBits = 0;
+    }
+    vector<char>& output;
+    unsigned int current;
+    int numBits;
+};
+
+class BitReader {
+public:
+    BitReader(const char* data, int length) : data(data), length(length), position(0) {
+    }
+    unsigned long long read(int bits) {
+        unsigned long long value = 0;
+        for (int i = 0; i < bits; i++) {
+            if (position >= 8*(long long) length)
+                throw OpenMMException("CompressedCoordinates: Unexpected end of data");
+            unsigned long long bit = (data[position/8]>>(position%8))&1;
+            value |= bit<<i;
+            position++;
+        }
+        return value;
+    }
+    int readUnary(int maxCount) {
+        int count = 0;
+        while (count < maxCount && read(1) == 1)
+            count++;
+        return count;
+    }
+private:
+    const char* data;
+    int length;
+    long long position;
+};
+
+static int bitLength(unsigned long long value) {
+    int bits = 0;
+    while (value != 0) {
+        bits++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+/**
+ * Compute the number of bits needed to code a value with a given Rice parameter.
+ */
+static int codeLength(unsigned long long value, int k) {
+    unsigned long long quotient = value>>k;
+    if (quotient < ESCAPE_QUOTIENT)
+        return quotient+1+k;
+    return ESCAPE_QUOTIENT+6+bitLength(value);
+}
+
+void CompressedCoordinates::encode(const double* coords, int numValues, double precision, vector<char>& output) {
+    if (numValues%3 != 0)
+        throw OpenMMException("CompressedCoordinates: Number of values must be a multiple of 3");
+
+    // Quantize the coordinates and convert them to differences from the previous particle.  The signed
+    // differences are mapped to unsigned values by interleaving positive and negative ones.
+
+    vector<unsigned long long> values(numValues);
+    long long previous[3] = {0, 0, 0};
+    for (int i = 0; i < numValues; i++) {
+        double scaled = floor(coords[i]*precision+0.5);
+        if (!(fabs(scaled) < 4e18))
+            throw OpenMMException("CompressedCoordinates: Coordinate is too large to encode");
+        long long quantized = (long long) scaled;
+        long long delta = quantized-previous[i%3];
+        previous[i%3] = quantized;
+        values[i] = (delta >= 0 ? 2*(unsigned long long) delta : 2*(unsigned long long) (-(delta+1))+1);
+    }
+
+    // Code each block with the Rice parameter that gives the shortest result.  The optimal parameter
+    // is close to log2 of the mean value, so only a few values around that need to be tried.
+
+    BitWriter writer(output);
+    for (int start = 0; start < numValues; start += BLOCK_SIZE) {
+        int end = min(start+BLOCK_SIZE, numValues);
+        unsigned long long mean = 0;
+        for (int i = start; i < end; i++)
+            mean += values[i]/(end-start);
+        int guess = bitLength(mean);
+        int bestK = 0;
+        long long bestLength = -1;
+        for (int k = max(0, guess-2); k <= min(MAX_RICE_PARAMETER, guess+2); k++) {
+            long long length = 0;
+            for (int i = start; i < end; i++)
+                length += codeLength(values[i], k);
+            if (bestLength == -1 || length < bestLength) {
+                bestK = k;
+                bestLength = length;
+            }
+        }
+        writer.write(bestK, 6);
+        for (int i = start; i < end; i++) {
+            unsigned long long quotient = values[i]>>bestK;
+            if (quotient < ESCAPE_QUOTIENT) {
+                writer.writeUnary((int) quotient);
+                writer.write(values[i], bestK);
+            }
+            else {
+                for (int j = 0; j < ESCAPE_QUOTIENT; j++)
+                    writer.write(1, 1);
+                int bits = bitLength(values[i]);
+                writer.write(bits-1, 6);
+                writer.write(values[i], bits);
+            }
+        }
+    }
+    writer.finish();
+}
+
+void CompressedCoordinates::decode(const char* data, int length, int numValues, double precision, double* coords) {
+    BitReader reader(data, length);
+    long long previous[3] = {0, 0, 0};
+    for (int start = 0; start < numValues; start += BLOCK_SIZE) {
+        int end = min(start+BLOCK_SIZE, numValues);
+        int k = (int) reader.read(6);
+        for (int i = start; i < end; i++) {
+            int quotient = reader.readUnary(ESCAPE_QUOTIENT);
+            unsigned long long value;
+            if (quotient < ESCAPE_QUOTIENT)
+                value = (((unsigned long long) quotient)<<k) | reader.read(k);
+            else {
+                int bits = (int) reader.read(6)+1;
+                value = reader.read(bits);
+            }
+            long long delta = ((value&1) == 0 ? (long long) (value>>1) : -(long long) (value>>1)-1);
+            previous[i%3] += delta;
+            coords[i] = previous[i%3]/precision;
+        }
+    }
+}
@@ -102,30 +102,10 @@ State Context::getState(int types, bool enforcePeriodicBox, int groups) const {
     }
     if (types&State::Positions) {
         vector<Vec3> positions;
-        impl->getPositions(positions);
-        if (enforcePeriodicBox) {
-            const vector<vector<int> >& molecules = impl->getMolecules();
-            for (int i = 0; i < (int) molecules.size(); i++) {
-                // Find the molecule center.
-
-                Vec3 center;
-                for (int j = 0; j < (int) molecules[i].size(); j++)
-                    center += positions[molecules[i][j]];
-                center *= 1.0/molecules[i].size();
-
-                // Find the displacement to move it into the first periodic box.
-                Vec3 diff;
-                diff += periodicBoxSize[2]*floor(center[2]/periodicBoxSize[2][2]);
-                diff += periodicBoxSize[1]*floor((center[1]-diff[1])/periodicBoxSize[1][1]);
-                diff += periodicBoxSize[0]*floor((center[0]-diff[0])/periodicBoxSize[0][0]);
-
-                // Translate all the particles in the molecule.
-                for (int j = 0; j < (int) molecules[i].size(); j++) {
-                    Vec3& pos = positions[molecules[i][j]];
-                    pos -= diff;
-                }
-            }
-        }
+        if (enforcePeriodicBox)
+            impl->getPeriodicPositions(positions);
+        else
+            impl->getPositions(positions);
         builder.setPositions(positions);
     }
     if (types&State::Velocities) {
@@ -166,6 +146,52 @@ void Context::setVelocities(const vector<Vec3>& velocities) {
     impl->setVelocities(velocities);
 }
 
+void Context::getPositions(double* positions, int stride, const vector<int>& particles) const {
+    impl->getParticleData(State::Positions, positions, stride, particles);
+}
+
+void Context::getPositions(float* positions, int stride, const vector<int>& particles) const {
+    impl->getParticleData(State::Positions, positions, stride, particles);
+}
+
+void Context::setPositions(const double* positions, int stride, const vector<int>& particles) {
+    impl->setParticleData(State::Positions, positions, stride, particles);
+}
+
+void Context::setPositions(const float* positions, int stride, const vector<int>& particles) {
+    impl->setParticleData(State::Positions, positions, stride, particles);
+}
+
+void Context::getVelocities(double* velocities, int stride, const vector<int>& particles) const {
+    impl->getParticleData(State::Velocities, velocities, stride, particles);
+}
+
+void Context::getVelocities(float* velocities, int stride, const vector<int>& particles) const {
+    impl->getParticleData(State::Velocities, velocities, stride, particles);
+}
+
+void Context::setVelocities(const double* velocities, int stride, const vector<int>& particles) {
+    impl->setParticleData(State::Velocities, velocities, stride, particles);
+}
+
+void Context::setVelocities(const float* velocities, int stride, const vector<int>& particles) {
+    impl->setParticleData(State::Velocities, velocities, stride, particles);
+}
+
+void Context::getForces(double* forces, int stride, const vector<int>& particles, int groups) const {
+    impl->calcForcesAndEnergy(true, false, groups);
+    impl->getParticleData(State::Forces, forces, stride, particles);
+}
+
+void Context::getForces(float* forces, int stride, const vector<int>& particles, int groups) const {
+    impl->calcForcesAndEnergy(true, false, groups);
+    impl->getParticleData(State::Forces, forces, stride, particles);
+}
+
+void Context::getMoleculeImages(vector<Vec3>& offsets) const {
+    impl->getMoleculeImages(offsets);
+}
+
 void Context::setVelocitiesToTemperature(double temperature, int randomSeed) {
     const System& system = impl->getSystem();
     
@@ -233,9 +259,11 @@ void Context::reinitialize() {
     const System& system = impl->getSystem();
     Integrator& integrator = impl->getIntegrator();
     Platform& platform = impl->getPlatform();
+    bool timingEnabled = impl->getTimingRecorder().isEnabled();
     integrator.cleanup();
     delete impl;
     impl = new ContextImpl(*this, system, integrator, &platform, properties);
+    impl->getTimingRecorder().setEnabled(timingEnabled);
 }
 
 void Context::createCheckpoint(ostream& stream) {
@@ -257,3 +285,28 @@ const ContextImpl& Context::getImpl() const {
 const vector<vector<int> >& Context::getMolecules() const {
     return impl->getMolecules();
 }
+
+void Context::setTimingEnabled(bool enabled) {
+    impl->getTimingRecorder().setEnabled(enabled);
+}
+
+bool Context::getTimingEnabled() const {
+    return impl->getTimingRecorder().isEnabled();
+}
+
+vector<string> Context::getTimedOperations() const {
+    return impl->getTimingRecorder().getOperations();
+}
+
+void Context::getTimingStatistics(const string& operation, int& count, double& minTime, double& meanTime, double& maxTime) const {
+    double totalTime;
+    impl->getTimingRecorder().getStatistics(operation, count, minTime, meanTime, maxTime, totalTime);
+}
+
+string Context::getTimingReport() const {
+    return impl->getTimingRecorder().createReport();
+}
+
+void Context::resetTiming() {
+    impl->getTimingRecorder().reset();
+}
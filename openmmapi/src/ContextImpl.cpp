@@ -44,13 +44,16 @@
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <utility>
 #include <vector>
 #include <string.h>
 
 using namespace OpenMM;
 using namespace std;
-const static char CHECKPOINT_MAGIC_BYTES[] = "OpenMM Binary Checkpoint\n";
+const static char CHECKPOINT_MAGIC_BYTES[] = "OpenMM Tagged Checkpoint\n";
+const static char LEGACY_CHECKPOINT_MAGIC_BYTES[] = "OpenMM Binary Checkpoint\n";
+const static int CHECKPOINT_VERSION = 3;
 
 
 ContextImpl::ContextImpl(Context& owner, const System& system, Integrator& integrator, Platform* platform, const map<string, string>& properties) :
@@ -223,6 +226,41 @@ void ContextImpl::getForces(std::vector<Vec3>& forces) {
     updateStateDataKernel.getAs<UpdateStateDataKernel>().getForces(*this, forces);
 }
 
+void ContextImpl::validateParticleData(int stride, const vector<int>& particles) const {
+    if (stride < 3)
+        throw OpenMMException("The stride for particle data must be at least 3");
+    int numParticles = system.getNumParticles();
+    for (int i = 0; i < (int) particles.size(); i++)
+        if (particles[i] < 0 || particles[i] >= numParticles)
+            throw OpenMMException("Illegal particle index for particle data");
+}
+
+void ContextImpl::getParticleData(State::DataType type, double* buffer, int stride, const vector<int>& particles) {
+    validateParticleData(stride, particles);
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().getParticleData(*this, type, buffer, stride, particles);
+}
+
+void ContextImpl::getParticleData(State::DataType type, float* buffer, int stride, const vector<int>& particles) {
+    validateParticleData(stride, particles);
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().getParticleData(*this, type, buffer, stride, particles);
+}
+
+void ContextImpl::setParticleData(State::DataType type, const double* buffer, int stride, const vector<int>& particles) {
+    validateParticleData(stride, particles);
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().setParticleData(*this, type, buffer, stride, particles);
+    if (type == State::Positions && particles.size() == 0)
+        hasSetPositions = true;
+    integrator.stateChanged(type);
+}
+
+void ContextImpl::setParticleData(State::DataType type, const float* buffer, int stride, const vector<int>& particles) {
+    validateParticleData(stride, particles);
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().setParticleData(*this, type, buffer, stride, particles);
+    if (type == State::Positions && particles.size() == 0)
+        hasSetPositions = true;
+    integrator.stateChanged(type);
+}
+
 const std::map<std::string, double>& ContextImpl::getParameters() const {
     return parameters;
 }
@@ -255,10 +293,12 @@ void ContextImpl::setPeriodicBoxVectors(const Vec3& a, const Vec3& b, const Vec3
 }
 
 void ContextImpl::applyConstraints(double tol) {
+    TimingRecorder::Scope scope(timing, "Apply constraints");
     applyConstraintsKernel.getAs<ApplyConstraintsKernel>().apply(*this, tol);
 }
 
 void ContextImpl::applyVelocityConstraints(double tol) {
+    TimingRecorder::Scope scope(timing, "Apply velocity constraints");
     applyConstraintsKernel.getAs<ApplyConstraintsKernel>().applyToVelocities(*this, tol);
 }
 
@@ -271,13 +311,32 @@ double ContextImpl::calcForcesAndEnergy(bool includeForces, bool includeEnergy,
         throw OpenMMException("Particle positions have not been set");
     lastForceGroups = groups;
     CalcForcesAndEnergyKernel& kernel = initializeForcesKernel.getAs<CalcForcesAndEnergyKernel>();
+    if (timing.isEnabled() && forceTimingNames.size() != forceImpls.size()) {
+        // Build the names under which the time for each Force is recorded.  They identify each Force by its
+        // index in the System and its force group, which do not depend on the compiler.
+
+        forceTimingNames.clear();
+        for (int i = 0; i < (int) forceImpls.size(); ++i) {
+            stringstream name;
+            name << "Force " << i << " (group " << forceImpls[i]->getOwner().getForceGroup() << ")";
+            forceTimingNames.push_back(name.str());
+        }
+    }
     while (true) {
         double energy = 0.0;
-        kernel.beginComputation(*this, includeForces, includeEnergy, groups);
-        for (int i = 0; i < (int) forceImpls.size(); ++i)
+        {
+            TimingRecorder::Scope scope(timing, "Begin force computation");
+            kernel.beginComputation(*this, includeForces, includeEnergy, groups);
+        }
+        for (int i = 0; i < (int) forceImpls.size(); ++i) {
+            TimingRecorder::Scope scope(timing, timing.isEnabled() ? forceTimingNames[i].c_str() : NULL);
             energy += forceImpls[i]->calcForcesAndEnergy(*this, includeForces, includeEnergy, groups);
+        }
         bool valid = true;
-        energy += kernel.finishComputation(*this, includeForces, includeEnergy, groups, valid);
+        {
+            TimingRecorder::Scope scope(timing, "Finish force computation");
+            energy += kernel.finishComputation(*this, includeForces, includeEnergy, groups, valid);
+        }
         if (valid)
             return energy;
     }
@@ -292,6 +351,7 @@ double ContextImpl::calcKineticEnergy() {
 }
 
 void ContextImpl::updateContextState() {
+    TimingRecorder::Scope scope(timing, "Update context state");
     for (int i = 0; i < (int) forceImpls.size(); ++i)
         forceImpls[i]->updateContextState(*this);
 }
@@ -358,6 +418,32 @@ const vector<vector<int> >& ContextImpl::getMolecules() const {
     return molecules;
 }
 
+const vector<int>& ContextImpl::getMoleculeStart() const {
+    if (moleculeStart.size() == 0) {
+        const vector<vector<int> >& mols = getMolecules();
+        moleculeParticles.reserve(system.getNumParticles());
+        moleculeStart.push_back(0);
+        for (int i = 0; i < (int) mols.size(); i++) {
+            moleculeParticles.insert(moleculeParticles.end(), mols[i].begin(), mols[i].end());
+            moleculeStart.push_back(moleculeParticles.size());
+        }
+    }
+    return moleculeStart;
+}
+
+const vector<int>& ContextImpl::getMoleculeParticles() const {
+    getMoleculeStart();
+    return moleculeParticles;
+}
+
+void ContextImpl::getMoleculeImages(vector<Vec3>& offsets) {
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().computeMoleculeImages(*this, getMoleculeStart(), getMoleculeParticles(), offsets);
+}
+
+void ContextImpl::getPeriodicPositions(vector<Vec3>& positions) {
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().getPeriodicPositions(*this, getMoleculeStart(), getMoleculeParticles(), positions);
+}
+
 vector<vector<int> > ContextImpl::findMolecules(int numParticles, vector<vector<int> >& particleBonds) {
     // This is essentially a recursive algorithm, but it is reformulated as a loop to avoid
     // stack overflows.  It selects a particle, marks it as a new molecule, then recursively
@@ -411,23 +497,62 @@ static void writeString(ostream& stream, string str) {
 static string readString(istream& stream) {
     int length;
     stream.read((char*) &length, sizeof(int));
+    if (!stream || length < 0 || length > 100000)
+        throw OpenMMException("loadCheckpoint: Checkpoint is corrupt");
     string str(length, ' ');
     stream.read((char*) &str[0], length);
     return str;
 }
 
+/**
+ * Write one section of a checkpoint: a tag identifying it, followed by the length of its data and the data itself.
+ */
+static void writeSection(ostream& stream, const string& tag, const string& data) {
+    writeString(stream, tag);
+    long long length = data.size();
+    stream.write((char*) &length, sizeof(long long));
+    stream.write(data.c_str(), length);
+}
+
 void ContextImpl::createCheckpoint(ostream& stream) {
     stream.write(CHECKPOINT_MAGIC_BYTES, sizeof(CHECKPOINT_MAGIC_BYTES)/sizeof(CHECKPOINT_MAGIC_BYTES[0]));
-    writeString(stream, getPlatform().getName());
+    int version = CHECKPOINT_VERSION;
+    stream.write((char*) &version, sizeof(int));
+
+    // The checkpoint is a sequence of tagged sections, each written by a different component.  The
+    // "context" section always comes first, since it is needed to validate everything after it.
+
+    stringstream context(ios_base::out | ios_base::binary);
+    writeString(context, getPlatform().getName());
     int numParticles = getSystem().getNumParticles();
-    stream.write((char*) &numParticles, sizeof(int));
+    context.write((char*) &numParticles, sizeof(int));
     int numParameters = parameters.size();
-    stream.write((char*) &numParameters, sizeof(int));
+    context.write((char*) &numParameters, sizeof(int));
     for (map<string, double>::const_iterator iter = parameters.begin(); iter != parameters.end(); ++iter) {
-        writeString(stream, iter->first);
-        stream.write((char*) &iter->second, sizeof(double));
+        writeString(context, iter->first);
+        context.write((char*) &iter->second, sizeof(double));
     }
-    updateStateDataKernel.getAs<UpdateStateDataKernel>().createCheckpoint(*this, stream);
+    writeSection(stream, "context", context.str());
+    stringstream platformState(ios_base::out | ios_base::binary);
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().createCheckpoint(*this, platformState);
+    writeSection(stream, "platform", platformState.str());
+
+    // The integrator and forces only get sections if they have internal state to record.
+
+    stringstream integratorState(ios_base::out | ios_base::binary);
+    integrator.createCheckpoint(integratorState);
+    if (integratorState.str().size() > 0)
+        writeSection(stream, "integrator", integratorState.str());
+    for (int i = 0; i < (int) forceImpls.size(); i++) {
+        stringstream forceState(ios_base::out | ios_base::binary);
+        forceImpls[i]->createCheckpoint(*this, forceState);
+        if (forceState.str().size() > 0) {
+            stringstream tag;
+            tag << "force:" << i;
+            writeSection(stream, tag.str(), forceState.str());
+        }
+    }
+    writeSection(stream, "end", "");
     stream.flush();
 }
 
@@ -435,9 +560,80 @@ void ContextImpl::loadCheckpoint(istream& stream) {
     static const int magiclength = sizeof(CHECKPOINT_MAGIC_BYTES)/sizeof(CHECKPOINT_MAGIC_BYTES[0]);
     char magicbytes[magiclength];
     stream.read(magicbytes, magiclength);
+    if (memcmp(magicbytes, LEGACY_CHECKPOINT_MAGIC_BYTES, magiclength) == 0) {
+        loadLegacyCheckpoint(stream);
+        return;
+    }
     if (memcmp(magicbytes, CHECKPOINT_MAGIC_BYTES, magiclength) != 0)
         throw OpenMMException("loadCheckpoint: Checkpoint header was not correct");
+    int version;
+    stream.read((char*) &version, sizeof(int));
+    if (version != CHECKPOINT_VERSION)
+        throw OpenMMException("loadCheckpoint: Unsupported checkpoint version");
+
+    // Process the sections.  Sections that are not recognized are skipped without being read into memory,
+    // so a checkpoint can contain data for components that are not present in this Context.
+
+    bool foundContext = false;
+    while (true) {
+        string tag = readString(stream);
+        long long length;
+        stream.read((char*) &length, sizeof(long long));
+        if (!stream || length < 0)
+            throw OpenMMException("loadCheckpoint: Checkpoint is corrupt");
+        if (tag == "end")
+            break;
+        int forceIndex = -1;
+        if (tag.compare(0, 6, "force:") == 0) {
+            forceIndex = atoi(tag.c_str()+6);
+            if (forceIndex < 0 || forceIndex >= (int) forceImpls.size())
+                throw OpenMMException("loadCheckpoint: Checkpoint contains data for a Force that does not exist");
+        }
+        else if (tag != "context" && tag != "platform" && tag != "integrator") {
+            stream.ignore(length);
+            continue;
+        }
+        if (tag != "context" && !foundContext)
+            throw OpenMMException("loadCheckpoint: Checkpoint does not begin with a context section");
+        string data(length, ' ');
+        if (length > 0)
+            stream.read(&data[0], length);
+        if (!stream)
+            throw OpenMMException("loadCheckpoint: Unexpected end of checkpoint");
+        stringstream section(data, ios_base::in | ios_base::binary);
+        if (tag == "context") {
+            string platformName = readString(section);
+            if (platformName != getPlatform().getName())
+                throw OpenMMException("loadCheckpoint: Checkpoint was created with a different Platform: "+platformName);
+            int numParticles;
+            section.read((char*) &numParticles, sizeof(int));
+            if (numParticles != getSystem().getNumParticles())
+                throw OpenMMException("loadCheckpoint: Checkpoint contains the wrong number of particles");
+            int numParameters;
+            section.read((char*) &numParameters, sizeof(int));
+            for (int i = 0; i < numParameters; i++) {
+                string name = readString(section);
+                double value;
+                section.read((char*) &value, sizeof(double));
+                parameters[name] = value;
+            }
+            foundContext = true;
+        }
+        else if (tag == "platform") {
+            updateStateDataKernel.getAs<UpdateStateDataKernel>().loadCheckpoint(*this, section);
+            hasSetPositions = true;
+        }
+        else if (tag == "integrator")
+            integrator.loadCheckpoint(section);
+        else
+            forceImpls[forceIndex]->loadCheckpoint(*this, section);
+    }
+    integrator.stateChanged(State::Positions);
+    integrator.stateChanged(State::Velocities);
+    integrator.stateChanged(State::Parameters);
+}
 
+void ContextImpl::loadLegacyCheckpoint(istream& stream) {
     string platformName = readString(stream);
     if (platformName != getPlatform().getName())
         throw OpenMMException("loadCheckpoint: Checkpoint was created with a different Platform: "+platformName);
@@ -453,6 +649,9 @@ void ContextImpl::loadCheckpoint(istream& stream) {
         stream.read((char*) &value, sizeof(double));
         parameters[name] = value;
     }
-    updateStateDataKernel.getAs<UpdateStateDataKernel>().loadCheckpoint(*this, stream);
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().loadLegacyCheckpoint(*this, stream);
     hasSetPositions = true;
+    integrator.stateChanged(State::Positions);
+    integrator.stateChanged(State::Velocities);
+    integrator.stateChanged(State::Parameters);
 }
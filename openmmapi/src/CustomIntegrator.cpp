@@ -35,6 +35,7 @@
 #include "openmm/internal/AssertionUtilities.h"
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/kernels.h"
+#include <iostream>
 #include <set>
 #include <string>
 
@@ -98,6 +99,9 @@ void CustomIntegrator::step(int steps) {
         throw OpenMMException("This Integrator is not bound to a context!");  
     globalsAreCurrent = false;
     for (int i = 0; i < steps; ++i) {
+        // The kernel computes forces whenever the step requires them, so this time includes theirs.
+
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         kernel.getAs<IntegrateCustomStepKernel>().execute(*context, *this, forcesAreValid);
     }
 }
@@ -157,6 +161,49 @@ void CustomIntegrator::setGlobalVariable(int index, double value) {
         kernel.getAs<IntegrateCustomStepKernel>().setGlobalVariables(*context, globalValues);
 }
 
+void CustomIntegrator::createCheckpoint(std::ostream& stream) const {
+    int numGlobals = getNumGlobalVariables();
+    stream.write((char*) &numGlobals, sizeof(int));
+    for (int i = 0; i < numGlobals; i++) {
+        double value = getGlobalVariable(i);
+        stream.write((char*) &value, sizeof(double));
+    }
+    int numPerDof = getNumPerDofVariables();
+    stream.write((char*) &numPerDof, sizeof(int));
+    vector<Vec3> values;
+    for (int i = 0; i < numPerDof; i++) {
+        getPerDofVariable(i, values);
+        int numValues = values.size();
+        stream.write((char*) &numValues, sizeof(int));
+        if (numValues > 0)
+            stream.write((char*) &values[0], numValues*sizeof(Vec3));
+    }
+}
+
+void CustomIntegrator::loadCheckpoint(std::istream& stream) {
+    int numGlobals, numPerDof;
+    stream.read((char*) &numGlobals, sizeof(int));
+    if (numGlobals != getNumGlobalVariables())
+        throw OpenMMException("loadCheckpoint: Checkpoint contains the wrong number of global variables");
+    for (int i = 0; i < numGlobals; i++) {
+        double value;
+        stream.read((char*) &value, sizeof(double));
+        setGlobalVariable(i, value);
+    }
+    stream.read((char*) &numPerDof, sizeof(int));
+    if (numPerDof != getNumPerDofVariables())
+        throw OpenMMException("loadCheckpoint: Checkpoint contains the wrong number of per-DOF variables");
+    vector<Vec3> values;
+    for (int i = 0; i < numPerDof; i++) {
+        int numValues;
+        stream.read((char*) &numValues, sizeof(int));
+        values.resize(numValues);
+        if (numValues > 0)
+            stream.read((char*) &values[0], numValues*sizeof(Vec3));
+        setPerDofVariable(i, values);
+    }
+}
+
 void CustomIntegrator::setGlobalVariableByName(const string& name, double value) {
     for (int i = 0; i < (int) globalNames.size(); i++)
         if (name == globalNames[i]) {
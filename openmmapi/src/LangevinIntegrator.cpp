@@ -77,6 +77,7 @@ void LangevinIntegrator::step(int steps) {
     for (int i = 0; i < steps; ++i) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         kernel.getAs<IntegrateLangevinStepKernel>().execute(*context, *this);
     }
 }
@@ -31,10 +31,12 @@
 
 #include "openmm/internal/MonteCarloAnisotropicBarostatImpl.h"
 #include "openmm/internal/ContextImpl.h"
+#include "openmm/internal/MonteCarloBarostatImpl.h"
 #include "openmm/internal/OSRngSeed.h"
 #include "openmm/Context.h"
 #include "openmm/kernels.h"
 #include <cmath>
+#include <iostream>
 #include <vector>
 #include <algorithm>
 
@@ -47,7 +49,7 @@ const float AVOGADRO = 6.0221367e23f;
 const float RGAS = BOLTZMANN*AVOGADRO; // (J/(mol K))
 const float BOLTZ = RGAS/1000;         // (kJ/(mol K))
 
-MonteCarloAnisotropicBarostatImpl::MonteCarloAnisotropicBarostatImpl(const MonteCarloAnisotropicBarostat& owner) : owner(owner), step(0) {
+MonteCarloAnisotropicBarostatImpl::MonteCarloAnisotropicBarostatImpl(const MonteCarloAnisotropicBarostat& owner) : owner(owner), step(0), energyGroupsKnown(false) {
 }
 
 void MonteCarloAnisotropicBarostatImpl::initialize(ContextImpl& context) {
@@ -73,10 +75,14 @@ void MonteCarloAnisotropicBarostatImpl::updateContextState(ContextImpl& context)
     if (!owner.getScaleX() && !owner.getScaleY() && !owner.getScaleZ())
         return;
     step = 0;
+    if (!energyGroupsKnown) {
+        energyGroups = MonteCarloBarostatImpl::findScaledEnergyGroups(context);
+        energyGroupsKnown = true;
+    }
     
     // Compute the current potential energy.
     
-    double initialEnergy = context.getOwner().getState(State::Energy).getPotentialEnergy();
+    double initialEnergy = context.calcForcesAndEnergy(false, true, energyGroups);
     double pressure;
     
     // Choose which axis to modify at random.
@@ -118,7 +124,7 @@ void MonteCarloAnisotropicBarostatImpl::updateContextState(ContextImpl& context)
     
     // Compute the energy of the modified system.
     
-    double finalEnergy = context.getOwner().getState(State::Energy).getPotentialEnergy();
+    double finalEnergy = context.calcForcesAndEnergy(false, true, energyGroups);
     double kT = BOLTZ*context.getParameter(MonteCarloAnisotropicBarostat::Temperature());
     double w = finalEnergy-initialEnergy + pressure*deltaVolume - context.getMolecules().size()*kT*std::log(newVolume/volume);
     if (w > 0 && genrand_real2(random) > std::exp(-w/kT)) {
@@ -160,3 +166,18 @@ std::vector<std::string> MonteCarloAnisotropicBarostatImpl::getKernelNames() {
     return names;
 }
 
+void MonteCarloAnisotropicBarostatImpl::createCheckpoint(ContextImpl& context, std::ostream& stream) {
+    stream.write((char*) &step, sizeof(int));
+    stream.write((char*) numAttempted, 3*sizeof(int));
+    stream.write((char*) numAccepted, 3*sizeof(int));
+    stream.write((char*) volumeScale, 3*sizeof(double));
+    random.createCheckpoint(stream);
+}
+
+void MonteCarloAnisotropicBarostatImpl::loadCheckpoint(ContextImpl& context, std::istream& stream) {
+    stream.read((char*) &step, sizeof(int));
+    stream.read((char*) numAttempted, 3*sizeof(int));
+    stream.read((char*) numAccepted, 3*sizeof(int));
+    stream.read((char*) volumeScale, 3*sizeof(double));
+    random.loadCheckpoint(stream);
+}
@@ -32,9 +32,19 @@
 #include "openmm/internal/MonteCarloBarostatImpl.h"
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/internal/OSRngSeed.h"
+#include "openmm/CMAPTorsionForce.h"
 #include "openmm/Context.h"
+#include "openmm/CustomAngleForce.h"
+#include "openmm/CustomBondForce.h"
+#include "openmm/CustomTorsionForce.h"
+#include "openmm/HarmonicAngleForce.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/PeriodicTorsionForce.h"
+#include "openmm/RBTorsionForce.h"
 #include "openmm/kernels.h"
 #include <cmath>
+#include <iostream>
 #include <vector>
 #include <algorithm>
 
@@ -47,7 +57,7 @@ const float AVOGADRO = 6.0221367e23f;
 const float RGAS = BOLTZMANN*AVOGADRO; // (J/(mol K))
 const float BOLTZ = RGAS/1000;         // (kJ/(mol K))
 
-MonteCarloBarostatImpl::MonteCarloBarostatImpl(const MonteCarloBarostat& owner) : owner(owner), step(0) {
+MonteCarloBarostatImpl::MonteCarloBarostatImpl(const MonteCarloBarostat& owner) : owner(owner), step(0), energyGroupsKnown(false) {
 }
 
 void MonteCarloBarostatImpl::initialize(ContextImpl& context) {
@@ -69,10 +79,14 @@ void MonteCarloBarostatImpl::updateContextState(ContextImpl& context) {
     if (++step < owner.getFrequency() || owner.getFrequency() == 0)
         return;
     step = 0;
+    if (!energyGroupsKnown) {
+        energyGroups = findScaledEnergyGroups(context);
+        energyGroupsKnown = true;
+    }
 
     // Compute the current potential energy.
 
-    double initialEnergy = context.getOwner().getState(State::Energy).getPotentialEnergy();
+    double initialEnergy = context.calcForcesAndEnergy(false, true, energyGroups);
 
     // Modify the periodic box size.
 
@@ -87,7 +101,7 @@ void MonteCarloBarostatImpl::updateContextState(ContextImpl& context) {
 
     // Compute the energy of the modified system.
     
-    double finalEnergy = context.getOwner().getState(State::Energy).getPotentialEnergy();
+    double finalEnergy = context.calcForcesAndEnergy(false, true, energyGroups);
     double pressure = context.getParameter(MonteCarloBarostat::Pressure())*(AVOGADRO*1e-25);
     double kT = BOLTZ*context.getParameter(MonteCarloBarostat::Temperature());
     double w = finalEnergy-initialEnergy + pressure*deltaVolume - context.getMolecules().size()*kT*std::log(newVolume/volume);
@@ -128,3 +142,148 @@ std::vector<std::string> MonteCarloBarostatImpl::getKernelNames() {
     return names;
 }
 
+
+/**
+ * Determine whether a list of particles all belong to the same molecule.
+ */
+static bool isInOneMolecule(const vector<int>& moleculeIndex, const int* particles, int numParticles) {
+    for (int i = 1; i < numParticles; i++)
+        if (moleculeIndex[particles[i]] != moleculeIndex[particles[0]])
+            return false;
+    return true;
+}
+
+/**
+ * Determine whether the energy of a Force is unchanged when each molecule is translated rigidly.
+ */
+static bool isInvariantUnderScaling(const Force& force, const vector<int>& moleculeIndex) {
+    int p[8];
+    double d[6];
+    vector<double> params;
+    if (dynamic_cast<const HarmonicBondForce*>(&force) != NULL) {
+        const HarmonicBondForce& f = dynamic_cast<const HarmonicBondForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumBonds(); i++) {
+            f.getBondParameters(i, p[0], p[1], d[0], d[1]);
+            if (!isInOneMolecule(moleculeIndex, p, 2))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const HarmonicAngleForce*>(&force) != NULL) {
+        const HarmonicAngleForce& f = dynamic_cast<const HarmonicAngleForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumAngles(); i++) {
+            f.getAngleParameters(i, p[0], p[1], p[2], d[0], d[1]);
+            if (!isInOneMolecule(moleculeIndex, p, 3))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const PeriodicTorsionForce*>(&force) != NULL) {
+        const PeriodicTorsionForce& f = dynamic_cast<const PeriodicTorsionForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumTorsions(); i++) {
+            f.getTorsionParameters(i, p[0], p[1], p[2], p[3], p[4], d[0], d[1]);
+            if (!isInOneMolecule(moleculeIndex, p, 4))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const RBTorsionForce*>(&force) != NULL) {
+        const RBTorsionForce& f = dynamic_cast<const RBTorsionForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumTorsions(); i++) {
+            f.getTorsionParameters(i, p[0], p[1], p[2], p[3], d[0], d[1], d[2], d[3], d[4], d[5]);
+            if (!isInOneMolecule(moleculeIndex, p, 4))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const CMAPTorsionForce*>(&force) != NULL) {
+        const CMAPTorsionForce& f = dynamic_cast<const CMAPTorsionForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        int map;
+        for (int i = 0; i < f.getNumTorsions(); i++) {
+            f.getTorsionParameters(i, map, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+            if (!isInOneMolecule(moleculeIndex, p, 8))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const CustomBondForce*>(&force) != NULL) {
+        const CustomBondForce& f = dynamic_cast<const CustomBondForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumBonds(); i++) {
+            f.getBondParameters(i, p[0], p[1], params);
+            if (!isInOneMolecule(moleculeIndex, p, 2))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const CustomAngleForce*>(&force) != NULL) {
+        const CustomAngleForce& f = dynamic_cast<const CustomAngleForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumAngles(); i++) {
+            f.getAngleParameters(i, p[0], p[1], p[2], params);
+            if (!isInOneMolecule(moleculeIndex, p, 3))
+                return false;
+        }
+        return true;
+    }
+    if (dynamic_cast<const CustomTorsionForce*>(&force) != NULL) {
+        const CustomTorsionForce& f = dynamic_cast<const CustomTorsionForce&>(force);
+        if (f.usesPeriodicBoundaryConditions())
+            return false;
+        for (int i = 0; i < f.getNumTorsions(); i++) {
+            f.getTorsionParameters(i, p[0], p[1], p[2], p[3], params);
+            if (!isInOneMolecule(moleculeIndex, p, 4))
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+int MonteCarloBarostatImpl::findScaledEnergyGroups(ContextImpl& context) {
+    const System& system = context.getSystem();
+    const vector<vector<int> >& molecules = context.getMolecules();
+    vector<int> moleculeIndex(system.getNumParticles());
+    for (int i = 0; i < (int) molecules.size(); i++)
+        for (int j = 0; j < (int) molecules[i].size(); j++)
+            moleculeIndex[molecules[i][j]] = i;
+    unsigned int groups = 0;
+    for (int i = 0; i < system.getNumForces(); i++) {
+        const Force& force = system.getForce(i);
+        if (isInvariantUnderScaling(force, moleculeIndex))
+            continue;
+        groups |= 1u<<force.getForceGroup();
+        const NonbondedForce* nonbonded = dynamic_cast<const NonbondedForce*>(&force);
+        if (nonbonded != NULL && nonbonded->getReciprocalSpaceForceGroup() >= 0)
+            groups |= 1u<<nonbonded->getReciprocalSpaceForceGroup();
+    }
+    return (int) groups;
+}
+
+void MonteCarloBarostatImpl::createCheckpoint(ContextImpl& context, std::ostream& stream) {
+    stream.write((char*) &step, sizeof(int));
+    stream.write((char*) &numAttempted, sizeof(int));
+    stream.write((char*) &numAccepted, sizeof(int));
+    stream.write((char*) &volumeScale, sizeof(double));
+    random.createCheckpoint(stream);
+}
+
+void MonteCarloBarostatImpl::loadCheckpoint(ContextImpl& context, std::istream& stream) {
+    stream.read((char*) &step, sizeof(int));
+    stream.read((char*) &numAttempted, sizeof(int));
+    stream.read((char*) &numAccepted, sizeof(int));
+    stream.read((char*) &volumeScale, sizeof(double));
+    random.loadCheckpoint(stream);
+}
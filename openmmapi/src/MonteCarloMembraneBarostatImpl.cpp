@@ -31,10 +31,12 @@
 
 #include "openmm/internal/MonteCarloMembraneBarostatImpl.h"
 #include "openmm/internal/ContextImpl.h"
+#include "openmm/internal/MonteCarloBarostatImpl.h"
 #include "openmm/internal/OSRngSeed.h"
 #include "openmm/Context.h"
 #include "openmm/kernels.h"
 #include <cmath>
+#include <iostream>
 #include <vector>
 #include <algorithm>
 
@@ -47,7 +49,7 @@ const float AVOGADRO = 6.0221367e23f;
 const float RGAS = BOLTZMANN*AVOGADRO; // (J/(mol K))
 const float BOLTZ = RGAS/1000;         // (kJ/(mol K))
 
-MonteCarloMembraneBarostatImpl::MonteCarloMembraneBarostatImpl(const MonteCarloMembraneBarostat& owner) : owner(owner), step(0) {
+MonteCarloMembraneBarostatImpl::MonteCarloMembraneBarostatImpl(const MonteCarloMembraneBarostat& owner) : owner(owner), step(0), energyGroupsKnown(false) {
 }
 
 void MonteCarloMembraneBarostatImpl::initialize(ContextImpl& context) {
@@ -71,10 +73,14 @@ void MonteCarloMembraneBarostatImpl::updateContextState(ContextImpl& context) {
     if (++step < owner.getFrequency() || owner.getFrequency() == 0)
         return;
     step = 0;
+    if (!energyGroupsKnown) {
+        energyGroups = MonteCarloBarostatImpl::findScaledEnergyGroups(context);
+        energyGroupsKnown = true;
+    }
     
     // Compute the current potential energy.
     
-    double initialEnergy = context.getOwner().getState(State::Energy).getPotentialEnergy();
+    double initialEnergy = context.calcForcesAndEnergy(false, true, energyGroups);
     double pressure = context.getParameter(MonteCarloMembraneBarostat::Pressure())*(AVOGADRO*1e-25);
     double tension = context.getParameter(MonteCarloMembraneBarostat::SurfaceTension())*(AVOGADRO*1e-25);
     
@@ -119,7 +125,7 @@ void MonteCarloMembraneBarostatImpl::updateContextState(ContextImpl& context) {
     
     // Compute the energy of the modified system.
     
-    double finalEnergy = context.getOwner().getState(State::Energy).getPotentialEnergy();
+    double finalEnergy = context.calcForcesAndEnergy(false, true, energyGroups);
     double kT = BOLTZ*context.getParameter(MonteCarloMembraneBarostat::Temperature());
     double w = finalEnergy-initialEnergy + pressure*deltaVolume - tension*deltaArea - context.getMolecules().size()*kT*std::log(newVolume/volume);
     if (w > 0 && genrand_real2(random) > std::exp(-w/kT)) {
@@ -159,3 +165,19 @@ std::vector<std::string> MonteCarloMembraneBarostatImpl::getKernelNames() {
     names.push_back(ApplyMonteCarloBarostatKernel::Name());
     return names;
 }
+
+void MonteCarloMembraneBarostatImpl::createCheckpoint(ContextImpl& context, std::ostream& stream) {
+    stream.write((char*) &step, sizeof(int));
+    stream.write((char*) numAttempted, 3*sizeof(int));
+    stream.write((char*) numAccepted, 3*sizeof(int));
+    stream.write((char*) volumeScale, 3*sizeof(double));
+    random.createCheckpoint(stream);
+}
+
+void MonteCarloMembraneBarostatImpl::loadCheckpoint(ContextImpl& context, std::istream& stream) {
+    stream.read((char*) &step, sizeof(int));
+    stream.read((char*) numAttempted, 3*sizeof(int));
+    stream.read((char*) numAccepted, 3*sizeof(int));
+    stream.read((char*) volumeScale, 3*sizeof(double));
+    random.loadCheckpoint(stream);
+}
@@ -34,6 +34,9 @@
 #include "openmm/NonbondedForce.h"
 #include "openmm/internal/AssertionUtilities.h"
 #include "openmm/internal/NonbondedForceImpl.h"
+#include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/hardware.h"
+#include <algorithm>
 #include <cmath>
 #include <map>
 #include <sstream>
@@ -42,7 +45,6 @@
 using namespace OpenMM;
 using std::map;
 using std::pair;
-using std::set;
 using std::string;
 using std::stringstream;
 using std::vector;
@@ -161,6 +163,36 @@ int NonbondedForce::addException(int particle1, int particle2, double chargeProd
     exceptionMap[pair<int, int>(particle1, particle2)] = newIndex;
     return newIndex;
 }
+
+void NonbondedForce::addExceptions(const vector<pair<int, int> >& pairs, const vector<double>& chargeProd, const vector<double>& sigma,
+            const vector<double>& epsilon, bool replace) {
+    int numPairs = pairs.size();
+    if (chargeProd.size() != pairs.size() || sigma.size() != pairs.size() || epsilon.size() != pairs.size())
+        throw OpenMMException("NonbondedForce: addExceptions() requires all vectors to have the same length");
+    exceptions.reserve(exceptions.size()+numPairs);
+    if (exceptions.size() == 0) {
+        // There are no existing exceptions to conflict with, so if the new ones don't conflict with each other
+        // we can build the map from a sorted list in linear time instead of inserting them one at a time.
+
+        vector<pair<int, int> > sortedPairs(numPairs);
+        for (int i = 0; i < numPairs; i++)
+            sortedPairs[i] = pair<int, int>(std::min(pairs[i].first, pairs[i].second), std::max(pairs[i].first, pairs[i].second));
+        std::sort(sortedPairs.begin(), sortedPairs.end());
+        if (std::adjacent_find(sortedPairs.begin(), sortedPairs.end()) == sortedPairs.end()) {
+            vector<pair<pair<int, int>, int> > entries(numPairs);
+            for (int i = 0; i < numPairs; i++) {
+                exceptions.push_back(ExceptionInfo(pairs[i].first, pairs[i].second, chargeProd[i], sigma[i], epsilon[i]));
+                entries[i] = pair<pair<int, int>, int>(pairs[i], i);
+            }
+            std::sort(entries.begin(), entries.end());
+            exceptionMap.insert(entries.begin(), entries.end());
+            return;
+        }
+    }
+    for (int i = 0; i < numPairs; i++)
+        addException(pairs[i].first, pairs[i].second, chargeProd[i], sigma[i], epsilon[i], replace);
+}
+
 void NonbondedForce::getExceptionParameters(int index, int& particle1, int& particle2, double& chargeProd, double& sigma, double& epsilon) const {
     ASSERT_VALID_INDEX(index, exceptions);
     particle1 = exceptions[index].particle1;
@@ -183,52 +215,129 @@ ForceImpl* NonbondedForce::createImpl() const {
     return new NonbondedForceImpl(*this);
 }
 
-void NonbondedForce::createExceptionsFromBonds(const vector<pair<int, int> >& bonds, double coulomb14Scale, double lj14Scale) {
+/**
+ * This task finds the pairs of particles separated by one, two, or three bonds.  The bond graph is stored in
+ * compressed sparse row format.  Each thread processes a contiguous range of particles, so concatenating the
+ * results from all threads gives the pairs in order.
+ */
+class FindExceptionsTask : public ThreadPool::Task {
+public:
+    FindExceptionsTask(int numParticles, const vector<int>& bondStart, const vector<int>& bondedTo, int numThreads) :
+            numParticles(numParticles), bondStart(bondStart), bondedTo(bondedTo), pairs(numThreads), is14(numThreads) {
+    }
+    void execute(ThreadPool& pool, int threadIndex) {
+        int numThreads = pairs.size();
+        int start = (int) ((long long) numParticles*threadIndex/numThreads);
+        int end = (int) ((long long) numParticles*(threadIndex+1)/numThreads);
+        findPairs(start, end, pairs[threadIndex], is14[threadIndex]);
+    }
+    void findPairs(int start, int end, vector<pair<int, int> >& pairs, vector<char>& is14) {
+        // Do a breadth first search from each particle out to a depth of three bonds.  lastVisitor records the
+        // particle whose search most recently reached each particle, so it never needs to be cleared.
+
+        vector<int> lastVisitor(numParticles, -1);
+        vector<int> found;
+        vector<int> foundDepth;
+        vector<pair<int, int> > earlier;
+        for (int i = start; i < end; i++) {
+            found.clear();
+            foundDepth.clear();
+            lastVisitor[i] = i;
+            int levelStart = 0;
+            int levelEnd = 0;
+            for (int depth = 1; depth <= 3; depth++) {
+                for (int j = (depth == 1 ? -1 : levelStart); j < (depth == 1 ? 0 : levelEnd); j++) {
+                    int from = (j == -1 ? i : found[j]);
+                    for (int k = bondStart[from]; k < bondStart[from+1]; k++) {
+                        int particle = bondedTo[k];
+                        if (lastVisitor[particle] != i) {
+                            lastVisitor[particle] = i;
+                            found.push_back(particle);
+                            foundDepth.push_back(depth);
+                        }
+                    }
+                }
+                levelStart = levelEnd;
+                levelEnd = found.size();
+            }
+
+            // Record the pairs with lower index particles.
+
+            earlier.clear();
+            for (int j = 0; j < (int) found.size(); j++)
+                if (found[j] < i)
+                    earlier.push_back(pair<int, int>(found[j], foundDepth[j]));
+            std::sort(earlier.begin(), earlier.end());
+            for (int j = 0; j < (int) earlier.size(); j++) {
+                pairs.push_back(pair<int, int>(earlier[j].first, i));
+                is14.push_back(earlier[j].second == 3);
+            }
+        }
+    }
+    int numParticles;
+    const vector<int>& bondStart;
+    const vector<int>& bondedTo;
+    vector<vector<pair<int, int> > > pairs;
+    vector<vector<char> > is14;
+};
 
-    // Find particles separated by 1, 2, or 3 bonds.
+void NonbondedForce::createExceptionsFromBonds(const vector<pair<int, int> >& bonds, double coulomb14Scale, double lj14Scale) {
+    // Build the bond graph in compressed sparse row format.
 
-    vector<set<int> > exclusions(particles.size());
-    vector<set<int> > bonded12(exclusions.size());
+    int numParticles = particles.size();
+    vector<int> bondStart(numParticles+1, 0);
     for (int i = 0; i < (int) bonds.size(); ++i) {
-        bonded12[bonds[i].first].insert(bonds[i].second);
-        bonded12[bonds[i].second].insert(bonds[i].first);
+        if (bonds[i].first < 0 || bonds[i].first >= numParticles || bonds[i].second < 0 || bonds[i].second >= numParticles)
+            throw OpenMMException("createExceptionsFromBonds: Illegal particle index in list of bonds");
+        bondStart[bonds[i].first+1]++;
+        bondStart[bonds[i].second+1]++;
+    }
+    for (int i = 0; i < numParticles; ++i)
+        bondStart[i+1] += bondStart[i];
+    vector<int> bondedTo(bondStart[numParticles]);
+    vector<int> nextBond(bondStart.begin(), bondStart.end()-1);
+    for (int i = 0; i < (int) bonds.size(); ++i) {
+        bondedTo[nextBond[bonds[i].first]++] = bonds[i].second;
+        bondedTo[nextBond[bonds[i].second]++] = bonds[i].first;
     }
-    for (int i = 0; i < (int) exclusions.size(); ++i)
-        addExclusionsToSet(bonded12, exclusions[i], i, i, 2);
-
-    // Find particles separated by 1 or 2 bonds and create the exceptions.
-
-    for (int i = 0; i < (int) exclusions.size(); ++i) {
-        set<int> bonded13;
-        addExclusionsToSet(bonded12, bonded13, i, i, 1);
-        for (set<int>::const_iterator iter = exclusions[i].begin(); iter != exclusions[i].end(); ++iter)
-            if (*iter < i) {
-                if (bonded13.find(*iter) == bonded13.end()) {
-                    // This is a 1-4 interaction.
-
-                    const ParticleInfo& particle1 = particles[*iter];
-                    const ParticleInfo& particle2 = particles[i];
-                    const double chargeProd = coulomb14Scale*particle1.charge*particle2.charge;
-                    const double sigma = 0.5*(particle1.sigma+particle2.sigma);
-                    const double epsilon = lj14Scale*std::sqrt(particle1.epsilon*particle2.epsilon);
-                    addException(*iter, i, chargeProd, sigma, epsilon);
-                }
-                else {
-                    // This interaction should be completely excluded.
 
-                    addException(*iter, i, 0.0, 1.0, 0.0);
-                }
-            }
+    // Find particles separated by 1, 2, or 3 bonds.  Large systems are split between threads.
+
+    const int minParticlesPerThread = 10000;
+    int numThreads = std::max(1, std::min(getNumProcessors(), numParticles/minParticlesPerThread));
+    FindExceptionsTask task(numParticles, bondStart, bondedTo, numThreads);
+    if (numThreads == 1)
+        task.findPairs(0, numParticles, task.pairs[0], task.is14[0]);
+    else {
+        ThreadPool threads(numThreads);
+        threads.execute(task);
+        threads.waitForThreads();
     }
-}
 
-void NonbondedForce::addExclusionsToSet(const vector<set<int> >& bonded12, set<int>& exclusions, int baseParticle, int fromParticle, int currentLevel) const {
-    for (set<int>::const_iterator iter = bonded12[fromParticle].begin(); iter != bonded12[fromParticle].end(); ++iter) {
-        if (*iter != baseParticle)
-            exclusions.insert(*iter);
-        if (currentLevel > 0)
-            addExclusionsToSet(bonded12, exclusions, baseParticle, *iter, currentLevel-1);
+    // Create the exceptions.  Pairs separated by 1 or 2 bonds are excluded, while 1-4 interactions are scaled.
+
+    vector<pair<int, int> > pairs;
+    vector<double> chargeProd, sigma, epsilon;
+    for (int i = 0; i < numThreads; i++) {
+        for (int j = 0; j < (int) task.pairs[i].size(); j++) {
+            pairs.push_back(task.pairs[i][j]);
+            if (task.is14[i][j]) {
+                const ParticleInfo& particle1 = particles[task.pairs[i][j].first];
+                const ParticleInfo& particle2 = particles[task.pairs[i][j].second];
+                chargeProd.push_back(coulomb14Scale*particle1.charge*particle2.charge);
+                sigma.push_back(0.5*(particle1.sigma+particle2.sigma));
+                epsilon.push_back(lj14Scale*std::sqrt(particle1.epsilon*particle2.epsilon));
+            }
+            else {
+                chargeProd.push_back(0.0);
+                sigma.push_back(1.0);
+                epsilon.push_back(0.0);
+            }
+        }
+        vector<pair<int, int> >().swap(task.pairs[i]);
+        vector<char>().swap(task.is14[i]);
     }
+    addExceptions(pairs, chargeProd, sigma, epsilon);
 }
 
 int NonbondedForce::getReciprocalSpaceForceGroup() const {
@@ -30,12 +30,53 @@
  * -------------------------------------------------------------------------- */
 
 #include "openmm/internal/ThreadPool.h"
+#include "openmm/OpenMMException.h"
 #include "openmm/internal/hardware.h"
+#include "openmm/internal/gmx_atomic.h"
+#include <sched.h>
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define SPIN_PAUSE() _mm_pause()
+#else
+    #define SPIN_PAUSE()
+#endif
 
 using namespace std;
 
 namespace OpenMM {
 
+/**
+ * In spin waiting mode, a thread checks whether it can continue up to SPIN_COUNT times before it gives
+ * up and blocks.  After the first PAUSE_COUNT checks it yields the processor between checks, so a waiting
+ * thread cannot starve the threads it is waiting for when there are more threads than cores.
+ */
+static const int SPIN_COUNT = 2000;
+static const int PAUSE_COUNT = 200;
+
+static void spinPause(int iteration) {
+    if (iteration < PAUSE_COUNT)
+        SPIN_PAUSE();
+    else
+        sched_yield();
+}
+
+/**
+ * The counters used in spin waiting mode.  generation is incremented every time the worker threads
+ * are resumed.  arrivedCount is the number of workers that have reached the current synchronization
+ * point.  blockedWorkers and blockedMaster record whether any thread has stopped spinning and is
+ * waiting on a condition variable, so it only needs to be signalled when that has actually happened.
+ */
+class ThreadPool::SpinState {
+public:
+    SpinState() {
+        gmx_atomic_set(&generation, 0);
+        gmx_atomic_set(&arrivedCount, 0);
+        gmx_atomic_set(&blockedWorkers, 0);
+        gmx_atomic_set(&blockedMaster, 0);
+    }
+    gmx_atomic_t generation, arrivedCount, blockedWorkers, blockedMaster;
+};
+
 class ThreadPool::ThreadData {
 public:
     ThreadData(ThreadPool& owner, int index) : owner(owner), index(index), isDeleted(false) {
@@ -60,15 +101,16 @@ static void* threadBody(void* args) {
     return 0;
 }
 
-ThreadPool::ThreadPool(int numThreads) {
+ThreadPool::ThreadPool(int numThreads, bool spinWait) : spinWait(spinWait), spinState(NULL) {
     if (numThreads <= 0)
         numThreads = getNumProcessors();
     this->numThreads = numThreads;
+    if (spinWait)
+        spinState = new SpinState();
     pthread_cond_init(&startCondition, NULL);
     pthread_cond_init(&endCondition, NULL);
     pthread_mutex_init(&lock, NULL);
     thread.resize(numThreads);
-    pthread_mutex_lock(&lock);
     waitCount = 0;
     for (int i = 0; i < numThreads; i++) {
         ThreadData* data = new ThreadData(*this, i);
@@ -76,19 +118,17 @@ ThreadPool::ThreadPool(int numThreads) {
         threadData.push_back(data);
         pthread_create(&thread[i], NULL, threadBody, data);
     }
-    while (waitCount < numThreads)
-        pthread_cond_wait(&endCondition, &lock);
-    pthread_mutex_unlock(&lock);
+    waitForThreads();
 }
 
 ThreadPool::~ThreadPool() {
     for (int i = 0; i < (int) threadData.size(); i++)
         threadData[i]->isDeleted = true;
-    pthread_mutex_lock(&lock);
-    pthread_cond_broadcast(&startCondition);
-    pthread_mutex_unlock(&lock);
+    resumeThreads();
     for (int i = 0; i < (int) thread.size(); i++)
         pthread_join(thread[i], NULL);
+    if (spinState != NULL)
+        delete spinState;
     pthread_mutex_destroy(&lock);
     pthread_cond_destroy(&startCondition);
     pthread_cond_destroy(&endCondition);
@@ -98,6 +138,29 @@ int ThreadPool::getNumThreads() const {
     return numThreads;
 }
 
+bool ThreadPool::getSpinWait() const {
+    return spinWait;
+}
+
+void ThreadPool::setThreadAffinity(const vector<int>& processors) {
+    if (processors.size() == 0)
+        throw OpenMMException("ThreadPool: no processors specified for thread affinity");
+#ifdef __linux__
+    for (int i = 0; i < numThreads; i++) {
+        int processor = processors[i%processors.size()];
+        if (processor < 0 || processor >= CPU_SETSIZE)
+            throw OpenMMException("ThreadPool: illegal processor index for thread affinity");
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(processor, &cpus);
+        if (pthread_setaffinity_np(thread[i], sizeof(cpus), &cpus) != 0)
+            throw OpenMMException("ThreadPool: failed to bind a thread to the requested processor");
+    }
+#else
+    throw OpenMMException("ThreadPool: setting thread affinity is not supported on this operating system");
+#endif
+}
+
 void ThreadPool::execute(Task& task) {
     for (int i = 0; i < (int) threadData.size(); i++)
         threadData[i]->currentTask = &task;
@@ -105,6 +168,38 @@ void ThreadPool::execute(Task& task) {
 }
 
 void ThreadPool::syncThreads() {
+    if (spinWait) {
+        // Record which generation we are in, then announce that this thread has arrived.  If it is
+        // the last one and the master thread has blocked, wake it up.
+
+        int currentGeneration = gmx_atomic_read(&spinState->generation);
+        gmx_atomic_memory_barrier();
+        bool lastThread = (gmx_atomic_add_return(&spinState->arrivedCount, 1) == numThreads);
+        gmx_atomic_memory_barrier();
+        if (lastThread && gmx_atomic_read(&spinState->blockedMaster) != 0) {
+            pthread_mutex_lock(&lock);
+            pthread_cond_signal(&endCondition);
+            pthread_mutex_unlock(&lock);
+        }
+
+        // Spin until the master thread starts the next generation, or block if that takes too long.
+
+        for (int i = 0; i < SPIN_COUNT; i++) {
+            if (gmx_atomic_read(&spinState->generation) != currentGeneration) {
+                gmx_atomic_memory_barrier();
+                return;
+            }
+            spinPause(i);
+        }
+        pthread_mutex_lock(&lock);
+        gmx_atomic_fetch_add(&spinState->blockedWorkers, 1);
+        gmx_atomic_memory_barrier();
+        while (gmx_atomic_read(&spinState->generation) == currentGeneration)
+            pthread_cond_wait(&startCondition, &lock);
+        gmx_atomic_fetch_add(&spinState->blockedWorkers, -1);
+        pthread_mutex_unlock(&lock);
+        return;
+    }
     pthread_mutex_lock(&lock);
     waitCount++;
     pthread_cond_signal(&endCondition);
@@ -113,6 +208,23 @@ void ThreadPool::syncThreads() {
 }
 
 void ThreadPool::waitForThreads() {
+    if (spinWait) {
+        for (int i = 0; i < SPIN_COUNT; i++) {
+            if (gmx_atomic_read(&spinState->arrivedCount) == numThreads) {
+                gmx_atomic_memory_barrier();
+                return;
+            }
+            spinPause(i);
+        }
+        pthread_mutex_lock(&lock);
+        gmx_atomic_fetch_add(&spinState->blockedMaster, 1);
+        gmx_atomic_memory_barrier();
+        while (gmx_atomic_read(&spinState->arrivedCount) < numThreads)
+            pthread_cond_wait(&endCondition, &lock);
+        gmx_atomic_fetch_add(&spinState->blockedMaster, -1);
+        pthread_mutex_unlock(&lock);
+        return;
+    }
     pthread_mutex_lock(&lock);
     while (waitCount < numThreads)
         pthread_cond_wait(&endCondition, &lock);
@@ -120,6 +232,21 @@ void ThreadPool::waitForThreads() {
 }
 
 void ThreadPool::resumeThreads() {
+    if (spinWait) {
+        // Starting a new generation releases the spinning threads.  Only blocked threads need a signal.
+
+        gmx_atomic_memory_barrier();
+        gmx_atomic_set(&spinState->arrivedCount, 0);
+        gmx_atomic_memory_barrier();
+        gmx_atomic_fetch_add(&spinState->generation, 1);
+        gmx_atomic_memory_barrier();
+        if (gmx_atomic_read(&spinState->blockedWorkers) != 0) {
+            pthread_mutex_lock(&lock);
+            pthread_cond_broadcast(&startCondition);
+            pthread_mutex_unlock(&lock);
+        }
+        return;
+    }
     pthread_mutex_lock(&lock);
     waitCount = 0;
     pthread_cond_broadcast(&startCondition);
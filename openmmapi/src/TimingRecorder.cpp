@@ -0,0 +1,115 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+#include "openmm/internal/TimingRecorder.h"
+#include "openmm/internal/timer.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+using namespace OpenMM;
+using namespace std;
+
+TimingRecorder::TimingRecorder() : enabled(false) {
+}
+
+void TimingRecorder::setEnabled(bool enabled) {
+    this->enabled = enabled;
+}
+
+void TimingRecorder::record(const string& operation, double time) {
+    Statistics& stats = statistics[operation];
+    if (stats.count == 0 || time < stats.min)
+        stats.min = time;
+    if (stats.count == 0 || time > stats.max)
+        stats.max = time;
+    stats.count++;
+    stats.total += time;
+}
+
+vector<string> TimingRecorder::getOperations() const {
+    vector<string> operations;
+    for (map<string, Statistics>::const_iterator iter = statistics.begin(); iter != statistics.end(); ++iter)
+        operations.push_back(iter->first);
+    return operations;
+}
+
+void TimingRecorder::getStatistics(const string& operation, int& count, double& minTime, double& meanTime, double& maxTime, double& totalTime) const {
+    map<string, Statistics>::const_iterator iter = statistics.find(operation);
+    if (iter == statistics.end()) {
+        count = 0;
+        minTime = meanTime = maxTime = totalTime = 0.0;
+        return;
+    }
+    const Statistics& stats = iter->second;
+    count = stats.count;
+    minTime = stats.min;
+    meanTime = stats.total/stats.count;
+    maxTime = stats.max;
+    totalTime = stats.total;
+}
+
+string TimingRecorder::createReport() const {
+    // Sort the operations by total time.
+
+    vector<pair<double, string> > sorted;
+    size_t nameWidth = 9;
+    for (map<string, Statistics>::const_iterator iter = statistics.begin(); iter != statistics.end(); ++iter) {
+        sorted.push_back(make_pair(-iter->second.total, iter->first));
+        nameWidth = max(nameWidth, iter->first.size());
+    }
+    sort(sorted.begin(), sorted.end());
+
+    // Format the table.
+
+    string report;
+    char line[100];
+    report += string("Operation")+string(nameWidth-9, ' ');
+    sprintf(line, " %10s %12s %12s %12s %12s\n", "Count", "Total (ms)", "Min (ms)", "Mean (ms)", "Max (ms)");
+    report += line;
+    for (int i = 0; i < (int) sorted.size(); i++) {
+        const string& name = sorted[i].second;
+        const Statistics& stats = statistics.find(name)->second;
+        report += name+string(nameWidth-name.size(), ' ');
+        sprintf(line, " %10d %12.3f %12.4f %12.4f %12.4f\n", stats.count, 1000*stats.total, 1000*stats.min, 1000*stats.total/stats.count, 1000*stats.max);
+        report += line;
+    }
+    return report;
+}
+
+void TimingRecorder::reset() {
+    statistics.clear();
+}
+
+double TimingRecorder::getCurrentTime() {
+    return ::getCurrentTime();
+}
@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/TrajectoryReader.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/CompressedCoordinates.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace OpenMM;
+using namespace std;
+
+static const char MAGIC[4] = {'O', 'M', 'M', 'T'};
+static const int FORMAT_VERSION = 1;
+
+static void readBytes(istream& stream, char* buffer, size_t length) {
+    stream.read(buffer, length);
+    if ((size_t) stream.gcount() != length)
+        throw OpenMMException("TrajectoryReader: Unexpected end of stream");
+}
+
+static unsigned int decodeUInt32(const char* data) {
+    const unsigned char* bytes = (const unsigned char*) data;
+    return bytes[0] | (bytes[1]<<8) | (bytes[2]<<16) | ((unsigned int) bytes[3]<<24);
+}
+
+static double decodeDouble(const char* data) {
+    const unsigned char* bytes = (const unsigned char*) data;
+    unsigned long long bits = 0;
+    for (int i = 0; i < 8; i++)
+        bits |= ((unsigned long long) bytes[i])<<(8*i);
+    double value;
+    memcpy(&value, &bits, sizeof(double));
+    return value;
+}
+
+TrajectoryReader::TrajectoryReader(istream& stream) : stream(&stream), ownedStream(NULL), hasFrame(false) {
+    readHeader();
+}
+
+TrajectoryReader::TrajectoryReader(const string& filename) : ownedStream(NULL), hasFrame(false) {
+    ifstream* file = new ifstream(filename.c_str(), ios_base::in | ios_base::binary);
+    if (!file->is_open()) {
+        delete file;
+        throw OpenMMException("TrajectoryReader: Unable to open file "+filename);
+    }
+    stream = ownedStream = file;
+    try {
+        readHeader();
+    }
+    catch (...) {
+        delete ownedStream;
+        throw;
+    }
+}
+
+TrajectoryReader::~TrajectoryReader() {
+    if (ownedStream != NULL)
+        delete ownedStream;
+}
+
+void TrajectoryReader::readHeader() {
+    char header[20];
+    readBytes(*stream, header, 20);
+    if (memcmp(header, MAGIC, 4) != 0)
+        throw OpenMMException("TrajectoryReader: Not a trajectory file");
+    if (decodeUInt32(&header[4]) != FORMAT_VERSION)
+        throw OpenMMException("TrajectoryReader: Unsupported file version");
+    numParticles = decodeUInt32(&header[8]);
+    precision = decodeDouble(&header[12]);
+}
+
+int TrajectoryReader::getNumParticles() const {
+    return numParticles;
+}
+
+double TrajectoryReader::getPrecision() const {
+    return precision;
+}
+
+bool TrajectoryReader::readFrame() {
+    char lengthBytes[4];
+    stream->read(lengthBytes, 4);
+    if (stream->gcount() == 0 && stream->eof()) {
+        hasFrame = false;
+        return false;
+    }
+    if (stream->gcount() != 4)
+        throw OpenMMException("TrajectoryReader: Unexpected end of stream");
+    unsigned int length = decodeUInt32(lengthBytes);
+    if (length < 80)
+        throw OpenMMException("TrajectoryReader: Frame is corrupt");
+    vector<char> frame(length);
+    readBytes(*stream, &frame[0], length);
+    time = decodeDouble(&frame[0]);
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            box[i][j] = decodeDouble(&frame[8+24*i+8*j]);
+    vector<double> coords(3*numParticles);
+    if (numParticles > 0)
+        CompressedCoordinates::decode(&frame[80], length-80, 3*numParticles, precision, &coords[0]);
+    positions.resize(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        positions[i] = Vec3(coords[3*i], coords[3*i+1], coords[3*i+2]);
+    hasFrame = true;
+    return true;
+}
+
+void TrajectoryReader::checkFrame() const {
+    if (!hasFrame)
+        throw OpenMMException("TrajectoryReader: No frame has been read");
+}
+
+double TrajectoryReader::getTime() const {
+    checkFrame();
+    return time;
+}
+
+void TrajectoryReader::getPeriodicBoxVectors(Vec3& a, Vec3& b, Vec3& c) const {
+    checkFrame();
+    a = box[0];
+    b = box[1];
+    c = box[2];
+}
+
+void TrajectoryReader::getPositions(vector<Vec3>& positions) const {
+    checkFrame();
+    positions = this->positions;
+}
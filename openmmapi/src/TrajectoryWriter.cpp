@@ -0,0 +1,252 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/TrajectoryWriter.h"
+#include "openmm/Integrator.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/CompressedCoordinates.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <pthread.h>
+
+using namespace OpenMM;
+using namespace std;
+
+static const char MAGIC[4] = {'O', 'M', 'M', 'T'};
+static const int FORMAT_VERSION = 1;
+
+static void appendUInt32(vector<char>& output, unsigned int value) {
+    for (int i = 0; i < 4; i++)
+        output.push_back((char) ((value>>(8*i))&0xFF));
+}
+
+static void appendDouble(vector<char>& output, double value) {
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(double));
+    for (int i = 0; i < 8; i++)
+        output.push_back((char) ((bits>>(8*i))&0xFF));
+}
+
+/**
+ * This holds the ring buffer and synchronization objects shared between the calling thread and the
+ * background thread.  Frame i is recorded into slot i%bufferSize.  numRecorded is the number of frames
+ * that have been recorded, and numWritten is the number that have been written.  If the stream was
+ * opened by the TrajectoryWriter itself, ownedStream holds it so it can be deleted at the end.
+ */
+class TrajectoryWriter::WriterData {
+public:
+    ostream* stream;
+    ostream* ownedStream;
+    int numValues, bufferSize;
+    double precision;
+    vector<vector<double> > coords;
+    vector<double> time;
+    vector<Vec3> box;
+    int numRecorded, numWritten;
+    bool isDeleted, failed;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t condition;
+};
+
+static void* trajectoryThreadBody(void* args) {
+    TrajectoryWriter::WriterData& data = *reinterpret_cast<TrajectoryWriter::WriterData*>(args);
+    vector<char> frame;
+    pthread_mutex_lock(&data.lock);
+    while (true) {
+        while (data.numWritten == data.numRecorded && !data.isDeleted)
+            pthread_cond_wait(&data.condition, &data.lock);
+        if (data.numWritten == data.numRecorded)
+            break;
+
+        // Encode and write the next frame.  The lock is released while doing it, since this is the slow part.
+
+        int slot = data.numWritten%data.bufferSize;
+        pthread_mutex_unlock(&data.lock);
+        bool success;
+        try {
+            frame.clear();
+            appendUInt32(frame, 0);
+            appendDouble(frame, data.time[slot]);
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++)
+                    appendDouble(frame, data.box[3*slot+i][j]);
+            CompressedCoordinates::encode(&data.coords[slot][0], data.numValues, data.precision, frame);
+            unsigned int length = frame.size()-4;
+            for (int i = 0; i < 4; i++)
+                frame[i] = (char) ((length>>(8*i))&0xFF);
+            data.stream->write(&frame[0], frame.size());
+            data.stream->flush();
+            success = !data.stream->fail();
+        }
+        catch (...) {
+            success = false;
+        }
+        pthread_mutex_lock(&data.lock);
+        if (!success)
+            data.failed = true;
+        data.numWritten++;
+        pthread_cond_broadcast(&data.condition);
+    }
+    pthread_mutex_unlock(&data.lock);
+    return 0;
+}
+
+TrajectoryWriter::TrajectoryWriter(Context& context, ostream& stream, int interval, const vector<int>& particles, double precision, int bufferSize) :
+        context(context), particles(particles), interval(interval), currentStep(0), numFrames(0), precision(precision) {
+    initialize(stream, NULL, bufferSize);
+}
+
+TrajectoryWriter::TrajectoryWriter(Context& context, const string& filename, int interval, const vector<int>& particles, double precision, int bufferSize) :
+        context(context), particles(particles), interval(interval), currentStep(0), numFrames(0), precision(precision) {
+    ofstream* file = new ofstream(filename.c_str(), ios_base::out | ios_base::binary);
+    if (!file->is_open()) {
+        delete file;
+        throw OpenMMException("TrajectoryWriter: Unable to open file "+filename);
+    }
+    try {
+        initialize(*file, file, bufferSize);
+    }
+    catch (...) {
+        delete file;
+        throw;
+    }
+}
+
+void TrajectoryWriter::initialize(ostream& stream, ostream* ownedStream, int bufferSize) {
+    if (interval <= 0)
+        throw OpenMMException("TrajectoryWriter: interval must be positive");
+    if (precision <= 0)
+        throw OpenMMException("TrajectoryWriter: precision must be positive");
+    if (bufferSize <= 0)
+        throw OpenMMException("TrajectoryWriter: bufferSize must be positive");
+    int numParticles = context.getSystem().getNumParticles();
+    for (int i = 0; i < (int) particles.size(); i++)
+        if (particles[i] < 0 || particles[i] >= numParticles)
+            throw OpenMMException("TrajectoryWriter: Illegal particle index");
+    if (particles.size() > 0)
+        numParticles = particles.size();
+    vector<char> header(MAGIC, MAGIC+4);
+    appendUInt32(header, FORMAT_VERSION);
+    appendUInt32(header, numParticles);
+    appendDouble(header, precision);
+    stream.write(&header[0], header.size());
+    data = new WriterData();
+    data->stream = &stream;
+    data->ownedStream = ownedStream;
+    data->numValues = 3*numParticles;
+    data->bufferSize = bufferSize;
+    data->precision = precision;
+    data->coords.resize(bufferSize, vector<double>(3*numParticles));
+    data->time.resize(bufferSize);
+    data->box.resize(3*bufferSize);
+    data->numRecorded = 0;
+    data->numWritten = 0;
+    data->isDeleted = false;
+    data->failed = false;
+    pthread_mutex_init(&data->lock, NULL);
+    pthread_cond_init(&data->condition, NULL);
+    pthread_create(&data->thread, NULL, trajectoryThreadBody, data);
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    pthread_mutex_lock(&data->lock);
+    data->isDeleted = true;
+    pthread_cond_broadcast(&data->condition);
+    pthread_mutex_unlock(&data->lock);
+    pthread_join(data->thread, NULL);
+    pthread_mutex_destroy(&data->lock);
+    pthread_cond_destroy(&data->condition);
+    if (data->ownedStream != NULL)
+        delete data->ownedStream;
+    delete data;
+}
+
+int TrajectoryWriter::getInterval() const {
+    return interval;
+}
+
+double TrajectoryWriter::getPrecision() const {
+    return precision;
+}
+
+int TrajectoryWriter::getNumFrames() const {
+    return numFrames;
+}
+
+void TrajectoryWriter::step(int steps) {
+    while (steps > 0) {
+        int stepsToTake = min(steps, interval-currentStep%interval);
+        context.getIntegrator().step(stepsToTake);
+        currentStep += stepsToTake;
+        steps -= stepsToTake;
+        if (currentStep%interval == 0)
+            writeFrame();
+    }
+}
+
+void TrajectoryWriter::writeFrame() {
+    // Wait until a slot in the ring buffer is available.
+
+    pthread_mutex_lock(&data->lock);
+    while (data->numRecorded-data->numWritten >= data->bufferSize)
+        pthread_cond_wait(&data->condition, &data->lock);
+    int slot = data->numRecorded%data->bufferSize;
+    pthread_mutex_unlock(&data->lock);
+
+    // Copy the data into the slot.  The background thread never touches it until numRecorded is
+    // incremented below, so no lock is needed.
+
+    context.getPositions(&data->coords[slot][0], 3, particles);
+    State state = context.getState(0);
+    data->time[slot] = state.getTime();
+    state.getPeriodicBoxVectors(data->box[3*slot], data->box[3*slot+1], data->box[3*slot+2]);
+
+    // Hand it off to the background thread.
+
+    pthread_mutex_lock(&data->lock);
+    data->numRecorded++;
+    pthread_cond_broadcast(&data->condition);
+    pthread_mutex_unlock(&data->lock);
+    numFrames++;
+}
+
+void TrajectoryWriter::flush() {
+    pthread_mutex_lock(&data->lock);
+    while (data->numWritten < data->numRecorded)
+        pthread_cond_wait(&data->condition, &data->lock);
+    bool failed = data->failed;
+    pthread_mutex_unlock(&data->lock);
+    if (failed)
+        throw OpenMMException("TrajectoryWriter: Error writing trajectory to stream");
+}
@@ -34,6 +34,7 @@
 #include "openmm/OpenMMException.h"
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/kernels.h"
+#include <iostream>
 #include <limits>
 #include <string>
 
@@ -74,12 +75,24 @@ double VariableLangevinIntegrator::computeKineticEnergy() {
     return kernel.getAs<IntegrateVariableLangevinStepKernel>().computeKineticEnergy(*context, *this);
 }
 
+void VariableLangevinIntegrator::createCheckpoint(std::ostream& stream) const {
+    double stepSize = getStepSize();
+    stream.write((char*) &stepSize, sizeof(double));
+}
+
+void VariableLangevinIntegrator::loadCheckpoint(std::istream& stream) {
+    double stepSize;
+    stream.read((char*) &stepSize, sizeof(double));
+    setStepSize(stepSize);
+}
+
 void VariableLangevinIntegrator::step(int steps) {
     if (context == NULL)
         throw OpenMMException("This Integrator is not bound to a context!");  
     for (int i = 0; i < steps; ++i) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         setStepSize(kernel.getAs<IntegrateVariableLangevinStepKernel>().execute(*context, *this, std::numeric_limits<double>::infinity()));
     }
 }
@@ -90,6 +103,7 @@ void VariableLangevinIntegrator::stepTo(double time) {
     while (time > context->getTime()) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         setStepSize(kernel.getAs<IntegrateVariableLangevinStepKernel>().execute(*context, *this, time));
     }
 }
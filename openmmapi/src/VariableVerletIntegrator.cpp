@@ -34,6 +34,7 @@
 #include "openmm/OpenMMException.h"
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/kernels.h"
+#include <iostream>
 #include <limits>
 #include <string>
 
@@ -69,12 +70,24 @@ double VariableVerletIntegrator::computeKineticEnergy() {
     return kernel.getAs<IntegrateVariableVerletStepKernel>().computeKineticEnergy(*context, *this);
 }
 
+void VariableVerletIntegrator::createCheckpoint(std::ostream& stream) const {
+    double stepSize = getStepSize();
+    stream.write((char*) &stepSize, sizeof(double));
+}
+
+void VariableVerletIntegrator::loadCheckpoint(std::istream& stream) {
+    double stepSize;
+    stream.read((char*) &stepSize, sizeof(double));
+    setStepSize(stepSize);
+}
+
 void VariableVerletIntegrator::step(int steps) {
     if (context == NULL)
         throw OpenMMException("This Integrator is not bound to a context!");
     for (int i = 0; i < steps; ++i) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         setStepSize(kernel.getAs<IntegrateVariableVerletStepKernel>().execute(*context, *this, std::numeric_limits<double>::infinity()));
     }
 }
@@ -85,6 +98,7 @@ void VariableVerletIntegrator::stepTo(double time) {
     while (time > context->getTime()) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         setStepSize(kernel.getAs<IntegrateVariableVerletStepKernel>().execute(*context, *this, time));
     }
 }
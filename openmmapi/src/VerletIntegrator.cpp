@@ -74,6 +74,7 @@ void VerletIntegrator::step(int steps) {
     for (int i = 0; i < steps; ++i) {
         context->updateContextState();
         context->calcForcesAndEnergy(true, false);
+        TimingRecorder::Scope scope(context->getTimingRecorder(), "Integrator update");
         kernel.getAs<IntegrateVerletStepKernel>().execute(*context, *this);
     }
 }
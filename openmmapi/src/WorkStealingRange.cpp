@@ -0,0 +1,123 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+#include "openmm/internal/WorkStealingRange.h"
+#include "openmm/internal/gmx_atomic.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace OpenMM {
+
+/**
+ * One thread's portion of the range.  next is shared with any threads that steal from this slice.
+ * current is the slice its owner is currently taking work from, and is only used by the owner.
+ * Each Slice fills a full cache line so different threads' slices never share one.
+ */
+class WorkStealingRange::Slice {
+public:
+    gmx_atomic_t next;
+    int end, current;
+    char padding[64-sizeof(gmx_atomic_t)-2*sizeof(int)];
+};
+
+WorkStealingRange::WorkStealingRange() : memory(NULL), slices(NULL), numSlices(0), maxSlices(0), grainSize(1) {
+}
+
+WorkStealingRange::~WorkStealingRange() {
+    if (memory != NULL)
+        delete[] memory;
+}
+
+void WorkStealingRange::reset(int size, int grainSize, int numThreads) {
+    if (numThreads > maxSlices) {
+        if (memory != NULL)
+            delete[] memory;
+        memory = new char[numThreads*sizeof(Slice)+63];
+        char* aligned = memory+63;
+        aligned -= (long long) aligned&63;
+        slices = (Slice*) aligned;
+        maxSlices = numThreads;
+    }
+    numSlices = numThreads;
+    this->grainSize = max(1, grainSize);
+    for (int i = 0; i < numThreads; i++) {
+        gmx_atomic_set(&slices[i].next, (int) ((i*(long long) size)/numThreads));
+        slices[i].end = (int) (((i+1)*(long long) size)/numThreads);
+        slices[i].current = i;
+    }
+}
+
+bool WorkStealingRange::getNextChunk(int threadIndex, int& start, int& end) {
+    Slice& owner = slices[threadIndex];
+    while (true) {
+        Slice& slice = slices[owner.current];
+        if (gmx_atomic_read(&slice.next) < slice.end) {
+            start = gmx_atomic_fetch_add(&slice.next, grainSize);
+            if (start < slice.end) {
+                end = min(start+grainSize, slice.end);
+                return true;
+            }
+        }
+
+        // This slice is finished, so move on to the next one.  Once we get back to our own
+        // slice, every slice has been used up.
+
+        int next = (owner.current+1)%numSlices;
+        if (next == threadIndex)
+            return false;
+        owner.current = next;
+    }
+}
+
+class ParallelForTask : public ThreadPool::Task {
+public:
+    ParallelForTask(WorkStealingRange& range, ParallelForBody& body) : range(range), body(body) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        int start, end;
+        while (range.getNextChunk(threadIndex, start, end))
+            body.execute(start, end, threadIndex);
+    }
+    WorkStealingRange& range;
+    ParallelForBody& body;
+};
+
+void parallelFor(ThreadPool& threads, int size, int grainSize, ParallelForBody& body) {
+    WorkStealingRange range;
+    range.reset(size, grainSize, threads.getNumThreads());
+    ParallelForTask task(range, body);
+    threads.execute(task);
+    threads.waitForThreads();
+}
+
+} // namespace OpenMM
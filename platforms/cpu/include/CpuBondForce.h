@@ -52,6 +52,10 @@ public:
      * Analyze the set of bonds and decide which to compute with each thread.
      */
     void initialize(int numAtoms, int numBonds, int numAtomsPerBond, int** bondAtoms, ThreadPool& threads);
+    /**
+     * Get the atoms involved in the bonds that have been assigned to a thread, in increasing order.
+     */
+    const std::vector<int>& getThreadAtoms(int threadIndex) const;
     /**
      * Compute the forces from all bonds.
      */
@@ -62,6 +66,12 @@ public:
      */
     void threadComputeForce(ThreadPool& threads, int threadIndex, std::vector<OpenMM::RealVec>& atomCoordinates, RealOpenMM** parameters,
             std::vector<OpenMM::RealVec>& forces, RealOpenMM* totalEnergy, ReferenceBondIxn& referenceBondIxn);
+    /**
+     * Compute the forces from bonds that could not be assigned to any single thread.  This must be called
+     * after every thread has finished threadComputeForce().
+     */
+    void computeExtraBonds(std::vector<OpenMM::RealVec>& atomCoordinates, RealOpenMM** parameters, std::vector<OpenMM::RealVec>& forces,
+            RealOpenMM* totalEnergy, ReferenceBondIxn& referenceBondIxn);
 private:
     bool canAssignBond(int bond, int thread, std::vector<int>& atomThread);
     void assignBond(int bond, int thread, std::vector<int>& atomThread, std::vector<int>& bondThread, std::vector<std::set<int> >& atomBonds, std::list<int>& candidateBonds);
@@ -69,6 +79,7 @@ private:
     int** bondAtoms;
     ThreadPool* threads;
     std::vector<std::vector<int> > threadBonds;
+    std::vector<std::vector<int> > threadAtoms;
     std::vector<int> extraBonds;
 };
 
@@ -0,0 +1,115 @@
+#ifndef OPENMM_CPUBONDFORCEQUEUE_H_
+#define OPENMM_CPUBONDFORCEQUEUE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuBondForce.h"
+#include "AlignedArray.h"
+#include "windowsExportCpu.h"
+#include "openmm/internal/ThreadPool.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class collects the bonded forces that need to be computed during a force evaluation, so that all
+ * of them can be computed by the threads at once instead of each one requiring a separate pass.  The work
+ * can also be done by the threads as part of a task that is computing something else, such as direct space
+ * nonbonded interactions, letting small bonded forces be computed alongside them.
+ *
+ * Each force divides its bonds between threads on its own, so different forces may assign the same atom to
+ * different threads.  Each thread therefore accumulates its forces into its own buffer, which is later summed
+ * along with the other per-thread force buffers.  Only the bonds a force could not assign to a single thread
+ * are added directly to the force array.
+ */
+class OPENMM_EXPORT_CPU CpuBondForceQueue {
+public:
+    class ComputeForcesTask;
+    CpuBondForceQueue(int numAtoms, int numThreads);
+    /**
+     * Set the per-thread buffers that forces are accumulated into.  Exactly one of the two arguments should
+     * be non-NULL.  Each buffer holds four elements per atom.
+     */
+    void setThreadForceBuffers(std::vector<AlignedArray<float> >* threadForce, std::vector<AlignedArray<double> >* threadForceDouble);
+    /**
+     * Add a force to the queue.  All arguments must remain valid until the force has been computed.  The
+     * forces from bonds that are computed by individual threads go into the per-thread buffers, while the
+     * forces from the remaining bonds are added to forces.
+     */
+    void addForce(CpuBondForce& bondForce, std::vector<OpenMM::RealVec>& atomCoordinates, RealOpenMM** parameters, std::vector<OpenMM::RealVec>& forces,
+            bool includeEnergy, ReferenceBondIxn& referenceBondIxn);
+    /**
+     * Get whether the queue contains any forces that have not been computed yet.
+     */
+    bool isEmpty() const;
+    /**
+     * Compute this thread's share of every force in the queue.  This is called by each thread of the pool.
+     */
+    void threadComputeForces(ThreadPool& threads, int threadIndex);
+    /**
+     * This is called after every thread has finished threadComputeForces().  It computes the bonds that could not
+     * be assigned to any thread, adds their energy to the total, and empties the queue.
+     */
+    void finishComputation();
+    /**
+     * Compute every force in the queue using the thread pool.
+     */
+    void computeForces(ThreadPool& threads);
+    /**
+     * Get the total energy of all forces that have been computed since the last call to reset().
+     */
+    double getEnergy() const;
+    /**
+     * Empty the queue and set the energy back to zero.
+     */
+    void reset();
+private:
+    struct QueuedForce {
+        CpuBondForce* bondForce;
+        std::vector<OpenMM::RealVec>* atomCoordinates;
+        RealOpenMM** parameters;
+        std::vector<OpenMM::RealVec>* forces;
+        bool includeEnergy;
+        ReferenceBondIxn* referenceBondIxn;
+    };
+    int numAtoms;
+    std::vector<QueuedForce> queue;
+    std::vector<std::vector<OpenMM::RealVec> > threadBondForce;
+    std::vector<AlignedArray<float> >* threadForce;
+    std::vector<AlignedArray<double> >* threadForceDouble;
+    std::vector<RealOpenMM> threadEnergy;
+    double energy;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_CPUBONDFORCEQUEUE_H_*/
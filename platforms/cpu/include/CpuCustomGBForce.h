@@ -25,6 +25,7 @@
 #ifndef OPENMM_CPU_CUSTOM_GB_FORCE_H__
 #define OPENMM_CPU_CUSTOM_GB_FORCE_H__
 
+#include "CpuExclusions.h"
 #include "CpuNeighborList.h"
 #include "lepton/CompiledExpression.h"
 #include "openmm/CustomGBForce.h"
@@ -47,7 +48,7 @@ private:
     const CpuNeighborList* neighborList;
     float periodicBoxSize[3];
     float cutoffDistance, cutoffDistance2;
-    const std::vector<std::set<int> > exclusions;
+    const CpuExclusions exclusions;
     std::vector<std::string> valueNames;
     std::vector<CustomGBForce::ComputationType> valueTypes;
     std::vector<std::string> paramNames;
@@ -185,7 +186,7 @@ public:
      * Construct a new CpuCustomGBForce.
      */
 
-     CpuCustomGBForce(int numAtoms, const std::vector<std::set<int> >& exclusions,
+     CpuCustomGBForce(int numAtoms, const CpuExclusions& exclusions,
                         const std::vector<Lepton::CompiledExpression>& valueExpressions,
                         const std::vector<std::vector<Lepton::CompiledExpression> >& valueDerivExpressions,
                         const std::vector<std::vector<Lepton::CompiledExpression> >& valueGradientExpressions,
@@ -27,6 +27,7 @@
 
 #include "ReferenceForce.h"
 #include "ReferenceBondIxn.h"
+#include "CpuExclusions.h"
 #include "CpuNeighborList.h"
 #include "openmm/CustomManyParticleForce.h"
 #include "openmm/internal/CompiledExpressionSet.h"
@@ -58,7 +59,7 @@ private:
     AlignedArray<fvec4> periodicBoxVec4;
     CpuNeighborList* neighborList;
     ThreadPool& threads;
-    std::vector<std::set<int> > exclusions;
+    CpuExclusions exclusions;
     std::vector<int> particleTypes;
     std::vector<int> orderIndex;
     std::vector<std::vector<int> > particleOrder;
@@ -26,6 +26,7 @@
 #define OPENMM_CPU_CUSTOM_NONBONDED_FORCE_H__
 
 #include "AlignedArray.h"
+#include "CpuExclusions.h"
 #include "CpuNeighborList.h"
 #include "openmm/internal/ThreadPool.h"
 #include "openmm/internal/vectorize.h"
@@ -47,7 +48,7 @@ class CpuCustomNonbondedForce {
          --------------------------------------------------------------------------------------- */
 
        CpuCustomNonbondedForce(const Lepton::CompiledExpression& energyExpression, const Lepton::CompiledExpression& forceExpression,
-                                   const std::vector<std::string>& parameterNames, const std::vector<std::set<int> >& exclusions, ThreadPool& threads);
+                                   const std::vector<std::string>& parameterNames, const CpuExclusions& exclusions, ThreadPool& threads);
 
       /**---------------------------------------------------------------------------------------
 
@@ -134,7 +135,7 @@ private:
     AlignedArray<fvec4> periodicBoxVec4;
     RealOpenMM cutoffDistance, switchingDistance;
     ThreadPool& threads;
-    const std::vector<std::set<int> > exclusions;
+    const CpuExclusions exclusions;
     std::vector<ThreadData*> threadData;
     std::vector<std::string> paramNames;
     std::vector<std::pair<int, int> > groupInteractions;
@@ -0,0 +1,126 @@
+#ifndef OPENMM_CPU_EXCLUSIONS_H_
+#define OPENMM_CPU_EXCLUSIONS_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class stores the exclusions for a set of atoms in compressed sparse row format.  The atoms
+ * excluded from interacting with atom i are stored in sorted order in one flat array, from
+ * getExclusions(i) to getExclusions(i)+getNumExclusions(i).  Compared to a vector of sets, this
+ * uses far less memory and lets an atom's exclusions be scanned without any pointer chasing.
+ */
+class CpuExclusions {
+public:
+    /**
+     * Create an empty object containing no atoms.
+     */
+    CpuExclusions() : offsets(1, 0) {
+    }
+    /**
+     * Create an object for a set of atoms that have no exclusions.
+     */
+    CpuExclusions(int numAtoms) : offsets(numAtoms+1, 0) {
+    }
+    /**
+     * Create an object from a pair list.  Each pair is added in both directions, and duplicates are ignored.
+     */
+    CpuExclusions(int numAtoms, const std::vector<std::pair<int, int> >& pairs) : offsets(numAtoms+1, 0) {
+        std::vector<std::pair<int, int> > sorted;
+        sorted.reserve(2*pairs.size());
+        for (int i = 0; i < (int) pairs.size(); i++) {
+            sorted.push_back(pairs[i]);
+            sorted.push_back(std::make_pair(pairs[i].second, pairs[i].first));
+        }
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        indices.resize(sorted.size());
+        for (int i = 0; i < (int) sorted.size(); i++) {
+            offsets[sorted[i].first+1]++;
+            indices[i] = sorted[i].second;
+        }
+        for (int i = 0; i < numAtoms; i++)
+            offsets[i+1] += offsets[i];
+    }
+    /**
+     * Create an object from a vector of sets, where exclusions[i] contains the atoms excluded from atom i.
+     */
+    CpuExclusions(const std::vector<std::set<int> >& exclusions) : offsets(exclusions.size()+1, 0) {
+        for (int i = 0; i < (int) exclusions.size(); i++)
+            offsets[i+1] = offsets[i]+exclusions[i].size();
+        indices.reserve(offsets.back());
+        for (int i = 0; i < (int) exclusions.size(); i++)
+            indices.insert(indices.end(), exclusions[i].begin(), exclusions[i].end());
+    }
+    /**
+     * Get the number of atoms.
+     */
+    int getNumAtoms() const {
+        return offsets.size()-1;
+    }
+    /**
+     * Get the number of atoms excluded from interacting with an atom.
+     */
+    int getNumExclusions(int atom) const {
+        return offsets[atom+1]-offsets[atom];
+    }
+    /**
+     * Get a pointer to the sorted list of atoms excluded from interacting with an atom.
+     */
+    const int* getExclusions(int atom) const {
+        return (indices.size() == 0 ? NULL : &indices[0]+offsets[atom]);
+    }
+    /**
+     * Get whether the interaction between two atoms is excluded.
+     */
+    bool isExcluded(int atom1, int atom2) const {
+        return std::binary_search(indices.begin()+offsets[atom1], indices.begin()+offsets[atom1+1], atom2);
+    }
+    bool operator==(const CpuExclusions& other) const {
+        return (offsets == other.offsets && indices == other.indices);
+    }
+    bool operator!=(const CpuExclusions& other) const {
+        return !(*this == other);
+    }
+private:
+    std::vector<int> offsets, indices;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_CPU_EXCLUSIONS_H_*/
@@ -27,6 +27,7 @@
 
 #include "AlignedArray.h"
 #include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/WorkStealingRange.h"
 #include "openmm/internal/vectorize.h"
 #include <set>
 #include <utility>
@@ -113,7 +114,7 @@ private:
     float const* posq;
     std::vector<AlignedArray<float> >* threadForce;
     bool includeEnergy;
-    void* atomicCounter;
+    WorkStealingRange blockRange, atomRange;
   
     static const int NUM_TABLE_POINTS;
     static const float TABLE_MIN;
@@ -38,9 +38,15 @@
 #include "CpuCustomNonbondedForce.h"
 #include "CpuGBSAOBCForce.h"
 #include "CpuLangevinDynamics.h"
+#include "CpuMonteCarloBarostat.h"
 #include "CpuNeighborList.h"
 #include "CpuNonbondedForce.h"
 #include "CpuPlatform.h"
+#include "ReferenceAngleBondIxn.h"
+#include "ReferenceKernels.h"
+#include "ReferenceLJCoulomb14.h"
+#include "ReferenceProperDihedralBond.h"
+#include "ReferenceRbDihedralBond.h"
 #include "openmm/kernels.h"
 #include "openmm/System.h"
 
@@ -93,6 +99,80 @@ private:
     std::vector<RealVec> lastPositions;
 };
 
+/**
+ * This kernel provides methods for setting and retrieving various state data.  It extends the reference
+ * version by copying bulk particle data in parallel.
+ */
+class CpuUpdateStateDataKernel : public ReferenceUpdateStateDataKernel {
+public:
+    template <class T, bool toBuffer>
+    class CopyParticleDataTask;
+    CpuUpdateStateDataKernel(std::string name, const Platform& platform, ReferencePlatform::PlatformData& referenceData, CpuPlatform::PlatformData& data) :
+            ReferenceUpdateStateDataKernel(name, platform, referenceData), data(data) {
+    }
+    /**
+     * Copy positions, velocities, or forces for a set of particles into a buffer provided by the caller.
+     *
+     * @param type       the data to retrieve: State::Positions, State::Velocities, or State::Forces
+     * @param buffer     on exit, the three components for the i'th requested particle are stored in
+     *                   buffer[i*stride], buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles
+     * @param particles  the indices of the particles to retrieve.  If this is empty, all particles are retrieved in order.
+     */
+    void getParticleData(ContextImpl& context, State::DataType type, double* buffer, int stride, const std::vector<int>& particles);
+    void getParticleData(ContextImpl& context, State::DataType type, float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Set the positions or velocities of a set of particles from a buffer provided by the caller.
+     *
+     * @param type       the data to set: State::Positions or State::Velocities
+     * @param buffer     the three components for the i'th particle are stored in buffer[i*stride],
+     *                   buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles
+     * @param particles  the indices of the particles to set.  If this is empty, all particles are set in order.
+     */
+    void setParticleData(ContextImpl& context, State::DataType type, const double* buffer, int stride, const std::vector<int>& particles);
+    void setParticleData(ContextImpl& context, State::DataType type, const float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Compute, for every molecule, the displacement that translates its center into the first periodic box.
+     *
+     * @param moleculeStart      the index in moleculeParticles of the first particle in each molecule
+     * @param moleculeParticles  the particles in all molecules, grouped by molecule
+     * @param offsets            on exit, offsets[i] is the displacement to add to every particle in molecule i
+     */
+    void computeMoleculeImages(ContextImpl& context, const std::vector<int>& moleculeStart, const std::vector<int>& moleculeParticles, std::vector<Vec3>& offsets);
+    /**
+     * Get the positions of all particles, with each molecule translated so that its center lies in the
+     * first periodic box.
+     *
+     * @param moleculeStart      the index in moleculeParticles of the first particle in each molecule
+     * @param moleculeParticles  the particles in all molecules, grouped by molecule
+     * @param positions          on exit, this contains the translated particle positions
+     */
+    void getPeriodicPositions(ContextImpl& context, const std::vector<int>& moleculeStart, const std::vector<int>& moleculeParticles, std::vector<Vec3>& positions);
+    /**
+     * Create a checkpoint recording the current state of the Context.
+     * 
+     * @param stream    an output stream the checkpoint data should be written to
+     */
+    void createCheckpoint(ContextImpl& context, std::ostream& stream);
+    /**
+     * Load a checkpoint that was written by createCheckpoint().
+     * 
+     * @param stream    an input stream the checkpoint data should be read from
+     */
+    void loadCheckpoint(ContextImpl& context, std::istream& stream);
+    /**
+     * Load a checkpoint in the format used before checkpoints were divided into tagged sections.
+     * Those do not contain the state of the random number generators, which is left unchanged.
+     * 
+     * @param stream    an input stream the checkpoint data should be read from
+     */
+    void loadLegacyCheckpoint(ContextImpl& context, std::istream& stream);
+private:
+    class MoleculeImageTask;
+    CpuPlatform::PlatformData& data;
+};
+
 /**
  * This kernel is invoked by HarmonicAngleForce to calculate the forces acting on the system and the energy of the system.
  */
@@ -115,7 +195,9 @@ public:
      * @param context        the context in which to execute this kernel
      * @param includeForces  true if forces should be calculated
      * @param includeEnergy  true if the energy should be calculated
-     * @return the potential energy due to the force
+     * @return 0.  The force is only added to the platform's CpuBondForceQueue here.  It is computed, and its
+     * energy returned, along with the nonbonded direct space or by CpuCalcForcesAndEnergyKernel::finishComputation(),
+     * so the time recorded for this Force when timing is enabled is close to zero.
      */
     double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
     /**
@@ -131,6 +213,7 @@ private:
     int **angleIndexArray;
     RealOpenMM **angleParamArray;
     CpuBondForce bondForce;
+    ReferenceAngleBondIxn angleBond;
     bool usePeriodic;
 };
 
@@ -156,7 +239,9 @@ public:
      * @param context        the context in which to execute this kernel
      * @param includeForces  true if forces should be calculated
      * @param includeEnergy  true if the energy should be calculated
-     * @return the potential energy due to the force
+     * @return 0.  The force is only added to the platform's CpuBondForceQueue here.  It is computed, and its
+     * energy returned, along with the nonbonded direct space or by CpuCalcForcesAndEnergyKernel::finishComputation(),
+     * so the time recorded for this Force when timing is enabled is close to zero.
      */
     double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
     /**
@@ -172,6 +257,7 @@ private:
     int **torsionIndexArray;
     RealOpenMM **torsionParamArray;
     CpuBondForce bondForce;
+    ReferenceProperDihedralBond periodicTorsionBond;
     bool usePeriodic;
 };
 
@@ -197,7 +283,9 @@ public:
      * @param context        the context in which to execute this kernel
      * @param includeForces  true if forces should be calculated
      * @param includeEnergy  true if the energy should be calculated
-     * @return the potential energy due to the force
+     * @return 0.  The force is only added to the platform's CpuBondForceQueue here.  It is computed, and its
+     * energy returned, along with the nonbonded direct space or by CpuCalcForcesAndEnergyKernel::finishComputation(),
+     * so the time recorded for this Force when timing is enabled is close to zero.
      */
     double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
     /**
@@ -213,6 +301,7 @@ private:
     int **torsionIndexArray;
     RealOpenMM **torsionParamArray;
     CpuBondForce bondForce;
+    ReferenceRbDihedralBond rbTorsionBond;
     bool usePeriodic;
 };
 
@@ -259,19 +348,37 @@ public:
     void getPMEParameters(double& alpha, int& nx, int& ny, int& nz) const;
 private:
     class PmeIO;
+    /**
+     * Create the optimized PME kernel, using the specified number of threads for it.
+     */
+    void createOptimizedPme(ContextImpl& context, int numPmeThreads);
+    /**
+     * Record the time taken by one evaluation, and decide how many threads to use for PME once enough
+     * evaluations have been timed.  This is used when PmeThreads is "auto".
+     */
+    void tunePmeThreads(double directTime, double reciprocalTime);
+    /**
+     * Record the time the optimized PME kernel spent on each phase of its most recent evaluation.
+     */
+    void recordPmePhaseTimes(ContextImpl& context);
     CpuPlatform::PlatformData& data;
     int numParticles, num14;
+    int pmeThreads, nextPmeThreads, tuningSteps;
+    double tuningDirectTime, tuningReciprocalTime, sequentialTime;
+    bool isTuningPme;
+    std::vector<double> lastPmePhaseTimes;
     int **bonded14IndexArray;
     double **bonded14ParamArray;
     double nonbondedCutoff, switchingDistance, rfDielectric, ewaldAlpha, ewaldSelfEnergy, dispersionCoefficient;
     int kmax[3], gridSize[3];
     bool useSwitchingFunction, useOptimizedPme, hasInitializedPme;
-    std::vector<std::set<int> > exclusions;
+    CpuExclusions exclusions;
     std::vector<std::pair<float, float> > particleParams;
     NonbondedMethod nonbondedMethod;
     CpuNonbondedForce* nonbonded;
     Kernel optimizedPme;
     CpuBondForce bondForce;
+    ReferenceLJCoulomb14 nonbonded14;
 };
 
 /**
@@ -312,7 +419,7 @@ private:
     bool useSwitchingFunction, hasInitializedLongRangeCorrection;
     CustomNonbondedForce* forceCopy;
     std::map<std::string, double> globalParamValues;
-    std::vector<std::set<int> > exclusions;
+    CpuExclusions exclusions;
     std::vector<std::string> parameterNames, globalParameterNames;
     std::vector<std::pair<std::set<int>, std::set<int> > > interactionGroups;
     NonbondedMethod nonbondedMethod;
@@ -396,7 +503,7 @@ private:
     RealOpenMM **particleParamArray;
     RealOpenMM nonbondedCutoff;
     CpuCustomGBForce* ixn;
-    std::vector<std::set<int> > exclusions;
+    CpuExclusions exclusions;
     std::vector<std::string> particleParameterNames, globalParameterNames, valueNames;
     std::vector<OpenMM::CustomGBForce::ComputationType> valueTypes;
     std::vector<OpenMM::CustomGBForce::ComputationType> energyTypes;
@@ -482,6 +589,47 @@ private:
     double prevTemp, prevFriction, prevStepSize;
 };
 
+/**
+ * This kernel is invoked by MonteCarloBarostat and the other Monte Carlo barostats to adjust the periodic box volume.
+ */
+class CpuApplyMonteCarloBarostatKernel : public ApplyMonteCarloBarostatKernel {
+public:
+    CpuApplyMonteCarloBarostatKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : ApplyMonteCarloBarostatKernel(name, platform),
+            data(data), barostat(NULL) {
+    }
+    ~CpuApplyMonteCarloBarostatKernel();
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param barostat   the MonteCarloBarostat this kernel will be used for
+     */
+    void initialize(const System& system, const Force& barostat);
+    /**
+     * Attempt a Monte Carlo step, scaling particle positions (or cluster centers) by a specified value.
+     * This version scales the x, y, and z positions independently.
+     * This is called BEFORE the periodic box size is modified.  It should begin by translating each particle
+     * or cluster into the first periodic box, so that coordinates will still be correct after the box size
+     * is changed.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param scaleX     the scale factor by which to multiply particle x-coordinate
+     * @param scaleY     the scale factor by which to multiply particle y-coordinate
+     * @param scaleZ     the scale factor by which to multiply particle z-coordinate
+     */
+    void scaleCoordinates(ContextImpl& context, double scaleX, double scaleY, double scaleZ);
+    /**
+     * Reject the most recent Monte Carlo step, restoring the particle positions to where they were before
+     * scaleCoordinates() was last called.
+     *
+     * @param context    the context in which to execute this kernel
+     */
+    void restoreCoordinates(ContextImpl& context);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuMonteCarloBarostat* barostat;
+};
+
 } // namespace OpenMM
 
 #endif /*OPENMM_CPUKERNELS_H_*/
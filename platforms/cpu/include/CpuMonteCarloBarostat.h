@@ -0,0 +1,83 @@
+
+/* Portions copyright (c) 2013-2015 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors: 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CPU_MONTE_CARLO_BAROSTAT_H__
+#define __CPU_MONTE_CARLO_BAROSTAT_H__
+
+#include "RealVec.h"
+#include "openmm/internal/ThreadPool.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class performs the coordinate scaling for Monte Carlo barostats, processing molecules in parallel.
+ * Rather than saving a copy of the positions before each trial move, it writes the scaled positions
+ * into a second buffer and swaps it with the position array.  Rejecting the move swaps them back.
+ */
+class CpuMonteCarloBarostat {
+public:
+    class ScaleTask;
+    /**
+     * Constructor.
+     *
+     * @param numAtoms   the number of atoms in the system
+     * @param molecules  the atoms in each molecule
+     * @param threads    thread pool for parallelizing computation
+     */
+    CpuMonteCarloBarostat(int numAtoms, const std::vector<std::vector<int> >& molecules, ThreadPool& threads);
+    /**
+     * Scale the molecule centers.  The old positions are retained so restorePositions() can recover them.
+     *
+     * @param atomPositions      atom positions.  On exit, this contains the scaled positions.
+     * @param boxVectors         the periodic box vectors
+     * @param scaleX             the factor by which to scale atom x-coordinates
+     * @param scaleY             the factor by which to scale atom y-coordinates
+     * @param scaleZ             the factor by which to scale atom z-coordinates
+     */
+    void applyBarostat(std::vector<RealVec>& atomPositions, const RealVec* boxVectors, RealOpenMM scaleX, RealOpenMM scaleY, RealOpenMM scaleZ);
+    /**
+     * Restore atom positions to what they were before applyBarostat() was called.
+     *
+     * @param atomPositions      atom positions
+     */
+    void restorePositions(std::vector<RealVec>& atomPositions);
+private:
+    void threadScaleMolecules(int threadIndex);
+    ThreadPool& threads;
+    std::vector<int> moleculeStart, moleculeAtoms;
+    std::vector<RealVec> otherPositions;
+    bool hasSavedPositions;
+    // The following variables are used to make information accessible to the individual threads.
+    const RealVec* oldPositions;
+    RealVec* newPositions;
+    RealVec boxVectors[3];
+    RealVec scale;
+    void* atomicCounter;
+};
+
+} // namespace OpenMM
+
+#endif // __CPU_MONTE_CARLO_BAROSTAT_H__
@@ -33,11 +33,11 @@
  * -------------------------------------------------------------------------- */
 
 #include "AlignedArray.h"
+#include "CpuExclusions.h"
 #include "RealVec.h"
 #include "windowsExportCpu.h"
-#include "openmm/internal/gmx_atomic.h"
+#include "openmm/internal/WorkStealingRange.h"
 #include "openmm/internal/ThreadPool.h"
-#include <set>
 #include <utility>
 #include <vector>
 
@@ -48,7 +48,7 @@ public:
     class ThreadTask;
     class Voxels;
     CpuNeighborList(int blockSize);
-    void computeNeighborList(int numAtoms, const AlignedArray<float>& atomLocations, const std::vector<std::set<int> >& exclusions,
+    void computeNeighborList(int numAtoms, const AlignedArray<float>& atomLocations, const CpuExclusions& exclusions,
             const RealVec* periodicBoxVectors, bool usePeriodic, float maxDistance, ThreadPool& threads);
     int getNumBlocks() const;
     int getBlockSize() const;
@@ -66,17 +66,19 @@ private:
     std::vector<float> sortedPositions;
     std::vector<std::vector<int> > blockNeighbors;
     std::vector<std::vector<char> > blockExclusions;
+    // Per-thread flags marking excluded atoms.  They are all zero between blocks, so they can be reused across builds.
+    std::vector<std::vector<char> > threadAtomFlags;
     // The following variables are used to make information accessible to the individual threads.
     float minx, maxx, miny, maxy, minz, maxz;
     std::vector<std::pair<int, int> > atomBins;
     Voxels* voxels;
-    const std::vector<std::set<int> >* exclusions;
+    const CpuExclusions* exclusions;
     const float* atomLocations;
     RealVec periodicBoxVectors[3];
     int numAtoms;
     bool usePeriodic;
     float maxDistance;
-    gmx_atomic_t atomicCounter;
+    WorkStealingRange blockRange;
 };
 
 } // namespace OpenMM
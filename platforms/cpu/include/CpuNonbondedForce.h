@@ -26,11 +26,13 @@
 #define OPENMM_CPU_NONBONDED_FORCE_H__
 
 #include "AlignedArray.h"
+#include "CpuBondForceQueue.h"
+#include "CpuExclusions.h"
 #include "CpuNeighborList.h"
 #include "ReferencePairIxn.h"
 #include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/WorkStealingRange.h"
 #include "openmm/internal/vectorize.h"
-#include <set>
 #include <utility>
 #include <vector>
 // ---------------------------------------------------------------------------------------
@@ -114,6 +116,31 @@ class CpuNonbondedForce {
       
       void setUsePME(float alpha, int meshSize[3]);
 
+      /**---------------------------------------------------------------------------------------
+      
+         Set a queue of bonded forces for the threads to compute at the same time as the direct
+         space interactions.  Each thread computes its share of the queued forces before starting
+         on the nonbonded interactions.  The caller is responsible for calling finishComputation()
+         on the queue once calculateDirectIxn() returns.
+      
+         @param queue    the queue to process, or NULL to not compute any bonded forces
+      
+         --------------------------------------------------------------------------------------- */
+      
+      void setBondForceQueue(CpuBondForceQueue* queue);
+
+      /**---------------------------------------------------------------------------------------
+      
+         Set the maximum number of threads from the pool to use for direct space interactions.
+         The remaining threads only compute their share of any queued bonded forces, leaving
+         their cores free for other work such as PME reciprocal space.
+      
+         @param maxThreads    the maximum number of threads to use, or 0 to use all of them
+      
+         --------------------------------------------------------------------------------------- */
+      
+      void setMaxThreads(int maxThreads);
+
       /**---------------------------------------------------------------------------------------
       
          Calculate Ewald ixn
@@ -123,14 +150,14 @@ class CpuNonbondedForce {
          @param atomCoordinates  atom coordinates (in format needed by PME)
          @param atomParameters   atom parameters (sigma/2, 2*sqrt(epsilon))
          @param exclusions       atom exclusion indices
-                                 exclusions[atomIndex] contains the list of exclusions for that atom
+                                 exclusions.getExclusions(atomIndex) contains the list of exclusions for that atom
          @param forces           force array (forces added)
          @param totalEnergy      total energy
             
          --------------------------------------------------------------------------------------- */
           
       void calculateReciprocalIxn(int numberOfAtoms, float* posq, const std::vector<RealVec>& atomCoordinates,
-                            const std::vector<std::pair<float, float> >& atomParameters, const std::vector<std::set<int> >& exclusions,
+                            const std::vector<std::pair<float, float> >& atomParameters, const CpuExclusions& exclusions,
                             std::vector<RealVec>& forces, double* totalEnergy) const;
       
       /**---------------------------------------------------------------------------------------
@@ -142,21 +169,41 @@ class CpuNonbondedForce {
          @param atomCoordinates  atom coordinates (periodic boundary conditions not applied)
          @param atomParameters   atom parameters (sigma/2, 2*sqrt(epsilon))
          @param exclusions       atom exclusion indices
-                                 exclusions[atomIndex] contains the list of exclusions for that atom
-         @param forces           force array (forces added)
+                                 exclusions.getExclusions(atomIndex) contains the list of exclusions for that atom
+         @param threadForce      the per-thread force arrays (forces added)
          @param totalEnergy      total energy
          @param threads          the thread pool to use
       
          --------------------------------------------------------------------------------------- */
           
       void calculateDirectIxn(int numberOfAtoms, float* posq, const std::vector<RealVec>& atomCoordinates, const std::vector<std::pair<float, float> >& atomParameters,
-            const std::vector<std::set<int> >& exclusions, std::vector<AlignedArray<float> >& threadForce, double* totalEnergy, ThreadPool& threads);
+            const CpuExclusions& exclusions, std::vector<AlignedArray<float> >& threadForce, double* totalEnergy, ThreadPool& threads);
+
+      /**
+       * This is identical to the above version, except that the interactions for each block are added
+       * to double precision force arrays.  It is used in mixed precision mode.
+       */
+      void calculateDirectIxn(int numberOfAtoms, float* posq, const std::vector<RealVec>& atomCoordinates, const std::vector<std::pair<float, float> >& atomParameters,
+            const CpuExclusions& exclusions, std::vector<AlignedArray<double> >& threadForce, double* totalEnergy, ThreadPool& threads);
 
     /**
      * This routine contains the code executed by each thread.
      */
     void threadComputeDirect(ThreadPool& threads, int threadIndex);
 
+private:
+    /**
+     * This is called by both versions of calculateDirectIxn() to do the calculation.
+     */
+    void runDirectIxn(int numberOfAtoms, float* posq, const std::vector<RealVec>& atomCoordinates, const std::vector<std::pair<float, float> >& atomParameters,
+            const CpuExclusions& exclusions, double* totalEnergy, ThreadPool& threads);
+
+    /**
+     * Compute this thread's subset of the direct space interactions, adding the forces to the specified array.
+     */
+    template <class FORCE_TYPE>
+    void threadComputeDirect(ThreadPool& threads, int threadIndex, FORCE_TYPE* forces);
+
 protected:
         bool cutoff;
         bool useSwitch;
@@ -166,6 +213,8 @@ protected:
         bool pme;
         bool tableIsValid;
         const CpuNeighborList* neighborList;
+        CpuBondForceQueue* bondForceQueue;
+        int maxThreads, numActiveThreads;
         float recipBoxSize[3];
         RealVec periodicBoxVectors[3];
         AlignedArray<fvec4> periodicBoxVec4;
@@ -182,10 +231,11 @@ protected:
         float* posq;
         RealVec const* atomCoordinates;
         std::pair<float, float> const* atomParameters;        
-        std::set<int> const* exclusions;
+        const CpuExclusions* exclusions;
         std::vector<AlignedArray<float> >* threadForce;
+        std::vector<AlignedArray<double> >* threadForceDouble;
         bool includeEnergy;
-        void* atomicCounter;
+        WorkStealingRange blockRange, exclusionRange;
 
         static const float TWO_OVER_SQRT_PI;
         static const int NUM_TABLE_POINTS;
@@ -201,7 +251,8 @@ protected:
             
          --------------------------------------------------------------------------------------- */
           
-      void calculateOneIxn(int atom1, int atom2, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+      template <class FORCE_TYPE>
+      void calculateOneIxn(int atom1, int atom2, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
             
       /**---------------------------------------------------------------------------------------
       
@@ -214,6 +265,11 @@ protected:
          --------------------------------------------------------------------------------------- */
           
       virtual void calculateBlockIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) = 0;
+
+      /**
+       * Calculate all the interactions for one atom block, adding the forces to a double precision array.
+       */
+      virtual void calculateBlockIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) = 0;
             
       /**---------------------------------------------------------------------------------------
       
@@ -227,6 +283,27 @@ protected:
           
       virtual void calculateBlockEwaldIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) = 0;
 
+      /**
+       * Calculate all the Ewald interactions for one atom block, adding the forces to a double precision array.
+       */
+      virtual void calculateBlockEwaldIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) = 0;
+
+      /**
+       * Add a force to an atom in a single precision force array.
+       */
+      static void addForce(float* forces, int atom, const fvec4& f) {
+          (fvec4(forces+4*atom)+f).store(forces+4*atom);
+      }
+
+      /**
+       * Add a force to an atom in a double precision force array.
+       */
+      static void addForce(double* forces, int atom, const fvec4& f) {
+          forces[4*atom] += f[0];
+          forces[4*atom+1] += f[1];
+          forces[4*atom+2] += f[2];
+      }
+
       /**
        * Compute the displacement and squared distance between two points, optionally using
        * periodic boundary conditions.
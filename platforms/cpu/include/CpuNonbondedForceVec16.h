@@ -0,0 +1,125 @@
+
+/* Portions copyright (c) 2006-2016 Stanford University and Simbios.
+ * Contributors: Pande Group
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef OPENMM_CPU_NONBONDED_FORCE_VEC16_H__
+#define OPENMM_CPU_NONBONDED_FORCE_VEC16_H__
+
+#include "CpuNonbondedForce.h"
+
+#ifdef __AVX512F__
+
+#include "openmm/internal/vectorize16.h"
+
+// ---------------------------------------------------------------------------------------
+
+namespace OpenMM {
+
+/**
+ * This class computes nonbonded interactions with AVX-512.  It uses the same blocks of eight atoms
+ * as CpuNonbondedForceVec8, but pairs each block with two neighbors at a time so that all sixteen
+ * vector lanes are used.
+ */
+class CpuNonbondedForceVec16 : public CpuNonbondedForce {
+public:
+       CpuNonbondedForceVec16();
+
+protected:            
+      /**---------------------------------------------------------------------------------------
+      
+         Calculate all the interactions for one atom block.
+      
+         @param blockIndex       the index of the atom block
+         @param forces           force array (forces added)
+         @param totalEnergy      total energy
+            
+         --------------------------------------------------------------------------------------- */
+          
+      void calculateBlockIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      void calculateBlockIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      /**
+       * Select the version of calculateBlockIxnImpl() to use based on the periodic boundary conditions.
+       */
+      template <class FORCE_TYPE>
+      void computeBlockIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+      
+      /**
+       * Templatized implementation of calculateBlockIxn.
+       */
+      template <int PERIODIC_TYPE, class FORCE_TYPE>
+      void calculateBlockIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
+            
+      /**---------------------------------------------------------------------------------------
+      
+         Calculate all the interactions for one atom block.
+      
+         @param blockIndex       the index of the atom block
+         @param forces           force array (forces added)
+         @param totalEnergy      total energy
+            
+         --------------------------------------------------------------------------------------- */
+          
+      void calculateBlockEwaldIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      void calculateBlockEwaldIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      /**
+       * Select the version of calculateBlockEwaldIxnImpl() to use based on the periodic boundary conditions.
+       */
+      template <class FORCE_TYPE>
+      void computeBlockEwaldIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      /**
+       * Templatized implementation of calculateBlockEwaldIxn.
+       */
+      template <int PERIODIC_TYPE, class FORCE_TYPE>
+      void calculateBlockEwaldIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
+
+      /**
+       * Compute the displacement and squared distance between a collection of points, optionally using
+       * periodic boundary conditions.  The lower half of each vector is relative to posI1, and the upper
+       * half is relative to posI2.
+       */
+      template <int PERIODIC_TYPE>
+      void getDeltaR(const fvec4& posI1, const fvec4& posI2, const fvec16& x, const fvec16& y, const fvec16& z, fvec16& dx, fvec16& dy, fvec16& dz, fvec16& r2, bool periodic, const fvec4& boxSize, const fvec4& invBoxSize) const;
+
+      /**
+       * Compute a fast approximation to erfc(x).
+       */
+      fvec16 erfcApprox(const fvec16& x);
+      
+      /**
+       * Evaluate the scale factor used with Ewald and PME: erfc(alpha*r) + 2*alpha*r*exp(-alpha*alpha*r*r)/sqrt(PI)
+       */
+      fvec16 ewaldScaleFunction(const fvec16& x);
+};
+
+} // namespace OpenMM
+
+// ---------------------------------------------------------------------------------------
+
+#endif // __AVX512F__
+
+#endif // OPENMM_CPU_NONBONDED_FORCE_VEC16_H__
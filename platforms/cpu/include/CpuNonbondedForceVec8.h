@@ -51,12 +51,20 @@ protected:
          --------------------------------------------------------------------------------------- */
           
       void calculateBlockIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      void calculateBlockIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      /**
+       * Select the version of calculateBlockIxnImpl() to use based on the periodic boundary conditions.
+       */
+      template <class FORCE_TYPE>
+      void computeBlockIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
       
       /**
        * Templatized implementation of calculateBlockIxn.
        */
-      template <int PERIODIC_TYPE>
-      void calculateBlockIxnImpl(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
+      template <int PERIODIC_TYPE, class FORCE_TYPE>
+      void calculateBlockIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
             
       /**---------------------------------------------------------------------------------------
       
@@ -70,11 +78,19 @@ protected:
           
       void calculateBlockEwaldIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
 
+      void calculateBlockEwaldIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
+      /**
+       * Select the version of calculateBlockEwaldIxnImpl() to use based on the periodic boundary conditions.
+       */
+      template <class FORCE_TYPE>
+      void computeBlockEwaldIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
+
       /**
        * Templatized implementation of calculateBlockEwaldIxn.
        */
-      template <int PERIODIC_TYPE>
-      void calculateBlockEwaldIxnImpl(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
+      template <int PERIODIC_TYPE, class FORCE_TYPE>
+      void calculateBlockEwaldIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
 
       /**
        * Compute the displacement and squared distance between a collection of points, optionally using
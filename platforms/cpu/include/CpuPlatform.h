@@ -33,6 +33,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "AlignedArray.h"
+#include "CpuBondForceQueue.h"
 #include "CpuRandom.h"
 #include "CpuNeighborList.h"
 #include "ReferencePlatform.h"
@@ -68,6 +69,43 @@ public:
         static const std::string key = "Threads";
         return key;
     }
+    /**
+     * This is the name of the parameter for selecting what numeric precision to use.  The allowed
+     * values are "single", "mixed", and "double".
+     */
+    static const std::string& CpuPrecision() {
+        static const std::string key = "Precision";
+        return key;
+    }
+    /**
+     * This is the name of the parameter for selecting whether idle threads should spin for a short time
+     * before blocking while they wait for the next task.  The allowed values are "true" and "false".
+     */
+    static const std::string& CpuSpinWait() {
+        static const std::string key = "SpinWait";
+        return key;
+    }
+    /**
+     * This is the name of the parameter for selecting how to bind threads to processors.  The allowed values
+     * are "none" (let the operating system schedule threads), "compact" (fill each core and socket before
+     * using the next one), "scatter" (spread threads across sockets and cores), or an explicit list of logical
+     * processor indices such as "0,2,4-7".
+     */
+    static const std::string& CpuThreadAffinity() {
+        static const std::string key = "ThreadAffinity";
+        return key;
+    }
+    /**
+     * This is the name of the parameter for selecting how many threads compute PME reciprocal space.  If it is
+     * less than the total number of threads, reciprocal space is computed at the same time as direct space, which
+     * uses the remaining threads.  If it equals the total number of threads, the two are computed one after the
+     * other using all threads, which is the default.  The value "auto" selects whichever is faster based on timing
+     * the first few steps.
+     */
+    static const std::string& CpuPmeThreads() {
+        static const std::string key = "PmeThreads";
+        return key;
+    }
     /**
      * We cannot use the standard mechanism for platform data, because that is already used by the superclass.
      * Instead, we maintain a table of ContextImpls to PlatformDatas.
@@ -80,19 +118,23 @@ private:
 
 class CpuPlatform::PlatformData {
 public:
-    PlatformData(int numParticles, int numThreads);
+    PlatformData(int numParticles, int numThreads, const std::string& precision, bool spinWait, const std::string& threadAffinity, const std::string& pmeThreads);
     ~PlatformData();
-    void requestNeighborList(double cutoffDistance, double padding, bool useExclusions, std::vector<std::set<int> >& exclusionList);
+    void requestNeighborList(double cutoffDistance, double padding, bool useExclusions, const CpuExclusions& exclusionList);
     AlignedArray<float> posq;
     std::vector<AlignedArray<float> > threadForce;
+    std::vector<AlignedArray<double> > threadForceDouble;
+    std::vector<float*> extraForces;
     ThreadPool threads;
-    bool isPeriodic;
+    CpuBondForceQueue bondForceQueue;
+    bool isPeriodic, useMixedPrecision, useDoublePrecision;
+    int pmeThreads;
     CpuRandom random;
     std::map<std::string, std::string> propertyValues;
     CpuNeighborList* neighborList;
     double cutoff, paddedCutoff;
-    bool anyExclusions;
-    std::vector<std::set<int> > exclusions;
+    bool anyExclusions, rebuildNeighborList;
+    CpuExclusions exclusions;
 };
 
 } // namespace OpenMM
@@ -34,6 +34,7 @@
 
 #include "sfmt/SFMT.h"
 #include "windowsExportCpu.h"
+#include <iosfwd>
 #include <vector>
 
 namespace OpenMM {
@@ -48,6 +49,14 @@ public:
     void initialize(int seed, int numThreads);
     float getGaussianRandom(int threadIndex);
     float getUniformRandom(int threadIndex);
+    /**
+     * Write the state of all the generators to a checkpoint.
+     */
+    void createCheckpoint(std::ostream& stream);
+    /**
+     * Restore the state of the generators from a checkpoint written by createCheckpoint().
+     */
+    void loadCheckpoint(std::istream& stream);
 private:
     bool hasInitialized;
     int randomSeed;
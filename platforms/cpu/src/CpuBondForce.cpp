@@ -151,6 +151,13 @@ void CpuBondForce::initialize(int numAtoms, int numBonds, int numAtomsPerBond, i
             }
         }
     }
+    
+    // Record the atoms each thread modifies.
+    
+    threadAtoms.resize(numThreads);
+    for (int atom = 0; atom < numAtoms; atom++)
+        if (atomThread[atom] != -1)
+            threadAtoms[atomThread[atom]].push_back(atom);
 }
 
 bool CpuBondForce::canAssignBond(int bond, int thread, vector<int>& atomThread) {
@@ -183,6 +190,10 @@ void CpuBondForce::assignBond(int bond, int thread, vector<int>& atomThread, vec
     }
 }
 
+const vector<int>& CpuBondForce::getThreadAtoms(int threadIndex) const {
+    return threadAtoms[threadIndex];
+}
+
 void CpuBondForce::calculateForce(vector<RealVec>& atomCoordinates, RealOpenMM** parameters, vector<RealVec>& forces, 
         RealOpenMM* totalEnergy, ReferenceBondIxn& referenceBondIxn) {
     // Have the worker threads compute their forces.
@@ -191,13 +202,7 @@ void CpuBondForce::calculateForce(vector<RealVec>& atomCoordinates, RealOpenMM**
     ComputeForceTask task(*this, atomCoordinates, parameters, forces, threadEnergy, totalEnergy, referenceBondIxn);
     threads->execute(task);
     threads->waitForThreads();
-    
-    // Compute any "extra" bonds.
-    
-    for (int i = 0; i < extraBonds.size(); i++) {
-        int bond = extraBonds[i];
-        referenceBondIxn.calculateBondIxn(bondAtoms[bond], atomCoordinates, parameters[bond], forces, totalEnergy);
-    }
+    computeExtraBonds(atomCoordinates, parameters, forces, totalEnergy, referenceBondIxn);
 
     // Compute the total energy.
     
@@ -214,4 +219,12 @@ void CpuBondForce::threadComputeForce(ThreadPool& threads, int threadIndex, vect
         int bond = bonds[i];
         referenceBondIxn.calculateBondIxn(bondAtoms[bond], atomCoordinates, parameters[bond], forces, totalEnergy);
     }
-}
\ No newline at end of file
+}
+
+void CpuBondForce::computeExtraBonds(vector<RealVec>& atomCoordinates, RealOpenMM** parameters, vector<RealVec>& forces,
+            RealOpenMM* totalEnergy, ReferenceBondIxn& referenceBondIxn) {
+    for (int i = 0; i < extraBonds.size(); i++) {
+        int bond = extraBonds[i];
+        referenceBondIxn.calculateBondIxn(bondAtoms[bond], atomCoordinates, parameters[bond], forces, totalEnergy);
+    }
+}
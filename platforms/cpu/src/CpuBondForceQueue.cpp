@@ -0,0 +1,145 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+#include "CpuBondForceQueue.h"
+
+using namespace OpenMM;
+using namespace std;
+
+class CpuBondForceQueue::ComputeForcesTask : public ThreadPool::Task {
+public:
+    ComputeForcesTask(CpuBondForceQueue& owner) : owner(owner) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        owner.threadComputeForces(threads, threadIndex);
+    }
+    CpuBondForceQueue& owner;
+};
+
+CpuBondForceQueue::CpuBondForceQueue(int numAtoms, int numThreads) : numAtoms(numAtoms), threadBondForce(numThreads), threadForce(NULL),
+        threadForceDouble(NULL), threadEnergy(numThreads, 0), energy(0.0) {
+}
+
+void CpuBondForceQueue::setThreadForceBuffers(vector<AlignedArray<float> >* threadForce, vector<AlignedArray<double> >* threadForceDouble) {
+    this->threadForce = threadForce;
+    this->threadForceDouble = threadForceDouble;
+}
+
+void CpuBondForceQueue::addForce(CpuBondForce& bondForce, vector<RealVec>& atomCoordinates, RealOpenMM** parameters, vector<RealVec>& forces,
+        bool includeEnergy, ReferenceBondIxn& referenceBondIxn) {
+    QueuedForce force;
+    force.bondForce = &bondForce;
+    force.atomCoordinates = &atomCoordinates;
+    force.parameters = parameters;
+    force.forces = &forces;
+    force.includeEnergy = includeEnergy;
+    force.referenceBondIxn = &referenceBondIxn;
+    queue.push_back(force);
+}
+
+bool CpuBondForceQueue::isEmpty() const {
+    return queue.empty();
+}
+
+void CpuBondForceQueue::threadComputeForces(ThreadPool& threads, int threadIndex) {
+    if (queue.empty())
+        return;
+    
+    // The buffer is allocated by the thread that uses it, and is left zeroed after every force.
+    
+    vector<RealVec>& bondForce = threadBondForce[threadIndex];
+    if (bondForce.size() != numAtoms)
+        bondForce.resize(numAtoms, RealVec());
+    for (int i = 0; i < (int) queue.size(); i++) {
+        QueuedForce& force = queue[i];
+        RealOpenMM* energyPtr = (force.includeEnergy ? &threadEnergy[threadIndex] : NULL);
+        force.bondForce->threadComputeForce(threads, threadIndex, *force.atomCoordinates, force.parameters, bondForce, energyPtr, *force.referenceBondIxn);
+        
+        // Move the forces into this thread's force buffer.
+        
+        const vector<int>& atoms = force.bondForce->getThreadAtoms(threadIndex);
+        int numThreadAtoms = atoms.size();
+        if (threadForceDouble != NULL) {
+            double* f = &(*threadForceDouble)[threadIndex][0];
+            for (int j = 0; j < numThreadAtoms; j++) {
+                int atom = atoms[j];
+                f[4*atom] += bondForce[atom][0];
+                f[4*atom+1] += bondForce[atom][1];
+                f[4*atom+2] += bondForce[atom][2];
+                bondForce[atom] = RealVec();
+            }
+        }
+        else {
+            float* f = &(*threadForce)[threadIndex][0];
+            for (int j = 0; j < numThreadAtoms; j++) {
+                int atom = atoms[j];
+                f[4*atom] += (float) bondForce[atom][0];
+                f[4*atom+1] += (float) bondForce[atom][1];
+                f[4*atom+2] += (float) bondForce[atom][2];
+                bondForce[atom] = RealVec();
+            }
+        }
+    }
+}
+
+void CpuBondForceQueue::finishComputation() {
+    RealOpenMM extraEnergy = 0;
+    for (int i = 0; i < (int) queue.size(); i++) {
+        QueuedForce& force = queue[i];
+        RealOpenMM* energyPtr = (force.includeEnergy ? &extraEnergy : NULL);
+        force.bondForce->computeExtraBonds(*force.atomCoordinates, force.parameters, *force.forces, energyPtr, *force.referenceBondIxn);
+    }
+    energy += extraEnergy;
+    for (int i = 0; i < (int) threadEnergy.size(); i++) {
+        energy += threadEnergy[i];
+        threadEnergy[i] = 0;
+    }
+    queue.clear();
+}
+
+void CpuBondForceQueue::computeForces(ThreadPool& threads) {
+    ComputeForcesTask task(*this);
+    threads.execute(task);
+    threads.waitForThreads();
+    finishComputation();
+}
+
+double CpuBondForceQueue::getEnergy() const {
+    return energy;
+}
+
+void CpuBondForceQueue::reset() {
+    queue.clear();
+    for (int i = 0; i < (int) threadEnergy.size(); i++)
+        threadEnergy[i] = 0;
+    energy = 0.0;
+}
@@ -103,7 +103,7 @@ CpuCustomGBForce::ThreadData::ThreadData(int numAtoms, int numThreads, int threa
     dVdR2.resize(valueDerivExpressions.size());
 }
 
-CpuCustomGBForce::CpuCustomGBForce(int numAtoms, const std::vector<std::set<int> >& exclusions,
+CpuCustomGBForce::CpuCustomGBForce(int numAtoms, const CpuExclusions& exclusions,
                      const vector<Lepton::CompiledExpression>& valueExpressions,
                      const vector<vector<Lepton::CompiledExpression> >& valueDerivExpressions,
                      const vector<vector<Lepton::CompiledExpression> >& valueGradientExpressions,
@@ -303,7 +303,7 @@ void CpuCustomGBForce::calculateParticlePairValue(int index, ThreadData& data, i
                 for (int k = 0; k < blockSize; k++) {
                     if ((blockExclusions[i] & (1<<k)) == 0) {
                         int second = blockAtom[k];
-                        if (useExclusions && exclusions[first].find(second) != exclusions[first].end())
+                        if (useExclusions && exclusions.isExcluded(first, second))
                             continue;
                         calculateOnePairValue(index, first, second, data, posq, atomParameters, valueArray, boxSize, invBoxSize);
                         calculateOnePairValue(index, second, first, data, posq, atomParameters, valueArray, boxSize, invBoxSize);
@@ -320,7 +320,7 @@ void CpuCustomGBForce::calculateParticlePairValue(int index, ThreadData& data, i
             if (i >= numAtoms)
                 break;
             for (int j = i+1; j < numAtoms; j++) {
-                if (useExclusions && exclusions[i].find(j) != exclusions[i].end())
+                if (useExclusions && exclusions.isExcluded(i, j))
                     continue;
                 calculateOnePairValue(index, i, j, data, posq, atomParameters, valueArray, boxSize, invBoxSize);
                 calculateOnePairValue(index, j, i, data, posq, atomParameters, valueArray, boxSize, invBoxSize);
@@ -389,7 +389,7 @@ void CpuCustomGBForce::calculateParticlePairEnergyTerm(int index, ThreadData& da
                 for (int k = 0; k < blockSize; k++) {
                     if ((blockExclusions[i] & (1<<k)) == 0) {
                         int second = blockAtom[k];
-                        if (useExclusions && exclusions[first].find(second) != exclusions[first].end())
+                        if (useExclusions && exclusions.isExcluded(first, second))
                             continue;
                         calculateOnePairEnergyTerm(index, first, second, data, posq, atomParameters, forces, totalEnergy, boxSize, invBoxSize);
                     }
@@ -405,7 +405,7 @@ void CpuCustomGBForce::calculateParticlePairEnergyTerm(int index, ThreadData& da
             if (i >= numAtoms)
                 break;
             for (int j = i+1; j < numAtoms; j++) {
-                if (useExclusions && exclusions[i].find(j) != exclusions[i].end())
+                if (useExclusions && exclusions.isExcluded(i, j))
                     continue;
                 calculateOnePairEnergyTerm(index, i, j, data, posq, atomParameters, forces, totalEnergy, boxSize, invBoxSize);
            }
@@ -471,7 +471,7 @@ void CpuCustomGBForce::calculateChainRuleForces(ThreadData& data, int numAtoms,
                 for (int k = 0; k < blockSize; k++) {
                     if ((blockExclusions[i] & (1<<k)) == 0) {
                         int second = blockAtom[k];
-                        bool isExcluded = (exclusions[first].find(second) != exclusions[first].end());
+                        bool isExcluded = (exclusions.isExcluded(first, second));
                         calculateOnePairChainRule(first, second, data, posq, atomParameters, forces, isExcluded, boxSize, invBoxSize);
                         calculateOnePairChainRule(second, first, data, posq, atomParameters, forces, isExcluded, boxSize, invBoxSize);
                     }
@@ -487,7 +487,7 @@ void CpuCustomGBForce::calculateChainRuleForces(ThreadData& data, int numAtoms,
             if (i >= numAtoms)
                 break;
             for (int j = i+1; j < numAtoms; j++) {
-                bool isExcluded = (exclusions[i].find(j) != exclusions[i].end());
+                bool isExcluded = (exclusions.isExcluded(i, j));
                 calculateOnePairChainRule(i, j, data, posq, atomParameters, forces, isExcluded, boxSize, invBoxSize);
                 calculateOnePairChainRule(j, i, data, posq, atomParameters, forces, isExcluded, boxSize, invBoxSize);
            }
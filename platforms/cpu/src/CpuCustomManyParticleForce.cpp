@@ -78,13 +78,13 @@ CpuCustomManyParticleForce::CpuCustomManyParticleForce(const CustomManyParticleF
     
     // Record exclusions.
     
-    exclusions.resize(force.getNumParticles());
+    vector<pair<int, int> > excludedPairs;
     for (int i = 0; i < (int) force.getNumExclusions(); i++) {
         int p1, p2;
         force.getExclusionParticles(i, p1, p2);
-        exclusions[p1].insert(p2);
-        exclusions[p2].insert(p1);
+        excludedPairs.push_back(make_pair(p1, p2));
     }
+    exclusions = CpuExclusions(force.getNumParticles(), excludedPairs);
     
     // Record information about type filters.
     
@@ -241,7 +241,7 @@ void CpuCustomManyParticleForce::loopOverInteractions(vector<int>& availablePart
             }
         }
         for (int j = 0; j < loopIndex && include; j++)
-            include &= (exclusions[particle].find(particleSet[j]) == exclusions[particle].end());
+            include &= !exclusions.isExcluded(particle, particleSet[j]);
         if (include) {
             if (loopIndex > 0 && availableParticles[i] == particleSet[0])
                 continue;
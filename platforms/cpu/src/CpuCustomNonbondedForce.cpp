@@ -58,7 +58,7 @@ CpuCustomNonbondedForce::ThreadData::ThreadData(const Lepton::CompiledExpression
 }
 
 CpuCustomNonbondedForce::CpuCustomNonbondedForce(const Lepton::CompiledExpression& energyExpression,
-            const Lepton::CompiledExpression& forceExpression, const vector<string>& parameterNames, const vector<set<int> >& exclusions,ThreadPool& threads) :
+            const Lepton::CompiledExpression& forceExpression, const vector<string>& parameterNames, const CpuExclusions& exclusions, ThreadPool& threads) :
             cutoff(false), useSwitch(false), periodic(false), paramNames(parameterNames), exclusions(exclusions), threads(threads) {
     for (int i = 0; i < threads.getNumThreads(); i++)
         threadData.push_back(new ThreadData(energyExpression, forceExpression, parameterNames));
@@ -81,7 +81,7 @@ void CpuCustomNonbondedForce::setInteractionGroups(const vector<pair<set<int>, s
         const set<int>& set2 = groups[group].second;
         for (set<int>::const_iterator atom1 = set1.begin(); atom1 != set1.end(); ++atom1) {
             for (set<int>::const_iterator atom2 = set2.begin(); atom2 != set2.end(); ++atom2) {
-                if (*atom1 == *atom2 || exclusions[*atom1].find(*atom2) != exclusions[*atom1].end())
+                if (*atom1 == *atom2 || exclusions.isExcluded(*atom1, *atom2))
                     continue; // This is an excluded interaction.
                 if (*atom1 > *atom2 && set1.find(*atom2) != set1.end() && set2.find(*atom1) != set2.end())
                     continue; // Both atoms are in both sets, so skip duplicate interactions.
@@ -220,8 +220,14 @@ void CpuCustomNonbondedForce::threadComputeForce(ThreadPool& threads, int thread
             int ii = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
             if (ii >= numberOfAtoms)
                 break;
+            const int* nextExclusion = exclusions.getExclusions(ii);
+            const int* lastExclusion = nextExclusion+exclusions.getNumExclusions(ii);
+            while (nextExclusion != lastExclusion && *nextExclusion <= ii)
+                nextExclusion++;
             for (int jj = ii+1; jj < numberOfAtoms; jj++) {
-                if (exclusions[jj].find(ii) == exclusions[jj].end()) {
+                if (nextExclusion != lastExclusion && *nextExclusion == jj)
+                    nextExclusion++;
+                else {
                     for (int j = 0; j < (int) paramNames.size(); j++) {
                         ReferenceForce::setVariable(data.energyParticleParams[j*2], atomParameters[ii][j]);
                         ReferenceForce::setVariable(data.energyParticleParams[j*2+1], atomParameters[jj][j]);
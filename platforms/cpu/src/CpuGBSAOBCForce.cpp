@@ -25,7 +25,6 @@
 #include "CpuGBSAOBCForce.h"
 #include "SimTKOpenMMRealType.h"
 #include "openmm/internal/vectorize.h"
-#include "openmm/internal/gmx_atomic.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -102,22 +101,19 @@ void CpuGBSAOBCForce::computeForce(const AlignedArray<float>& posq, vector<Align
     threadBornForces.resize(numThreads);
     for (int i = 0; i < numThreads; i++)
         threadBornForces[i].resize(particleParams.size()+3);
-    gmx_atomic_t counter;
-    this->atomicCounter = &counter;
+    int numBlocks = (particleParams.size()+3)/4;
     
     // Signal the threads to start running and wait for them to finish.
     
     ComputeTask task(*this);
-    gmx_atomic_set(&counter, 0);
+    blockRange.reset(numBlocks, 1, numThreads);
     threads.execute(task);
     threads.waitForThreads(); // Compute Born radii
-    gmx_atomic_set(&counter, 0);
+    atomRange.reset(particleParams.size(), 16, numThreads);
+    blockRange.reset(numBlocks, 1, numThreads);
     threads.resumeThreads();
-    threads.waitForThreads(); // Compute surface area term
-    gmx_atomic_set(&counter, 0);
-    threads.resumeThreads();
-    threads.waitForThreads(); // First loop
-    gmx_atomic_set(&counter, 0);
+    threads.waitForThreads(); // Compute surface area term and first loop
+    blockRange.reset(numBlocks, 1, numThreads);
     threads.resumeThreads();
     threads.waitForThreads(); // Second loop
     
@@ -140,74 +136,73 @@ void CpuGBSAOBCForce::threadComputeForce(ThreadPool& threads, int threadIndex) {
     const float gammaObc = 4.85f;
     fvec4 boxSize(periodicBoxSize[0], periodicBoxSize[1], periodicBoxSize[2], 0);
     fvec4 invBoxSize((1/periodicBoxSize[0]), (1/periodicBoxSize[1]), (1/periodicBoxSize[2]), 0);
-    int start = (threadIndex*numParticles)/numThreads;
-    int end = ((threadIndex+1)*numParticles)/numThreads;
+    int start, end;
 
     // Calculate Born radii
 
-    while (true) {
-        int blockStart = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 4);
-        if (blockStart >= numParticles)
-            break;
-        int numInBlock = min(4, numParticles-blockStart);
-        ivec4 blockAtomIndex(blockStart, blockStart+1, blockStart+2, blockStart+3);
-        float atomRadius[4], atomx[4], atomy[4], atomz[4];
-        int blockMask[4] = {0, 0, 0, 0};
-        for (int i = 0; i < numInBlock; i++) {
-            int atomIndex = blockStart+i;
-            atomRadius[i] = particleParams[atomIndex].first;
-            atomx[i] = posq[4*atomIndex];
-            atomy[i] = posq[4*atomIndex+1];
-            atomz[i] = posq[4*atomIndex+2];
-            blockMask[i] = 0xFFFFFFFF;
-        }
-        fvec4 offsetRadiusI(atomRadius);
-        fvec4 radiusIInverse = 1.0f/offsetRadiusI;
-        fvec4 x(atomx);
-        fvec4 y(atomy);
-        fvec4 z(atomz);
-        ivec4 mask(blockMask);
-        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-        for (int atomJ = 0; atomJ < numParticles; atomJ++) {
-            fvec4 posJ(posq+4*atomJ);
-            fvec4 dx, dy, dz, r2;
-            getDeltaR(posJ, x, y, z, dx, dy, dz, r2, periodic, boxSize, invBoxSize);
-            ivec4 include = mask & (blockAtomIndex != ivec4(atomJ));
-            if (cutoff)
-                include = include & (r2 < cutoffDistance*cutoffDistance);
-            if (!any(include))
-                continue;
-            fvec4 r = sqrt(r2);
-            float scaledRadiusJ = particleParams[atomJ].second;
-            float scaledRadiusJ2 = scaledRadiusJ*scaledRadiusJ;
-            fvec4 rScaledRadiusJ = r + scaledRadiusJ;
-            include = include & (offsetRadiusI < rScaledRadiusJ);
-            fvec4 l_ij = 1.0f/max(offsetRadiusI, abs(r-scaledRadiusJ));
-            fvec4 u_ij = 1.0f/rScaledRadiusJ;
-            fvec4 l_ij2 = l_ij*l_ij;
-            fvec4 u_ij2 = u_ij*u_ij;
-            fvec4 rInverse = 1.0f/r;
-            fvec4 r2Inverse = rInverse*rInverse;
-            fvec4 logRatio = fastLog(u_ij/l_ij);
-            fvec4 term = l_ij - u_ij + 0.25f*r*(u_ij2 - l_ij2) + (0.5f*rInverse*logRatio) + (0.25f*scaledRadiusJ*scaledRadiusJ*rInverse)*(l_ij2 - u_ij2);
-            for (int j = 0; j < 4; j++) {
-                if (include[j]) {
-                    sum[j] += term[j];
-                    if (offsetRadiusI[j] < scaledRadiusJ-r[j])
-                        sum[j] += 2.0f*(radiusIInverse[j]-l_ij[j]);
+    while (blockRange.getNextChunk(threadIndex, start, end)) {
+        for (int block = start; block < end; block++) {
+            int blockStart = 4*block;
+            int numInBlock = min(4, numParticles-blockStart);
+            ivec4 blockAtomIndex(blockStart, blockStart+1, blockStart+2, blockStart+3);
+            float atomRadius[4], atomx[4], atomy[4], atomz[4];
+            int blockMask[4] = {0, 0, 0, 0};
+            for (int i = 0; i < numInBlock; i++) {
+                int atomIndex = blockStart+i;
+                atomRadius[i] = particleParams[atomIndex].first;
+                atomx[i] = posq[4*atomIndex];
+                atomy[i] = posq[4*atomIndex+1];
+                atomz[i] = posq[4*atomIndex+2];
+                blockMask[i] = 0xFFFFFFFF;
+            }
+            fvec4 offsetRadiusI(atomRadius);
+            fvec4 radiusIInverse = 1.0f/offsetRadiusI;
+            fvec4 x(atomx);
+            fvec4 y(atomy);
+            fvec4 z(atomz);
+            ivec4 mask(blockMask);
+            float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int atomJ = 0; atomJ < numParticles; atomJ++) {
+                fvec4 posJ(posq+4*atomJ);
+                fvec4 dx, dy, dz, r2;
+                getDeltaR(posJ, x, y, z, dx, dy, dz, r2, periodic, boxSize, invBoxSize);
+                ivec4 include = mask & (blockAtomIndex != ivec4(atomJ));
+                if (cutoff)
+                    include = include & (r2 < cutoffDistance*cutoffDistance);
+                if (!any(include))
+                    continue;
+                fvec4 r = sqrt(r2);
+                float scaledRadiusJ = particleParams[atomJ].second;
+                float scaledRadiusJ2 = scaledRadiusJ*scaledRadiusJ;
+                fvec4 rScaledRadiusJ = r + scaledRadiusJ;
+                include = include & (offsetRadiusI < rScaledRadiusJ);
+                fvec4 l_ij = 1.0f/max(offsetRadiusI, abs(r-scaledRadiusJ));
+                fvec4 u_ij = 1.0f/rScaledRadiusJ;
+                fvec4 l_ij2 = l_ij*l_ij;
+                fvec4 u_ij2 = u_ij*u_ij;
+                fvec4 rInverse = 1.0f/r;
+                fvec4 r2Inverse = rInverse*rInverse;
+                fvec4 logRatio = fastLog(u_ij/l_ij);
+                fvec4 term = l_ij - u_ij + 0.25f*r*(u_ij2 - l_ij2) + (0.5f*rInverse*logRatio) + (0.25f*scaledRadiusJ*scaledRadiusJ*rInverse)*(l_ij2 - u_ij2);
+                for (int j = 0; j < 4; j++) {
+                    if (include[j]) {
+                        sum[j] += term[j];
+                        if (offsetRadiusI[j] < scaledRadiusJ-r[j])
+                            sum[j] += 2.0f*(radiusIInverse[j]-l_ij[j]);
+                    }
                 }
             }
-        }
-        for (int i = 0; i < numInBlock; i++) {
-            int atomIndex = blockStart+i;
-            sum[i] *= 0.5f*atomRadius[i];
-            float sum2 = sum[i]*sum[i];
-            float sum3 = sum[i]*sum2;
-            float tanhSum = tanh(alphaObc*sum[i] - betaObc*sum2 + gammaObc*sum3);
-            float radiusI = atomRadius[i] + dielectricOffset;
-            bornRadii[atomIndex] = 1.0f/(1.0f/atomRadius[i] - tanhSum/radiusI);
-            obcChain[atomIndex] = atomRadius[i]*(alphaObc - 2.0f*betaObc*sum[i] + 3.0f*gammaObc*sum2);
-            obcChain[atomIndex] = (1.0f - tanhSum*tanhSum)*obcChain[atomIndex]/radiusI;
+            for (int i = 0; i < numInBlock; i++) {
+                int atomIndex = blockStart+i;
+                sum[i] *= 0.5f*atomRadius[i];
+                float sum2 = sum[i]*sum[i];
+                float sum3 = sum[i]*sum2;
+                float tanhSum = tanh(alphaObc*sum[i] - betaObc*sum2 + gammaObc*sum3);
+                float radiusI = atomRadius[i] + dielectricOffset;
+                bornRadii[atomIndex] = 1.0f/(1.0f/atomRadius[i] - tanhSum/radiusI);
+                obcChain[atomIndex] = atomRadius[i]*(alphaObc - 2.0f*betaObc*sum[i] + 3.0f*gammaObc*sum2);
+                obcChain[atomIndex] = (1.0f - tanhSum*tanhSum)*obcChain[atomIndex]/radiusI;
+            }
         }
     }
     threads.syncThreads();
@@ -219,24 +214,23 @@ void CpuGBSAOBCForce::threadComputeForce(ThreadPool& threads, int threadIndex) {
     AlignedArray<float>& bornForces = threadBornForces[threadIndex];
     for (int i = 0; i < numParticles; i++)
         bornForces[i] = 0.0f;
-    while (true) {
-        int atomI = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
-        if (atomI >= numParticles)
-            break;
-        if (bornRadii[atomI] > 0) {
-            float radiusI = particleParams[atomI].first + dielectricOffset;
-            float r = radiusI + probeRadius;
-            float ratio6 = powf(radiusI/bornRadii[atomI], 6.0f);
-            float saTerm = surfaceAreaFactor*r*r*ratio6;
-            energy += saTerm;
-            bornForces[atomI] = -6.0f*saTerm/bornRadii[atomI]; 
+    while (atomRange.getNextChunk(threadIndex, start, end)) {
+        for (int atomI = start; atomI < end; atomI++) {
+            if (bornRadii[atomI] > 0) {
+                float radiusI = particleParams[atomI].first + dielectricOffset;
+                float r = radiusI + probeRadius;
+                float ratio6 = powf(radiusI/bornRadii[atomI], 6.0f);
+                float saTerm = surfaceAreaFactor*r*r*ratio6;
+                energy += saTerm;
+                bornForces[atomI] = -6.0f*saTerm/bornRadii[atomI]; 
+            }
+            else
+                bornForces[atomI] = 0.0f;
         }
-        else
-            bornForces[atomI] = 0.0f;
     }
-    threads.syncThreads();
  
-    // First loop of Born energy computation.
+    // First loop of Born energy computation.  This only uses the Born radii and this thread's own
+    // bornForces array, so there is no need to wait for the other threads to finish the previous step.
 
     float* forces = &(*threadForce)[threadIndex][0];
     float preFactor;
@@ -244,154 +238,154 @@ void CpuGBSAOBCForce::threadComputeForce(ThreadPool& threads, int threadIndex) {
         preFactor = ONE_4PI_EPS0*((1.0f/solventDielectric) - (1.0f/soluteDielectric));
     else
         preFactor = 0.0f;
-    while (true) {
-        int blockStart = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 4);
-        if (blockStart >= numParticles)
-            break;
-        int numInBlock = min(4, numParticles-blockStart);
-        ivec4 blockAtomIndex(blockStart, blockStart+1, blockStart+2, blockStart+3);
-        float atomCharge[4], atomx[4], atomy[4], atomz[4];
-        int blockMask[4] = {0, 0, 0, 0};
-        fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f), blockAtomBornForce(0.0f);
-        for (int i = 0; i < numInBlock; i++) {
-            int atomIndex = blockStart+i;
-            atomx[i] = posq[4*atomIndex];
-            atomy[i] = posq[4*atomIndex+1];
-            atomz[i] = posq[4*atomIndex+2];
-            atomCharge[i] = preFactor*posq[4*atomIndex+3];
-            blockMask[i] = 0xFFFFFFFF;
-        }
-        fvec4 radii(&bornRadii[blockStart]);
-        fvec4 x(atomx);
-        fvec4 y(atomy);
-        fvec4 z(atomz);
-        fvec4 partialChargeI(atomCharge);
-        ivec4 mask(blockMask);
-        for (int atomJ = blockStart; atomJ < numParticles; atomJ++) {
-            fvec4 posJ(posq+4*atomJ);
-            fvec4 dx, dy, dz, r2;
-            getDeltaR(posJ, x, y, z, dx, dy, dz, r2, periodic, boxSize, invBoxSize);
-            ivec4 include = mask & (blockAtomIndex <= ivec4(atomJ));
-            if (cutoff)
-                include = include & (r2 < cutoffDistance*cutoffDistance);
-            if (!any(include))
-                continue;
-            fvec4 r = sqrt(r2);
-            fvec4 alpha2_ij = radii*bornRadii[atomJ];
-            fvec4 D_ij = r2/(4.0f*alpha2_ij);
-            fvec4 expTerm = exp(-D_ij);
-            fvec4 denominator2 = r2 + alpha2_ij*expTerm;
-            fvec4 denominator = sqrt(denominator2);
-            fvec4 Gpol = (partialChargeI*posJ[3])/denominator; 
-            fvec4 dGpol_dr = -Gpol*(1.0f - 0.25f*expTerm)/denominator2;  
-            fvec4 dGpol_dalpha2_ij = -0.5f*Gpol*expTerm*(1.0f + D_ij)/denominator2;
-            dGpol_dr = blend(0.0f, dGpol_dr, include);
-            dGpol_dalpha2_ij = blend(0.0f, dGpol_dalpha2_ij, include);
-            fvec4 fx = dx*dGpol_dr;
-            fvec4 fy = dy*dGpol_dr;
-            fvec4 fz = dz*dGpol_dr;
-            blockAtomForceX -= fx;
-            blockAtomForceY -= fy;
-            blockAtomForceZ -= fz;
-            blockAtomBornForce += dGpol_dalpha2_ij*bornRadii[atomJ];
-            float* atomForce = forces+4*atomJ;
-            fvec4 one(1.0f);
-            atomForce[0] += dot4(fx, one);
-            atomForce[1] += dot4(fy, one);
-            atomForce[2] += dot4(fz, one);
-            ivec4 atomJMask = include & (blockAtomIndex != ivec4(atomJ));
-            fvec4 termEnergy = blend(0.0f, Gpol, include);
-            if (cutoff)
-                termEnergy -= blend(0.0f, partialChargeI*posJ[3]/cutoffDistance, atomJMask);
-            termEnergy *= blend(0.5f, 1.0f, atomJMask);
-            energy += dot4(termEnergy, one);
-            bornForces[atomJ] += dot4(blend(0.0f, dGpol_dalpha2_ij, atomJMask), radii);
-        }
-        fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
-        transpose(f[0], f[1], f[2], f[3]);
-        for (int i = 0; i < numInBlock; i++) {
-            int atomIndex = blockStart+i;
-            (fvec4(forces+4*atomIndex)+f[i]).store(forces+4*atomIndex);
-            bornForces[atomIndex] += blockAtomBornForce[i];
+    while (blockRange.getNextChunk(threadIndex, start, end)) {
+        for (int block = start; block < end; block++) {
+            int blockStart = 4*block;
+            int numInBlock = min(4, numParticles-blockStart);
+            ivec4 blockAtomIndex(blockStart, blockStart+1, blockStart+2, blockStart+3);
+            float atomCharge[4], atomx[4], atomy[4], atomz[4];
+            int blockMask[4] = {0, 0, 0, 0};
+            fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f), blockAtomBornForce(0.0f);
+            for (int i = 0; i < numInBlock; i++) {
+                int atomIndex = blockStart+i;
+                atomx[i] = posq[4*atomIndex];
+                atomy[i] = posq[4*atomIndex+1];
+                atomz[i] = posq[4*atomIndex+2];
+                atomCharge[i] = preFactor*posq[4*atomIndex+3];
+                blockMask[i] = 0xFFFFFFFF;
+            }
+            fvec4 radii(&bornRadii[blockStart]);
+            fvec4 x(atomx);
+            fvec4 y(atomy);
+            fvec4 z(atomz);
+            fvec4 partialChargeI(atomCharge);
+            ivec4 mask(blockMask);
+            for (int atomJ = blockStart; atomJ < numParticles; atomJ++) {
+                fvec4 posJ(posq+4*atomJ);
+                fvec4 dx, dy, dz, r2;
+                getDeltaR(posJ, x, y, z, dx, dy, dz, r2, periodic, boxSize, invBoxSize);
+                ivec4 include = mask & (blockAtomIndex <= ivec4(atomJ));
+                if (cutoff)
+                    include = include & (r2 < cutoffDistance*cutoffDistance);
+                if (!any(include))
+                    continue;
+                fvec4 r = sqrt(r2);
+                fvec4 alpha2_ij = radii*bornRadii[atomJ];
+                fvec4 D_ij = r2/(4.0f*alpha2_ij);
+                fvec4 expTerm = exp(-D_ij);
+                fvec4 denominator2 = r2 + alpha2_ij*expTerm;
+                fvec4 denominator = sqrt(denominator2);
+                fvec4 Gpol = (partialChargeI*posJ[3])/denominator; 
+                fvec4 dGpol_dr = -Gpol*(1.0f - 0.25f*expTerm)/denominator2;  
+                fvec4 dGpol_dalpha2_ij = -0.5f*Gpol*expTerm*(1.0f + D_ij)/denominator2;
+                dGpol_dr = blend(0.0f, dGpol_dr, include);
+                dGpol_dalpha2_ij = blend(0.0f, dGpol_dalpha2_ij, include);
+                fvec4 fx = dx*dGpol_dr;
+                fvec4 fy = dy*dGpol_dr;
+                fvec4 fz = dz*dGpol_dr;
+                blockAtomForceX -= fx;
+                blockAtomForceY -= fy;
+                blockAtomForceZ -= fz;
+                blockAtomBornForce += dGpol_dalpha2_ij*bornRadii[atomJ];
+                float* atomForce = forces+4*atomJ;
+                fvec4 one(1.0f);
+                atomForce[0] += dot4(fx, one);
+                atomForce[1] += dot4(fy, one);
+                atomForce[2] += dot4(fz, one);
+                ivec4 atomJMask = include & (blockAtomIndex != ivec4(atomJ));
+                fvec4 termEnergy = blend(0.0f, Gpol, include);
+                if (cutoff)
+                    termEnergy -= blend(0.0f, partialChargeI*posJ[3]/cutoffDistance, atomJMask);
+                termEnergy *= blend(0.5f, 1.0f, atomJMask);
+                energy += dot4(termEnergy, one);
+                bornForces[atomJ] += dot4(blend(0.0f, dGpol_dalpha2_ij, atomJMask), radii);
+            }
+            fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
+            transpose(f[0], f[1], f[2], f[3]);
+            for (int i = 0; i < numInBlock; i++) {
+                int atomIndex = blockStart+i;
+                (fvec4(forces+4*atomIndex)+f[i]).store(forces+4*atomIndex);
+                bornForces[atomIndex] += blockAtomBornForce[i];
+            }
         }
     }
     threads.syncThreads();
 
     // Second loop of Born energy computation.
 
-    while (true) {
-        int blockStart = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 4);
-        if (blockStart >= numParticles)
-            break;
-        fvec4 bornForce(0.0f);
-        for (int i = 0; i < numThreads; i++)
-            bornForce += fvec4(&threadBornForces[i][blockStart]);
-        fvec4 radii(&bornRadii[blockStart]);
-        bornForce *= radii*radii*fvec4(&obcChain[blockStart]);
-        int numInBlock = min(4, numParticles-blockStart);
-        ivec4 blockAtomIndex(blockStart, blockStart+1, blockStart+2, blockStart+3);
-        float atomRadius[4], atomx[4], atomy[4], atomz[4];
-        int blockMask[4] = {0, 0, 0, 0};
-        fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
-        for (int i = 0; i < numInBlock; i++) {
-            int atomIndex = blockStart+i;
-            atomRadius[i] = particleParams[atomIndex].first;
-            atomx[i] = posq[4*atomIndex];
-            atomy[i] = posq[4*atomIndex+1];
-            atomz[i] = posq[4*atomIndex+2];
-            blockMask[i] = 0xFFFFFFFF;
-        }
-        for (int i = numInBlock; i < 4; i++) {
-            atomx[i] = 0.0f;
-            atomy[i] = 0.0f;
-            atomz[i] = 0.0f;
-        }
-        fvec4 offsetRadiusI(atomRadius);
-        fvec4 x(atomx);
-        fvec4 y(atomy);
-        fvec4 z(atomz);
-        ivec4 mask(blockMask);
-        for (int atomJ = 0; atomJ < numParticles; atomJ++) {
-            fvec4 posJ(posq+4*atomJ);
-            fvec4 dx, dy, dz, r2;
-            getDeltaR(posJ, x, y, z, dx, dy, dz, r2, periodic, boxSize, invBoxSize);
-            ivec4 include = mask & (blockAtomIndex != ivec4(atomJ));
-            if (cutoff)
-                include = include & (r2 < cutoffDistance*cutoffDistance);
-            if (!any(include))
-                continue;
-            fvec4 r = sqrt(r2);
-            float scaledRadiusJ = particleParams[atomJ].second;
-            float scaledRadiusJ2 = scaledRadiusJ*scaledRadiusJ;
-            fvec4 rScaledRadiusJ = r + scaledRadiusJ;
-            include = include & (offsetRadiusI < rScaledRadiusJ);
-            fvec4 l_ij = 1.0f/max(offsetRadiusI, abs(r-scaledRadiusJ));
-            fvec4 u_ij = 1.0f/rScaledRadiusJ;
-            fvec4 l_ij2 = l_ij*l_ij;
-            fvec4 u_ij2 = u_ij*u_ij;
-            fvec4 rInverse = 1.0f/r;
-            fvec4 r2Inverse = rInverse*rInverse;
-            fvec4 logRatio = fastLog(u_ij/l_ij);
-            fvec4 t3 = 0.125f*(1.0f + scaledRadiusJ2*r2Inverse)*(l_ij2 - u_ij2) + 0.25f*logRatio*r2Inverse;
-            fvec4 de = bornForce*t3*rInverse;
-            de = blend(0.0f, de, include);
-            fvec4 fx = dx*de;
-            fvec4 fy = dy*de;
-            fvec4 fz = dz*de;
-            blockAtomForceX += fx;
-            blockAtomForceY += fy;
-            blockAtomForceZ += fz;
-            float* atomForce = forces+4*atomJ;
-            fvec4 one(1.0f);
-            atomForce[0] -= dot4(fx, one);
-            atomForce[1] -= dot4(fy, one);
-            atomForce[2] -= dot4(fz, one);
-        }
-        fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
-        transpose(f[0], f[1], f[2], f[3]);
-        for (int i = 0; i < numInBlock; i++) {
-            int atomIndex = blockStart+i;
-            (fvec4(forces+4*atomIndex)+f[i]).store(forces+4*atomIndex);
+    while (blockRange.getNextChunk(threadIndex, start, end)) {
+        for (int block = start; block < end; block++) {
+            int blockStart = 4*block;
+            fvec4 bornForce(0.0f);
+            for (int i = 0; i < numThreads; i++)
+                bornForce += fvec4(&threadBornForces[i][blockStart]);
+            fvec4 radii(&bornRadii[blockStart]);
+            bornForce *= radii*radii*fvec4(&obcChain[blockStart]);
+            int numInBlock = min(4, numParticles-blockStart);
+            ivec4 blockAtomIndex(blockStart, blockStart+1, blockStart+2, blockStart+3);
+            float atomRadius[4], atomx[4], atomy[4], atomz[4];
+            int blockMask[4] = {0, 0, 0, 0};
+            fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
+            for (int i = 0; i < numInBlock; i++) {
+                int atomIndex = blockStart+i;
+                atomRadius[i] = particleParams[atomIndex].first;
+                atomx[i] = posq[4*atomIndex];
+                atomy[i] = posq[4*atomIndex+1];
+                atomz[i] = posq[4*atomIndex+2];
+                blockMask[i] = 0xFFFFFFFF;
+            }
+            for (int i = numInBlock; i < 4; i++) {
+                atomx[i] = 0.0f;
+                atomy[i] = 0.0f;
+                atomz[i] = 0.0f;
+            }
+            fvec4 offsetRadiusI(atomRadius);
+            fvec4 x(atomx);
+            fvec4 y(atomy);
+            fvec4 z(atomz);
+            ivec4 mask(blockMask);
+            for (int atomJ = 0; atomJ < numParticles; atomJ++) {
+                fvec4 posJ(posq+4*atomJ);
+                fvec4 dx, dy, dz, r2;
+                getDeltaR(posJ, x, y, z, dx, dy, dz, r2, periodic, boxSize, invBoxSize);
+                ivec4 include = mask & (blockAtomIndex != ivec4(atomJ));
+                if (cutoff)
+                    include = include & (r2 < cutoffDistance*cutoffDistance);
+                if (!any(include))
+                    continue;
+                fvec4 r = sqrt(r2);
+                float scaledRadiusJ = particleParams[atomJ].second;
+                float scaledRadiusJ2 = scaledRadiusJ*scaledRadiusJ;
+                fvec4 rScaledRadiusJ = r + scaledRadiusJ;
+                include = include & (offsetRadiusI < rScaledRadiusJ);
+                fvec4 l_ij = 1.0f/max(offsetRadiusI, abs(r-scaledRadiusJ));
+                fvec4 u_ij = 1.0f/rScaledRadiusJ;
+                fvec4 l_ij2 = l_ij*l_ij;
+                fvec4 u_ij2 = u_ij*u_ij;
+                fvec4 rInverse = 1.0f/r;
+                fvec4 r2Inverse = rInverse*rInverse;
+                fvec4 logRatio = fastLog(u_ij/l_ij);
+                fvec4 t3 = 0.125f*(1.0f + scaledRadiusJ2*r2Inverse)*(l_ij2 - u_ij2) + 0.25f*logRatio*r2Inverse;
+                fvec4 de = bornForce*t3*rInverse;
+                de = blend(0.0f, de, include);
+                fvec4 fx = dx*de;
+                fvec4 fy = dy*de;
+                fvec4 fz = dz*de;
+                blockAtomForceX += fx;
+                blockAtomForceY += fy;
+                blockAtomForceZ += fz;
+                float* atomForce = forces+4*atomJ;
+                fvec4 one(1.0f);
+                atomForce[0] -= dot4(fx, one);
+                atomForce[1] -= dot4(fy, one);
+                atomForce[2] -= dot4(fz, one);
+            }
+            fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
+            transpose(f[0], f[1], f[2], f[3]);
+            for (int i = 0; i < numInBlock; i++) {
+                int atomIndex = blockStart+i;
+                (fvec4(forces+4*atomIndex)+f[i]).store(forces+4*atomIndex);
+            }
         }
     }
     threadEnergy[threadIndex] = energy;
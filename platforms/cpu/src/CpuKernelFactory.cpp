@@ -32,6 +32,7 @@
 #include "CpuKernelFactory.h"
 #include "CpuKernels.h"
 #include "CpuPlatform.h"
+#include "ReferenceKernelFactory.h"
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/OpenMMException.h"
 
@@ -39,8 +40,16 @@ using namespace OpenMM;
 
 KernelImpl* CpuKernelFactory::createKernelImpl(std::string name, const Platform& platform, ContextImpl& context) const {
     CpuPlatform::PlatformData& data = CpuPlatform::getPlatformData(context);
+    if (data.useDoublePrecision) {
+        // Double precision contexts use the Reference implementations of every kernel.
+
+        ReferenceKernelFactory referenceFactory;
+        return referenceFactory.createKernelImpl(name, platform, context);
+    }
     if (name == CalcForcesAndEnergyKernel::Name())
         return new CpuCalcForcesAndEnergyKernel(name, platform, data, context);
+    if (name == UpdateStateDataKernel::Name())
+        return new CpuUpdateStateDataKernel(name, platform, *reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData()), data);
     if (name == CalcHarmonicAngleForceKernel::Name())
         return new CpuCalcHarmonicAngleForceKernel(name, platform, data);
     if (name == CalcPeriodicTorsionForceKernel::Name())
@@ -59,5 +68,7 @@ KernelImpl* CpuKernelFactory::createKernelImpl(std::string name, const Platform&
         return new CpuCalcCustomGBForceKernel(name, platform, data);
     if (name == IntegrateLangevinStepKernel::Name())
         return new CpuIntegrateLangevinStepKernel(name, platform, data);
+    if (name == ApplyMonteCarloBarostatKernel::Name())
+        return new CpuApplyMonteCarloBarostatKernel(name, platform, data);
     throw OpenMMException((std::string("Tried to create kernel with illegal kernel name '") + name + "'").c_str());
 }
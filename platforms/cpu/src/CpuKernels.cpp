@@ -42,8 +42,11 @@
 #include "openmm/Context.h"
 #include "openmm/OpenMMException.h"
 #include "openmm/internal/ContextImpl.h"
+#include "openmm/internal/gmx_atomic.h"
+#include "openmm/internal/MoleculeImages.h"
 #include "openmm/internal/CustomNonbondedForceImpl.h"
 #include "openmm/internal/NonbondedForceImpl.h"
+#include "openmm/internal/timer.h"
 #include "openmm/internal/vectorize.h"
 #include "RealVec.h"
 #include "lepton/CompiledExpression.h"
@@ -51,6 +54,7 @@
 #include "lepton/Operation.h"
 #include "lepton/Parser.h"
 #include "lepton/ParsedExpression.h"
+#include <algorithm>
 
 using namespace OpenMM;
 using namespace std;
@@ -142,14 +146,24 @@ public:
         int numThreads = threads.getNumThreads();
         int start = threadIndex*numParticles/numThreads;
         int end = (threadIndex+1)*numParticles/numThreads;
+        int numExtra = data.extraForces.size();
         for (int i = start; i < end; i++) {
             fvec4 f(0.0f);
             for (int j = 0; j < numThreads; j++)
                 f += fvec4(&data.threadForce[j][4*i]);
+            for (int j = 0; j < numExtra; j++)
+                f += fvec4(&data.extraForces[j][4*i]);
             forceData[i][0] += f[0];
             forceData[i][1] += f[1];
             forceData[i][2] += f[2];
         }
+        if (data.useMixedPrecision)
+            for (int i = start; i < end; i++)
+                for (int j = 0; j < numThreads; j++) {
+                    forceData[i][0] += data.threadForceDouble[j][4*i];
+                    forceData[i][1] += data.threadForceDouble[j][4*i+1];
+                    forceData[i][2] += data.threadForceDouble[j][4*i+2];
+                }
     }
     int numParticles;
     vector<RealVec>& forceData;
@@ -213,6 +227,11 @@ public:
         fvec4 zero(0.0f);
         for (int j = 0; j < numParticles; j++)
             zero.store(&data.threadForce[threadIndex][j*4]);
+        if (data.useMixedPrecision) {
+            double* forceDouble = &data.threadForceDouble[threadIndex][0];
+            for (int j = 0; j < 4*numParticles; j++)
+                forceDouble[j] = 0.0;
+        }
     }
     int numParticles;
     bool positionsValid;
@@ -239,9 +258,14 @@ void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool i
     // Convert positions to single precision and clear the forces.
 
     int numParticles = context.getSystem().getNumParticles();
+    data.bondForceQueue.reset();
+    data.extraForces.clear();
     InitForceTask task(numParticles, context, data);
-    data.threads.execute(task);
-    data.threads.waitForThreads();
+    {
+        TimingRecorder::Scope scope(context.getTimingRecorder(), "Force initialization");
+        data.threads.execute(task);
+        data.threads.waitForThreads();
+    }
     if (!task.positionsValid)
         throw OpenMMException("Particle coordinate is nan");
 
@@ -249,13 +273,13 @@ void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool i
         
     if (data.neighborList != NULL) {
         double padding = data.paddedCutoff-data.cutoff;;
-        bool needRecompute = false;
+        bool needRecompute = data.rebuildNeighborList;
         double closeCutoff2 = 0.25*padding*padding;
         double farCutoff2 = 0.5*padding*padding;
         int maxNumMoved = numParticles/10;
         vector<int> moved;
         vector<RealVec>& posData = extractPositions(context);
-        for (int i = 0; i < numParticles; i++) {
+        for (int i = 0; i < numParticles && !needRecompute; i++) {
             RealVec delta = posData[i]-lastPositions[i];
             double dist2 = delta.dot(delta);
             if (dist2 > closeCutoff2) {
@@ -288,19 +312,165 @@ void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool i
                 }
         }
         if (needRecompute) {
+            TimingRecorder::Scope scope(context.getTimingRecorder(), "Neighbor list");
             data.neighborList->computeNeighborList(numParticles, data.posq, data.exclusions, extractBoxVectors(context), data.isPeriodic, data.paddedCutoff, data.threads);
             lastPositions = posData;
+            data.rebuildNeighborList = false;
         }
     }
 }
 
 double CpuCalcForcesAndEnergyKernel::finishComputation(ContextImpl& context, bool includeForce, bool includeEnergy, int groups, bool& valid) {
+    // Compute any bonded forces that were not already handled along with the nonbonded interactions.
+
+    if (!data.bondForceQueue.isEmpty()) {
+        TimingRecorder::Scope scope(context.getTimingRecorder(), "Bonded forces");
+        data.bondForceQueue.computeForces(data.threads);
+    }
+    double energy = data.bondForceQueue.getEnergy();
+    data.bondForceQueue.reset();
+
     // Sum the forces from all the threads.
     
     SumForceTask task(context.getSystem().getNumParticles(), extractForces(context), data);
+    {
+        TimingRecorder::Scope scope(context.getTimingRecorder(), "Force reduction");
+        data.threads.execute(task);
+        data.threads.waitForThreads();
+    }
+    energy += referenceKernel.getAs<ReferenceCalcForcesAndEnergyKernel>().finishComputation(context, includeForce, includeEnergy, groups, valid);
+    return energy;
+}
+
+static vector<RealVec>& extractParticleData(ContextImpl& context, State::DataType type) {
+    if (type == State::Positions)
+        return extractPositions(context);
+    if (type == State::Velocities)
+        return extractVelocities(context);
+    if (type == State::Forces)
+        return extractForces(context);
+    throw OpenMMException("Unsupported data type for particle data");
+}
+
+template <class T, bool toBuffer>
+class CpuUpdateStateDataKernel::CopyParticleDataTask : public ThreadPool::Task {
+public:
+    CopyParticleDataTask(vector<RealVec>& data, T* buffer, int stride, const vector<int>& particles) :
+            data(data), buffer(buffer), stride(stride), particles(particles) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        int numParticles = (particles.size() == 0 ? data.size() : particles.size());
+        int start = threadIndex*(long long) numParticles/threads.getNumThreads();
+        int end = (threadIndex+1)*(long long) numParticles/threads.getNumThreads();
+        for (int i = start; i < end; i++) {
+            RealVec& value = data[particles.size() == 0 ? i : particles[i]];
+            T* element = buffer+i*(size_t) stride;
+            if (toBuffer) {
+                element[0] = (T) value[0];
+                element[1] = (T) value[1];
+                element[2] = (T) value[2];
+            }
+            else
+                value = RealVec((RealOpenMM) element[0], (RealOpenMM) element[1], (RealOpenMM) element[2]);
+        }
+    }
+    vector<RealVec>& data;
+    T* buffer;
+    int stride;
+    const vector<int>& particles;
+};
+
+void CpuUpdateStateDataKernel::getParticleData(ContextImpl& context, State::DataType type, double* buffer, int stride, const vector<int>& particles) {
+    CopyParticleDataTask<double, true> task(extractParticleData(context, type), buffer, stride, particles);
     data.threads.execute(task);
     data.threads.waitForThreads();
-    return referenceKernel.getAs<ReferenceCalcForcesAndEnergyKernel>().finishComputation(context, includeForce, includeEnergy, groups, valid);
+}
+
+void CpuUpdateStateDataKernel::getParticleData(ContextImpl& context, State::DataType type, float* buffer, int stride, const vector<int>& particles) {
+    CopyParticleDataTask<float, true> task(extractParticleData(context, type), buffer, stride, particles);
+    data.threads.execute(task);
+    data.threads.waitForThreads();
+}
+
+void CpuUpdateStateDataKernel::setParticleData(ContextImpl& context, State::DataType type, const double* buffer, int stride, const vector<int>& particles) {
+    if (type != State::Positions && type != State::Velocities)
+        throw OpenMMException("Unsupported data type for setting particle data");
+    CopyParticleDataTask<double, false> task(extractParticleData(context, type), const_cast<double*>(buffer), stride, particles);
+    data.threads.execute(task);
+    data.threads.waitForThreads();
+}
+
+void CpuUpdateStateDataKernel::setParticleData(ContextImpl& context, State::DataType type, const float* buffer, int stride, const vector<int>& particles) {
+    if (type != State::Positions && type != State::Velocities)
+        throw OpenMMException("Unsupported data type for setting particle data");
+    CopyParticleDataTask<float, false> task(extractParticleData(context, type), const_cast<float*>(buffer), stride, particles);
+    data.threads.execute(task);
+    data.threads.waitForThreads();
+}
+
+class CpuUpdateStateDataKernel::MoleculeImageTask : public ThreadPool::Task {
+public:
+    MoleculeImageTask(const vector<RealVec>& posData, const RealVec* boxVectors, const vector<int>& moleculeStart, const vector<int>& moleculeParticles,
+            vector<Vec3>& offsets, vector<Vec3>* positions) : posData(posData), boxVectors(boxVectors), moleculeStart(moleculeStart),
+            moleculeParticles(moleculeParticles), offsets(offsets), positions(positions) {
+        gmx_atomic_set(&counter, 0);
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        // Molecules vary greatly in size, so hand them out in small chunks.
+
+        const int chunkSize = 64;
+        int numMolecules = moleculeStart.size()-1;
+        while (true) {
+            int start = gmx_atomic_fetch_add(&counter, chunkSize);
+            if (start >= numMolecules)
+                break;
+            int end = min(start+chunkSize, numMolecules);
+            findMoleculeImages(&posData[0], boxVectors, moleculeStart, moleculeParticles, start, end, &offsets[0], positions == NULL ? NULL : &(*positions)[0]);
+        }
+    }
+    const vector<RealVec>& posData;
+    const RealVec* boxVectors;
+    const vector<int>& moleculeStart;
+    const vector<int>& moleculeParticles;
+    vector<Vec3>& offsets;
+    vector<Vec3>* positions;
+    gmx_atomic_t counter;
+};
+
+void CpuUpdateStateDataKernel::computeMoleculeImages(ContextImpl& context, const vector<int>& moleculeStart, const vector<int>& moleculeParticles, vector<Vec3>& offsets) {
+    offsets.resize(moleculeStart.size()-1);
+    MoleculeImageTask task(extractPositions(context), extractBoxVectors(context), moleculeStart, moleculeParticles, offsets, NULL);
+    data.threads.execute(task);
+    data.threads.waitForThreads();
+}
+
+void CpuUpdateStateDataKernel::getPeriodicPositions(ContextImpl& context, const vector<int>& moleculeStart, const vector<int>& moleculeParticles, vector<Vec3>& positions) {
+    vector<Vec3> offsets(moleculeStart.size()-1);
+    positions.resize(context.getSystem().getNumParticles());
+    MoleculeImageTask task(extractPositions(context), extractBoxVectors(context), moleculeStart, moleculeParticles, offsets, &positions);
+    data.threads.execute(task);
+    data.threads.waitForThreads();
+}
+
+void CpuUpdateStateDataKernel::createCheckpoint(ContextImpl& context, ostream& stream) {
+    ReferenceUpdateStateDataKernel::createCheckpoint(context, stream);
+    data.random.createCheckpoint(stream);
+
+    // The neighbor list is not saved.  Instead, it is rebuilt from the current positions both here and
+    // after loading, so the original and restored simulations see the same list.
+
+    data.rebuildNeighborList = true;
+}
+
+void CpuUpdateStateDataKernel::loadCheckpoint(ContextImpl& context, istream& stream) {
+    ReferenceUpdateStateDataKernel::loadCheckpoint(context, stream);
+    data.random.loadCheckpoint(stream);
+    data.rebuildNeighborList = true;
+}
+
+void CpuUpdateStateDataKernel::loadLegacyCheckpoint(ContextImpl& context, istream& stream) {
+    ReferenceUpdateStateDataKernel::loadCheckpoint(context, stream);
+    data.rebuildNeighborList = true;
 }
 
 CpuCalcHarmonicAngleForceKernel::~CpuCalcHarmonicAngleForceKernel() {
@@ -339,12 +509,14 @@ void CpuCalcHarmonicAngleForceKernel::initialize(const System& system, const Har
 double CpuCalcHarmonicAngleForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
     vector<RealVec>& posData = extractPositions(context);
     vector<RealVec>& forceData = extractForces(context);
-    RealOpenMM energy = 0;
-    ReferenceAngleBondIxn angleBond;
     if (usePeriodic)
         angleBond.setPeriodic(extractBoxVectors(context));
-    bondForce.calculateForce(posData, angleParamArray, forceData, includeEnergy ? &energy : NULL, angleBond);
-    return energy;
+
+    // Rather than computing the force right away, queue it so all the bonded forces can be computed together.
+    // Its energy gets returned by CpuCalcForcesAndEnergyKernel::finishComputation().
+
+    data.bondForceQueue.addForce(bondForce, posData, angleParamArray, forceData, includeEnergy, angleBond);
+    return 0.0;
 }
 
 void CpuCalcHarmonicAngleForceKernel::copyParametersToContext(ContextImpl& context, const HarmonicAngleForce& force) {
@@ -402,12 +574,10 @@ void CpuCalcPeriodicTorsionForceKernel::initialize(const System& system, const P
 double CpuCalcPeriodicTorsionForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
     vector<RealVec>& posData = extractPositions(context);
     vector<RealVec>& forceData = extractForces(context);
-    RealOpenMM energy = 0;
-    ReferenceProperDihedralBond periodicTorsionBond;
     if (usePeriodic)
         periodicTorsionBond.setPeriodic(extractBoxVectors(context));
-    bondForce.calculateForce(posData, torsionParamArray, forceData, includeEnergy ? &energy : NULL, periodicTorsionBond);
-    return energy;
+    data.bondForceQueue.addForce(bondForce, posData, torsionParamArray, forceData, includeEnergy, periodicTorsionBond);
+    return 0.0;
 }
 
 void CpuCalcPeriodicTorsionForceKernel::copyParametersToContext(ContextImpl& context, const PeriodicTorsionForce& force) {
@@ -469,12 +639,10 @@ void CpuCalcRBTorsionForceKernel::initialize(const System& system, const RBTorsi
 double CpuCalcRBTorsionForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
     vector<RealVec>& posData = extractPositions(context);
     vector<RealVec>& forceData = extractForces(context);
-    RealOpenMM energy = 0;
-    ReferenceRbDihedralBond rbTorsionBond;
     if (usePeriodic)
         rbTorsionBond.setPeriodic(extractBoxVectors(context));
-    bondForce.calculateForce(posData, torsionParamArray, forceData, includeEnergy ? &energy : NULL, rbTorsionBond);
-    return energy;
+    data.bondForceQueue.addForce(bondForce, posData, torsionParamArray, forceData, includeEnergy, rbTorsionBond);
+    return 0.0;
 }
 
 void CpuCalcRBTorsionForceKernel::copyParametersToContext(ContextImpl& context, const RBTorsionForce& force) {
@@ -500,31 +668,33 @@ void CpuCalcRBTorsionForceKernel::copyParametersToContext(ContextImpl& context,
 
 class CpuCalcNonbondedForceKernel::PmeIO : public CalcPmeReciprocalForceKernel::IO {
 public:
-    PmeIO(float* posq, float* force, int numParticles) : posq(posq), force(force), numParticles(numParticles) {
+    PmeIO(float* posq, vector<float*>& extraForces) : posq(posq), extraForces(extraForces) {
     }
     float* getPosq() {
         return posq;
     }
     void setForce(float* f) {
-        for (int i = 0; i < numParticles; i++) {
-            force[4*i] += f[4*i];
-            force[4*i+1] += f[4*i+1];
-            force[4*i+2] += f[4*i+2];
-        }
+        // Rather than adding the forces to a thread's buffer here, let the final reduction add them in parallel.
+        
+        extraForces.push_back(f);
     }
 private:
     float* posq;
-    float* force;
-    int numParticles;
+    vector<float*>& extraForces;
 };
 
 bool isVec8Supported();
+bool isVec16Supported();
 CpuNonbondedForce* createCpuNonbondedForceVec4();
 CpuNonbondedForce* createCpuNonbondedForceVec8();
+CpuNonbondedForce* createCpuNonbondedForceVec16();
 
 CpuCalcNonbondedForceKernel::CpuCalcNonbondedForceKernel(string name, const Platform& platform, CpuPlatform::PlatformData& data) : CalcNonbondedForceKernel(name, platform),
-        data(data), bonded14IndexArray(NULL), bonded14ParamArray(NULL), hasInitializedPme(false), nonbonded(NULL) {
-    if (isVec8Supported())
+        data(data), bonded14IndexArray(NULL), bonded14ParamArray(NULL), hasInitializedPme(false), nonbonded(NULL),
+        pmeThreads(0), nextPmeThreads(0), tuningSteps(0), tuningDirectTime(0.0), tuningReciprocalTime(0.0), sequentialTime(0.0), isTuningPme(false) {
+    if (isVec16Supported())
+        nonbonded = createCpuNonbondedForceVec16();
+    else if (isVec8Supported())
         nonbonded = createCpuNonbondedForceVec8();
     else
         nonbonded = createCpuNonbondedForceVec4();
@@ -548,17 +718,17 @@ void CpuCalcNonbondedForceKernel::initialize(const System& system, const Nonbond
     // Identify which exceptions are 1-4 interactions.
 
     numParticles = force.getNumParticles();
-    exclusions.resize(numParticles);
+    vector<pair<int, int> > excludedPairs;
     vector<int> nb14s;
     for (int i = 0; i < force.getNumExceptions(); i++) {
         int particle1, particle2;
         double chargeProd, sigma, epsilon;
         force.getExceptionParameters(i, particle1, particle2, chargeProd, sigma, epsilon);
-        exclusions[particle1].insert(particle2);
-        exclusions[particle2].insert(particle1);
+        excludedPairs.push_back(make_pair(particle1, particle2));
         if (chargeProd != 0.0 || epsilon != 0.0)
             nb14s.push_back(i);
     }
+    exclusions = CpuExclusions(numParticles, excludedPairs);
 
     // Record the particle parameters.
 
@@ -637,11 +807,17 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
             kernelNames.push_back("CalcPmeReciprocalForce");
             useOptimizedPme = getPlatform().supportsKernels(kernelNames);
             if (useOptimizedPme) {
-                optimizedPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), context);
-                optimizedPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSize[0], gridSize[1], gridSize[2], numParticles, ewaldAlpha);
+                // If PmeThreads is "auto", start by computing direct and reciprocal space one after the other.
+                // tunePmeThreads() will decide whether overlapping them is faster.
+
+                int numThreads = data.threads.getNumThreads();
+                isTuningPme = (data.pmeThreads == 0 && numThreads > 1);
+                nextPmeThreads = (data.pmeThreads == 0 ? numThreads : data.pmeThreads);
             }
         }
     }
+    if (useOptimizedPme && nextPmeThreads != pmeThreads)
+        createOptimizedPme(context, nextPmeThreads);
     AlignedArray<float>& posq = data.posq;
     vector<RealVec>& posData = extractPositions(context);
     vector<RealVec>& forceData = extractForces(context);
@@ -665,28 +841,109 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
     if (useSwitchingFunction)
         nonbonded->setUseSwitchingFunction(switchingDistance);
     double nonbondedEnergy = 0;
-    if (includeDirect)
-        nonbonded->calculateDirectIxn(numParticles, &posq[0], posData, particleParams, exclusions, data.threadForce, includeEnergy ? &nonbondedEnergy : NULL, data.threads);
+    int numThreads = data.threads.getNumThreads();
+    bool overlapPme = (includeReciprocal && useOptimizedPme && pmeThreads < numThreads);
+    PmeIO io(&posq[0], data.extraForces);
+    Vec3 periodicBoxVectors[3] = {boxVectors[0], boxVectors[1], boxVectors[2]};
+    double startTime = getCurrentTime();
+    if (overlapPme) {
+        // Start computing reciprocal space on the PME kernel's own threads.  Direct space is computed
+        // at the same time on the rest.
+        
+        optimizedPme.getAs<CalcPmeReciprocalForceKernel>().beginComputation(io, periodicBoxVectors, includeEnergy);
+        nonbonded->setMaxThreads(numThreads-pmeThreads);
+    }
+    else
+        nonbonded->setMaxThreads(numThreads);
+    if (includeDirect) {
+        TimingRecorder::Scope scope(context.getTimingRecorder(), "Nonbonded direct space");
+
+        // The 1-4 interactions are queued along with any other bonded forces, so the threads can
+        // compute all of them while they are also working on the direct space interactions.
+
+        data.bondForceQueue.addForce(bondForce, posData, bonded14ParamArray, forceData, includeEnergy, nonbonded14);
+        nonbonded->setBondForceQueue(&data.bondForceQueue);
+        if (data.useMixedPrecision)
+            nonbonded->calculateDirectIxn(numParticles, &posq[0], posData, particleParams, exclusions, data.threadForceDouble, includeEnergy ? &nonbondedEnergy : NULL, data.threads);
+        else
+            nonbonded->calculateDirectIxn(numParticles, &posq[0], posData, particleParams, exclusions, data.threadForce, includeEnergy ? &nonbondedEnergy : NULL, data.threads);
+        nonbonded->setBondForceQueue(NULL);
+        data.bondForceQueue.finishComputation();
+    }
+    double directTime = getCurrentTime();
     if (includeReciprocal) {
+        // When reciprocal space is overlapped with direct space, this only records the time spent waiting for it to finish.
+
+        TimingRecorder::Scope scope(context.getTimingRecorder(), "Nonbonded reciprocal space");
         if (useOptimizedPme) {
-            PmeIO io(&posq[0], &data.threadForce[0][0], numParticles);
-            Vec3 periodicBoxVectors[3] = {boxVectors[0], boxVectors[1], boxVectors[2]};
-            optimizedPme.getAs<CalcPmeReciprocalForceKernel>().beginComputation(io, periodicBoxVectors, includeEnergy);
+            if (!overlapPme)
+                optimizedPme.getAs<CalcPmeReciprocalForceKernel>().beginComputation(io, periodicBoxVectors, includeEnergy);
             nonbondedEnergy += optimizedPme.getAs<CalcPmeReciprocalForceKernel>().finishComputation(io);
+            recordPmePhaseTimes(context);
+            if (isTuningPme && includeDirect)
+                tunePmeThreads(directTime-startTime, getCurrentTime()-directTime);
         }
         else
             nonbonded->calculateReciprocalIxn(numParticles, &posq[0], posData, particleParams, exclusions, forceData, includeEnergy ? &nonbondedEnergy : NULL);
     }
     energy += nonbondedEnergy;
-    if (includeDirect) {
-        ReferenceLJCoulomb14 nonbonded14;
-        bondForce.calculateForce(posData, bonded14ParamArray, forceData, includeEnergy ? &energy : NULL, nonbonded14);
-        if (data.isPeriodic)
-            energy += dispersionCoefficient/(boxVectors[0][0]*boxVectors[1][1]*boxVectors[2][2]);
-    }
+    if (includeDirect && data.isPeriodic)
+        energy += dispersionCoefficient/(boxVectors[0][0]*boxVectors[1][1]*boxVectors[2][2]);
     return energy;
 }
 
+void CpuCalcNonbondedForceKernel::createOptimizedPme(ContextImpl& context, int numPmeThreads) {
+    optimizedPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), context);
+    optimizedPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSize[0], gridSize[1], gridSize[2], numParticles, ewaldAlpha, numPmeThreads);
+    pmeThreads = numPmeThreads;
+    lastPmePhaseTimes.clear();
+}
+
+void CpuCalcNonbondedForceKernel::recordPmePhaseTimes(ContextImpl& context) {
+    // The PME kernel reports the total time for each phase, so record the change since the last evaluation.
+
+    static const char* phaseNames[] = {"PME spread charges", "PME forward FFT", "PME convolution", "PME backward FFT", "PME interpolate forces"};
+    vector<double> times;
+    optimizedPme.getAs<CalcPmeReciprocalForceKernel>().getPhaseTimes(times);
+    if (lastPmePhaseTimes.size() != times.size())
+        lastPmePhaseTimes.resize(times.size(), 0.0);
+    TimingRecorder& timing = context.getTimingRecorder();
+    if (timing.isEnabled() && times.size() == 5)
+        for (int i = 0; i < (int) times.size(); i++)
+            timing.record(phaseNames[i], times[i]-lastPmePhaseTimes[i]);
+    lastPmePhaseTimes = times;
+}
+
+void CpuCalcNonbondedForceKernel::tunePmeThreads(double directTime, double reciprocalTime) {
+    const int stepsToTime = 10;
+    if (++tuningSteps == 1)
+        return; // The first evaluation after creating the PME kernel includes one-time setup costs.
+    tuningDirectTime += directTime;
+    tuningReciprocalTime += reciprocalTime;
+    if (tuningSteps <= stepsToTime)
+        return;
+    int numThreads = data.threads.getNumThreads();
+    double totalTime = tuningDirectTime+tuningReciprocalTime;
+    if (pmeThreads == numThreads) {
+        // We have timed computing them one after the other.  Now try overlapping them, dividing the threads
+        // in proportion to how long each part took.
+
+        sequentialTime = totalTime;
+        int split = (int) floor(numThreads*tuningReciprocalTime/totalTime+0.5);
+        nextPmeThreads = max(1, min(numThreads-1, split));
+    }
+    else {
+        // Keep whichever one was faster.
+
+        if (totalTime > sequentialTime)
+            nextPmeThreads = numThreads;
+        isTuningPme = false;
+    }
+    tuningSteps = 0;
+    tuningDirectTime = 0.0;
+    tuningReciprocalTime = 0.0;
+}
+
 void CpuCalcNonbondedForceKernel::copyParametersToContext(ContextImpl& context, const NonbondedForce& force) {
     if (force.getNumParticles() != numParticles)
         throw OpenMMException("updateParametersInContext: The number of particles has changed");
@@ -767,13 +1024,13 @@ void CpuCalcCustomNonbondedForceKernel::initialize(const System& system, const C
     // Record the exclusions.
 
     numParticles = force.getNumParticles();
-    exclusions.resize(numParticles);
+    vector<pair<int, int> > excludedPairs;
     for (int i = 0; i < force.getNumExclusions(); i++) {
         int particle1, particle2;
         force.getExclusionParticles(i, particle1, particle2);
-        exclusions[particle1].insert(particle2);
-        exclusions[particle2].insert(particle1);
+        excludedPairs.push_back(make_pair(particle1, particle2));
     }
+    exclusions = CpuExclusions(numParticles, excludedPairs);
 
     // Build the arrays.
 
@@ -988,13 +1245,13 @@ void CpuCalcCustomGBForceKernel::initialize(const System& system, const CustomGB
     // Record the exclusions.
 
     numParticles = force.getNumParticles();
-    exclusions.resize(numParticles);
+    vector<pair<int, int> > excludedPairs;
     for (int i = 0; i < force.getNumExclusions(); i++) {
         int particle1, particle2;
         force.getExclusionParticles(i, particle1, particle2);
-        exclusions[particle1].insert(particle2);
-        exclusions[particle2].insert(particle1);
+        excludedPairs.push_back(make_pair(particle1, particle2));
     }
+    exclusions = CpuExclusions(numParticles, excludedPairs);
 
     // Build the arrays.
 
@@ -1111,7 +1368,6 @@ double CpuCalcCustomGBForceKernel::execute(ContextImpl& context, bool includeFor
     if (data.isPeriodic)
         ixn->setPeriodic(extractBoxSize(context));
     if (nonbondedMethod != NoCutoff) {
-        vector<set<int> > noExclusions(numParticles);
         ixn->setUseCutoff(nonbondedCutoff, *data.neighborList);
     }
     map<string, double> globalParameters;
@@ -1245,3 +1501,24 @@ void CpuIntegrateLangevinStepKernel::execute(ContextImpl& context, const Langevi
 double CpuIntegrateLangevinStepKernel::computeKineticEnergy(ContextImpl& context, const LangevinIntegrator& integrator) {
     return computeShiftedKineticEnergy(context, masses, 0.5*integrator.getStepSize());
 }
+
+CpuApplyMonteCarloBarostatKernel::~CpuApplyMonteCarloBarostatKernel() {
+    if (barostat)
+        delete barostat;
+}
+
+void CpuApplyMonteCarloBarostatKernel::initialize(const System& system, const Force& barostat) {
+}
+
+void CpuApplyMonteCarloBarostatKernel::scaleCoordinates(ContextImpl& context, double scaleX, double scaleY, double scaleZ) {
+    if (barostat == NULL)
+        barostat = new CpuMonteCarloBarostat(context.getSystem().getNumParticles(), context.getMolecules(), data.threads);
+    vector<RealVec>& posData = extractPositions(context);
+    RealVec* boxVectors = extractBoxVectors(context);
+    barostat->applyBarostat(posData, boxVectors, scaleX, scaleY, scaleZ);
+}
+
+void CpuApplyMonteCarloBarostatKernel::restoreCoordinates(ContextImpl& context) {
+    vector<RealVec>& posData = extractPositions(context);
+    barostat->restorePositions(posData);
+}
@@ -0,0 +1,130 @@
+
+/* Portions copyright (c) 2006-2015 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors: 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CpuMonteCarloBarostat.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/gmx_atomic.h"
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+class CpuMonteCarloBarostat::ScaleTask : public ThreadPool::Task {
+public:
+    ScaleTask(CpuMonteCarloBarostat& owner) : owner(owner) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        owner.threadScaleMolecules(threadIndex);
+    }
+    CpuMonteCarloBarostat& owner;
+};
+
+CpuMonteCarloBarostat::CpuMonteCarloBarostat(int numAtoms, const vector<vector<int> >& molecules, ThreadPool& threads) :
+        threads(threads), otherPositions(numAtoms), hasSavedPositions(false) {
+    // Record the molecules as a flat list of atoms, with an offset to the start of each one.
+
+    moleculeStart.resize(molecules.size()+1);
+    moleculeAtoms.reserve(numAtoms);
+    moleculeStart[0] = 0;
+    for (int i = 0; i < (int) molecules.size(); i++) {
+        moleculeAtoms.insert(moleculeAtoms.end(), molecules[i].begin(), molecules[i].end());
+        moleculeStart[i+1] = moleculeAtoms.size();
+    }
+    if ((int) moleculeAtoms.size() != numAtoms)
+        throw OpenMMException("CpuMonteCarloBarostat: Every atom must belong to exactly one molecule");
+}
+
+void CpuMonteCarloBarostat::applyBarostat(vector<RealVec>& atomPositions, const RealVec* boxVectors, RealOpenMM scaleX, RealOpenMM scaleY, RealOpenMM scaleZ) {
+    // Record the parameters for the threads.
+
+    oldPositions = &atomPositions[0];
+    newPositions = &otherPositions[0];
+    for (int i = 0; i < 3; i++)
+        this->boxVectors[i] = boxVectors[i];
+    scale = RealVec(scaleX, scaleY, scaleZ);
+    gmx_atomic_t counter;
+    gmx_atomic_set(&counter, 0);
+    atomicCounter = &counter;
+
+    // Signal the threads to start running and wait for them to finish.
+
+    ScaleTask task(*this);
+    threads.execute(task);
+    threads.waitForThreads();
+
+    // The scaled positions become the current ones, and the old ones are kept for restorePositions().
+
+    atomPositions.swap(otherPositions);
+    hasSavedPositions = true;
+}
+
+void CpuMonteCarloBarostat::restorePositions(vector<RealVec>& atomPositions) {
+    if (!hasSavedPositions)
+        throw OpenMMException("CpuMonteCarloBarostat: restorePositions() called without a preceding call to applyBarostat()");
+    atomPositions.swap(otherPositions);
+    hasSavedPositions = false;
+}
+
+void CpuMonteCarloBarostat::threadScaleMolecules(int threadIndex) {
+    // Molecules vary greatly in size, so hand them out in small chunks.
+
+    const int chunkSize = 64;
+    int numMolecules = moleculeStart.size()-1;
+    while (true) {
+        int start = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), chunkSize);
+        if (start >= numMolecules)
+            break;
+        int end = min(start+chunkSize, numMolecules);
+        for (int i = start; i < end; i++) {
+            int first = moleculeStart[i];
+            int last = moleculeStart[i+1];
+
+            // Find the molecule center.
+
+            RealVec pos(0, 0, 0);
+            for (int j = first; j < last; j++)
+                pos += oldPositions[moleculeAtoms[j]];
+            pos /= last-first;
+
+            // Move it into the first periodic box.
+
+            RealVec newPos = pos;
+            newPos -= boxVectors[2]*floor(newPos[2]/boxVectors[2][2]);
+            newPos -= boxVectors[1]*floor(newPos[1]/boxVectors[1][1]);
+            newPos -= boxVectors[0]*floor(newPos[0]/boxVectors[0][0]);
+
+            // Now scale the position of the molecule center.
+
+            newPos[0] *= scale[0];
+            newPos[1] *= scale[1];
+            newPos[2] *= scale[2];
+            RealVec offset = newPos-pos;
+            for (int j = first; j < last; j++) {
+                int atom = moleculeAtoms[j];
+                newPositions[atom] = oldPositions[atom]+offset;
+            }
+        }
+    }
+}
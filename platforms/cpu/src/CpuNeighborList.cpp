@@ -34,8 +34,6 @@
 #include "openmm/internal/vectorize.h"
 #include "hilbert.h"
 #include <algorithm>
-#include <set>
-#include <map>
 #include <cmath>
 
 using namespace std;
@@ -422,13 +420,14 @@ public:
 CpuNeighborList::CpuNeighborList(int blockSize) : blockSize(blockSize) {
 }
 
-void CpuNeighborList::computeNeighborList(int numAtoms, const AlignedArray<float>& atomLocations, const vector<set<int> >& exclusions,
+void CpuNeighborList::computeNeighborList(int numAtoms, const AlignedArray<float>& atomLocations, const CpuExclusions& exclusions,
             const RealVec* periodicBoxVectors, bool usePeriodic, float maxDistance, ThreadPool& threads) {
     int numBlocks = (numAtoms+blockSize-1)/blockSize;
     blockNeighbors.resize(numBlocks);
     blockExclusions.resize(numBlocks);
     sortedAtoms.resize(numAtoms);
     sortedPositions.resize(4*numAtoms);
+    threadAtomFlags.resize(threads.getNumThreads());
     
     // Record the parameters for the threads.
     
@@ -487,7 +486,7 @@ void CpuNeighborList::computeNeighborList(int numAtoms, const AlignedArray<float
 
     // Signal the threads to start running and wait for them to finish.
     
-    gmx_atomic_set(&atomicCounter, 0);
+    blockRange.reset(numBlocks, 1, threads.getNumThreads());
     threads.resumeThreads();
     threads.waitForThreads();
     
@@ -544,64 +543,66 @@ void CpuNeighborList::threadComputeNeighborList(ThreadPool& threads, int threadI
 
     // Compute this thread's subset of neighbors.
 
-    int numBlocks = blockNeighbors.size();
     vector<int> blockAtoms;
     vector<float> blockAtomX(blockSize), blockAtomY(blockSize), blockAtomZ(blockSize);
     vector<VoxelIndex> atomVoxelIndex;
-    while (true) {
-        int i = gmx_atomic_fetch_add(&atomicCounter, 1);
-        if (i >= numBlocks)
-            break;
-
-        // Find the atoms in this block and compute their bounding box.
+    vector<char>& atomFlags = threadAtomFlags[threadIndex];
+    if ((int) atomFlags.size() != numAtoms)
+        atomFlags.assign(numAtoms, 0);
+    vector<int> flaggedAtoms;
+    int start, end;
+    while (blockRange.getNextChunk(threadIndex, start, end)) {
+        for (int i = start; i < end; i++) {
+            // Find the atoms in this block and compute their bounding box.
         
-        int firstIndex = blockSize*i;
-        int atomsInBlock = min(blockSize, numAtoms-firstIndex);
-        blockAtoms.resize(atomsInBlock);
-        atomVoxelIndex.resize(atomsInBlock);
-        for (int j = 0; j < atomsInBlock; j++) {
-            blockAtoms[j] = sortedAtoms[firstIndex+j];
-            atomVoxelIndex[j] = voxels->getVoxelIndex(&atomLocations[4*blockAtoms[j]]);
-        }
-        fvec4 minPos(&sortedPositions[4*firstIndex]);
-        fvec4 maxPos = minPos;
-        for (int j = 1; j < atomsInBlock; j++) {
-            fvec4 pos(&sortedPositions[4*(firstIndex+j)]);
-            minPos = min(minPos, pos);
-            maxPos = max(maxPos, pos);
-        }
-        for (int j = 0; j < atomsInBlock; j++) {
-            blockAtomX[j] = sortedPositions[4*(firstIndex+j)];
-            blockAtomY[j] = sortedPositions[4*(firstIndex+j)+1];
-            blockAtomZ[j] = sortedPositions[4*(firstIndex+j)+2];
-        }
-        for (int j = atomsInBlock; j < blockSize; j++) {
-            blockAtomX[j] = 1e10;
-            blockAtomY[j] = 1e10;
-            blockAtomZ[j] = 1e10;
-        }
-        voxels->getNeighbors(blockNeighbors[i], i, (maxPos+minPos)*0.5f, (maxPos-minPos)*0.5f, sortedAtoms, blockExclusions[i], maxDistance, blockAtoms, blockAtomX, blockAtomY, blockAtomZ, sortedPositions, atomVoxelIndex);
-
-        // Record the exclusions for this block.
-
-        map<int, char> atomFlags;
-        for (int j = 0; j < atomsInBlock; j++) {
-            const set<int>& atomExclusions = (*exclusions)[sortedAtoms[firstIndex+j]];
-            char mask = 1<<j;
-            for (set<int>::const_iterator iter = atomExclusions.begin(); iter != atomExclusions.end(); ++iter) {
-                map<int, char>::iterator thisAtomFlags = atomFlags.find(*iter);
-                if (thisAtomFlags == atomFlags.end())
-                    atomFlags[*iter] = mask;
-                else
-                    thisAtomFlags->second |= mask;
+            int firstIndex = blockSize*i;
+            int atomsInBlock = min(blockSize, numAtoms-firstIndex);
+            blockAtoms.resize(atomsInBlock);
+            atomVoxelIndex.resize(atomsInBlock);
+            for (int j = 0; j < atomsInBlock; j++) {
+                blockAtoms[j] = sortedAtoms[firstIndex+j];
+                atomVoxelIndex[j] = voxels->getVoxelIndex(&atomLocations[4*blockAtoms[j]]);
+            }
+            fvec4 minPos(&sortedPositions[4*firstIndex]);
+            fvec4 maxPos = minPos;
+            for (int j = 1; j < atomsInBlock; j++) {
+                fvec4 pos(&sortedPositions[4*(firstIndex+j)]);
+                minPos = min(minPos, pos);
+                maxPos = max(maxPos, pos);
+            }
+            for (int j = 0; j < atomsInBlock; j++) {
+                blockAtomX[j] = sortedPositions[4*(firstIndex+j)];
+                blockAtomY[j] = sortedPositions[4*(firstIndex+j)+1];
+                blockAtomZ[j] = sortedPositions[4*(firstIndex+j)+2];
+            }
+            for (int j = atomsInBlock; j < blockSize; j++) {
+                blockAtomX[j] = 1e10;
+                blockAtomY[j] = 1e10;
+                blockAtomZ[j] = 1e10;
+            }
+            voxels->getNeighbors(blockNeighbors[i], i, (maxPos+minPos)*0.5f, (maxPos-minPos)*0.5f, sortedAtoms, blockExclusions[i], maxDistance, blockAtoms, blockAtomX, blockAtomY, blockAtomZ, sortedPositions, atomVoxelIndex);
+
+            // Record the exclusions for this block.
+
+            for (int j = 0; j < atomsInBlock; j++) {
+                int atom = sortedAtoms[firstIndex+j];
+                const int* atomExclusions = exclusions->getExclusions(atom);
+                int numExclusions = exclusions->getNumExclusions(atom);
+                char mask = 1<<j;
+                for (int k = 0; k < numExclusions; k++) {
+                    if (atomFlags[atomExclusions[k]] == 0)
+                        flaggedAtoms.push_back(atomExclusions[k]);
+                    atomFlags[atomExclusions[k]] |= mask;
+                }
+            }
+            if (flaggedAtoms.size() > 0) {
+                int numNeighbors = blockNeighbors[i].size();
+                for (int k = 0; k < numNeighbors; k++)
+                    blockExclusions[i][k] |= atomFlags[blockNeighbors[i][k]];
+                for (int k = 0; k < (int) flaggedAtoms.size(); k++)
+                    atomFlags[flaggedAtoms[k]] = 0;
+                flaggedAtoms.clear();
             }
-        }
-        int numNeighbors = blockNeighbors[i].size();
-        for (int k = 0; k < numNeighbors; k++) {
-            int atomIndex = blockNeighbors[i][k];
-            map<int, char>::iterator thisAtomFlags = atomFlags.find(atomIndex);
-            if (thisAtomFlags != atomFlags.end())
-                blockExclusions[i][k] |= thisAtomFlags->second;
         }
     }
 }
@@ -28,7 +28,6 @@
 #include "CpuNonbondedForce.h"
 #include "ReferenceForce.h"
 #include "ReferencePME.h"
-#include "openmm/internal/gmx_atomic.h"
 #include <algorithm>
 
 // In case we're using some primitive version of Visual Studio this will
@@ -57,7 +56,8 @@ public:
 
    --------------------------------------------------------------------------------------- */
 
-CpuNonbondedForce::CpuNonbondedForce() : cutoff(false), useSwitch(false), periodic(false), ewald(false), pme(false), tableIsValid(false), cutoffDistance(0.0f), alphaEwald(0.0f) {
+CpuNonbondedForce::CpuNonbondedForce() : cutoff(false), useSwitch(false), periodic(false), ewald(false), pme(false), tableIsValid(false), neighborList(NULL), bondForceQueue(NULL), maxThreads(0),
+        cutoffDistance(0.0f), alphaEwald(0.0f) {
 }
 
 CpuNonbondedForce::~CpuNonbondedForce() {
@@ -170,6 +170,31 @@ void CpuNonbondedForce::setUseSwitchingFunction(float distance) {
       tabulateEwaldScaleFactor();
   }
 
+  /**---------------------------------------------------------------------------------------
+
+     Set a queue of bonded forces for the threads to compute at the same time as the direct
+     space interactions.
+
+     @param queue    the queue to process, or NULL to not compute any bonded forces
+
+     --------------------------------------------------------------------------------------- */
+
+  void CpuNonbondedForce::setBondForceQueue(CpuBondForceQueue* queue) {
+      bondForceQueue = queue;
+  }
+
+  /**---------------------------------------------------------------------------------------
+
+     Set the maximum number of threads from the pool to use for direct space interactions.
+
+     @param maxThreads    the maximum number of threads to use, or 0 to use all of them
+
+     --------------------------------------------------------------------------------------- */
+
+  void CpuNonbondedForce::setMaxThreads(int maxThreads) {
+      this->maxThreads = maxThreads;
+  }
+
   
   void CpuNonbondedForce::tabulateEwaldScaleFactor() {
     if (tableIsValid)
@@ -189,7 +214,7 @@ void CpuNonbondedForce::setUseSwitchingFunction(float distance) {
 }
   
 void CpuNonbondedForce::calculateReciprocalIxn(int numberOfAtoms, float* posq, const vector<RealVec>& atomCoordinates,
-                                             const vector<pair<float, float> >& atomParameters, const vector<set<int> >& exclusions,
+                                             const vector<pair<float, float> >& atomParameters, const CpuExclusions& exclusions,
                                              vector<RealVec>& forces, double* totalEnergy) const {
     typedef std::complex<float> d_complex;
 
@@ -301,20 +326,40 @@ void CpuNonbondedForce::calculateReciprocalIxn(int numberOfAtoms, float* posq, c
 
 
 void CpuNonbondedForce::calculateDirectIxn(int numberOfAtoms, float* posq, const vector<RealVec>& atomCoordinates, const vector<pair<float, float> >& atomParameters,
-                const vector<set<int> >& exclusions, vector<AlignedArray<float> >& threadForce, double* totalEnergy, ThreadPool& threads) {
+                const CpuExclusions& exclusions, vector<AlignedArray<float> >& threadForce, double* totalEnergy, ThreadPool& threads) {
+    this->threadForce = &threadForce;
+    this->threadForceDouble = NULL;
+    runDirectIxn(numberOfAtoms, posq, atomCoordinates, atomParameters, exclusions, totalEnergy, threads);
+}
+
+void CpuNonbondedForce::calculateDirectIxn(int numberOfAtoms, float* posq, const vector<RealVec>& atomCoordinates, const vector<pair<float, float> >& atomParameters,
+                const CpuExclusions& exclusions, vector<AlignedArray<double> >& threadForce, double* totalEnergy, ThreadPool& threads) {
+    this->threadForce = NULL;
+    this->threadForceDouble = &threadForce;
+    runDirectIxn(numberOfAtoms, posq, atomCoordinates, atomParameters, exclusions, totalEnergy, threads);
+}
+
+void CpuNonbondedForce::runDirectIxn(int numberOfAtoms, float* posq, const vector<RealVec>& atomCoordinates, const vector<pair<float, float> >& atomParameters,
+                const CpuExclusions& exclusions, double* totalEnergy, ThreadPool& threads) {
     // Record the parameters for the threads.
     
     this->numberOfAtoms = numberOfAtoms;
     this->posq = posq;
     this->atomCoordinates = &atomCoordinates[0];
     this->atomParameters = &atomParameters[0];
-    this->exclusions = &exclusions[0];
-    this->threadForce = &threadForce;
+    this->exclusions = &exclusions;
     includeEnergy = (totalEnergy != NULL);
-    threadEnergy.resize(threads.getNumThreads());
-    gmx_atomic_t counter;
-    gmx_atomic_set(&counter, 0);
-    this->atomicCounter = &counter;
+    int numThreads = threads.getNumThreads();
+    threadEnergy.resize(numThreads);
+    numActiveThreads = (maxThreads > 0 && maxThreads < numThreads ? maxThreads : numThreads);
+    if (ewald || pme) {
+        blockRange.reset(neighborList->getNumBlocks(), 1, numActiveThreads);
+        exclusionRange.reset(numberOfAtoms, max(1, numberOfAtoms/(10*numActiveThreads)), numActiveThreads);
+    }
+    else if (cutoff)
+        blockRange.reset(neighborList->getNumBlocks(), 1, numActiveThreads);
+    else
+        blockRange.reset(numberOfAtoms, 1, numActiveThreads);
     
     // Signal the threads to start running and wait for them to finish.
     
@@ -322,14 +367,6 @@ void CpuNonbondedForce::calculateDirectIxn(int numberOfAtoms, float* posq, const
     threads.execute(task);
     threads.waitForThreads();
     
-    // Signal the threads to subtract the exclusions.
-    
-    if (ewald || pme) {
-        gmx_atomic_set(&counter, 0);
-        threads.resumeThreads();
-        threads.waitForThreads();
-    }
-    
     // Combine the energies from all the threads.
     
     if (totalEnergy != NULL) {
@@ -342,39 +379,50 @@ void CpuNonbondedForce::calculateDirectIxn(int numberOfAtoms, float* posq, const
 }
 
 void CpuNonbondedForce::threadComputeDirect(ThreadPool& threads, int threadIndex) {
+    // Compute this thread's share of any queued bonded forces first.  The nonbonded blocks are divided
+    // dynamically, so the other threads will take up the slack while this one is busy.
+
+    if (bondForceQueue != NULL)
+        bondForceQueue->threadComputeForces(threads, threadIndex);
+    if (threadIndex >= numActiveThreads) {
+        threadEnergy[threadIndex] = 0;
+        return;
+    }
+    if (threadForceDouble != NULL)
+        threadComputeDirect(threads, threadIndex, &(*threadForceDouble)[threadIndex][0]);
+    else
+        threadComputeDirect(threads, threadIndex, &(*threadForce)[threadIndex][0]);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForce::threadComputeDirect(ThreadPool& threads, int threadIndex, FORCE_TYPE* forces) {
     // Compute this thread's subset of interactions.
 
-    int numThreads = threads.getNumThreads();
     threadEnergy[threadIndex] = 0;
     double* energyPtr = (includeEnergy ? &threadEnergy[threadIndex] : NULL);
-    float* forces = &(*threadForce)[threadIndex][0];
     fvec4 boxSize(periodicBoxVectors[0][0], periodicBoxVectors[1][1], periodicBoxVectors[2][2], 0);
     fvec4 invBoxSize(recipBoxSize[0], recipBoxSize[1], recipBoxSize[2], 0);
     if (ewald || pme) {
         // Compute the interactions from the neighbor list.
 
-        while (true) {
-            int nextBlock = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
-            if (nextBlock >= neighborList->getNumBlocks())
-                break;
-            calculateBlockEwaldIxn(nextBlock, forces, energyPtr, boxSize, invBoxSize);
-        }
+        int start, end;
+        while (blockRange.getNextChunk(threadIndex, start, end))
+            for (int block = start; block < end; block++)
+                calculateBlockEwaldIxn(block, forces, energyPtr, boxSize, invBoxSize);
 
         // Now subtract off the exclusions, since they were implicitly included in the reciprocal space sum.
+        // This only adds to the thread's own force array, so threads can move on to it without waiting for
+        // the others to finish their blocks.
 
-        threads.syncThreads();
-        const int groupSize = max(1, numberOfAtoms/(10*numThreads));
-        while (true) {
-            int start = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), groupSize);
-            if (start >= numberOfAtoms)
-                break;
-            int end = min(start+groupSize, numberOfAtoms);
+        while (exclusionRange.getNextChunk(threadIndex, start, end)) {
             for (int i = start; i < end; i++) {
                fvec4 posI((float) atomCoordinates[i][0], (float) atomCoordinates[i][1], (float) atomCoordinates[i][2], 0.0f);
                 float scaledChargeI = (float) (ONE_4PI_EPS0*posq[4*i+3]);
-                for (set<int>::const_iterator iter = exclusions[i].begin(); iter != exclusions[i].end(); ++iter) {
-                    if (*iter > i) {
-                        int j = *iter;
+                const int* atomExclusions = exclusions->getExclusions(i);
+                int numExclusions = exclusions->getNumExclusions(i);
+                for (int k = 0; k < numExclusions; k++) {
+                    if (atomExclusions[k] > i) {
+                        int j = atomExclusions[k];
                         fvec4 deltaR;
                         fvec4 posJ((float) atomCoordinates[j][0], (float) atomCoordinates[j][1], (float) atomCoordinates[j][2], 0.0f);
                         float r2;
@@ -388,8 +436,8 @@ void CpuNonbondedForce::threadComputeDirect(ThreadPool& threads, int threadIndex
                             float dEdR = chargeProdOverR*inverseR*inverseR;
                             dEdR = dEdR * (erfAlphaR-(float)TWO_OVER_SQRT_PI*alphaR*(float)exp(-alphaR*alphaR));
                             fvec4 result = deltaR*dEdR;
-                            (fvec4(forces+4*i)-result).store(forces+4*i);
-                            (fvec4(forces+4*j)+result).store(forces+4*j);
+                            addForce(forces, i, -result);
+                            addForce(forces, j, result);
                             if (includeEnergy)
                                 threadEnergy[threadIndex] -= chargeProdOverR*erfAlphaR;
                         }
@@ -401,28 +449,36 @@ void CpuNonbondedForce::threadComputeDirect(ThreadPool& threads, int threadIndex
     else if (cutoff) {
         // Compute the interactions from the neighbor list.
 
-        while (true) {
-            int nextBlock = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
-            if (nextBlock >= neighborList->getNumBlocks())
-                break;
-            calculateBlockIxn(nextBlock, forces, energyPtr, boxSize, invBoxSize);
-        }
+        int start, end;
+        while (blockRange.getNextChunk(threadIndex, start, end))
+            for (int block = start; block < end; block++)
+                calculateBlockIxn(block, forces, energyPtr, boxSize, invBoxSize);
     }
     else {
         // Loop over all atom pairs
 
-        while (true) {
-            int i = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
-            if (i >= numberOfAtoms)
-                break;
-            for (int j = i+1; j < numberOfAtoms; j++)
-                if (exclusions[j].find(i) == exclusions[j].end())
-                    calculateOneIxn(i, j, forces, energyPtr, boxSize, invBoxSize);
+        int start, end;
+        while (blockRange.getNextChunk(threadIndex, start, end)) {
+            for (int i = start; i < end; i++) {
+                // Walk through this atom's sorted exclusions in step with j to skip the excluded pairs.
+
+                const int* nextExclusion = exclusions->getExclusions(i);
+                const int* lastExclusion = nextExclusion+exclusions->getNumExclusions(i);
+                while (nextExclusion != lastExclusion && *nextExclusion <= i)
+                    nextExclusion++;
+                for (int j = i+1; j < numberOfAtoms; j++) {
+                    if (nextExclusion != lastExclusion && *nextExclusion == j)
+                        nextExclusion++;
+                    else
+                        calculateOneIxn(i, j, forces, energyPtr, boxSize, invBoxSize);
+                }
+            }
         }
     }
 }
 
-void CpuNonbondedForce::calculateOneIxn(int ii, int jj, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+template <class FORCE_TYPE>
+void CpuNonbondedForce::calculateOneIxn(int ii, int jj, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
     // get deltaR, R2, and R between 2 atoms
 
     fvec4 deltaR;
@@ -472,8 +528,8 @@ void CpuNonbondedForce::calculateOneIxn(int ii, int jj, float* forces, double* t
     // accumulate forces
 
     fvec4 result = deltaR*dEdR;
-    (fvec4(forces+4*ii)+result).store(forces+4*ii);
-    (fvec4(forces+4*jj)-result).store(forces+4*jj);
+    addForce(forces, ii, result);
+    addForce(forces, jj, -result);
   }
 
 void CpuNonbondedForce::getDeltaR(const fvec4& posI, const fvec4& posJ, fvec4& deltaR, float& r2, bool periodic, const fvec4& boxSize, const fvec4& invBoxSize) const {
@@ -0,0 +1,541 @@
+
+/* Portions copyright (c) 2006-2016 Stanford University and Simbios.
+ * Contributors: Pande Group
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SimTKOpenMMUtilities.h"
+#include "CpuNonbondedForceVec16.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/hardware.h"
+#include <algorithm>
+
+using namespace std;
+using namespace OpenMM;
+
+#ifndef __AVX512F__
+bool isVec16Supported() {
+    return false;
+}
+
+CpuNonbondedForce* createCpuNonbondedForceVec16() {
+    throw OpenMMException("Internal error: OpenMM was compiled without AVX-512 support");
+}
+#else
+bool isVec8Supported();
+
+/**
+ * Check whether 16 component vectors are supported with the current CPU.
+ */
+bool isVec16Supported() {
+    // Make sure the CPU supports AVX-512F, and that the operating system saves the AVX-512 registers
+    // (opmask, upper halves of ZMM0-15, and ZMM16-31) on context switches.
+
+    if (!isVec8Supported())
+        return false;
+    int cpuInfo[4];
+    cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7)
+        return false;
+    cpuid(cpuInfo, 1);
+    if ((cpuInfo[2] & ((int) 1 << 27)) == 0)
+        return false; // OSXSAVE is not enabled.
+    cpuid(cpuInfo, 7);
+    if ((cpuInfo[1] & ((int) 1 << 16)) == 0)
+        return false;
+#ifdef _MSC_VER
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    unsigned long long xcr0 = ((unsigned long long) edx << 32) | eax;
+#endif
+    return ((xcr0 & 0xE6) == 0xE6);
+}
+
+/**
+ * Factory method to create a CpuNonbondedForceVec16.
+ */
+CpuNonbondedForce* createCpuNonbondedForceVec16() {
+    return new CpuNonbondedForceVec16();
+}
+
+/**---------------------------------------------------------------------------------------
+
+   CpuNonbondedForceVec16 constructor
+
+   --------------------------------------------------------------------------------------- */
+
+CpuNonbondedForceVec16::CpuNonbondedForceVec16() {
+}
+
+enum PeriodicType {NoPeriodic, PeriodicPerAtom, PeriodicPerInteraction, PeriodicTriclinic};
+
+/**
+ * This accumulates the forces on the atoms in a block, and subtracts the opposite forces from the
+ * two neighbors processed in each iteration.  The lower half of each vector holds the interactions
+ * with the first neighbor and the upper half those with the second.  With a single precision force
+ * array, the block forces are summed in vector registers.  With a double precision array (mixed
+ * precision mode), every sum is done in double precision.
+ */
+template <class FORCE_TYPE>
+class BlockForces16;
+
+template <>
+class BlockForces16<float> {
+public:
+    BlockForces16() : x(0.0f), y(0.0f), z(0.0f) {
+    }
+    void add(float* forces, int atom1, int atom2, bool hasSecond, const fvec16& fx, const fvec16& fy, const fvec16& fz) {
+        x += fx;
+        y += fy;
+        z += fz;
+        float* atomForce1 = forces+4*atom1;
+        atomForce1[0] -= reduceAdd(fx, 0x00FF);
+        atomForce1[1] -= reduceAdd(fy, 0x00FF);
+        atomForce1[2] -= reduceAdd(fz, 0x00FF);
+        if (hasSecond) {
+            float* atomForce2 = forces+4*atom2;
+            atomForce2[0] -= reduceAdd(fx, 0xFF00);
+            atomForce2[1] -= reduceAdd(fy, 0xFF00);
+            atomForce2[2] -= reduceAdd(fz, 0xFF00);
+        }
+    }
+    void store(float* forces, const int* blockAtom) {
+        fvec4 f[8];
+        transpose(x.lowerVec()+x.upperVec(), y.lowerVec()+y.upperVec(), z.lowerVec()+z.upperVec(), 0.0f, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
+        for (int j = 0; j < 8; j++)
+            (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+    }
+private:
+    fvec16 x, y, z;
+};
+
+template <>
+class BlockForces16<double> {
+public:
+    BlockForces16() {
+        for (int j = 0; j < 8; j++)
+            x[j] = y[j] = z[j] = 0.0;
+    }
+    void add(double* forces, int atom1, int atom2, bool hasSecond, const fvec16& fx, const fvec16& fy, const fvec16& fz) {
+        float f[3][16];
+        fx.store(f[0]);
+        fy.store(f[1]);
+        fz.store(f[2]);
+        double sum1[3] = {0.0, 0.0, 0.0};
+        double sum2[3] = {0.0, 0.0, 0.0};
+        for (int j = 0; j < 8; j++) {
+            x[j] += (double) f[0][j] + f[0][j+8];
+            y[j] += (double) f[1][j] + f[1][j+8];
+            z[j] += (double) f[2][j] + f[2][j+8];
+            for (int k = 0; k < 3; k++) {
+                sum1[k] += f[k][j];
+                sum2[k] += f[k][j+8];
+            }
+        }
+        for (int k = 0; k < 3; k++)
+            forces[4*atom1+k] -= sum1[k];
+        if (hasSecond)
+            for (int k = 0; k < 3; k++)
+                forces[4*atom2+k] -= sum2[k];
+    }
+    void store(double* forces, const int* blockAtom) {
+        for (int j = 0; j < 8; j++) {
+            forces[4*blockAtom[j]] += x[j];
+            forces[4*blockAtom[j]+1] += y[j];
+            forces[4*blockAtom[j]+2] += z[j];
+        }
+    }
+private:
+    double x[8], y[8], z[8];
+};
+
+void CpuNonbondedForceVec16::calculateBlockIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+void CpuNonbondedForceVec16::calculateBlockIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForceVec16::computeBlockIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    // Determine whether we need to apply periodic boundary conditions.
+    
+    PeriodicType periodicType;
+    fvec4 blockCenter;
+    if (!periodic) {
+        periodicType = NoPeriodic;
+        blockCenter = 0.0f;
+    }
+    else {
+        const int* blockAtom = &neighborList->getSortedAtoms()[8*blockIndex];
+        float minx, maxx, miny, maxy, minz, maxz;
+        minx = maxx = posq[4*blockAtom[0]];
+        miny = maxy = posq[4*blockAtom[0]+1];
+        minz = maxz = posq[4*blockAtom[0]+2];
+        for (int i = 1; i < 8; i++) {
+            minx = min(minx, posq[4*blockAtom[i]]);
+            maxx = max(maxx, posq[4*blockAtom[i]]);
+            miny = min(miny, posq[4*blockAtom[i]+1]);
+            maxy = max(maxy, posq[4*blockAtom[i]+1]);
+            minz = min(minz, posq[4*blockAtom[i]+2]);
+            maxz = max(maxz, posq[4*blockAtom[i]+2]);
+        }
+        blockCenter = fvec4(0.5f*(minx+maxx), 0.5f*(miny+maxy), 0.5f*(minz+maxz), 0.0f);
+        if (!(minx < cutoffDistance || miny < cutoffDistance || minz < cutoffDistance ||
+                maxx > boxSize[0]-cutoffDistance || maxy > boxSize[1]-cutoffDistance || maxz > boxSize[2]-cutoffDistance))
+            periodicType = NoPeriodic;
+        else if (triclinic)
+            periodicType = PeriodicTriclinic;
+        else if (0.5f*(boxSize[0]-(maxx-minx)) >= cutoffDistance &&
+                 0.5f*(boxSize[1]-(maxy-miny)) >= cutoffDistance &&
+                 0.5f*(boxSize[2]-(maxz-minz)) >= cutoffDistance)
+            periodicType = PeriodicPerAtom;
+        else
+            periodicType = PeriodicPerInteraction;
+    }
+    
+    // Call the appropriate version depending on what calculation is required for periodic boundary conditions.
+    
+    if (periodicType == NoPeriodic)
+        calculateBlockIxnImpl<NoPeriodic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    else if (periodicType == PeriodicPerAtom)
+        calculateBlockIxnImpl<PeriodicPerAtom>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    else if (periodicType == PeriodicPerInteraction)
+        calculateBlockIxnImpl<PeriodicPerInteraction>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    else if (periodicType == PeriodicTriclinic)
+        calculateBlockIxnImpl<PeriodicTriclinic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+}
+
+template <int PERIODIC_TYPE, class FORCE_TYPE>
+void CpuNonbondedForceVec16::calculateBlockIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+    // Load the positions and parameters of the atoms in the block.  Each value is duplicated into
+    // both halves of a vector, so the block can be paired with two neighbors at once.
+    
+    const int* blockAtom = &neighborList->getSortedAtoms()[8*blockIndex];
+    fvec4 blockAtomPosq[8];
+    BlockForces16<FORCE_TYPE> blockForces;
+    fvec8 x, y, z, q;
+    for (int i = 0; i < 8; i++) {
+        blockAtomPosq[i] = fvec4(posq+4*blockAtom[i]);
+        if (PERIODIC_TYPE == PeriodicPerAtom)
+            blockAtomPosq[i] -= floor((blockAtomPosq[i]-blockCenter)*invBoxSize+0.5f)*boxSize;
+    }
+    transpose(blockAtomPosq[0], blockAtomPosq[1], blockAtomPosq[2], blockAtomPosq[3], blockAtomPosq[4], blockAtomPosq[5], blockAtomPosq[6], blockAtomPosq[7], x, y, z, q);
+    fvec16 blockAtomX(x, x), blockAtomY(y, y), blockAtomZ(z, z), blockAtomCharge(q, q);
+    blockAtomCharge *= ONE_4PI_EPS0;
+    fvec8 sigma(atomParameters[blockAtom[0]].first, atomParameters[blockAtom[1]].first, atomParameters[blockAtom[2]].first, atomParameters[blockAtom[3]].first, atomParameters[blockAtom[4]].first, atomParameters[blockAtom[5]].first, atomParameters[blockAtom[6]].first, atomParameters[blockAtom[7]].first);
+    fvec8 epsilon(atomParameters[blockAtom[0]].second, atomParameters[blockAtom[1]].second, atomParameters[blockAtom[2]].second, atomParameters[blockAtom[3]].second, atomParameters[blockAtom[4]].second, atomParameters[blockAtom[5]].second, atomParameters[blockAtom[6]].second, atomParameters[blockAtom[7]].second);
+    fvec16 blockAtomSigma(sigma, sigma), blockAtomEpsilon(epsilon, epsilon);
+    const bool needPeriodic = (PERIODIC_TYPE == PeriodicPerInteraction || PERIODIC_TYPE == PeriodicTriclinic);
+    const float invSwitchingInterval = 1/(cutoffDistance-switchingDistance);
+    
+    // Loop over neighbors for this block, two at a time.
+    
+    const vector<int>& neighbors = neighborList->getBlockNeighbors(blockIndex);
+    const vector<char>& exclusions = neighborList->getBlockExclusions(blockIndex);
+    int numNeighbors = neighbors.size();
+    for (int i = 0; i < numNeighbors; i += 2) {
+        // Load the next two neighbors.  If only one is left, the upper half of every vector is excluded.
+        
+        bool hasSecond = (i+1 < numNeighbors);
+        int atom1 = neighbors[i];
+        int atom2 = (hasSecond ? neighbors[i+1] : atom1);
+        int excl = ((unsigned char) exclusions[i]) | ((hasSecond ? (unsigned char) exclusions[i+1] : 0xFF)<<8);
+        
+        // Compute the distances to the block atoms.
+        
+        fvec16 dx, dy, dz, r2;
+        fvec4 atomPos1(posq+4*atom1), atomPos2(posq+4*atom2);
+        if (PERIODIC_TYPE == PeriodicPerAtom) {
+            atomPos1 -= floor((atomPos1-blockCenter)*invBoxSize+0.5f)*boxSize;
+            atomPos2 -= floor((atomPos2-blockCenter)*invBoxSize+0.5f)*boxSize;
+        }
+        getDeltaR<PERIODIC_TYPE>(atomPos1, atomPos2, blockAtomX, blockAtomY, blockAtomZ, dx, dy, dz, r2, needPeriodic, boxSize, invBoxSize);
+        __mmask16 include = (~excl) & (r2 < cutoffDistance*cutoffDistance);
+        if (!any(include))
+            continue; // No interactions to compute.
+        
+        // Compute the interactions.
+        
+        fvec16 inverseR = rsqrt(r2);
+        fvec16 energy, dEdR;
+        float atomEpsilon1 = atomParameters[atom1].second;
+        float atomEpsilon2 = atomParameters[atom2].second;
+        if (atomEpsilon1 != 0.0f || atomEpsilon2 != 0.0f) {
+            fvec16 sig = blockAtomSigma+fvec16(fvec8(atomParameters[atom1].first), fvec8(atomParameters[atom2].first));
+            fvec16 sig2 = inverseR*sig;
+            sig2 *= sig2;
+            fvec16 sig6 = sig2*sig2*sig2;
+            fvec16 epsSig6 = blockAtomEpsilon*fvec16(fvec8(atomEpsilon1), fvec8(atomEpsilon2))*sig6;
+            dEdR = epsSig6*fmadd(12.0f, sig6, -6.0f);
+            energy = epsSig6*(sig6-1.0f);
+            if (useSwitch) {
+                fvec16 r = r2*inverseR;
+                fvec16 t = blend(0.0f, (r-switchingDistance)*invSwitchingInterval, r > switchingDistance);
+                fvec16 switchValue = 1+t*t*t*(-10.0f+t*(15.0f-t*6.0f));
+                fvec16 switchDeriv = t*t*(-30.0f+t*(60.0f-t*30.0f))*invSwitchingInterval;
+                dEdR = switchValue*dEdR - energy*switchDeriv*r;
+                energy *= switchValue;
+            }
+        }
+        else {
+            energy = 0.0f;
+            dEdR = 0.0f;
+        }
+        fvec16 chargeProd = blockAtomCharge*fvec16(fvec8(posq[4*atom1+3]), fvec8(posq[4*atom2+3]));
+        if (cutoff)
+            dEdR += chargeProd*(inverseR-2.0f*krf*r2);
+        else
+            dEdR += chargeProd*inverseR;
+        dEdR *= inverseR*inverseR;
+
+        // Accumulate energies.
+
+        if (totalEnergy) {
+            if (cutoff)
+                energy += chargeProd*(inverseR+krf*r2-crf);
+            else
+                energy += chargeProd*inverseR;
+            *totalEnergy += reduceAdd(energy, include);
+        }
+
+        // Accumulate forces.
+
+        dEdR = blend(0.0f, dEdR, include);
+        fvec16 fx = dx*dEdR;
+        fvec16 fy = dy*dEdR;
+        fvec16 fz = dz*dEdR;
+        blockForces.add(forces, atom1, atom2, hasSecond, fx, fy, fz);
+    }
+    
+    // Record the forces on the block atoms.
+
+    blockForces.store(forces, blockAtom);
+}
+
+void CpuNonbondedForceVec16::calculateBlockEwaldIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockEwaldIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+void CpuNonbondedForceVec16::calculateBlockEwaldIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockEwaldIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForceVec16::computeBlockEwaldIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    // Determine whether we need to apply periodic boundary conditions.
+    
+    PeriodicType periodicType;
+    fvec4 blockCenter;
+    if (!periodic) {
+        periodicType = NoPeriodic;
+        blockCenter = 0.0f;
+    }
+    else {
+        const int* blockAtom = &neighborList->getSortedAtoms()[8*blockIndex];
+        float minx, maxx, miny, maxy, minz, maxz;
+        minx = maxx = posq[4*blockAtom[0]];
+        miny = maxy = posq[4*blockAtom[0]+1];
+        minz = maxz = posq[4*blockAtom[0]+2];
+        for (int i = 1; i < 8; i++) {
+            minx = min(minx, posq[4*blockAtom[i]]);
+            maxx = max(maxx, posq[4*blockAtom[i]]);
+            miny = min(miny, posq[4*blockAtom[i]+1]);
+            maxy = max(maxy, posq[4*blockAtom[i]+1]);
+            minz = min(minz, posq[4*blockAtom[i]+2]);
+            maxz = max(maxz, posq[4*blockAtom[i]+2]);
+        }
+        blockCenter = fvec4(0.5f*(minx+maxx), 0.5f*(miny+maxy), 0.5f*(minz+maxz), 0.0f);
+        if (!(minx < cutoffDistance || miny < cutoffDistance || minz < cutoffDistance ||
+                maxx > boxSize[0]-cutoffDistance || maxy > boxSize[1]-cutoffDistance || maxz > boxSize[2]-cutoffDistance))
+            periodicType = NoPeriodic;
+        else if (triclinic)
+            periodicType = PeriodicTriclinic;
+        else if (0.5f*(boxSize[0]-(maxx-minx)) >= cutoffDistance &&
+                 0.5f*(boxSize[1]-(maxy-miny)) >= cutoffDistance &&
+                 0.5f*(boxSize[2]-(maxz-minz)) >= cutoffDistance)
+            periodicType = PeriodicPerAtom;
+        else
+            periodicType = PeriodicPerInteraction;
+    }
+    
+    // Call the appropriate version depending on what calculation is required for periodic boundary conditions.
+    
+    if (periodicType == NoPeriodic)
+        calculateBlockEwaldIxnImpl<NoPeriodic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    else if (periodicType == PeriodicPerAtom)
+        calculateBlockEwaldIxnImpl<PeriodicPerAtom>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    else if (periodicType == PeriodicPerInteraction)
+        calculateBlockEwaldIxnImpl<PeriodicPerInteraction>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    else if (periodicType == PeriodicTriclinic)
+        calculateBlockEwaldIxnImpl<PeriodicTriclinic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+}
+
+template <int PERIODIC_TYPE, class FORCE_TYPE>
+void CpuNonbondedForceVec16::calculateBlockEwaldIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+    // Load the positions and parameters of the atoms in the block.  Each value is duplicated into
+    // both halves of a vector, so the block can be paired with two neighbors at once.
+    
+    const int* blockAtom = &neighborList->getSortedAtoms()[8*blockIndex];
+    fvec4 blockAtomPosq[8];
+    BlockForces16<FORCE_TYPE> blockForces;
+    fvec8 x, y, z, q;
+    for (int i = 0; i < 8; i++) {
+        blockAtomPosq[i] = fvec4(posq+4*blockAtom[i]);
+        if (PERIODIC_TYPE == PeriodicPerAtom)
+            blockAtomPosq[i] -= floor((blockAtomPosq[i]-blockCenter)*invBoxSize+0.5f)*boxSize;
+    }
+    transpose(blockAtomPosq[0], blockAtomPosq[1], blockAtomPosq[2], blockAtomPosq[3], blockAtomPosq[4], blockAtomPosq[5], blockAtomPosq[6], blockAtomPosq[7], x, y, z, q);
+    fvec16 blockAtomX(x, x), blockAtomY(y, y), blockAtomZ(z, z), blockAtomCharge(q, q);
+    blockAtomCharge *= ONE_4PI_EPS0;
+    fvec8 sigma(atomParameters[blockAtom[0]].first, atomParameters[blockAtom[1]].first, atomParameters[blockAtom[2]].first, atomParameters[blockAtom[3]].first, atomParameters[blockAtom[4]].first, atomParameters[blockAtom[5]].first, atomParameters[blockAtom[6]].first, atomParameters[blockAtom[7]].first);
+    fvec8 epsilon(atomParameters[blockAtom[0]].second, atomParameters[blockAtom[1]].second, atomParameters[blockAtom[2]].second, atomParameters[blockAtom[3]].second, atomParameters[blockAtom[4]].second, atomParameters[blockAtom[5]].second, atomParameters[blockAtom[6]].second, atomParameters[blockAtom[7]].second);
+    fvec16 blockAtomSigma(sigma, sigma), blockAtomEpsilon(epsilon, epsilon);
+    const bool needPeriodic = (PERIODIC_TYPE == PeriodicPerInteraction || PERIODIC_TYPE == PeriodicTriclinic);
+    const float invSwitchingInterval = 1/(cutoffDistance-switchingDistance);
+    
+    // Loop over neighbors for this block, two at a time.
+    
+    const vector<int>& neighbors = neighborList->getBlockNeighbors(blockIndex);
+    const vector<char>& exclusions = neighborList->getBlockExclusions(blockIndex);
+    int numNeighbors = neighbors.size();
+    for (int i = 0; i < numNeighbors; i += 2) {
+        // Load the next two neighbors.  If only one is left, the upper half of every vector is excluded.
+        
+        bool hasSecond = (i+1 < numNeighbors);
+        int atom1 = neighbors[i];
+        int atom2 = (hasSecond ? neighbors[i+1] : atom1);
+        int excl = ((unsigned char) exclusions[i]) | ((hasSecond ? (unsigned char) exclusions[i+1] : 0xFF)<<8);
+        
+        // Compute the distances to the block atoms.
+        
+        fvec16 dx, dy, dz, r2;
+        fvec4 atomPos1(posq+4*atom1), atomPos2(posq+4*atom2);
+        if (PERIODIC_TYPE == PeriodicPerAtom) {
+            atomPos1 -= floor((atomPos1-blockCenter)*invBoxSize+0.5f)*boxSize;
+            atomPos2 -= floor((atomPos2-blockCenter)*invBoxSize+0.5f)*boxSize;
+        }
+        getDeltaR<PERIODIC_TYPE>(atomPos1, atomPos2, blockAtomX, blockAtomY, blockAtomZ, dx, dy, dz, r2, needPeriodic, boxSize, invBoxSize);
+        __mmask16 include = (~excl) & (r2 < cutoffDistance*cutoffDistance);
+        if (!any(include))
+            continue; // No interactions to compute.
+        
+        // Compute the interactions.
+        
+        fvec16 inverseR = rsqrt(r2);
+        fvec16 r = r2*inverseR;
+        fvec16 energy, dEdR;
+        float atomEpsilon1 = atomParameters[atom1].second;
+        float atomEpsilon2 = atomParameters[atom2].second;
+        if (atomEpsilon1 != 0.0f || atomEpsilon2 != 0.0f) {
+            fvec16 sig = blockAtomSigma+fvec16(fvec8(atomParameters[atom1].first), fvec8(atomParameters[atom2].first));
+            fvec16 sig2 = inverseR*sig;
+            sig2 *= sig2;
+            fvec16 sig6 = sig2*sig2*sig2;
+            fvec16 epsSig6 = blockAtomEpsilon*fvec16(fvec8(atomEpsilon1), fvec8(atomEpsilon2))*sig6;
+            dEdR = epsSig6*fmadd(12.0f, sig6, -6.0f);
+            energy = epsSig6*(sig6-1.0f);
+            if (useSwitch) {
+                fvec16 t = blend(0.0f, (r-switchingDistance)*invSwitchingInterval, r > switchingDistance);
+                fvec16 switchValue = 1+t*t*t*(-10.0f+t*(15.0f-t*6.0f));
+                fvec16 switchDeriv = t*t*(-30.0f+t*(60.0f-t*30.0f))*invSwitchingInterval;
+                dEdR = switchValue*dEdR - energy*switchDeriv*r;
+                energy *= switchValue;
+            }
+        }
+        else {
+            energy = 0.0f;
+            dEdR = 0.0f;
+        }
+        fvec16 chargeProd = blockAtomCharge*fvec16(fvec8(posq[4*atom1+3]), fvec8(posq[4*atom2+3]));
+        dEdR += chargeProd*inverseR*ewaldScaleFunction(r);
+        dEdR *= inverseR*inverseR;
+
+        // Accumulate energies.
+
+        if (totalEnergy) {
+            energy += chargeProd*inverseR*erfcApprox(alphaEwald*r);
+            *totalEnergy += reduceAdd(energy, include);
+        }
+
+        // Accumulate forces.
+
+        dEdR = blend(0.0f, dEdR, include);
+        fvec16 fx = dx*dEdR;
+        fvec16 fy = dy*dEdR;
+        fvec16 fz = dz*dEdR;
+        blockForces.add(forces, atom1, atom2, hasSecond, fx, fy, fz);
+    }
+    
+    // Record the forces on the block atoms.
+
+    blockForces.store(forces, blockAtom);
+}
+
+template <int PERIODIC_TYPE>
+void CpuNonbondedForceVec16::getDeltaR(const fvec4& posI1, const fvec4& posI2, const fvec16& x, const fvec16& y, const fvec16& z, fvec16& dx, fvec16& dy, fvec16& dz, fvec16& r2, bool periodic, const fvec4& boxSize, const fvec4& invBoxSize) const {
+    dx = x-fvec16(fvec8(posI1[0]), fvec8(posI2[0]));
+    dy = y-fvec16(fvec8(posI1[1]), fvec8(posI2[1]));
+    dz = z-fvec16(fvec8(posI1[2]), fvec8(posI2[2]));
+    if (PERIODIC_TYPE == PeriodicTriclinic) {
+        fvec16 scale3 = floor(dz*recipBoxSize[2]+0.5f);
+        dx -= scale3*periodicBoxVectors[2][0];
+        dy -= scale3*periodicBoxVectors[2][1];
+        dz -= scale3*periodicBoxVectors[2][2];
+        fvec16 scale2 = floor(dy*recipBoxSize[1]+0.5f);
+        dx -= scale2*periodicBoxVectors[1][0];
+        dy -= scale2*periodicBoxVectors[1][1];
+        fvec16 scale1 = floor(dx*recipBoxSize[0]+0.5f);
+        dx -= scale1*periodicBoxVectors[0][0];
+    }
+    else if (PERIODIC_TYPE == PeriodicPerInteraction) {
+        dx -= round(dx*invBoxSize[0])*boxSize[0];
+        dy -= round(dy*invBoxSize[1])*boxSize[1];
+        dz -= round(dz*invBoxSize[2])*boxSize[2];
+    }
+    r2 = fmadd(dx, dx, fmadd(dy, dy, dz*dz));
+}
+
+fvec16 CpuNonbondedForceVec16::erfcApprox(const fvec16& x) {
+    fvec16 x1 = x*erfcDXInv;
+    ivec16 index = min(floor(x1), NUM_TABLE_POINTS);
+    fvec16 coeff2 = x1-index;
+    fvec16 coeff1 = 1.0f-coeff2;
+    fvec16 s1 = gather(&erfcTable[0], index);
+    fvec16 s2 = gather(&erfcTable[1], index);
+    return fmadd(coeff1, s1, coeff2*s2);
+}
+
+fvec16 CpuNonbondedForceVec16::ewaldScaleFunction(const fvec16& x) {
+    // Compute the tabulated Ewald scale factor: erfc(alpha*r) + 2*alpha*r*exp(-alpha*alpha*r*r)/sqrt(PI)
+
+    fvec16 x1 = x*ewaldDXInv;
+    ivec16 index = min(floor(x1), NUM_TABLE_POINTS);
+    fvec16 coeff2 = x1-index;
+    fvec16 coeff1 = 1.0f-coeff2;
+    fvec16 s1 = gather(&ewaldScaleTable[0], index);
+    fvec16 s2 = gather(&ewaldScaleTable[1], index);
+    return fmadd(coeff1, s1, coeff2*s2);
+}
+#endif
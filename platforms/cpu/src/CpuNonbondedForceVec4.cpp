@@ -47,7 +47,85 @@ CpuNonbondedForceVec4::CpuNonbondedForceVec4() {
 
 enum PeriodicType {NoPeriodic, PeriodicPerAtom, PeriodicPerInteraction, PeriodicTriclinic};
 
+/**
+ * This accumulates the forces on the atoms in a block, and subtracts the opposite forces from each
+ * neighbor.  With a single precision force array, the block forces are summed in vector registers.
+ * With a double precision array (mixed precision mode), every sum is done in double precision.
+ */
+template <class FORCE_TYPE>
+class BlockForces4;
+
+template <>
+class BlockForces4<float> {
+public:
+    BlockForces4() : x(0.0f), y(0.0f), z(0.0f) {
+    }
+    void add(float* forces, int atom, const fvec4& fx, const fvec4& fy, const fvec4& fz) {
+        x += fx;
+        y += fy;
+        z += fz;
+        fvec4 one(1.0f);
+        float* atomForce = forces+4*atom;
+        atomForce[0] -= dot4(fx, one);
+        atomForce[1] -= dot4(fy, one);
+        atomForce[2] -= dot4(fz, one);
+    }
+    void store(float* forces, const int* blockAtom) {
+        fvec4 f[4] = {x, y, z, 0.0f};
+        transpose(f[0], f[1], f[2], f[3]);
+        for (int j = 0; j < 4; j++)
+            (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+    }
+private:
+    fvec4 x, y, z;
+};
+
+template <>
+class BlockForces4<double> {
+public:
+    BlockForces4() {
+        for (int j = 0; j < 4; j++)
+            x[j] = y[j] = z[j] = 0.0;
+    }
+    void add(double* forces, int atom, const fvec4& fx, const fvec4& fy, const fvec4& fz) {
+        float f[3][4];
+        fx.store(f[0]);
+        fy.store(f[1]);
+        fz.store(f[2]);
+        double sum[3] = {0.0, 0.0, 0.0};
+        for (int j = 0; j < 4; j++) {
+            x[j] += f[0][j];
+            y[j] += f[1][j];
+            z[j] += f[2][j];
+            sum[0] += f[0][j];
+            sum[1] += f[1][j];
+            sum[2] += f[2][j];
+        }
+        forces[4*atom] -= sum[0];
+        forces[4*atom+1] -= sum[1];
+        forces[4*atom+2] -= sum[2];
+    }
+    void store(double* forces, const int* blockAtom) {
+        for (int j = 0; j < 4; j++) {
+            forces[4*blockAtom[j]] += x[j];
+            forces[4*blockAtom[j]+1] += y[j];
+            forces[4*blockAtom[j]+2] += z[j];
+        }
+    }
+private:
+    double x[4], y[4], z[4];
+};
+
 void CpuNonbondedForceVec4::calculateBlockIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+void CpuNonbondedForceVec4::calculateBlockIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForceVec4::computeBlockIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
     // Determine whether we need to apply periodic boundary conditions.
     
     PeriodicType periodicType;
@@ -96,13 +174,13 @@ void CpuNonbondedForceVec4::calculateBlockIxn(int blockIndex, float* forces, dou
         calculateBlockIxnImpl<PeriodicTriclinic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
 }
 
-template <int PERIODIC_TYPE>
-void CpuNonbondedForceVec4::calculateBlockIxnImpl(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+template <int PERIODIC_TYPE, class FORCE_TYPE>
+void CpuNonbondedForceVec4::calculateBlockIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
     // Load the positions and parameters of the atoms in the block.
     
     const int* blockAtom = &neighborList->getSortedAtoms()[4*blockIndex];
     fvec4 blockAtomPosq[4];
-    fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
+    BlockForces4<FORCE_TYPE> blockForces;
     for (int i = 0; i < 4; i++) {
         blockAtomPosq[i] = fvec4(posq+4*blockAtom[i]);
         if (PERIODIC_TYPE == PeriodicPerAtom)
@@ -194,24 +272,24 @@ void CpuNonbondedForceVec4::calculateBlockIxnImpl(int blockIndex, float* forces,
         fvec4 fx = dx*dEdR;
         fvec4 fy = dy*dEdR;
         fvec4 fz = dz*dEdR;
-        blockAtomForceX += fx;
-        blockAtomForceY += fy;
-        blockAtomForceZ += fz;
-        float* atomForce = forces+4*atom;
-        atomForce[0] -= dot4(fx, one);
-        atomForce[1] -= dot4(fy, one);
-        atomForce[2] -= dot4(fz, one);
+        blockForces.add(forces, atom, fx, fy, fz);
     }
     
     // Record the forces on the block atoms.
 
-    fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
-    transpose(f[0], f[1], f[2], f[3]);
-    for (int j = 0; j < 4; j++)
-        (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+    blockForces.store(forces, blockAtom);
   }
 
 void CpuNonbondedForceVec4::calculateBlockEwaldIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockEwaldIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+void CpuNonbondedForceVec4::calculateBlockEwaldIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockEwaldIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForceVec4::computeBlockEwaldIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
     // Determine whether we need to apply periodic boundary conditions.
     
     PeriodicType periodicType;
@@ -260,13 +338,13 @@ void CpuNonbondedForceVec4::calculateBlockEwaldIxn(int blockIndex, float* forces
         calculateBlockEwaldIxnImpl<PeriodicTriclinic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
 }
 
-template <int PERIODIC_TYPE>
-void CpuNonbondedForceVec4::calculateBlockEwaldIxnImpl(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+template <int PERIODIC_TYPE, class FORCE_TYPE>
+void CpuNonbondedForceVec4::calculateBlockEwaldIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
     // Load the positions and parameters of the atoms in the block.
     
     const int* blockAtom = &neighborList->getSortedAtoms()[4*blockIndex];
     fvec4 blockAtomPosq[4];
-    fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
+    BlockForces4<FORCE_TYPE> blockForces;
     for (int i = 0; i < 4; i++) {
         blockAtomPosq[i] = fvec4(posq+4*blockAtom[i]);
         if (PERIODIC_TYPE == PeriodicPerAtom)
@@ -352,21 +430,12 @@ void CpuNonbondedForceVec4::calculateBlockEwaldIxnImpl(int blockIndex, float* fo
         fvec4 fx = dx*dEdR;
         fvec4 fy = dy*dEdR;
         fvec4 fz = dz*dEdR;
-        blockAtomForceX += fx;
-        blockAtomForceY += fy;
-        blockAtomForceZ += fz;
-        float* atomForce = forces+4*atom;
-        atomForce[0] -= dot4(fx, one);
-        atomForce[1] -= dot4(fy, one);
-        atomForce[2] -= dot4(fz, one);
+        blockForces.add(forces, atom, fx, fy, fz);
     }
     
     // Record the forces on the block atoms.
-    
-    fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
-    transpose(f[0], f[1], f[2], f[3]);
-    for (int j = 0; j < 4; j++)
-        (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+
+    blockForces.store(forces, blockAtom);
 }
 
 template <int PERIODIC_TYPE>
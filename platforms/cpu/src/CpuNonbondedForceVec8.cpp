@@ -79,7 +79,85 @@ CpuNonbondedForceVec8::CpuNonbondedForceVec8() {
 
 enum PeriodicType {NoPeriodic, PeriodicPerAtom, PeriodicPerInteraction, PeriodicTriclinic};
 
+/**
+ * This accumulates the forces on the atoms in a block, and subtracts the opposite forces from each
+ * neighbor.  With a single precision force array, the block forces are summed in vector registers.
+ * With a double precision array (mixed precision mode), every sum is done in double precision.
+ */
+template <class FORCE_TYPE>
+class BlockForces8;
+
+template <>
+class BlockForces8<float> {
+public:
+    BlockForces8() : x(0.0f), y(0.0f), z(0.0f) {
+    }
+    void add(float* forces, int atom, const fvec8& fx, const fvec8& fy, const fvec8& fz) {
+        x += fx;
+        y += fy;
+        z += fz;
+        fvec8 one(1.0f);
+        float* atomForce = forces+4*atom;
+        atomForce[0] -= dot8(fx, one);
+        atomForce[1] -= dot8(fy, one);
+        atomForce[2] -= dot8(fz, one);
+    }
+    void store(float* forces, const int* blockAtom) {
+        fvec4 f[8];
+        transpose(x, y, z, 0.0f, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
+        for (int j = 0; j < 8; j++)
+            (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+    }
+private:
+    fvec8 x, y, z;
+};
+
+template <>
+class BlockForces8<double> {
+public:
+    BlockForces8() {
+        for (int j = 0; j < 8; j++)
+            x[j] = y[j] = z[j] = 0.0;
+    }
+    void add(double* forces, int atom, const fvec8& fx, const fvec8& fy, const fvec8& fz) {
+        float f[3][8];
+        fx.store(f[0]);
+        fy.store(f[1]);
+        fz.store(f[2]);
+        double sum[3] = {0.0, 0.0, 0.0};
+        for (int j = 0; j < 8; j++) {
+            x[j] += f[0][j];
+            y[j] += f[1][j];
+            z[j] += f[2][j];
+            sum[0] += f[0][j];
+            sum[1] += f[1][j];
+            sum[2] += f[2][j];
+        }
+        forces[4*atom] -= sum[0];
+        forces[4*atom+1] -= sum[1];
+        forces[4*atom+2] -= sum[2];
+    }
+    void store(double* forces, const int* blockAtom) {
+        for (int j = 0; j < 8; j++) {
+            forces[4*blockAtom[j]] += x[j];
+            forces[4*blockAtom[j]+1] += y[j];
+            forces[4*blockAtom[j]+2] += z[j];
+        }
+    }
+private:
+    double x[8], y[8], z[8];
+};
+
 void CpuNonbondedForceVec8::calculateBlockIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+void CpuNonbondedForceVec8::calculateBlockIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForceVec8::computeBlockIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
     // Determine whether we need to apply periodic boundary conditions.
     
     PeriodicType periodicType;
@@ -128,13 +206,13 @@ void CpuNonbondedForceVec8::calculateBlockIxn(int blockIndex, float* forces, dou
         calculateBlockIxnImpl<PeriodicTriclinic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
 }
 
-template <int PERIODIC_TYPE>
-void CpuNonbondedForceVec8::calculateBlockIxnImpl(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+template <int PERIODIC_TYPE, class FORCE_TYPE>
+void CpuNonbondedForceVec8::calculateBlockIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
     // Load the positions and parameters of the atoms in the block.
     
     const int* blockAtom = &neighborList->getSortedAtoms()[8*blockIndex];
     fvec4 blockAtomPosq[8];
-    fvec8 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
+    BlockForces8<FORCE_TYPE> blockForces;
     fvec8 blockAtomX, blockAtomY, blockAtomZ, blockAtomCharge;
     for (int i = 0; i < 8; i++) {
         blockAtomPosq[i] = fvec4(posq+4*blockAtom[i]);
@@ -225,24 +303,24 @@ void CpuNonbondedForceVec8::calculateBlockIxnImpl(int blockIndex, float* forces,
         fvec8 fx = dx*dEdR;
         fvec8 fy = dy*dEdR;
         fvec8 fz = dz*dEdR;
-        blockAtomForceX += fx;
-        blockAtomForceY += fy;
-        blockAtomForceZ += fz;
-        float* atomForce = forces+4*atom;
-        atomForce[0] -= dot8(fx, one);
-        atomForce[1] -= dot8(fy, one);
-        atomForce[2] -= dot8(fz, one);
+        blockForces.add(forces, atom, fx, fy, fz);
     }
     
     // Record the forces on the block atoms.
 
-    fvec4 f[8];
-    transpose(blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
-    for (int j = 0; j < 8; j++)
-        (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+    blockForces.store(forces, blockAtom);
   }
 
 void CpuNonbondedForceVec8::calculateBlockEwaldIxn(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockEwaldIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+void CpuNonbondedForceVec8::calculateBlockEwaldIxn(int blockIndex, double* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
+    computeBlockEwaldIxn(blockIndex, forces, totalEnergy, boxSize, invBoxSize);
+}
+
+template <class FORCE_TYPE>
+void CpuNonbondedForceVec8::computeBlockEwaldIxn(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
     // Determine whether we need to apply periodic boundary conditions.
     
     PeriodicType periodicType;
@@ -291,13 +369,13 @@ void CpuNonbondedForceVec8::calculateBlockEwaldIxn(int blockIndex, float* forces
         calculateBlockEwaldIxnImpl<PeriodicTriclinic>(blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
 }
 
-template <int PERIODIC_TYPE>
-void CpuNonbondedForceVec8::calculateBlockEwaldIxnImpl(int blockIndex, float* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+template <int PERIODIC_TYPE, class FORCE_TYPE>
+void CpuNonbondedForceVec8::calculateBlockEwaldIxnImpl(int blockIndex, FORCE_TYPE* forces, double* totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
     // Load the positions and parameters of the atoms in the block.
     
     const int* blockAtom = &neighborList->getSortedAtoms()[8*blockIndex];
     fvec4 blockAtomPosq[8];
-    fvec8 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
+    BlockForces8<FORCE_TYPE> blockForces;
     fvec8 blockAtomX, blockAtomY, blockAtomZ, blockAtomCharge;
     for (int i = 0; i < 8; i++) {
         blockAtomPosq[i] = fvec4(posq+4*blockAtom[i]);
@@ -382,21 +460,12 @@ void CpuNonbondedForceVec8::calculateBlockEwaldIxnImpl(int blockIndex, float* fo
         fvec8 fx = dx*dEdR;
         fvec8 fy = dy*dEdR;
         fvec8 fz = dz*dEdR;
-        blockAtomForceX += fx;
-        blockAtomForceY += fy;
-        blockAtomForceZ += fz;
-        float* atomForce = forces+4*atom;
-        atomForce[0] -= dot8(fx, one);
-        atomForce[1] -= dot8(fy, one);
-        atomForce[2] -= dot8(fz, one);
+        blockForces.add(forces, atom, fx, fy, fz);
     }
     
     // Record the forces on the block atoms.
-    
-    fvec4 f[8];
-    transpose(blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
-    for (int j = 0; j < 8; j++)
-        (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+
+    blockForces.store(forces, blockAtom);
 }
 
 template <int PERIODIC_TYPE>
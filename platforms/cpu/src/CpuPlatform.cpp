@@ -37,8 +37,13 @@
 #include "openmm/OpenMMException.h"
 #include "openmm/internal/hardware.h"
 #include "openmm/internal/vectorize.h"
+#include <algorithm>
+#include <cstdio>
 #include <sstream>
 #include <stdlib.h>
+#ifdef __linux__
+    #include <sched.h>
+#endif
 
 using namespace OpenMM;
 using namespace std;
@@ -63,6 +68,7 @@ CpuPlatform::CpuPlatform() {
     deprecatedPropertyReplacements["CpuThreads"] = CpuThreads();
     CpuKernelFactory* factory = new CpuKernelFactory();
     registerKernelFactory(CalcForcesAndEnergyKernel::Name(), factory);
+    registerKernelFactory(UpdateStateDataKernel::Name(), factory);
     registerKernelFactory(CalcHarmonicAngleForceKernel::Name(), factory);
     registerKernelFactory(CalcPeriodicTorsionForceKernel::Name(), factory);
     registerKernelFactory(CalcRBTorsionForceKernel::Name(), factory);
@@ -72,7 +78,12 @@ CpuPlatform::CpuPlatform() {
     registerKernelFactory(CalcGBSAOBCForceKernel::Name(), factory);
     registerKernelFactory(CalcCustomGBForceKernel::Name(), factory);
     registerKernelFactory(IntegrateLangevinStepKernel::Name(), factory);
+    registerKernelFactory(ApplyMonteCarloBarostatKernel::Name(), factory);
     platformProperties.push_back(CpuThreads());
+    platformProperties.push_back(CpuPrecision());
+    platformProperties.push_back(CpuSpinWait());
+    platformProperties.push_back(CpuThreadAffinity());
+    platformProperties.push_back(CpuPmeThreads());
     int threads = getNumProcessors();
     char* threadsEnv = getenv("OPENMM_CPU_THREADS");
     if (threadsEnv != NULL)
@@ -80,6 +91,10 @@ CpuPlatform::CpuPlatform() {
     stringstream defaultThreads;
     defaultThreads << threads;
     setPropertyDefaultValue(CpuThreads(), defaultThreads.str());
+    setPropertyDefaultValue(CpuPrecision(), "single");
+    setPropertyDefaultValue(CpuSpinWait(), "false");
+    setPropertyDefaultValue(CpuThreadAffinity(), "none");
+    setPropertyDefaultValue(CpuPmeThreads(), defaultThreads.str());
 }
 
 const string& CpuPlatform::getPropertyValue(const Context& context, const string& property) const {
@@ -99,7 +114,7 @@ double CpuPlatform::getSpeed() const {
 }
 
 bool CpuPlatform::supportsDoublePrecision() const {
-    return false;
+    return true;
 }
 
 bool CpuPlatform::isProcessorSupported() {
@@ -107,13 +122,28 @@ bool CpuPlatform::isProcessorSupported() {
 }
 
 void CpuPlatform::contextCreated(ContextImpl& context, const map<string, string>& properties) const {
-    ReferencePlatform::contextCreated(context, properties);
     const string& threadsPropValue = (properties.find(CpuThreads()) == properties.end() ?
             getPropertyDefaultValue(CpuThreads()) : properties.find(CpuThreads())->second);
+    string precisionPropValue = (properties.find(CpuPrecision()) == properties.end() ?
+            getPropertyDefaultValue(CpuPrecision()) : properties.find(CpuPrecision())->second);
+    string spinWaitPropValue = (properties.find(CpuSpinWait()) == properties.end() ?
+            getPropertyDefaultValue(CpuSpinWait()) : properties.find(CpuSpinWait())->second);
+    transform(precisionPropValue.begin(), precisionPropValue.end(), precisionPropValue.begin(), ::tolower);
+    string affinityPropValue = (properties.find(CpuThreadAffinity()) == properties.end() ?
+            getPropertyDefaultValue(CpuThreadAffinity()) : properties.find(CpuThreadAffinity())->second);
+    transform(spinWaitPropValue.begin(), spinWaitPropValue.end(), spinWaitPropValue.begin(), ::tolower);
+    transform(affinityPropValue.begin(), affinityPropValue.end(), affinityPropValue.begin(), ::tolower);
+    // If PmeThreads is not specified, PlatformData sets it to the number of threads actually being used.
+    string pmeThreadsPropValue = (properties.find(CpuPmeThreads()) == properties.end() ?
+            "" : properties.find(CpuPmeThreads())->second);
+    transform(pmeThreadsPropValue.begin(), pmeThreadsPropValue.end(), pmeThreadsPropValue.begin(), ::tolower);
+    if (spinWaitPropValue != "true" && spinWaitPropValue != "false")
+        throw OpenMMException("Illegal value for SpinWait: "+spinWaitPropValue);
     int numThreads;
     stringstream(threadsPropValue) >> numThreads;
-    PlatformData* data = new PlatformData(context.getSystem().getNumParticles(), numThreads);
+    PlatformData* data = new PlatformData(context.getSystem().getNumParticles(), numThreads, precisionPropValue, spinWaitPropValue == "true", affinityPropValue, pmeThreadsPropValue);
     contextData[&context] = data;
+    ReferencePlatform::contextCreated(context, properties);
     ReferenceConstraints& constraints = *(ReferenceConstraints*) reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData())->constraints;
     if (constraints.settle != NULL) {
         CpuSETTLE* parallelSettle = new CpuSETTLE(context.getSystem(), *(ReferenceSETTLEAlgorithm*) constraints.settle, data->threads);
@@ -136,16 +166,182 @@ const CpuPlatform::PlatformData& CpuPlatform::getPlatformData(const ContextImpl&
     return *contextData[&context];
 }
 
-CpuPlatform::PlatformData::PlatformData(int numParticles, int numThreads) : posq(4*numParticles), threads(numThreads),
-        neighborList(NULL), cutoff(0.0), paddedCutoff(0.0), anyExclusions(false) {
+/**
+ * Read a single integer from a file, returning a default value if it cannot be read.
+ */
+static int readIntFromFile(const string& filename, int defaultValue) {
+    FILE* file = fopen(filename.c_str(), "r");
+    if (file == NULL)
+        return defaultValue;
+    int value;
+    if (fscanf(file, "%d", &value) != 1)
+        value = defaultValue;
+    fclose(file);
+    return value;
+}
+
+struct ProcessorInfo {
+    int index, socket, core, hyperthread;
+};
+
+static bool compareCompact(const ProcessorInfo& p1, const ProcessorInfo& p2) {
+    if (p1.socket != p2.socket)
+        return (p1.socket < p2.socket);
+    if (p1.core != p2.core)
+        return (p1.core < p2.core);
+    return (p1.hyperthread < p2.hyperthread);
+}
+
+static bool compareScatter(const ProcessorInfo& p1, const ProcessorInfo& p2) {
+    if (p1.hyperthread != p2.hyperthread)
+        return (p1.hyperthread < p2.hyperthread);
+    if (p1.core != p2.core)
+        return (p1.core < p2.core);
+    return (p1.socket < p2.socket);
+}
+
+/**
+ * Get the logical processors this process is allowed to run on, sorted according to a "compact" or "scatter"
+ * placement policy.  On Linux the topology is read from sysfs.  Elsewhere every processor is treated as a
+ * separate core on a single socket.
+ */
+static vector<int> getOrderedProcessors(bool scatter) {
+    vector<int> allowed;
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0)
+        for (int i = 0; i < CPU_SETSIZE; i++)
+            if (CPU_ISSET(i, &cpus))
+                allowed.push_back(i);
+#endif
+    if (allowed.size() == 0)
+        for (int i = 0; i < getNumProcessors(); i++)
+            allowed.push_back(i);
+
+    // Identify the socket and core of each processor.  Cores are renumbered within each socket so that
+    // "scatter" alternates between sockets even when core IDs are not contiguous.
+
+    vector<ProcessorInfo> info(allowed.size());
+    map<pair<int, int>, int> coreIndex, hyperthreadCount;
+    map<int, int> coresInSocket;
+    for (int i = 0; i < (int) allowed.size(); i++) {
+        stringstream topology;
+        topology << "/sys/devices/system/cpu/cpu" << allowed[i] << "/topology/";
+        int socket = readIntFromFile(topology.str()+"physical_package_id", 0);
+        int core = readIntFromFile(topology.str()+"core_id", allowed[i]);
+        pair<int, int> key(socket, core);
+        if (coreIndex.find(key) == coreIndex.end())
+            coreIndex[key] = coresInSocket[socket]++;
+        info[i].index = allowed[i];
+        info[i].socket = socket;
+        info[i].core = coreIndex[key];
+        info[i].hyperthread = hyperthreadCount[key]++;
+    }
+    sort(info.begin(), info.end(), scatter ? compareScatter : compareCompact);
+    vector<int> result;
+    for (int i = 0; i < (int) info.size(); i++)
+        result.push_back(info[i].index);
+    return result;
+}
+
+/**
+ * Parse an explicit list of processors, such as "0,2,4-7".
+ */
+static vector<int> parseProcessorList(const string& list) {
+    vector<int> result;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ',')) {
+        int first, last;
+        char extra;
+        if (sscanf(item.c_str(), "%d-%d%c", &first, &last, &extra) == 2) {
+            if (first < 0 || last < first)
+                throw OpenMMException("Illegal value for ThreadAffinity: "+list);
+            for (int i = first; i <= last; i++)
+                result.push_back(i);
+        }
+        else if (sscanf(item.c_str(), "%d%c", &first, &extra) == 1 && first >= 0)
+            result.push_back(first);
+        else
+            throw OpenMMException("Illegal value for ThreadAffinity: "+list);
+    }
+    if (result.size() == 0)
+        throw OpenMMException("Illegal value for ThreadAffinity: "+list);
+    return result;
+}
+
+/**
+ * Each thread allocates and clears its own force buffers.  Physical memory is normally assigned on the
+ * NUMA node of the thread that first touches it, so this keeps each buffer local to the thread that uses
+ * it, provided the thread is not later moved to a different socket.
+ */
+class AllocateThreadForceTask : public ThreadPool::Task {
+public:
+    AllocateThreadForceTask(CpuPlatform::PlatformData& data, int numParticles) : data(data), numParticles(numParticles) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        AlignedArray<float>& force = data.threadForce[threadIndex];
+        force.resize(4*numParticles);
+        for (int i = 0; i < 4*numParticles; i++)
+            force[i] = 0.0f;
+        if (data.useMixedPrecision) {
+            AlignedArray<double>& forceDouble = data.threadForceDouble[threadIndex];
+            forceDouble.resize(4*numParticles);
+            for (int i = 0; i < 4*numParticles; i++)
+                forceDouble[i] = 0.0;
+        }
+    }
+    CpuPlatform::PlatformData& data;
+    int numParticles;
+};
+
+CpuPlatform::PlatformData::PlatformData(int numParticles, int numThreads, const string& precision, bool spinWait, const string& threadAffinity, const string& pmeThreads) :
+        posq(4*numParticles), threads(numThreads, spinWait), bondForceQueue(numParticles, threads.getNumThreads()),
+        neighborList(NULL), cutoff(0.0), paddedCutoff(0.0), anyExclusions(false), rebuildNeighborList(false) {
+    if (precision == "single") {
+        useMixedPrecision = false;
+        useDoublePrecision = false;
+    }
+    else if (precision == "mixed") {
+        useMixedPrecision = true;
+        useDoublePrecision = false;
+    }
+    else if (precision == "double") {
+        useMixedPrecision = false;
+        useDoublePrecision = true;
+    }
+    else
+        throw OpenMMException("Illegal value for Precision: "+precision);
     numThreads = threads.getNumThreads();
+    if (pmeThreads == "")
+        this->pmeThreads = numThreads;
+    else if (pmeThreads == "auto")
+        this->pmeThreads = 0;
+    else {
+        stringstream pmeThreadsStream(pmeThreads);
+        if (!(pmeThreadsStream >> this->pmeThreads) || !pmeThreadsStream.eof() || this->pmeThreads < 1 || this->pmeThreads > numThreads)
+            throw OpenMMException("Illegal value for PmeThreads: "+pmeThreads);
+    }
+    if (threadAffinity == "compact" || threadAffinity == "scatter")
+        threads.setThreadAffinity(getOrderedProcessors(threadAffinity == "scatter"));
+    else if (threadAffinity != "none")
+        threads.setThreadAffinity(parseProcessorList(threadAffinity));
     threadForce.resize(numThreads);
-    for (int i = 0; i < numThreads; i++)
-        threadForce[i].resize(4*numParticles);
+    if (useMixedPrecision)
+        threadForceDouble.resize(numThreads);
+    bondForceQueue.setThreadForceBuffers(useMixedPrecision ? NULL : &threadForce, useMixedPrecision ? &threadForceDouble : NULL);
+    AllocateThreadForceTask task(*this, numParticles);
+    threads.execute(task);
+    threads.waitForThreads();
     isPeriodic = false;
+    propertyValues[CpuPrecision()] = precision;
+    propertyValues[CpuSpinWait()] = (spinWait ? "true" : "false");
+    propertyValues[CpuThreadAffinity()] = threadAffinity;
     stringstream threadsProperty;
     threadsProperty << numThreads;
     propertyValues[CpuThreads()] = threadsProperty.str();
+    propertyValues[CpuPmeThreads()] = (pmeThreads == "" ? threadsProperty.str() : pmeThreads);
 }
 
 CpuPlatform::PlatformData::~PlatformData() {
@@ -155,7 +351,7 @@ CpuPlatform::PlatformData::~PlatformData() {
 
 bool isVec8Supported();
 
-void CpuPlatform::PlatformData::requestNeighborList(double cutoffDistance, double padding, bool useExclusions, vector<set<int> >& exclusionList) {
+void CpuPlatform::PlatformData::requestNeighborList(double cutoffDistance, double padding, bool useExclusions, const CpuExclusions& exclusionList) {
     if (neighborList == NULL)
         neighborList = new CpuNeighborList(isVec8Supported() ? 8 : 4);
     if (cutoffDistance > cutoff)
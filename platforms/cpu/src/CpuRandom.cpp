@@ -26,6 +26,7 @@
 #include "openmm/internal/OSRngSeed.h"
 #include "openmm/OpenMMException.h"
 #include <cmath>
+#include <iostream>
 
 using namespace std;
 using namespace OpenMM;
@@ -87,3 +88,40 @@ float CpuRandom::getGaussianRandom(int threadIndex) {
 float CpuRandom::getUniformRandom(int threadIndex) {
     return genrand_real2(*threadRandom[threadIndex]);
 }
+
+void CpuRandom::createCheckpoint(ostream& stream) {
+    stream.write((char*) &hasInitialized, sizeof(bool));
+    if (!hasInitialized)
+        return;
+    int numThreads = threadRandom.size();
+    stream.write((char*) &randomSeed, sizeof(int));
+    stream.write((char*) &numThreads, sizeof(int));
+    for (int i = 0; i < numThreads; i++)
+        threadRandom[i]->createCheckpoint(stream);
+    stream.write((char*) &nextGaussian[0], sizeof(float)*numThreads);
+    stream.write((char*) &nextGaussianIsValid[0], sizeof(int)*numThreads);
+}
+
+void CpuRandom::loadCheckpoint(istream& stream) {
+    bool initialized;
+    stream.read((char*) &initialized, sizeof(bool));
+    if (!initialized)
+        return;
+    int numThreads;
+    stream.read((char*) &randomSeed, sizeof(int));
+    stream.read((char*) &numThreads, sizeof(int));
+    if (hasInitialized && numThreads != (int) threadRandom.size())
+        throw OpenMMException("loadCheckpoint: Checkpoint was created with a different number of threads");
+    if (!hasInitialized) {
+        threadRandom.resize(numThreads);
+        nextGaussian.resize(numThreads);
+        nextGaussianIsValid.resize(numThreads);
+        for (int i = 0; i < numThreads; i++)
+            threadRandom[i] = new OpenMM_SFMT::SFMT();
+        hasInitialized = true;
+    }
+    for (int i = 0; i < numThreads; i++)
+        threadRandom[i]->loadCheckpoint(stream);
+    stream.read((char*) &nextGaussian[0], sizeof(float)*numThreads);
+    stream.read((char*) &nextGaussianIsValid[0], sizeof(int)*numThreads);
+}
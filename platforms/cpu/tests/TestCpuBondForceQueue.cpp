@@ -0,0 +1,163 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+
+/**
+ * This tests computing several bonded forces together on the CPU platform, both on their own and
+ * alongside the nonbonded interactions.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/HarmonicAngleForce.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/PeriodicTorsionForce.h"
+#include "openmm/RBTorsionForce.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "CpuPlatform.h"
+#include "ReferencePlatform.h"
+#include "sfmt/SFMT.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Build a periodic system of four atom chains with angles, torsions, and 1-4 interactions.  Each
+ * force is placed in its own force group.
+ */
+System* createSystem(vector<Vec3>& positions, bool nonbondedFirst, bool includeNonbonded) {
+    const int numMolecules = 200;
+    const double boxSize = 3.0;
+    System* system = new System();
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(0.9);
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    PeriodicTorsionForce* periodic = new PeriodicTorsionForce();
+    RBTorsionForce* rb = new RBTorsionForce();
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    positions.clear();
+    for (int i = 0; i < numMolecules; i++) {
+        Vec3 pos(boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt));
+        for (int j = 0; j < 4; j++) {
+            system->addParticle(1.0);
+            nonbonded->addParticle(j%2 == 0 ? -0.3 : 0.3, 0.3, 0.5);
+            positions.push_back(pos);
+            pos += Vec3(0.15*genrand_real2(sfmt), 0.15*genrand_real2(sfmt), 0.15*genrand_real2(sfmt));
+        }
+        int first = 4*i;
+        angles->addAngle(first, first+1, first+2, 1.9, 100.0);
+        angles->addAngle(first+1, first+2, first+3, 2.0, 120.0);
+        periodic->addTorsion(first, first+1, first+2, first+3, 3, 0.5, 2.0);
+        rb->addTorsion(first, first+1, first+2, first+3, 1.0, 0.5, -0.3, 0.2, 0.1, -0.1);
+        for (int j = 0; j < 3; j++)
+            for (int k = j+1; k < 4; k++) {
+                if (k-j == 3)
+                    nonbonded->addException(first+j, first+k, 0.05, 0.3, 0.25);
+                else
+                    nonbonded->addException(first+j, first+k, 0.0, 1.0, 0.0);
+            }
+    }
+    angles->setForceGroup(1);
+    periodic->setForceGroup(2);
+    rb->setForceGroup(3);
+    if (includeNonbonded && nonbondedFirst)
+        system->addForce(nonbonded);
+    system->addForce(angles);
+    system->addForce(periodic);
+    system->addForce(rb);
+    if (includeNonbonded && !nonbondedFirst)
+        system->addForce(nonbonded);
+    if (!includeNonbonded)
+        delete nonbonded;
+    return system;
+}
+
+void testBondedForces(bool nonbondedFirst, bool includeNonbonded, const string& precision) {
+    vector<Vec3> positions;
+    System* system = createSystem(positions, nonbondedFirst, includeNonbonded);
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    CpuPlatform cpu;
+    ReferencePlatform reference;
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "3";
+    properties[CpuPlatform::CpuPrecision()] = precision;
+    Context context1(*system, integrator1, cpu, properties);
+    Context context2(*system, integrator2, reference);
+    context1.setPositions(positions);
+    context2.setPositions(positions);
+
+    // Compare the total forces and energy.
+
+    State state1 = context1.getState(State::Forces | State::Energy);
+    State state2 = context2.getState(State::Forces | State::Energy);
+    ASSERT_EQUAL_TOL(state2.getPotentialEnergy(), state1.getPotentialEnergy(), 1e-4);
+    for (int i = 0; i < system->getNumParticles(); i++)
+        ASSERT_EQUAL_VEC(state2.getForces()[i], state1.getForces()[i], 1e-4);
+
+    // The energy of each force group should also be reported correctly.
+
+    for (int group = 0; group < 4; group++) {
+        state1 = context1.getState(State::Forces | State::Energy, false, 1<<group);
+        state2 = context2.getState(State::Forces | State::Energy, false, 1<<group);
+        ASSERT_EQUAL_TOL(state2.getPotentialEnergy(), state1.getPotentialEnergy(), 1e-4);
+        for (int i = 0; i < system->getNumParticles(); i++)
+            ASSERT_EQUAL_VEC(state2.getForces()[i], state1.getForces()[i], 1e-4);
+    }
+    delete system;
+}
+
+int main() {
+    try {
+        if (!CpuPlatform::isProcessorSupported()) {
+            cout << "CPU is not supported.  Exiting." << endl;
+            return 0;
+        }
+        testBondedForces(true, true, "single");
+        testBondedForces(false, true, "single");
+        testBondedForces(false, false, "single");
+        testBondedForces(true, true, "mixed");
+        testBondedForces(false, false, "mixed");
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -31,6 +31,7 @@
 
 #include "CpuTests.h"
 #include "TestCheckpoints.h"
+#include "openmm/LangevinIntegrator.h"
 
 void testCheckpoint() {
     const int numParticles = 100;
@@ -103,6 +104,135 @@ void testCheckpoint() {
     compareStates(s1, s5);
 }
 
+/**
+ * Create a System of charged particles in a periodic box.
+ */
+System* createSystem(vector<Vec3>& positions) {
+    const int numParticles = 50;
+    const double boxSize = 3.0;
+    System* system = new System();
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    system->addForce(nonbonded);
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    positions.resize(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system->addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.1 : -0.1, 0.2, 0.1);
+        positions[i] = Vec3(boxSize*(i%4)/4, boxSize*((i/4)%4)/4, boxSize*(i/16)/4)+Vec3(0.1*genrand_real2(sfmt), 0.1*genrand_real2(sfmt), 0.1*genrand_real2(sfmt));
+    }
+    return system;
+}
+
+string readSectionString(istream& stream) {
+    int length;
+    stream.read((char*) &length, sizeof(int));
+    string str(length, ' ');
+    stream.read(&str[0], length);
+    return str;
+}
+
+void testLegacyCheckpoint() {
+    // Create a checkpoint from a Context whose random number generators have not been used yet.
+
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    VerletIntegrator integrator(0.001);
+    Context context(*system, integrator, platform);
+    context.setPositions(positions);
+    integrator.step(10);
+    State s1 = context.getState(State::Positions | State::Velocities | State::Parameters);
+    stringstream tagged(ios_base::out | ios_base::in | ios_base::binary);
+    context.createCheckpoint(tagged);
+
+    // Convert it to the format used before checkpoints were divided into sections.  That consisted of
+    // the same data as the "context" section, followed by the data written by the Reference platform.
+    // The "platform" section holds that data followed by a single byte, which indicates that the random
+    // number generators have not been initialized.
+
+    const char taggedMagic[] = "OpenMM Tagged Checkpoint\n";
+    const char legacyMagic[] = "OpenMM Binary Checkpoint\n";
+    tagged.seekg(sizeof(taggedMagic)+sizeof(int));
+    string contextData, platformData;
+    while (true) {
+        string tag = readSectionString(tagged);
+        long long length;
+        tagged.read((char*) &length, sizeof(long long));
+        string data(length, ' ');
+        if (length > 0)
+            tagged.read(&data[0], length);
+        ASSERT(tagged);
+        if (tag == "context")
+            contextData = data;
+        else if (tag == "platform")
+            platformData = data;
+        else if (tag == "end")
+            break;
+    }
+    ASSERT_EQUAL(0, platformData[platformData.size()-1]);
+    stringstream legacy(ios_base::out | ios_base::in | ios_base::binary);
+    legacy.write(legacyMagic, sizeof(legacyMagic));
+    legacy.write(contextData.c_str(), contextData.size());
+    legacy.write(platformData.c_str(), platformData.size()-1);
+
+    // Data following the checkpoint in the stream should not be read.
+
+    const string trailer = "trailing data";
+    legacy << trailer;
+
+    // Load it into a Context whose random number generators are in use.
+
+    LangevinIntegrator integrator2(300.0, 1.0, 0.001);
+    Context context2(*system, integrator2, platform);
+    context2.setPositions(positions);
+    integrator2.step(10);
+    legacy.seekg(0);
+    context2.loadCheckpoint(legacy);
+    State s2 = context2.getState(State::Positions | State::Velocities | State::Parameters);
+    compareStates(s1, s2);
+    string remaining;
+    getline(legacy, remaining);
+    ASSERT_EQUAL(trailer, remaining);
+    integrator2.step(10);
+    delete system;
+}
+
+void testLangevinCheckpoint() {
+    // The CPU platform's LangevinIntegrator uses the platform's own random number generators.  Make sure
+    // they are restored, so the simulation continues exactly as it would have.
+
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    LangevinIntegrator integrator(300.0, 5.0, 0.001);
+    Context context(*system, integrator, platform);
+    context.setPositions(positions);
+    integrator.step(20);
+    stringstream stream(ios_base::out | ios_base::in | ios_base::binary);
+    context.createCheckpoint(stream);
+    integrator.step(10);
+    State s1 = context.getState(State::Positions | State::Velocities | State::Parameters);
+    context.loadCheckpoint(stream);
+    integrator.step(10);
+    State s2 = context.getState(State::Positions | State::Velocities | State::Parameters);
+    compareStates(s1, s2);
+
+    // It should also work when loaded into a different Context.
+
+    LangevinIntegrator integrator2(300.0, 5.0, 0.001);
+    Context context2(*system, integrator2, platform);
+    stream.seekg(0);
+    context2.loadCheckpoint(stream);
+    integrator2.step(10);
+    State s3 = context2.getState(State::Positions | State::Velocities | State::Parameters);
+    compareStates(s1, s3);
+    delete system;
+}
+
 void runPlatformTests() {
     testCheckpoint();
+    testLegacyCheckpoint();
+    testLangevinCheckpoint();
 }
@@ -0,0 +1,87 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2008-2016 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuTests.h"
+#include "TestMonteCarloBarostat.h"
+#include "ReferencePlatform.h"
+#include "openmm/HarmonicBondForce.h"
+
+void testMatchesReference() {
+    const int numParticles = 500;
+    const double boxSize = 5.0;
+
+    // Create molecules of varying sizes.  The bonds have no energy, so the barostat's decisions
+    // depend only on the random number stream and will be the same on both platforms.
+
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    vector<Vec3> positions(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        if (i > 0 && genrand_real2(sfmt) < 0.7) {
+            bonds->addBond(i-1, i, 0.1, 0.0);
+            positions[i] = positions[i-1]+Vec3(0.1, 0, 0);
+        }
+        else
+            positions[i] = Vec3(2*boxSize*genrand_real2(sfmt), 2*boxSize*genrand_real2(sfmt), 2*boxSize*genrand_real2(sfmt));
+    }
+    system.addForce(bonds);
+    MonteCarloBarostat* barostat = new MonteCarloBarostat(1.0, 300.0, 1);
+    barostat->setRandomNumberSeed(3);
+    system.addForce(barostat);
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    ReferencePlatform reference;
+    Context context1(system, integrator1, reference);
+    Context context2(system, integrator2, platform);
+    context1.setPositions(positions);
+    context2.setPositions(positions);
+    for (int i = 0; i < 50; i++) {
+        integrator1.step(1);
+        integrator2.step(1);
+        State state1 = context1.getState(State::Positions);
+        State state2 = context2.getState(State::Positions);
+        Vec3 box1[3], box2[3];
+        state1.getPeriodicBoxVectors(box1[0], box1[1], box1[2]);
+        state2.getPeriodicBoxVectors(box2[0], box2[1], box2[2]);
+        for (int j = 0; j < 3; j++)
+            ASSERT_EQUAL_VEC(box1[j], box2[j], 1e-10);
+        for (int j = 0; j < numParticles; j++)
+            ASSERT_EQUAL_VEC(state1.getPositions()[j], state2.getPositions()[j], 1e-10);
+    }
+}
+
+void runPlatformTests() {
+    testMatchesReference();
+}
@@ -80,7 +80,7 @@ void testNeighborList(bool periodic, bool triclinic) {
     }
     ThreadPool threads;
     CpuNeighborList neighborList(blockSize);
-    neighborList.computeNeighborList(numParticles, positions, exclusions, boxVectors, periodic, cutoff, threads);
+    neighborList.computeNeighborList(numParticles, positions, CpuExclusions(exclusions), boxVectors, periodic, cutoff, threads);
     
     // Convert the neighbor list to a set for faster lookup.
     
@@ -0,0 +1,312 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+/**
+ * This tests the properties of the CPU platform: that each one reports the value it was given, rejects
+ * illegal values, and does not change the computed forces beyond the expected precision.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "CpuPlatform.h"
+#include "ReferencePlatform.h"
+#include "SimTKOpenMMRealType.h"
+#include "sfmt/SFMT.h"
+#include <iostream>
+#include <cmath>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Build a periodic system of charged dimers with some bonds and exclusions.  The molecules are placed on a
+ * jittered lattice so no two of them overlap.
+ */
+System* createSystem(vector<Vec3>& positions) {
+    const int gridSize = 7;
+    const int numMolecules = 300;
+    const double boxSize = 4.0;
+    const double spacing = boxSize/gridSize;
+    System* system = new System();
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(1.0);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    positions.clear();
+    for (int i = 0; i < numMolecules; i++) {
+        system->addParticle(10.0);
+        system->addParticle(10.0);
+        nonbonded->addParticle(-0.5, 0.3, 0.5);
+        nonbonded->addParticle(0.5, 0.2, 0.4);
+        Vec3 pos = Vec3(i%gridSize, (i/gridSize)%gridSize, i/(gridSize*gridSize))*spacing;
+        pos += Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*0.1;
+        positions.push_back(pos);
+        positions.push_back(pos+Vec3(0.1, 0, 0));
+        bonds->addBond(2*i, 2*i+1, 0.1, 1000.0);
+        nonbonded->addException(2*i, 2*i+1, 0.0, 1.0, 0.0);
+    }
+    system->addForce(nonbonded);
+    system->addForce(bonds);
+    return system;
+}
+
+/**
+ * Create a Context on the CPU platform with one property set to a specified value, in addition to any other
+ * properties given.  Check that the platform reports the expected value for the property, and that the forces
+ * and energy match the Reference platform.  They are compared several times, since some settings change
+ * how the work is divided between evaluations.
+ */
+void testPropertyForces(map<string, string> properties, const string& name, const string& value, const string& expectedValue, double tol, int numEvaluations) {
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    CpuPlatform cpu;
+    ReferencePlatform reference;
+    properties[name] = value;
+    Context context1(*system, integrator1, cpu, properties);
+    Context context2(*system, integrator2, reference);
+    ASSERT_EQUAL(expectedValue, cpu.getPropertyValue(context1, name));
+    context1.setPositions(positions);
+    context2.setPositions(positions);
+    State state2 = context2.getState(State::Forces | State::Energy);
+    for (int i = 0; i < numEvaluations; i++) {
+        State state1 = context1.getState(State::Forces | State::Energy);
+        ASSERT_EQUAL_TOL(state2.getPotentialEnergy(), state1.getPotentialEnergy(), tol);
+        for (int j = 0; j < system->getNumParticles(); j++)
+            ASSERT_EQUAL_VEC(state2.getForces()[j], state1.getForces()[j], tol);
+    }
+    delete system;
+}
+
+/**
+ * Check that creating a Context fails for each of a list of illegal values for a property.
+ */
+void testIllegalValues(map<string, string> properties, const string& name, const char* values[], int numValues) {
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    CpuPlatform cpu;
+    for (int i = 0; i < numValues; i++) {
+        VerletIntegrator integrator(0.001);
+        properties[name] = values[i];
+        bool threwException = false;
+        try {
+            Context context(*system, integrator, cpu, properties);
+        }
+        catch (const OpenMMException& ex) {
+            threwException = true;
+        }
+        ASSERT(threwException);
+    }
+    delete system;
+}
+
+void testSpinWait() {
+    CpuPlatform cpu;
+    ASSERT_EQUAL("false", cpu.getPropertyDefaultValue(CpuPlatform::CpuSpinWait()));
+    map<string, string> properties;
+    testPropertyForces(properties, CpuPlatform::CpuSpinWait(), "false", "false", 1e-5, 1);
+    testPropertyForces(properties, CpuPlatform::CpuSpinWait(), "true", "true", 1e-5, 1);
+    testPropertyForces(properties, CpuPlatform::CpuSpinWait(), "True", "true", 1e-5, 1);
+    const char* illegalValues[] = {"yes", "1", "", "truee"};
+    testIllegalValues(properties, CpuPlatform::CpuSpinWait(), illegalValues, 4);
+}
+
+void testThreadAffinity() {
+    map<string, string> properties;
+    testPropertyForces(properties, CpuPlatform::CpuThreadAffinity(), "none", "none", 1e-5, 1);
+#ifdef __linux__
+    const char* values[] = {"compact", "scatter", "0"};
+    for (int i = 0; i < 3; i++)
+        testPropertyForces(properties, CpuPlatform::CpuThreadAffinity(), values[i], values[i], 1e-5, 1);
+#endif
+    const char* illegalValues[] = {"everywhere", "1-", "3-1", "0,,1"};
+    testIllegalValues(properties, CpuPlatform::CpuThreadAffinity(), illegalValues, 4);
+}
+
+void testPmeThreads() {
+    // Evaluate the forces enough times for "auto" to try both ways of dividing the threads.
+
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "3";
+    const char* values[] = {"auto", "1", "3"};
+    for (int i = 0; i < 3; i++)
+        testPropertyForces(properties, CpuPlatform::CpuPmeThreads(), values[i], values[i], 1e-5, 25);
+    const char* illegalValues[] = {"0", "4", "two"};
+    testIllegalValues(properties, CpuPlatform::CpuPmeThreads(), illegalValues, 3);
+
+    // By default, reciprocal space uses every thread.
+
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    CpuPlatform cpu;
+    ASSERT_EQUAL(cpu.getPropertyDefaultValue(CpuPlatform::CpuThreads()), cpu.getPropertyDefaultValue(CpuPlatform::CpuPmeThreads()));
+    VerletIntegrator integrator(0.001);
+    Context context(*system, integrator, cpu, properties);
+    ASSERT_EQUAL("3", cpu.getPropertyValue(context, CpuPlatform::CpuPmeThreads()));
+    delete system;
+}
+
+void testPrecision() {
+    map<string, string> properties;
+    testPropertyForces(properties, CpuPlatform::CpuPrecision(), "single", "single", 1e-5, 1);
+    testPropertyForces(properties, CpuPlatform::CpuPrecision(), "mixed", "mixed", 1e-5, 1);
+    testPropertyForces(properties, CpuPlatform::CpuPrecision(), "double", "double", 1e-8, 1);
+    const char* illegalValues[] = {"quadruple"};
+    testIllegalValues(properties, CpuPlatform::CpuPrecision(), illegalValues, 1);
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    CpuPlatform cpu;
+    ASSERT_EQUAL("single", cpu.getPropertyDefaultValue(CpuPlatform::CpuPrecision()));
+    VerletIntegrator integrator(0.001);
+    Context context(*system, integrator, cpu);
+    ASSERT_EQUAL("single", cpu.getPropertyValue(context, CpuPlatform::CpuPrecision()));
+    delete system;
+}
+
+/**
+ * Compute the largest difference between the forces computed with the CPU platform at a given precision and
+ * with the Reference platform, for a rock salt lattice.  By symmetry the net force on every ion is zero, and
+ * the contributions from each pair of opposite neighbors cancel exactly, so the error comes entirely from
+ * how the forces are accumulated.
+ */
+double computeLatticeForceError(const string& precision) {
+    const int gridSize = 8;
+    const double spacing = 0.5;
+    const double boxSize = gridSize*spacing;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.9);
+    system.addForce(nonbonded);
+    vector<Vec3> positions;
+    for (int i = 0; i < gridSize; i++)
+        for (int j = 0; j < gridSize; j++)
+            for (int k = 0; k < gridSize; k++) {
+                system.addParticle(10.0);
+                nonbonded->addParticle((i+j+k)%2 == 0 ? 1.0 : -1.0, 0.3, 0.5);
+                positions.push_back(Vec3(i, j, k)*spacing);
+            }
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    CpuPlatform cpu;
+    ReferencePlatform reference;
+    map<string, string> properties;
+    properties[CpuPlatform::CpuPrecision()] = precision;
+    Context context1(system, integrator1, cpu, properties);
+    Context context2(system, integrator2, reference);
+    context1.setPositions(positions);
+    context2.setPositions(positions);
+    State state1 = context1.getState(State::Forces);
+    State state2 = context2.getState(State::Forces);
+    double maxError = 0.0;
+    for (int i = 0; i < system.getNumParticles(); i++) {
+        Vec3 delta = state1.getForces()[i]-state2.getForces()[i];
+        maxError = max(maxError, sqrt(delta.dot(delta)));
+    }
+    return maxError;
+}
+
+void testMixedAccumulation() {
+    // Single precision accumulates the forces in float, so the cancellation is inexact.  Mixed precision
+    // accumulates them in double, so it should be far more accurate.
+
+    double singleError = computeLatticeForceError("single");
+    double mixedError = computeLatticeForceError("mixed");
+    ASSERT(singleError < 1e-2);
+    ASSERT(mixedError < 1e-6);
+}
+
+/**
+ * Run a short constant energy simulation and return the change in total energy per degree of freedom, in
+ * units of kT.
+ */
+double computeEnergyDrift(const string& precision) {
+    const double temperature = 300.0;
+    const int numSteps = 1000;
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    VerletIntegrator integrator(0.001);
+    CpuPlatform cpu;
+    map<string, string> properties;
+    properties[CpuPlatform::CpuPrecision()] = precision;
+    Context context(*system, integrator, cpu, properties);
+    context.setPositions(positions);
+    context.setVelocitiesToTemperature(temperature, 0);
+    integrator.step(100);
+    State state = context.getState(State::Energy);
+    double initialEnergy = state.getKineticEnergy()+state.getPotentialEnergy();
+    integrator.step(numSteps);
+    state = context.getState(State::Energy);
+    double finalEnergy = state.getKineticEnergy()+state.getPotentialEnergy();
+    double kT = BOLTZ*temperature;
+    double drift = (finalEnergy-initialEnergy)/(3*system->getNumParticles()*kT);
+    delete system;
+    return drift;
+}
+
+void testEnergyConservation() {
+    ASSERT(fabs(computeEnergyDrift("single")) < 0.01);
+    ASSERT(fabs(computeEnergyDrift("mixed")) < 0.01);
+    ASSERT(fabs(computeEnergyDrift("double")) < 0.01);
+}
+
+int main() {
+    try {
+        if (!CpuPlatform::isProcessorSupported()) {
+            cout << "CPU is not supported.  Exiting." << endl;
+            return 0;
+        }
+        testSpinWait();
+        testThreadAffinity();
+        testPmeThreads();
+        testPrecision();
+        testMixedAccumulation();
+        testEnergyConservation();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
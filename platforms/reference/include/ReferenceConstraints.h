@@ -34,6 +34,7 @@
 
 #include "ReferenceConstraintAlgorithm.h"
 #include "openmm/System.h"
+#include "openmm/internal/TimingRecorder.h"
 
 namespace OpenMM {
 
@@ -68,6 +69,10 @@ public:
     void applyToVelocities(std::vector<OpenMM::RealVec>& atomCoordinates, std::vector<OpenMM::RealVec>& velocities, std::vector<RealOpenMM>& inverseMasses, RealOpenMM tolerance);
     ReferenceConstraintAlgorithm* ccma;
     ReferenceConstraintAlgorithm* settle;
+    /**
+     * If this is not NULL, the time spent applying constraints is recorded in it.
+     */
+    TimingRecorder* timing;
 };
 
 } // namespace OpenMM
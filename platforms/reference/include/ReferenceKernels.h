@@ -157,6 +157,36 @@ public:
      * @param forces  on exit, this contains the forces
      */
     void getForces(ContextImpl& context, std::vector<Vec3>& forces);
+    /**
+     * Copy positions, velocities, or forces for a set of particles into a buffer provided by the caller.
+     *
+     * @param type       the data to retrieve: State::Positions, State::Velocities, or State::Forces
+     * @param buffer     on exit, the three components for the i'th requested particle are stored in
+     *                   buffer[i*stride], buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles
+     * @param particles  the indices of the particles to retrieve.  If this is empty, all particles are retrieved in order.
+     */
+    void getParticleData(ContextImpl& context, State::DataType type, double* buffer, int stride, const std::vector<int>& particles);
+    void getParticleData(ContextImpl& context, State::DataType type, float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Set the positions or velocities of a set of particles from a buffer provided by the caller.
+     *
+     * @param type       the data to set: State::Positions or State::Velocities
+     * @param buffer     the three components for the i'th particle are stored in buffer[i*stride],
+     *                   buffer[i*stride+1], and buffer[i*stride+2]
+     * @param stride     the number of elements between the start of consecutive particles
+     * @param particles  the indices of the particles to set.  If this is empty, all particles are set in order.
+     */
+    void setParticleData(ContextImpl& context, State::DataType type, const double* buffer, int stride, const std::vector<int>& particles);
+    void setParticleData(ContextImpl& context, State::DataType type, const float* buffer, int stride, const std::vector<int>& particles);
+    /**
+     * Compute, for every molecule, the displacement that translates its center into the first periodic box.
+     *
+     * @param moleculeStart      the index in moleculeParticles of the first particle in each molecule
+     * @param moleculeParticles  the particles in all molecules, grouped by molecule
+     * @param offsets            on exit, offsets[i] is the displacement to add to every particle in molecule i
+     */
+    void computeMoleculeImages(ContextImpl& context, const std::vector<int>& moleculeStart, const std::vector<int>& moleculeParticles, std::vector<Vec3>& offsets);
     /**
      * Get the current periodic box vectors.
      *
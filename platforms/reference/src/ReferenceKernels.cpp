@@ -71,6 +71,7 @@
 #include "openmm/internal/CustomHbondForceImpl.h"
 #include "openmm/internal/CustomNonbondedForceImpl.h"
 #include "openmm/internal/CMAPTorsionForceImpl.h"
+#include "openmm/internal/MoleculeImages.h"
 #include "openmm/internal/NonbondedForceImpl.h"
 #include "openmm/Integrator.h"
 #include "openmm/OpenMMException.h"
@@ -273,6 +274,68 @@ void ReferenceUpdateStateDataKernel::getForces(ContextImpl& context, std::vector
         forces[i] = Vec3(forceData[i][0], forceData[i][1], forceData[i][2]);
 }
 
+/**
+ * Select the array of particle data corresponding to a State::DataType.
+ */
+static vector<RealVec>& extractParticleData(ContextImpl& context, State::DataType type) {
+    if (type == State::Positions)
+        return extractPositions(context);
+    if (type == State::Velocities)
+        return extractVelocities(context);
+    if (type == State::Forces)
+        return extractForces(context);
+    throw OpenMMException("Unsupported data type for particle data");
+}
+
+template <class T>
+static void copyParticleDataToBuffer(const vector<RealVec>& data, T* buffer, int stride, const vector<int>& particles) {
+    int numParticles = (particles.size() == 0 ? data.size() : particles.size());
+    for (int i = 0; i < numParticles; i++) {
+        const RealVec& value = data[particles.size() == 0 ? i : particles[i]];
+        T* element = buffer+i*(size_t) stride;
+        element[0] = (T) value[0];
+        element[1] = (T) value[1];
+        element[2] = (T) value[2];
+    }
+}
+
+template <class T>
+static void copyParticleDataFromBuffer(vector<RealVec>& data, const T* buffer, int stride, const vector<int>& particles) {
+    int numParticles = (particles.size() == 0 ? data.size() : particles.size());
+    for (int i = 0; i < numParticles; i++) {
+        const T* element = buffer+i*(size_t) stride;
+        data[particles.size() == 0 ? i : particles[i]] = RealVec((RealOpenMM) element[0], (RealOpenMM) element[1], (RealOpenMM) element[2]);
+    }
+}
+
+void ReferenceUpdateStateDataKernel::getParticleData(ContextImpl& context, State::DataType type, double* buffer, int stride, const vector<int>& particles) {
+    copyParticleDataToBuffer(extractParticleData(context, type), buffer, stride, particles);
+}
+
+void ReferenceUpdateStateDataKernel::getParticleData(ContextImpl& context, State::DataType type, float* buffer, int stride, const vector<int>& particles) {
+    copyParticleDataToBuffer(extractParticleData(context, type), buffer, stride, particles);
+}
+
+void ReferenceUpdateStateDataKernel::setParticleData(ContextImpl& context, State::DataType type, const double* buffer, int stride, const vector<int>& particles) {
+    if (type != State::Positions && type != State::Velocities)
+        throw OpenMMException("Unsupported data type for setting particle data");
+    copyParticleDataFromBuffer(extractParticleData(context, type), buffer, stride, particles);
+}
+
+void ReferenceUpdateStateDataKernel::setParticleData(ContextImpl& context, State::DataType type, const float* buffer, int stride, const vector<int>& particles) {
+    if (type != State::Positions && type != State::Velocities)
+        throw OpenMMException("Unsupported data type for setting particle data");
+    copyParticleDataFromBuffer(extractParticleData(context, type), buffer, stride, particles);
+}
+
+void ReferenceUpdateStateDataKernel::computeMoleculeImages(ContextImpl& context, const vector<int>& moleculeStart, const vector<int>& moleculeParticles, vector<Vec3>& offsets) {
+    vector<RealVec>& posData = extractPositions(context);
+    int numMolecules = moleculeStart.size()-1;
+    offsets.resize(numMolecules);
+    if (numMolecules > 0)
+        findMoleculeImages(&posData[0], extractBoxVectors(context), moleculeStart, moleculeParticles, 0, numMolecules, &offsets[0], NULL);
+}
+
 void ReferenceUpdateStateDataKernel::getPeriodicBoxVectors(ContextImpl& context, Vec3& a, Vec3& b, Vec3& c) const {
     RealVec* vectors = extractBoxVectors(context);
     a = vectors[0];
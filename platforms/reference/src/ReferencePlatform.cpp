@@ -84,7 +84,9 @@ bool ReferencePlatform::supportsDoublePrecision() const {
 }
 
 void ReferencePlatform::contextCreated(ContextImpl& context, const map<string, string>& properties) const {
-    context.setPlatformData(new PlatformData(context.getSystem()));
+    PlatformData* data = new PlatformData(context.getSystem());
+    ((ReferenceConstraints*) data->constraints)->timing = &context.getTimingRecorder();
+    context.setPlatformData(data);
 }
 
 void ReferencePlatform::contextDestroyed(ContextImpl& context) const {
@@ -41,7 +41,7 @@
 using namespace OpenMM;
 using namespace std;
 
-ReferenceConstraints::ReferenceConstraints(const System& system) : ccma(NULL), settle(NULL) {
+ReferenceConstraints::ReferenceConstraints(const System& system) : ccma(NULL), settle(NULL), timing(NULL) {
     int numParticles = system.getNumParticles();
     vector<RealOpenMM> masses(numParticles);
     for (int i = 0; i < numParticles; ++i)
@@ -192,6 +192,7 @@ ReferenceConstraints::~ReferenceConstraints() {
 }
 
 void ReferenceConstraints::apply(vector<OpenMM::RealVec>& atomCoordinates, vector<OpenMM::RealVec>& atomCoordinatesP, vector<RealOpenMM>& inverseMasses, RealOpenMM tolerance) {
+    TimingRecorder::Scope scope(timing, "Constraints");
     if (ccma != NULL)
         ccma->apply(atomCoordinates, atomCoordinatesP, inverseMasses, tolerance);
     if (settle != NULL)
@@ -199,6 +200,7 @@ void ReferenceConstraints::apply(vector<OpenMM::RealVec>& atomCoordinates, vecto
 }
 
 void ReferenceConstraints::applyToVelocities(vector<OpenMM::RealVec>& atomCoordinates, vector<OpenMM::RealVec>& velocities, vector<RealOpenMM>& inverseMasses, RealOpenMM tolerance) {
+    TimingRecorder::Scope scope(timing, "Velocity constraints");
     if (ccma != NULL)
         ccma->applyToVelocities(atomCoordinates, velocities, inverseMasses, tolerance);
     if (settle != NULL)
@@ -153,6 +153,35 @@ public:
      * Set the surface area factor kJ/(nm*nm) used in SASA contribution
      */
     void setSurfaceAreaFactor(double surfaceAreaFactor);
+
+    /**
+     * Get the cutoff distance (nm) used when integrating the Born radii.  Pairs of atoms farther apart than this
+     * distance are omitted from the integral.  A value of 0 (the default) means all pairs are included.
+     */
+    double getBornRadiusCutoff() const;
+
+    /**
+     * Set the cutoff distance (nm) used when integrating the Born radii.  Pairs of atoms farther apart than this
+     * distance are omitted from the integral.  Their contribution decays as 1/r^6, so a cutoff of 1 to 1.5 nm
+     * introduces only a small error while making the cost of computing the Born radii linear in the number of atoms.
+     * A value of 0 means all pairs are included.
+     */
+    void setBornRadiusCutoff(double distance);
+
+    /**
+     * Get the number of force evaluations between recomputing the Born radii.  A value of 1 (the default) means
+     * they are recomputed every time forces or energy are computed.
+     */
+    int getBornRadiiUpdateInterval() const;
+
+    /**
+     * Set the number of force evaluations between recomputing the Born radii.  Between updates, the most recently
+     * computed Born radii are reused and their dependence on the atom positions is ignored.  Values greater than 1
+     * therefore trade accuracy for speed, and are only appropriate when the atoms move little between updates.
+     *
+     * @param interval    the number of force evaluations between updates, which must be at least 1
+     */
+    void setBornRadiiUpdateInterval(int interval);
     /**
      * Update the per-particle parameters in a Context to match those stored in this Force object.  This method provides
      * an efficient method to update certain parameters in an existing Context without needing to reinitialize it.
@@ -177,8 +206,9 @@ protected:
 private:
     class ParticleInfo;
     int includeCavityTerm;
+    int bornRadiiUpdateInterval;
     double solventDielectric, soluteDielectric, dielectricOffset,
-           probeRadius, surfaceAreaFactor;
+           probeRadius, surfaceAreaFactor, bornRadiusCutoff;
     std::vector<ParticleInfo> particles;
 };
 
@@ -93,6 +93,23 @@ public:
 
     };
 
+    enum MutualInducedSolver {
+
+        /**
+         * Direct inversion in the iterative subspace.  Each iteration evaluates the field from the current
+         * dipoles and extrapolates from the history of previous iterations.  This is the default.
+         */
+        DIIS = 0,
+
+        /**
+         * Conjugate gradient with a diagonal (Jacobi) preconditioner.  This usually needs substantially fewer
+         * induced field evaluations than DIIS to reach the same target epsilon.  Platforms that do not implement
+         * it fall back to DIIS.
+         */
+        ConjugateGradient = 1
+
+    };
+
     enum MultipoleAxisTypes { ZThenX = 0, Bisector = 1, ZBisect = 2, ThreeFold = 3, ZOnly = 4, NoAxisType = 5, LastAxisTypeIndex = 6 };
 
     enum CovalentType {
@@ -309,6 +326,36 @@ public:
      */
     void setMutualInducedTargetEpsilon(double inputMutualInducedTargetEpsilon);
 
+    /**
+     * Get the iterative method used to converge the mutual induced dipoles.  This has no effect unless the
+     * polarization type is Mutual.
+     */
+    MutualInducedSolver getMutualInducedSolver() const;
+
+    /**
+     * Set the iterative method used to converge the mutual induced dipoles.  This has no effect unless the
+     * polarization type is Mutual.
+     */
+    void setMutualInducedSolver(MutualInducedSolver solver);
+
+    /**
+     * Get the number of previous time steps whose converged induced dipoles are used to predict the initial
+     * guess for the mutual induced dipoles.  A value of 0 (the default) disables prediction, so iteration
+     * starts from the direct dipoles.
+     *
+     * @return the number of previous solutions used by the predictor
+     */
+    int getMutualInducedPredictorOrder() const;
+
+    /**
+     * Set the number of previous time steps whose converged induced dipoles are used to predict the initial
+     * guess for the mutual induced dipoles.  The prediction uses the always stable predictor-corrector (ASPC)
+     * coefficients of Kolafa (J. Comput. Chem. 25, 335 (2004)).  A value of 0 disables prediction.
+     *
+     * @param order    the number of previous solutions to use, between 0 and 8
+     */
+    void setMutualInducedPredictorOrder(int order);
+
     /**
      * Set the coefficients for the mu_0, mu_1, mu_2, ..., mu_n terms in the extrapolation
      * algorithm for induced dipoles.
@@ -412,6 +459,8 @@ private:
     int pmeBSplineOrder;
     std::vector<int> pmeGridDimension;
     int mutualInducedMaxIterations;
+    MutualInducedSolver mutualInducedSolver;
+    int mutualInducedPredictorOrder;
     std::vector<double> extrapolationCoefficients;
 
     double mutualInducedTargetEpsilon;
@@ -36,7 +36,8 @@
 
 using namespace OpenMM;
 
-AmoebaGeneralizedKirkwoodForce::AmoebaGeneralizedKirkwoodForce() : solventDielectric(78.3), soluteDielectric(1.0), dielectricOffset(0.009), includeCavityTerm(1), probeRadius(0.14) {
+AmoebaGeneralizedKirkwoodForce::AmoebaGeneralizedKirkwoodForce() : solventDielectric(78.3), soluteDielectric(1.0), dielectricOffset(0.009), includeCavityTerm(1), probeRadius(0.14),
+                                                                   bornRadiusCutoff(0.0), bornRadiiUpdateInterval(1) {
 
      surfaceAreaFactor = -6.0* 3.1415926535*0.0216*1000.0*0.4184;
 }
@@ -90,6 +91,26 @@ void AmoebaGeneralizedKirkwoodForce::setSurfaceAreaFactor(double inputSurfaceAre
     surfaceAreaFactor = inputSurfaceAreaFactor;
 }
 
+double AmoebaGeneralizedKirkwoodForce::getBornRadiusCutoff() const {
+    return bornRadiusCutoff;
+}
+
+void AmoebaGeneralizedKirkwoodForce::setBornRadiusCutoff(double distance) {
+    if (distance < 0.0)
+        throw OpenMMException("AmoebaGeneralizedKirkwoodForce: Born radius cutoff cannot be negative");
+    bornRadiusCutoff = distance;
+}
+
+int AmoebaGeneralizedKirkwoodForce::getBornRadiiUpdateInterval() const {
+    return bornRadiiUpdateInterval;
+}
+
+void AmoebaGeneralizedKirkwoodForce::setBornRadiiUpdateInterval(int interval) {
+    if (interval < 1)
+        throw OpenMMException("AmoebaGeneralizedKirkwoodForce: Born radii update interval must be at least 1");
+    bornRadiiUpdateInterval = interval;
+}
+
 ForceImpl* AmoebaGeneralizedKirkwoodForce::createImpl() const {
     return new AmoebaGeneralizedKirkwoodForceImpl(*this);
 }
@@ -40,6 +40,7 @@ using std::string;
 using std::vector;
 
 AmoebaMultipoleForce::AmoebaMultipoleForce() : nonbondedMethod(NoCutoff), polarizationType(Mutual), pmeBSplineOrder(5), cutoffDistance(1.0), ewaldErrorTol(1e-4), mutualInducedMaxIterations(60),
+                                               mutualInducedSolver(DIIS), mutualInducedPredictorOrder(0),
                                                mutualInducedTargetEpsilon(1.0e-02), scalingDistanceCutoff(100.0), electricConstant(138.9354558456), aewald(0.0) {
     pmeGridDimension.resize(3);
     pmeGridDimension[0] = pmeGridDimension[1] = pmeGridDimension[2];
@@ -135,6 +136,24 @@ void AmoebaMultipoleForce::setMutualInducedTargetEpsilon(double inputMutualInduc
     mutualInducedTargetEpsilon = inputMutualInducedTargetEpsilon;
 }
 
+AmoebaMultipoleForce::MutualInducedSolver AmoebaMultipoleForce::getMutualInducedSolver() const {
+    return mutualInducedSolver;
+}
+
+void AmoebaMultipoleForce::setMutualInducedSolver(AmoebaMultipoleForce::MutualInducedSolver solver) {
+    mutualInducedSolver = solver;
+}
+
+int AmoebaMultipoleForce::getMutualInducedPredictorOrder() const {
+    return mutualInducedPredictorOrder;
+}
+
+void AmoebaMultipoleForce::setMutualInducedPredictorOrder(int order) {
+    if (order < 0 || order > 8)
+        throw OpenMMException("AmoebaMultipoleForce: mutual induced predictor order must be between 0 and 8");
+    mutualInducedPredictorOrder = order;
+}
+
 double AmoebaMultipoleForce::getEwaldErrorTolerance() const {
     return ewaldErrorTol;
 }
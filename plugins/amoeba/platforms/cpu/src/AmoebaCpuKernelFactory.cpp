@@ -0,0 +1,83 @@
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "AmoebaCpuKernelFactory.h"
+#include "AmoebaCpuKernels.h"
+#include "CpuPlatform.h"
+#include "openmm/internal/ContextImpl.h"
+#include "openmm/OpenMMException.h"
+
+using namespace OpenMM;
+
+static void registerCpuKernelFactories() {
+    try {
+        Platform& platform = Platform::getPlatformByName("CPU");
+        AmoebaCpuKernelFactory* factory = new AmoebaCpuKernelFactory();
+        platform.registerKernelFactory(CalcAmoebaVdwForceKernel::Name(), factory);
+        platform.registerKernelFactory(CalcAmoebaGeneralizedKirkwoodForceKernel::Name(), factory);
+    }
+    catch (...) {
+        // Ignore.  The CPU platform isn't available.
+    }
+}
+
+extern "C" OPENMM_EXPORT void registerPlatforms() {
+}
+
+extern "C" OPENMM_EXPORT void registerKernelFactories() {
+    registerCpuKernelFactories();
+}
+
+extern "C" OPENMM_EXPORT void registerAmoebaCpuKernelFactories() {
+    try {
+        Platform::getPlatformByName("CPU");
+    }
+    catch (...) {
+        if (CpuPlatform::isProcessorSupported())
+            Platform::registerPlatform(new CpuPlatform());
+    }
+    registerCpuKernelFactories();
+}
+
+KernelImpl* AmoebaCpuKernelFactory::createKernelImpl(std::string name, const Platform& platform, ContextImpl& context) const {
+    CpuPlatform::PlatformData& data = CpuPlatform::getPlatformData(context);
+
+    // Double precision contexts use the Reference implementations.
+
+    if (data.useDoublePrecision && name == CalcAmoebaVdwForceKernel::Name())
+        return new ReferenceCalcAmoebaVdwForceKernel(name, platform, context.getSystem());
+
+    if (data.useDoublePrecision && name == CalcAmoebaGeneralizedKirkwoodForceKernel::Name())
+        return new ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel(name, platform, context.getSystem());
+
+    if (name == CalcAmoebaVdwForceKernel::Name())
+        return new CpuCalcAmoebaVdwForceKernel(name, platform, data, context.getSystem());
+
+    if (name == CalcAmoebaGeneralizedKirkwoodForceKernel::Name())
+        return new CpuCalcAmoebaGeneralizedKirkwoodForceKernel(name, platform, data, context.getSystem());
+
+    throw OpenMMException((std::string("Tried to create kernel with illegal kernel name '")+name+"'").c_str());
+}
@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "AmoebaCpuKernels.h"
+#include "CpuAmoebaGeneralizedKirkwoodMultipoleForce.h"
+#include "openmm/internal/AmoebaVdwForceImpl.h"
+#include "openmm/internal/ContextImpl.h"
+#include "openmm/OpenMMException.h"
+#include "RealVec.h"
+
+using namespace OpenMM;
+using namespace std;
+
+static vector<RealVec>& extractPositions(ContextImpl& context) {
+    ReferencePlatform::PlatformData* data = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    return *((vector<RealVec>*) data->positions);
+}
+
+static RealVec* extractBoxVectors(ContextImpl& context) {
+    ReferencePlatform::PlatformData* data = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    return (RealVec*) data->periodicBoxVectors;
+}
+
+/* -------------------------------------------------------------------------- *
+ *                                AmoebaVdw                                   *
+ * -------------------------------------------------------------------------- */
+
+CpuCalcAmoebaVdwForceKernel::CpuCalcAmoebaVdwForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, const System& system) :
+       CalcAmoebaVdwForceKernel(name, platform), data(data), system(system), vdwForce(NULL) {
+}
+
+CpuCalcAmoebaVdwForceKernel::~CpuCalcAmoebaVdwForceKernel() {
+    if (vdwForce != NULL)
+        delete vdwForce;
+}
+
+void CpuCalcAmoebaVdwForceKernel::initialize(const System& system, const AmoebaVdwForce& force) {
+
+    // per-particle parameters
+
+    numParticles = system.getNumParticles();
+    indexIVs.resize(numParticles);
+    sigmas.resize(numParticles);
+    epsilons.resize(numParticles);
+    reductions.resize(numParticles);
+    vector<set<int> > allExclusions(numParticles);
+    for (int ii = 0; ii < numParticles; ii++) {
+        int indexIV;
+        double sigma, epsilon, reduction;
+        vector<int> exclusions;
+        force.getParticleParameters(ii, indexIV, sigma, epsilon, reduction);
+        force.getParticleExclusions(ii, exclusions);
+        for (int jj = 0; jj < (int) exclusions.size(); jj++)
+            allExclusions[ii].insert(exclusions[jj]);
+        indexIVs[ii] = indexIV;
+        sigmas[ii] = (float) sigma;
+        epsilons[ii] = (float) epsilon;
+        reductions[ii] = (float) reduction;
+    }
+    useCutoff = (force.getNonbondedMethod() != AmoebaVdwForce::NoCutoff);
+    usePBC = (force.getNonbondedMethod() == AmoebaVdwForce::CutoffPeriodic);
+    cutoff = force.getCutoff();
+    dispersionCoefficient = force.getUseDispersionCorrection() ? AmoebaVdwForceImpl::calcDispersionCorrection(system, force) : 0.0;
+    vdwForce = new CpuAmoebaVdwForce(force.getSigmaCombiningRule(), force.getEpsilonCombiningRule(), allExclusions, data.threads);
+    vdwForce->setParticleParameters(indexIVs, sigmas, epsilons, reductions);
+    if (useCutoff)
+        vdwForce->setUseCutoff(cutoff, 0.1*cutoff);
+}
+
+double CpuCalcAmoebaVdwForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    vector<RealVec>& posData = extractPositions(context);
+    double energy = 0.0;
+    if (usePBC) {
+        RealVec* boxVectors = extractBoxVectors(context);
+        double minAllowedSize = 1.999999*cutoff;
+        if (boxVectors[0][0] < minAllowedSize || boxVectors[1][1] < minAllowedSize || boxVectors[2][2] < minAllowedSize)
+            throw OpenMMException("The periodic box size has decreased to less than twice the cutoff.");
+        vdwForce->setPeriodic(boxVectors);
+        energy += dispersionCoefficient/(boxVectors[0][0]*boxVectors[1][1]*boxVectors[2][2]);
+    }
+    energy += vdwForce->calculateForceAndEnergy(posData, data.threadForce, includeForces, includeEnergy);
+    return energy;
+}
+
+void CpuCalcAmoebaVdwForceKernel::copyParametersToContext(ContextImpl& context, const AmoebaVdwForce& force) {
+    if (numParticles != force.getNumParticles())
+        throw OpenMMException("updateParametersInContext: The number of particles has changed");
+
+    // Record the values.
+
+    for (int i = 0; i < numParticles; ++i) {
+        int indexIV;
+        double sigma, epsilon, reduction;
+        force.getParticleParameters(i, indexIV, sigma, epsilon, reduction);
+        indexIVs[i] = indexIV;
+        sigmas[i] = (float) sigma;
+        epsilons[i] = (float) epsilon;
+        reductions[i] = (float) reduction;
+    }
+    vdwForce->setParticleParameters(indexIVs, sigmas, epsilons, reductions);
+}
+
+/* -------------------------------------------------------------------------- *
+ *                           AmoebaGeneralizedKirkwood                        *
+ * -------------------------------------------------------------------------- */
+
+CpuCalcAmoebaGeneralizedKirkwoodForceKernel::CpuCalcAmoebaGeneralizedKirkwoodForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, const System& system) :
+       ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel(name, platform, system), data(data), gkForce(NULL) {
+}
+
+CpuCalcAmoebaGeneralizedKirkwoodForceKernel::~CpuCalcAmoebaGeneralizedKirkwoodForceKernel() {
+    if (gkForce != NULL)
+        delete gkForce;
+}
+
+void CpuCalcAmoebaGeneralizedKirkwoodForceKernel::initialize(const System& system, const AmoebaGeneralizedKirkwoodForce& force) {
+    ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::initialize(system, force);
+    gkForce = new CpuAmoebaGeneralizedKirkwoodForce(data.threads);
+    gkForce->setBornRadiusCutoff(force.getBornRadiusCutoff());
+}
+
+AmoebaReferenceGeneralizedKirkwoodMultipoleForce* CpuCalcAmoebaGeneralizedKirkwoodForceKernel::createMultipoleForce(AmoebaReferenceGeneralizedKirkwoodForce* gkForce) {
+    return new CpuAmoebaGeneralizedKirkwoodMultipoleForce(gkForce, data.threads);
+}
+
+void CpuCalcAmoebaGeneralizedKirkwoodForceKernel::computeBornRadii(ContextImpl& context, vector<RealOpenMM>& bornRadii) {
+    // The parameters may have been changed by copyParametersToContext(), so pass the current values.
+
+    vector<double> radii(atomicRadii.begin(), atomicRadii.end());
+    vector<double> scales(scaleFactors.begin(), scaleFactors.end());
+    gkForce->setParticleParameters(radii, scales);
+    vector<double> radiiOut;
+    gkForce->computeBornRadii(extractPositions(context), radiiOut);
+    bornRadii.assign(radiiOut.begin(), radiiOut.end());
+}
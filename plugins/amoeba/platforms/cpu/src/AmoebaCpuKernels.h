@@ -0,0 +1,122 @@
+#ifndef AMOEBA_OPENMM_CPU_KERNELS_H_
+#define AMOEBA_OPENMM_CPU_KERNELS_H_
+
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/System.h"
+#include "openmm/amoebaKernels.h"
+#include "AmoebaReferenceKernels.h"
+#include "CpuAmoebaGeneralizedKirkwoodForce.h"
+#include "CpuAmoebaVdwForce.h"
+#include "CpuPlatform.h"
+
+namespace OpenMM {
+
+/**
+ * This kernel is invoked to calculate the vdw forces acting on the system and the energy of the system.
+ */
+class CpuCalcAmoebaVdwForceKernel : public CalcAmoebaVdwForceKernel {
+public:
+    CpuCalcAmoebaVdwForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, const System& system);
+    ~CpuCalcAmoebaVdwForceKernel();
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the AmoebaVdwForce this kernel will be used for
+     */
+    void initialize(const System& system, const AmoebaVdwForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the AmoebaVdwForce to copy the parameters from
+     */
+    void copyParametersToContext(ContextImpl& context, const AmoebaVdwForce& force);
+private:
+    CpuPlatform::PlatformData& data;
+    int numParticles;
+    bool useCutoff;
+    bool usePBC;
+    double cutoff;
+    double dispersionCoefficient;
+    std::vector<int> indexIVs;
+    std::vector<float> sigmas;
+    std::vector<float> epsilons;
+    std::vector<float> reductions;
+    const System& system;
+    CpuAmoebaVdwForce* vdwForce;
+};
+
+/**
+ * This kernel is invoked by AmoebaGeneralizedKirkwoodForce.  The generalized Kirkwood interaction itself is
+ * computed by the multipole kernel inherited from the Reference platform; this kernel provides it with
+ * Born radii computed in parallel, and with a multipole force that divides the pair loops between threads.
+ */
+class CpuCalcAmoebaGeneralizedKirkwoodForceKernel : public ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel {
+public:
+    CpuCalcAmoebaGeneralizedKirkwoodForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, const System& system);
+    ~CpuCalcAmoebaGeneralizedKirkwoodForceKernel();
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the AmoebaGeneralizedKirkwoodForce this kernel will be used for
+     */
+    void initialize(const System& system, const AmoebaGeneralizedKirkwoodForce& force);
+    /**
+     * Create the object that computes the generalized Kirkwood multipole interaction.
+     *
+     * @param gkForce    the AmoebaReferenceGeneralizedKirkwoodForce holding the GK parameters and Born radii
+     * @return the newly created multipole force
+     */
+    AmoebaReferenceGeneralizedKirkwoodMultipoleForce* createMultipoleForce(AmoebaReferenceGeneralizedKirkwoodForce* gkForce);
+protected:
+    /**
+     * Compute the Grycuk Born radii.
+     *
+     * @param context    the context in which to compute the Born radii
+     * @param bornRadii  on exit, the Born radius of every particle
+     */
+    void computeBornRadii(ContextImpl& context, std::vector<RealOpenMM>& bornRadii);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuAmoebaGeneralizedKirkwoodForce* gkForce;
+};
+
+} // namespace OpenMM
+
+#endif /*AMOEBA_OPENMM_CPU_KERNELS_H_*/
@@ -0,0 +1,189 @@
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuAmoebaGeneralizedKirkwoodForce.h"
+#include "openmm/internal/gmx_atomic.h"
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+class CpuAmoebaGeneralizedKirkwoodForce::ComputeBornSumTask : public ThreadPool::Task {
+public:
+    ComputeBornSumTask(CpuAmoebaGeneralizedKirkwoodForce& owner) : owner(owner) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        owner.threadComputeBornSum(threads, threadIndex);
+    }
+    CpuAmoebaGeneralizedKirkwoodForce& owner;
+};
+
+CpuAmoebaGeneralizedKirkwoodForce::CpuAmoebaGeneralizedKirkwoodForce(ThreadPool& threads) : numParticles(0), cutoffDistance(0.0),
+            threads(threads), neighborList(NULL) {
+    threadBornSum.resize(threads.getNumThreads());
+}
+
+CpuAmoebaGeneralizedKirkwoodForce::~CpuAmoebaGeneralizedKirkwoodForce() {
+    if (neighborList != NULL)
+        delete neighborList;
+}
+
+void CpuAmoebaGeneralizedKirkwoodForce::setBornRadiusCutoff(double distance) {
+    cutoffDistance = distance;
+    if (distance > 0.0 && neighborList == NULL)
+        neighborList = new CpuNeighborList(4);
+}
+
+void CpuAmoebaGeneralizedKirkwoodForce::setParticleParameters(const vector<double>& atomicRadii, const vector<double>& scaleFactors) {
+    numParticles = atomicRadii.size();
+    this->atomicRadii = atomicRadii;
+    scaledRadii.resize(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        scaledRadii[i] = atomicRadii[i]*scaleFactors[i];
+    exclusions = CpuExclusions(numParticles);
+    posq.resize(4*numParticles);
+    for (int i = 0; i < (int) threadBornSum.size(); i++)
+        threadBornSum[i].resize(numParticles);
+}
+
+void CpuAmoebaGeneralizedKirkwoodForce::computeBornRadii(const vector<RealVec>& atomCoordinates, vector<double>& bornRadii) {
+    this->atomCoordinates = &atomCoordinates[0];
+    if (cutoffDistance > 0.0) {
+        // Find the pairs of atoms that contribute to the integral.
+
+        for (int i = 0; i < numParticles; i++)
+            for (int j = 0; j < 3; j++)
+                posq[4*i+j] = (float) atomCoordinates[i][j];
+        RealVec boxVectors[3] = {RealVec(1, 0, 0), RealVec(0, 1, 0), RealVec(0, 0, 1)};
+        neighborList->computeNeighborList(numParticles, posq, exclusions, boxVectors, false, (float) cutoffDistance, threads);
+    }
+
+    // Integrate over the solute volume.
+
+    gmx_atomic_t counter;
+    gmx_atomic_set(&counter, 0);
+    this->atomicCounter = &counter;
+    ComputeBornSumTask task(*this);
+    threads.execute(task);
+    threads.waitForThreads();
+
+    // Combine the results from all the threads and compute the Born radii.
+
+    const double bigRadius = 1000.0;
+    int numThreads = threads.getNumThreads();
+    bornRadii.resize(numParticles);
+    for (int i = 0; i < numParticles; i++) {
+        if (atomicRadii[i] <= 0.0) {
+            bornRadii[i] = bigRadius;
+            continue;
+        }
+        double bornSum = 0.0;
+        for (int j = 0; j < numThreads; j++)
+            bornSum += threadBornSum[j][i];
+        bornSum = 1.0/(atomicRadii[i]*atomicRadii[i]*atomicRadii[i]) - bornSum;
+        bornRadii[i] = (bornSum <= 0.0 ? bigRadius : pow(bornSum, -1.0/3.0));
+    }
+}
+
+void CpuAmoebaGeneralizedKirkwoodForce::threadComputeBornSum(ThreadPool& threads, int threadIndex) {
+    vector<double>& bornSum = threadBornSum[threadIndex];
+    for (int i = 0; i < numParticles; i++)
+        bornSum[i] = 0.0;
+    if (cutoffDistance > 0.0) {
+        // Loop over pairs from the neighbor list, adding the contribution of each atom to the other one's integral.
+
+        double cutoff2 = cutoffDistance*cutoffDistance;
+        const int numBlocks = neighborList->getNumBlocks();
+        while (true) {
+            int blockIndex = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
+            if (blockIndex >= numBlocks)
+                break;
+            const int* blockAtom = &neighborList->getSortedAtoms()[4*blockIndex];
+            const vector<int>& neighbors = neighborList->getBlockNeighbors(blockIndex);
+            const vector<char>& blockExclusions = neighborList->getBlockExclusions(blockIndex);
+            for (int k = 0; k < 4; k++) {
+                int i = blockAtom[k];
+                for (int n = 0; n < (int) neighbors.size(); n++) {
+                    if ((blockExclusions[n] & (1<<k)) != 0)
+                        continue;
+                    int j = neighbors[n];
+                    RealVec delta = atomCoordinates[j]-atomCoordinates[i];
+                    double r2 = delta.dot(delta);
+                    if (r2 > cutoff2)
+                        continue;
+                    double r = sqrt(r2);
+                    if (atomicRadii[i] > 0.0 && atomicRadii[j] >= 0.0)
+                        bornSum[i] += computeBornSumTerm(atomicRadii[i], scaledRadii[j], r);
+                    if (atomicRadii[j] > 0.0 && atomicRadii[i] >= 0.0)
+                        bornSum[j] += computeBornSumTerm(atomicRadii[j], scaledRadii[i], r);
+                }
+            }
+        }
+    }
+    else {
+        // Every atom contributes to the integral for every other one.  Each thread processes whole
+        // atoms at a time, so no two threads ever add to the same integral.
+
+        while (true) {
+            int i = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
+            if (i >= numParticles)
+                break;
+            if (atomicRadii[i] <= 0.0)
+                continue;
+            double sum = 0.0;
+            for (int j = 0; j < numParticles; j++) {
+                if (j == i || atomicRadii[j] < 0.0)
+                    continue;
+                RealVec delta = atomCoordinates[j]-atomCoordinates[i];
+                sum += computeBornSumTerm(atomicRadii[i], scaledRadii[j], sqrt(delta.dot(delta)));
+            }
+            bornSum[i] = sum;
+        }
+    }
+}
+
+double CpuAmoebaGeneralizedKirkwoodForce::computeBornSumTerm(double radiusI, double scaledRadiusJ, double r) const {
+    double sk = scaledRadiusJ;
+    double sk2 = sk*sk;
+    double r2 = r*r;
+    double sum = 0.0;
+    if (radiusI+r < sk) {
+        double uik = sk-r;
+        sum -= 1.0/(uik*uik*uik) - 1.0/(radiusI*radiusI*radiusI);
+    }
+    double uik = r+sk;
+    double lik;
+    if (radiusI+r < sk)
+        lik = sk-r;
+    else if (r < radiusI+sk)
+        lik = radiusI;
+    else
+        lik = r-sk;
+    double l2 = lik*lik;
+    double u2 = uik*uik;
+    double term = (3.0*(r2-sk2) + 6.0*u2 - 8.0*uik*r)/(u2*u2*r) - (3.0*(r2-sk2) + 6.0*l2 - 8.0*lik*r)/(l2*l2*r);
+    return sum + term/16.0;
+}
@@ -0,0 +1,106 @@
+#ifndef OPENMM_CPU_AMOEBA_GK_FORCE_H__
+#define OPENMM_CPU_AMOEBA_GK_FORCE_H__
+
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "AlignedArray.h"
+#include "CpuExclusions.h"
+#include "CpuNeighborList.h"
+#include "RealVec.h"
+#include "openmm/internal/ThreadPool.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class computes the Grycuk Born radii used by the AMOEBA generalized Kirkwood model on the CPU.
+ * The integral over the solute volume is split between threads.  If a cutoff is specified, only pairs
+ * of atoms found by a neighbor list contribute to it, which makes the cost linear in the number of atoms.
+ */
+class CpuAmoebaGeneralizedKirkwoodForce {
+public:
+    class ComputeBornSumTask;
+
+    /**
+     * Create a CpuAmoebaGeneralizedKirkwoodForce.
+     *
+     * @param threads    the thread pool to use
+     */
+    CpuAmoebaGeneralizedKirkwoodForce(ThreadPool& threads);
+
+    ~CpuAmoebaGeneralizedKirkwoodForce();
+
+    /**
+     * Set the cutoff used when integrating the Born radii.
+     *
+     * @param distance    pairs of atoms farther apart than this are omitted.  A value of 0 means all pairs are included.
+     */
+    void setBornRadiusCutoff(double distance);
+
+    /**
+     * Set the per-particle parameters.
+     *
+     * @param atomicRadii    the atomic radius of each particle
+     * @param scaleFactors   the scale factor of each particle
+     */
+    void setParticleParameters(const std::vector<double>& atomicRadii, const std::vector<double>& scaleFactors);
+
+    /**
+     * Compute the Born radii.
+     *
+     * @param atomCoordinates  atom coordinates
+     * @param bornRadii        on exit, the Born radius of every particle
+     */
+    void computeBornRadii(const std::vector<RealVec>& atomCoordinates, std::vector<double>& bornRadii);
+
+    /**
+     * This routine contains the code executed by each thread.
+     */
+    void threadComputeBornSum(ThreadPool& threads, int threadIndex);
+
+private:
+    int numParticles;
+    double cutoffDistance;
+    std::vector<double> atomicRadii, scaledRadii;
+    CpuExclusions exclusions;
+    ThreadPool& threads;
+    CpuNeighborList* neighborList;
+    AlignedArray<float> posq;
+    std::vector<std::vector<double> > threadBornSum;
+    // The following variables are used to make information accessible to the individual threads.
+    RealVec const* atomCoordinates;
+    void* atomicCounter;
+
+    /**
+     * Compute the contribution of atom j to the integral for atom i.
+     */
+    double computeBornSumTerm(double radiusI, double scaledRadiusJ, double r) const;
+};
+
+} // namespace OpenMM
+
+#endif // OPENMM_CPU_AMOEBA_GK_FORCE_H__
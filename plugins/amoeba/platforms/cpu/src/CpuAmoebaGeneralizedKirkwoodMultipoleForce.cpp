@@ -0,0 +1,150 @@
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuAmoebaGeneralizedKirkwoodMultipoleForce.h"
+#include "openmm/internal/WorkStealingRange.h"
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Each thread processes whole rows ii of the pair loop, adding to its own buffers.  Rows get shorter
+ * as ii increases, so they are handed out one at a time and balanced by work stealing.
+ */
+class CpuAmoebaGeneralizedKirkwoodMultipoleForce::KirkwoodTask : public ParallelForBody {
+public:
+    KirkwoodTask(const CpuAmoebaGeneralizedKirkwoodMultipoleForce& owner, const vector<MultipoleParticleData>& particleData, int numThreads) :
+            owner(owner), particleData(particleData), forces(numThreads, vector<RealVec>(particleData.size(), RealVec())),
+            torques(numThreads, vector<RealVec>(particleData.size(), RealVec())),
+            dBorn(numThreads, vector<RealOpenMM>(particleData.size(), 0.0)), energy(numThreads, 0.0) {
+    }
+    void execute(int start, int end, int threadIndex) {
+        for (int ii = start; ii < end; ii++)
+            for (unsigned int jj = ii; jj < particleData.size(); jj++)
+                energy[threadIndex] += owner.calculateKirkwoodPairIxn(particleData[ii], particleData[jj], forces[threadIndex], torques[threadIndex], dBorn[threadIndex]);
+    }
+    const CpuAmoebaGeneralizedKirkwoodMultipoleForce& owner;
+    const vector<MultipoleParticleData>& particleData;
+    vector<vector<RealVec> > forces, torques;
+    vector<vector<RealOpenMM> > dBorn;
+    vector<RealOpenMM> energy;
+};
+
+class CpuAmoebaGeneralizedKirkwoodMultipoleForce::ChainRuleTask : public ParallelForBody {
+public:
+    ChainRuleTask(const CpuAmoebaGeneralizedKirkwoodMultipoleForce& owner, const vector<MultipoleParticleData>& particleData,
+            const vector<RealOpenMM>& dBorn, int numThreads) :
+            owner(owner), particleData(particleData), dBorn(dBorn), forces(numThreads, vector<RealVec>(particleData.size(), RealVec())) {
+    }
+    void execute(int start, int end, int threadIndex) {
+        for (int ii = start; ii < end; ii++) {
+            for (unsigned int jj = ii+1; jj < particleData.size(); jj++) {
+                owner.calculateGrycukChainRulePairIxn(particleData[ii], particleData[jj], dBorn, forces[threadIndex]);
+                owner.calculateGrycukChainRulePairIxn(particleData[jj], particleData[ii], dBorn, forces[threadIndex]);
+            }
+        }
+    }
+    const CpuAmoebaGeneralizedKirkwoodMultipoleForce& owner;
+    const vector<MultipoleParticleData>& particleData;
+    const vector<RealOpenMM>& dBorn;
+    vector<vector<RealVec> > forces;
+};
+
+class CpuAmoebaGeneralizedKirkwoodMultipoleForce::EDiffTask : public ParallelForBody {
+public:
+    EDiffTask(const CpuAmoebaGeneralizedKirkwoodMultipoleForce& owner, const vector<MultipoleParticleData>& particleData, int numThreads) :
+            owner(owner), particleData(particleData), forces(numThreads, vector<RealVec>(particleData.size(), RealVec())),
+            torques(numThreads, vector<RealVec>(particleData.size(), RealVec())),
+            scaleFactors(numThreads, vector<RealOpenMM>(LAST_SCALE_TYPE_INDEX, 1.0)), energy(numThreads, 0.0) {
+    }
+    void execute(int start, int end, int threadIndex) {
+        vector<RealOpenMM>& factors = scaleFactors[threadIndex];
+        for (int ii = start; ii < end; ii++) {
+            for (unsigned int jj = ii+1; jj < particleData.size(); jj++) {
+                bool scaled = (jj <= owner._maxScaleIndex[ii]);
+                if (scaled)
+                    owner.getMultipoleScaleFactors(ii, jj, factors);
+                energy[threadIndex] += owner.calculateKirkwoodEDiffPairIxn(particleData[ii], particleData[jj],
+                        factors[P_SCALE], factors[D_SCALE], forces[threadIndex], torques[threadIndex]);
+                if (scaled)
+                    for (int kk = 0; kk < LAST_SCALE_TYPE_INDEX; kk++)
+                        factors[kk] = 1.0;
+            }
+        }
+    }
+    const CpuAmoebaGeneralizedKirkwoodMultipoleForce& owner;
+    const vector<MultipoleParticleData>& particleData;
+    vector<vector<RealVec> > forces, torques;
+    vector<vector<RealOpenMM> > scaleFactors;
+    vector<RealOpenMM> energy;
+};
+
+CpuAmoebaGeneralizedKirkwoodMultipoleForce::CpuAmoebaGeneralizedKirkwoodMultipoleForce(AmoebaReferenceGeneralizedKirkwoodForce* gkForce, ThreadPool& threads) :
+        AmoebaReferenceGeneralizedKirkwoodMultipoleForce(gkForce), threads(threads) {
+}
+
+RealOpenMM CpuAmoebaGeneralizedKirkwoodMultipoleForce::calculateKirkwoodIxns(const vector<MultipoleParticleData>& particleData,
+        vector<RealVec>& forces, vector<RealVec>& torques, vector<RealOpenMM>& dBorn) const {
+    int numThreads = threads.getNumThreads();
+    KirkwoodTask task(*this, particleData, numThreads);
+    parallelFor(threads, particleData.size(), 1, task);
+    RealOpenMM energy = 0.0;
+    for (int i = 0; i < numThreads; i++) {
+        energy += task.energy[i];
+        for (int j = 0; j < (int) particleData.size(); j++) {
+            forces[j] += task.forces[i][j];
+            torques[j] += task.torques[i][j];
+            dBorn[j] += task.dBorn[i][j];
+        }
+    }
+    return energy;
+}
+
+void CpuAmoebaGeneralizedKirkwoodMultipoleForce::calculateGrycukChainRuleIxns(const vector<MultipoleParticleData>& particleData,
+        const vector<RealOpenMM>& dBorn, vector<RealVec>& forces) const {
+    int numThreads = threads.getNumThreads();
+    ChainRuleTask task(*this, particleData, dBorn, numThreads);
+    parallelFor(threads, particleData.size(), 1, task);
+    for (int i = 0; i < numThreads; i++)
+        for (int j = 0; j < (int) particleData.size(); j++)
+            forces[j] += task.forces[i][j];
+}
+
+RealOpenMM CpuAmoebaGeneralizedKirkwoodMultipoleForce::calculateKirkwoodEDiffIxns(const vector<MultipoleParticleData>& particleData,
+        vector<RealVec>& forces, vector<RealVec>& torques) const {
+    int numThreads = threads.getNumThreads();
+    EDiffTask task(*this, particleData, numThreads);
+    parallelFor(threads, particleData.size(), 1, task);
+    RealOpenMM energy = 0.0;
+    for (int i = 0; i < numThreads; i++) {
+        energy += task.energy[i];
+        for (int j = 0; j < (int) particleData.size(); j++) {
+            forces[j] += task.forces[i][j];
+            torques[j] += task.torques[i][j];
+        }
+    }
+    return energy;
+}
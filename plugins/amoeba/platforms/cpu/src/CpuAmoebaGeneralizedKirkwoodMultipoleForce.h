@@ -0,0 +1,68 @@
+#ifndef OPENMM_CPU_AMOEBA_GK_MULTIPOLE_FORCE_H__
+#define OPENMM_CPU_AMOEBA_GK_MULTIPOLE_FORCE_H__
+
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "AmoebaReferenceMultipoleForce.h"
+#include "openmm/internal/ThreadPool.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This computes the generalized Kirkwood multipole interaction.  The O(N^2) loops over particle pairs are
+ * divided between threads, each of which accumulates into its own force, torque, and Born force buffers.
+ */
+class CpuAmoebaGeneralizedKirkwoodMultipoleForce : public AmoebaReferenceGeneralizedKirkwoodMultipoleForce {
+public:
+    class KirkwoodTask;
+    class ChainRuleTask;
+    class EDiffTask;
+
+    /**
+     * Create a CpuAmoebaGeneralizedKirkwoodMultipoleForce.
+     *
+     * @param gkForce    the generalized Kirkwood parameters; ownership is transferred to this object
+     * @param threads    the thread pool to use
+     */
+    CpuAmoebaGeneralizedKirkwoodMultipoleForce(AmoebaReferenceGeneralizedKirkwoodForce* gkForce, ThreadPool& threads);
+
+protected:
+    RealOpenMM calculateKirkwoodIxns(const std::vector<MultipoleParticleData>& particleData,
+                                     std::vector<RealVec>& forces, std::vector<RealVec>& torques,
+                                     std::vector<RealOpenMM>& dBorn) const;
+    void calculateGrycukChainRuleIxns(const std::vector<MultipoleParticleData>& particleData,
+                                      const std::vector<RealOpenMM>& dBorn, std::vector<RealVec>& forces) const;
+    RealOpenMM calculateKirkwoodEDiffIxns(const std::vector<MultipoleParticleData>& particleData,
+                                          std::vector<RealVec>& forces, std::vector<RealVec>& torques) const;
+private:
+    ThreadPool& threads;
+};
+
+} // namespace OpenMM
+
+#endif // OPENMM_CPU_AMOEBA_GK_MULTIPOLE_FORCE_H__
@@ -0,0 +1,495 @@
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuAmoebaVdwForce.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/gmx_atomic.h"
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+static const float DHAL = 0.07f;
+static const float GHAL = 0.12f;
+
+class CpuAmoebaVdwForce::ReducedPositionsTask : public ThreadPool::Task {
+public:
+    ReducedPositionsTask(CpuAmoebaVdwForce& owner) : owner(owner) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        owner.threadComputeReducedPositions(threads, threadIndex);
+    }
+    CpuAmoebaVdwForce& owner;
+};
+
+class CpuAmoebaVdwForce::ComputeForceTask : public ThreadPool::Task {
+public:
+    ComputeForceTask(CpuAmoebaVdwForce& owner) : owner(owner) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        owner.threadComputeForce(threads, threadIndex);
+    }
+    CpuAmoebaVdwForce& owner;
+};
+
+CpuAmoebaVdwForce::CpuAmoebaVdwForce(const string& sigmaCombiningRule, const string& epsilonCombiningRule,
+            const vector<set<int> >& exclusions, ThreadPool& threads) : cutoff(false), periodic(false), triclinic(false), cutoffDistance(0.0), padding(0.0),
+            numParticles(exclusions.size()), threads(threads), neighborList(NULL), neighborListValid(false) {
+    string sigmaRule = sigmaCombiningRule;
+    transform(sigmaRule.begin(), sigmaRule.end(), sigmaRule.begin(), (int(*)(int)) toupper);
+    if (sigmaRule == "GEOMETRIC")
+        this->sigmaRule = GeometricSigma;
+    else if (sigmaRule == "CUBIC-MEAN")
+        this->sigmaRule = CubicMeanSigma;
+    else
+        this->sigmaRule = ArithmeticSigma;
+    string epsilonRule = epsilonCombiningRule;
+    transform(epsilonRule.begin(), epsilonRule.end(), epsilonRule.begin(), (int(*)(int)) toupper);
+    if (epsilonRule == "ARITHMETIC")
+        this->epsilonRule = ArithmeticEpsilon;
+    else if (epsilonRule == "HARMONIC")
+        this->epsilonRule = HarmonicEpsilon;
+    else if (epsilonRule == "HHG")
+        this->epsilonRule = HhgEpsilon;
+    else
+        this->epsilonRule = GeometricEpsilon;
+
+    // Make sure the exclusions are symmetric, since the neighbor list only checks them in one direction.
+
+    vector<pair<int, int> > excludedPairs;
+    for (int i = 0; i < numParticles; i++)
+        for (set<int>::const_iterator iter = exclusions[i].begin(); iter != exclusions[i].end(); ++iter)
+            excludedPairs.push_back(make_pair(i, *iter));
+    this->exclusions = CpuExclusions(numParticles, excludedPairs);
+    for (int i = 0; i < 3; i++) {
+        periodicBoxVectors[i] = RealVec(i == 0, i == 1, i == 2);
+        neighborListBoxVectors[i] = periodicBoxVectors[i];
+    }
+    int numThreads = threads.getNumThreads();
+    reducedPosq.resize(4*numParticles);
+    unwrappedPositions.resize(4*numParticles);
+    threadSiteForce.resize(numThreads);
+    for (int i = 0; i < numThreads; i++)
+        threadSiteForce[i].resize(4*numParticles);
+    threadNeighbors.resize(numThreads);
+    threadExclusions.resize(numThreads);
+    threadExclusionMask.resize(numThreads);
+    threadEnergy.resize(numThreads);
+    threadNeedsRebuild.resize(numThreads);
+}
+
+CpuAmoebaVdwForce::~CpuAmoebaVdwForce() {
+    if (neighborList != NULL)
+        delete neighborList;
+}
+
+void CpuAmoebaVdwForce::setUseCutoff(double distance, double padding) {
+    cutoff = true;
+    cutoffDistance = distance;
+    this->padding = padding;
+    taperCutoff = (float) (0.9*distance);
+    double delta = taperCutoff-distance;
+    taperC3 = (float) (10.0/(delta*delta*delta));
+    taperC4 = (float) (15.0/(delta*delta*delta*delta));
+    taperC5 = (float) (6.0/(delta*delta*delta*delta*delta));
+    if (neighborList == NULL)
+        neighborList = new CpuNeighborList(4);
+    neighborListValid = false;
+}
+
+void CpuAmoebaVdwForce::setPeriodic(RealVec* periodicBoxVectors) {
+    assert(cutoff);
+    periodic = true;
+    this->periodicBoxVectors[0] = periodicBoxVectors[0];
+    this->periodicBoxVectors[1] = periodicBoxVectors[1];
+    this->periodicBoxVectors[2] = periodicBoxVectors[2];
+    recipBoxSize[0] = (float) (1.0/periodicBoxVectors[0][0]);
+    recipBoxSize[1] = (float) (1.0/periodicBoxVectors[1][1]);
+    recipBoxSize[2] = (float) (1.0/periodicBoxVectors[2][2]);
+    triclinic = (periodicBoxVectors[0][1] != 0.0 || periodicBoxVectors[0][2] != 0.0 ||
+                 periodicBoxVectors[1][0] != 0.0 || periodicBoxVectors[1][2] != 0.0 ||
+                 periodicBoxVectors[2][0] != 0.0 || periodicBoxVectors[2][1] != 0.0);
+}
+
+void CpuAmoebaVdwForce::setParticleParameters(const vector<int>& indexIVs, const vector<float>& sigmas,
+            const vector<float>& epsilons, const vector<float>& reductions) {
+    this->indexIVs = indexIVs;
+    this->sigmas = sigmas;
+    this->epsilons = epsilons;
+    this->reductions = reductions;
+    neighborListValid = false;
+}
+
+double CpuAmoebaVdwForce::calculateForceAndEnergy(const vector<RealVec>& atomCoordinates, vector<AlignedArray<float> >& threadForce,
+            bool includeForce, bool includeEnergy) {
+    // Record the parameters for the threads.
+
+    this->atomCoordinates = &atomCoordinates[0];
+    this->threadForce = &threadForce;
+    this->includeForce = includeForce;
+    this->includeEnergy = includeEnergy;
+    int numThreads = threads.getNumThreads();
+
+    // Compute the positions of the interaction sites.
+
+    ReducedPositionsTask positionsTask(*this);
+    threads.execute(positionsTask);
+    threads.waitForThreads();
+
+    // Rebuild the neighbor list if any site has moved too far since it was last built.
+
+    if (cutoff) {
+        bool needRebuild = !neighborListValid;
+        for (int i = 0; i < numThreads; i++)
+            needRebuild |= (threadNeedsRebuild[i] != 0);
+        if (periodic)
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++)
+                    needRebuild |= (periodicBoxVectors[i][j] != neighborListBoxVectors[i][j]);
+        if (needRebuild) {
+            neighborList->computeNeighborList(numParticles, reducedPosq, exclusions, periodicBoxVectors, periodic, (float) (cutoffDistance+padding), threads);
+            neighborListPositions = unwrappedPositions;
+            for (int i = 0; i < 3; i++)
+                neighborListBoxVectors[i] = periodicBoxVectors[i];
+            neighborListValid = true;
+        }
+    }
+
+    // Compute the interactions.
+
+    gmx_atomic_t counter;
+    gmx_atomic_set(&counter, 0);
+    this->atomicCounter = &counter;
+    ComputeForceTask forceTask(*this);
+    threads.execute(forceTask);
+    threads.waitForThreads();
+
+    // Combine the energies from all the threads.
+
+    double energy = 0.0;
+    if (includeEnergy)
+        for (int i = 0; i < numThreads; i++)
+            energy += threadEnergy[i];
+    return energy;
+}
+
+void CpuAmoebaVdwForce::threadComputeReducedPositions(ThreadPool& threads, int threadIndex) {
+    int numThreads = threads.getNumThreads();
+    int start = threadIndex*numParticles/numThreads;
+    int end = (threadIndex+1)*numParticles/numThreads;
+    double maxMoveSquared = 0.25*padding*padding;
+    bool checkMoved = (cutoff && neighborListValid);
+    bool moved = false;
+    for (int i = start; i < end; i++) {
+        // Shift the site toward its parent atom.
+
+        RealVec pos = atomCoordinates[i];
+        if (reductions[i] != 0.0f) {
+            const RealVec& parentPos = atomCoordinates[indexIVs[i]];
+            pos = parentPos + (pos-parentPos)*reductions[i];
+        }
+        if (checkMoved && !moved) {
+            RealVec delta(pos[0]-neighborListPositions[4*i], pos[1]-neighborListPositions[4*i+1], pos[2]-neighborListPositions[4*i+2]);
+            moved = (delta.dot(delta) > maxMoveSquared);
+        }
+        unwrappedPositions[4*i] = (float) pos[0];
+        unwrappedPositions[4*i+1] = (float) pos[1];
+        unwrappedPositions[4*i+2] = (float) pos[2];
+        unwrappedPositions[4*i+3] = 0.0f;
+
+        // Wrap it into the periodic box.
+
+        if (periodic) {
+            if (triclinic) {
+                pos -= periodicBoxVectors[2]*floor(pos[2]/periodicBoxVectors[2][2]);
+                pos -= periodicBoxVectors[1]*floor(pos[1]/periodicBoxVectors[1][1]);
+                pos -= periodicBoxVectors[0]*floor(pos[0]/periodicBoxVectors[0][0]);
+            }
+            else
+                for (int j = 0; j < 3; j++)
+                    pos[j] -= floor(pos[j]/periodicBoxVectors[j][j])*periodicBoxVectors[j][j];
+        }
+        reducedPosq[4*i] = (float) pos[0];
+        reducedPosq[4*i+1] = (float) pos[1];
+        reducedPosq[4*i+2] = (float) pos[2];
+        reducedPosq[4*i+3] = 0.0f;
+    }
+    threadNeedsRebuild[threadIndex] = moved;
+
+    // Clear this thread's site forces.
+
+    AlignedArray<float>& siteForce = threadSiteForce[threadIndex];
+    if (includeForce)
+        for (int i = 0; i < 4*numParticles; i++)
+            siteForce[i] = 0.0f;
+}
+
+void CpuAmoebaVdwForce::threadComputeForce(ThreadPool& threads, int threadIndex) {
+    float* siteForces = &threadSiteForce[threadIndex][0];
+    threadEnergy[threadIndex] = 0;
+    double& energy = threadEnergy[threadIndex];
+    fvec4 boxSize((float) periodicBoxVectors[0][0], (float) periodicBoxVectors[1][1], (float) periodicBoxVectors[2][2], 0);
+    fvec4 invBoxSize(recipBoxSize[0], recipBoxSize[1], recipBoxSize[2], 0);
+    PeriodicType periodicType = (!periodic ? NoPeriodic : (triclinic ? PeriodicTriclinic : PeriodicPerInteraction));
+    if (cutoff) {
+        // We are using a cutoff, so get the interactions from the neighbor list.
+
+        const int numBlocks = neighborList->getNumBlocks();
+        while (true) {
+            int blockIndex = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
+            if (blockIndex >= numBlocks)
+                break;
+            const int* blockAtom = &neighborList->getSortedAtoms()[4*blockIndex];
+            const vector<int>& neighbors = neighborList->getBlockNeighbors(blockIndex);
+            const vector<char>& exclusions = neighborList->getBlockExclusions(blockIndex);
+            if (neighbors.size() == 0)
+                continue;
+            if (periodicType == NoPeriodic)
+                calculateBlockIxn<NoPeriodic>(blockAtom, &neighbors[0], &exclusions[0], neighbors.size(), siteForces, energy, boxSize, invBoxSize);
+            else if (periodicType == PeriodicPerInteraction)
+                calculateBlockIxn<PeriodicPerInteraction>(blockAtom, &neighbors[0], &exclusions[0], neighbors.size(), siteForces, energy, boxSize, invBoxSize);
+            else
+                calculateBlockIxn<PeriodicTriclinic>(blockAtom, &neighbors[0], &exclusions[0], neighbors.size(), siteForces, energy, boxSize, invBoxSize);
+        }
+    }
+    else {
+        // Every site interacts with every other one.  Divide the sites into blocks of four in index
+        // order, and let each block interact with every site whose index is lower than its own.
+
+        const int numBlocks = (numParticles+3)/4;
+        vector<int>& neighbors = threadNeighbors[threadIndex];
+        vector<char>& blockExclusions = threadExclusions[threadIndex];
+        vector<char>& exclusionMask = threadExclusionMask[threadIndex];
+        exclusionMask.resize(numParticles, 0);
+        while (true) {
+            int blockIndex = gmx_atomic_fetch_add(reinterpret_cast<gmx_atomic_t*>(atomicCounter), 1);
+            if (blockIndex >= numBlocks)
+                break;
+            int firstAtom = 4*blockIndex;
+            int blockAtom[4];
+            char paddingMask = 0;
+            for (int k = 0; k < 4; k++) {
+                int atom = firstAtom+k;
+                if (atom < numParticles) {
+                    blockAtom[k] = atom;
+                    const int* excluded = exclusions.getExclusions(atom);
+                    for (int m = exclusions.getNumExclusions(atom)-1; m >= 0; m--)
+                        exclusionMask[excluded[m]] |= 1<<k;
+                }
+                else {
+                    blockAtom[k] = 0;
+                    paddingMask |= 1<<k;
+                }
+            }
+            int numNeighbors = min(firstAtom+3, numParticles);
+            neighbors.resize(numNeighbors);
+            blockExclusions.resize(numNeighbors);
+            for (int j = 0; j < numNeighbors; j++) {
+                char excl = exclusionMask[j] | paddingMask;
+                if (j >= firstAtom)
+                    excl |= (1<<(j-firstAtom+1))-1;
+                neighbors[j] = j;
+                blockExclusions[j] = excl;
+            }
+            for (int k = 0; k < 4 && firstAtom+k < numParticles; k++) {
+                const int* excluded = exclusions.getExclusions(firstAtom+k);
+                for (int m = exclusions.getNumExclusions(firstAtom+k)-1; m >= 0; m--)
+                    exclusionMask[excluded[m]] = 0;
+            }
+            if (numNeighbors > 0)
+                calculateBlockIxn<NoPeriodic>(blockAtom, &neighbors[0], &blockExclusions[0], numNeighbors, siteForces, energy, boxSize, invBoxSize);
+        }
+    }
+
+    // Apply the forces on the interaction sites to the atoms they are derived from.
+
+    if (includeForce) {
+        float* forces = &(*threadForce)[threadIndex][0];
+        for (int i = 0; i < numParticles; i++) {
+            fvec4 f(siteForces+4*i);
+            if (indexIVs[i] == i)
+                (fvec4(forces+4*i)+f).store(forces+4*i);
+            else {
+                int parent = indexIVs[i];
+                float reduction = reductions[i];
+                (fvec4(forces+4*i)+f*reduction).store(forces+4*i);
+                (fvec4(forces+4*parent)+f*(1.0f-reduction)).store(forces+4*parent);
+            }
+        }
+    }
+}
+
+template <int PERIODIC_TYPE>
+void CpuAmoebaVdwForce::calculateBlockIxn(const int* blockAtom, const int* neighbors, const char* exclusions, int numNeighbors, float* forces, double& totalEnergy,
+            const fvec4& boxSize, const fvec4& invBoxSize) {
+    // Load the positions and parameters of the sites in the block.
+
+    fvec4 blockAtomPos[4];
+    for (int i = 0; i < 4; i++)
+        blockAtomPos[i] = fvec4(&reducedPosq[4*blockAtom[i]]);
+    fvec4 blockAtomX = fvec4(blockAtomPos[0][0], blockAtomPos[1][0], blockAtomPos[2][0], blockAtomPos[3][0]);
+    fvec4 blockAtomY = fvec4(blockAtomPos[0][1], blockAtomPos[1][1], blockAtomPos[2][1], blockAtomPos[3][1]);
+    fvec4 blockAtomZ = fvec4(blockAtomPos[0][2], blockAtomPos[1][2], blockAtomPos[2][2], blockAtomPos[3][2]);
+    fvec4 blockAtomSigma(sigmas[blockAtom[0]], sigmas[blockAtom[1]], sigmas[blockAtom[2]], sigmas[blockAtom[3]]);
+    fvec4 blockAtomEpsilon(epsilons[blockAtom[0]], epsilons[blockAtom[1]], epsilons[blockAtom[2]], epsilons[blockAtom[3]]);
+    fvec4 blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
+    const float cutoffSquared = (float) (cutoffDistance*cutoffDistance);
+    const fvec4 one(1.0f);
+
+    // Loop over neighbors for this block.
+
+    for (int i = 0; i < numNeighbors; i++) {
+        // Compute the distances to the block sites.
+
+        int atom = neighbors[i];
+        fvec4 dx, dy, dz, r2;
+        fvec4 atomPos(&reducedPosq[4*atom]);
+        getDeltaR<PERIODIC_TYPE>(atomPos, blockAtomX, blockAtomY, blockAtomZ, dx, dy, dz, r2, boxSize, invBoxSize);
+        ivec4 include;
+        char excl = exclusions[i];
+        if (excl == 0)
+            include = -1;
+        else
+            include = ivec4(excl&1 ? 0 : -1, excl&2 ? 0 : -1, excl&4 ? 0 : -1, excl&8 ? 0 : -1);
+        if (cutoff)
+            include = include & (r2 < cutoffSquared);
+        if (!any(include))
+            continue; // No interactions to compute.
+
+        // Compute the buffered 14-7 interaction.
+
+        fvec4 r = sqrt(r2);
+        fvec4 sigma = combineSigmas(blockAtomSigma, sigmas[atom]);
+        fvec4 epsilon = combineEpsilons(blockAtomEpsilon, epsilons[atom]);
+        fvec4 sigma2 = sigma*sigma;
+        fvec4 sigma7 = sigma2*sigma2*sigma2*sigma;
+        fvec4 r6 = r2*r2*r2;
+        fvec4 rho = r6*r + GHAL*sigma7;
+        fvec4 tau = (DHAL+1.0f)/(r + DHAL*sigma);
+        fvec4 tau2 = tau*tau;
+        fvec4 tau7 = tau2*tau2*tau2*tau;
+        fvec4 dtau = tau/(DHAL+1.0f);
+        fvec4 ratio = sigma7/rho;
+        fvec4 gtau = epsilon*tau7*r6*(GHAL+1.0f)*ratio*ratio;
+        fvec4 energy = epsilon*tau7*sigma7*((GHAL+1.0f)*ratio - 2.0f);
+        fvec4 dEdR = -7.0f*(dtau*energy + gtau);
+        if (cutoff) {
+            // Apply the taper.
+
+            fvec4 delta = max(0.0f, r-taperCutoff);
+            fvec4 delta2 = delta*delta;
+            fvec4 taper = 1.0f + delta2*delta*(taperC3 + delta*(taperC4 + delta*taperC5));
+            fvec4 dtaper = delta2*(3.0f*taperC3 + delta*(4.0f*taperC4 + delta*5.0f*taperC5));
+            dEdR = energy*dtaper + dEdR*taper;
+            energy *= taper;
+        }
+
+        // Accumulate energies.
+
+        if (includeEnergy) {
+            energy = blend(0.0f, energy, include);
+            totalEnergy += dot4(energy, one);
+        }
+
+        // Accumulate forces.
+
+        if (includeForce) {
+            dEdR = blend(0.0f, dEdR/r, include);
+            fvec4 fx = dx*dEdR;
+            fvec4 fy = dy*dEdR;
+            fvec4 fz = dz*dEdR;
+            blockAtomForceX -= fx;
+            blockAtomForceY -= fy;
+            blockAtomForceZ -= fz;
+            float* atomForce = forces+4*atom;
+            atomForce[0] += dot4(fx, one);
+            atomForce[1] += dot4(fy, one);
+            atomForce[2] += dot4(fz, one);
+        }
+    }
+
+    // Record the forces on the block sites.
+
+    if (includeForce) {
+        fvec4 f[4] = {blockAtomForceX, blockAtomForceY, blockAtomForceZ, 0.0f};
+        transpose(f[0], f[1], f[2], f[3]);
+        for (int j = 0; j < 4; j++)
+            (fvec4(forces+4*blockAtom[j])+f[j]).store(forces+4*blockAtom[j]);
+    }
+}
+
+template <int PERIODIC_TYPE>
+void CpuAmoebaVdwForce::getDeltaR(const fvec4& posI, const fvec4& x, const fvec4& y, const fvec4& z, fvec4& dx, fvec4& dy, fvec4& dz, fvec4& r2,
+            const fvec4& boxSize, const fvec4& invBoxSize) const {
+    dx = x-posI[0];
+    dy = y-posI[1];
+    dz = z-posI[2];
+    if (PERIODIC_TYPE == PeriodicTriclinic) {
+        fvec4 scale3 = floor(dz*recipBoxSize[2]+0.5f);
+        dx -= scale3*(float) periodicBoxVectors[2][0];
+        dy -= scale3*(float) periodicBoxVectors[2][1];
+        dz -= scale3*(float) periodicBoxVectors[2][2];
+        fvec4 scale2 = floor(dy*recipBoxSize[1]+0.5f);
+        dx -= scale2*(float) periodicBoxVectors[1][0];
+        dy -= scale2*(float) periodicBoxVectors[1][1];
+        fvec4 scale1 = floor(dx*recipBoxSize[0]+0.5f);
+        dx -= scale1*(float) periodicBoxVectors[0][0];
+    }
+    else if (PERIODIC_TYPE == PeriodicPerInteraction) {
+        dx -= round(dx*invBoxSize[0])*boxSize[0];
+        dy -= round(dy*invBoxSize[1])*boxSize[1];
+        dz -= round(dz*invBoxSize[2])*boxSize[2];
+    }
+    r2 = dx*dx + dy*dy + dz*dz;
+}
+
+fvec4 CpuAmoebaVdwForce::combineSigmas(const fvec4& sigmaI, float sigmaJ) const {
+    if (sigmaRule == ArithmeticSigma)
+        return sigmaI+sigmaJ;
+    if (sigmaRule == GeometricSigma)
+        return 2.0f*sqrt(sigmaI*sigmaJ);
+    if (sigmaJ == 0.0f)
+        return 0.0f;
+    fvec4 sigmaI2 = sigmaI*sigmaI;
+    float sigmaJ2 = sigmaJ*sigmaJ;
+    return blend(0.0f, 2.0f*(sigmaI2*sigmaI + sigmaJ2*sigmaJ)/(sigmaI2 + sigmaJ2), sigmaI != 0.0f);
+}
+
+fvec4 CpuAmoebaVdwForce::combineEpsilons(const fvec4& epsilonI, float epsilonJ) const {
+    if (epsilonRule == GeometricEpsilon)
+        return sqrt(epsilonI*epsilonJ);
+    if (epsilonRule == ArithmeticEpsilon)
+        return 0.5f*(epsilonI+epsilonJ);
+    if (epsilonJ == 0.0f)
+        return 0.0f;
+    if (epsilonRule == HarmonicEpsilon)
+        return blend(0.0f, 2.0f*(epsilonI*epsilonJ)/(epsilonI+epsilonJ), epsilonI != 0.0f);
+    fvec4 denominator = sqrt(epsilonI)+sqrtf(epsilonJ);
+    return blend(0.0f, 4.0f*(epsilonI*epsilonJ)/(denominator*denominator), epsilonI != 0.0f);
+}
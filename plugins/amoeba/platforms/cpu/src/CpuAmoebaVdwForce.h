@@ -0,0 +1,182 @@
+#ifndef OPENMM_CPU_AMOEBA_VDW_FORCE_H__
+#define OPENMM_CPU_AMOEBA_VDW_FORCE_H__
+
+/* -------------------------------------------------------------------------- *
+ *                              OpenMMAmoeba                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU Lesser General Public License as published   *
+ * by the Free Software Foundation, either version 3 of the License, or       *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              *
+ * GNU Lesser General Public License for more details.                        *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.      *
+ * -------------------------------------------------------------------------- */
+
+#include "AlignedArray.h"
+#include "CpuExclusions.h"
+#include "CpuNeighborList.h"
+#include "RealVec.h"
+#include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/vectorize.h"
+#include <set>
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class computes the AMOEBA buffered 14-7 vdW interaction on the CPU.  Interactions are
+ * evaluated between reduced (hydrogen-shifted) interaction sites, four at a time, using a
+ * Verlet list that is built on the reduced sites with a padding distance and is only rebuilt
+ * once some site has moved more than half the padding.  Each thread accumulates the forces on
+ * the interaction sites in its own buffer and then redistributes them to the parent atoms.
+ */
+class CpuAmoebaVdwForce {
+public:
+    class ReducedPositionsTask;
+    class ComputeForceTask;
+
+    /**
+     * Create a CpuAmoebaVdwForce.
+     *
+     * @param sigmaCombiningRule    the sigma combining rule (ARITHMETIC, GEOMETRIC, or CUBIC-MEAN)
+     * @param epsilonCombiningRule  the epsilon combining rule (GEOMETRIC, ARITHMETIC, HARMONIC, or HHG)
+     * @param exclusions            the indices of the particles each particle should not interact with
+     * @param threads               the thread pool to use
+     */
+    CpuAmoebaVdwForce(const std::string& sigmaCombiningRule, const std::string& epsilonCombiningRule,
+                      const std::vector<std::set<int> >& exclusions, ThreadPool& threads);
+
+    ~CpuAmoebaVdwForce();
+
+    /**
+     * Set the force to use a cutoff.
+     *
+     * @param distance    the cutoff distance
+     * @param padding     the extra distance included in the neighbor list, so that it only needs
+     *                    to be rebuilt after some site has moved more than half this distance
+     */
+    void setUseCutoff(double distance, double padding);
+
+    /**
+     * Set the force to use periodic boundary conditions.  This requires that a cutoff has
+     * already been set, and the smallest side of the periodic box is at least twice the cutoff
+     * distance.
+     *
+     * @param periodicBoxVectors    the vectors defining the periodic box
+     */
+    void setPeriodic(RealVec* periodicBoxVectors);
+
+    /**
+     * Set the per-particle parameters.
+     *
+     * @param indexIVs     the index of the parent atom each particle's interaction site is shifted toward
+     * @param sigmas       the sigma of each particle
+     * @param epsilons     the epsilon of each particle
+     * @param reductions   the reduction factor of each particle
+     */
+    void setParticleParameters(const std::vector<int>& indexIVs, const std::vector<float>& sigmas,
+                               const std::vector<float>& epsilons, const std::vector<float>& reductions);
+
+    /**
+     * Calculate the vdW interaction.
+     *
+     * @param atomCoordinates  atom coordinates
+     * @param threadForce      per-thread force arrays (forces added)
+     * @param includeForce     whether to compute forces
+     * @param includeEnergy    whether to compute the energy
+     * @return the energy of the interaction
+     */
+    double calculateForceAndEnergy(const std::vector<RealVec>& atomCoordinates, std::vector<AlignedArray<float> >& threadForce,
+                                   bool includeForce, bool includeEnergy);
+
+    /**
+     * This routine contains the code executed by each thread to compute the reduced site positions.
+     */
+    void threadComputeReducedPositions(ThreadPool& threads, int threadIndex);
+
+    /**
+     * This routine contains the code executed by each thread to compute the interactions.
+     */
+    void threadComputeForce(ThreadPool& threads, int threadIndex);
+
+private:
+    enum SigmaRule {ArithmeticSigma, GeometricSigma, CubicMeanSigma};
+    enum EpsilonRule {GeometricEpsilon, ArithmeticEpsilon, HarmonicEpsilon, HhgEpsilon};
+    enum PeriodicType {NoPeriodic, PeriodicPerInteraction, PeriodicTriclinic};
+    SigmaRule sigmaRule;
+    EpsilonRule epsilonRule;
+    bool cutoff;
+    bool periodic;
+    bool triclinic;
+    double cutoffDistance, padding;
+    float taperCutoff, taperC3, taperC4, taperC5;
+    RealVec periodicBoxVectors[3];
+    float recipBoxSize[3];
+    int numParticles;
+    CpuExclusions exclusions;
+    std::vector<int> indexIVs;
+    std::vector<float> sigmas, epsilons, reductions;
+    ThreadPool& threads;
+    CpuNeighborList* neighborList;
+    bool neighborListValid;
+    RealVec neighborListBoxVectors[3];
+    AlignedArray<float> reducedPosq;
+    std::vector<float> unwrappedPositions;
+    std::vector<float> neighborListPositions;
+    std::vector<AlignedArray<float> > threadSiteForce;
+    std::vector<std::vector<int> > threadNeighbors;
+    std::vector<std::vector<char> > threadExclusions;
+    std::vector<std::vector<char> > threadExclusionMask;
+    std::vector<double> threadEnergy;
+    std::vector<char> threadNeedsRebuild;
+    // The following variables are used to make information accessible to the individual threads.
+    RealVec const* atomCoordinates;
+    std::vector<AlignedArray<float> >* threadForce;
+    bool includeForce, includeEnergy;
+    void* atomicCounter;
+
+    /**
+     * Compute the interactions between the sites in one block of four and a list of neighbors.
+     */
+    template <int PERIODIC_TYPE>
+    void calculateBlockIxn(const int* blockAtom, const int* neighbors, const char* exclusions, int numNeighbors, float* forces, double& energy,
+                           const fvec4& boxSize, const fvec4& invBoxSize);
+
+    /**
+     * Compute the displacement and squared distance between a collection of points, optionally using
+     * periodic boundary conditions.
+     */
+    template <int PERIODIC_TYPE>
+    void getDeltaR(const fvec4& posI, const fvec4& x, const fvec4& y, const fvec4& z, fvec4& dx, fvec4& dy, fvec4& dz, fvec4& r2,
+                   const fvec4& boxSize, const fvec4& invBoxSize) const;
+
+    /**
+     * Apply the sigma combining rule to a block of sites and a single neighbor.
+     */
+    fvec4 combineSigmas(const fvec4& sigmaI, float sigmaJ) const;
+
+    /**
+     * Apply the epsilon combining rule to a block of sites and a single neighbor.
+     */
+    fvec4 combineEpsilons(const fvec4& epsilonI, float epsilonJ) const;
+};
+
+} // namespace OpenMM
+
+#endif // OPENMM_CPU_AMOEBA_VDW_FORCE_H__
@@ -0,0 +1,201 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMMAmoeba                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests the CPU implementation of AmoebaGeneralizedKirkwoodForce by comparing it to the Reference implementation.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "OpenMMAmoeba.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "sfmt/SFMT.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+extern "C" OPENMM_EXPORT void registerAmoebaReferenceKernelFactories();
+extern "C" OPENMM_EXPORT void registerAmoebaCpuKernelFactories();
+
+const double TOL = 1e-5;
+
+/**
+ * Build a random cluster of polarizable ions.
+ */
+void buildSystem(System& system, AmoebaGeneralizedKirkwoodForce* gk, vector<Vec3>& positions, int numParticles) {
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    AmoebaMultipoleForce* multipole = new AmoebaMultipoleForce();
+    multipole->setNonbondedMethod(AmoebaMultipoleForce::NoCutoff);
+    multipole->setPolarizationType(AmoebaMultipoleForce::Direct);
+    vector<double> dipole(3, 0.0), quadrupole(9, 0.0);
+    double boxSize = 0.35*pow((double) numParticles, 1.0/3.0);
+    positions.clear();
+    for (int i = 0; i < numParticles; i++) {
+        double charge = (i%2 == 0 ? 0.5 : -0.5);
+        double radius = 0.12+0.06*genrand_real2(sfmt);
+        double polarity = 0.0005+0.001*genrand_real2(sfmt);
+        system.addParticle(20.0);
+        multipole->addMultipole(charge, dipole, quadrupole, AmoebaMultipoleForce::NoAxisType, -1, -1, -1, 0.39, pow(polarity, 1.0/6.0), polarity);
+        gk->addParticle(charge, radius, 0.69);
+        while (true) {
+            Vec3 pos(boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt));
+            bool tooClose = false;
+            for (int j = 0; j < i && !tooClose; j++) {
+                Vec3 delta = pos-positions[j];
+                tooClose = (delta.dot(delta) < 0.25*0.25);
+            }
+            if (!tooClose) {
+                positions.push_back(pos);
+                break;
+            }
+        }
+    }
+    system.addForce(multipole);
+    system.addForce(gk);
+}
+
+/**
+ * Compute the forces and energy with both the CPU and Reference platforms.
+ */
+void computeStates(const System& system, const vector<Vec3>& positions, State& cpuState, State& referenceState) {
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    Context cpuContext(system, integrator1, Platform::getPlatformByName("CPU"));
+    Context referenceContext(system, integrator2, Platform::getPlatformByName("Reference"));
+    cpuContext.setPositions(positions);
+    referenceContext.setPositions(positions);
+    cpuState = cpuContext.getState(State::Forces | State::Energy);
+    referenceState = referenceContext.getState(State::Forces | State::Energy);
+}
+
+void compareStates(const State& expected, const State& found, double tol) {
+    ASSERT_EQUAL_TOL(expected.getPotentialEnergy(), found.getPotentialEnergy(), tol);
+    for (int i = 0; i < (int) expected.getForces().size(); i++)
+        ASSERT_EQUAL_VEC(expected.getForces()[i], found.getForces()[i], tol);
+}
+
+void testNoCutoff(bool includeCavityTerm) {
+    System system;
+    AmoebaGeneralizedKirkwoodForce* gk = new AmoebaGeneralizedKirkwoodForce();
+    gk->setIncludeCavityTerm(includeCavityTerm);
+    vector<Vec3> positions;
+    buildSystem(system, gk, positions, 150);
+    State cpuState, referenceState;
+    computeStates(system, positions, cpuState, referenceState);
+    compareStates(referenceState, cpuState, TOL);
+}
+
+void testCutoff() {
+    // With the same cutoff, both platforms should agree.
+
+    System system;
+    AmoebaGeneralizedKirkwoodForce* gk = new AmoebaGeneralizedKirkwoodForce();
+    gk->setBornRadiusCutoff(0.8);
+    vector<Vec3> positions;
+    buildSystem(system, gk, positions, 150);
+    State cpuState, referenceState;
+    computeStates(system, positions, cpuState, referenceState);
+    compareStates(referenceState, cpuState, TOL);
+
+    // The cutoff should introduce only a small error relative to integrating over all pairs.
+
+    gk->setBornRadiusCutoff(0.0);
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, Platform::getPlatformByName("Reference"));
+    context.setPositions(positions);
+    State exactState = context.getState(State::Forces | State::Energy);
+    compareStates(exactState, cpuState, 2e-3);
+}
+
+void testUpdateInterval() {
+    System system;
+    AmoebaGeneralizedKirkwoodForce* gk = new AmoebaGeneralizedKirkwoodForce();
+    gk->setBornRadiiUpdateInterval(2);
+    vector<Vec3> positions;
+    buildSystem(system, gk, positions, 50);
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    Context cpuContext(system, integrator1, Platform::getPlatformByName("CPU"));
+    Context referenceContext(system, integrator2, Platform::getPlatformByName("Reference"));
+    cpuContext.setPositions(positions);
+    cpuContext.getState(State::Energy);
+
+    // Queries that do not evaluate the forces should not count toward the interval.
+
+    AmoebaMultipoleForce& multipole = dynamic_cast<AmoebaMultipoleForce&>(system.getForce(0));
+    vector<Vec3> dipoles;
+    multipole.getInducedDipoles(cpuContext, dipoles);
+    multipole.getInducedDipoles(cpuContext, dipoles);
+
+    // Move the atoms.  The first evaluation should still use the old Born radii, and the second one
+    // should recompute them.
+
+    for (int i = 0; i < (int) positions.size(); i++)
+        positions[i] *= 1.05;
+    cpuContext.setPositions(positions);
+    referenceContext.setPositions(positions);
+    State staleState = cpuContext.getState(State::Energy);
+    State cpuState = cpuContext.getState(State::Forces | State::Energy);
+    State referenceState = referenceContext.getState(State::Forces | State::Energy);
+    ASSERT(fabs(staleState.getPotentialEnergy()-cpuState.getPotentialEnergy()) > 1e-3*fabs(cpuState.getPotentialEnergy()));
+    compareStates(referenceState, cpuState, TOL);
+}
+
+int main(int numberOfArguments, char* argv[]) {
+    try {
+        std::cout << "TestCpuAmoebaGeneralizedKirkwoodForce running test..." << std::endl;
+        registerAmoebaCpuKernelFactories();
+        registerAmoebaReferenceKernelFactories();
+        try {
+            Platform::getPlatformByName("CPU");
+        }
+        catch (...) {
+            std::cout << "CPU is not supported.  Exiting." << std::endl;
+            return 0;
+        }
+        testNoCutoff(false);
+        testNoCutoff(true);
+        testCutoff();
+        testUpdateInterval();
+    }
+    catch(const std::exception& e) {
+        std::cout << "exception: " << e.what() << std::endl;
+        std::cout << "FAIL - ERROR.  Test failed." << std::endl;
+        return 1;
+    }
+    std::cout << "Done" << std::endl;
+    return 0;
+}
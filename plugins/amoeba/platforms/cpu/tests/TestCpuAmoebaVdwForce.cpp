@@ -0,0 +1,232 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMMAmoeba                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests the CPU implementation of AmoebaVdwForce by comparing it to the Reference implementation.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "OpenMMAmoeba.h"
+#include "openmm/System.h"
+#include "openmm/AmoebaVdwForce.h"
+#include "openmm/LangevinIntegrator.h"
+#include "openmm/VerletIntegrator.h"
+#include "sfmt/SFMT.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+extern "C" OPENMM_EXPORT void registerAmoebaReferenceKernelFactories();
+extern "C" OPENMM_EXPORT void registerAmoebaCpuKernelFactories();
+
+const double TOL = 1e-4;
+
+/**
+ * Build a box of three site molecules resembling water.  The two hydrogens of each molecule
+ * interact through sites that are shifted toward the oxygen.
+ */
+void buildWaterBox(System& system, AmoebaVdwForce* vdw, vector<Vec3>& positions, int gridSize, double spacing) {
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    positions.clear();
+    for (int i = 0; i < gridSize; i++)
+        for (int j = 0; j < gridSize; j++)
+            for (int k = 0; k < gridSize; k++) {
+                int oxygen = system.getNumParticles();
+                system.addParticle(16.0);
+                system.addParticle(1.0);
+                system.addParticle(1.0);
+                vdw->addParticle(oxygen, 0.1702, 0.46, 0.0);
+                vdw->addParticle(oxygen, 0.1327, 0.0565, 0.91);
+                vdw->addParticle(oxygen, 0.1327, 0.0565, 0.91);
+                Vec3 pos = Vec3(i+0.2*genrand_real2(sfmt), j+0.2*genrand_real2(sfmt), k+0.2*genrand_real2(sfmt))*spacing;
+                positions.push_back(pos);
+                for (int h = 0; h < 2; h++) {
+                    Vec3 dir(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5);
+                    positions.push_back(pos+dir*(0.1/sqrt(dir.dot(dir))));
+                }
+                vector<int> exclusions;
+                for (int m = 0; m < 3; m++)
+                    exclusions.push_back(oxygen+m);
+                for (int m = 0; m < 3; m++)
+                    vdw->setParticleExclusions(oxygen+m, exclusions);
+            }
+    system.addForce(vdw);
+}
+
+/**
+ * Compute the forces and energy with both the CPU and Reference platforms and make sure they agree.
+ */
+void compareToReference(const System& system, const vector<Vec3>& positions) {
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    Context cpuContext(system, integrator1, Platform::getPlatformByName("CPU"));
+    Context referenceContext(system, integrator2, Platform::getPlatformByName("Reference"));
+    cpuContext.setPositions(positions);
+    referenceContext.setPositions(positions);
+    State cpuState = cpuContext.getState(State::Forces | State::Energy);
+    State referenceState = referenceContext.getState(State::Forces | State::Energy);
+    ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), cpuState.getPotentialEnergy(), TOL);
+    for (int i = 0; i < system.getNumParticles(); i++)
+        ASSERT_EQUAL_VEC(referenceState.getForces()[i], cpuState.getForces()[i], TOL);
+}
+
+void testCombiningRules() {
+    const char* sigmaRules[] = {"ARITHMETIC", "GEOMETRIC", "CUBIC-MEAN"};
+    const char* epsilonRules[] = {"GEOMETRIC", "ARITHMETIC", "HARMONIC", "HHG"};
+    for (int sigmaRule = 0; sigmaRule < 3; sigmaRule++)
+        for (int epsilonRule = 0; epsilonRule < 4; epsilonRule++) {
+            System system;
+            AmoebaVdwForce* vdw = new AmoebaVdwForce();
+            vdw->setSigmaCombiningRule(sigmaRules[sigmaRule]);
+            vdw->setEpsilonCombiningRule(epsilonRules[epsilonRule]);
+            vector<Vec3> positions;
+            buildWaterBox(system, vdw, positions, 2, 0.3);
+            compareToReference(system, positions);
+        }
+}
+
+void testCutoff(bool useDispersionCorrection) {
+    System system;
+    AmoebaVdwForce* vdw = new AmoebaVdwForce();
+    vdw->setNonbondedMethod(AmoebaVdwForce::CutoffPeriodic);
+    vdw->setCutoff(0.7);
+    vdw->setUseDispersionCorrection(useDispersionCorrection);
+    vector<Vec3> positions;
+    const int gridSize = 6;
+    const double spacing = 0.4;
+    buildWaterBox(system, vdw, positions, gridSize, spacing);
+    double boxSize = gridSize*spacing;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    compareToReference(system, positions);
+}
+
+void testTriclinic() {
+    System system;
+    AmoebaVdwForce* vdw = new AmoebaVdwForce();
+    vdw->setNonbondedMethod(AmoebaVdwForce::CutoffPeriodic);
+    vdw->setCutoff(0.7);
+    vector<Vec3> positions;
+    const int gridSize = 6;
+    const double spacing = 0.4;
+    buildWaterBox(system, vdw, positions, gridSize, spacing);
+    double boxSize = gridSize*spacing;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0.3, boxSize, 0), Vec3(-0.2, 0.4, boxSize));
+    compareToReference(system, positions);
+}
+
+void testNeighborListUpdate() {
+    // Run a short simulation on the CPU platform, and make sure the forces stay correct as the
+    // neighbor list gets rebuilt.
+
+    System system;
+    AmoebaVdwForce* vdw = new AmoebaVdwForce();
+    vdw->setNonbondedMethod(AmoebaVdwForce::CutoffPeriodic);
+    vdw->setCutoff(0.7);
+    vector<Vec3> positions;
+    const int gridSize = 6;
+    const double spacing = 0.4;
+    buildWaterBox(system, vdw, positions, gridSize, spacing);
+    double boxSize = gridSize*spacing;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    LangevinIntegrator integrator(1000.0, 1.0, 0.002);
+    Context context(system, integrator, Platform::getPlatformByName("CPU"));
+    context.setPositions(positions);
+    for (int i = 0; i < 10; i++) {
+        integrator.step(10);
+        State state = context.getState(State::Positions);
+        compareToReference(system, state.getPositions());
+    }
+}
+
+void testChangingParameters() {
+    System system;
+    AmoebaVdwForce* vdw = new AmoebaVdwForce();
+    vdw->setNonbondedMethod(AmoebaVdwForce::CutoffPeriodic);
+    vdw->setCutoff(0.7);
+    vector<Vec3> positions;
+    const int gridSize = 4;
+    const double spacing = 0.4;
+    buildWaterBox(system, vdw, positions, gridSize, spacing);
+    double boxSize = gridSize*spacing;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    Context cpuContext(system, integrator1, Platform::getPlatformByName("CPU"));
+    Context referenceContext(system, integrator2, Platform::getPlatformByName("Reference"));
+    cpuContext.setPositions(positions);
+    referenceContext.setPositions(positions);
+    cpuContext.getState(State::Energy);
+    for (int i = 0; i < vdw->getNumParticles(); i++) {
+        int parent;
+        double sigma, epsilon, reduction;
+        vdw->getParticleParameters(i, parent, sigma, epsilon, reduction);
+        vdw->setParticleParameters(i, parent, 1.1*sigma, 0.9*epsilon, (reduction == 0.0 ? 0.0 : 0.85));
+    }
+    vdw->updateParametersInContext(cpuContext);
+    vdw->updateParametersInContext(referenceContext);
+    State cpuState = cpuContext.getState(State::Forces | State::Energy);
+    State referenceState = referenceContext.getState(State::Forces | State::Energy);
+    ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), cpuState.getPotentialEnergy(), TOL);
+    for (int i = 0; i < system.getNumParticles(); i++)
+        ASSERT_EQUAL_VEC(referenceState.getForces()[i], cpuState.getForces()[i], TOL);
+}
+
+int main(int numberOfArguments, char* argv[]) {
+    try {
+        std::cout << "TestCpuAmoebaVdwForce running test..." << std::endl;
+        registerAmoebaReferenceKernelFactories();
+        registerAmoebaCpuKernelFactories();
+        try {
+            Platform::getPlatformByName("CPU");
+        }
+        catch (...) {
+            std::cout << "CPU is not supported.  Exiting." << std::endl;
+            return 0;
+        }
+        testCombiningRules();
+        testCutoff(false);
+        testCutoff(true);
+        testTriclinic();
+        testNeighborListUpdate();
+        testChangingParameters();
+    }
+    catch(const std::exception& e) {
+        std::cout << "exception: " << e.what() << std::endl;
+        std::cout << "FAIL - ERROR.  Test failed." << std::endl;
+        return 1;
+    }
+    std::cout << "Done" << std::endl;
+    return 0;
+}
@@ -31,32 +31,44 @@
 #include "openmm/OpenMMException.h"
 
 using namespace OpenMM;
-
-extern "C" OPENMM_EXPORT void registerPlatforms() {
-}
-
-extern "C" OPENMM_EXPORT void registerKernelFactories() {
+using namespace std;
+
+static void registerReferenceKernelFactories() {
+    vector<string> kernelNames;
+    kernelNames.push_back(CalcAmoebaBondForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaAngleForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaInPlaneAngleForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaPiTorsionForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaStretchBendForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaOutOfPlaneBendForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaTorsionTorsionForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaVdwForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaMultipoleForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaGeneralizedKirkwoodForceKernel::Name());
+    kernelNames.push_back(CalcAmoebaWcaDispersionForceKernel::Name());
     for (int i = 0; i < Platform::getNumPlatforms(); i++) {
         Platform& platform = Platform::getPlatform(i);
         if (dynamic_cast<ReferencePlatform*>(&platform) != NULL) {
+             // Subclasses of ReferencePlatform (such as the CPU platform) may provide optimized versions
+             // of some kernels, so only fill in the ones that have not already been registered.
+
              AmoebaReferenceKernelFactory* factory = new AmoebaReferenceKernelFactory();
-             platform.registerKernelFactory(CalcAmoebaBondForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaAngleForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaInPlaneAngleForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaPiTorsionForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaStretchBendForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaOutOfPlaneBendForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaTorsionTorsionForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaVdwForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaMultipoleForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaGeneralizedKirkwoodForceKernel::Name(), factory);
-             platform.registerKernelFactory(CalcAmoebaWcaDispersionForceKernel::Name(), factory);
+             for (int j = 0; j < (int) kernelNames.size(); j++)
+                 if (!platform.supportsKernels(vector<string>(1, kernelNames[j])))
+                     platform.registerKernelFactory(kernelNames[j], factory);
         }
     }
 }
 
+extern "C" OPENMM_EXPORT void registerPlatforms() {
+}
+
+extern "C" OPENMM_EXPORT void registerKernelFactories() {
+    registerReferenceKernelFactories();
+}
+
 extern "C" OPENMM_EXPORT void registerAmoebaReferenceKernelFactories() {
-    registerKernelFactories();
+    registerReferenceKernelFactories();
 }
 
 KernelImpl* AmoebaReferenceKernelFactory::createKernelImpl(std::string name, const Platform& platform, ContextImpl& context) const {
@@ -510,6 +510,7 @@ double ReferenceCalcAmoebaTorsionTorsionForceKernel::execute(ContextImpl& contex
 
 ReferenceCalcAmoebaMultipoleForceKernel::ReferenceCalcAmoebaMultipoleForceKernel(std::string name, const Platform& platform, const System& system) : 
          CalcAmoebaMultipoleForceKernel(name, platform), system(system), numMultipoles(0), mutualInducedMaxIterations(60), mutualInducedTargetEpsilon(1.0e-03),
+                                                         mutualInducedSolver(AmoebaMultipoleForce::DIIS), mutualInducedPredictorOrder(0), latestInducedDipolesTime(0.0),
                                                          usePme(false),alphaEwald(0.0), cutoffDistance(1.0) {  
 
 }
@@ -585,6 +586,8 @@ void ReferenceCalcAmoebaMultipoleForceKernel::initialize(const System& system, c
     if (polarizationType == AmoebaMultipoleForce::Mutual) {
         mutualInducedMaxIterations = force.getMutualInducedMaxIterations();
         mutualInducedTargetEpsilon = force.getMutualInducedTargetEpsilon();
+        mutualInducedSolver = force.getMutualInducedSolver();
+        mutualInducedPredictorOrder = force.getMutualInducedPredictorOrder();
     } else if (polarizationType == AmoebaMultipoleForce::Extrapolated) {
         extrapolationCoefficients = force.getExtrapolationCoefficients();
     }
@@ -656,12 +659,13 @@ AmoebaReferenceMultipoleForce* ReferenceCalcAmoebaMultipoleForceKernel::setupAmo
         gkKernel->getCharges(parameters);
         amoebaReferenceGeneralizedKirkwoodForce->setCharges(parameters);
 
-        // calculate Grycuk Born radii
+        // get Grycuk Born radii
 
-        vector<RealVec>& posData   = extractPositions(context);
-        amoebaReferenceGeneralizedKirkwoodForce->calculateGrycukBornRadii(posData);
+        vector<RealOpenMM> bornRadii;
+        gkKernel->getBornRadii(context, bornRadii);
+        amoebaReferenceGeneralizedKirkwoodForce->setGrycukBornRadii(bornRadii);
 
-        amoebaReferenceMultipoleForce = new AmoebaReferenceGeneralizedKirkwoodMultipoleForce(amoebaReferenceGeneralizedKirkwoodForce);
+        amoebaReferenceMultipoleForce = gkKernel->createMultipoleForce(amoebaReferenceGeneralizedKirkwoodForce);
 
     } else if (usePme) {
 
@@ -687,6 +691,10 @@ AmoebaReferenceMultipoleForce* ReferenceCalcAmoebaMultipoleForceKernel::setupAmo
         amoebaReferenceMultipoleForce->setPolarizationType(AmoebaReferenceMultipoleForce::Mutual);
         amoebaReferenceMultipoleForce->setMutualInducedDipoleTargetEpsilon(mutualInducedTargetEpsilon);
         amoebaReferenceMultipoleForce->setMaximumMutualInducedDipoleIterations(mutualInducedMaxIterations);
+        if (mutualInducedSolver == AmoebaMultipoleForce::ConjugateGradient)
+            amoebaReferenceMultipoleForce->setMutualInducedSolver(AmoebaReferenceMultipoleForce::ConjugateGradient);
+        else
+            amoebaReferenceMultipoleForce->setMutualInducedSolver(AmoebaReferenceMultipoleForce::DIIS);
     } else if (polarizationType == AmoebaMultipoleForce::Direct) {
         amoebaReferenceMultipoleForce->setPolarizationType(AmoebaReferenceMultipoleForce::Direct);
     } else if (polarizationType == AmoebaMultipoleForce::Extrapolated) {
@@ -704,6 +712,22 @@ double ReferenceCalcAmoebaMultipoleForceKernel::execute(ContextImpl& context, bo
 
     AmoebaReferenceMultipoleForce* amoebaReferenceMultipoleForce = setupAmoebaReferenceMultipoleForce(context);
 
+    // The predictor history holds one entry for each previous time step: the dipoles from the last evaluation at
+    // that time.  Every evaluation at the current time, whether for a step, a state query, a Monte Carlo trial
+    // move, or energy minimization, predicts from the same history, and its dipoles replace those of any earlier
+    // evaluation at this time.  They are only added to the history once the time changes.
+
+    if (context.getTime() != latestInducedDipolesTime && latestInducedDipoles.size() > 0) {
+        if (inducedDipoleHistory.size() > 0 && inducedDipoleHistory[0].size() != latestInducedDipoles.size())
+            inducedDipoleHistory.clear();
+        inducedDipoleHistory.insert(inducedDipoleHistory.begin(), latestInducedDipoles);
+        if ((int) inducedDipoleHistory.size() > mutualInducedPredictorOrder)
+            inducedDipoleHistory.resize(mutualInducedPredictorOrder);
+        latestInducedDipoles.clear();
+    }
+    latestInducedDipolesTime = context.getTime();
+    amoebaReferenceMultipoleForce->setInducedDipoleHistory(mutualInducedPredictorOrder, &inducedDipoleHistory, &latestInducedDipoles);
+
     vector<RealVec>& posData   = extractPositions(context);
     vector<RealVec>& forceData = extractForces(context);
     RealOpenMM energy          = amoebaReferenceMultipoleForce->calculateForceAndEnergy(posData, charges, dipoles, quadrupoles, tholes,
@@ -829,7 +853,7 @@ void ReferenceCalcAmoebaMultipoleForceKernel::getPMEParameters(double& alpha, in
  * -------------------------------------------------------------------------- */
 
 ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel(std::string name, const Platform& platform, const System& system) : 
-           CalcAmoebaGeneralizedKirkwoodForceKernel(name, platform), system(system) {
+           CalcAmoebaGeneralizedKirkwoodForceKernel(name, platform), system(system), stepsSinceBornRadiiUpdate(0) {
 }
 
 ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::~ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel() {
@@ -927,10 +951,37 @@ void ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::initialize(const System&
     probeRadius        = static_cast<RealOpenMM>(force.getProbeRadius()), 
     surfaceAreaFactor  = static_cast<RealOpenMM>(force.getSurfaceAreaFactor()); 
     directPolarization = amoebaMultipoleForce->getPolarizationType() == AmoebaMultipoleForce::Direct ? 1 : 0;
+    bornRadiusCutoff   = static_cast<RealOpenMM>(force.getBornRadiusCutoff());
+    bornRadiiUpdateInterval = force.getBornRadiiUpdateInterval();
+}
+
+void ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::getBornRadii(ContextImpl& context, vector<RealOpenMM>& outputBornRadii) {
+    if (bornRadii.size() == 0 || stepsSinceBornRadiiUpdate >= bornRadiiUpdateInterval) {
+        computeBornRadii(context, bornRadii);
+        stepsSinceBornRadiiUpdate = 0;
+    }
+    outputBornRadii = bornRadii;
+}
+
+AmoebaReferenceGeneralizedKirkwoodMultipoleForce* ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::createMultipoleForce(AmoebaReferenceGeneralizedKirkwoodForce* gkForce) {
+    return new AmoebaReferenceGeneralizedKirkwoodMultipoleForce(gkForce);
+}
+
+void ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::computeBornRadii(ContextImpl& context, vector<RealOpenMM>& outputBornRadii) {
+    AmoebaReferenceGeneralizedKirkwoodForce gkForce;
+    gkForce.setNumParticles(numParticles);
+    gkForce.setAtomicRadii(atomicRadii);
+    gkForce.setScaleFactors(scaleFactors);
+    gkForce.setBornRadiusCutoff(bornRadiusCutoff);
+    gkForce.calculateGrycukBornRadii(extractPositions(context));
+    gkForce.getGrycukBornRadii(outputBornRadii);
 }
 
 double ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
-    // handled in AmoebaReferenceGeneralizedKirkwoodMultipoleForce, a derived class of the class AmoebaReferenceMultipoleForce
+    // handled in AmoebaReferenceGeneralizedKirkwoodMultipoleForce, a derived class of the class AmoebaReferenceMultipoleForce;
+    // this only counts force evaluations so the Born radii are updated at the requested interval
+
+    stepsSinceBornRadiiUpdate++;
     return 0.0;
 }
 
@@ -947,6 +998,7 @@ void ReferenceCalcAmoebaGeneralizedKirkwoodForceKernel::copyParametersToContext(
         scaleFactors[i] = scalingFactor;
         charges[i] = particleCharge;
     }
+    bornRadii.clear();
 }
 
 ReferenceCalcAmoebaVdwForceKernel::ReferenceCalcAmoebaVdwForceKernel(std::string name, const Platform& platform, const System& system) :
@@ -1010,7 +1062,17 @@ double ReferenceCalcAmoebaVdwForceKernel::execute(ContextImpl& context, bool inc
     RealOpenMM energy;
     if (useCutoff) {
         vdwForce.setCutoff(cutoff);
-        computeNeighborListVoxelHash(*neighborList, numParticles, posData, allExclusions, extractBoxVectors(context), usePBC, cutoff, 0.0);
+
+        // The cutoff applies to the interaction sites, so build the neighbor list from the reduced positions.
+
+        vector<RealVec> reducedPositions(numParticles);
+        for (int i = 0; i < numParticles; i++) {
+            if (reductions[i] != 0.0)
+                reducedPositions[i] = posData[indexIVs[i]] + (posData[i]-posData[indexIVs[i]])*reductions[i];
+            else
+                reducedPositions[i] = posData[i];
+        }
+        computeNeighborListVoxelHash(*neighborList, numParticles, reducedPositions, allExclusions, extractBoxVectors(context), usePBC, cutoff, 0.0);
         if (usePBC) {
             vdwForce.setNonbondedMethod(AmoebaReferenceVdwForce::CutoffPeriodic);
             RealVec* boxVectors = extractBoxVectors(context);
@@ -439,6 +439,11 @@ private:
 
     int mutualInducedMaxIterations;
     RealOpenMM mutualInducedTargetEpsilon;
+    AmoebaMultipoleForce::MutualInducedSolver mutualInducedSolver;
+    int mutualInducedPredictorOrder;
+    std::vector<std::vector<std::vector<RealVec> > > inducedDipoleHistory;
+    std::vector<std::vector<RealVec> > latestInducedDipoles;
+    double latestInducedDipolesTime;
     std::vector<double> extrapolationCoefficients;
 
     bool usePme;
@@ -661,7 +666,38 @@ public:
      */
     void copyParametersToContext(ContextImpl& context, const AmoebaGeneralizedKirkwoodForce& force);
 
-private:
+    /**
+     *  Get the Grycuk Born radii for the current positions.  They are only recomputed
+     *  once every bornRadiiUpdateInterval force evaluations; otherwise the previous values are returned.
+     *
+     *  @param context    the context in which to compute the Born radii
+     *  @param bornRadii  on exit, the Born radius of every particle
+     *
+     */
+    void getBornRadii(ContextImpl& context, std::vector<RealOpenMM>& bornRadii);
+
+    /**
+     *  Create the object that computes the generalized Kirkwood multipole interaction.  Subclasses may
+     *  override this to provide a faster implementation.
+     *
+     *  @param gkForce    the AmoebaReferenceGeneralizedKirkwoodForce holding the GK parameters and Born radii;
+     *                    ownership is passed to the returned object
+     *
+     *  @return the newly created multipole force
+     */
+    virtual AmoebaReferenceGeneralizedKirkwoodMultipoleForce* createMultipoleForce(AmoebaReferenceGeneralizedKirkwoodForce* gkForce);
+
+protected:
+
+    /**
+     *  Compute the Grycuk Born radii.  Subclasses may override this to provide
+     *  a faster implementation.
+     *
+     *  @param context    the context in which to compute the Born radii
+     *  @param bornRadii  on exit, the Born radius of every particle
+     *
+     */
+    virtual void computeBornRadii(ContextImpl& context, std::vector<RealOpenMM>& bornRadii);
 
     int numParticles;
     std::vector<RealOpenMM> atomicRadii;
@@ -674,6 +710,10 @@ private:
     RealOpenMM surfaceAreaFactor;
     int includeCavityTerm;
     int directPolarization;
+    RealOpenMM bornRadiusCutoff;
+    int bornRadiiUpdateInterval;
+    int stepsSinceBornRadiiUpdate;
+    std::vector<RealOpenMM> bornRadii;
     const System& system;
 };
 
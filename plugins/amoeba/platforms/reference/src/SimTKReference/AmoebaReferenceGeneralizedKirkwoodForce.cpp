@@ -33,7 +33,8 @@ AmoebaReferenceGeneralizedKirkwoodForce::AmoebaReferenceGeneralizedKirkwoodForce
                                                                                       _solventDielectric(78.3),
                                                                                       _dielectricOffset(0.009),
                                                                                       _probeRadius(0.14),
-                                                                                      _surfaceAreaFactor(0.0054) {
+                                                                                      _surfaceAreaFactor(0.0054),
+                                                                                      _bornRadiusCutoff(0.0) {
 
 }
 
@@ -121,11 +122,24 @@ void AmoebaReferenceGeneralizedKirkwoodForce::getScaleFactors(vector<RealOpenMM>
     copy(_scaleFactors.begin(), _scaleFactors.end(), scaleFactors.begin());
 }
 
+void AmoebaReferenceGeneralizedKirkwoodForce::setBornRadiusCutoff(RealOpenMM bornRadiusCutoff) {
+    _bornRadiusCutoff = bornRadiusCutoff;
+}
+
+RealOpenMM AmoebaReferenceGeneralizedKirkwoodForce::getBornRadiusCutoff() const {
+    return _bornRadiusCutoff;
+}
+
 void AmoebaReferenceGeneralizedKirkwoodForce::setCharges(const vector<RealOpenMM>& charges) {
     _charges.resize(charges.size());
     copy(charges.begin(), charges.end(), _charges.begin());
 }
 
+void AmoebaReferenceGeneralizedKirkwoodForce::setGrycukBornRadii(const vector<RealOpenMM>& bornRadii) {
+    _bornRadii.resize(bornRadii.size());
+    copy(bornRadii.begin(), bornRadii.end(), _bornRadii.begin());
+}
+
 void AmoebaReferenceGeneralizedKirkwoodForce::getGrycukBornRadii(vector<RealOpenMM>& bornRadii) const {
     bornRadii.resize(_bornRadii.size());
     copy(_bornRadii.begin(), _bornRadii.end(), bornRadii.begin());
@@ -141,6 +155,7 @@ void AmoebaReferenceGeneralizedKirkwoodForce::calculateGrycukBornRadii(const vec
     const RealOpenMM sixteen   = 16.0;
     const RealOpenMM oneThird  = 1.0/3.0;
     const RealOpenMM bigRadius = 1000.0;
+    const RealOpenMM cutoff2   = _bornRadiusCutoff*_bornRadiusCutoff;
 
     _bornRadii.resize(_numParticles);
     for (unsigned int ii = 0; ii < _numParticles; ii++) {
@@ -160,6 +175,7 @@ void AmoebaReferenceGeneralizedKirkwoodForce::calculateGrycukBornRadii(const vec
             RealOpenMM zr       = particlePositions[jj][2] - particlePositions[ii][2];
 
             RealOpenMM r2       = xr*xr + yr*yr + zr*zr;
+            if (cutoff2 > zero && r2 > cutoff2) continue;
             RealOpenMM r        = SQRT(r2);
 
             RealOpenMM sk       = _atomicRadii[jj]*_scaleFactors[jj];
@@ -215,6 +215,22 @@ public:
      */
     void setCharges(const vector<RealOpenMM>& charges);
 
+    /**
+     * Set the cutoff used when integrating the Born radii
+     *
+     * @param bornRadiusCutoff pairs farther apart than this are omitted; zero means no cutoff
+     *
+     */
+    void setBornRadiusCutoff(RealOpenMM bornRadiusCutoff);
+
+    /**
+     * Get the cutoff used when integrating the Born radii
+     *
+     * @return bornRadiusCutoff
+     *
+     */
+    RealOpenMM getBornRadiusCutoff() const;
+
     /**
      * Calculate Grycuk Born radii
      *
@@ -229,7 +245,15 @@ public:
      * @param bornRadii vector of Born radii
      *
      */
-    void getGrycukBornRadii(vector<RealOpenMM>& bornRadii) const;     
+    void getGrycukBornRadii(vector<RealOpenMM>& bornRadii) const;
+
+    /**
+     * Set Grycuk Born radii computed elsewhere, in place of calling calculateGrycukBornRadii()
+     *
+     * @param bornRadii vector of Born radii
+     *
+     */
+    void setGrycukBornRadii(const vector<RealOpenMM>& bornRadii);     
 
 private:
 
@@ -242,6 +266,7 @@ private:
     RealOpenMM _dielectricOffset;
     RealOpenMM _probeRadius;
     RealOpenMM _surfaceAreaFactor;
+    RealOpenMM _bornRadiusCutoff;
 
     std::vector<RealOpenMM> _atomicRadii;
     std::vector<RealOpenMM> _scaleFactors;
@@ -41,6 +41,10 @@ AmoebaReferenceMultipoleForce::AmoebaReferenceMultipoleForce() :
                                                    _mutualInducedDipoleConverged(0),
                                                    _mutualInducedDipoleIterations(0),
                                                    _maximumMutualInducedDipoleIterations(100),
+                                                   _mutualInducedSolver(DIIS),
+                                                   _predictorOrder(0),
+                                                   _inducedDipoleHistory(NULL),
+                                                   _latestInducedDipoles(NULL),
                                                    _mutualInducedDipoleEpsilon(1.0e+50),
                                                    _mutualInducedDipoleTargetEpsilon(1.0e-04),
                                                    _polarSOR(0.55),
@@ -57,6 +61,10 @@ AmoebaReferenceMultipoleForce::AmoebaReferenceMultipoleForce(NonbondedMethod non
                                                    _mutualInducedDipoleConverged(0),
                                                    _mutualInducedDipoleIterations(0),
                                                    _maximumMutualInducedDipoleIterations(100),
+                                                   _mutualInducedSolver(DIIS),
+                                                   _predictorOrder(0),
+                                                   _inducedDipoleHistory(NULL),
+                                                   _latestInducedDipoles(NULL),
                                                    _mutualInducedDipoleEpsilon(1.0e+50),
                                                    _mutualInducedDipoleTargetEpsilon(1.0e-04),
                                                    _polarSOR(0.55),
@@ -157,6 +165,24 @@ void AmoebaReferenceMultipoleForce::setMaximumMutualInducedDipoleIterations(int
     _maximumMutualInducedDipoleIterations = maximumMutualInducedDipoleIterations;
 }
 
+AmoebaReferenceMultipoleForce::MutualInducedSolver AmoebaReferenceMultipoleForce::getMutualInducedSolver() const 
+{
+    return _mutualInducedSolver;
+}
+
+void AmoebaReferenceMultipoleForce::setMutualInducedSolver(AmoebaReferenceMultipoleForce::MutualInducedSolver mutualInducedSolver)
+{
+    _mutualInducedSolver = mutualInducedSolver;
+}
+
+void AmoebaReferenceMultipoleForce::setInducedDipoleHistory(int predictorOrder, const vector<vector<vector<RealVec> > >* history,
+                                                            vector<vector<RealVec> >* latestDipoles)
+{
+    _predictorOrder       = predictorOrder;
+    _inducedDipoleHistory = history;
+    _latestInducedDipoles = latestDipoles;
+}
+
 RealOpenMM AmoebaReferenceMultipoleForce::getMutualInducedDipoleTargetEpsilon() const 
 {
     return _mutualInducedDipoleTargetEpsilon;
@@ -1114,6 +1140,167 @@ void AmoebaReferenceMultipoleForce::computeDIISCoefficients(const vector<vector<
     } 
 }
 
+void AmoebaReferenceMultipoleForce::convergeInduceDipolesByConjugateGradient(const vector<MultipoleParticleData>& particleData, vector<UpdateInducedDipoleFieldStruct>& updateInducedDipoleField) {
+
+    // The mutual induced dipoles satisfy (1/alpha - T) mu = E, where T maps dipoles to the field they produce
+    // and alpha*E is the fixed multipole field stored in the UpdateInducedDipoleFieldStruct.  The matrix is
+    // symmetric, so it is solved by conjugate gradient using 1/alpha as a Jacobi preconditioner.  Sites with
+    // zero polarizability carry no induced dipole and are left out of the system.
+
+    int numFields = updateInducedDipoleField.size();
+    setMutualInducedDipoleConverged(false);
+    RealVec zeroVec(0.0, 0.0, 0.0);
+    vector<vector<RealVec> > residual(numFields, vector<RealVec>(_numParticles));
+    vector<vector<RealVec> > searchDirection(numFields, vector<RealVec>(_numParticles));
+    vector<RealOpenMM> residualDotPrecond(numFields, 0.0);
+
+    // Compute the initial residual.  The preconditioned residual alpha*r equals the change in dipole a single
+    // fixed point iteration would make, so its norm is the same convergence measure used by DIIS.
+
+    calculateInducedDipoleFields(particleData, updateInducedDipoleField);
+    RealOpenMM maxEpsilon = 0.0;
+    for (int k = 0; k < numFields; k++) {
+        UpdateInducedDipoleFieldStruct& field = updateInducedDipoleField[k];
+        RealOpenMM epsilon = 0.0;
+        for (int i = 0; i < _numParticles; i++) {
+            RealOpenMM polarity = particleData[i].polarity;
+            if (polarity == 0.0) {
+                residual[k][i] = zeroVec;
+                searchDirection[k][i] = zeroVec;
+                continue;
+            }
+            RealVec precond = (*field.fixedMultipoleField)[i] + field.inducedDipoleField[i]*polarity - (*field.inducedDipoles)[i];
+            residual[k][i] = precond/polarity;
+            searchDirection[k][i] = precond;
+            residualDotPrecond[k] += residual[k][i].dot(precond);
+            epsilon += precond.dot(precond);
+        }
+        maxEpsilon = epsilon > maxEpsilon ? epsilon : maxEpsilon;
+    }
+    maxEpsilon = _debye*SQRT(maxEpsilon/_numParticles);
+    if (maxEpsilon < getMutualInducedDipoleTargetEpsilon()) {
+        setMutualInducedDipoleConverged(true);
+        setMutualInducedDipoleEpsilon(maxEpsilon);
+        setMutualInducedDipoleIterations(0);
+        return;
+    }
+
+    // Each iteration needs the field produced by the search direction, computed with the same
+    // field routines (and therefore the same real space, reciprocal space, and GK terms) as the dipoles.
+
+    vector<vector<RealVec> > unusedDipoles;
+    vector<vector<RealOpenMM> > unusedGradient;
+    vector<UpdateInducedDipoleFieldStruct> searchField;
+    for (int k = 0; k < numFields; k++)
+        searchField.push_back(UpdateInducedDipoleFieldStruct(*updateInducedDipoleField[k].fixedMultipoleField, searchDirection[k], unusedDipoles, unusedGradient));
+
+    int iteration = 1;
+    for (; ; iteration++) {
+        calculateInducedDipoleFields(particleData, searchField);
+        maxEpsilon = 0.0;
+        for (int k = 0; k < numFields; k++) {
+            if (residualDotPrecond[k] == 0.0)
+                continue;
+            vector<RealVec>& dipoles = *updateInducedDipoleField[k].inducedDipoles;
+            vector<RealVec>& direction = searchDirection[k];
+            vector<RealVec>& directionField = searchField[k].inducedDipoleField;
+            RealOpenMM directionDotProduct = 0.0;
+            for (int i = 0; i < _numParticles; i++) {
+                RealOpenMM polarity = particleData[i].polarity;
+                if (polarity != 0.0) {
+                    directionField[i] = direction[i]/polarity - directionField[i];
+                    directionDotProduct += direction[i].dot(directionField[i]);
+                }
+            }
+            if (directionDotProduct == 0.0)
+                continue;
+            RealOpenMM stepSize = residualDotPrecond[k]/directionDotProduct;
+            RealOpenMM newResidualDotPrecond = 0.0;
+            RealOpenMM epsilon = 0.0;
+            for (int i = 0; i < _numParticles; i++) {
+                RealOpenMM polarity = particleData[i].polarity;
+                if (polarity == 0.0)
+                    continue;
+                dipoles[i] += direction[i]*stepSize;
+                residual[k][i] -= directionField[i]*stepSize;
+                RealVec precond = residual[k][i]*polarity;
+                newResidualDotPrecond += residual[k][i].dot(precond);
+                epsilon += precond.dot(precond);
+            }
+            RealOpenMM beta = newResidualDotPrecond/residualDotPrecond[k];
+            residualDotPrecond[k] = newResidualDotPrecond;
+            for (int i = 0; i < _numParticles; i++) {
+                RealOpenMM polarity = particleData[i].polarity;
+                if (polarity != 0.0)
+                    direction[i] = residual[k][i]*polarity + direction[i]*beta;
+            }
+            maxEpsilon = epsilon > maxEpsilon ? epsilon : maxEpsilon;
+        }
+        maxEpsilon = _debye*SQRT(maxEpsilon/_numParticles);
+        if (maxEpsilon < getMutualInducedDipoleTargetEpsilon()) {
+            setMutualInducedDipoleConverged(true);
+            break;
+        }
+        if (iteration >= getMaximumMutualInducedDipoleIterations())
+            break;
+    }
+    setMutualInducedDipoleEpsilon(maxEpsilon);
+    setMutualInducedDipoleIterations(iteration);
+
+    // Leave the fields (and any state the subclasses record while computing them) consistent with the final dipoles.
+
+    calculateInducedDipoleFields(particleData, updateInducedDipoleField);
+}
+
+void AmoebaReferenceMultipoleForce::predictInducedDipoles(vector<UpdateInducedDipoleFieldStruct>& updateInducedDipoleField) const {
+    if (_inducedDipoleHistory == NULL || _predictorOrder == 0 || _inducedDipoleHistory->size() == 0)
+        return;
+    const vector<vector<vector<RealVec> > >& history = *_inducedDipoleHistory;
+    int numFields = updateInducedDipoleField.size();
+    int numSteps = ((int) history.size() < _predictorOrder ? (int) history.size() : _predictorOrder);
+    if ((int) history[numSteps-1].size() != numFields || history[numSteps-1][0].size() != _numParticles)
+        return;
+
+    // ASPC predictor coefficients for k = numSteps-2: B_j = (-1)^(j+1) j C(2k+4, k+2-j)/C(2k+2, k+1).
+
+    vector<RealOpenMM> coefficients(numSteps);
+    double sign = 1.0;
+    for (int j = 1; j <= numSteps; j++) {
+        double numerator = 1.0, denominator = 1.0;
+        for (int m = 1; m <= numSteps-j; m++)
+            numerator *= (double) (numSteps+j+m)/m;
+        for (int m = 1; m <= numSteps-1; m++)
+            denominator *= (double) (numSteps-1+m)/m;
+        coefficients[j-1] = sign*j*numerator/denominator;
+        sign = -sign;
+    }
+    for (int k = 0; k < numFields; k++) {
+        vector<RealVec>& dipoles = *updateInducedDipoleField[k].inducedDipoles;
+        for (int i = 0; i < _numParticles; i++) {
+            RealVec dipole(0.0, 0.0, 0.0);
+            for (int j = 0; j < numSteps; j++)
+                dipole += history[j][k][i]*coefficients[j];
+            dipoles[i] = dipole;
+        }
+    }
+}
+
+void AmoebaReferenceMultipoleForce::convergeMutualInducedDipoles(const vector<MultipoleParticleData>& particleData, vector<UpdateInducedDipoleFieldStruct>& updateInducedDipoleField) {
+    predictInducedDipoles(updateInducedDipoleField);
+    if (getMutualInducedSolver() == AmoebaReferenceMultipoleForce::ConjugateGradient)
+        convergeInduceDipolesByConjugateGradient(particleData, updateInducedDipoleField);
+    else
+        convergeInduceDipolesByDIIS(particleData, updateInducedDipoleField);
+    if (_latestInducedDipoles == NULL || _predictorOrder == 0)
+        return;
+
+    // Record the converged dipoles so the caller can add them to the history.
+
+    _latestInducedDipoles->resize(updateInducedDipoleField.size());
+    for (unsigned int k = 0; k < updateInducedDipoleField.size(); k++)
+        (*_latestInducedDipoles)[k] = *updateInducedDipoleField[k].inducedDipoles;
+}
+
 void AmoebaReferenceMultipoleForce::calculateInducedDipoles(const vector<MultipoleParticleData>& particleData)
 {
 
@@ -1147,7 +1334,7 @@ void AmoebaReferenceMultipoleForce::calculateInducedDipoles(const vector<Multipo
     // UpdateInducedDipoleFieldStruct contains induced dipole, fixed multipole fields and fields
     // due to other induced dipoles at each site
     if (getPolarizationType() == AmoebaReferenceMultipoleForce::Mutual)
-        convergeInduceDipolesByDIIS(particleData, updateInducedDipoleField);
+        convergeMutualInducedDipoles(particleData, updateInducedDipoleField);
     else if (getPolarizationType() == AmoebaReferenceMultipoleForce::Extrapolated)
         convergeInduceDipolesByExtrapolation(particleData, updateInducedDipoleField);
 }
@@ -2552,7 +2739,7 @@ void AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateInducedDipoles(c
     updateInducedDipoleField.push_back(UpdateInducedDipoleFieldStruct(gkFieldPolar, _inducedDipolePolarS, _ptDipolePS, _ptDipoleFieldGradientPS));
 
     if (getPolarizationType() == AmoebaReferenceMultipoleForce::Mutual)
-        convergeInduceDipolesByDIIS(particleData, updateInducedDipoleField);
+        convergeMutualInducedDipoles(particleData, updateInducedDipoleField);
     else if (getPolarizationType() == AmoebaReferenceMultipoleForce::Extrapolated)
         convergeInduceDipolesByExtrapolation(particleData, updateInducedDipoleField);
 }
@@ -3980,11 +4167,7 @@ RealOpenMM AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateElectrosta
 
     // Kirkwood loop over particle pairs
 
-    for (unsigned int ii = 0; ii < particleData.size(); ii++) {
-        for (unsigned int jj = ii; jj < particleData.size(); jj++) {
-            energy += calculateKirkwoodPairIxn(particleData[ii], particleData[jj], forces, torques, dBorn);
-        }
-    }
+    energy += calculateKirkwoodIxns(particleData, forces, torques, dBorn);
 
     // cavity term
 
@@ -3992,41 +4175,13 @@ RealOpenMM AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateElectrosta
         energy += calculateCavityTermEnergyAndForces(dBorn);
     }
 
-    // apply Born chain rule; skip diagonal terms since these make no contribution to forces
+    // apply Born chain rule
 
-    for (unsigned int ii = 0; ii < particleData.size(); ii++) {
-        for (unsigned int jj = ii+1; jj < particleData.size(); jj++) {
-            calculateGrycukChainRulePairIxn(particleData[ii], particleData[jj], dBorn, forces);
-            calculateGrycukChainRulePairIxn(particleData[jj], particleData[ii], dBorn, forces);
-        }
-    }
+    calculateGrycukChainRuleIxns(particleData, dBorn, forces);
 
     // correct vacuum to SCRF derivatives (ediff1 in TINKER)
 
-    vector<RealOpenMM> scaleFactors(LAST_SCALE_TYPE_INDEX);
-    for (unsigned int kk = 0; kk < scaleFactors.size(); kk++) {
-        scaleFactors[kk] = 1.0;
-    }   
-
-    RealOpenMM eDiffEnergy = 0.0;
-    for (unsigned int ii = 0; ii < particleData.size(); ii++) {
-        for (unsigned int jj = ii+1; jj < particleData.size(); jj++) {
-
-            if (jj <= _maxScaleIndex[ii]) {
-                getMultipoleScaleFactors(ii, jj, scaleFactors);
-            }
-
-            eDiffEnergy += calculateKirkwoodEDiffPairIxn(particleData[ii], particleData[jj],
-                                                         scaleFactors[P_SCALE], scaleFactors[D_SCALE], forces, torques);
-
-            if (jj <= _maxScaleIndex[ii]) {
-                for (unsigned int kk = 0; kk < LAST_SCALE_TYPE_INDEX; kk++) {
-                    scaleFactors[kk] = 1.0;
-                }
-            }
-        }
-    }
-    energy += (_electric/_dielectric)*eDiffEnergy;
+    energy += (_electric/_dielectric)*calculateKirkwoodEDiffIxns(particleData, forces, torques);
 
     if (getPolarizationType() == AmoebaReferenceMultipoleForce::Extrapolated) {
         RealOpenMM prefac = (_electric/_dielectric);
@@ -4080,6 +4235,61 @@ RealOpenMM AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateElectrosta
     return energy;
 }
 
+RealOpenMM AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateKirkwoodIxns(const vector<MultipoleParticleData>& particleData,
+                                                                                   vector<RealVec>& forces, vector<RealVec>& torques,
+                                                                                   vector<RealOpenMM>& dBorn) const
+{
+    RealOpenMM energy = 0.0;
+    for (unsigned int ii = 0; ii < particleData.size(); ii++) {
+        for (unsigned int jj = ii; jj < particleData.size(); jj++) {
+            energy += calculateKirkwoodPairIxn(particleData[ii], particleData[jj], forces, torques, dBorn);
+        }
+    }
+    return energy;
+}
+
+void AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateGrycukChainRuleIxns(const vector<MultipoleParticleData>& particleData,
+                                                                                    const vector<RealOpenMM>& dBorn, vector<RealVec>& forces) const
+{
+    // skip diagonal terms since these make no contribution to forces
+
+    for (unsigned int ii = 0; ii < particleData.size(); ii++) {
+        for (unsigned int jj = ii+1; jj < particleData.size(); jj++) {
+            calculateGrycukChainRulePairIxn(particleData[ii], particleData[jj], dBorn, forces);
+            calculateGrycukChainRulePairIxn(particleData[jj], particleData[ii], dBorn, forces);
+        }
+    }
+}
+
+RealOpenMM AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateKirkwoodEDiffIxns(const vector<MultipoleParticleData>& particleData,
+                                                                                        vector<RealVec>& forces, vector<RealVec>& torques) const
+{
+    vector<RealOpenMM> scaleFactors(LAST_SCALE_TYPE_INDEX);
+    for (unsigned int kk = 0; kk < scaleFactors.size(); kk++) {
+        scaleFactors[kk] = 1.0;
+    }   
+
+    RealOpenMM eDiffEnergy = 0.0;
+    for (unsigned int ii = 0; ii < particleData.size(); ii++) {
+        for (unsigned int jj = ii+1; jj < particleData.size(); jj++) {
+
+            if (jj <= _maxScaleIndex[ii]) {
+                getMultipoleScaleFactors(ii, jj, scaleFactors);
+            }
+
+            eDiffEnergy += calculateKirkwoodEDiffPairIxn(particleData[ii], particleData[jj],
+                                                         scaleFactors[P_SCALE], scaleFactors[D_SCALE], forces, torques);
+
+            if (jj <= _maxScaleIndex[ii]) {
+                for (unsigned int kk = 0; kk < LAST_SCALE_TYPE_INDEX; kk++) {
+                    scaleFactors[kk] = 1.0;
+                }
+            }
+        }
+    }
+    return eDiffEnergy;
+}
+
 void AmoebaReferenceGeneralizedKirkwoodMultipoleForce::calculateGrycukChainRulePairIxn(const MultipoleParticleData& particleI, const MultipoleParticleData& particleJ,
                                                                                        const vector<RealOpenMM>& dBorn, vector<RealVec>& forces) const 
 {
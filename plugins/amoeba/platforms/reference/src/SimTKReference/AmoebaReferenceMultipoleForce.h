@@ -356,6 +356,22 @@ public:
         Extrapolated = 2
     };
 
+    /**
+     * This is an enumeration of the iterative methods that may be used for converging mutual induced dipoles.
+     */
+    enum MutualInducedSolver {
+
+        /**
+         * Direct inversion in the iterative subspace
+         */
+        DIIS = 0,
+
+        /**
+         * Jacobi preconditioned conjugate gradient
+         */
+        ConjugateGradient = 1
+    };
+
     /**
      * Constructor
      * 
@@ -468,6 +484,33 @@ public:
      */
     int getMaximumMutualInducedDipoleIterations() const;
 
+    /**
+     * Get the method used to converge mutual induced dipoles.
+     *
+     * @return solver used for mutual induced dipoles
+     */
+    MutualInducedSolver getMutualInducedSolver() const;
+
+    /**
+     * Set the method used to converge mutual induced dipoles.
+     *
+     * @param mutualInducedSolver solver used for mutual induced dipoles
+     */
+    void setMutualInducedSolver(MutualInducedSolver mutualInducedSolver);
+
+    /**
+     * Set the history of converged induced dipoles from previous steps, used to predict the initial
+     * guess for mutual induced dipoles.
+     *
+     * @param predictorOrder  maximum number of previous solutions to use; 0 disables prediction
+     * @param history         history[step][field] holds the dipoles of a previous step, most recent step first;
+     *                        the caller retains ownership
+     * @param latestDipoles   on exit, latestDipoles[field] holds the newly converged dipoles, which the caller
+     *                        may add to the history; the caller retains ownership
+     */
+    void setInducedDipoleHistory(int predictorOrder, const std::vector<std::vector<std::vector<RealVec> > >* history,
+                                 std::vector<std::vector<RealVec> >* latestDipoles);
+
     /**
      * Calculate force and energy.
      *
@@ -677,6 +720,10 @@ protected:
     int _mutualInducedDipoleIterations;
     int _maximumMutualInducedDipoleIterations;
     int _maxPTOrder;
+    MutualInducedSolver _mutualInducedSolver;
+    int _predictorOrder;
+    const std::vector<std::vector<std::vector<RealVec> > >* _inducedDipoleHistory;
+    std::vector<std::vector<RealVec> >* _latestInducedDipoles;
     std::vector<RealOpenMM>  _extrapolationCoefficients;
     std::vector<RealOpenMM>  _extPartCoefficients;
     RealOpenMM  _mutualInducedDipoleEpsilon;
@@ -977,6 +1024,32 @@ protected:
      */
     void computeDIISCoefficients(const std::vector<std::vector<RealVec> >& prevErrors, std::vector<RealOpenMM>& coefficients) const;
 
+    /**
+     * Converge induced dipoles using a Jacobi preconditioned conjugate gradient solver.
+     * 
+     * @param particleData              vector of particle positions and parameters (charge, labFrame dipoles, quadrupoles, ...)
+     * @param updateInducedDipoleFields vector of UpdateInducedDipoleFieldStruct containing input induced dipoles and output fields
+     */
+    void convergeInduceDipolesByConjugateGradient(const std::vector<MultipoleParticleData>& particleData,
+                                                  std::vector<UpdateInducedDipoleFieldStruct>& updateInducedDipoleFields);
+
+    /**
+     * Converge mutual induced dipoles with the selected solver, starting from the predicted
+     * dipoles if a history of previous solutions is available, and record the result in the history.
+     * 
+     * @param particleData              vector of particle positions and parameters (charge, labFrame dipoles, quadrupoles, ...)
+     * @param updateInducedDipoleFields vector of UpdateInducedDipoleFieldStruct containing input induced dipoles and output fields
+     */
+    void convergeMutualInducedDipoles(const std::vector<MultipoleParticleData>& particleData,
+                                      std::vector<UpdateInducedDipoleFieldStruct>& updateInducedDipoleFields);
+
+    /**
+     * Replace the induced dipoles with the ASPC prediction from the history of previous solutions.
+     * 
+     * @param updateInducedDipoleFields vector of UpdateInducedDipoleFieldStruct containing induced dipoles to be overwritten
+     */
+    void predictInducedDipoles(std::vector<UpdateInducedDipoleFieldStruct>& updateInducedDipoleFields) const;
+
     /**
      * Update fields due to induced dipoles for each particle.
      * 
@@ -1293,6 +1366,47 @@ private:
     void calculateInducedDipolePairGkIxn(const MultipoleParticleData& particleI, const MultipoleParticleData& particleJ,
                                          const std::vector<RealVec>& field, std::vector<RealVec>& fieldPolar) const;
 
+protected:
+
+    /**
+     * Calculate the Kirkwood interactions of all pairs of particles.  Subclasses may override this
+     * to divide the pairs between threads.
+     * 
+     * @param particleData            vector of parameters (charge, labFrame dipoles, quadrupoles, ...) for particles
+     * @param forces                  add Kirkwood forces to forces
+     * @param torques                 add Kirkwood torques to torques
+     * @param dBorn                   add chain-rule factors to dBorn
+     *
+     * @return energy
+     */
+    virtual RealOpenMM calculateKirkwoodIxns(const std::vector<MultipoleParticleData>& particleData,
+                                             std::vector<RealVec>& forces, std::vector<RealVec>& torques,
+                                             std::vector<RealOpenMM>& dBorn) const;
+
+    /**
+     * Calculate the Grycuk 'chain-rule' forces of all pairs of particles.  Subclasses may override this
+     * to divide the pairs between threads.
+     * 
+     * @param particleData            vector of parameters (charge, labFrame dipoles, quadrupoles, ...) for particles
+     * @param dBorn                   chain-rule Born force factors
+     * @param forces                  add chain-rule forces to forces
+     */
+    virtual void calculateGrycukChainRuleIxns(const std::vector<MultipoleParticleData>& particleData,
+                                              const std::vector<RealOpenMM>& dBorn, std::vector<RealVec>& forces) const;
+
+    /**
+     * Correct vacuum to SCRF derivatives for all pairs of particles (TINKER's ediff1()).  Subclasses may
+     * override this to divide the pairs between threads.
+     * 
+     * @param particleData            vector of parameters (charge, labFrame dipoles, quadrupoles, ...) for particles
+     * @param forces                  force accumulator
+     * @param torques                 torque accumulator
+     *
+     * @return energy, not yet multiplied by the electric constant over the dielectric
+     */
+    virtual RealOpenMM calculateKirkwoodEDiffIxns(const std::vector<MultipoleParticleData>& particleData,
+                                                  std::vector<RealVec>& forces, std::vector<RealVec>& torques) const;
+
     /**
      * Calculate Kirkwood interaction.
      * 
@@ -39,6 +39,7 @@
 #include "openmm/System.h"
 #include "openmm/AmoebaMultipoleForce.h"
 #include "openmm/LangevinIntegrator.h"
+#include "openmm/VerletIntegrator.h"
 #include "openmm/Vec3.h"
 #include <iostream>
 #include <vector>
@@ -438,6 +439,90 @@ static void testMultipoleAmmoniaMutualPolarization() {
     compareForcesEnergy(testName, state2.getPotentialEnergy(), state1.getPotentialEnergy(), state2.getForces(), state1.getForces(), tolerance);
 }
 
+// test that the conjugate gradient solver, with and without the induced dipole predictor, agrees with DIIS
+
+static void testMutualInducedSolvers(AmoebaMultipoleForce::NonbondedMethod nonbondedMethod) {
+
+    std::string testName      = "testMutualInducedSolvers";
+
+    int inputPmeGridDimension = (nonbondedMethod == AmoebaMultipoleForce::PME ? 24 : 0);
+    double cutoff             = (nonbondedMethod == AmoebaMultipoleForce::PME ? 0.25 : 9000000.0);
+    std::vector<Vec3> forces, expectedForces;
+    double energy, expectedEnergy;
+
+    System system1, system2;
+    AmoebaMultipoleForce* amoebaMultipoleForce1 = new AmoebaMultipoleForce();
+    AmoebaMultipoleForce* amoebaMultipoleForce2 = new AmoebaMultipoleForce();
+    setupMultipoleAmmonia(system1, amoebaMultipoleForce1, nonbondedMethod, AmoebaMultipoleForce::Mutual, cutoff, inputPmeGridDimension);
+    setupMultipoleAmmonia(system2, amoebaMultipoleForce2, nonbondedMethod, AmoebaMultipoleForce::Mutual, cutoff, inputPmeGridDimension);
+    amoebaMultipoleForce2->setMutualInducedSolver(AmoebaMultipoleForce::ConjugateGradient);
+    amoebaMultipoleForce2->setMutualInducedPredictorOrder(4);
+    LangevinIntegrator integrator1(0.0, 0.1, 0.0005);
+    LangevinIntegrator integrator2(0.0, 0.1, 0.0005);
+    Context context1(system1, integrator1, Platform::getPlatformByName("Reference"));
+    Context context2(system2, integrator2, Platform::getPlatformByName("Reference"));
+    getForcesEnergyMultipoleAmmonia(context1, expectedForces, expectedEnergy);
+    getForcesEnergyMultipoleAmmonia(context2, forces, energy);
+    compareForcesEnergy(testName, expectedEnergy, energy, expectedForces, forces, 1.0e-04);
+
+    // Take some steps so the predictor has a history to work from, and check that the dipoles
+    // it converges to still match those found by DIIS.
+
+    for (int i = 0; i < 10; i++) {
+        integrator2.step(1);
+        State state2 = context2.getState(State::Positions | State::Forces | State::Energy);
+        context1.setPositions(state2.getPositions());
+        State state1 = context1.getState(State::Forces | State::Energy);
+        compareForcesEnergy(testName, state1.getPotentialEnergy(), state2.getPotentialEnergy(), state1.getForces(), state2.getForces(), 1.0e-04);
+        std::vector<Vec3> dipoles1, dipoles2;
+        amoebaMultipoleForce1->getInducedDipoles(context1, dipoles1);
+        amoebaMultipoleForce2->getInducedDipoles(context2, dipoles2);
+        for (int j = 0; j < (int) dipoles1.size(); j++)
+            ASSERT_EQUAL_VEC(dipoles1[j], dipoles2[j], 1.0e-04);
+    }
+}
+
+// test that evaluating the forces again without taking a step does not change the predictor history
+
+static void testPredictorHistory() {
+
+    System system1, system2;
+    AmoebaMultipoleForce* amoebaMultipoleForce1 = new AmoebaMultipoleForce();
+    AmoebaMultipoleForce* amoebaMultipoleForce2 = new AmoebaMultipoleForce();
+    setupMultipoleAmmonia(system1, amoebaMultipoleForce1, AmoebaMultipoleForce::NoCutoff, AmoebaMultipoleForce::Mutual, 9000000.0, 0);
+    setupMultipoleAmmonia(system2, amoebaMultipoleForce2, AmoebaMultipoleForce::NoCutoff, AmoebaMultipoleForce::Mutual, 9000000.0, 0);
+    AmoebaMultipoleForce* forces[] = {amoebaMultipoleForce1, amoebaMultipoleForce2};
+    for (int i = 0; i < 2; i++) {
+        forces[i]->setMutualInducedSolver(AmoebaMultipoleForce::ConjugateGradient);
+        forces[i]->setMutualInducedPredictorOrder(4);
+        forces[i]->setMutualInducedTargetEpsilon(1.0e-04);
+    }
+    VerletIntegrator integrator1(0.0005);
+    VerletIntegrator integrator2(0.0005);
+    Context context1(system1, integrator1, Platform::getPlatformByName("Reference"));
+    Context context2(system2, integrator2, Platform::getPlatformByName("Reference"));
+    std::vector<Vec3> positions;
+    double energy;
+    getForcesEnergyMultipoleAmmonia(context1, positions, energy);
+    getForcesEnergyMultipoleAmmonia(context2, positions, energy);
+
+    // The first context has its forces queried repeatedly between steps.  If the queries were added to the
+    // history, the dipoles predicted for the next step would differ, and so would the converged dipoles.
+
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 3; j++)
+            context1.getState(State::Forces | State::Energy);
+        integrator1.step(1);
+        integrator2.step(1);
+        State state1 = context1.getState(State::Positions | State::Velocities);
+        State state2 = context2.getState(State::Positions | State::Velocities);
+        for (int j = 0; j < system1.getNumParticles(); j++) {
+            ASSERT_EQUAL_VEC(state2.getPositions()[j], state1.getPositions()[j], 1.0e-12);
+            ASSERT_EQUAL_VEC(state2.getVelocities()[j], state1.getVelocities()[j], 1.0e-12);
+        }
+    }
+}
+
 // setup for box of 4 water molecules -- used to test PME
 
 static void setupAndGetForcesEnergyMultipoleWater(AmoebaMultipoleForce::NonbondedMethod nonbondedMethod,
@@ -2888,6 +2973,12 @@ int main(int numberOfArguments, char* argv[]) {
 
         testMultipoleAmmoniaMutualPolarization();
 
+        // test the conjugate gradient solver and predictor against DIIS
+
+        testMutualInducedSolvers(AmoebaMultipoleForce::NoCutoff);
+        testMutualInducedSolvers(AmoebaMultipoleForce::PME);
+        testPredictorHistory();
+
         // test multipole direct & mutual polarization using PME
 
         testMultipoleWaterPMEDirectPolarization();
@@ -42,7 +42,7 @@ AmoebaGeneralizedKirkwoodForceProxy::AmoebaGeneralizedKirkwoodForceProxy() : Ser
 }
 
 void AmoebaGeneralizedKirkwoodForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 2);
+    node.setIntProperty("version", 3);
     const AmoebaGeneralizedKirkwoodForce& force = *reinterpret_cast<const AmoebaGeneralizedKirkwoodForce*>(object);
 
     node.setIntProperty("forceGroup", force.getForceGroup());
@@ -52,6 +52,8 @@ void AmoebaGeneralizedKirkwoodForceProxy::serialize(const void* object, Serializ
     node.setDoubleProperty("GeneralizedKirkwoodProbeRadius",       force.getProbeRadius());
     node.setDoubleProperty("GeneralizedKirkwoodSurfaceAreaFactor", force.getSurfaceAreaFactor());
     node.setIntProperty(  "GeneralizedKirkwoodIncludeCavityTerm", force.getIncludeCavityTerm());
+    node.setDoubleProperty("GeneralizedKirkwoodBornRadiusCutoff",  force.getBornRadiusCutoff());
+    node.setIntProperty(  "GeneralizedKirkwoodBornRadiiUpdateInterval", force.getBornRadiiUpdateInterval());
 
     SerializationNode& particles = node.createChildNode("GeneralizedKirkwoodParticles");
     for (unsigned int ii = 0; ii < static_cast<unsigned int>(force.getNumParticles()); ii++) {
@@ -64,7 +66,7 @@ void AmoebaGeneralizedKirkwoodForceProxy::serialize(const void* object, Serializ
 
 void* AmoebaGeneralizedKirkwoodForceProxy::deserialize(const SerializationNode& node) const {
     int version = node.getIntProperty("version");
-    if (version < 1 || version > 2)
+    if (version < 1 || version > 3)
         throw OpenMMException("Unsupported version number");
     AmoebaGeneralizedKirkwoodForce* force = new AmoebaGeneralizedKirkwoodForce();
     try {
@@ -76,6 +78,10 @@ void* AmoebaGeneralizedKirkwoodForceProxy::deserialize(const SerializationNode&
         force->setProbeRadius(        node.getDoubleProperty("GeneralizedKirkwoodProbeRadius"));
         force->setSurfaceAreaFactor(  node.getDoubleProperty("GeneralizedKirkwoodSurfaceAreaFactor"));
         force->setIncludeCavityTerm(  node.getIntProperty(   "GeneralizedKirkwoodIncludeCavityTerm"));
+        if (version > 2) {
+            force->setBornRadiusCutoff(node.getDoubleProperty("GeneralizedKirkwoodBornRadiusCutoff"));
+            force->setBornRadiiUpdateInterval(node.getIntProperty("GeneralizedKirkwoodBornRadiiUpdateInterval"));
+        }
 
         const SerializationNode& particles = node.getChildNode("GeneralizedKirkwoodParticles");
         for (unsigned int ii = 0; ii < particles.getChildren().size(); ii++) {
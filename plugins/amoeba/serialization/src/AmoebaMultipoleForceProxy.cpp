@@ -68,7 +68,7 @@ void loadCovalentMap(const SerializationNode& map, std::vector< int >& covalentM
 }
 
 void AmoebaMultipoleForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 4);
+    node.setIntProperty("version", 5);
     const AmoebaMultipoleForce& force = *reinterpret_cast<const AmoebaMultipoleForce*>(object);
 
     node.setIntProperty("forceGroup", force.getForceGroup());
@@ -77,6 +77,8 @@ void AmoebaMultipoleForceProxy::serialize(const void* object, SerializationNode&
     //node.setIntProperty("pmeBSplineOrder",                  force.getPmeBSplineOrder());
     //node.setIntProperty("mutualInducedIterationMethod",     force.getMutualInducedIterationMethod());
     node.setIntProperty("mutualInducedMaxIterations",       force.getMutualInducedMaxIterations());
+    node.setIntProperty("mutualInducedSolver",              force.getMutualInducedSolver());
+    node.setIntProperty("mutualInducedPredictorOrder",      force.getMutualInducedPredictorOrder());
 
     node.setDoubleProperty("cutoffDistance",                force.getCutoffDistance());
     node.setDoubleProperty("aEwald",                        force.getAEwald());
@@ -134,7 +136,7 @@ void AmoebaMultipoleForceProxy::serialize(const void* object, SerializationNode&
 
 void* AmoebaMultipoleForceProxy::deserialize(const SerializationNode& node) const {
     int version = node.getIntProperty("version");
-    if (version < 0 || version > 4)
+    if (version < 0 || version > 5)
         throw OpenMMException("Unsupported version number");
     AmoebaMultipoleForce* force = new AmoebaMultipoleForce();
 
@@ -147,6 +149,10 @@ void* AmoebaMultipoleForceProxy::deserialize(const SerializationNode& node) cons
         //force->setPmeBSplineOrder(node.getIntProperty("pmeBSplineOrder"));
         //force->setMutualInducedIterationMethod(static_cast<AmoebaMultipoleForce::MutualInducedIterationMethod>(node.getIntProperty("mutualInducedIterationMethod")));
         force->setMutualInducedMaxIterations(node.getIntProperty("mutualInducedMaxIterations"));
+        if (version >= 5) {
+            force->setMutualInducedSolver(static_cast<AmoebaMultipoleForce::MutualInducedSolver>(node.getIntProperty("mutualInducedSolver")));
+            force->setMutualInducedPredictorOrder(node.getIntProperty("mutualInducedPredictorOrder"));
+        }
 
         force->setCutoffDistance(node.getDoubleProperty("cutoffDistance"));
         force->setAEwald(node.getDoubleProperty("aEwald"));
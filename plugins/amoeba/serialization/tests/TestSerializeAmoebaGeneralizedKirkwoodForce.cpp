@@ -52,6 +52,8 @@ void testSerialization() {
     force1.setProbeRadius(        1.40);
     force1.setSurfaceAreaFactor(  0.888);
     force1.setIncludeCavityTerm(  1);
+    force1.setBornRadiusCutoff(   1.2);
+    force1.setBornRadiiUpdateInterval(3);
 
     force1.addParticle(1.0, 2.0, 0.9);
     force1.addParticle(-1.1,2.1, 0.8);
@@ -72,6 +74,8 @@ void testSerialization() {
     ASSERT_EQUAL(force1.getProbeRadius(),          force2.getProbeRadius());
     ASSERT_EQUAL(force1.getSurfaceAreaFactor(),    force2.getSurfaceAreaFactor());
     ASSERT_EQUAL(force1.getIncludeCavityTerm(),    force2.getIncludeCavityTerm());
+    ASSERT_EQUAL(force1.getBornRadiusCutoff(),     force2.getBornRadiusCutoff());
+    ASSERT_EQUAL(force1.getBornRadiiUpdateInterval(), force2.getBornRadiiUpdateInterval());
 
     ASSERT_EQUAL(force1.getNumParticles(), force2.getNumParticles());
     for (unsigned int ii = 0; ii < static_cast<unsigned int>(force1.getNumParticles()); ii++) {
@@ -72,6 +72,8 @@ void testSerialization() {
     force1.setPmeGridDimensions(gridDimension); 
     //force1.setMutualInducedIterationMethod(AmoebaMultipoleForce::SOR); 
     force1.setMutualInducedMaxIterations(200); 
+    force1.setMutualInducedSolver(AmoebaMultipoleForce::ConjugateGradient);
+    force1.setMutualInducedPredictorOrder(4);
     force1.setMutualInducedTargetEpsilon(1.0e-05); 
     //force1.setElectricConstant(138.93); 
     force1.setEwaldErrorTolerance(1.0e-05); 
@@ -119,6 +121,8 @@ void testSerialization() {
     //ASSERT_EQUAL(force1.getPmeBSplineOrder(),               force2.getPmeBSplineOrder());
     //ASSERT_EQUAL(force1.getMutualInducedIterationMethod(),  force2.getMutualInducedIterationMethod());
     ASSERT_EQUAL(force1.getMutualInducedMaxIterations(),    force2.getMutualInducedMaxIterations());
+    ASSERT_EQUAL(force1.getMutualInducedSolver(),           force2.getMutualInducedSolver());
+    ASSERT_EQUAL(force1.getMutualInducedPredictorOrder(),   force2.getMutualInducedPredictorOrder());
     ASSERT_EQUAL(force1.getMutualInducedTargetEpsilon(),    force2.getMutualInducedTargetEpsilon());
     //ASSERT_EQUAL(force1.getElectricConstant(),              force2.getElectricConstant());
     ASSERT_EQUAL(force1.getEwaldErrorTolerance(),           force2.getEwaldErrorTolerance());
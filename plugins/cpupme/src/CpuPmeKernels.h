@@ -36,8 +36,8 @@
 #include "internal/windowsExportPme.h"
 #include "openmm/kernels.h"
 #include "openmm/Vec3.h"
-#include "openmm/internal/gmx_atomic.h"
 #include "openmm/internal/ThreadPool.h"
+#include "openmm/internal/WorkStealingRange.h"
 #include <fftw3.h>
 #include <pthread.h>
 #include <vector>
@@ -62,8 +62,11 @@ public:
      * @param gridz        the z size of the PME grid
      * @param numParticles the number of particles in the system
      * @param alpha        the Ewald blending parameter
+     * @param numThreads   the number of threads to use.  If this is 0, it is set to the value of the
+     *                     OPENMM_CPU_THREADS environment variable, or the number of processors if
+     *                     that is not set.
      */
-    void initialize(int xsize, int ysize, int zsize, int numParticles, double alpha);
+    void initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, int numThreads);
     ~CpuCalcPmeReciprocalForceKernel();
     /**
      * Begin computing the force and energy.
@@ -101,6 +104,15 @@ public:
      * @param nz      the number of grid points along the Z axis
      */
     void getPMEParameters(double& alpha, int& nx, int& ny, int& nz) const;
+    /**
+     * Get the total time that has been spent on each phase of the calculation since the kernel
+     * was initialized.  This is useful for profiling.
+     * 
+     * @param times   on exit, contains the time in seconds spent on spreading charges (including
+     *                summing the threads' grids), the forward FFT, the reciprocal space convolution,
+     *                the backward FFT, and interpolating forces, in that order
+     */
+    void getPhaseTimes(std::vector<double>& times) const;
 private:
     class ComputeTask;
     /**
@@ -108,7 +120,7 @@ private:
      */
     int findFFTDimension(int minimum, bool isZ);
     static bool hasInitializedThreads;
-    static int numThreads;
+    int numThreads;
     int gridx, gridy, gridz, numParticles;
     double alpha;
     bool hasCreatedPlan, isFinished, isDeleted;
@@ -117,6 +129,7 @@ private:
     std::vector<float> recipEterm;
     Vec3 lastBoxVectors[3];
     std::vector<float> threadEnergy;
+    std::vector<double> phaseTimes;
     std::vector<float*> tempGrid;
     float* realGrid;
     fftwf_complex* complexGrid;
@@ -131,7 +144,7 @@ private:
     float* posq;
     Vec3 periodicBoxVectors[3], recipBoxVectors[3];
     bool includeEnergy;
-    gmx_atomic_t atomicCounter;
+    WorkStealingRange particleRange;
 };
 
 } // namespace OpenMM
@@ -61,7 +61,7 @@ public:
     }
 };
 
-void testPME(bool triclinic) {
+void testPME(bool triclinic, int numThreads) {
     // Create a cloud of random point charges.
 
     const int numParticles = 51;
@@ -122,7 +122,7 @@ void testPME(bool triclinic) {
         sumSquaredCharges += charge*charge;
     }
     double ewaldSelfEnergy = -ONE_4PI_EPS0*alpha*sumSquaredCharges/sqrt(M_PI);
-    pme.initialize(gridx, gridy, gridz, numParticles, alpha);
+    pme.initialize(gridx, gridy, gridz, numParticles, alpha, numThreads);
     pme.beginComputation(io, boxVectors, true);
     double energy = pme.finishComputation(io);
     
@@ -133,14 +133,56 @@ void testPME(bool triclinic) {
         ASSERT_EQUAL_VEC(refState.getForces()[i], Vec3(io.force[4*i], io.force[4*i+1], io.force[4*i+2]), 1e-3);
 }
 
+/**
+ * Compute reciprocal space forces for many particles with more threads than there are cores, so threads that
+ * finish their own share of the particles steal work from the others.  Every evaluation must process each
+ * particle exactly once and agree with a single threaded evaluation.
+ */
+void testWorkStealing() {
+    const int numParticles = 1000;
+    const int numThreads = 8;
+    const double boxWidth = 4.0;
+    Vec3 boxVectors[3];
+    boxVectors[0] = Vec3(boxWidth, 0, 0);
+    boxVectors[1] = Vec3(0, boxWidth, 0);
+    boxVectors[2] = Vec3(0, 0, boxWidth);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    IO io;
+    for (int i = 0; i < numParticles; i++) {
+        io.posq.push_back(boxWidth*genrand_real2(sfmt));
+        io.posq.push_back(boxWidth*genrand_real2(sfmt));
+        io.posq.push_back(boxWidth*genrand_real2(sfmt));
+        io.posq.push_back(i%2 == 0 ? -1.0 : 1.0);
+    }
+    Platform& platform = Platform::getPlatformByName("Reference");
+    CpuCalcPmeReciprocalForceKernel pme1(CalcPmeReciprocalForceKernel::Name(), platform);
+    CpuCalcPmeReciprocalForceKernel pme2(CalcPmeReciprocalForceKernel::Name(), platform);
+    pme1.initialize(32, 32, 32, numParticles, 3.0, 1);
+    pme2.initialize(32, 32, 32, numParticles, 3.0, numThreads);
+    pme1.beginComputation(io, boxVectors, true);
+    double expectedEnergy = pme1.finishComputation(io);
+    vector<float> expectedForce(io.force, io.force+4*numParticles);
+    for (int iteration = 0; iteration < 10; iteration++) {
+        pme2.beginComputation(io, boxVectors, true);
+        double energy = pme2.finishComputation(io);
+        ASSERT_EQUAL_TOL(expectedEnergy, energy, 1e-5);
+        for (int i = 0; i < numParticles; i++)
+            ASSERT_EQUAL_VEC(Vec3(expectedForce[4*i], expectedForce[4*i+1], expectedForce[4*i+2]), Vec3(io.force[4*i], io.force[4*i+1], io.force[4*i+2]), 1e-4);
+    }
+}
+
 int main(int argc, char* argv[]) {
     try {
         if (!CpuCalcPmeReciprocalForceKernel::isProcessorSupported()) {
             cout << "CPU is not supported.  Exiting." << endl;
             return 0;
         }
-        testPME(false);
-        testPME(true);
+        testPME(false, 0);
+        testPME(true, 0);
+        testPME(false, 1);
+        testPME(true, 3);
+        testWorkStealing();
     }
     catch(const exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -0,0 +1,175 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests using the CPU implementation of PME from the CPU platform, including computing reciprocal
+ * space at the same time as direct space.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "CpuPlatform.h"
+#include "ReferencePlatform.h"
+#include "../src/CpuPmeKernelFactory.h"
+#include "../src/CpuPmeKernels.h"
+#include "sfmt/SFMT.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Build a periodic box of charges placed on a jittered lattice.
+ */
+System* createSystem(vector<Vec3>& positions) {
+    const int gridSize = 8;
+    const int numParticles = 500;
+    const double boxSize = 3.0;
+    const double spacing = boxSize/gridSize;
+    System* system = new System();
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(1.0);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    positions.clear();
+    for (int i = 0; i < numParticles; i++) {
+        system->addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? -1.0 : 1.0, 0.3, 0.5);
+        Vec3 pos = Vec3(i%gridSize, (i/gridSize)%gridSize, i/(gridSize*gridSize))*spacing;
+        positions.push_back(pos+Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*0.05);
+    }
+    system->addForce(nonbonded);
+    return system;
+}
+
+void testPmeThreads(const string& pmeThreads) {
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    VerletIntegrator integrator3(0.001);
+    CpuPlatform cpu;
+    cpu.registerKernelFactory(CalcPmeReciprocalForceKernel::Name(), new CpuPmeKernelFactory());
+    vector<string> kernelNames;
+    kernelNames.push_back(CalcPmeReciprocalForceKernel::Name());
+    ASSERT(cpu.supportsKernels(kernelNames));
+    ReferencePlatform reference;
+
+    // Compare the results to computing direct and reciprocal space one after the other, which uses the same
+    // PME kernel, and to the Reference platform, which uses a different PME implementation.
+
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "3";
+    Context sequentialContext(*system, integrator2, cpu, properties);
+    properties[CpuPlatform::CpuPmeThreads()] = pmeThreads;
+    Context context(*system, integrator1, cpu, properties);
+    Context referenceContext(*system, integrator3, reference);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(1, sfmt);
+
+    // Evaluate the forces enough times for "auto" to try both ways of dividing the threads.  Move the
+    // particles a little each time so every evaluation is different.
+
+    for (int i = 0; i < 25; i++) {
+        for (int j = 0; j < (int) positions.size(); j++)
+            positions[j] += Vec3(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5)*0.01;
+        context.setPositions(positions);
+        sequentialContext.setPositions(positions);
+        referenceContext.setPositions(positions);
+        State state = context.getState(State::Forces | State::Energy);
+        State sequentialState = sequentialContext.getState(State::Forces | State::Energy);
+        State referenceState = referenceContext.getState(State::Forces | State::Energy);
+        ASSERT_EQUAL_TOL(sequentialState.getPotentialEnergy(), state.getPotentialEnergy(), 1e-5);
+        ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), state.getPotentialEnergy(), 1e-3);
+        for (int j = 0; j < system->getNumParticles(); j++) {
+            ASSERT_EQUAL_VEC(sequentialState.getForces()[j], state.getForces()[j], 1e-4);
+            ASSERT_EQUAL_VEC(referenceState.getForces()[j], state.getForces()[j], 5e-3);
+        }
+    }
+
+    // The property should still have the value that was specified.
+
+    ASSERT_EQUAL(pmeThreads, cpu.getPropertyValue(context, CpuPlatform::CpuPmeThreads()));
+    delete system;
+}
+
+void testPhaseTimes() {
+    vector<Vec3> positions;
+    System* system = createSystem(positions);
+    VerletIntegrator integrator(0.001);
+    CpuPlatform cpu;
+    cpu.registerKernelFactory(CalcPmeReciprocalForceKernel::Name(), new CpuPmeKernelFactory());
+    Context context(*system, integrator, cpu);
+    context.setPositions(positions);
+    context.setTimingEnabled(true);
+    const int numSteps = 5;
+    integrator.step(numSteps);
+
+    // Every force evaluation should record the time spent on each phase of the reciprocal space calculation.
+
+    const char* phases[] = {"PME spread charges", "PME forward FFT", "PME convolution", "PME backward FFT", "PME interpolate forces"};
+    for (int i = 0; i < 5; i++) {
+        int count;
+        double minTime, meanTime, maxTime;
+        context.getTimingStatistics(phases[i], count, minTime, meanTime, maxTime);
+        ASSERT(count >= numSteps);
+        ASSERT(minTime >= 0.0);
+        ASSERT(minTime <= meanTime);
+        ASSERT(meanTime <= maxTime);
+    }
+    delete system;
+}
+
+int main() {
+    try {
+        if (!CpuPlatform::isProcessorSupported() || !CpuCalcPmeReciprocalForceKernel::isProcessorSupported()) {
+            cout << "CPU is not supported.  Exiting." << endl;
+            return 0;
+        }
+        testPmeThreads("1");
+        testPmeThreads("2");
+        testPmeThreads("3");
+        testPmeThreads("auto");
+        testPhaseTimes();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -1,15 +1,16 @@
 #ifndef OPENMM_CUSTOM_INTEGRATOR_PROXY_H_
 #define OPENMM_CUSTOM_INTEGRATOR_PROXY_H_
 
+#include "openmm/serialization/IncrementalSerializationProxy.h"
 #include "openmm/serialization/XmlSerializer.h"
 
 namespace OpenMM {
 
-    class CustomIntegratorProxy : public SerializationProxy {
+    class CustomIntegratorProxy : public IncrementalSerializationProxy {
     public:
         CustomIntegratorProxy();
-        void serialize(const void* object, SerializationNode& node) const;
-        void* deserialize(const SerializationNode& node) const;
+        void serializeIncremental(const void* object, SerializationWriter& writer) const;
+        void* deserializeIncremental(SerializationReader& reader) const;
     };
 
 }
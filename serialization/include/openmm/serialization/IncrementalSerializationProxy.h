@@ -0,0 +1,68 @@
+#ifndef OPENMM_INCREMENTALSERIALIZATIONPROXY_H_
+#define OPENMM_INCREMENTALSERIALIZATIONPROXY_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/serialization/SerializationReader.h"
+#include "openmm/serialization/SerializationWriter.h"
+#include "openmm/internal/windowsExport.h"
+#include <string>
+
+namespace OpenMM {
+
+/**
+ * An IncrementalSerializationProxy is a SerializationProxy that describes objects through a SerializationWriter
+ * and reconstructs them through a SerializationReader.  Subclasses implement serializeIncremental() and
+ * deserializeIncremental(), and this class implements serialize() and deserialize() on top of them.
+ *
+ * This is intended for types whose serialized form can be very large, such as System and State.  XmlSerializer
+ * then writes and reads them directly, without ever holding a tree of SerializationNodes for the whole object.
+ */
+
+class OPENMM_EXPORT IncrementalSerializationProxy : public SerializationProxy {
+public:
+    /**
+     * Create a new IncrementalSerializationProxy.
+     *
+     * @param typeName     the name of the object type this proxy knows how to serialize
+     */
+    IncrementalSerializationProxy(const std::string& typeName);
+    void serialize(const void* object, SerializationNode& node) const;
+    void* deserialize(const SerializationNode& node) const;
+    virtual void serializeIncremental(const void* object, SerializationWriter& writer) const = 0;
+    virtual void* deserializeIncremental(SerializationReader& reader) const = 0;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_INCREMENTALSERIALIZATIONPROXY_H_*/
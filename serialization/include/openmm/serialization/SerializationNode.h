@@ -62,6 +62,12 @@ namespace OpenMM {
  * property as a string.  Similarly, you can use setStringProperty() to specify a property and then access it
  * using getIntProperty().  This will produce the expected result if the original value was, in fact, the
  * string representation of an int, but if the original string was non-numeric, the result is undefined.
+ *
+ * A node can also store "array properties", which are vectors of ints or doubles.  These are
+ * intended for the bulk per-element data of large objects, such as the parameters of every particle
+ * in a Force.  Storing each array as a single property is much faster and uses much less memory than
+ * creating a separate child node for every element.  Array properties are stored separately from
+ * ordinary properties, and must always be accessed with the same data type they were specified with.
  */
 
 class OPENMM_EXPORT SerializationNode {
@@ -196,6 +202,48 @@ public:
      * @param value  the value to set for the property
      */
     SerializationNode& setDoubleProperty(const std::string& name, double value);
+    /**
+     * Get a map containing all of this node's array properties whose elements are doubles.
+     */
+    const std::map<std::string, std::vector<double> >& getDoubleArrayProperties() const;
+    /**
+     * Get a map containing all of this node's array properties whose elements are ints.
+     */
+    const std::map<std::string, std::vector<int> >& getIntArrayProperties() const;
+    /**
+     * Determine whether this node has an array property (of either type) with a particular name.
+     *
+     * @param name  the name of the property to check for
+     */
+    bool hasArrayProperty(const std::string& name) const;
+    /**
+     * Get an array property whose elements are doubles.  If there is no such property with
+     * the specified name, an exception is thrown.
+     *
+     * @param name   the name of the property to get
+     */
+    const std::vector<double>& getDoubleArrayProperty(const std::string& name) const;
+    /**
+     * Set the value of an array property whose elements are doubles.
+     *
+     * @param name   the name of the property to set
+     * @param value  the value to set for the property
+     */
+    SerializationNode& setDoubleArrayProperty(const std::string& name, const std::vector<double>& value);
+    /**
+     * Get an array property whose elements are ints.  If there is no such property with
+     * the specified name, an exception is thrown.
+     *
+     * @param name   the name of the property to get
+     */
+    const std::vector<int>& getIntArrayProperty(const std::string& name) const;
+    /**
+     * Set the value of an array property whose elements are ints.
+     *
+     * @param name   the name of the property to set
+     * @param value  the value to set for the property
+     */
+    SerializationNode& setIntArrayProperty(const std::string& name, const std::vector<int>& value);
     /**
      * Create a new child node
      *
@@ -244,6 +292,8 @@ private:
     std::string name;
     std::vector<SerializationNode> children;
     std::map<std::string, std::string> properties;
+    std::map<std::string, std::vector<double> > doubleArrayProperties;
+    std::map<std::string, std::vector<int> > intArrayProperties;
 };
 
 } // namespace OpenMM
@@ -40,12 +40,19 @@
 namespace OpenMM {
 
 class SerializationNode;
+class SerializationReader;
+class SerializationWriter;
 
 /**
  * A SerializationProxy is an object that knows how to serialize and deserialize objects of a
  * particular type.  This is an abstract class.  Subclasses implement the logic for serializing
  * particular types of logic.
  *
+ * Serializers that write or read a stream one piece at a time use serializeIncremental() and
+ * deserializeIncremental() instead.  By default these build a complete SerializationNode and pass it to
+ * serialize() or deserialize(), so subclasses only need to implement the incremental versions if the
+ * objects they describe can be large.  See IncrementalSerializationProxy.
+ *
  * A global registry maintains the list of what SerializationProxy to use for each type of
  * object.  Call registerProxy() to register the proxy for a particular type.  This is typically
  * done at application startup or by a dynamic library's initialization code.
@@ -84,6 +91,23 @@ public:
      * of the object.
      */
     virtual void* deserialize(const SerializationNode& node) const = 0;
+    /**
+     * Write the description of an object to a SerializationWriter.  The default implementation calls
+     * serialize() to build a SerializationNode, then writes its contents.
+     *
+     * @param object      a pointer to the object being serialized
+     * @param writer      all data to be serialized should be written to this, as the contents of its current node
+     */
+    virtual void serializeIncremental(const void* object, SerializationWriter& writer) const;
+    /**
+     * Reconstruct an object by reading its description from a SerializationReader.  The default
+     * implementation reads the current node into a SerializationNode, then calls deserialize().
+     *
+     * @param reader  a SerializationReader whose current node contains the object's description
+     * @return a pointer to a new object created from the data.  The caller assumes ownership
+     * of the object.
+     */
+    virtual void* deserializeIncremental(SerializationReader& reader) const;
     /**
      * Register a SerializationProxy to be used for objects of a particular type.
      *
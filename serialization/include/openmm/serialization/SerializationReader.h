@@ -0,0 +1,209 @@
+#ifndef OPENMM_SERIALIZATIONREADER_H_
+#define OPENMM_SERIALIZATIONREADER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/SerializationNode.h"
+#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/internal/windowsExport.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * A SerializationReader supplies the description of an object one piece at a time.  It describes the same
+ * tree of nodes, properties, and array properties as SerializationNode, but instead of the whole tree being
+ * read into memory first, each piece is read from the input only when it is requested.  This keeps the memory
+ * used by deserialization independent of the size of the input.
+ *
+ * The reader always has a current node, whose name and ordinary properties are available as soon as it becomes
+ * the current node.  Its contents are visited in order by calling nextChild().  Each array property is visited
+ * like a child node whose name is the name of the property.  isDoubleArray() or isIntArray() identifies it, and
+ * its values are read one at a time with readDoubleArrayValue() or readIntArrayValue().  Every call to nextChild()
+ * that returns true must be matched by a call to endNode(), which skips whatever was not read and makes the
+ * parent the current node again.
+ *
+ * This is an abstract class.  Subclasses implement it for particular input formats.
+ */
+
+class OPENMM_EXPORT SerializationReader {
+public:
+    virtual ~SerializationReader() {
+    }
+    /**
+     * Get the name of the current node.
+     */
+    const std::string& getName() const;
+    /**
+     * Get a map containing all ordinary properties of the current node.
+     */
+    const std::map<std::string, std::string>& getProperties() const;
+    /**
+     * Determine whether the current node has a property with a particular name.
+     *
+     * @param name     the name of the property to check for
+     */
+    bool hasProperty(const std::string& name) const;
+    /**
+     * Get the property of the current node with a particular name, specified as a string.  If there is
+     * no property with the specified name, an exception is thrown.
+     *
+     * @param name     the name of the property to get
+     */
+    const std::string& getStringProperty(const std::string& name) const;
+    /**
+     * Get the property of the current node with a particular name, specified as a string.  If there is
+     * no property with the specified name, a default value is returned instead.
+     *
+     * @param name          the name of the property to get
+     * @param defaultValue  the value to return if the specified property does not exist
+     */
+    const std::string& getStringProperty(const std::string& name, const std::string& defaultValue) const;
+    /**
+     * Get the property of the current node with a particular name, specified as an int.  If there is
+     * no property with the specified name, an exception is thrown.
+     *
+     * @param name     the name of the property to get
+     */
+    int getIntProperty(const std::string& name) const;
+    /**
+     * Get the property of the current node with a particular name, specified as an int.  If there is
+     * no property with the specified name, a default value is returned instead.
+     *
+     * @param name          the name of the property to get
+     * @param defaultValue  the value to return if the specified property does not exist
+     */
+    int getIntProperty(const std::string& name, int defaultValue) const;
+    /**
+     * Get the property of the current node with a particular name, specified as a bool.  If there is
+     * no property with the specified name, an exception is thrown.
+     *
+     * @param name     the name of the property to get
+     */
+    bool getBoolProperty(const std::string& name) const;
+    /**
+     * Get the property of the current node with a particular name, specified as a bool.  If there is
+     * no property with the specified name, a default value is returned instead.
+     *
+     * @param name          the name of the property to get
+     * @param defaultValue  the value to return if the specified property does not exist
+     */
+    bool getBoolProperty(const std::string& name, bool defaultValue) const;
+    /**
+     * Get the property of the current node with a particular name, specified as a double.  If there is
+     * no property with the specified name, an exception is thrown.
+     *
+     * @param name     the name of the property to get
+     */
+    double getDoubleProperty(const std::string& name) const;
+    /**
+     * Get the property of the current node with a particular name, specified as a double.  If there is
+     * no property with the specified name, a default value is returned instead.
+     *
+     * @param name          the name of the property to get
+     * @param defaultValue  the value to return if the specified property does not exist
+     */
+    double getDoubleProperty(const std::string& name, double defaultValue) const;
+    /**
+     * Advance to the next child node or array property of the current node, and make it the current node.
+     *
+     * @return true if there was another child, or false if all the contents of the current node have been visited.
+     * In that case, the current node does not change.
+     */
+    virtual bool nextChild() = 0;
+    /**
+     * Skip the rest of the current node, and make its parent the current node again.
+     */
+    virtual void endNode() = 0;
+    /**
+     * Get whether the current node is an array property of doubles.
+     */
+    virtual bool isDoubleArray() const = 0;
+    /**
+     * Get whether the current node is an array property of ints.
+     */
+    virtual bool isIntArray() const = 0;
+    /**
+     * Read the next value of the current array property, which must be an array of doubles.
+     *
+     * @param value    the value that was read is stored into this
+     * @return true if a value was read, or false if the end of the array was reached
+     */
+    virtual bool readDoubleArrayValue(double& value) = 0;
+    /**
+     * Read the next value of the current array property, which must be an array of ints.
+     *
+     * @param value    the value that was read is stored into this
+     * @return true if a value was read, or false if the end of the array was reached
+     */
+    virtual bool readIntArrayValue(int& value) = 0;
+    /**
+     * Read all remaining values of the current array property, which must be an array of doubles.
+     *
+     * @param values    the values are stored into this
+     */
+    void readDoubleArray(std::vector<double>& values);
+    /**
+     * Read all remaining values of the current array property, which must be an array of ints.
+     *
+     * @param values    the values are stored into this
+     */
+    void readIntArray(std::vector<int>& values);
+    /**
+     * Copy the name, properties, and all remaining contents of the current node into a SerializationNode.
+     * This does not call endNode().
+     *
+     * @param node    the node to copy the information into
+     */
+    void readNode(SerializationNode& node);
+    /**
+     * Reconstruct an object from the current node, using the SerializationProxy selected by its "type"
+     * property.  This does not call endNode().
+     *
+     * @return a pointer to a new object created from the data.  The caller assumes ownership of the object.
+     */
+    template <class T>
+    T* readObject() {
+        return reinterpret_cast<T*>(SerializationProxy::getProxy(getStringProperty("type")).deserializeIncremental(*this));
+    }
+protected:
+    /**
+     * Get a SerializationNode containing the name and ordinary properties of the current node.
+     */
+    virtual const SerializationNode& getPropertyNode() const = 0;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_SERIALIZATIONREADER_H_*/
@@ -0,0 +1,175 @@
+#ifndef OPENMM_SERIALIZATIONWRITER_H_
+#define OPENMM_SERIALIZATIONWRITER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/SerializationNode.h"
+#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/internal/windowsExport.h"
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * A SerializationWriter receives the description of an object one piece at a time.  It describes the same
+ * tree of nodes, properties, and array properties as SerializationNode, but instead of the whole tree being
+ * built in memory first, each piece can be written to the output as soon as it is received.  This keeps the
+ * memory used by serialization independent of the size of the object.
+ *
+ * The writer always has a current node.  beginNode() creates a child of the current node and makes it the
+ * current node, and endNode() makes its parent the current node again.  All ordinary properties of a node
+ * must be set before any child nodes or array properties are added to it.  The values of an array property
+ * are written one at a time between a call to beginDoubleArray() or beginIntArray() and a call to endArray().
+ *
+ * This is an abstract class.  Subclasses implement it for particular output formats.
+ */
+
+class OPENMM_EXPORT SerializationWriter {
+public:
+    virtual ~SerializationWriter() {
+    }
+    /**
+     * Set the value of a property of the current node, specified as a string.
+     *
+     * @param name     the name of the property to set
+     * @param value    the value to set for the property
+     */
+    SerializationWriter& setStringProperty(const std::string& name, const std::string& value);
+    /**
+     * Set the value of a property of the current node, specified as an int.
+     *
+     * @param name     the name of the property to set
+     * @param value    the value to set for the property
+     */
+    SerializationWriter& setIntProperty(const std::string& name, int value);
+    /**
+     * Set the value of a property of the current node, specified as a bool.
+     *
+     * @param name     the name of the property to set
+     * @param value    the value to set for the property
+     */
+    SerializationWriter& setBoolProperty(const std::string& name, bool value);
+    /**
+     * Set the value of a property of the current node, specified as a double.
+     *
+     * @param name     the name of the property to set
+     * @param value    the value to set for the property
+     */
+    SerializationWriter& setDoubleProperty(const std::string& name, double value);
+    /**
+     * Create a new child of the current node, and make it the current node.
+     *
+     * @param name    the name of the new node
+     */
+    virtual void beginNode(const std::string& name) = 0;
+    /**
+     * Finish the current node, and make its parent the current node again.
+     */
+    virtual void endNode() = 0;
+    /**
+     * Begin writing an array property of doubles.  Its values are then passed to writeDoubleArrayValue(),
+     * followed by a call to endArray().
+     *
+     * @param name    the name of the array property
+     */
+    virtual void beginDoubleArray(const std::string& name) = 0;
+    /**
+     * Begin writing an array property of ints.  Its values are then passed to writeIntArrayValue(),
+     * followed by a call to endArray().
+     *
+     * @param name    the name of the array property
+     */
+    virtual void beginIntArray(const std::string& name) = 0;
+    /**
+     * Write the next value of the array property begun by beginDoubleArray().
+     */
+    virtual void writeDoubleArrayValue(double value) = 0;
+    /**
+     * Write the next value of the array property begun by beginIntArray().
+     */
+    virtual void writeIntArrayValue(int value) = 0;
+    /**
+     * Finish the current array property.
+     */
+    virtual void endArray() = 0;
+    /**
+     * Write a complete array property of doubles.
+     *
+     * @param name     the name of the array property
+     * @param values   the values of the array property
+     */
+    SerializationWriter& setDoubleArrayProperty(const std::string& name, const std::vector<double>& values);
+    /**
+     * Write a complete array property of ints.
+     *
+     * @param name     the name of the array property
+     * @param values   the values of the array property
+     */
+    SerializationWriter& setIntArrayProperty(const std::string& name, const std::vector<int>& values);
+    /**
+     * Write the properties, array properties, and children of a SerializationNode as the contents of the
+     * current node.
+     */
+    void writeNodeContents(const SerializationNode& node);
+    /**
+     * Write a child node that describes another object.  Its SerializationProxy is selected based on
+     * the object's type, and a "type" property is recorded so it can be found again during deserialization.
+     *
+     * @param name     the name of the new node
+     * @param object   the object to describe
+     */
+    template <class T>
+    void writeObject(const std::string& name, const T* object) {
+        writeObject(name, object, SerializationProxy::getProxy(typeid(*object)));
+    }
+    /**
+     * Write a child node that describes another object, using a specified SerializationProxy.
+     *
+     * @param name     the name of the new node
+     * @param object   the object to describe
+     * @param proxy    the proxy to use for serializing the object
+     */
+    void writeObject(const std::string& name, const void* object, const SerializationProxy& proxy);
+protected:
+    /**
+     * Get a SerializationNode to record the ordinary properties of the current node in.  Subclasses should throw
+     * an exception if children or array properties have already been added to the current node.
+     */
+    virtual SerializationNode& getPropertyNode() = 0;
+private:
+    SerializationNode& getNodeForNewProperty(const std::string& name);
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_SERIALIZATIONWRITER_H_*/
@@ -1,15 +1,16 @@
 #ifndef STATE_PROXY_H_
 #define STATE_PROXY_H_
 
+#include "openmm/serialization/IncrementalSerializationProxy.h"
 #include "openmm/serialization/XmlSerializer.h"
 
 namespace OpenMM { // needs to be for friend class to work
 
-class StateProxy : public SerializationProxy {
+class StateProxy : public IncrementalSerializationProxy {
 public:
     StateProxy();
-    void serialize(const void* object, SerializationNode& node) const;
-    void* deserialize(const SerializationNode& node) const;
+    void serializeIncremental(const void* object, SerializationWriter& writer) const;
+    void* deserializeIncremental(SerializationReader& reader) const;
 };
 
 }
@@ -33,7 +33,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "openmm/internal/windowsExport.h"
-#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/serialization/IncrementalSerializationProxy.h"
 
 namespace OpenMM {
 
@@ -41,11 +41,11 @@ namespace OpenMM {
  * This is a proxy for serializing System objects.
  */
 
-class OPENMM_EXPORT SystemProxy : public SerializationProxy {
+class OPENMM_EXPORT SystemProxy : public IncrementalSerializationProxy {
 public:
     SystemProxy();
-    void serialize(const void* object, SerializationNode& node) const;
-    void* deserialize(const SerializationNode& node) const;
+    void serializeIncremental(const void* object, SerializationWriter& writer) const;
+    void* deserializeIncremental(SerializationReader& reader) const;
 };
 
 } // namespace OpenMM
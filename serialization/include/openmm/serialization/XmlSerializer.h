@@ -42,6 +42,15 @@ namespace OpenMM {
 
 /**
  * XmlSerializer is used for serializing objects as XML, and for reconstructing them again.
+ *
+ * Array properties of a SerializationNode are written as omm:DoubleArray or omm:IntArray child elements,
+ * whose text is the list of values separated by spaces.  The omm namespace is declared on the root element,
+ * so these never collide with child nodes.  Node names beginning with "omm:" are reserved.
+ *
+ * The XML is written and parsed one piece at a time, through a SerializationWriter and a SerializationReader.
+ * Objects whose SerializationProxy describes them incrementally, such as System and State, are therefore
+ * never held in memory as a complete tree of SerializationNodes.  Other objects are converted to and from
+ * a SerializationNode one at a time.
  */
 
 class OPENMM_EXPORT XmlSerializer {
@@ -55,14 +64,7 @@ public:
      */
     template <class T>
     static void serialize(const T* object, const std::string& rootName, std::ostream& stream) {
-        const SerializationProxy& proxy = SerializationProxy::getProxy(typeid(*object));
-        SerializationNode node;
-        node.setName(rootName);
-        proxy.serialize(object, node);
-        if (node.hasProperty("type"))
-            throw OpenMMException(proxy.getTypeName()+" created node with reserved property 'type'");
-        node.setStringProperty("type", proxy.getTypeName());
-        serialize(node, stream);
+        serializeObject(object, SerializationProxy::getProxy(typeid(*object)), rootName, stream);
     }
     /**
      * Reconstruct an object that has been serialized as XML.
@@ -87,10 +89,8 @@ public:
         return reinterpret_cast<T*>(proxy.deserialize(node));
     }
 private:
-    class StreamReader;
-    static void serialize(const SerializationNode& node, std::ostream& stream);
+    static void serializeObject(const void* object, const SerializationProxy& proxy, const std::string& rootName, std::ostream& stream);
     static void* deserializeStream(std::istream& stream);
-    static void encodeNode(const SerializationNode& node, std::ostream& stream, int depth);
 };
 
 } // namespace OpenMM
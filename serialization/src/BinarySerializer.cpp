@@ -0,0 +1,500 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/BinarySerializer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+
+using namespace OpenMM;
+using namespace std;
+
+extern "C" char* g_fmt(char*, double);
+extern "C" double strtod2(const char* s00, char** se);
+
+static const char MAGIC[4] = {'O', 'M', 'M', 'B'};
+static const int FORMAT_VERSION = 1;
+
+// Each group of children is stored either as a single node or as a table of leaf nodes.
+
+static const int NODE_RUN = 0;
+static const int TABLE_RUN = 1;
+
+// The types a property value or a column of a table can be stored as.
+
+static const int STRING_VALUE = 0;
+static const int INT_VALUE = 1;
+static const int DOUBLE_VALUE = 2;
+
+/**
+ * This wraps the stream being read, and keeps track of how many bytes are left in it so lengths
+ * read from the stream can be checked before any memory is allocated for them.
+ */
+class InputStream {
+public:
+    InputStream(istream& stream) : stream(stream), remaining(-1) {
+        streampos start = stream.tellg();
+        if (start != streampos(-1)) {
+            stream.seekg(0, ios::end);
+            streampos end = stream.tellg();
+            stream.seekg(start);
+            if (end != streampos(-1))
+                remaining = end-start;
+        }
+    }
+    void read(char* buffer, size_t length) {
+        stream.read(buffer, length);
+        if ((size_t) stream.gcount() != length)
+            throw OpenMMException("BinarySerializer: Unexpected end of stream");
+        if (remaining >= 0)
+            remaining -= length;
+    }
+    /**
+     * Check that the stream is large enough to hold a number of items, each of which takes up
+     * at least bytesPerItem bytes.  If the size of the stream is unknown, this does nothing.
+     */
+    void checkLength(unsigned int numItems, int bytesPerItem) const {
+        if (remaining >= 0 && (long long) numItems*bytesPerItem > remaining)
+            throw OpenMMException("BinarySerializer: Invalid length");
+    }
+private:
+    istream& stream;
+    long long remaining;
+};
+
+static void writeUInt32(ostream& stream, unsigned int value) {
+    char bytes[4] = {(char) (value&0xFF), (char) ((value>>8)&0xFF), (char) ((value>>16)&0xFF), (char) ((value>>24)&0xFF)};
+    stream.write(bytes, 4);
+}
+
+static void writeByte(ostream& stream, int value) {
+    char byte = (char) value;
+    stream.write(&byte, 1);
+}
+
+static void writeString(ostream& stream, const string& value) {
+    writeUInt32(stream, value.size());
+    stream.write(value.c_str(), value.size());
+}
+
+static unsigned int readUInt32(InputStream& stream) {
+    unsigned char bytes[4];
+    stream.read((char*) bytes, 4);
+    return bytes[0] | (bytes[1]<<8) | (bytes[2]<<16) | ((unsigned int) bytes[3]<<24);
+}
+
+/**
+ * Read a count of items from the stream, checking that there is room left in it for that many items.
+ */
+static int readLength(InputStream& stream, int bytesPerItem) {
+    unsigned int length = readUInt32(stream);
+    if (length > (unsigned int) numeric_limits<int>::max())
+        throw OpenMMException("BinarySerializer: Invalid length");
+    stream.checkLength(length, bytesPerItem);
+    return (int) length;
+}
+
+static int readByte(InputStream& stream) {
+    unsigned char byte;
+    stream.read((char*) &byte, 1);
+    return byte;
+}
+
+static void readString(InputStream& stream, string& value) {
+    int length = readLength(stream, 1);
+    value.resize(length);
+    if (length > 0)
+        stream.read(&value[0], length);
+}
+
+/**
+ * Determine whether a string is exactly the text SerializationNode::setIntProperty() would produce for some int.
+ */
+static bool isIntString(const string& value, int& result) {
+    if (value.size() == 0 || value.size() > 11)
+        return false;
+    char* end;
+    long parsed = strtol(value.c_str(), &end, 10);
+    if (*end != 0 || parsed < numeric_limits<int>::min() || parsed > numeric_limits<int>::max())
+        return false;
+    char buffer[16];
+    sprintf(buffer, "%d", (int) parsed);
+    if (value != buffer)
+        return false;
+    result = (int) parsed;
+    return true;
+}
+
+/**
+ * Determine whether a string is exactly the text SerializationNode::setDoubleProperty() would produce for some double.
+ */
+static bool isDoubleString(const string& value, double& result) {
+    if (value.size() == 0 || value.size() > 31)
+        return false;
+    char* end;
+    double parsed = strtod2(value.c_str(), &end);
+    if (*end != 0)
+        return false;
+    char buffer[32];
+    g_fmt(buffer, parsed);
+    if (value != buffer)
+        return false;
+    result = parsed;
+    return true;
+}
+
+/**
+ * Determine whether two nodes can be stored in the same table.
+ */
+static bool haveSameLayout(const SerializationNode& node1, const SerializationNode& node2) {
+    if (node1.getName() != node2.getName() || node1.getChildren().size() != 0 || node2.getChildren().size() != 0)
+        return false;
+    if (node1.getDoubleArrayProperties().size() != 0 || node1.getIntArrayProperties().size() != 0 ||
+            node2.getDoubleArrayProperties().size() != 0 || node2.getIntArrayProperties().size() != 0)
+        return false;
+    const map<string, string>& props1 = node1.getProperties();
+    const map<string, string>& props2 = node2.getProperties();
+    if (props1.size() != props2.size())
+        return false;
+    for (map<string, string>::const_iterator iter1 = props1.begin(), iter2 = props2.begin(); iter1 != props1.end(); ++iter1, ++iter2)
+        if (iter1->first != iter2->first)
+            return false;
+    return true;
+}
+
+static void writeInts(ostream& stream, const int* values, int length, vector<char>& buffer) {
+    if (length == 0)
+        return;
+    buffer.resize(4*length);
+    for (int i = 0; i < length; i++) {
+        unsigned int value = (unsigned int) values[i];
+        for (int j = 0; j < 4; j++)
+            buffer[4*i+j] = (char) ((value>>(8*j))&0xFF);
+    }
+    stream.write(&buffer[0], buffer.size());
+}
+
+static void writeDoubles(ostream& stream, const double* values, int length, vector<char>& buffer) {
+    if (length == 0)
+        return;
+    buffer.resize(8*length);
+    for (int i = 0; i < length; i++) {
+        unsigned long long value;
+        memcpy(&value, &values[i], 8);
+        for (int j = 0; j < 8; j++)
+            buffer[8*i+j] = (char) ((value>>(8*j))&0xFF);
+    }
+    stream.write(&buffer[0], buffer.size());
+}
+
+static void readInts(InputStream& stream, int* values, int length, vector<unsigned char>& buffer) {
+    if (length == 0)
+        return;
+    buffer.resize(4*length);
+    stream.read((char*) &buffer[0], buffer.size());
+    for (int i = 0; i < length; i++) {
+        unsigned int bits = 0;
+        for (int j = 0; j < 4; j++)
+            bits |= ((unsigned int) buffer[4*i+j])<<(8*j);
+        values[i] = (int) bits;
+    }
+}
+
+static void readDoubles(InputStream& stream, double* values, int length, vector<unsigned char>& buffer) {
+    if (length == 0)
+        return;
+    buffer.resize(8*length);
+    stream.read((char*) &buffer[0], buffer.size());
+    for (int i = 0; i < length; i++) {
+        unsigned long long bits = 0;
+        for (int j = 0; j < 8; j++)
+            bits |= ((unsigned long long) buffer[8*i+j])<<(8*j);
+        memcpy(&values[i], &bits, 8);
+    }
+}
+
+/**
+ * Write a property value as a type code followed by the value, using a binary int or double whenever
+ * that reproduces the value exactly.
+ */
+static void writeValue(ostream& stream, const string& value, vector<char>& buffer) {
+    int intValue;
+    double doubleValue;
+    if (isIntString(value, intValue)) {
+        writeByte(stream, INT_VALUE);
+        writeInts(stream, &intValue, 1, buffer);
+    }
+    else if (isDoubleString(value, doubleValue)) {
+        writeByte(stream, DOUBLE_VALUE);
+        writeDoubles(stream, &doubleValue, 1, buffer);
+    }
+    else {
+        writeByte(stream, STRING_VALUE);
+        writeString(stream, value);
+    }
+}
+
+/**
+ * Read a value written by writeValue().  SerializationNode stores all properties as text, so binary
+ * values are converted to exactly the text setIntProperty() or setDoubleProperty() would produce.
+ */
+static void readValue(InputStream& stream, string& value, vector<unsigned char>& buffer) {
+    int type = readByte(stream);
+    char text[32];
+    if (type == INT_VALUE) {
+        int intValue;
+        readInts(stream, &intValue, 1, buffer);
+        sprintf(text, "%d", intValue);
+        value = text;
+    }
+    else if (type == DOUBLE_VALUE) {
+        double doubleValue;
+        readDoubles(stream, &doubleValue, 1, buffer);
+        g_fmt(text, doubleValue);
+        value = text;
+    }
+    else if (type == STRING_VALUE)
+        readString(stream, value);
+    else
+        throw OpenMMException("BinarySerializer: Illegal value type");
+}
+
+static void encodeNode(const SerializationNode& node, ostream& stream);
+
+/**
+ * Write a table containing the nodes children[start] through children[end-1], which all have the same layout.
+ */
+static void encodeTable(const vector<SerializationNode>& children, int start, int end, ostream& stream) {
+    int numRows = end-start;
+    const map<string, string>& firstProps = children[start].getProperties();
+    writeString(stream, children[start].getName());
+    writeUInt32(stream, numRows);
+    writeUInt32(stream, firstProps.size());
+    vector<const string*> values(numRows);
+    vector<int> intValues(numRows);
+    vector<double> doubleValues(numRows);
+    vector<char> buffer;
+    for (map<string, string>::const_iterator column = firstProps.begin(); column != firstProps.end(); ++column) {
+        writeString(stream, column->first);
+        for (int i = 0; i < numRows; i++)
+            values[i] = &children[start+i].getProperties().find(column->first)->second;
+
+        // Select the most compact type that reproduces every value exactly.
+
+        bool allInts = true, allDoubles = true;
+        for (int i = 0; i < numRows && allInts; i++)
+            allInts = isIntString(*values[i], intValues[i]);
+        if (!allInts)
+            for (int i = 0; i < numRows && allDoubles; i++)
+                allDoubles = isDoubleString(*values[i], doubleValues[i]);
+        if (allInts) {
+            writeByte(stream, INT_VALUE);
+            writeInts(stream, &intValues[0], numRows, buffer);
+        }
+        else if (allDoubles) {
+            writeByte(stream, DOUBLE_VALUE);
+            writeDoubles(stream, &doubleValues[0], numRows, buffer);
+        }
+        else {
+            writeByte(stream, STRING_VALUE);
+            for (int i = 0; i < numRows; i++)
+                writeString(stream, *values[i]);
+        }
+    }
+}
+
+static void encodeNode(const SerializationNode& node, ostream& stream) {
+    writeString(stream, node.getName());
+    vector<char> buffer;
+    const map<string, string>& properties = node.getProperties();
+    writeUInt32(stream, properties.size());
+    for (map<string, string>::const_iterator iter = properties.begin(); iter != properties.end(); ++iter) {
+        writeString(stream, iter->first);
+        writeValue(stream, iter->second, buffer);
+    }
+    const map<string, vector<double> >& doubleArrays = node.getDoubleArrayProperties();
+    writeUInt32(stream, doubleArrays.size());
+    for (map<string, vector<double> >::const_iterator iter = doubleArrays.begin(); iter != doubleArrays.end(); ++iter) {
+        writeString(stream, iter->first);
+        writeUInt32(stream, iter->second.size());
+        if (iter->second.size() > 0)
+            writeDoubles(stream, &iter->second[0], iter->second.size(), buffer);
+    }
+    const map<string, vector<int> >& intArrays = node.getIntArrayProperties();
+    writeUInt32(stream, intArrays.size());
+    for (map<string, vector<int> >::const_iterator iter = intArrays.begin(); iter != intArrays.end(); ++iter) {
+        writeString(stream, iter->first);
+        writeUInt32(stream, iter->second.size());
+        if (iter->second.size() > 0)
+            writeInts(stream, &iter->second[0], iter->second.size(), buffer);
+    }
+
+    // Divide the children into runs that can be stored as tables.
+
+    const vector<SerializationNode>& children = node.getChildren();
+    vector<int> runStart;
+    for (int i = 0; i < (int) children.size(); ) {
+        runStart.push_back(i);
+        int j = i+1;
+        while (j < (int) children.size() && haveSameLayout(children[i], children[j]))
+            j++;
+        i = j;
+    }
+    runStart.push_back(children.size());
+    writeUInt32(stream, runStart.size()-1);
+    for (int i = 0; i < (int) runStart.size()-1; i++) {
+        if (runStart[i+1]-runStart[i] > 1) {
+            writeByte(stream, TABLE_RUN);
+            encodeTable(children, runStart[i], runStart[i+1], stream);
+        }
+        else {
+            writeByte(stream, NODE_RUN);
+            encodeNode(children[runStart[i]], stream);
+        }
+    }
+}
+
+static void decodeNode(SerializationNode& node, InputStream& stream);
+
+static void decodeTable(SerializationNode& node, InputStream& stream) {
+    string name;
+    readString(stream, name);
+    int numRows = readLength(stream, 0);
+    int numColumns = readLength(stream, 5);
+
+    // Every row takes up at least four bytes in each column.
+
+    if (numColumns > 0)
+        stream.checkLength(numRows, 4*numColumns);
+    vector<SerializationNode>& children = node.getChildren();
+    int firstRow = children.size();
+    children.reserve(firstRow+numRows);
+    for (int i = 0; i < numRows; i++)
+        node.createChildNode(name);
+    string key, value;
+    vector<unsigned char> buffer;
+    vector<int> intValues(numRows);
+    vector<double> doubleValues(numRows);
+    char text[32];
+    for (int column = 0; column < numColumns; column++) {
+        readString(stream, key);
+        int type = readByte(stream);
+        if (type == INT_VALUE) {
+            readInts(stream, &intValues[0], numRows, buffer);
+            for (int i = 0; i < numRows; i++) {
+                sprintf(text, "%d", intValues[i]);
+                children[firstRow+i].setStringProperty(key, text);
+            }
+        }
+        else if (type == DOUBLE_VALUE) {
+            readDoubles(stream, &doubleValues[0], numRows, buffer);
+            for (int i = 0; i < numRows; i++) {
+                g_fmt(text, doubleValues[i]);
+                children[firstRow+i].setStringProperty(key, text);
+            }
+        }
+        else if (type == STRING_VALUE) {
+            for (int i = 0; i < numRows; i++) {
+                readString(stream, value);
+                children[firstRow+i].setStringProperty(key, value);
+            }
+        }
+        else
+            throw OpenMMException("BinarySerializer: Illegal column type");
+    }
+}
+
+static void decodeNode(SerializationNode& node, InputStream& stream) {
+    string name, key, value;
+    readString(stream, name);
+    node.setName(name);
+    vector<unsigned char> buffer;
+    int numProperties = readLength(stream, 9);
+    for (int i = 0; i < numProperties; i++) {
+        readString(stream, key);
+        readValue(stream, value, buffer);
+        node.setStringProperty(key, value);
+    }
+    int numDoubleArrays = readLength(stream, 8);
+    for (int i = 0; i < numDoubleArrays; i++) {
+        readString(stream, key);
+        vector<double> values(readLength(stream, 8));
+        if (values.size() > 0)
+            readDoubles(stream, &values[0], values.size(), buffer);
+        node.setDoubleArrayProperty(key, values);
+    }
+    int numIntArrays = readLength(stream, 8);
+    for (int i = 0; i < numIntArrays; i++) {
+        readString(stream, key);
+        vector<int> values(readLength(stream, 4));
+        if (values.size() > 0)
+            readInts(stream, &values[0], values.size(), buffer);
+        node.setIntArrayProperty(key, values);
+    }
+    int numRuns = readLength(stream, 13);
+    for (int i = 0; i < numRuns; i++) {
+        int type = readByte(stream);
+        if (type == NODE_RUN)
+            decodeNode(node.createChildNode(""), stream);
+        else if (type == TABLE_RUN)
+            decodeTable(node, stream);
+        else
+            throw OpenMMException("BinarySerializer: Illegal node type");
+    }
+}
+
+void BinarySerializer::serialize(const SerializationNode& node, std::ostream& stream) {
+    stream.write(MAGIC, 4);
+    writeUInt32(stream, FORMAT_VERSION);
+    encodeNode(node, stream);
+}
+
+void BinarySerializer::deserialize(SerializationNode& node, std::istream& stream) {
+    InputStream input(stream);
+    char magic[4];
+    input.read(magic, 4);
+    if (memcmp(magic, MAGIC, 4) != 0)
+        throw OpenMMException("BinarySerializer: The stream does not contain binary serialized data");
+    if (readUInt32(input) != FORMAT_VERSION)
+        throw OpenMMException("BinarySerializer: Unsupported format version");
+    node = SerializationNode();
+    decodeNode(node, input);
+}
+
+void* BinarySerializer::deserializeStream(std::istream& stream) {
+    SerializationNode root;
+    deserialize(root, stream);
+    const SerializationProxy& proxy = SerializationProxy::getProxy(root.getStringProperty("type"));
+    return proxy.deserialize(root);
+}
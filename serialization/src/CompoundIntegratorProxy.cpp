@@ -35,23 +35,26 @@
 using namespace std;
 using namespace OpenMM;
 
-CompoundIntegratorProxy::CompoundIntegratorProxy() : SerializationProxy("CompoundIntegrator") {
+CompoundIntegratorProxy::CompoundIntegratorProxy() : IncrementalSerializationProxy("CompoundIntegrator") {
 }
 
-void CompoundIntegratorProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+void CompoundIntegratorProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 1);
     const CompoundIntegrator& integrator = *reinterpret_cast<const CompoundIntegrator*>(object);
-    node.setIntProperty("currentIntegrator", integrator.getCurrentIntegrator());
+    writer.setIntProperty("currentIntegrator", integrator.getCurrentIntegrator());
     for (int i = 0; i < integrator.getNumIntegrators(); i++)
-        node.createChildNode("Integrator", &integrator.getIntegrator(i));
+        writer.writeObject("Integrator", &integrator.getIntegrator(i));
 }
 
-void* CompoundIntegratorProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* CompoundIntegratorProxy::deserializeIncremental(SerializationReader& reader) const {
+    if (reader.getIntProperty("version") != 1)
         throw OpenMMException("Unsupported version number");
+    int currentIntegrator = reader.getIntProperty("currentIntegrator");
     CompoundIntegrator *integrator = new CompoundIntegrator();
-    for (int i = 0; i < node.getChildren().size(); i++)
-        integrator->addIntegrator(node.getChildren()[i].decodeObject<Integrator>());
-    integrator->setCurrentIntegrator(node.getIntProperty("currentIntegrator"));
+    while (reader.nextChild()) {
+        integrator->addIntegrator(reader.readObject<Integrator>());
+        reader.endNode();
+    }
+    integrator->setCurrentIntegrator(currentIntegrator);
     return integrator;
 }
\ No newline at end of file
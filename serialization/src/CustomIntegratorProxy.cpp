@@ -35,84 +35,97 @@
 using namespace std;
 using namespace OpenMM;
 
-CustomIntegratorProxy::CustomIntegratorProxy() : SerializationProxy("CustomIntegrator") {
+CustomIntegratorProxy::CustomIntegratorProxy() : IncrementalSerializationProxy("CustomIntegrator") {
 
 }
 
-void CustomIntegratorProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+void CustomIntegratorProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 1);
     const CustomIntegrator& integrator = *reinterpret_cast<const CustomIntegrator*>(object);
-    SerializationNode& globalVariablesNode = node.createChildNode("GlobalVariables");
+    writer.setStringProperty("kineticEnergyExpression",integrator.getKineticEnergyExpression());
+    writer.setIntProperty("randomSeed",integrator.getRandomNumberSeed());
+    writer.setDoubleProperty("stepSize",integrator.getStepSize());
+    writer.setDoubleProperty("constraintTolerance",integrator.getConstraintTolerance());
+    writer.beginNode("GlobalVariables");
     for(int i=0; i<integrator.getNumGlobalVariables(); i++) {
-        globalVariablesNode.setDoubleProperty(integrator.getGlobalVariableName(i), integrator.getGlobalVariable(i));
+        writer.setDoubleProperty(integrator.getGlobalVariableName(i), integrator.getGlobalVariable(i));
     }
-    SerializationNode& perDofVariablesNode = node.createChildNode("PerDofVariables");
+    writer.endNode();
+    writer.beginNode("PerDofVariables");
     for(int i=0; i<integrator.getNumPerDofVariables(); i++) {
-        SerializationNode& perDofValuesNode = perDofVariablesNode.createChildNode(integrator.getPerDofVariableName(i));
+        writer.beginNode(integrator.getPerDofVariableName(i));
         vector<Vec3> perDofValues; integrator.getPerDofVariable(i, perDofValues);
         for(int j=0; j<perDofValues.size(); j++) {
-            perDofValuesNode.createChildNode("Value").setDoubleProperty("x",perDofValues[j][0]).setDoubleProperty("y",perDofValues[j][1]).setDoubleProperty("z",perDofValues[j][2]);
+            writer.beginNode("Value");
+            writer.setDoubleProperty("x",perDofValues[j][0]).setDoubleProperty("y",perDofValues[j][1]).setDoubleProperty("z",perDofValues[j][2]);
+            writer.endNode();
         }
+        writer.endNode();
     }
-    SerializationNode& computationsNode = node.createChildNode("Computations");
+    writer.endNode();
+    writer.beginNode("Computations");
     for(int i=0; i<integrator.getNumComputations(); i++) {
         CustomIntegrator::ComputationType computationType;
         string computationVariable;
         string computationExpression;
         integrator.getComputationStep(i, computationType, computationVariable, computationExpression);
-        computationsNode.createChildNode("Computation").setIntProperty("computationType",static_cast<int>(computationType))
+        writer.beginNode("Computation");
+        writer.setIntProperty("computationType",static_cast<int>(computationType))
             .setStringProperty("computationVariable",computationVariable).setStringProperty("computationExpression",computationExpression);
+        writer.endNode();
     }
-    node.setStringProperty("kineticEnergyExpression",integrator.getKineticEnergyExpression());
-    node.setIntProperty("randomSeed",integrator.getRandomNumberSeed());
-    node.setDoubleProperty("stepSize",integrator.getStepSize());
-    node.setDoubleProperty("constraintTolerance",integrator.getConstraintTolerance());
+    writer.endNode();
 }
 
-void* CustomIntegratorProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* CustomIntegratorProxy::deserializeIncremental(SerializationReader& reader) const {
+    if (reader.getIntProperty("version") != 1)
         throw OpenMMException("Unsupported version number");
-    CustomIntegrator* integrator = new CustomIntegrator(node.getDoubleProperty("stepSize"));
-    const SerializationNode& globalVariablesNode = node.getChildNode("GlobalVariables");
-    const map<string, string> &globalVariableProp = globalVariablesNode.getProperties();
-    for(map<string, string>::const_iterator cit = globalVariableProp.begin(); cit != globalVariableProp.end(); cit++) {
-        integrator->addGlobalVariable(cit->first, globalVariablesNode.getDoubleProperty(cit->first));
-    }
-    const SerializationNode& perDofVariablesNode = node.getChildNode("PerDofVariables");
-    const vector<SerializationNode>& perDofVariableList = perDofVariablesNode.getChildren();
-    int count = 0;
-    for(vector<SerializationNode>::const_iterator cit=perDofVariableList.begin(); cit != perDofVariableList.end(); cit++, count++) {
-        const vector<SerializationNode>& perDofVariableVector = cit->getChildren();
-        integrator->addPerDofVariable(cit->getName(),0);
-        vector<Vec3> perDofValues;
-        for(vector<SerializationNode>::const_iterator dit=perDofVariableVector.begin(); dit!=perDofVariableVector.end(); dit++) {
-            perDofValues.push_back(Vec3(dit->getDoubleProperty("x"),dit->getDoubleProperty("y"),dit->getDoubleProperty("z")));
+    CustomIntegrator* integrator = new CustomIntegrator(reader.getDoubleProperty("stepSize"));
+    integrator->setKineticEnergyExpression(reader.getStringProperty("kineticEnergyExpression"));
+    integrator->setRandomNumberSeed(reader.getIntProperty("randomSeed"));
+    integrator->setConstraintTolerance(reader.getDoubleProperty("constraintTolerance"));
+    while (reader.nextChild()) {
+        if (reader.getName() == "GlobalVariables") {
+            const map<string, string> &globalVariableProp = reader.getProperties();
+            for(map<string, string>::const_iterator cit = globalVariableProp.begin(); cit != globalVariableProp.end(); cit++) {
+                integrator->addGlobalVariable(cit->first, reader.getDoubleProperty(cit->first));
+            }
         }
-        integrator->setPerDofVariable(count, perDofValues);
-    }
-    const SerializationNode& computationsNode = node.getChildNode("Computations");
-    const vector<SerializationNode>& computationsList = computationsNode.getChildren();
-    for(vector<SerializationNode>::const_iterator cit = computationsList.begin(); cit != computationsList.end(); cit++) {
-        CustomIntegrator::ComputationType computationType = static_cast<CustomIntegrator::ComputationType>(cit->getIntProperty("computationType"));
-        // make sure that the int casts to a valid enum
-        if(computationType == CustomIntegrator::ComputeGlobal) {
-            integrator->addComputeGlobal(cit->getStringProperty("computationVariable"), cit->getStringProperty("computationExpression"));
-        } else if(computationType == CustomIntegrator::ComputePerDof) {
-            integrator->addComputePerDof(cit->getStringProperty("computationVariable"), cit->getStringProperty("computationExpression"));
-        } else if(computationType == CustomIntegrator::ComputeSum) {
-            integrator->addComputeSum(cit->getStringProperty("computationVariable"), cit->getStringProperty("computationExpression"));
-        } else if(computationType == CustomIntegrator::ConstrainPositions) {
-            integrator->addConstrainPositions();
-        } else if(computationType == CustomIntegrator::ConstrainVelocities) {
-            integrator->addConstrainVelocities();
-        } else if(computationType == CustomIntegrator::UpdateContextState) {
-            integrator->addUpdateContextState();
-        } else {
-            throw(OpenMMException("Custom Integrator Deserialization: Unknown computation type"));
+        else if (reader.getName() == "PerDofVariables") {
+            while (reader.nextChild()) {
+                int index = integrator->addPerDofVariable(reader.getName(),0);
+                vector<Vec3> perDofValues;
+                while (reader.nextChild()) {
+                    perDofValues.push_back(Vec3(reader.getDoubleProperty("x"),reader.getDoubleProperty("y"),reader.getDoubleProperty("z")));
+                    reader.endNode();
+                }
+                integrator->setPerDofVariable(index, perDofValues);
+                reader.endNode();
+            }
+        }
+        else if (reader.getName() == "Computations") {
+            while (reader.nextChild()) {
+                CustomIntegrator::ComputationType computationType = static_cast<CustomIntegrator::ComputationType>(reader.getIntProperty("computationType"));
+                // make sure that the int casts to a valid enum
+                if(computationType == CustomIntegrator::ComputeGlobal) {
+                    integrator->addComputeGlobal(reader.getStringProperty("computationVariable"), reader.getStringProperty("computationExpression"));
+                } else if(computationType == CustomIntegrator::ComputePerDof) {
+                    integrator->addComputePerDof(reader.getStringProperty("computationVariable"), reader.getStringProperty("computationExpression"));
+                } else if(computationType == CustomIntegrator::ComputeSum) {
+                    integrator->addComputeSum(reader.getStringProperty("computationVariable"), reader.getStringProperty("computationExpression"));
+                } else if(computationType == CustomIntegrator::ConstrainPositions) {
+                    integrator->addConstrainPositions();
+                } else if(computationType == CustomIntegrator::ConstrainVelocities) {
+                    integrator->addConstrainVelocities();
+                } else if(computationType == CustomIntegrator::UpdateContextState) {
+                    integrator->addUpdateContextState();
+                } else {
+                    throw(OpenMMException("Custom Integrator Deserialization: Unknown computation type"));
+                }
+                reader.endNode();
+            }
         }
+        reader.endNode();
     }
-    integrator->setKineticEnergyExpression(node.getStringProperty("kineticEnergyExpression"));
-    integrator->setRandomNumberSeed(node.getIntProperty("randomSeed"));
-    integrator->setConstraintTolerance(node.getDoubleProperty("constraintTolerance"));
     return integrator;
 }
\ No newline at end of file
@@ -42,22 +42,21 @@ HarmonicAngleForceProxy::HarmonicAngleForceProxy() : SerializationProxy("Harmoni
 }
 
 void HarmonicAngleForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 2);
+    node.setIntProperty("version", 3);
     const HarmonicAngleForce& force = *reinterpret_cast<const HarmonicAngleForce*>(object);
     node.setIntProperty("forceGroup", force.getForceGroup());
     node.setBoolProperty("usesPeriodic", force.usesPeriodicBoundaryConditions());
-    SerializationNode& bonds = node.createChildNode("Angles");
-    for (int i = 0; i < force.getNumAngles(); i++) {
-        int particle1, particle2, particle3;
-        double angle, k;
-        force.getAngleParameters(i, particle1, particle2, particle3, angle, k);
-        bonds.createChildNode("Angle").setIntProperty("p1", particle1).setIntProperty("p2", particle2).setIntProperty("p3", particle3).setDoubleProperty("a", angle).setDoubleProperty("k", k);
-    }
+    int numAngles = force.getNumAngles();
+    vector<int> p1(numAngles), p2(numAngles), p3(numAngles);
+    vector<double> a(numAngles), k(numAngles);
+    for (int i = 0; i < numAngles; i++)
+        force.getAngleParameters(i, p1[i], p2[i], p3[i], a[i], k[i]);
+    node.createChildNode("Angles").setIntArrayProperty("p1", p1).setIntArrayProperty("p2", p2).setIntArrayProperty("p3", p3).setDoubleArrayProperty("a", a).setDoubleArrayProperty("k", k);
 }
 
 void* HarmonicAngleForceProxy::deserialize(const SerializationNode& node) const {
     int version = node.getIntProperty("version");
-    if (version < 1 || version > 2)
+    if (version < 1 || version > 3)
         throw OpenMMException("Unsupported version number");
     HarmonicAngleForce* force = new HarmonicAngleForce();
     try {
@@ -65,9 +64,23 @@ void* HarmonicAngleForceProxy::deserialize(const SerializationNode& node) const
         if (version > 1)
             force->setUsesPeriodicBoundaryConditions(node.getBoolProperty("usesPeriodic"));
         const SerializationNode& angles = node.getChildNode("Angles");
-        for (int i = 0; i < (int) angles.getChildren().size(); i++) {
-            const SerializationNode& angle = angles.getChildren()[i];
-            force->addAngle(angle.getIntProperty("p1"), angle.getIntProperty("p2"), angle.getIntProperty("p3"), angle.getDoubleProperty("a"), angle.getDoubleProperty("k"));
+        if (version > 2) {
+            const vector<int>& p1 = angles.getIntArrayProperty("p1");
+            const vector<int>& p2 = angles.getIntArrayProperty("p2");
+            const vector<int>& p3 = angles.getIntArrayProperty("p3");
+            const vector<double>& a = angles.getDoubleArrayProperty("a");
+            const vector<double>& k = angles.getDoubleArrayProperty("k");
+            int numAngles = p1.size();
+            if ((int) p2.size() != numAngles || (int) p3.size() != numAngles || (int) a.size() != numAngles || (int) k.size() != numAngles)
+                throw OpenMMException("HarmonicAngleForce: Inconsistent number of angle parameters");
+            for (int i = 0; i < numAngles; i++)
+                force->addAngle(p1[i], p2[i], p3[i], a[i], k[i]);
+        }
+        else {
+            for (int i = 0; i < (int) angles.getChildren().size(); i++) {
+                const SerializationNode& angle = angles.getChildren()[i];
+                force->addAngle(angle.getIntProperty("p1"), angle.getIntProperty("p2"), angle.getIntProperty("p3"), angle.getDoubleProperty("a"), angle.getDoubleProperty("k"));
+            }
         }
     }
     catch (...) {
@@ -42,22 +42,21 @@ HarmonicBondForceProxy::HarmonicBondForceProxy() : SerializationProxy("HarmonicB
 }
 
 void HarmonicBondForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 2);
+    node.setIntProperty("version", 3);
     const HarmonicBondForce& force = *reinterpret_cast<const HarmonicBondForce*>(object);
     node.setIntProperty("forceGroup", force.getForceGroup());
     node.setBoolProperty("usesPeriodic", force.usesPeriodicBoundaryConditions());
-    SerializationNode& bonds = node.createChildNode("Bonds");
-    for (int i = 0; i < force.getNumBonds(); i++) {
-        int particle1, particle2;
-        double distance, k;
-        force.getBondParameters(i, particle1, particle2, distance, k);
-        bonds.createChildNode("Bond").setIntProperty("p1", particle1).setIntProperty("p2", particle2).setDoubleProperty("d", distance).setDoubleProperty("k", k);
-    }
+    int numBonds = force.getNumBonds();
+    vector<int> p1(numBonds), p2(numBonds);
+    vector<double> d(numBonds), k(numBonds);
+    for (int i = 0; i < numBonds; i++)
+        force.getBondParameters(i, p1[i], p2[i], d[i], k[i]);
+    node.createChildNode("Bonds").setIntArrayProperty("p1", p1).setIntArrayProperty("p2", p2).setDoubleArrayProperty("d", d).setDoubleArrayProperty("k", k);
 }
 
 void* HarmonicBondForceProxy::deserialize(const SerializationNode& node) const {
     int version = node.getIntProperty("version");
-    if (version < 1 || version > 2)
+    if (version < 1 || version > 3)
         throw OpenMMException("Unsupported version number");
     HarmonicBondForce* force = new HarmonicBondForce();
     try {
@@ -65,9 +64,22 @@ void* HarmonicBondForceProxy::deserialize(const SerializationNode& node) const {
         if (version > 1)
             force->setUsesPeriodicBoundaryConditions(node.getBoolProperty("usesPeriodic"));
         const SerializationNode& bonds = node.getChildNode("Bonds");
-        for (int i = 0; i < (int) bonds.getChildren().size(); i++) {
-            const SerializationNode& bond = bonds.getChildren()[i];
-            force->addBond(bond.getIntProperty("p1"), bond.getIntProperty("p2"), bond.getDoubleProperty("d"), bond.getDoubleProperty("k"));
+        if (version > 2) {
+            const vector<int>& p1 = bonds.getIntArrayProperty("p1");
+            const vector<int>& p2 = bonds.getIntArrayProperty("p2");
+            const vector<double>& d = bonds.getDoubleArrayProperty("d");
+            const vector<double>& k = bonds.getDoubleArrayProperty("k");
+            int numBonds = p1.size();
+            if ((int) p2.size() != numBonds || (int) d.size() != numBonds || (int) k.size() != numBonds)
+                throw OpenMMException("HarmonicBondForce: Inconsistent number of bond parameters");
+            for (int i = 0; i < numBonds; i++)
+                force->addBond(p1[i], p2[i], d[i], k[i]);
+        }
+        else {
+            for (int i = 0; i < (int) bonds.getChildren().size(); i++) {
+                const SerializationNode& bond = bonds.getChildren()[i];
+                force->addBond(bond.getIntProperty("p1"), bond.getIntProperty("p2"), bond.getDoubleProperty("d"), bond.getDoubleProperty("k"));
+            }
         }
     }
     catch (...) {
@@ -0,0 +1,220 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/IncrementalSerializationProxy.h"
+#include "openmm/OpenMMException.h"
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * This SerializationWriter builds a tree of SerializationNodes in memory.
+ */
+class SerializationNodeWriter : public SerializationWriter {
+public:
+    SerializationNodeWriter(SerializationNode& root) : arrayType(NO_ARRAY) {
+        nodes.push_back(&root);
+        hasContent.push_back(false);
+    }
+    void beginNode(const string& name) {
+        checkNoArray();
+        hasContent.back() = true;
+        nodes.push_back(&nodes.back()->createChildNode(name));
+        hasContent.push_back(false);
+    }
+    void endNode() {
+        checkNoArray();
+        if (nodes.size() == 1)
+            throw OpenMMException("SerializationWriter: endNode() called without a matching beginNode()");
+        nodes.pop_back();
+        hasContent.pop_back();
+    }
+    void beginDoubleArray(const string& name) {
+        beginArray(name, DOUBLE_ARRAY);
+    }
+    void beginIntArray(const string& name) {
+        beginArray(name, INT_ARRAY);
+    }
+    void writeDoubleArrayValue(double value) {
+        if (arrayType != DOUBLE_ARRAY)
+            throw OpenMMException("SerializationWriter: writeDoubleArrayValue() called outside a double array");
+        doubleValues.push_back(value);
+    }
+    void writeIntArrayValue(int value) {
+        if (arrayType != INT_ARRAY)
+            throw OpenMMException("SerializationWriter: writeIntArrayValue() called outside an int array");
+        intValues.push_back(value);
+    }
+    void endArray() {
+        if (arrayType == DOUBLE_ARRAY)
+            nodes.back()->setDoubleArrayProperty(arrayName, doubleValues);
+        else if (arrayType == INT_ARRAY)
+            nodes.back()->setIntArrayProperty(arrayName, intValues);
+        else
+            throw OpenMMException("SerializationWriter: endArray() called without a matching beginDoubleArray() or beginIntArray()");
+        arrayType = NO_ARRAY;
+    }
+protected:
+    SerializationNode& getPropertyNode() {
+        checkNoArray();
+        if (hasContent.back())
+            throw OpenMMException("SerializationWriter: Properties of node '"+nodes.back()->getName()+"' must be set before its children and array properties");
+        return *nodes.back();
+    }
+private:
+    enum ArrayType {NO_ARRAY, DOUBLE_ARRAY, INT_ARRAY};
+    void checkNoArray() {
+        if (arrayType != NO_ARRAY)
+            throw OpenMMException("SerializationWriter: Array property '"+arrayName+"' was not finished");
+    }
+    void beginArray(const string& name, ArrayType type) {
+        checkNoArray();
+        hasContent.back() = true;
+        arrayName = name;
+        arrayType = type;
+        doubleValues.clear();
+        intValues.clear();
+    }
+    // Each node on the stack is the most recent child of the one before it, so adding children to the
+    // top node can never invalidate the pointers below it.
+    vector<SerializationNode*> nodes;
+    vector<bool> hasContent;
+    ArrayType arrayType;
+    string arrayName;
+    vector<double> doubleValues;
+    vector<int> intValues;
+};
+
+/**
+ * This SerializationReader reads from a tree of SerializationNodes in memory.  The contents of each
+ * node are visited in the order double arrays, int arrays, child nodes.
+ */
+class SerializationNodeReader : public SerializationReader {
+public:
+    SerializationNodeReader(const SerializationNode& root) {
+        frames.push_back(Frame());
+        frames.back().node = &root;
+        frames.back().nextDoubleArray = root.getDoubleArrayProperties().begin();
+        frames.back().nextIntArray = root.getIntArrayProperties().begin();
+    }
+    bool nextChild() {
+        const Frame& current = frames.back();
+        if (current.node == NULL)
+            return false;
+        Frame child;
+        if (current.nextDoubleArray != current.node->getDoubleArrayProperties().end()) {
+            child.arrayNode.setName(current.nextDoubleArray->first);
+            child.doubleArray = &current.nextDoubleArray->second;
+            frames.back().nextDoubleArray++;
+        }
+        else if (current.nextIntArray != current.node->getIntArrayProperties().end()) {
+            child.arrayNode.setName(current.nextIntArray->first);
+            child.intArray = &current.nextIntArray->second;
+            frames.back().nextIntArray++;
+        }
+        else if (current.nextChild < (int) current.node->getChildren().size()) {
+            child.node = &current.node->getChildren()[current.nextChild];
+            child.nextDoubleArray = child.node->getDoubleArrayProperties().begin();
+            child.nextIntArray = child.node->getIntArrayProperties().begin();
+            frames.back().nextChild++;
+        }
+        else
+            return false;
+        frames.push_back(child);
+        return true;
+    }
+    void endNode() {
+        if (frames.size() == 1)
+            throw OpenMMException("SerializationReader: endNode() called without a matching nextChild()");
+        frames.pop_back();
+    }
+    bool isDoubleArray() const {
+        return (frames.back().doubleArray != NULL);
+    }
+    bool isIntArray() const {
+        return (frames.back().intArray != NULL);
+    }
+    bool readDoubleArrayValue(double& value) {
+        Frame& current = frames.back();
+        if (current.doubleArray == NULL)
+            throw OpenMMException("SerializationReader: '"+getName()+"' is not a double array property");
+        if (current.arrayPosition == (int) current.doubleArray->size())
+            return false;
+        value = (*current.doubleArray)[current.arrayPosition++];
+        return true;
+    }
+    bool readIntArrayValue(int& value) {
+        Frame& current = frames.back();
+        if (current.intArray == NULL)
+            throw OpenMMException("SerializationReader: '"+getName()+"' is not an int array property");
+        if (current.arrayPosition == (int) current.intArray->size())
+            return false;
+        value = (*current.intArray)[current.arrayPosition++];
+        return true;
+    }
+protected:
+    const SerializationNode& getPropertyNode() const {
+        const Frame& current = frames.back();
+        return (current.node == NULL ? current.arrayNode : *current.node);
+    }
+private:
+    /**
+     * This records the position within one node or array property.  For an array, node is NULL and
+     * arrayNode holds its name.
+     */
+    struct Frame {
+        Frame() : node(NULL), nextChild(0), doubleArray(NULL), intArray(NULL), arrayPosition(0) {
+        }
+        const SerializationNode* node;
+        map<string, vector<double> >::const_iterator nextDoubleArray;
+        map<string, vector<int> >::const_iterator nextIntArray;
+        int nextChild;
+        SerializationNode arrayNode;
+        const vector<double>* doubleArray;
+        const vector<int>* intArray;
+        int arrayPosition;
+    };
+    vector<Frame> frames;
+};
+
+IncrementalSerializationProxy::IncrementalSerializationProxy(const string& typeName) : SerializationProxy(typeName) {
+}
+
+void IncrementalSerializationProxy::serialize(const void* object, SerializationNode& node) const {
+    SerializationNodeWriter writer(node);
+    serializeIncremental(object, writer);
+}
+
+void* IncrementalSerializationProxy::deserialize(const SerializationNode& node) const {
+    SerializationNodeReader reader(node);
+    return deserializeIncremental(reader);
+}
@@ -35,27 +35,27 @@
 using namespace std;
 using namespace OpenMM;
 
-LangevinIntegratorProxy::LangevinIntegratorProxy() : SerializationProxy("LangevinIntegrator") {
+LangevinIntegratorProxy::LangevinIntegratorProxy() : IncrementalSerializationProxy("LangevinIntegrator") {
 
 }
 
-void LangevinIntegratorProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+void LangevinIntegratorProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 1);
     const LangevinIntegrator& integrator = *reinterpret_cast<const LangevinIntegrator*>(object);
-    node.setDoubleProperty("stepSize", integrator.getStepSize());
-    node.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
-    node.setDoubleProperty("temperature", integrator.getTemperature());
-    node.setDoubleProperty("friction", integrator.getFriction());
-    node.setIntProperty("randomSeed", integrator.getRandomNumberSeed());
+    writer.setDoubleProperty("stepSize", integrator.getStepSize());
+    writer.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
+    writer.setDoubleProperty("temperature", integrator.getTemperature());
+    writer.setDoubleProperty("friction", integrator.getFriction());
+    writer.setIntProperty("randomSeed", integrator.getRandomNumberSeed());
 }
 
-void* LangevinIntegratorProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* LangevinIntegratorProxy::deserializeIncremental(SerializationReader& reader) const {
+    if (reader.getIntProperty("version") != 1)
         throw OpenMMException("Unsupported version number");
-    LangevinIntegrator *integrator = new LangevinIntegrator(node.getDoubleProperty("temperature"),
-                                                            node.getDoubleProperty("friction"),
-                                                            node.getDoubleProperty("stepSize"));
-    integrator->setConstraintTolerance(node.getDoubleProperty("constraintTolerance"));
-    integrator->setRandomNumberSeed(node.getIntProperty("randomSeed"));
+    LangevinIntegrator *integrator = new LangevinIntegrator(reader.getDoubleProperty("temperature"),
+                                                            reader.getDoubleProperty("friction"),
+                                                            reader.getDoubleProperty("stepSize"));
+    integrator->setConstraintTolerance(reader.getDoubleProperty("constraintTolerance"));
+    integrator->setRandomNumberSeed(reader.getIntProperty("randomSeed"));
     return integrator;
 }
\ No newline at end of file
@@ -42,7 +42,7 @@ NonbondedForceProxy::NonbondedForceProxy() : SerializationProxy("NonbondedForce"
 }
 
 void NonbondedForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+    node.setIntProperty("version", 2);
     const NonbondedForce& force = *reinterpret_cast<const NonbondedForce*>(object);
     node.setIntProperty("forceGroup", force.getForceGroup());
     node.setIntProperty("method", (int) force.getNonbondedMethod());
@@ -60,23 +60,24 @@ void NonbondedForceProxy::serialize(const void* object, SerializationNode& node)
     node.setIntProperty("ny", ny);
     node.setIntProperty("nz", nz);
     node.setIntProperty("recipForceGroup", force.getReciprocalSpaceForceGroup());
-    SerializationNode& particles = node.createChildNode("Particles");
-    for (int i = 0; i < force.getNumParticles(); i++) {
-        double charge, sigma, epsilon;
-        force.getParticleParameters(i, charge, sigma, epsilon);
-        particles.createChildNode("Particle").setDoubleProperty("q", charge).setDoubleProperty("sig", sigma).setDoubleProperty("eps", epsilon);
-    }
-    SerializationNode& exceptions = node.createChildNode("Exceptions");
-    for (int i = 0; i < force.getNumExceptions(); i++) {
-        int particle1, particle2;
-        double chargeProd, sigma, epsilon;
-        force.getExceptionParameters(i, particle1, particle2, chargeProd, sigma, epsilon);
-        exceptions.createChildNode("Exception").setIntProperty("p1", particle1).setIntProperty("p2", particle2).setDoubleProperty("q", chargeProd).setDoubleProperty("sig", sigma).setDoubleProperty("eps", epsilon);
-    }
+    int numParticles = force.getNumParticles();
+    vector<double> q(numParticles), sig(numParticles), eps(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        force.getParticleParameters(i, q[i], sig[i], eps[i]);
+    node.createChildNode("Particles").setDoubleArrayProperty("q", q).setDoubleArrayProperty("sig", sig).setDoubleArrayProperty("eps", eps);
+    int numExceptions = force.getNumExceptions();
+    vector<int> p1(numExceptions), p2(numExceptions);
+    q.resize(numExceptions);
+    sig.resize(numExceptions);
+    eps.resize(numExceptions);
+    for (int i = 0; i < numExceptions; i++)
+        force.getExceptionParameters(i, p1[i], p2[i], q[i], sig[i], eps[i]);
+    node.createChildNode("Exceptions").setIntArrayProperty("p1", p1).setIntArrayProperty("p2", p2).setDoubleArrayProperty("q", q).setDoubleArrayProperty("sig", sig).setDoubleArrayProperty("eps", eps);
 }
 
 void* NonbondedForceProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+    int version = node.getIntProperty("version");
+    if (version < 1 || version > 2)
         throw OpenMMException("Unsupported version number");
     NonbondedForce* force = new NonbondedForce();
     try {
@@ -95,14 +96,36 @@ void* NonbondedForceProxy::deserialize(const SerializationNode& node) const {
         force->setPMEParameters(alpha, nx, ny, nz);
         force->setReciprocalSpaceForceGroup(node.getIntProperty("recipForceGroup", -1));
         const SerializationNode& particles = node.getChildNode("Particles");
-        for (int i = 0; i < (int) particles.getChildren().size(); i++) {
-            const SerializationNode& particle = particles.getChildren()[i];
-            force->addParticle(particle.getDoubleProperty("q"), particle.getDoubleProperty("sig"), particle.getDoubleProperty("eps"));
-        }
         const SerializationNode& exceptions = node.getChildNode("Exceptions");
-        for (int i = 0; i < (int) exceptions.getChildren().size(); i++) {
-            const SerializationNode& exception = exceptions.getChildren()[i];
-            force->addException(exception.getIntProperty("p1"), exception.getIntProperty("p2"), exception.getDoubleProperty("q"), exception.getDoubleProperty("sig"), exception.getDoubleProperty("eps"));
+        if (version > 1) {
+            const vector<double>& q = particles.getDoubleArrayProperty("q");
+            const vector<double>& sig = particles.getDoubleArrayProperty("sig");
+            const vector<double>& eps = particles.getDoubleArrayProperty("eps");
+            int numParticles = q.size();
+            if ((int) sig.size() != numParticles || (int) eps.size() != numParticles)
+                throw OpenMMException("NonbondedForce: Inconsistent number of particle parameters");
+            for (int i = 0; i < numParticles; i++)
+                force->addParticle(q[i], sig[i], eps[i]);
+            const vector<int>& p1 = exceptions.getIntArrayProperty("p1");
+            const vector<int>& p2 = exceptions.getIntArrayProperty("p2");
+            const vector<double>& exceptionQ = exceptions.getDoubleArrayProperty("q");
+            const vector<double>& exceptionSig = exceptions.getDoubleArrayProperty("sig");
+            const vector<double>& exceptionEps = exceptions.getDoubleArrayProperty("eps");
+            int numExceptions = p1.size();
+            if ((int) p2.size() != numExceptions || (int) exceptionQ.size() != numExceptions || (int) exceptionSig.size() != numExceptions || (int) exceptionEps.size() != numExceptions)
+                throw OpenMMException("NonbondedForce: Inconsistent number of exception parameters");
+            for (int i = 0; i < numExceptions; i++)
+                force->addException(p1[i], p2[i], exceptionQ[i], exceptionSig[i], exceptionEps[i]);
+        }
+        else {
+            for (int i = 0; i < (int) particles.getChildren().size(); i++) {
+                const SerializationNode& particle = particles.getChildren()[i];
+                force->addParticle(particle.getDoubleProperty("q"), particle.getDoubleProperty("sig"), particle.getDoubleProperty("eps"));
+            }
+            for (int i = 0; i < (int) exceptions.getChildren().size(); i++) {
+                const SerializationNode& exception = exceptions.getChildren()[i];
+                force->addException(exception.getIntProperty("p1"), exception.getIntProperty("p2"), exception.getDoubleProperty("q"), exception.getDoubleProperty("sig"), exception.getDoubleProperty("eps"));
+            }
         }
     }
     catch (...) {
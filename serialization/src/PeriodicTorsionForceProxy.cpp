@@ -42,22 +42,22 @@ PeriodicTorsionForceProxy::PeriodicTorsionForceProxy() : SerializationProxy("Per
 }
 
 void PeriodicTorsionForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 2);
+    node.setIntProperty("version", 3);
     const PeriodicTorsionForce& force = *reinterpret_cast<const PeriodicTorsionForce*>(object);
     node.setIntProperty("forceGroup", force.getForceGroup());
     node.setBoolProperty("usesPeriodic", force.usesPeriodicBoundaryConditions());
-    SerializationNode& torsions = node.createChildNode("Torsions");
-    for (int i = 0; i < force.getNumTorsions(); i++) {
-        int particle1, particle2, particle3, particle4, periodicity;
-        double phase, k;
-        force.getTorsionParameters(i, particle1, particle2, particle3, particle4, periodicity, phase, k);
-        torsions.createChildNode("Torsion").setIntProperty("p1", particle1).setIntProperty("p2", particle2).setIntProperty("p3", particle3).setIntProperty("p4", particle4).setIntProperty("periodicity", periodicity).setDoubleProperty("phase", phase).setDoubleProperty("k", k);
-    }
+    int numTorsions = force.getNumTorsions();
+    vector<int> p1(numTorsions), p2(numTorsions), p3(numTorsions), p4(numTorsions), periodicity(numTorsions);
+    vector<double> phase(numTorsions), k(numTorsions);
+    for (int i = 0; i < numTorsions; i++)
+        force.getTorsionParameters(i, p1[i], p2[i], p3[i], p4[i], periodicity[i], phase[i], k[i]);
+    node.createChildNode("Torsions").setIntArrayProperty("p1", p1).setIntArrayProperty("p2", p2).setIntArrayProperty("p3", p3).setIntArrayProperty("p4", p4)
+            .setIntArrayProperty("periodicity", periodicity).setDoubleArrayProperty("phase", phase).setDoubleArrayProperty("k", k);
 }
 
 void* PeriodicTorsionForceProxy::deserialize(const SerializationNode& node) const {
     int version = node.getIntProperty("version");
-    if (version < 1 || version > 2)
+    if (version < 1 || version > 3)
         throw OpenMMException("Unsupported version number");
     PeriodicTorsionForce* force = new PeriodicTorsionForce();
     try {
@@ -65,10 +65,27 @@ void* PeriodicTorsionForceProxy::deserialize(const SerializationNode& node) cons
         if (version > 1)
             force->setUsesPeriodicBoundaryConditions(node.getBoolProperty("usesPeriodic"));
         const SerializationNode& torsions = node.getChildNode("Torsions");
-        for (int i = 0; i < (int) torsions.getChildren().size(); i++) {
-            const SerializationNode& torsion = torsions.getChildren()[i];
-            force->addTorsion(torsion.getIntProperty("p1"), torsion.getIntProperty("p2"), torsion.getIntProperty("p3"), torsion.getIntProperty("p4"),
-                    torsion.getIntProperty("periodicity"), torsion.getDoubleProperty("phase"), torsion.getDoubleProperty("k"));
+        if (version > 2) {
+            const vector<int>& p1 = torsions.getIntArrayProperty("p1");
+            const vector<int>& p2 = torsions.getIntArrayProperty("p2");
+            const vector<int>& p3 = torsions.getIntArrayProperty("p3");
+            const vector<int>& p4 = torsions.getIntArrayProperty("p4");
+            const vector<int>& periodicity = torsions.getIntArrayProperty("periodicity");
+            const vector<double>& phase = torsions.getDoubleArrayProperty("phase");
+            const vector<double>& k = torsions.getDoubleArrayProperty("k");
+            int numTorsions = p1.size();
+            if ((int) p2.size() != numTorsions || (int) p3.size() != numTorsions || (int) p4.size() != numTorsions || (int) periodicity.size() != numTorsions ||
+                    (int) phase.size() != numTorsions || (int) k.size() != numTorsions)
+                throw OpenMMException("PeriodicTorsionForce: Inconsistent number of torsion parameters");
+            for (int i = 0; i < numTorsions; i++)
+                force->addTorsion(p1[i], p2[i], p3[i], p4[i], periodicity[i], phase[i], k[i]);
+        }
+        else {
+            for (int i = 0; i < (int) torsions.getChildren().size(); i++) {
+                const SerializationNode& torsion = torsions.getChildren()[i];
+                force->addTorsion(torsion.getIntProperty("p1"), torsion.getIntProperty("p2"), torsion.getIntProperty("p3"), torsion.getIntProperty("p4"),
+                        torsion.getIntProperty("periodicity"), torsion.getDoubleProperty("phase"), torsion.getDoubleProperty("k"));
+            }
         }
     }
     catch (...) {
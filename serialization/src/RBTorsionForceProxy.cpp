@@ -42,22 +42,23 @@ RBTorsionForceProxy::RBTorsionForceProxy() : SerializationProxy("RBTorsionForce"
 }
 
 void RBTorsionForceProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 2);
+    node.setIntProperty("version", 3);
     const RBTorsionForce& force = *reinterpret_cast<const RBTorsionForce*>(object);
     node.setIntProperty("forceGroup", force.getForceGroup());
     node.setBoolProperty("usesPeriodic", force.usesPeriodicBoundaryConditions());
-    SerializationNode& torsions = node.createChildNode("Torsions");
-    for (int i = 0; i < force.getNumTorsions(); i++) {
-        int particle1, particle2, particle3, particle4;
-        double c0, c1, c2, c3, c4, c5;
-        force.getTorsionParameters(i, particle1, particle2, particle3, particle4, c0, c1, c2, c3, c4, c5);
-        torsions.createChildNode("Torsion").setIntProperty("p1", particle1).setIntProperty("p2", particle2).setIntProperty("p3", particle3).setIntProperty("p4", particle4).setDoubleProperty("c0", c0).setDoubleProperty("c1", c1).setDoubleProperty("c2", c2).setDoubleProperty("c3", c3).setDoubleProperty("c4", c4).setDoubleProperty("c5", c5);
-    }
+    int numTorsions = force.getNumTorsions();
+    vector<int> p1(numTorsions), p2(numTorsions), p3(numTorsions), p4(numTorsions);
+    vector<double> c0(numTorsions), c1(numTorsions), c2(numTorsions), c3(numTorsions), c4(numTorsions), c5(numTorsions);
+    for (int i = 0; i < numTorsions; i++)
+        force.getTorsionParameters(i, p1[i], p2[i], p3[i], p4[i], c0[i], c1[i], c2[i], c3[i], c4[i], c5[i]);
+    node.createChildNode("Torsions").setIntArrayProperty("p1", p1).setIntArrayProperty("p2", p2).setIntArrayProperty("p3", p3).setIntArrayProperty("p4", p4)
+            .setDoubleArrayProperty("c0", c0).setDoubleArrayProperty("c1", c1).setDoubleArrayProperty("c2", c2)
+            .setDoubleArrayProperty("c3", c3).setDoubleArrayProperty("c4", c4).setDoubleArrayProperty("c5", c5);
 }
 
 void* RBTorsionForceProxy::deserialize(const SerializationNode& node) const {
     int version = node.getIntProperty("version");
-    if (version < 1 || version > 2)
+    if (version < 1 || version > 3)
         throw OpenMMException("Unsupported version number");
     RBTorsionForce* force = new RBTorsionForce();
     try {
@@ -65,11 +66,31 @@ void* RBTorsionForceProxy::deserialize(const SerializationNode& node) const {
         if (version > 1)
             force->setUsesPeriodicBoundaryConditions(node.getBoolProperty("usesPeriodic"));
         const SerializationNode& torsions = node.getChildNode("Torsions");
-        for (int i = 0; i < (int) torsions.getChildren().size(); i++) {
-            const SerializationNode& torsion = torsions.getChildren()[i];
-            force->addTorsion(torsion.getIntProperty("p1"), torsion.getIntProperty("p2"), torsion.getIntProperty("p3"), torsion.getIntProperty("p4"),
-                    torsion.getDoubleProperty("c0"), torsion.getDoubleProperty("c1"), torsion.getDoubleProperty("c2"),
-                    torsion.getDoubleProperty("c3"), torsion.getDoubleProperty("c4"), torsion.getDoubleProperty("c5"));
+        if (version > 2) {
+            const vector<int>& p1 = torsions.getIntArrayProperty("p1");
+            const vector<int>& p2 = torsions.getIntArrayProperty("p2");
+            const vector<int>& p3 = torsions.getIntArrayProperty("p3");
+            const vector<int>& p4 = torsions.getIntArrayProperty("p4");
+            const vector<double>& c0 = torsions.getDoubleArrayProperty("c0");
+            const vector<double>& c1 = torsions.getDoubleArrayProperty("c1");
+            const vector<double>& c2 = torsions.getDoubleArrayProperty("c2");
+            const vector<double>& c3 = torsions.getDoubleArrayProperty("c3");
+            const vector<double>& c4 = torsions.getDoubleArrayProperty("c4");
+            const vector<double>& c5 = torsions.getDoubleArrayProperty("c5");
+            int numTorsions = p1.size();
+            if ((int) p2.size() != numTorsions || (int) p3.size() != numTorsions || (int) p4.size() != numTorsions || (int) c0.size() != numTorsions || (int) c1.size() != numTorsions ||
+                    (int) c2.size() != numTorsions || (int) c3.size() != numTorsions || (int) c4.size() != numTorsions || (int) c5.size() != numTorsions)
+                throw OpenMMException("RBTorsionForce: Inconsistent number of torsion parameters");
+            for (int i = 0; i < numTorsions; i++)
+                force->addTorsion(p1[i], p2[i], p3[i], p4[i], c0[i], c1[i], c2[i], c3[i], c4[i], c5[i]);
+        }
+        else {
+            for (int i = 0; i < (int) torsions.getChildren().size(); i++) {
+                const SerializationNode& torsion = torsions.getChildren()[i];
+                force->addTorsion(torsion.getIntProperty("p1"), torsion.getIntProperty("p2"), torsion.getIntProperty("p3"), torsion.getIntProperty("p4"),
+                        torsion.getDoubleProperty("c0"), torsion.getDoubleProperty("c1"), torsion.getDoubleProperty("c2"),
+                        torsion.getDoubleProperty("c3"), torsion.getDoubleProperty("c4"), torsion.getDoubleProperty("c5"));
+            }
         }
     }
     catch (...) {
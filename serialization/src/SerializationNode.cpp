@@ -168,6 +168,42 @@ SerializationNode& SerializationNode::setDoubleProperty(const string& name, doub
     return *this;
 }
 
+const map<string, vector<double> >& SerializationNode::getDoubleArrayProperties() const {
+    return doubleArrayProperties;
+}
+
+const map<string, vector<int> >& SerializationNode::getIntArrayProperties() const {
+    return intArrayProperties;
+}
+
+bool SerializationNode::hasArrayProperty(const string& name) const {
+    return (doubleArrayProperties.find(name) != doubleArrayProperties.end() || intArrayProperties.find(name) != intArrayProperties.end());
+}
+
+const vector<double>& SerializationNode::getDoubleArrayProperty(const string& name) const {
+    map<string, vector<double> >::const_iterator iter = doubleArrayProperties.find(name);
+    if (iter == doubleArrayProperties.end())
+        throw OpenMMException("Unknown double array property '"+name+"' in node '"+getName()+"'");
+    return iter->second;
+}
+
+SerializationNode& SerializationNode::setDoubleArrayProperty(const string& name, const vector<double>& value) {
+    doubleArrayProperties[name] = value;
+    return *this;
+}
+
+const vector<int>& SerializationNode::getIntArrayProperty(const string& name) const {
+    map<string, vector<int> >::const_iterator iter = intArrayProperties.find(name);
+    if (iter == intArrayProperties.end())
+        throw OpenMMException("Unknown int array property '"+name+"' in node '"+getName()+"'");
+    return iter->second;
+}
+
+SerializationNode& SerializationNode::setIntArrayProperty(const string& name, const vector<int>& value) {
+    intArrayProperties[name] = value;
+    return *this;
+}
+
 SerializationNode& SerializationNode::createChildNode(const std::string& name) {
     children.push_back(SerializationNode());
     children.back().setName(name);
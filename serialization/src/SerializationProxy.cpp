@@ -30,6 +30,8 @@
  * -------------------------------------------------------------------------- */
 
 #include "openmm/serialization/SerializationProxy.h"
+#include "openmm/serialization/SerializationReader.h"
+#include "openmm/serialization/SerializationWriter.h"
 #include "openmm/OpenMMException.h"
 #include <typeinfo>
 
@@ -53,6 +55,20 @@ const string& SerializationProxy::getTypeName() const {
     return typeName;
 }
 
+void SerializationProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    SerializationNode node;
+    serialize(object, node);
+    if (node.hasProperty("type"))
+        throw OpenMMException(getTypeName()+" created node with reserved property 'type'");
+    writer.writeNodeContents(node);
+}
+
+void* SerializationProxy::deserializeIncremental(SerializationReader& reader) const {
+    SerializationNode node;
+    reader.readNode(node);
+    return deserialize(node);
+}
+
 void SerializationProxy::registerProxy(const type_info& type, const SerializationProxy* proxy) {
     getProxiesByType()[type.name()] = proxy;
     getProxiesByName()[proxy->getTypeName()] = proxy;
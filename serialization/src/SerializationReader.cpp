@@ -0,0 +1,115 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/SerializationReader.h"
+
+using namespace OpenMM;
+using namespace std;
+
+const string& SerializationReader::getName() const {
+    return getPropertyNode().getName();
+}
+
+const map<string, string>& SerializationReader::getProperties() const {
+    return getPropertyNode().getProperties();
+}
+
+bool SerializationReader::hasProperty(const string& name) const {
+    return getPropertyNode().hasProperty(name);
+}
+
+const string& SerializationReader::getStringProperty(const string& name) const {
+    return getPropertyNode().getStringProperty(name);
+}
+
+const string& SerializationReader::getStringProperty(const string& name, const string& defaultValue) const {
+    return getPropertyNode().getStringProperty(name, defaultValue);
+}
+
+int SerializationReader::getIntProperty(const string& name) const {
+    return getPropertyNode().getIntProperty(name);
+}
+
+int SerializationReader::getIntProperty(const string& name, int defaultValue) const {
+    return getPropertyNode().getIntProperty(name, defaultValue);
+}
+
+bool SerializationReader::getBoolProperty(const string& name) const {
+    return getPropertyNode().getBoolProperty(name);
+}
+
+bool SerializationReader::getBoolProperty(const string& name, bool defaultValue) const {
+    return getPropertyNode().getBoolProperty(name, defaultValue);
+}
+
+double SerializationReader::getDoubleProperty(const string& name) const {
+    return getPropertyNode().getDoubleProperty(name);
+}
+
+double SerializationReader::getDoubleProperty(const string& name, double defaultValue) const {
+    return getPropertyNode().getDoubleProperty(name, defaultValue);
+}
+
+void SerializationReader::readDoubleArray(vector<double>& values) {
+    values.clear();
+    double value;
+    while (readDoubleArrayValue(value))
+        values.push_back(value);
+}
+
+void SerializationReader::readIntArray(vector<int>& values) {
+    values.clear();
+    int value;
+    while (readIntArrayValue(value))
+        values.push_back(value);
+}
+
+void SerializationReader::readNode(SerializationNode& node) {
+    node.setName(getName());
+    const map<string, string>& properties = getProperties();
+    for (map<string, string>::const_iterator iter = properties.begin(); iter != properties.end(); ++iter)
+        node.setStringProperty(iter->first, iter->second);
+    while (nextChild()) {
+        if (isDoubleArray()) {
+            vector<double> values;
+            readDoubleArray(values);
+            node.setDoubleArrayProperty(getName(), values);
+        }
+        else if (isIntArray()) {
+            vector<int> values;
+            readIntArray(values);
+            node.setIntArrayProperty(getName(), values);
+        }
+        else
+            readNode(node.createChildNode(getName()));
+        endNode();
+    }
+}
@@ -0,0 +1,104 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/SerializationWriter.h"
+#include "openmm/OpenMMException.h"
+
+using namespace OpenMM;
+using namespace std;
+
+SerializationNode& SerializationWriter::getNodeForNewProperty(const string& name) {
+    SerializationNode& node = getPropertyNode();
+    if (node.hasProperty(name))
+        throw OpenMMException("Property '"+name+"' was set more than once in node '"+node.getName()+"'");
+    return node;
+}
+
+SerializationWriter& SerializationWriter::setStringProperty(const string& name, const string& value) {
+    getNodeForNewProperty(name).setStringProperty(name, value);
+    return *this;
+}
+
+SerializationWriter& SerializationWriter::setIntProperty(const string& name, int value) {
+    getNodeForNewProperty(name).setIntProperty(name, value);
+    return *this;
+}
+
+SerializationWriter& SerializationWriter::setBoolProperty(const string& name, bool value) {
+    getNodeForNewProperty(name).setBoolProperty(name, value);
+    return *this;
+}
+
+SerializationWriter& SerializationWriter::setDoubleProperty(const string& name, double value) {
+    getNodeForNewProperty(name).setDoubleProperty(name, value);
+    return *this;
+}
+
+SerializationWriter& SerializationWriter::setDoubleArrayProperty(const string& name, const vector<double>& values) {
+    beginDoubleArray(name);
+    for (int i = 0; i < (int) values.size(); i++)
+        writeDoubleArrayValue(values[i]);
+    endArray();
+    return *this;
+}
+
+SerializationWriter& SerializationWriter::setIntArrayProperty(const string& name, const vector<int>& values) {
+    beginIntArray(name);
+    for (int i = 0; i < (int) values.size(); i++)
+        writeIntArrayValue(values[i]);
+    endArray();
+    return *this;
+}
+
+void SerializationWriter::writeNodeContents(const SerializationNode& node) {
+    const map<string, string>& properties = node.getProperties();
+    for (map<string, string>::const_iterator iter = properties.begin(); iter != properties.end(); ++iter)
+        setStringProperty(iter->first, iter->second);
+    const map<string, vector<double> >& doubleArrays = node.getDoubleArrayProperties();
+    for (map<string, vector<double> >::const_iterator iter = doubleArrays.begin(); iter != doubleArrays.end(); ++iter)
+        setDoubleArrayProperty(iter->first, iter->second);
+    const map<string, vector<int> >& intArrays = node.getIntArrayProperties();
+    for (map<string, vector<int> >::const_iterator iter = intArrays.begin(); iter != intArrays.end(); ++iter)
+        setIntArrayProperty(iter->first, iter->second);
+    const vector<SerializationNode>& children = node.getChildren();
+    for (int i = 0; i < (int) children.size(); i++) {
+        beginNode(children[i].getName());
+        writeNodeContents(children[i]);
+        endNode();
+    }
+}
+
+void SerializationWriter::writeObject(const string& name, const void* object, const SerializationProxy& proxy) {
+    beginNode(name);
+    setStringProperty("type", proxy.getTypeName());
+    proxy.serializeIncremental(object, *this);
+    endNode();
+}
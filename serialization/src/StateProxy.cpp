@@ -38,122 +38,166 @@
 using namespace std;
 using namespace OpenMM;
 
-StateProxy::StateProxy() : SerializationProxy("State") {
+StateProxy::StateProxy() : IncrementalSerializationProxy("State") {
 
 }
 
-void StateProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
-    node.setStringProperty("openmmVersion", Platform::getOpenMMVersion());
+/**
+ * Write a vector as a child node with x, y, and z properties.
+ */
+static void writeVec3(SerializationWriter& writer, const string& name, const Vec3& vec) {
+    writer.beginNode(name);
+    writer.setDoubleProperty("x", vec[0]).setDoubleProperty("y", vec[1]).setDoubleProperty("z", vec[2]);
+    writer.endNode();
+}
+
+/**
+ * Write a per-particle array of vectors as a child node with three array properties.  The values are written
+ * directly from the State, without creating temporary copies of the arrays.
+ */
+static void storeVectors(SerializationWriter& writer, const string& name, const vector<Vec3>& vectors) {
+    static const char* componentNames[] = {"x", "y", "z"};
+    writer.beginNode(name);
+    for (int component = 0; component < 3; component++) {
+        writer.beginDoubleArray(componentNames[component]);
+        for (int i = 0; i < (int) vectors.size(); i++)
+            writer.writeDoubleArrayValue(vectors[i][component]);
+        writer.endArray();
+    }
+    writer.endNode();
+}
+
+/**
+ * Load a per-particle array of vectors from the current node.  This supports both the current format, which
+ * uses array properties, and the version 1 format, which uses one child node per particle.
+ */
+static void loadVectors(SerializationReader& reader, int version, vector<Vec3>& vectors) {
+    if (version > 1) {
+        int numValues[3] = {0, 0, 0};
+        while (reader.nextChild()) {
+            int component = -1;
+            if (reader.getName() == "x")
+                component = 0;
+            else if (reader.getName() == "y")
+                component = 1;
+            else if (reader.getName() == "z")
+                component = 2;
+            if (component != -1 && reader.isDoubleArray()) {
+                double value;
+                int& index = numValues[component];
+                while (reader.readDoubleArrayValue(value)) {
+                    if (index == (int) vectors.size())
+                        vectors.push_back(Vec3());
+                    vectors[index++][component] = value;
+                }
+            }
+            reader.endNode();
+        }
+        if (numValues[1] != numValues[0] || numValues[2] != numValues[0])
+            throw OpenMMException("State Deserialization: Inconsistent number of vector components");
+    }
+    else {
+        while (reader.nextChild()) {
+            vectors.push_back(Vec3(reader.getDoubleProperty("x"), reader.getDoubleProperty("y"), reader.getDoubleProperty("z")));
+            reader.endNode();
+        }
+    }
+}
+
+void StateProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 2);
+    writer.setStringProperty("openmmVersion", Platform::getOpenMMVersion());
     const State& s = *reinterpret_cast<const State*>(object);
-    node.setDoubleProperty("time", s.getTime());
+    writer.setDoubleProperty("time", s.getTime());
     Vec3 a,b,c;
     s.getPeriodicBoxVectors(a,b,c);
-    SerializationNode& boxVectorsNode = node.createChildNode("PeriodicBoxVectors");
-    boxVectorsNode.createChildNode("A").setDoubleProperty("x", a[0]).setDoubleProperty("y", a[1]).setDoubleProperty("z", a[2]);
-    boxVectorsNode.createChildNode("B").setDoubleProperty("x", b[0]).setDoubleProperty("y", b[1]).setDoubleProperty("z", b[2]);
-    boxVectorsNode.createChildNode("C").setDoubleProperty("x", c[0]).setDoubleProperty("y", c[1]).setDoubleProperty("z", c[2]);
+    writer.beginNode("PeriodicBoxVectors");
+    writeVec3(writer, "A", a);
+    writeVec3(writer, "B", b);
+    writeVec3(writer, "C", c);
+    writer.endNode();
     if ((s.getDataTypes()&State::Parameters) != 0) {
-        s.getParameters();
-        SerializationNode& parametersNode = node.createChildNode("Parameters");
-        map<string, double> stateParams = s.getParameters();
+        writer.beginNode("Parameters");
+        const map<string, double>& stateParams = s.getParameters();
         map<string, double>::const_iterator it;
         for (it = stateParams.begin(); it!=stateParams.end();it++) {
-            parametersNode.setDoubleProperty(it->first, it->second);
+            writer.setDoubleProperty(it->first, it->second);
         }
+        writer.endNode();
     }
     if ((s.getDataTypes()&State::Energy) != 0) {
-        s.getPotentialEnergy();
-        SerializationNode& energiesNode = node.createChildNode("Energies");
-        energiesNode.setDoubleProperty("PotentialEnergy", s.getPotentialEnergy());
-        energiesNode.setDoubleProperty("KineticEnergy", s.getKineticEnergy());
-    }
-    if ((s.getDataTypes()&State::Positions) != 0) {
-        s.getPositions();
-        SerializationNode& positionsNode = node.createChildNode("Positions");
-        vector<Vec3> statePositions = s.getPositions();
-        for (int i=0; i<statePositions.size();i++) {
-           positionsNode.createChildNode("Position").setDoubleProperty("x", statePositions[i][0]).setDoubleProperty("y", statePositions[i][1]).setDoubleProperty("z", statePositions[i][2]);
-        }
-    }
-    if ((s.getDataTypes()&State::Velocities) != 0) {
-        s.getVelocities();
-        SerializationNode& velocitiesNode = node.createChildNode("Velocities");
-        vector<Vec3> stateVelocities = s.getVelocities();
-        for (int i=0; i<stateVelocities.size();i++) {
-           velocitiesNode.createChildNode("Velocity").setDoubleProperty("x", stateVelocities[i][0]).setDoubleProperty("y", stateVelocities[i][1]).setDoubleProperty("z", stateVelocities[i][2]);
-        }
-    }
-    if ((s.getDataTypes()&State::Forces) != 0) {
-        s.getForces();
-        SerializationNode& forcesNode = node.createChildNode("Forces");
-        vector<Vec3> stateForces = s.getForces();
-        for (int i=0; i<stateForces.size();i++) {
-            forcesNode.createChildNode("Force").setDoubleProperty("x", stateForces[i][0]).setDoubleProperty("y", stateForces[i][1]).setDoubleProperty("z", stateForces[i][2]);
-        }
+        writer.beginNode("Energies");
+        writer.setDoubleProperty("PotentialEnergy", s.getPotentialEnergy());
+        writer.setDoubleProperty("KineticEnergy", s.getKineticEnergy());
+        writer.endNode();
     }
+    if ((s.getDataTypes()&State::Positions) != 0)
+        storeVectors(writer, "Positions", s.getPositions());
+    if ((s.getDataTypes()&State::Velocities) != 0)
+        storeVectors(writer, "Velocities", s.getVelocities());
+    if ((s.getDataTypes()&State::Forces) != 0)
+        storeVectors(writer, "Forces", s.getForces());
 }
 
-void* StateProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* StateProxy::deserializeIncremental(SerializationReader& reader) const {
+    int version = reader.getIntProperty("version");
+    if (version < 1 || version > 2)
         throw OpenMMException("Unsupported version number");
-    double outTime = node.getDoubleProperty("time");
-    const SerializationNode& boxVectorsNode = node.getChildNode("PeriodicBoxVectors");
-    const SerializationNode& AVec = boxVectorsNode.getChildNode("A");
-    Vec3 outAVec(AVec.getDoubleProperty("x"),AVec.getDoubleProperty("y"),AVec.getDoubleProperty("z"));
-    const SerializationNode& BVec = boxVectorsNode.getChildNode("B");
-    Vec3 outBVec(BVec.getDoubleProperty("x"),BVec.getDoubleProperty("y"),BVec.getDoubleProperty("z"));
-    const SerializationNode& CVec = boxVectorsNode.getChildNode("C");
-    Vec3 outCVec(CVec.getDoubleProperty("x"),CVec.getDoubleProperty("y"),CVec.getDoubleProperty("z"));
-    int types = 0;
+    double outTime = reader.getDoubleProperty("time");
+    bool hasBoxVectors = false;
+    Vec3 outAVec, outBVec, outCVec;
     vector<int> arraySizes;
     State::StateBuilder builder(outTime);
-    const vector<SerializationNode>& children = node.getChildren();
-    for (int j = 0; j < (int) children.size(); j++) {
-        const SerializationNode& child = children[j];
-        if (child.getName() == "Parameters") {
+    while (reader.nextChild()) {
+        string name = reader.getName();
+        if (name == "PeriodicBoxVectors") {
+            SerializationNode boxVectorsNode;
+            reader.readNode(boxVectorsNode);
+            const SerializationNode& AVec = boxVectorsNode.getChildNode("A");
+            outAVec = Vec3(AVec.getDoubleProperty("x"),AVec.getDoubleProperty("y"),AVec.getDoubleProperty("z"));
+            const SerializationNode& BVec = boxVectorsNode.getChildNode("B");
+            outBVec = Vec3(BVec.getDoubleProperty("x"),BVec.getDoubleProperty("y"),BVec.getDoubleProperty("z"));
+            const SerializationNode& CVec = boxVectorsNode.getChildNode("C");
+            outCVec = Vec3(CVec.getDoubleProperty("x"),CVec.getDoubleProperty("y"),CVec.getDoubleProperty("z"));
+            hasBoxVectors = true;
+        }
+        else if (name == "Parameters") {
             map<string, double> outStateParams;
             // inStateParams is really a <string,double> pair, where string is the name and double is the value
             // but we want to avoid casting a string to a double and instead use the built in routines,
-            map<string, string> inStateParams = child.getProperties();
+            const map<string, string>& inStateParams = reader.getProperties();
             for (map<string, string>::const_iterator pit = inStateParams.begin(); pit != inStateParams.end(); pit++) {
-                outStateParams[pit->first] = child.getDoubleProperty(pit->first);
+                outStateParams[pit->first] = reader.getDoubleProperty(pit->first);
             }
             builder.setParameters(outStateParams);
         }
-        else if (child.getName() == "Energies") {
-            double potentialEnergy = child.getDoubleProperty("PotentialEnergy");
-            double kineticEnergy = child.getDoubleProperty("KineticEnergy");
+        else if (name == "Energies") {
+            double potentialEnergy = reader.getDoubleProperty("PotentialEnergy");
+            double kineticEnergy = reader.getDoubleProperty("KineticEnergy");
             builder.setEnergy(kineticEnergy, potentialEnergy);
         }
-        else if (child.getName() == "Positions") {
+        else if (name == "Positions") {
             vector<Vec3> outPositions;
-            for (int i = 0; i < (int) child.getChildren().size(); i++) {
-                const SerializationNode& particle = child.getChildren()[i];
-                outPositions.push_back(Vec3(particle.getDoubleProperty("x"),particle.getDoubleProperty("y"),particle.getDoubleProperty("z")));
-            }
+            loadVectors(reader, version, outPositions);
             builder.setPositions(outPositions);
             arraySizes.push_back(outPositions.size());
         }
-        else if (child.getName() == "Velocities") {
+        else if (name == "Velocities") {
             vector<Vec3> outVelocities;
-            for (int i = 0; i < (int) child.getChildren().size(); i++) {
-                const SerializationNode& particle = child.getChildren()[i];
-                outVelocities.push_back(Vec3(particle.getDoubleProperty("x"),particle.getDoubleProperty("y"),particle.getDoubleProperty("z")));
-            }
+            loadVectors(reader, version, outVelocities);
             builder.setVelocities(outVelocities);
             arraySizes.push_back(outVelocities.size());
         }
-        else if (child.getName() == "Forces") {
+        else if (name == "Forces") {
             vector<Vec3> outForces;
-            for (int i = 0; i < (int) child.getChildren().size(); i++) {
-                const SerializationNode& particle = child.getChildren()[i];
-                outForces.push_back(Vec3(particle.getDoubleProperty("x"),particle.getDoubleProperty("y"),particle.getDoubleProperty("z")));
-            }
+            loadVectors(reader, version, outForces);
             builder.setForces(outForces);
             arraySizes.push_back(outForces.size());
         }
+        reader.endNode();
     }
+    if (!hasBoxVectors)
+        throw OpenMMException("Unknown child 'PeriodicBoxVectors' for node '"+reader.getName()+"'");
     for (int i = 1; i < arraySizes.size(); i++) {
         if (arraySizes[i] != arraySizes[i-1]) {
             throw(OpenMMException("State Deserialization Particle Size Mismatch, check number of particles in Forces, Velocities, Positions!"));
@@ -163,4 +207,4 @@ void* StateProxy::deserialize(const SerializationNode& node) const {
     State *s = new State();
     *s = builder.getState();
     return s;
-}
\ No newline at end of file
+}
@@ -40,34 +40,77 @@
 using namespace OpenMM;
 using namespace std;
 
-SystemProxy::SystemProxy() : SerializationProxy("System") {
+SystemProxy::SystemProxy() : IncrementalSerializationProxy("System") {
 }
 
-void SystemProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
-    node.setStringProperty("openmmVersion", Platform::getOpenMMVersion());
+/**
+ * Reconstruct a virtual site from the node describing it.  If the node does not describe a known
+ * type of virtual site, this returns NULL.
+ */
+static VirtualSite* decodeVirtualSite(const SerializationNode& vsite) {
+    if (vsite.getName() == "TwoParticleAverageSite")
+        return new TwoParticleAverageSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getDoubleProperty("w1"), vsite.getDoubleProperty("w2"));
+    if (vsite.getName() == "ThreeParticleAverageSite")
+        return new ThreeParticleAverageSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getIntProperty("p3"), vsite.getDoubleProperty("w1"), vsite.getDoubleProperty("w2"), vsite.getDoubleProperty("w3"));
+    if (vsite.getName() == "OutOfPlaneSite")
+        return new OutOfPlaneSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getIntProperty("p3"), vsite.getDoubleProperty("w12"), vsite.getDoubleProperty("w13"), vsite.getDoubleProperty("wc"));
+    if (vsite.getName() == "LocalCoordinatesSite") {
+        Vec3 wo(vsite.getDoubleProperty("wo1"), vsite.getDoubleProperty("wo2"), vsite.getDoubleProperty("wo3"));
+        Vec3 wx(vsite.getDoubleProperty("wx1"), vsite.getDoubleProperty("wx2"), vsite.getDoubleProperty("wx3"));
+        Vec3 wy(vsite.getDoubleProperty("wy1"), vsite.getDoubleProperty("wy2"), vsite.getDoubleProperty("wy3"));
+        Vec3 p(vsite.getDoubleProperty("pos1"), vsite.getDoubleProperty("pos2"), vsite.getDoubleProperty("pos3"));
+        return new LocalCoordinatesSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getIntProperty("p3"), wo, wx, wy, p);
+    }
+    return NULL;
+}
+
+/**
+ * Write a vector as a child node with x, y, and z properties.
+ */
+static void writeVec3(SerializationWriter& writer, const string& name, const Vec3& vec) {
+    writer.beginNode(name);
+    writer.setDoubleProperty("x", vec[0]).setDoubleProperty("y", vec[1]).setDoubleProperty("z", vec[2]);
+    writer.endNode();
+}
+
+void SystemProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 2);
+    writer.setStringProperty("openmmVersion", Platform::getOpenMMVersion());
     const System& system = *reinterpret_cast<const System*>(object);
     Vec3 a, b, c;
     system.getDefaultPeriodicBoxVectors(a, b, c);
-    SerializationNode& box = node.createChildNode("PeriodicBoxVectors");
-    box.createChildNode("A").setDoubleProperty("x", a[0]).setDoubleProperty("y", a[1]).setDoubleProperty("z", a[2]);
-    box.createChildNode("B").setDoubleProperty("x", b[0]).setDoubleProperty("y", b[1]).setDoubleProperty("z", b[2]);
-    box.createChildNode("C").setDoubleProperty("x", c[0]).setDoubleProperty("y", c[1]).setDoubleProperty("z", c[2]);
-    SerializationNode& particles = node.createChildNode("Particles");
+    writer.beginNode("PeriodicBoxVectors");
+    writeVec3(writer, "A", a);
+    writeVec3(writer, "B", b);
+    writeVec3(writer, "C", c);
+    writer.endNode();
+    writer.beginNode("Particles");
+    writer.beginDoubleArray("mass");
+    for (int i = 0; i < system.getNumParticles(); i++)
+        writer.writeDoubleArrayValue(system.getParticleMass(i));
+    writer.endArray();
+
+    // Virtual sites are stored as child nodes of the Particles node, each recording the index of its particle.
+
     for (int i = 0; i < system.getNumParticles(); i++) {
-        SerializationNode& particle = particles.createChildNode("Particle").setDoubleProperty("mass", system.getParticleMass(i));
         if (system.isVirtualSite(i)) {
             if (typeid(system.getVirtualSite(i)) == typeid(TwoParticleAverageSite)) {
                 const TwoParticleAverageSite& site = dynamic_cast<const TwoParticleAverageSite&>(system.getVirtualSite(i));
-                particle.createChildNode("TwoParticleAverageSite").setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setDoubleProperty("w1", site.getWeight(0)).setDoubleProperty("w2", site.getWeight(1));
+                writer.beginNode("TwoParticleAverageSite");
+                writer.setIntProperty("index", i).setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setDoubleProperty("w1", site.getWeight(0)).setDoubleProperty("w2", site.getWeight(1));
+                writer.endNode();
             }
             else if (typeid(system.getVirtualSite(i)) == typeid(ThreeParticleAverageSite)) {
                 const ThreeParticleAverageSite& site = dynamic_cast<const ThreeParticleAverageSite&>(system.getVirtualSite(i));
-                particle.createChildNode("ThreeParticleAverageSite").setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setIntProperty("p3", site.getParticle(2)).setDoubleProperty("w1", site.getWeight(0)).setDoubleProperty("w2", site.getWeight(1)).setDoubleProperty("w3", site.getWeight(2));
+                writer.beginNode("ThreeParticleAverageSite");
+                writer.setIntProperty("index", i).setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setIntProperty("p3", site.getParticle(2)).setDoubleProperty("w1", site.getWeight(0)).setDoubleProperty("w2", site.getWeight(1)).setDoubleProperty("w3", site.getWeight(2));
+                writer.endNode();
             }
             else if (typeid(system.getVirtualSite(i)) == typeid(OutOfPlaneSite)) {
                 const OutOfPlaneSite& site = dynamic_cast<const OutOfPlaneSite&>(system.getVirtualSite(i));
-                particle.createChildNode("OutOfPlaneSite").setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setIntProperty("p3", site.getParticle(2)).setDoubleProperty("w12", site.getWeight12()).setDoubleProperty("w13", site.getWeight13()).setDoubleProperty("wc", site.getWeightCross());
+                writer.beginNode("OutOfPlaneSite");
+                writer.setIntProperty("index", i).setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setIntProperty("p3", site.getParticle(2)).setDoubleProperty("w12", site.getWeight12()).setDoubleProperty("w13", site.getWeight13()).setDoubleProperty("wc", site.getWeightCross());
+                writer.endNode();
             }
             else if (typeid(system.getVirtualSite(i)) == typeid(LocalCoordinatesSite)) {
                 const LocalCoordinatesSite& site = dynamic_cast<const LocalCoordinatesSite&>(system.getVirtualSite(i));
@@ -75,67 +118,160 @@ void SystemProxy::serialize(const void* object, SerializationNode& node) const {
                 Vec3 wx = site.getXWeights();
                 Vec3 wy = site.getYWeights();
                 Vec3 p = site.getLocalPosition();
-                particle.createChildNode("LocalCoordinatesSite").setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setIntProperty("p3", site.getParticle(2)).
+                writer.beginNode("LocalCoordinatesSite");
+                writer.setIntProperty("index", i).setIntProperty("p1", site.getParticle(0)).setIntProperty("p2", site.getParticle(1)).setIntProperty("p3", site.getParticle(2)).
                         setDoubleProperty("wo1", wo[0]).setDoubleProperty("wo2", wo[1]).setDoubleProperty("wo3", wo[2]).
                         setDoubleProperty("wx1", wx[0]).setDoubleProperty("wx2", wx[1]).setDoubleProperty("wx3", wx[2]).
                         setDoubleProperty("wy1", wy[0]).setDoubleProperty("wy2", wy[1]).setDoubleProperty("wy3", wy[2]).
                         setDoubleProperty("pos1", p[0]).setDoubleProperty("pos2", p[1]).setDoubleProperty("pos3", p[2]);
+                writer.endNode();
             }
         }
     }
-    SerializationNode& constraints = node.createChildNode("Constraints");
-    for (int i = 0; i < system.getNumConstraints(); i++) {
-        int particle1, particle2;
-        double distance;
+    writer.endNode();
+
+    // Each constraint parameter is written as its own array, in the order the XML format has always used.
+
+    int numConstraints = system.getNumConstraints();
+    int particle1, particle2;
+    double distance;
+    writer.beginNode("Constraints");
+    writer.beginDoubleArray("d");
+    for (int i = 0; i < numConstraints; i++) {
+        system.getConstraintParameters(i, particle1, particle2, distance);
+        writer.writeDoubleArrayValue(distance);
+    }
+    writer.endArray();
+    writer.beginIntArray("p1");
+    for (int i = 0; i < numConstraints; i++) {
         system.getConstraintParameters(i, particle1, particle2, distance);
-        constraints.createChildNode("Constraint").setIntProperty("p1", particle1).setIntProperty("p2", particle2).setDoubleProperty("d", distance);
+        writer.writeIntArrayValue(particle1);
     }
-    SerializationNode& forces = node.createChildNode("Forces");
+    writer.endArray();
+    writer.beginIntArray("p2");
+    for (int i = 0; i < numConstraints; i++) {
+        system.getConstraintParameters(i, particle1, particle2, distance);
+        writer.writeIntArrayValue(particle2);
+    }
+    writer.endArray();
+    writer.endNode();
+    writer.beginNode("Forces");
     for (int i = 0; i < system.getNumForces(); i++)
-        forces.createChildNode("Force", &system.getForce(i));
+        writer.writeObject("Force", &system.getForce(i));
+    writer.endNode();
 }
 
-void* SystemProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+/**
+ * Read the box vectors from the current node.
+ */
+static void readBoxVectors(SerializationReader& reader, System& system) {
+    SerializationNode box;
+    reader.readNode(box);
+    const SerializationNode& boxa = box.getChildNode("A");
+    const SerializationNode& boxb = box.getChildNode("B");
+    const SerializationNode& boxc = box.getChildNode("C");
+    Vec3 a(boxa.getDoubleProperty("x"), boxa.getDoubleProperty("y"), boxa.getDoubleProperty("z"));
+    Vec3 b(boxb.getDoubleProperty("x"), boxb.getDoubleProperty("y"), boxb.getDoubleProperty("z"));
+    Vec3 c(boxc.getDoubleProperty("x"), boxc.getDoubleProperty("y"), boxc.getDoubleProperty("z"));
+    system.setDefaultPeriodicBoxVectors(a, b, c);
+}
+
+/**
+ * Read the particles and virtual sites from the current node.
+ */
+static void readParticles(SerializationReader& reader, int version, System& system) {
+    if (version > 1) {
+        while (reader.nextChild()) {
+            if (reader.isDoubleArray()) {
+                if (reader.getName() == "mass") {
+                    double mass;
+                    while (reader.readDoubleArrayValue(mass))
+                        system.addParticle(mass);
+                }
+            }
+            else if (!reader.isIntArray()) {
+                SerializationNode vsite;
+                reader.readNode(vsite);
+                int index = vsite.getIntProperty("index");
+                if (index < 0 || index >= system.getNumParticles())
+                    throw OpenMMException("System: Illegal particle index for virtual site");
+                VirtualSite* site = decodeVirtualSite(vsite);
+                if (site != NULL)
+                    system.setVirtualSite(index, site);
+            }
+            reader.endNode();
+        }
+    }
+    else {
+        while (reader.nextChild()) {
+            system.addParticle(reader.getDoubleProperty("mass"));
+            if (reader.nextChild()) {
+                SerializationNode vsite;
+                reader.readNode(vsite);
+                reader.endNode();
+                VirtualSite* site = decodeVirtualSite(vsite);
+                if (site != NULL)
+                    system.setVirtualSite(system.getNumParticles()-1, site);
+            }
+            reader.endNode();
+        }
+    }
+}
+
+/**
+ * Read the constraints from the current node.
+ */
+static void readConstraints(SerializationReader& reader, int version, System& system) {
+    if (version > 1) {
+        vector<int> p1, p2;
+        vector<double> d;
+        while (reader.nextChild()) {
+            if (reader.isIntArray() && reader.getName() == "p1")
+                reader.readIntArray(p1);
+            else if (reader.isIntArray() && reader.getName() == "p2")
+                reader.readIntArray(p2);
+            else if (reader.isDoubleArray() && reader.getName() == "d")
+                reader.readDoubleArray(d);
+            reader.endNode();
+        }
+        int numConstraints = p1.size();
+        if ((int) p2.size() != numConstraints || (int) d.size() != numConstraints)
+            throw OpenMMException("System: Inconsistent number of constraint parameters");
+        for (int i = 0; i < numConstraints; i++)
+            system.addConstraint(p1[i], p2[i], d[i]);
+    }
+    else {
+        while (reader.nextChild()) {
+            system.addConstraint(reader.getIntProperty("p1"), reader.getIntProperty("p2"), reader.getDoubleProperty("d"));
+            reader.endNode();
+        }
+    }
+}
+
+void* SystemProxy::deserializeIncremental(SerializationReader& reader) const {
+    int version = reader.getIntProperty("version");
+    if (version < 1 || version > 2)
         throw OpenMMException("Unsupported version number");
     System* system = new System();
     try {
-        const SerializationNode& box = node.getChildNode("PeriodicBoxVectors");
-        const SerializationNode& boxa = box.getChildNode("A");
-        const SerializationNode& boxb = box.getChildNode("B");
-        const SerializationNode& boxc = box.getChildNode("C");
-        Vec3 a(boxa.getDoubleProperty("x"), boxa.getDoubleProperty("y"), boxa.getDoubleProperty("z"));
-        Vec3 b(boxb.getDoubleProperty("x"), boxb.getDoubleProperty("y"), boxb.getDoubleProperty("z"));
-        Vec3 c(boxc.getDoubleProperty("x"), boxc.getDoubleProperty("y"), boxc.getDoubleProperty("z"));
-        system->setDefaultPeriodicBoxVectors(a, b, c);
-        const SerializationNode& particles = node.getChildNode("Particles");
-        for (int i = 0; i < (int) particles.getChildren().size(); i++) {
-            system->addParticle(particles.getChildren()[i].getDoubleProperty("mass"));
-            if (particles.getChildren()[i].getChildren().size() > 0) {
-                const SerializationNode& vsite = particles.getChildren()[i].getChildren()[0];
-                if (vsite.getName() == "TwoParticleAverageSite")
-                    system->setVirtualSite(i, new TwoParticleAverageSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getDoubleProperty("w1"), vsite.getDoubleProperty("w2")));
-                else if (vsite.getName() == "ThreeParticleAverageSite")
-                    system->setVirtualSite(i, new ThreeParticleAverageSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getIntProperty("p3"), vsite.getDoubleProperty("w1"), vsite.getDoubleProperty("w2"), vsite.getDoubleProperty("w3")));
-                else if (vsite.getName() == "OutOfPlaneSite")
-                    system->setVirtualSite(i, new OutOfPlaneSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getIntProperty("p3"), vsite.getDoubleProperty("w12"), vsite.getDoubleProperty("w13"), vsite.getDoubleProperty("wc")));
-                else if (vsite.getName() == "LocalCoordinatesSite") {
-                    Vec3 wo(vsite.getDoubleProperty("wo1"), vsite.getDoubleProperty("wo2"), vsite.getDoubleProperty("wo3"));
-                    Vec3 wx(vsite.getDoubleProperty("wx1"), vsite.getDoubleProperty("wx2"), vsite.getDoubleProperty("wx3"));
-                    Vec3 wy(vsite.getDoubleProperty("wy1"), vsite.getDoubleProperty("wy2"), vsite.getDoubleProperty("wy3"));
-                    Vec3 p(vsite.getDoubleProperty("pos1"), vsite.getDoubleProperty("pos2"), vsite.getDoubleProperty("pos3"));
-                    system->setVirtualSite(i, new LocalCoordinatesSite(vsite.getIntProperty("p1"), vsite.getIntProperty("p2"), vsite.getIntProperty("p3"), wo, wx, wy, p));
+        // Each Force is reconstructed as soon as it is read, so only one of them is ever held in memory in
+        // serialized form.
+
+        while (reader.nextChild()) {
+            string name = reader.getName();
+            if (name == "PeriodicBoxVectors")
+                readBoxVectors(reader, *system);
+            else if (name == "Particles")
+                readParticles(reader, version, *system);
+            else if (name == "Constraints")
+                readConstraints(reader, version, *system);
+            else if (name == "Forces") {
+                while (reader.nextChild()) {
+                    system->addForce(reader.readObject<Force>());
+                    reader.endNode();
                 }
             }
-        }
-        const SerializationNode& constraints = node.getChildNode("Constraints");
-        for (int i = 0; i < (int) constraints.getChildren().size(); i++) {
-            const SerializationNode& constraint = constraints.getChildren()[i];
-            system->addConstraint(constraint.getIntProperty("p1"), constraint.getIntProperty("p2"), constraint.getDoubleProperty("d"));
-        }
-        const SerializationNode& forces = node.getChildNode("Forces");
-        for (int i = 0; i < (int) forces.getChildren().size(); i++) {
-            system->addForce(forces.getChildren()[i].decodeObject<Force>());
+            reader.endNode();
         }
     }
     catch (...) {
@@ -143,4 +279,4 @@ void* SystemProxy::deserialize(const SerializationNode& node) const {
         throw;
     }
     return system;
-}
\ No newline at end of file
+}
@@ -35,29 +35,29 @@
 using namespace std;
 using namespace OpenMM;
 
-VariableLangevinIntegratorProxy::VariableLangevinIntegratorProxy() : SerializationProxy("VariableLangevinIntegrator") {
+VariableLangevinIntegratorProxy::VariableLangevinIntegratorProxy() : IncrementalSerializationProxy("VariableLangevinIntegrator") {
 
 }
 
-void VariableLangevinIntegratorProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+void VariableLangevinIntegratorProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 1);
     const VariableLangevinIntegrator& integrator = *reinterpret_cast<const VariableLangevinIntegrator*>(object);
-    node.setDoubleProperty("stepSize", integrator.getStepSize());
-    node.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
-    node.setDoubleProperty("temperature", integrator.getTemperature());
-    node.setDoubleProperty("friction", integrator.getFriction());
-    node.setDoubleProperty("errorTol", integrator.getErrorTolerance());
-    node.setIntProperty("randomSeed", integrator.getRandomNumberSeed());
+    writer.setDoubleProperty("stepSize", integrator.getStepSize());
+    writer.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
+    writer.setDoubleProperty("temperature", integrator.getTemperature());
+    writer.setDoubleProperty("friction", integrator.getFriction());
+    writer.setDoubleProperty("errorTol", integrator.getErrorTolerance());
+    writer.setIntProperty("randomSeed", integrator.getRandomNumberSeed());
 }
 
-void* VariableLangevinIntegratorProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* VariableLangevinIntegratorProxy::deserializeIncremental(SerializationReader& reader) const {
+    if (reader.getIntProperty("version") != 1)
         throw OpenMMException("Unsupported version number");
-    VariableLangevinIntegrator *integrator = new VariableLangevinIntegrator(node.getDoubleProperty("temperature"),
-                                                            node.getDoubleProperty("friction"),
-                                                            node.getDoubleProperty("errorTol"));
-    integrator->setStepSize(node.getDoubleProperty("stepSize"));
-    integrator->setConstraintTolerance(node.getDoubleProperty("constraintTolerance"));
-    integrator->setRandomNumberSeed(node.getIntProperty("randomSeed"));
+    VariableLangevinIntegrator *integrator = new VariableLangevinIntegrator(reader.getDoubleProperty("temperature"),
+                                                            reader.getDoubleProperty("friction"),
+                                                            reader.getDoubleProperty("errorTol"));
+    integrator->setStepSize(reader.getDoubleProperty("stepSize"));
+    integrator->setConstraintTolerance(reader.getDoubleProperty("constraintTolerance"));
+    integrator->setRandomNumberSeed(reader.getIntProperty("randomSeed"));
     return integrator;
 }
\ No newline at end of file
@@ -35,23 +35,23 @@
 using namespace std;
 using namespace OpenMM;
 
-VariableVerletIntegratorProxy::VariableVerletIntegratorProxy() : SerializationProxy("VariableVerletIntegrator") {
+VariableVerletIntegratorProxy::VariableVerletIntegratorProxy() : IncrementalSerializationProxy("VariableVerletIntegrator") {
 
 }
 
-void VariableVerletIntegratorProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+void VariableVerletIntegratorProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 1);
     const VariableVerletIntegrator& integrator = *reinterpret_cast<const VariableVerletIntegrator*>(object);
-    node.setDoubleProperty("errorTol", integrator.getErrorTolerance());
-    node.setDoubleProperty("stepSize", integrator.getStepSize());
-    node.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
+    writer.setDoubleProperty("errorTol", integrator.getErrorTolerance());
+    writer.setDoubleProperty("stepSize", integrator.getStepSize());
+    writer.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
 }
 
-void* VariableVerletIntegratorProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* VariableVerletIntegratorProxy::deserializeIncremental(SerializationReader& reader) const {
+    if (reader.getIntProperty("version") != 1)
         throw OpenMMException("Unsupported version number");
-    VariableVerletIntegrator *integrator = new VariableVerletIntegrator(node.getDoubleProperty("errorTol"));
-    integrator->setStepSize(node.getDoubleProperty("stepSize"));
-    integrator->setConstraintTolerance(node.getDoubleProperty("constraintTolerance"));
+    VariableVerletIntegrator *integrator = new VariableVerletIntegrator(reader.getDoubleProperty("errorTol"));
+    integrator->setStepSize(reader.getDoubleProperty("stepSize"));
+    integrator->setConstraintTolerance(reader.getDoubleProperty("constraintTolerance"));
     return integrator;
 }
\ No newline at end of file
@@ -35,21 +35,21 @@
 using namespace std;
 using namespace OpenMM;
 
-VerletIntegratorProxy::VerletIntegratorProxy() : SerializationProxy("VerletIntegrator") {
+VerletIntegratorProxy::VerletIntegratorProxy() : IncrementalSerializationProxy("VerletIntegrator") {
 
 }
 
-void VerletIntegratorProxy::serialize(const void* object, SerializationNode& node) const {
-    node.setIntProperty("version", 1);
+void VerletIntegratorProxy::serializeIncremental(const void* object, SerializationWriter& writer) const {
+    writer.setIntProperty("version", 1);
     const VerletIntegrator& integrator = *reinterpret_cast<const VerletIntegrator*>(object);
-    node.setDoubleProperty("stepSize", integrator.getStepSize());
-    node.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
+    writer.setDoubleProperty("stepSize", integrator.getStepSize());
+    writer.setDoubleProperty("constraintTolerance", integrator.getConstraintTolerance());
 }
 
-void* VerletIntegratorProxy::deserialize(const SerializationNode& node) const {
-    if (node.getIntProperty("version") != 1)
+void* VerletIntegratorProxy::deserializeIncremental(SerializationReader& reader) const {
+    if (reader.getIntProperty("version") != 1)
         throw OpenMMException("Unsupported version number");
-    VerletIntegrator *integrator = new VerletIntegrator(node.getDoubleProperty("stepSize"));
-    integrator->setConstraintTolerance(node.getDoubleProperty("constraintTolerance"));
+    VerletIntegrator *integrator = new VerletIntegrator(reader.getDoubleProperty("stepSize"));
+    integrator->setConstraintTolerance(reader.getDoubleProperty("constraintTolerance"));
     return integrator;
 }
\ No newline at end of file
@@ -30,15 +30,28 @@
  * -------------------------------------------------------------------------- */
 
 #include "openmm/serialization/XmlSerializer.h"
-#include "irrXML.h"
+#include "openmm/serialization/SerializationReader.h"
+#include "openmm/serialization/SerializationWriter.h"
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <map>
 
 using namespace OpenMM;
 using namespace std;
-using namespace irr;
-using namespace io;
+
+extern "C" char* g_fmt(char*, double);
+extern "C" double strtod2(const char* s00, char** se);
+
+// Array properties are written as child elements in a namespace of their own, so they can never be
+// confused with child nodes.  The namespace is declared on the root element.
+
+static const string ARRAY_NAMESPACE_PREFIX = "omm:";
+static const string ARRAY_NAMESPACE_ATTRIBUTE = "xmlns:omm";
+static const string ARRAY_NAMESPACE_URI = "urn:openmm:serialization";
+static const string DOUBLE_ARRAY_ELEMENT = "omm:DoubleArray";
+static const string INT_ARRAY_ELEMENT = "omm:IntArray";
 
 /**
  * Apply XML encoding to a string.  This is adapted from TinyXML (written by Lee Thomason).
@@ -106,93 +119,510 @@ static void encodeString(const string& str, string* outString) {
     }
 }
 
-void XmlSerializer::serialize(const SerializationNode& node, std::ostream& stream) {
-    stream << "<?xml version=\"1.0\" ?>\n";
-    encodeNode(node, stream, 0);
-}
-
-void XmlSerializer::encodeNode(const SerializationNode& node, std::ostream& stream, int depth) {
-    for (int i = 0; i < depth; i++)
-        stream << '\t';
-    stream << '<' << node.getName();
-    const map<string, string>& properties = node.getProperties();
-    for (map<string, string>::const_iterator iter = properties.begin(); iter != properties.end(); ++iter) {
-        string name, value;
-        encodeString(iter->first, &name);
-        encodeString(iter->second, &value);
-        stream << ' ' << name << "=\"" << value << '\"';
-    }
-    const vector<SerializationNode>& children = node.getChildren();
-    if (children.size() == 0)
-        stream << "/>\n";
-    else {
-        stream << ">\n";
-        for (int i = 0; i < (int) children.size(); i++)
-            encodeNode(children[i], stream, depth+1);
+/**
+ * This SerializationWriter writes XML to a stream as it receives each piece of the document.  The start tag
+ * of each element is held back until its first child or array property arrives, so that its properties can
+ * still be added, and so that an element with no contents can be written as an empty tag.  Array values are
+ * formatted into a fixed size buffer, so no temporary copy of an array is ever created.
+ */
+class XmlStreamWriter : public SerializationWriter {
+public:
+    XmlStreamWriter(std::ostream& stream) : stream(stream), hasPendingNode(false), arrayElement(NULL), numArrayValues(0), length(0) {
+        stream << "<?xml version=\"1.0\" ?>\n";
+    }
+    void beginNode(const string& name) {
+        checkNoArray();
+        if (name.compare(0, ARRAY_NAMESPACE_PREFIX.size(), ARRAY_NAMESPACE_PREFIX) == 0)
+            throw OpenMMException("XmlSerializer: '"+name+"' is a reserved node name");
+        if (hasPendingNode)
+            writeStartTag(false);
+        pendingNode = SerializationNode();
+        pendingNode.setName(name);
+        hasPendingNode = true;
+        openNodes.push_back(name);
+    }
+    void endNode() {
+        checkNoArray();
+        if (openNodes.size() == 0)
+            throw OpenMMException("XmlSerializer: endNode() called without a matching beginNode()");
+        if (hasPendingNode)
+            writeStartTag(true);
+        else {
+            writeIndent(openNodes.size()-1);
+            stream << "</" << openNodes.back() << ">\n";
+        }
+        openNodes.pop_back();
+    }
+    void beginDoubleArray(const string& name) {
+        beginArray(name, DOUBLE_ARRAY_ELEMENT);
+    }
+    void beginIntArray(const string& name) {
+        beginArray(name, INT_ARRAY_ELEMENT);
+    }
+    void writeDoubleArrayValue(double value) {
+        if (arrayElement != &DOUBLE_ARRAY_ELEMENT)
+            throw OpenMMException("XmlSerializer: writeDoubleArrayValue() called outside a double array");
+        startArrayValue();
+        g_fmt(buffer+length, value);
+        length += strlen(buffer+length);
+    }
+    void writeIntArrayValue(int value) {
+        if (arrayElement != &INT_ARRAY_ELEMENT)
+            throw OpenMMException("XmlSerializer: writeIntArrayValue() called outside an int array");
+        startArrayValue();
+        length += sprintf(buffer+length, "%d", value);
+    }
+    void endArray() {
+        if (arrayElement == NULL)
+            throw OpenMMException("XmlSerializer: endArray() called without a matching beginDoubleArray() or beginIntArray()");
+        stream.write(buffer, length);
+        stream << "</" << *arrayElement << ">\n";
+        arrayElement = NULL;
+    }
+protected:
+    SerializationNode& getPropertyNode() {
+        checkNoArray();
+        if (!hasPendingNode)
+            throw OpenMMException("XmlSerializer: Properties of node '"+(openNodes.size() == 0 ? string() : openNodes.back())+"' must be set before its children and array properties");
+        return pendingNode;
+    }
+private:
+    void checkNoArray() {
+        if (arrayElement != NULL)
+            throw OpenMMException("XmlSerializer: Array property '"+arrayName+"' was not finished");
+    }
+    void writeIndent(int depth) {
         for (int i = 0; i < depth; i++)
             stream << '\t';
-        stream << "</" << node.getName() << ">\n";
     }
+    void writeStartTag(bool isEmpty) {
+        int depth = openNodes.size()-1;
+        writeIndent(depth);
+        stream << '<' << pendingNode.getName();
+        const map<string, string>& properties = pendingNode.getProperties();
+        if (depth == 0) {
+            if (properties.find(ARRAY_NAMESPACE_ATTRIBUTE) != properties.end())
+                throw OpenMMException("XmlSerializer: '"+ARRAY_NAMESPACE_ATTRIBUTE+"' is a reserved property name");
+            stream << ' ' << ARRAY_NAMESPACE_ATTRIBUTE << "=\"" << ARRAY_NAMESPACE_URI << '\"';
+        }
+        for (map<string, string>::const_iterator iter = properties.begin(); iter != properties.end(); ++iter) {
+            string name, value;
+            encodeString(iter->first, &name);
+            encodeString(iter->second, &value);
+            stream << ' ' << name << "=\"" << value << '\"';
+        }
+        stream << (isEmpty ? "/>\n" : ">\n");
+        hasPendingNode = false;
+    }
+    void beginArray(const string& name, const string& element) {
+        checkNoArray();
+        if (openNodes.size() == 0)
+            throw OpenMMException("XmlSerializer: Array property '"+name+"' is not inside a node");
+        if (hasPendingNode)
+            writeStartTag(false);
+        string encodedName;
+        encodeString(name, &encodedName);
+        writeIndent(openNodes.size());
+        stream << '<' << element << " name=\"" << encodedName << "\">";
+        arrayElement = &element;
+        arrayName = name;
+        numArrayValues = 0;
+        length = 0;
+    }
+    void startArrayValue() {
+        if (length > (int) sizeof(buffer)-40) {
+            stream.write(buffer, length);
+            length = 0;
+        }
+        if (numArrayValues++ > 0)
+            buffer[length++] = ' ';
+    }
+    std::ostream& stream;
+    vector<string> openNodes;
+    SerializationNode pendingNode;
+    bool hasPendingNode;
+    const string* arrayElement;
+    string arrayName;
+    int numArrayValues, length;
+    char buffer[4096];
+};
+
+void XmlSerializer::serializeObject(const void* object, const SerializationProxy& proxy, const string& rootName, std::ostream& stream) {
+    XmlStreamWriter writer(stream);
+    writer.writeObject(rootName, object, proxy);
 }
 
 /**
- * Adapter class to let irrXML read a C++ stream.
+ * This class reads characters from a stream through a fixed size buffer.  Unlike reading the entire
+ * document into memory, this keeps memory use bounded and works with streams that do not support
+ * seeking, such as pipes or decompressing streams.
  */
-class XmlSerializer::StreamReader : public IFileReadCallBack {
+class XmlInputBuffer {
 public:
-    StreamReader(std::istream& stream) : stream(stream) {
-        stream.seekg(0, ios_base::end);
-        size = stream.tellg();
-        stream.seekg(0);
+    XmlInputBuffer(std::istream& stream) : stream(stream), position(0), end(0) {
     }
-    int read(void* buffer, int sizeToRead) {
-        stream.read((char*) buffer, sizeToRead);
-        return stream.gcount();
+    /**
+     * Get the next character without consuming it.  At the end of the stream, this returns -1.
+     */
+    int peek() {
+        if (position == end) {
+            stream.read(buffer, sizeof(buffer));
+            end = stream.gcount();
+            position = 0;
+            if (end == 0)
+                return -1;
+        }
+        return (unsigned char) buffer[position];
+    }
+    /**
+     * Get the next character and consume it.  At the end of the stream, this returns -1.
+     */
+    int get() {
+        int c = peek();
+        if (c != -1)
+            position++;
+        return c;
     }
-    int getSize() {
-        return size;
+    /**
+     * Consume the next character, which must be the one specified.
+     */
+    void expect(char c) {
+        if (get() != c)
+            throw OpenMMException(string("XmlSerializer: Malformed XML: expected '")+c+"'");
     }
 private:
     std::istream& stream;
-    int size;
+    char buffer[65536];
+    int position, end;
+};
+
+/**
+ * This records the information about an XML element read from the start tag.
+ */
+struct XmlTag {
+    string name;
+    vector<pair<string, string> > attributes;
+    bool isEmpty, isEnd;
 };
 
+static bool isWhitespace(int c) {
+    return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+static void skipWhitespace(XmlInputBuffer& reader) {
+    while (isWhitespace(reader.peek()))
+        reader.get();
+}
+
+/**
+ * Skip characters until after the specified terminator has been read.
+ */
+static void skipPast(XmlInputBuffer& reader, const string& terminator) {
+    int matched = 0;
+    while (matched < (int) terminator.size()) {
+        int c = reader.get();
+        if (c == -1)
+            throw OpenMMException("XmlSerializer: Unexpected end of stream");
+        if (c == terminator[matched])
+            matched++;
+        else
+            matched = (c == terminator[0] ? 1 : 0);
+    }
+}
+
+/**
+ * Decode a character or entity reference.  The leading '&' has already been consumed.
+ */
+static void decodeEntity(XmlInputBuffer& reader, string& result) {
+    string entity;
+    int c;
+    while ((c = reader.get()) != ';') {
+        if (c == -1 || entity.size() > 10)
+            throw OpenMMException("XmlSerializer: Malformed XML: illegal entity");
+        entity += (char) c;
+    }
+    if (entity == "amp")
+        result += '&';
+    else if (entity == "lt")
+        result += '<';
+    else if (entity == "gt")
+        result += '>';
+    else if (entity == "quot")
+        result += '"';
+    else if (entity == "apos")
+        result += '\'';
+    else if (entity.size() > 1 && entity[0] == '#') {
+        // A character reference.  Encode the character as UTF-8.
+
+        long value;
+        char* end;
+        bool isHex = (entity[1] == 'x' || entity[1] == 'X');
+        const char* digits = entity.c_str()+(isHex ? 2 : 1);
+        value = strtol(digits, &end, isHex ? 16 : 10);
+        if (*digits == 0 || *end != 0 || value <= 0 || value > 0x10FFFF)
+            throw OpenMMException("XmlSerializer: Malformed XML: illegal character reference '&"+entity+";'");
+        if (value < 0x80)
+            result += (char) value;
+        else if (value < 0x800) {
+            result += (char) (0xC0 | (value>>6));
+            result += (char) (0x80 | (value&0x3F));
+        }
+        else if (value < 0x10000) {
+            result += (char) (0xE0 | (value>>12));
+            result += (char) (0x80 | ((value>>6)&0x3F));
+            result += (char) (0x80 | (value&0x3F));
+        }
+        else {
+            result += (char) (0xF0 | (value>>18));
+            result += (char) (0x80 | ((value>>12)&0x3F));
+            result += (char) (0x80 | ((value>>6)&0x3F));
+            result += (char) (0x80 | (value&0x3F));
+        }
+    }
+    else
+        throw OpenMMException("XmlSerializer: Malformed XML: unknown entity '&"+entity+";'");
+}
+
+static void readName(XmlInputBuffer& reader, string& name) {
+    name.clear();
+    int c = reader.peek();
+    while (c != -1 && !isWhitespace(c) && c != '=' && c != '/' && c != '>' && c != '<') {
+        name += (char) reader.get();
+        c = reader.peek();
+    }
+    if (name.size() == 0)
+        throw OpenMMException("XmlSerializer: Malformed XML: expected a name");
+}
+
 /**
- * Process an XML node, storing its content into a SerializationNode.
+ * Read the next tag from the stream, skipping over any text, comments, and processing instructions
+ * before it.  If the end of the stream is reached, this returns false.
  */
-static void decodeNode(SerializationNode& node, IrrXMLReader& xml) {
-    for (int i = 0; i < xml.getAttributeCount(); i++)
-        node.setStringProperty(xml.getAttributeName(i), xml.getAttributeValue(i));
-    if (xml.isEmptyElement())
-        return;
-    while (xml.read()) {
-        switch (xml.getNodeType()) {
-            case EXN_ELEMENT:
-            {
-                SerializationNode& childNode = node.createChildNode(xml.getNodeName());
-                decodeNode(childNode, xml);
-                break;
+static bool readTag(XmlInputBuffer& reader, XmlTag& tag) {
+    while (true) {
+        int c = reader.get();
+        if (c == -1)
+            return false;
+        if (c != '<')
+            continue;
+        c = reader.peek();
+        if (c == '?') {
+            skipPast(reader, "?>");
+            continue;
+        }
+        if (c == '!') {
+            reader.get();
+            if (reader.peek() == '-')
+                skipPast(reader, "-->");
+            else if (reader.peek() == '[')
+                skipPast(reader, "]]>");
+            else
+                skipPast(reader, ">");
+            continue;
+        }
+        tag.attributes.clear();
+        tag.isEmpty = false;
+        tag.isEnd = (c == '/');
+        if (tag.isEnd)
+            reader.get();
+        readName(reader, tag.name);
+        while (true) {
+            skipWhitespace(reader);
+            c = reader.peek();
+            if (c == '>') {
+                reader.get();
+                return true;
+            }
+            if (c == '/') {
+                reader.get();
+                reader.expect('>');
+                tag.isEmpty = true;
+                return true;
+            }
+            tag.attributes.push_back(pair<string, string>());
+            readName(reader, tag.attributes.back().first);
+            skipWhitespace(reader);
+            reader.expect('=');
+            skipWhitespace(reader);
+            int quote = reader.get();
+            if (quote != '"' && quote != '\'')
+                throw OpenMMException("XmlSerializer: Malformed XML: attribute values must be quoted");
+            string& value = tag.attributes.back().second;
+            while ((c = reader.get()) != quote) {
+                if (c == -1)
+                    throw OpenMMException("XmlSerializer: Unexpected end of stream");
+                if (c == '&')
+                    decodeEntity(reader, value);
+                else
+                    value += (char) c;
             }
-            case EXN_ELEMENT_END:
-                return;
         }
     }
 }
 
+/**
+ * Read the next value of an array property directly from the stream.  If the closing tag is reached
+ * instead, this returns false.
+ */
+static bool readArrayToken(XmlInputBuffer& input, char* token, int maxLength, const string& name) {
+    skipWhitespace(input);
+    if (input.peek() == '<' || input.peek() == -1)
+        return false;
+    int length = 0;
+    while (!isWhitespace(input.peek()) && input.peek() != '<' && input.peek() != -1) {
+        if (length == maxLength-1)
+            throw OpenMMException("XmlSerializer: Illegal value in array property '"+name+"'");
+        token[length++] = (char) input.get();
+    }
+    token[length] = 0;
+    return true;
+}
+
+/**
+ * This SerializationReader parses XML from a stream as each piece of the document is requested.  Only
+ * the start tags of the elements enclosing the current position are held in memory.
+ */
+class XmlStreamReader : public SerializationReader {
+public:
+    XmlStreamReader(std::istream& stream) : input(stream) {
+        XmlTag tag;
+        if (!readTag(input, tag) || tag.isEnd)
+            throw OpenMMException("XmlSerializer: The stream does not contain an XML document");
+        enterElement(tag);
+    }
+    bool nextChild() {
+        if (frames.back().isFinished || frames.back().arrayElement != NULL)
+            return false;
+        XmlTag tag;
+        if (!readTag(input, tag))
+            throw OpenMMException("XmlSerializer: Unexpected end of stream");
+        if (tag.isEnd) {
+            finishElement(tag);
+            return false;
+        }
+        enterElement(tag);
+        return true;
+    }
+    void endNode() {
+        if (frames.size() == 1)
+            throw OpenMMException("XmlSerializer: endNode() called without a matching nextChild()");
+        vector<string> skipped;
+        XmlTag tag;
+        while (!frames.back().isFinished) {
+            if (!readTag(input, tag))
+                throw OpenMMException("XmlSerializer: Unexpected end of stream");
+            if (!tag.isEnd) {
+                if (!tag.isEmpty)
+                    skipped.push_back(tag.name);
+            }
+            else if (skipped.size() > 0) {
+                if (tag.name != skipped.back())
+                    throw OpenMMException("XmlSerializer: Malformed XML: mismatched closing tag '"+tag.name+"'");
+                skipped.pop_back();
+            }
+            else
+                finishElement(tag);
+        }
+        frames.pop_back();
+    }
+    bool isDoubleArray() const {
+        return (frames.back().arrayElement == &DOUBLE_ARRAY_ELEMENT);
+    }
+    bool isIntArray() const {
+        return (frames.back().arrayElement == &INT_ARRAY_ELEMENT);
+    }
+    bool readDoubleArrayValue(double& value) {
+        if (!isDoubleArray())
+            throw OpenMMException("XmlSerializer: '"+getName()+"' is not a double array property");
+        char token[64];
+        if (!readArrayValue(token, sizeof(token)))
+            return false;
+        char* end;
+        value = strtod2(token, &end);
+        if (*end != 0)
+            throw OpenMMException("XmlSerializer: Illegal value in array property '"+getName()+"'");
+        return true;
+    }
+    bool readIntArrayValue(int& value) {
+        if (!isIntArray())
+            throw OpenMMException("XmlSerializer: '"+getName()+"' is not an int array property");
+        char token[64];
+        if (!readArrayValue(token, sizeof(token)))
+            return false;
+        char* end;
+        value = (int) strtol(token, &end, 10);
+        if (*end != 0)
+            throw OpenMMException("XmlSerializer: Illegal value in array property '"+getName()+"'");
+        return true;
+    }
+protected:
+    const SerializationNode& getPropertyNode() const {
+        return frames.back().header;
+    }
+private:
+    /**
+     * This records an element enclosing the current position.  For an array property, header holds
+     * the name of the property.  Otherwise it holds the name and properties of the node.
+     */
+    struct Frame {
+        string element;
+        SerializationNode header;
+        const string* arrayElement;
+        bool isFinished;
+    };
+    void enterElement(const XmlTag& tag) {
+        frames.push_back(Frame());
+        Frame& frame = frames.back();
+        frame.element = tag.name;
+        frame.isFinished = tag.isEmpty;
+        frame.arrayElement = NULL;
+        if (tag.name == DOUBLE_ARRAY_ELEMENT)
+            frame.arrayElement = &DOUBLE_ARRAY_ELEMENT;
+        else if (tag.name == INT_ARRAY_ELEMENT)
+            frame.arrayElement = &INT_ARRAY_ELEMENT;
+        if (frame.arrayElement != NULL) {
+            bool hasName = false;
+            for (int i = 0; i < (int) tag.attributes.size(); i++)
+                if (tag.attributes[i].first == "name") {
+                    frame.header.setName(tag.attributes[i].second);
+                    hasName = true;
+                }
+            if (!hasName)
+                throw OpenMMException("XmlSerializer: Array property is missing a name");
+        }
+        else {
+            frame.header.setName(tag.name);
+            for (int i = 0; i < (int) tag.attributes.size(); i++)
+                if (tag.attributes[i].first != ARRAY_NAMESPACE_ATTRIBUTE)
+                    frame.header.setStringProperty(tag.attributes[i].first, tag.attributes[i].second);
+        }
+    }
+    void finishElement(const XmlTag& tag) {
+        Frame& frame = frames.back();
+        if (tag.name != frame.element) {
+            if (frame.arrayElement != NULL)
+                throw OpenMMException("XmlSerializer: Malformed XML: unterminated array property '"+frame.header.getName()+"'");
+            throw OpenMMException("XmlSerializer: Malformed XML: mismatched closing tag '"+tag.name+"'");
+        }
+        frame.isFinished = true;
+    }
+    bool readArrayValue(char* token, int maxLength) {
+        if (frames.back().isFinished)
+            return false;
+        if (readArrayToken(input, token, maxLength, getName()))
+            return true;
+        XmlTag tag;
+        if (!readTag(input, tag) || !tag.isEnd)
+            throw OpenMMException("XmlSerializer: Malformed XML: unterminated array property '"+getName()+"'");
+        finishElement(tag);
+        return false;
+    }
+    XmlInputBuffer input;
+    vector<Frame> frames;
+};
+
 void* XmlSerializer::deserializeStream(std::istream& stream) {
-    SerializationNode root;
-    StreamReader reader(stream);
-    IrrXMLReader* xml = createIrrXMLReader(&reader);
-    
-    // Find the root node in the file.
-    
-    while (xml->read() && xml->getNodeType() != EXN_ELEMENT)
-        ;
-    decodeNode(root, *xml);
-    delete xml;
-    
-    // Process the SerializationNodes.
-    
-    const SerializationProxy& proxy = SerializationProxy::getProxy(root.getStringProperty("type"));
-    return proxy.deserialize(root);
+    XmlStreamReader reader(stream);
+    const SerializationProxy& proxy = SerializationProxy::getProxy(reader.getStringProperty("type"));
+    return proxy.deserializeIncremental(reader);
 }
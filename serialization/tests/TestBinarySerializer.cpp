@@ -0,0 +1,372 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "OpenMM.h"
+#include "openmm/serialization/BinarySerializer.h"
+#include "openmm/serialization/XmlSerializer.h"
+#include "sfmt/SFMT.h"
+#include <iostream>
+#include <sstream>
+
+using namespace OpenMM;
+using namespace std;
+
+System* createSystem(int numParticles) {
+    System* system = new System();
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    PeriodicTorsionForce* torsions = new PeriodicTorsionForce();
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(0.9);
+    for (int i = 0; i < numParticles; i++) {
+        system->addParticle(1.0+genrand_real2(sfmt));
+        nonbonded->addParticle(genrand_real2(sfmt)-0.5, 0.3, 0.5*i);
+    }
+    for (int i = 0; i < numParticles-1; i++)
+        bonds->addBond(i, i+1, 0.1+0.01*genrand_real2(sfmt), 1000.0*i);
+    for (int i = 0; i < numParticles-2; i++)
+        angles->addAngle(i, i+1, i+2, 1.9, 100.0+i);
+    for (int i = 0; i < numParticles-3; i++)
+        torsions->addTorsion(i, i+1, i+2, i+3, 1+i%3, genrand_real2(sfmt), -5.0);
+    nonbonded->createExceptionsFromBonds(vector<pair<int, int> >(1, pair<int, int>(0, 1)), 0.5, 0.5);
+    system->addForce(bonds);
+    system->addForce(angles);
+    system->addForce(torsions);
+    system->addForce(nonbonded);
+    system->setDefaultPeriodicBoxVectors(Vec3(3, 0, 0), Vec3(0, 3, 0), Vec3(0, 0, 3));
+    return system;
+}
+
+void testSystemRoundTrip() {
+    // Serialize a System in binary format, then deserialize it.  Converting both copies to XML should
+    // give exactly the same result.
+
+    System* system = createSystem(100);
+    stringstream binary(ios::in | ios::out | ios::binary);
+    BinarySerializer::serialize<System>(system, "System", binary);
+    System* copy = BinarySerializer::deserialize<System>(binary);
+    stringstream xml1, xml2;
+    XmlSerializer::serialize<System>(system, "System", xml1);
+    XmlSerializer::serialize<System>(copy, "System", xml2);
+    ASSERT_EQUAL(xml1.str(), xml2.str());
+
+    // The binary representation should be more compact.
+
+    ASSERT(binary.str().size() < xml1.str().size());
+    delete system;
+    delete copy;
+}
+
+/**
+ * Serialize an object in binary format and deserialize it again.  Converting both copies to XML
+ * should give exactly the same result.  The object is deleted afterward.
+ */
+template <class T>
+void testObjectRoundTrip(T* object) {
+    stringstream binary(ios::in | ios::out | ios::binary);
+    BinarySerializer::serialize<T>(object, "Object", binary);
+    T* copy = BinarySerializer::deserialize<T>(binary);
+    stringstream xml1, xml2;
+    XmlSerializer::serialize<T>(object, "Object", xml1);
+    XmlSerializer::serialize<T>(copy, "Object", xml2);
+    ASSERT_EQUAL(xml1.str(), xml2.str());
+    delete object;
+    delete copy;
+}
+
+void testAllProxies() {
+    // Round trip an object of every type that has a serialization proxy.
+
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<double> values(24), params(2);
+    for (int i = 0; i < (int) values.size(); i++)
+        values[i] = genrand_real2(sfmt);
+    vector<int> particles(4);
+    for (int i = 0; i < 4; i++)
+        particles[i] = 2*i;
+
+    // Tabulated functions.
+
+    testObjectRoundTrip<TabulatedFunction>(new Continuous1DFunction(values, -1.0, 2.5));
+    testObjectRoundTrip<TabulatedFunction>(new Continuous2DFunction(4, 6, values, 0.0, 1.0, 0.1, 0.7));
+    testObjectRoundTrip<TabulatedFunction>(new Continuous3DFunction(2, 3, 4, values, 0.0, 1.0, 0.1, 0.7, -1.0, 1.0));
+    testObjectRoundTrip<TabulatedFunction>(new Discrete1DFunction(values));
+    testObjectRoundTrip<TabulatedFunction>(new Discrete2DFunction(4, 6, values));
+    testObjectRoundTrip<TabulatedFunction>(new Discrete3DFunction(2, 3, 4, values));
+
+    // Forces.
+
+    testObjectRoundTrip<Force>(new AndersenThermostat(301.5, 0.1));
+    CMAPTorsionForce* cmap = new CMAPTorsionForce();
+    cmap->addMap(4, vector<double>(values.begin(), values.begin()+16));
+    cmap->addTorsion(0, 0, 1, 2, 3, 1, 2, 3, 4);
+    cmap->addTorsion(0, 5, 6, 7, 8, 6, 7, 8, 9);
+    testObjectRoundTrip<Force>(cmap);
+    testObjectRoundTrip<Force>(new CMMotionRemover(7));
+    CustomAngleForce* customAngle = new CustomAngleForce("k*(theta-theta0)^2");
+    customAngle->addPerAngleParameter("k");
+    customAngle->addPerAngleParameter("theta0");
+    customAngle->addGlobalParameter("scale", 0.5);
+    for (int i = 0; i < 5; i++) {
+        params[0] = values[i];
+        params[1] = values[i+1];
+        customAngle->addAngle(i, i+1, i+2, params);
+    }
+    testObjectRoundTrip<Force>(customAngle);
+    CustomBondForce* customBond = new CustomBondForce("k*(r-r0)^2");
+    customBond->addPerBondParameter("k");
+    customBond->addPerBondParameter("r0");
+    for (int i = 0; i < 5; i++) {
+        params[0] = values[i];
+        params[1] = 1e-20*values[i+1];
+        customBond->addBond(i, i+1, params);
+    }
+    testObjectRoundTrip<Force>(customBond);
+    CustomCentroidBondForce* centroid = new CustomCentroidBondForce(2, "k*distance(g1,g2)^2");
+    centroid->addPerBondParameter("k");
+    centroid->addGroup(particles);
+    centroid->addGroup(particles, vector<double>(values.begin(), values.begin()+4));
+    vector<int> groups(2);
+    groups[0] = 0;
+    groups[1] = 1;
+    centroid->addBond(groups, vector<double>(1, values[0]));
+    testObjectRoundTrip<Force>(centroid);
+    CustomCompoundBondForce* compound = new CustomCompoundBondForce(4, "k*dihedral(p1,p2,p3,p4)+f(distance(p1,p4))");
+    compound->addPerBondParameter("k");
+    compound->addBond(particles, vector<double>(1, values[1]));
+    compound->addTabulatedFunction("f", new Continuous1DFunction(values, 0.0, 2.0));
+    testObjectRoundTrip<Force>(compound);
+    CustomExternalForce* external = new CustomExternalForce("a*x^2");
+    external->addPerParticleParameter("a");
+    for (int i = 0; i < 5; i++)
+        external->addParticle(i, vector<double>(1, values[i]));
+    testObjectRoundTrip<Force>(external);
+    CustomGBForce* customGB = new CustomGBForce();
+    customGB->addPerParticleParameter("q");
+    customGB->addComputedValue("I", "1/r", CustomGBForce::ParticlePairNoExclusions);
+    customGB->addEnergyTerm("q*I", CustomGBForce::SingleParticle);
+    customGB->addEnergyTerm("q1*q2/r", CustomGBForce::ParticlePair);
+    for (int i = 0; i < 5; i++)
+        customGB->addParticle(vector<double>(1, values[i]-0.5));
+    customGB->addExclusion(0, 1);
+    testObjectRoundTrip<Force>(customGB);
+    CustomHbondForce* hbond = new CustomHbondForce("k*distance(d1,a1)");
+    hbond->addPerDonorParameter("k");
+    hbond->addDonor(0, 1, -1, vector<double>(1, values[2]));
+    hbond->addAcceptor(2, 3, 4);
+    hbond->addExclusion(0, 0);
+    testObjectRoundTrip<Force>(hbond);
+    CustomManyParticleForce* manyParticle = new CustomManyParticleForce(3, "c*angle(p1,p2,p3)");
+    manyParticle->addPerParticleParameter("c");
+    for (int i = 0; i < 5; i++)
+        manyParticle->addParticle(vector<double>(1, values[i]), i%2);
+    manyParticle->addExclusion(0, 3);
+    testObjectRoundTrip<Force>(manyParticle);
+    CustomNonbondedForce* customNonbonded = new CustomNonbondedForce("eps*r^2");
+    customNonbonded->addPerParticleParameter("eps");
+    for (int i = 0; i < 5; i++)
+        customNonbonded->addParticle(vector<double>(1, values[i]));
+    customNonbonded->addExclusion(1, 2);
+    customNonbonded->addTabulatedFunction("g", new Discrete2DFunction(4, 6, values));
+    testObjectRoundTrip<Force>(customNonbonded);
+    CustomTorsionForce* customTorsion = new CustomTorsionForce("k*cos(theta)");
+    customTorsion->addPerTorsionParameter("k");
+    customTorsion->addTorsion(0, 1, 2, 3, vector<double>(1, values[3]));
+    testObjectRoundTrip<Force>(customTorsion);
+    GBSAOBCForce* obc = new GBSAOBCForce();
+    for (int i = 0; i < 5; i++)
+        obc->addParticle(values[i]-0.5, 0.15, 0.8);
+    testObjectRoundTrip<Force>(obc);
+    testObjectRoundTrip<Force>(new MonteCarloAnisotropicBarostat(Vec3(1.0, 2.0, 3.0), 300.0, true, false, true, 12));
+    testObjectRoundTrip<Force>(new MonteCarloBarostat(1.5, 310.0, 20));
+    testObjectRoundTrip<Force>(new MonteCarloMembraneBarostat(1.0, 200.0, 300.0, MonteCarloMembraneBarostat::XYAnisotropic, MonteCarloMembraneBarostat::ZFixed, 15));
+    RBTorsionForce* rb = new RBTorsionForce();
+    rb->addTorsion(0, 1, 2, 3, values[0], values[1], values[2], values[3], values[4], values[5]);
+    rb->addTorsion(1, 2, 3, 4, values[6], values[7], values[8], values[9], values[10], values[11]);
+    testObjectRoundTrip<Force>(rb);
+    System* system = createSystem(20);
+    for (int i = 0; i < system->getNumForces(); i++)
+        testObjectRoundTrip<Force>(XmlSerializer::clone<Force>(system->getForce(i)));
+
+    // Systems.
+
+    system->addConstraint(0, 1, 0.1);
+    system->setVirtualSite(5, new TwoParticleAverageSite(3, 4, 0.4, 0.6));
+    testObjectRoundTrip<System>(system);
+
+    // Integrators.
+
+    testObjectRoundTrip<Integrator>(new BrownianIntegrator(300.0, 2.0, 0.002));
+    CompoundIntegrator* compoundIntegrator = new CompoundIntegrator();
+    compoundIntegrator->addIntegrator(new VerletIntegrator(0.001));
+    compoundIntegrator->addIntegrator(new LangevinIntegrator(300.0, 1.0, 0.002));
+    testObjectRoundTrip<Integrator>(compoundIntegrator);
+    CustomIntegrator* customIntegrator = new CustomIntegrator(0.001);
+    customIntegrator->addGlobalVariable("a", values[0]);
+    customIntegrator->addPerDofVariable("b", values[1]);
+    customIntegrator->addComputePerDof("v", "v+dt*f/m");
+    customIntegrator->addComputePerDof("x", "x+dt*v");
+    customIntegrator->addConstrainPositions();
+    testObjectRoundTrip<Integrator>(customIntegrator);
+    testObjectRoundTrip<Integrator>(new LangevinIntegrator(300.0, 1.0, 0.002));
+    testObjectRoundTrip<Integrator>(new VariableLangevinIntegrator(300.0, 1.0, 1e-4));
+    testObjectRoundTrip<Integrator>(new VariableVerletIntegrator(1e-4));
+    testObjectRoundTrip<Integrator>(new VerletIntegrator(0.002));
+
+    // States.
+
+    vector<Vec3> positions, velocities;
+    map<string, double> parameters;
+    for (int i = 0; i < 5; i++) {
+        positions.push_back(Vec3(values[i], values[i+1], values[i+2]));
+        velocities.push_back(Vec3(-values[i], 1e-30*values[i+1], 0.0));
+    }
+    parameters["temperature"] = 300.0;
+    State::StateBuilder builder(1.25);
+    builder.setPositions(positions);
+    builder.setVelocities(velocities);
+    builder.setForces(positions);
+    builder.setParameters(parameters);
+    builder.setEnergy(10.5, -1234.5);
+    builder.setPeriodicBoxVectors(Vec3(2, 0, 0), Vec3(0, 3, 0), Vec3(0.5, 0.5, 4));
+    testObjectRoundTrip<State>(new State(builder.getState()));
+}
+
+void compareNodes(const SerializationNode& node1, const SerializationNode& node2) {
+    ASSERT_EQUAL(node1.getName(), node2.getName());
+    ASSERT(node1.getProperties() == node2.getProperties());
+    ASSERT(node1.getDoubleArrayProperties() == node2.getDoubleArrayProperties());
+    ASSERT(node1.getIntArrayProperties() == node2.getIntArrayProperties());
+    ASSERT_EQUAL(node1.getChildren().size(), node2.getChildren().size());
+    for (int i = 0; i < (int) node1.getChildren().size(); i++)
+        compareNodes(node1.getChildren()[i], node2.getChildren()[i]);
+}
+
+void testNodeRoundTrip() {
+    // Build a node containing a mixture of structures and property types.
+
+    SerializationNode root;
+    root.setName("Root");
+    root.setIntProperty("version", 3);
+    root.setStringProperty("label", "a \"quoted\" label");
+    SerializationNode& list = root.createChildNode("List");
+    for (int i = 0; i < 10; i++) {
+        SerializationNode& item = list.createChildNode("Item");
+        item.setIntProperty("index", -i);
+        item.setDoubleProperty("value", 1.0/(i+1));
+        item.setStringProperty("text", i%2 == 0 ? "even" : "1e500");
+    }
+    list.createChildNode("Other").setDoubleProperty("x", 1e-300);
+    SerializationNode& mixed = list.createChildNode("Item");
+    mixed.setDoubleProperty("index", 0.5);
+    mixed.createChildNode("Child");
+    SerializationNode& item = list.createChildNode("Item");
+    item.setStringProperty("index", "007");
+    list.createChildNode("Item").setStringProperty("index", "2147483648");
+    root.createChildNode("Empty");
+    vector<double> doubles;
+    doubles.push_back(0.1);
+    doubles.push_back(-1e300);
+    vector<int> ints(5, -7);
+    root.createChildNode("Arrays").setDoubleArrayProperty("doubles", doubles).setIntArrayProperty("ints", ints).setIntArrayProperty("empty", vector<int>());
+
+    // Write it and read it back, then compare the XML representations.
+
+    stringstream binary(ios::in | ios::out | ios::binary);
+    BinarySerializer::serialize(root, binary);
+    SerializationNode copy;
+    BinarySerializer::deserialize(copy, binary);
+    compareNodes(root, copy);
+}
+
+void testInvalidData() {
+    stringstream notBinary("<System/>");
+    SerializationNode node;
+    bool threwException = false;
+    try {
+        BinarySerializer::deserialize(node, notBinary);
+    }
+    catch (const OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+
+    // A truncated stream should also be detected.
+
+    System* system = createSystem(10);
+    stringstream binary(ios::in | ios::out | ios::binary);
+    BinarySerializer::serialize<System>(system, "System", binary);
+    delete system;
+    stringstream truncated(binary.str().substr(0, binary.str().size()/2), ios::in | ios::binary);
+    threwException = false;
+    try {
+        BinarySerializer::deserialize(node, truncated);
+    }
+    catch (const OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+
+    // A length larger than the rest of the stream should be rejected before anything is allocated for it.
+
+    string data = binary.str();
+    data[8] = data[9] = data[10] = data[11] = (char) 0xFF;
+    stringstream corrupt(data, ios::in | ios::binary);
+    threwException = false;
+    try {
+        BinarySerializer::deserialize(node, corrupt);
+    }
+    catch (const OpenMMException& ex) {
+        threwException = true;
+        ASSERT_EQUAL(string("BinarySerializer: Invalid length"), string(ex.what()));
+    }
+    ASSERT(threwException);
+}
+
+int main() {
+    try {
+        testSystemRoundTrip();
+        testNodeRoundTrip();
+        testAllProxies();
+        testInvalidData();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
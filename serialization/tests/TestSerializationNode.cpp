@@ -75,9 +75,45 @@ void testProperties() {
     ASSERT_EQUAL(false, node.hasProperty("prop2"));
 }
 
+void testArrayProperties() {
+    SerializationNode node;
+    ASSERT_EQUAL(false, node.hasArrayProperty("array1"));
+    bool exists = false;
+    try {
+        node.getDoubleArrayProperty("array1");
+        exists = true;
+    }
+    catch (const exception& ex) {
+    }
+    ASSERT_EQUAL(false, exists);
+    vector<double> doubles;
+    doubles.push_back(1.5);
+    doubles.push_back(-2.0);
+    vector<int> ints;
+    ints.push_back(3);
+    node.setDoubleArrayProperty("array1", doubles).setIntArrayProperty("array2", ints);
+    ASSERT_EQUAL(true, node.hasArrayProperty("array1"));
+    ASSERT_EQUAL(true, node.hasArrayProperty("array2"));
+    ASSERT_EQUAL(false, node.hasProperty("array1"));
+    ASSERT_EQUAL(2, node.getDoubleArrayProperty("array1").size());
+    ASSERT_EQUAL(-2.0, node.getDoubleArrayProperty("array1")[1]);
+    ASSERT_EQUAL(3, node.getIntArrayProperty("array2")[0]);
+
+    // Array properties must be accessed with the type they were set with.
+
+    try {
+        node.getIntArrayProperty("array1");
+        exists = true;
+    }
+    catch (const exception& ex) {
+    }
+    ASSERT_EQUAL(false, exists);
+}
+
 int main() {
     try {
         testProperties();
+        testArrayProperties();
     }
     catch(const exception& e) {
         cout << "exception: " << e.what() << endl;
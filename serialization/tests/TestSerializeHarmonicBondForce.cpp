@@ -73,9 +73,34 @@ void testSerialization() {
     }
 }
 
+void testVersion2Format() {
+    // Files written by older versions store one child node per bond.  Make sure they can still be read.
+
+    stringstream buffer;
+    buffer << "<?xml version=\"1.0\" ?>\n";
+    buffer << "<Force forceGroup=\"1\" type=\"HarmonicBondForce\" usesPeriodic=\"0\" version=\"2\">\n";
+    buffer << "<Bonds>\n";
+    buffer << "<Bond d=\"1.5\" k=\"2\" p1=\"0\" p2=\"1\"/>\n";
+    buffer << "<Bond d=\"2.5\" k=\"3\" p1=\"3\" p2=\"2\"/>\n";
+    buffer << "</Bonds>\n";
+    buffer << "</Force>\n";
+    HarmonicBondForce* force = XmlSerializer::deserialize<HarmonicBondForce>(buffer);
+    ASSERT_EQUAL(1, force->getForceGroup());
+    ASSERT_EQUAL(2, force->getNumBonds());
+    int p1, p2;
+    double d, k;
+    force->getBondParameters(1, p1, p2, d, k);
+    ASSERT_EQUAL(3, p1);
+    ASSERT_EQUAL(2, p2);
+    ASSERT_EQUAL(2.5, d);
+    ASSERT_EQUAL(3.0, k);
+    delete force;
+}
+
 int main() {
     try {
         testSerialization();
+        testVersion2Format();
     }
     catch(const exception& e) {
         cout << "exception: " << e.what() << endl;
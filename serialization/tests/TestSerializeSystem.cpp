@@ -119,9 +119,49 @@ void testSerialization() {
     delete copy;
 }
 
+void testVersion1Format() {
+    // Files written by older versions store one child node per particle and constraint.  Make sure they can still be read.
+
+    stringstream buffer;
+    buffer << "<?xml version=\"1.0\" ?>\n";
+    buffer << "<System openmmVersion=\"6.3\" type=\"System\" version=\"1\">\n";
+    buffer << "<PeriodicBoxVectors>\n";
+    buffer << "<A x=\"2\" y=\"0\" z=\"0\"/>\n";
+    buffer << "<B x=\"0\" y=\"2\" z=\"0\"/>\n";
+    buffer << "<C x=\"0\" y=\"0\" z=\"2\"/>\n";
+    buffer << "</PeriodicBoxVectors>\n";
+    buffer << "<Particles>\n";
+    buffer << "<Particle mass=\"1.5\"/>\n";
+    buffer << "<Particle mass=\"2.5\"/>\n";
+    buffer << "<Particle mass=\"0\">\n";
+    buffer << "<TwoParticleAverageSite p1=\"0\" p2=\"1\" w1=\"0.4\" w2=\"0.6\"/>\n";
+    buffer << "</Particle>\n";
+    buffer << "</Particles>\n";
+    buffer << "<Constraints>\n";
+    buffer << "<Constraint d=\"0.1\" p1=\"0\" p2=\"1\"/>\n";
+    buffer << "</Constraints>\n";
+    buffer << "<Forces/>\n";
+    buffer << "</System>\n";
+    System* system = XmlSerializer::deserialize<System>(buffer);
+    ASSERT_EQUAL(3, system->getNumParticles());
+    ASSERT_EQUAL(2.5, system->getParticleMass(1));
+    ASSERT(!system->isVirtualSite(1));
+    ASSERT(system->isVirtualSite(2));
+    ASSERT_EQUAL(0.6, dynamic_cast<const TwoParticleAverageSite&>(system->getVirtualSite(2)).getWeight(1));
+    ASSERT_EQUAL(1, system->getNumConstraints());
+    int p1, p2;
+    double d;
+    system->getConstraintParameters(0, p1, p2, d);
+    ASSERT_EQUAL(0, p1);
+    ASSERT_EQUAL(1, p2);
+    ASSERT_EQUAL(0.1, d);
+    delete system;
+}
+
 int main() {
     try {
         testSerialization();
+        testVersion1Format();
     }
     catch(const exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -0,0 +1,489 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/CustomBondForce.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/State.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "openmm/serialization/IncrementalSerializationProxy.h"
+#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/serialization/XmlSerializer.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * A stream buffer that delivers a string a few characters at a time and does not support
+ * seeking, like a pipe.
+ */
+class PipeBuffer : public streambuf {
+public:
+    PipeBuffer(const string& data) : data(data), position(0) {
+    }
+protected:
+    int_type underflow() {
+        if (position >= data.size())
+            return traits_type::eof();
+        int length = min((size_t) 7, data.size()-position);
+        memcpy(buffer, &data[position], length);
+        position += length;
+        setg(buffer, buffer, buffer+length);
+        return traits_type::to_int_type(buffer[0]);
+    }
+private:
+    string data;
+    size_t position;
+    char buffer[7];
+};
+
+/**
+ * A stream buffer that counts how many characters have been read from it or written to it.  Input is
+ * delivered a few thousand characters at a time, and output is appended to a string.
+ */
+class CountingBuffer : public streambuf {
+public:
+    CountingBuffer() : position(0) {
+    }
+    CountingBuffer(const string& data) : data(data), position(0) {
+    }
+    size_t getCount() const {
+        return position;
+    }
+    const string& getData() const {
+        return data;
+    }
+protected:
+    int_type underflow() {
+        if (position >= data.size())
+            return traits_type::eof();
+        int length = min(sizeof(buffer), data.size()-position);
+        memcpy(buffer, &data[position], length);
+        position += length;
+        setg(buffer, buffer, buffer+length);
+        return traits_type::to_int_type(buffer[0]);
+    }
+    int_type overflow(int_type c) {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            data += traits_type::to_char_type(c);
+            position++;
+        }
+        return traits_type::not_eof(c);
+    }
+    streamsize xsputn(const char* s, streamsize n) {
+        data.append(s, n);
+        position += n;
+        return n;
+    }
+private:
+    string data;
+    size_t position;
+    char buffer[4096];
+};
+
+System* createSystem() {
+    System* system = new System();
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    NonbondedForce* nonbonded = new NonbondedForce();
+    for (int i = 0; i < 1000; i++) {
+        system->addParticle(1.0+0.001*i);
+        nonbonded->addParticle(0.1*(i%7)-0.3, 0.3+1e-5*i, 0.5);
+    }
+    for (int i = 0; i < 999; i++)
+        bonds->addBond(i, i+1, 0.1, 1000.0/(i+1));
+    system->addForce(bonds);
+    system->addForce(nonbonded);
+    return system;
+}
+
+void testNonSeekableStream() {
+    // Deserialize a System from a stream that cannot seek and delivers only a few characters at a time.
+
+    System* system = createSystem();
+    stringstream buffer;
+    XmlSerializer::serialize<System>(system, "System", buffer);
+    PipeBuffer pipe(buffer.str());
+    istream input(&pipe);
+    System* copy = XmlSerializer::deserialize<System>(input);
+    stringstream buffer2;
+    XmlSerializer::serialize<System>(copy, "System", buffer2);
+    ASSERT_EQUAL(buffer.str(), buffer2.str());
+    delete system;
+    delete copy;
+}
+
+void testIncrementalProxies() {
+    // The proxies for large core objects should describe them incrementally.  Others use the tree of SerializationNodes.
+
+    const char* incremental[] = {"System", "State", "VerletIntegrator", "LangevinIntegrator", "BrownianIntegrator",
+            "VariableVerletIntegrator", "VariableLangevinIntegrator", "CustomIntegrator", "CompoundIntegrator"};
+    for (int i = 0; i < 9; i++)
+        ASSERT(dynamic_cast<const IncrementalSerializationProxy*>(&SerializationProxy::getProxy(incremental[i])) != NULL);
+    ASSERT(dynamic_cast<const IncrementalSerializationProxy*>(&SerializationProxy::getProxy("HarmonicBondForce")) == NULL);
+}
+
+/**
+ * A large array of values, whose proxy records how much of the stream had been processed when each value was
+ * written or read.
+ */
+class LargeArray {
+public:
+    vector<double> values;
+};
+
+static CountingBuffer* activeBuffer;
+static vector<size_t> counts;
+
+class LargeArrayProxy : public IncrementalSerializationProxy {
+public:
+    LargeArrayProxy() : IncrementalSerializationProxy("LargeArray") {
+    }
+    void serializeIncremental(const void* object, SerializationWriter& writer) const {
+        const LargeArray& array = *reinterpret_cast<const LargeArray*>(object);
+        writer.setIntProperty("version", 1);
+        writer.beginDoubleArray("values");
+        for (int i = 0; i < (int) array.values.size(); i++) {
+            counts.push_back(activeBuffer->getCount());
+            writer.writeDoubleArrayValue(array.values[i]);
+        }
+        writer.endArray();
+    }
+    void* deserializeIncremental(SerializationReader& reader) const {
+        LargeArray* array = new LargeArray();
+        ASSERT(reader.nextChild());
+        ASSERT(reader.isDoubleArray());
+        double value;
+        while (reader.readDoubleArrayValue(value)) {
+            counts.push_back(activeBuffer->getCount());
+            array->values.push_back(value);
+        }
+        reader.endNode();
+        ASSERT(!reader.nextChild());
+        return array;
+    }
+};
+
+void testArrayStreamedByElement() {
+    // Write and read an array much larger than any buffer, and check that each value was processed while
+    // only the part of the document around it had been written or read.
+
+    SerializationProxy::registerProxy(typeid(LargeArray), new LargeArrayProxy());
+    LargeArray array;
+    for (int i = 0; i < 200000; i++)
+        array.values.push_back(1.0/(i+3));
+    CountingBuffer output;
+    activeBuffer = &output;
+    counts.clear();
+    ostream outputStream(&output);
+    XmlSerializer::serialize<LargeArray>(&array, "LargeArray", outputStream);
+    const string& xml = output.getData();
+    ASSERT(xml.size() > 2000000);
+
+    // Find where each value appears in the document.  No more than one buffer of text should have been
+    // written when a value was passed to the writer, or read when it was returned by the reader.
+
+    vector<size_t> offsets;
+    size_t position = xml.find('>', xml.find("omm:DoubleArray"))+1;
+    for (int i = 0; i < (int) array.values.size(); i++) {
+        offsets.push_back(position);
+        position = xml.find_first_of(" <", position)+1;
+    }
+    ASSERT_EQUAL(array.values.size(), counts.size());
+    for (int i = 0; i < (int) counts.size(); i++)
+        ASSERT(counts[i] <= offsets[i] && counts[i]+4096 >= offsets[i]);
+    CountingBuffer input(xml);
+    activeBuffer = &input;
+    counts.clear();
+    istream inputStream(&input);
+    LargeArray* copy = XmlSerializer::deserialize<LargeArray>(inputStream);
+    ASSERT(array.values == copy->values);
+    ASSERT_EQUAL(array.values.size(), counts.size());
+    for (int i = 0; i < (int) counts.size(); i++)
+        ASSERT(counts[i] > offsets[i] && counts[i] <= offsets[i]+65536+4096);
+    delete copy;
+}
+
+/**
+ * A Force that records how much of the stream had been processed when it was serialized or deserialized.
+ * Its proxy uses the default tree based implementation, like the proxies in plugins.
+ */
+class MarkerForce : public Force {
+protected:
+    ForceImpl* createImpl() const {
+        throw OpenMMException("MarkerForce cannot be simulated");
+    }
+};
+
+class MarkerForceProxy : public SerializationProxy {
+public:
+    MarkerForceProxy() : SerializationProxy("MarkerForce") {
+    }
+    void serialize(const void* object, SerializationNode& node) const {
+        counts.push_back(activeBuffer->getCount());
+        node.setIntProperty("version", 1);
+    }
+    void* deserialize(const SerializationNode& node) const {
+        counts.push_back(activeBuffer->getCount());
+        return new MarkerForce();
+    }
+};
+
+void testSystemStreamedByForce() {
+    // Put a large Force between two markers, and check that the first marker was written and read before
+    // the large Force had been.
+
+    SerializationProxy::registerProxy(typeid(MarkerForce), new MarkerForceProxy());
+    System* system = createSystem();
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    for (int i = 0; i < 50000; i++)
+        bonds->addBond(i%1000, (i+1)%1000, 0.1+1e-6*i, 1000.0/(i+1));
+    system->addForce(new MarkerForce());
+    system->addForce(bonds);
+    system->addForce(new MarkerForce());
+    CountingBuffer output;
+    activeBuffer = &output;
+    counts.clear();
+    ostream outputStream(&output);
+    XmlSerializer::serialize<System>(system, "System", outputStream);
+    size_t size = output.getData().size();
+    ASSERT(size > 1000000);
+    ASSERT_EQUAL(2, counts.size());
+    ASSERT(counts[0] < size/4);
+    ASSERT(counts[1] > 3*size/4);
+    CountingBuffer input(output.getData());
+    activeBuffer = &input;
+    counts.clear();
+    istream inputStream(&input);
+    System* copy = XmlSerializer::deserialize<System>(inputStream);
+    ASSERT_EQUAL(2, counts.size());
+    ASSERT(counts[0] < size/4);
+    ASSERT(counts[1] > 3*size/4);
+    ASSERT_EQUAL(system->getNumParticles(), copy->getNumParticles());
+    ASSERT_EQUAL(5, copy->getNumForces());
+    ASSERT(dynamic_cast<MarkerForce*>(&copy->getForce(2)) != NULL);
+    const HarmonicBondForce& bonds2 = dynamic_cast<const HarmonicBondForce&>(copy->getForce(3));
+    ASSERT_EQUAL(bonds->getNumBonds(), bonds2.getNumBonds());
+    for (int i = 0; i < bonds->getNumBonds(); i += 100) {
+        int p1, p2, q1, q2;
+        double length1, length2, k1, k2;
+        bonds->getBondParameters(i, p1, p2, length1, k1);
+        bonds2.getBondParameters(i, q1, q2, length2, k2);
+        ASSERT_EQUAL(p1, q1);
+        ASSERT_EQUAL(p2, q2);
+        ASSERT_EQUAL(length1, length2);
+        ASSERT_EQUAL(k1, k2);
+    }
+    delete system;
+    delete copy;
+}
+
+void testStateRoundTrip() {
+    // A State should be the same after passing through XML, or through a tree of SerializationNodes.
+
+    State::StateBuilder builder(2.5);
+    vector<Vec3> positions, velocities;
+    for (int i = 0; i < 100; i++) {
+        positions.push_back(Vec3(0.1*i, 1.0/(i+1), -0.3*i));
+        velocities.push_back(Vec3(-1.0/(i+2), 0.2*i, 0.5));
+    }
+    map<string, double> parameters;
+    parameters["a"] = 1.5;
+    parameters["b"] = -0.25;
+    builder.setPositions(positions);
+    builder.setVelocities(velocities);
+    builder.setParameters(parameters);
+    builder.setEnergy(3.0, -7.5);
+    builder.setPeriodicBoxVectors(Vec3(2, 0, 0), Vec3(0.5, 3, 0), Vec3(0, 0.25, 4));
+    State state = builder.getState();
+    stringstream buffer;
+    XmlSerializer::serialize<State>(&state, "State", buffer);
+    State* copies[2];
+    copies[0] = XmlSerializer::deserialize<State>(buffer);
+    copies[1] = XmlSerializer::clone<State>(state);
+    for (int j = 0; j < 2; j++) {
+        const State& copy = *copies[j];
+        ASSERT_EQUAL(state.getDataTypes(), copy.getDataTypes());
+        ASSERT_EQUAL(state.getTime(), copy.getTime());
+        ASSERT_EQUAL(state.getKineticEnergy(), copy.getKineticEnergy());
+        ASSERT_EQUAL(state.getPotentialEnergy(), copy.getPotentialEnergy());
+        ASSERT(parameters == copy.getParameters());
+        ASSERT_EQUAL(positions.size(), copy.getPositions().size());
+        for (int i = 0; i < (int) positions.size(); i++) {
+            ASSERT_EQUAL_VEC(positions[i], copy.getPositions()[i], 0);
+            ASSERT_EQUAL_VEC(velocities[i], copy.getVelocities()[i], 0);
+        }
+        Vec3 a, b, c;
+        copy.getPeriodicBoxVectors(a, b, c);
+        ASSERT_EQUAL_VEC(Vec3(0.5, 3, 0), b, 0);
+        delete copies[j];
+    }
+}
+
+void testParsing() {
+    // Make sure comments, processing instructions, entities, and single quoted attributes are handled correctly.
+
+    stringstream buffer;
+    buffer << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    buffer << "<!-- A comment containing <tags> -->\n";
+    buffer << "<Force xmlns:omm=\"urn:openmm:serialization\" type='HarmonicBondForce' version=\"3\" forceGroup = \"2\" usesPeriodic=\"0\">\n";
+    buffer << "  <!-- Another comment -->\n";
+    buffer << "  <Bonds>\n";
+    buffer << "    <omm:IntArray name=\"p1\">0 2</omm:IntArray>\n";
+    buffer << "    <omm:IntArray name='p2'>\n1\n3\n</omm:IntArray>\n";
+    buffer << "    <omm:DoubleArray name=\"d\">1.5 -2e-3</omm:DoubleArray>\n";
+    buffer << "    <omm:DoubleArray name=\"k\">10 20</omm:DoubleArray>\n";
+    buffer << "  </Bonds>\n";
+    buffer << "</Force>\n";
+    HarmonicBondForce* force = XmlSerializer::deserialize<HarmonicBondForce>(buffer);
+    ASSERT_EQUAL(2, force->getForceGroup());
+    ASSERT_EQUAL(2, force->getNumBonds());
+    int p1, p2;
+    double d, k;
+    force->getBondParameters(1, p1, p2, d, k);
+    ASSERT_EQUAL(2, p1);
+    ASSERT_EQUAL(3, p2);
+    ASSERT_EQUAL(-2e-3, d);
+    ASSERT_EQUAL(20.0, k);
+    delete force;
+}
+
+void testCharacterReferences() {
+    // Character references should be decoded as UTF-8.
+
+    CustomBondForce force("PLACEHOLDER");
+    stringstream buffer;
+    XmlSerializer::serialize<CustomBondForce>(&force, "Force", buffer);
+    string xml = buffer.str();
+    size_t index = xml.find("PLACEHOLDER");
+    stringstream encoded(xml.substr(0, index)+"A&#66;&#xe9;&#x4E2D;&#128512;"+xml.substr(index+11));
+    CustomBondForce* copy = XmlSerializer::deserialize<CustomBondForce>(encoded);
+    ASSERT_EQUAL(string("AB\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80"), copy->getEnergyFunction());
+    delete copy;
+
+    // Invalid references should be rejected.
+
+    const char* invalid[] = {"&#;", "&#x;", "&#12a;", "&#x110000;", "&#0;"};
+    for (int i = 0; i < 5; i++) {
+        stringstream bad(xml.substr(0, index)+invalid[i]+xml.substr(index+11));
+        bool threwException = false;
+        try {
+            delete XmlSerializer::deserialize<CustomBondForce>(bad);
+        }
+        catch (const OpenMMException& ex) {
+            threwException = true;
+        }
+        ASSERT(threwException);
+    }
+}
+
+/**
+ * A class whose proxy creates a child node with the same name as the elements used for array properties.
+ */
+class NamedValues {
+public:
+    vector<double> values;
+    double extra;
+};
+
+class NamedValuesProxy : public SerializationProxy {
+public:
+    NamedValuesProxy() : SerializationProxy("NamedValues") {
+    }
+    void serialize(const void* object, SerializationNode& node) const {
+        const NamedValues& named = *reinterpret_cast<const NamedValues*>(object);
+        node.setDoubleArrayProperty("values", named.values);
+        node.createChildNode("DoubleArray").setDoubleProperty("extra", named.extra);
+    }
+    void* deserialize(const SerializationNode& node) const {
+        NamedValues* named = new NamedValues();
+        named->values = node.getDoubleArrayProperty("values");
+        ASSERT_EQUAL(1, node.getChildren().size());
+        named->extra = node.getChildNode("DoubleArray").getDoubleProperty("extra");
+        return named;
+    }
+};
+
+void testChildNamedLikeArray() {
+    // A child node named like an array element should be read back as a child node.
+
+    SerializationProxy::registerProxy(typeid(NamedValues), new NamedValuesProxy());
+    NamedValues named;
+    named.values.push_back(1.5);
+    named.values.push_back(-2.0);
+    named.extra = 3.25;
+    stringstream buffer;
+    XmlSerializer::serialize<NamedValues>(&named, "NamedValues", buffer);
+    NamedValues* copy = XmlSerializer::deserialize<NamedValues>(buffer);
+    ASSERT(named.values == copy->values);
+    ASSERT_EQUAL(named.extra, copy->extra);
+    delete copy;
+}
+
+void testMalformedDocument() {
+    stringstream buffer;
+    buffer << "<Force type=\"HarmonicBondForce\" version=\"3\">\n";
+    buffer << "  <Bonds>\n";
+    buffer << "    <omm:IntArray name=\"p1\">0 2</omm:IntArray>\n";
+    bool threwException = false;
+    try {
+        XmlSerializer::deserialize<HarmonicBondForce>(buffer);
+    }
+    catch (const OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+}
+
+int main() {
+    try {
+        testNonSeekableStream();
+        testIncrementalProxies();
+        testArrayStreamedByElement();
+        testSystemStreamedByForce();
+        testStateRoundTrip();
+        testParsing();
+        testCharacterReferences();
+        testChildNamedLikeArray();
+        testMalformedDocument();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
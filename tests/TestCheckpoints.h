@@ -31,11 +31,17 @@
 
 #include "openmm/internal/AssertionUtilities.h"
 #include "openmm/AndersenThermostat.h"
+#include "openmm/AsyncCheckpointWriter.h"
 #include "openmm/Context.h"
+#include "openmm/CustomIntegrator.h"
+#include "openmm/MonteCarloBarostat.h"
 #include "openmm/NonbondedForce.h"
+#include "openmm/OpenMMException.h"
 #include "openmm/System.h"
 #include "openmm/VerletIntegrator.h"
 #include "sfmt/SFMT.h"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -116,12 +122,155 @@ void testSetState() {
     }
 }
 
+void testForceAndIntegratorState() {
+    const int numParticles = 20;
+    const double boxSize = 3.0;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    MonteCarloBarostat* barostat = new MonteCarloBarostat(100.0, 300.0, 1);
+    system.addForce(barostat);
+    NonbondedForce* nonbonded = new NonbondedForce();
+    system.addForce(nonbonded);
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    vector<Vec3> positions(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(0.0, 0.2, 0.5);
+        positions[i] = Vec3((i%4)*0.75, ((i/4)%4)*0.75, (i/16)*0.75)+Vec3(0.1*genrand_real2(sfmt), 0.1*genrand_real2(sfmt), 0.1*genrand_real2(sfmt));
+    }
+    CustomIntegrator integrator(0.002);
+    integrator.addGlobalVariable("steps", 0.0);
+    integrator.addPerDofVariable("x0", 0.0);
+    integrator.addComputePerDof("x0", "x");
+    integrator.addComputePerDof("v", "v+0.5*dt*f/m");
+    integrator.addComputePerDof("x", "x+dt*v");
+    integrator.addComputePerDof("v", "v+0.5*dt*f/m");
+    integrator.addComputeGlobal("steps", "steps+1");
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    context.setVelocitiesToTemperature(300.0);
+    integrator.step(20);
+
+    // Make a checkpoint, continue the simulation, then go back and repeat the same steps.  The barostat's
+    // random number generator and the integrator's variables are both part of the checkpoint, so the
+    // two runs should follow the same trajectory.
+
+    stringstream stream(ios_base::out | ios_base::in | ios_base::binary);
+    context.createCheckpoint(stream);
+    integrator.step(20);
+    State s1 = context.getState(State::Positions | State::Velocities | State::Parameters);
+    double steps = integrator.getGlobalVariable(0);
+    vector<Vec3> x0;
+    integrator.getPerDofVariable(0, x0);
+    integrator.setGlobalVariable(0, -1.0);
+    context.loadCheckpoint(stream);
+    ASSERT_EQUAL(20.0, integrator.getGlobalVariable(0));
+    integrator.step(20);
+    State s2 = context.getState(State::Positions | State::Velocities | State::Parameters);
+    compareStates(s1, s2);
+    ASSERT_EQUAL(steps, integrator.getGlobalVariable(0));
+    vector<Vec3> x1;
+    integrator.getPerDofVariable(0, x1);
+    for (int i = 0; i < numParticles; i++)
+        ASSERT_EQUAL_VEC(x0[i], x1[i], TOL);
+}
+
+void testAsyncCheckpoint() {
+    const int numParticles = 10;
+    const double boxSize = 3.0;
+    System system;
+    system.addForce(new AndersenThermostat(300.0, 100.0));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    system.addForce(nonbonded);
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    vector<Vec3> positions(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.1 : -0.1, 0.2, 0.1);
+        positions[i] = Vec3(boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt));
+    }
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    context.setPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    integrator.step(10);
+
+    // Create several checkpoints, integrating between them while they are being written.
+
+    AsyncCheckpointWriter writer(context);
+    const int numCheckpoints = 4;
+    vector<stringstream*> streams(numCheckpoints);
+    vector<State> states;
+    for (int i = 0; i < numCheckpoints; i++) {
+        states.push_back(context.getState(State::Positions | State::Velocities | State::Parameters));
+        streams[i] = new stringstream(ios_base::out | ios_base::in | ios_base::binary);
+        ASSERT_EQUAL(i, writer.createCheckpoint(*streams[i]));
+        integrator.step(10);
+    }
+    writer.waitForAll();
+
+    // Each checkpoint should match the state at the moment it was created, and should be identical
+    // to one written synchronously.
+
+    for (int i = 0; i < numCheckpoints; i++) {
+        ASSERT(writer.isComplete(i));
+        writer.waitForCompletion(i);
+        context.loadCheckpoint(*streams[i]);
+        State s = context.getState(State::Positions | State::Velocities | State::Parameters);
+        compareStates(states[i], s);
+        stringstream expected(ios_base::out | ios_base::in | ios_base::binary);
+        context.createCheckpoint(expected);
+        ASSERT(expected.str() == streams[i]->str());
+        delete streams[i];
+    }
+
+    // Write a checkpoint to a file and make sure it can be loaded.
+
+    State fileState = context.getState(State::Positions | State::Velocities | State::Parameters);
+    const string filename = "TestAsyncCheckpoint.chk";
+    int fileIndex = writer.writeCheckpoint(filename);
+    integrator.step(10);
+    writer.waitForCompletion(fileIndex);
+    ifstream file(filename.c_str(), ios_base::in | ios_base::binary);
+    context.loadCheckpoint(file);
+    file.close();
+    remove(filename.c_str());
+    State s = context.getState(State::Positions | State::Velocities | State::Parameters);
+    compareStates(fileState, s);
+
+    // An error writing a checkpoint should be reported once, and not affect later checkpoints.
+
+    stringstream badStream(ios_base::out | ios_base::in | ios_base::binary);
+    badStream.setstate(ios_base::badbit);
+    int badIndex = writer.createCheckpoint(badStream);
+    bool threwException = false;
+    try {
+        writer.waitForAll();
+    }
+    catch (OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+    writer.waitForAll();
+    writer.waitForCompletion(badIndex);
+    stringstream goodStream(ios_base::out | ios_base::in | ios_base::binary);
+    writer.waitForCompletion(writer.createCheckpoint(goodStream));
+    writer.waitForAll();
+}
+
 void runPlatformTests();
 
 int main(int argc, char* argv[]) {
     try {
         initializeTests(argc, argv);
         testSetState();
+        testForceAndIntegratorState();
+        testAsyncCheckpoint();
         runPlatformTests();
     }
     catch(const exception& e) {
@@ -33,6 +33,8 @@
 #include "openmm/CustomNonbondedForce.h"
 #include "openmm/NonbondedForce.h"
 #include "openmm/OpenMMException.h"
+#include "sfmt/SFMT.h"
+#include <cmath>
 #include <iostream>
 #include <set>
 #include <vector>
@@ -167,6 +169,157 @@ void testReplaceExceptions() {
     ASSERT(charge == 5.0);
 }
 
+/**
+ * Test adding many exceptions at once.
+ */
+
+void testAddExceptions() {
+    NonbondedForce nonbonded;
+    for (int i = 0; i < 10; i++)
+        nonbonded.addParticle(1.0, 1.0, 0.0);
+    vector<pair<int, int> > pairs;
+    vector<double> charge, sigma, epsilon;
+    for (int i = 1; i < 6; i++) {
+        pairs.push_back(pair<int, int>(i, i-1));
+        charge.push_back(i);
+        sigma.push_back(0.1*i);
+        epsilon.push_back(0.5*i);
+    }
+    nonbonded.addExceptions(pairs, charge, sigma, epsilon);
+    ASSERT_EQUAL(5, nonbonded.getNumExceptions());
+    for (int i = 0; i < 5; i++) {
+        int p1, p2;
+        double c, s, e;
+        nonbonded.getExceptionParameters(i, p1, p2, c, s, e);
+        ASSERT_EQUAL(i+1, p1);
+        ASSERT_EQUAL(i, p2);
+        ASSERT_EQUAL(i+1.0, c);
+        ASSERT_EQUAL(0.1*(i+1), s);
+        ASSERT_EQUAL(0.5*(i+1), e);
+    }
+
+    // Adding a pair that already exists, in either order, should fail unless replace is true.
+
+    vector<pair<int, int> > more(1, pair<int, int>(2, 3));
+    vector<double> one(1, 1.0);
+    try {
+        nonbonded.addExceptions(more, one, one, one);
+        throw std::exception();
+    }
+    catch (const OpenMMException ex) {
+        // This should have thrown an exception.
+    }
+    nonbonded.addExceptions(more, one, one, one, true);
+    ASSERT_EQUAL(5, nonbonded.getNumExceptions());
+
+    // Duplicates within a single call are detected too.
+
+    NonbondedForce nonbonded2;
+    for (int i = 0; i < 10; i++)
+        nonbonded2.addParticle(1.0, 1.0, 0.0);
+    pairs.push_back(pair<int, int>(0, 1));
+    charge.push_back(1.0);
+    sigma.push_back(1.0);
+    epsilon.push_back(1.0);
+    try {
+        nonbonded2.addExceptions(pairs, charge, sigma, epsilon);
+        throw std::exception();
+    }
+    catch (const OpenMMException ex) {
+        // This should have thrown an exception.
+    }
+}
+
+/**
+ * Find exceptions for a large system with a random topology, and compare them to ones found by
+ * directly searching sets of bonded particles.
+ */
+
+void addBondedToSet(const vector<set<int> >& bonded12, set<int>& result, int baseParticle, int fromParticle, int currentLevel) {
+    for (set<int>::const_iterator iter = bonded12[fromParticle].begin(); iter != bonded12[fromParticle].end(); ++iter) {
+        if (*iter != baseParticle)
+            result.insert(*iter);
+        if (currentLevel > 0)
+            addBondedToSet(bonded12, result, baseParticle, *iter, currentLevel-1);
+    }
+}
+
+void testLargeSystem() {
+    const int numParticles = 40000;
+    NonbondedForce nonbonded;
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++)
+        nonbonded.addParticle(genrand_real2(sfmt)-0.5, 0.1+0.2*genrand_real2(sfmt), genrand_real2(sfmt));
+
+    // Create chains with branches and occasional rings.
+
+    vector<pair<int, int> > bonds;
+    vector<set<int> > bonded12(numParticles);
+    vector<int> parent(numParticles, -1);
+    int numRings = 0;
+    for (int i = 1; i < numParticles; i++) {
+        int j = -1;
+        double r = genrand_real2(sfmt);
+        if (r < 0.7)
+            j = i-1;
+        else if (r < 0.9)
+            j = i-1-(int) (5*genrand_real2(sfmt));
+        if (j >= 0) {
+            bonds.push_back(pair<int, int>(j, i));
+            bonded12[i].insert(j);
+            bonded12[j].insert(i);
+            parent[i] = j;
+
+            // Sometimes close a ring of 3 to 6 atoms by bonding to an ancestor.
+
+            if (genrand_real2(sfmt) < 0.05) {
+                int k = j;
+                int depth = 2+(int) (4*genrand_real2(sfmt));
+                for (int d = 1; d < depth && k >= 0; d++)
+                    k = parent[k];
+                if (k >= 0 && bonded12[i].find(k) == bonded12[i].end()) {
+                    bonds.push_back(pair<int, int>(k, i));
+                    bonded12[i].insert(k);
+                    bonded12[k].insert(i);
+                    numRings++;
+                }
+            }
+        }
+    }
+    ASSERT(numRings > 100);
+    nonbonded.createExceptionsFromBonds(bonds, 0.5, 0.25);
+
+    // Compare them, including the order they were added in.
+
+    int index = 0;
+    for (int i = 0; i < numParticles; i++) {
+        set<int> bonded13, bonded14;
+        addBondedToSet(bonded12, bonded13, i, i, 1);
+        addBondedToSet(bonded12, bonded14, i, i, 2);
+        for (set<int>::const_iterator iter = bonded14.begin(); iter != bonded14.end() && *iter < i; ++iter) {
+            int p1, p2;
+            double chargeProd, sigma, epsilon;
+            nonbonded.getExceptionParameters(index++, p1, p2, chargeProd, sigma, epsilon);
+            ASSERT_EQUAL(*iter, p1);
+            ASSERT_EQUAL(i, p2);
+            if (bonded13.find(*iter) == bonded13.end()) {
+                double q1, q2, s1, s2, e1, e2;
+                nonbonded.getParticleParameters(p1, q1, s1, e1);
+                nonbonded.getParticleParameters(p2, q2, s2, e2);
+                ASSERT_EQUAL_TOL(0.5*q1*q2, chargeProd, 1e-10);
+                ASSERT_EQUAL_TOL(0.5*(s1+s2), sigma, 1e-10);
+                ASSERT_EQUAL_TOL(0.25*sqrt(e1*e2), epsilon, 1e-10);
+            }
+            else {
+                ASSERT_EQUAL(0.0, chargeProd);
+                ASSERT_EQUAL(0.0, epsilon);
+            }
+        }
+    }
+    ASSERT_EQUAL(index, nonbonded.getNumExceptions());
+}
+
 /**
  * This is the same as testFindExceptions(), except it tests adding exclusions to a CustomNonbondedForce.
  */
@@ -222,6 +375,8 @@ int main() {
     try {
         testFindExceptions();
         testReplaceExceptions();
+        testAddExceptions();
+        testLargeSystem();
         testFindCustomExclusions();
     }
     catch(const exception& e) {
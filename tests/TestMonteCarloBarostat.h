@@ -32,6 +32,8 @@
 #include "openmm/internal/AssertionUtilities.h"
 #include "openmm/MonteCarloBarostat.h"
 #include "openmm/Context.h"
+#include "openmm/HarmonicAngleForce.h"
+#include "openmm/HarmonicBondForce.h"
 #include "openmm/NonbondedForce.h"
 #include "openmm/System.h"
 #include "openmm/LangevinIntegrator.h"
@@ -268,6 +270,73 @@ void testWater() {
     ASSERT_USUALLY_EQUAL_TOL(1.0, density, 0.02);
 }
 
+void testBondedForceGroups() {
+    const int numMolecules = 8;
+    const int frequency = 5;
+    const int steps = 20;
+    const double boxSize = 2.0;
+
+    // Each force group is either all on its own or mixed with the others.  Intramolecular bonds
+    // do not change under scaling, but angles between separate molecules do.  The barostat should
+    // produce the same trajectory either way, including when the scaled forces are in the
+    // highest group.
+
+    vector<Vec3> finalBox[3];
+    for (int grouping = 0; grouping < 3; grouping++) {
+        System system;
+        system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+        NonbondedForce* nonbonded = new NonbondedForce();
+        nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+        nonbonded->setCutoffDistance(0.9);
+        HarmonicBondForce* bonds = new HarmonicBondForce();
+        HarmonicAngleForce* angles = new HarmonicAngleForce();
+        vector<Vec3> positions;
+        OpenMM_SFMT::SFMT sfmt;
+        init_gen_rand(0, sfmt);
+        for (int i = 0; i < numMolecules; i++) {
+            system.addParticle(10.0);
+            system.addParticle(10.0);
+            nonbonded->addParticle(0.0, 0.3, 0.5);
+            nonbonded->addParticle(0.0, 0.3, 0.5);
+            nonbonded->addException(2*i, 2*i+1, 0.0, 1.0, 0.0);
+            bonds->addBond(2*i, 2*i+1, 0.1, 1000.0);
+            Vec3 pos(boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt));
+            positions.push_back(pos);
+            positions.push_back(pos+Vec3(0.12, 0, 0));
+        }
+        for (int i = 0; i < numMolecules-1; i++)
+            angles->addAngle(2*i, 2*i+1, 2*i+2, M_PI/2, 10000.0);
+        if (grouping == 1) {
+            bonds->setForceGroup(1);
+            angles->setForceGroup(2);
+        }
+        if (grouping == 2) {
+            nonbonded->setForceGroup(31);
+            bonds->setForceGroup(1);
+            angles->setForceGroup(31);
+        }
+        system.addForce(nonbonded);
+        system.addForce(bonds);
+        system.addForce(angles);
+        MonteCarloBarostat* barostat = new MonteCarloBarostat(100.0, 300.0, frequency);
+        barostat->setRandomNumberSeed(5);
+        system.addForce(barostat);
+        VerletIntegrator integrator(0.001);
+        Context context(system, integrator, platform);
+        context.setPositions(positions);
+        for (int i = 0; i < steps; i++) {
+            integrator.step(frequency);
+            Vec3 box[3];
+            context.getState(0).getPeriodicBoxVectors(box[0], box[1], box[2]);
+            finalBox[grouping].push_back(box[0]);
+        }
+    }
+    for (int i = 0; i < steps; i++) {
+        ASSERT_EQUAL_VEC(finalBox[0][i], finalBox[1][i], 1e-5);
+        ASSERT_EQUAL_VEC(finalBox[0][i], finalBox[2][i], 1e-5);
+    }
+}
+
 void runPlatformTests();
 
 int main(int argc, char* argv[]) {
@@ -276,6 +345,7 @@ int main(int argc, char* argv[]) {
         testChangingBoxSize();
         testIdealGas();
         testRandomSeed();
+        testBondedForceGroups();
         // Don't run testWater() here, because it's very slow on Reference platform.
         // Individual platforms can run it from runPlatformTests().
         runPlatformTests();
@@ -0,0 +1,251 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "sfmt/SFMT.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+const int numParticles = 50;
+
+void createSystem(System& system, vector<Vec3>& positions, vector<Vec3>& velocities) {
+    NonbondedForce* nonbonded = new NonbondedForce();
+    system.addForce(nonbonded);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    positions.resize(numParticles);
+    velocities.resize(numParticles);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.5 : -0.5, 0.2, 0.1);
+        positions[i] = Vec3(i%5, (i/5)%5, i/25)+Vec3(0.2*genrand_real2(sfmt), 0.2*genrand_real2(sfmt), 0.2*genrand_real2(sfmt));
+        velocities[i] = Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt));
+    }
+}
+
+void testGetData() {
+    System system;
+    vector<Vec3> positions, velocities;
+    createSystem(system, positions, velocities);
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    context.setVelocities(velocities);
+    State state = context.getState(State::Positions | State::Velocities | State::Forces);
+
+    // Retrieve all particles into packed double precision buffers.
+
+    vector<double> packed(3*numParticles);
+    context.getPositions(&packed[0]);
+    for (int i = 0; i < numParticles; i++)
+        ASSERT_EQUAL_VEC(state.getPositions()[i], Vec3(packed[3*i], packed[3*i+1], packed[3*i+2]), 1e-10);
+    context.getVelocities(&packed[0]);
+    for (int i = 0; i < numParticles; i++)
+        ASSERT_EQUAL_VEC(state.getVelocities()[i], Vec3(packed[3*i], packed[3*i+1], packed[3*i+2]), 1e-10);
+    context.getForces(&packed[0]);
+    for (int i = 0; i < numParticles; i++)
+        ASSERT_EQUAL_VEC(state.getForces()[i], Vec3(packed[3*i], packed[3*i+1], packed[3*i+2]), 1e-5);
+
+    // Retrieve a subset of particles into a strided single precision buffer.
+
+    vector<int> subset;
+    for (int i = numParticles-1; i >= 0; i -= 3)
+        subset.push_back(i);
+    const int stride = 4;
+    vector<float> strided(stride*subset.size(), -1.0f);
+    context.getPositions(&strided[0], stride, subset);
+    for (int i = 0; i < (int) subset.size(); i++) {
+        ASSERT_EQUAL_VEC(state.getPositions()[subset[i]], Vec3(strided[stride*i], strided[stride*i+1], strided[stride*i+2]), 1e-6);
+        ASSERT_EQUAL(-1.0f, strided[stride*i+3]);
+    }
+    context.getVelocities(&strided[0], stride, subset);
+    for (int i = 0; i < (int) subset.size(); i++)
+        ASSERT_EQUAL_VEC(state.getVelocities()[subset[i]], Vec3(strided[stride*i], strided[stride*i+1], strided[stride*i+2]), 1e-6);
+    context.getForces(&strided[0], stride, subset);
+    for (int i = 0; i < (int) subset.size(); i++)
+        ASSERT_EQUAL_VEC(state.getForces()[subset[i]], Vec3(strided[stride*i], strided[stride*i+1], strided[stride*i+2]), 1e-5);
+}
+
+void testSetData() {
+    System system;
+    vector<Vec3> positions, velocities;
+    createSystem(system, positions, velocities);
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, platform);
+
+    // Set all positions and velocities from packed buffers.
+
+    vector<double> packedPositions(3*numParticles), packedVelocities(3*numParticles);
+    for (int i = 0; i < numParticles; i++)
+        for (int j = 0; j < 3; j++) {
+            packedPositions[3*i+j] = positions[i][j];
+            packedVelocities[3*i+j] = velocities[i][j];
+        }
+    context.setPositions(&packedPositions[0]);
+    context.setVelocities(&packedVelocities[0]);
+    State state = context.getState(State::Positions | State::Velocities);
+    for (int i = 0; i < numParticles; i++) {
+        ASSERT_EQUAL_VEC(positions[i], state.getPositions()[i], 1e-10);
+        ASSERT_EQUAL_VEC(velocities[i], state.getVelocities()[i], 1e-10);
+    }
+
+    // Modify a subset of particles from a strided single precision buffer.  Other particles should be unchanged.
+
+    vector<int> subset;
+    for (int i = 1; i < numParticles; i += 4)
+        subset.push_back(i);
+    const int stride = 5;
+    vector<float> strided(stride*subset.size());
+    for (int i = 0; i < (int) subset.size(); i++)
+        for (int j = 0; j < 3; j++)
+            strided[stride*i+j] = (float) (positions[subset[i]][j]+0.1*(j+1));
+    context.setPositions(&strided[0], stride, subset);
+    context.setVelocities(&strided[0], stride, subset);
+    state = context.getState(State::Positions | State::Velocities);
+    vector<Vec3> expectedPositions = positions;
+    vector<Vec3> expectedVelocities = velocities;
+    for (int i = 0; i < (int) subset.size(); i++) {
+        expectedPositions[subset[i]] = Vec3(strided[stride*i], strided[stride*i+1], strided[stride*i+2]);
+        expectedVelocities[subset[i]] = expectedPositions[subset[i]];
+    }
+    for (int i = 0; i < numParticles; i++) {
+        ASSERT_EQUAL_VEC(expectedPositions[i], state.getPositions()[i], 1e-6);
+        ASSERT_EQUAL_VEC(expectedVelocities[i], state.getVelocities()[i], 1e-6);
+    }
+}
+
+void testIllegalArguments() {
+    System system;
+    vector<Vec3> positions, velocities;
+    createSystem(system, positions, velocities);
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    vector<double> buffer(3*numParticles);
+    bool threwException = false;
+    try {
+        context.getPositions(&buffer[0], 2);
+    }
+    catch (OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+    vector<int> subset(1, numParticles);
+    threwException = false;
+    try {
+        context.setVelocities(&buffer[0], 3, subset);
+    }
+    catch (OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+}
+
+void testMoleculeImages() {
+    const int numMolecules = 60;
+    Vec3 a(6.7929, 0, 0);
+    Vec3 b(-2.264163559406279, 6.404455775962287, 0);
+    Vec3 c(-2.264163559406279, -3.2019384603140684, 5.54658849047036);
+    System system;
+    system.setDefaultPeriodicBoxVectors(a, b, c);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<Vec3> positions;
+
+    // Alternate between single particles and constrained pairs so molecules have different sizes.
+
+    for (int i = 0; i < numMolecules; i++) {
+        Vec3 pos = a*(5*genrand_real2(sfmt)-2) + b*(5*genrand_real2(sfmt)-2) + c*(5*genrand_real2(sfmt)-2);
+        system.addParticle(1.0);
+        positions.push_back(pos);
+        if (i%2 == 1) {
+            system.addParticle(1.0);
+            positions.push_back(pos+Vec3(1.0, 0.0, 0.0));
+            system.addConstraint(system.getNumParticles()-2, system.getNumParticles()-1, 1.0);
+        }
+    }
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    State state = context.getState(State::Positions, true);
+    vector<Vec3> offsets;
+    context.getMoleculeImages(offsets);
+    const vector<vector<int> >& molecules = context.getMolecules();
+    ASSERT_EQUAL(molecules.size(), offsets.size());
+    for (int i = 0; i < (int) molecules.size(); i++) {
+        // Check that the offset is a whole number of box vectors and moves the center into the first box.
+
+        Vec3 center;
+        for (int j = 0; j < (int) molecules[i].size(); j++)
+            center += positions[molecules[i][j]];
+        center *= 1.0/molecules[i].size();
+        Vec3 wrapped = center+offsets[i];
+        ASSERT(wrapped[2] >= 0.0 && wrapped[2] < c[2]);
+        double nc = offsets[i][2]/c[2];
+        ASSERT_EQUAL_TOL(floor(nc+0.5), nc, 1e-6);
+
+        // The positions returned by getState() should be translated by the same offset.
+
+        for (int j = 0; j < (int) molecules[i].size(); j++) {
+            int particle = molecules[i][j];
+            ASSERT_EQUAL_VEC(positions[particle]+offsets[i], state.getPositions()[particle], 1e-6);
+        }
+    }
+}
+
+void runPlatformTests();
+
+int main(int argc, char* argv[]) {
+    try {
+        initializeTests(argc, argv);
+        testGetData();
+        testSetData();
+        testIllegalArguments();
+        testMoleculeImages();
+        runPlatformTests();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
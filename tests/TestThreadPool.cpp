@@ -0,0 +1,93 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests the ThreadPool class in both of its synchronization modes.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/internal/ThreadPool.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Each thread adds its index to its own element, synchronizes, then reads the values written
+ * by all the other threads.
+ */
+class SumTask : public ThreadPool::Task {
+public:
+    SumTask(int numThreads) : values(numThreads, 0), sums(numThreads, 0) {
+    }
+    void execute(ThreadPool& pool, int threadIndex) {
+        values[threadIndex] += threadIndex+1;
+        pool.syncThreads();
+        int sum = 0;
+        for (int i = 0; i < (int) values.size(); i++)
+            sum += values[i];
+        sums[threadIndex] = sum;
+    }
+    vector<int> values, sums;
+};
+
+void testThreadPool(int numThreads, bool spinWait) {
+    ThreadPool pool(numThreads, spinWait);
+    ASSERT_EQUAL(numThreads, pool.getNumThreads());
+    ASSERT_EQUAL(spinWait, pool.getSpinWait());
+    SumTask task(numThreads);
+    const int numIterations = 1000;
+    for (int iteration = 1; iteration <= numIterations; iteration++) {
+        pool.execute(task);
+        pool.waitForThreads();
+        pool.resumeThreads();
+        pool.waitForThreads();
+        int expected = iteration*numThreads*(numThreads+1)/2;
+        for (int i = 0; i < numThreads; i++)
+            ASSERT_EQUAL(expected, task.sums[i]);
+    }
+}
+
+int main() {
+    try {
+        for (int numThreads = 1; numThreads <= 4; numThreads++) {
+            testThreadPool(numThreads, false);
+            testThreadPool(numThreads, true);
+        }
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
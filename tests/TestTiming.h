@@ -0,0 +1,190 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/CustomIntegrator.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/LangevinIntegrator.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/System.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+const int numMolecules = 64;
+
+void createSystem(System& system, vector<Vec3>& positions) {
+    // Create a box of diatomic molecules with a bond or constraint holding each one together.
+
+    const double boxSize = 3.0;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system.addForce(bonds);
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    nonbonded->setForceGroup(1);
+    system.addForce(nonbonded);
+    for (int i = 0; i < numMolecules; i++) {
+        system.addParticle(1.0);
+        system.addParticle(1.0);
+        nonbonded->addParticle(0.2, 0.2, 0.1);
+        nonbonded->addParticle(-0.2, 0.2, 0.1);
+        nonbonded->addException(2*i, 2*i+1, 0.0, 1.0, 0.0);
+        if (i%2 == 0)
+            bonds->addBond(2*i, 2*i+1, 0.1, 1000.0);
+        else
+            system.addConstraint(2*i, 2*i+1, 0.1);
+        Vec3 pos(0.7*(i%4), 0.7*((i/4)%4), 0.7*(i/16));
+        positions.push_back(pos);
+        positions.push_back(pos+Vec3(0.1, 0, 0));
+    }
+}
+
+bool hasOperation(const Context& context, const string& operation) {
+    vector<string> operations = context.getTimedOperations();
+    return (find(operations.begin(), operations.end(), operation) != operations.end());
+}
+
+void testDisabledByDefault() {
+    System system;
+    vector<Vec3> positions;
+    createSystem(system, positions);
+    LangevinIntegrator integrator(300.0, 1.0, 0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    ASSERT(!context.getTimingEnabled());
+    integrator.step(5);
+    context.getState(State::Energy);
+    ASSERT_EQUAL(0, context.getTimedOperations().size());
+}
+
+void testRecordTiming() {
+    System system;
+    vector<Vec3> positions;
+    createSystem(system, positions);
+    LangevinIntegrator integrator(300.0, 1.0, 0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    context.setTimingEnabled(true);
+    ASSERT(context.getTimingEnabled());
+    const int numSteps = 5;
+    integrator.step(numSteps);
+
+    // Every step should have computed both forces, updated the positions, and applied constraints.
+
+    int count;
+    double minTime, meanTime, maxTime;
+    context.getTimingStatistics("Integrator update", count, minTime, meanTime, maxTime);
+    ASSERT_EQUAL(numSteps, count);
+    ASSERT(minTime >= 0.0);
+    ASSERT(minTime <= meanTime);
+    ASSERT(meanTime <= maxTime);
+    const char* operations[] = {"Force 0 (group 0)", "Force 1 (group 1)", "Begin force computation", "Finish force computation", "Constraints"};
+    for (int i = 0; i < 5; i++) {
+        ASSERT(hasOperation(context, operations[i]));
+        context.getTimingStatistics(operations[i], count, minTime, meanTime, maxTime);
+        ASSERT(count >= numSteps);
+        ASSERT(minTime <= meanTime);
+        ASSERT(meanTime <= maxTime);
+        ASSERT(context.getTimingReport().find(operations[i]) != string::npos);
+    }
+
+    // An operation that was never recorded should report zeros.
+
+    context.getTimingStatistics("No such operation", count, minTime, meanTime, maxTime);
+    ASSERT_EQUAL(0, count);
+    ASSERT_EQUAL(0.0, maxTime);
+
+    // Disabling timing should stop recording without discarding what was already recorded.
+
+    context.setTimingEnabled(false);
+    integrator.step(numSteps);
+    context.getTimingStatistics("Integrator update", count, minTime, meanTime, maxTime);
+    ASSERT_EQUAL(numSteps, count);
+
+    // Resetting should discard it.
+
+    context.resetTiming();
+    ASSERT_EQUAL(0, context.getTimedOperations().size());
+
+    // Reinitializing the Context should preserve whether timing is enabled.
+
+    context.setTimingEnabled(true);
+    context.reinitialize();
+    context.setPositions(positions);
+    ASSERT(context.getTimingEnabled());
+    integrator.step(1);
+    ASSERT(hasOperation(context, "Integrator update"));
+}
+
+void testCustomIntegrator() {
+    System system;
+    vector<Vec3> positions;
+    createSystem(system, positions);
+    CustomIntegrator integrator(0.001);
+    integrator.addUpdateContextState();
+    integrator.addComputePerDof("v", "v+dt*f/m");
+    integrator.addComputePerDof("x", "x+dt*v");
+    integrator.addConstrainPositions();
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    context.setTimingEnabled(true);
+    const int numSteps = 5;
+    integrator.step(numSteps);
+    int count;
+    double minTime, meanTime, maxTime;
+    context.getTimingStatistics("Integrator update", count, minTime, meanTime, maxTime);
+    ASSERT_EQUAL(numSteps, count);
+    ASSERT(hasOperation(context, "Force 1 (group 1)"));
+}
+
+void runPlatformTests();
+
+int main(int argc, char* argv[]) {
+    try {
+        initializeTests(argc, argv);
+        testDisabledByDefault();
+        testRecordTiming();
+        testCustomIntegrator();
+        runPlatformTests();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
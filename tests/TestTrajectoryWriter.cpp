@@ -0,0 +1,192 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/internal/CompressedCoordinates.h"
+#include "openmm/Context.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/Platform.h"
+#include "openmm/System.h"
+#include "openmm/TrajectoryReader.h"
+#include "openmm/TrajectoryWriter.h"
+#include "openmm/VerletIntegrator.h"
+#include "sfmt/SFMT.h"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+void testCompressedCoordinates() {
+    // Include small steps, large jumps, and negative values to exercise all the code paths.
+
+    const int numParticles = 1000;
+    const double precision = 1000.0;
+    vector<double> coords(3*numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < 3*numParticles; i++) {
+        if (i < 3)
+            coords[i] = 5.0*genrand_real2(sfmt);
+        else if (i%500 == 0)
+            coords[i] = 1e5*(genrand_real2(sfmt)-0.5);
+        else
+            coords[i] = coords[i-3]+0.15*(genrand_real2(sfmt)-0.5);
+    }
+    vector<char> encoded;
+    CompressedCoordinates::encode(&coords[0], coords.size(), precision, encoded);
+    ASSERT(encoded.size() < 0.35*sizeof(float)*coords.size());
+    vector<double> decoded(coords.size());
+    CompressedCoordinates::decode(&encoded[0], encoded.size(), coords.size(), precision, &decoded[0]);
+    for (int i = 0; i < (int) coords.size(); i++)
+        ASSERT_EQUAL_TOL(coords[i], decoded[i], 0.5/precision+1e-9);
+}
+
+void testWriteTrajectory() {
+    const int numParticles = 50;
+    const double boxSize = 3.0;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    system.addForce(nonbonded);
+    vector<Vec3> positions(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(0.0, 0.2, 0.1);
+        positions[i] = Vec3(boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt), boxSize*genrand_real2(sfmt));
+    }
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, Platform::getPlatformByName("Reference"));
+    context.setPositions(positions);
+    context.setVelocitiesToTemperature(300.0);
+
+    // Record a trajectory of every particle and one of a subset, using a small ring buffer so the
+    // writer sometimes has to wait for the background thread.
+
+    vector<int> subset;
+    for (int i = 0; i < numParticles; i += 3)
+        subset.push_back(i);
+    stringstream allStream(ios_base::out | ios_base::in | ios_base::binary);
+    stringstream subsetStream(ios_base::out | ios_base::in | ios_base::binary);
+    vector<State> states;
+    {
+        TrajectoryWriter allWriter(context, allStream, 5, vector<int>(), 1000.0, 2);
+        TrajectoryWriter subsetWriter(context, subsetStream, 10, subset, 100.0);
+        for (int i = 0; i < 10; i++) {
+            allWriter.step(5);
+            states.push_back(context.getState(State::Positions));
+            if (i%2 == 1)
+                subsetWriter.writeFrame();
+        }
+        ASSERT_EQUAL(10, allWriter.getNumFrames());
+        ASSERT_EQUAL(5, subsetWriter.getNumFrames());
+        allWriter.flush();
+    }
+
+    // Read them back and compare to the states.
+
+    TrajectoryReader allReader(allStream);
+    ASSERT_EQUAL(numParticles, allReader.getNumParticles());
+    ASSERT_EQUAL(1000.0, allReader.getPrecision());
+    Vec3 a, b, c;
+    vector<Vec3> frame;
+    for (int i = 0; i < 10; i++) {
+        ASSERT(allReader.readFrame());
+        ASSERT_EQUAL_TOL(states[i].getTime(), allReader.getTime(), 1e-10);
+        allReader.getPeriodicBoxVectors(a, b, c);
+        ASSERT_EQUAL_VEC(Vec3(boxSize, 0, 0), a, 0);
+        ASSERT_EQUAL_VEC(Vec3(0, boxSize, 0), b, 0);
+        ASSERT_EQUAL_VEC(Vec3(0, 0, boxSize), c, 0);
+        allReader.getPositions(frame);
+        for (int j = 0; j < numParticles; j++)
+            for (int k = 0; k < 3; k++)
+                ASSERT_EQUAL_TOL(states[i].getPositions()[j][k], frame[j][k], 0.0005+1e-9);
+    }
+    ASSERT(!allReader.readFrame());
+    TrajectoryReader subsetReader(subsetStream);
+    ASSERT_EQUAL(subset.size(), subsetReader.getNumParticles());
+    for (int i = 1; i < 10; i += 2) {
+        ASSERT(subsetReader.readFrame());
+        subsetReader.getPositions(frame);
+        for (int j = 0; j < (int) subset.size(); j++)
+            for (int k = 0; k < 3; k++)
+                ASSERT_EQUAL_TOL(states[i].getPositions()[subset[j]][k], frame[j][k], 0.005+1e-9);
+    }
+    ASSERT(!subsetReader.readFrame());
+}
+
+void testTrajectoryFile() {
+    const int numParticles = 10;
+    System system;
+    vector<Vec3> positions(numParticles);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        positions[i] = Vec3(0.1*i, 0.2*i, -0.3*i);
+    }
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, Platform::getPlatformByName("Reference"));
+    context.setPositions(positions);
+    const string filename = "TestTrajectoryFile.omt";
+    {
+        TrajectoryWriter writer(context, filename, 1);
+        writer.writeFrame();
+    }
+    {
+        TrajectoryReader reader(filename);
+        ASSERT_EQUAL(numParticles, reader.getNumParticles());
+        ASSERT(reader.readFrame());
+        vector<Vec3> frame;
+        reader.getPositions(frame);
+        for (int i = 0; i < numParticles; i++)
+            ASSERT_EQUAL_VEC(positions[i], frame[i], 0.0005+1e-9);
+        ASSERT(!reader.readFrame());
+    }
+    remove(filename.c_str());
+}
+
+int main() {
+    try {
+        testCompressedCoordinates();
+        testWriteTrajectory();
+        testTrajectoryFile();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -0,0 +1,309 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests AVX-512 vectorized operations.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/internal/vectorize16.h"
+#include <iostream>
+
+#ifndef __AVX512F__
+bool isVec16Supported() {
+    return false;
+}
+#else
+/**
+ * Check whether 16 component vectors are supported with the current CPU.
+ */
+bool isVec16Supported() {
+    // Make sure the CPU supports AVX-512F and the operating system has enabled it.
+
+    int cpuInfo[4];
+    cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7)
+        return false;
+    cpuid(cpuInfo, 1);
+    if ((cpuInfo[2] & ((int) 1 << 27)) == 0 || (cpuInfo[2] & ((int) 1 << 28)) == 0)
+        return false;
+    cpuid(cpuInfo, 7);
+    if ((cpuInfo[1] & ((int) 1 << 16)) == 0)
+        return false;
+    unsigned int eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return ((eax & 0xE6) == 0xE6);
+}
+#endif
+
+using namespace OpenMM;
+using namespace std;
+
+#ifdef __AVX512F__
+void assertVec16Equal(const fvec16& found, const float* expected, const char* file, int line) {
+    float values[16];
+    found.store(values);
+    for (int i = 0; i < 16; i++)
+        if (std::abs(values[i]-expected[i]) > 1e-6) {
+            std::stringstream details;
+            details << " Expected " << expected[i] << " in element " << i << ", found " << values[i];
+            throwException(file, line, details.str());
+        }
+}
+
+void assertVec16EqualInt(const ivec16& found, const int* expected, const char* file, int line) {
+    int values[16];
+    found.store(values);
+    for (int i = 0; i < 16; i++)
+        if (values[i] != expected[i]) {
+            std::stringstream details;
+            details << " Expected " << expected[i] << " in element " << i << ", found " << values[i];
+            throwException(file, line, details.str());
+        }
+}
+
+#define ASSERT_VEC16_EQUAL(found, expected) assertVec16Equal(found, expected, __FILE__, __LINE__);
+#define ASSERT_VEC16_EQUAL_INT(found, expected) assertVec16EqualInt(found, expected, __FILE__, __LINE__);
+
+void testLoadStore() {
+    float farray[16], fexpected[16];
+    int iarray[16], iexpected[16];
+    for (int i = 0; i < 16; i++) {
+        fexpected[i] = 2.5f+0.5f*i;
+        iexpected[i] = 2+i;
+    }
+    ASSERT_VEC16_EQUAL(fvec16(fexpected), fexpected);
+    ASSERT_VEC16_EQUAL_INT(ivec16(iexpected), iexpected);
+    fvec16 f1(2.5, 3.0, 3.5, 4.0, 4.5, 5.0, 5.5, 6.0, 6.5, 7.0, 7.5, 8.0, 8.5, 9.0, 9.5, 10.0);
+    ivec16 i1(2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17);
+    ASSERT_VEC16_EQUAL(f1, fexpected);
+    ASSERT_VEC16_EQUAL_INT(i1, iexpected);
+    f1.store(farray);
+    i1.store(iarray);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQUAL(fexpected[i], farray[i]);
+        ASSERT_EQUAL(iexpected[i], iarray[i]);
+    }
+    ASSERT_EQUAL(2.5, f1.lowerVec().lowerVec()[0]);
+    ASSERT_EQUAL(6.5, f1.upperVec().lowerVec()[0]);
+    ASSERT_EQUAL(10.0, f1.upperVec().upperVec()[3]);
+    ASSERT_EQUAL(2, i1.lowerVec().lowerVec()[0]);
+    ASSERT_EQUAL(10, i1.upperVec().lowerVec()[0]);
+    ASSERT_EQUAL(17, i1.upperVec().upperVec()[3]);
+    fvec16 f2(f1.upperVec(), f1.lowerVec());
+    ASSERT_EQUAL(6.5, f2.lowerVec().lowerVec()[0]);
+    ASSERT_EQUAL(2.5, f2.upperVec().lowerVec()[0]);
+    fvec16 f3(2.0f);
+    float twos[16];
+    for (int i = 0; i < 16; i++)
+        twos[i] = 2.0f;
+    ASSERT_VEC16_EQUAL(f3, twos);
+}
+
+void testArithmetic() {
+    float a[16], b[16], expected[16];
+    for (int i = 0; i < 16; i++) {
+        a[i] = 0.5f*(i+1);
+        b[i] = i+1;
+    }
+    fvec16 f1(a), f2(b);
+    for (int i = 0; i < 16; i++)
+        expected[i] = a[i]+b[i];
+    ASSERT_VEC16_EQUAL(f1+f2, expected);
+    fvec16 f3 = f1;
+    f3 += f2;
+    ASSERT_VEC16_EQUAL(f3, expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = a[i]-b[i];
+    ASSERT_VEC16_EQUAL(f1-f2, expected);
+    f3 = f1;
+    f3 -= f2;
+    ASSERT_VEC16_EQUAL(f3, expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = a[i]*b[i];
+    ASSERT_VEC16_EQUAL(f1*f2, expected);
+    f3 = f1;
+    f3 *= f2;
+    ASSERT_VEC16_EQUAL(f3, expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = a[i]/b[i];
+    ASSERT_VEC16_EQUAL(f1/f2, expected);
+    f3 = f1;
+    f3 /= f2;
+    ASSERT_VEC16_EQUAL(f3, expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = a[i]*b[i]+3.0f;
+    ASSERT_VEC16_EQUAL(fmadd(f1, f2, 3.0f), expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = -a[i];
+    ASSERT_VEC16_EQUAL(-f1, expected);
+    int ia[16], ib[16], iexpected[16];
+    for (int i = 0; i < 16; i++) {
+        ia[i] = 3*i;
+        ib[i] = i-5;
+        iexpected[i] = ia[i]+ib[i];
+    }
+    ASSERT_VEC16_EQUAL_INT(ivec16(ia)+ivec16(ib), iexpected);
+    for (int i = 0; i < 16; i++)
+        iexpected[i] = ia[i]-ib[i];
+    ASSERT_VEC16_EQUAL_INT(ivec16(ia)-ivec16(ib), iexpected);
+}
+
+void testLogic() {
+    int allBits = -1;
+    float allBitsf = *((float*) &allBits);
+    int mask[16], iexpected[16], ivalues[16];
+    float fmask[16], fvalues[16], fexpected[16];
+    for (int i = 0; i < 16; i++) {
+        bool set = (i%3 == 0);
+        mask[i] = (set ? allBits : 0);
+        fmask[i] = (set ? allBitsf : 0.0f);
+        ivalues[i] = i+1;
+        fvalues[i] = 0.5f*(i+1);
+        iexpected[i] = (set ? ivalues[i] : 0);
+        fexpected[i] = (set ? fvalues[i] : 0.0f);
+    }
+    ASSERT_VEC16_EQUAL(fvec16(fvalues)&fvec16(fmask), fexpected);
+    ASSERT_VEC16_EQUAL_INT(ivec16(ivalues)&ivec16(mask), iexpected);
+    for (int i = 0; i < 16; i++)
+        iexpected[i] = (mask[i] ? allBits : ivalues[i]);
+    ASSERT_VEC16_EQUAL_INT(ivec16(ivalues)|ivec16(mask), iexpected);
+    float temp[16];
+    (fvec16(fvalues)|fvec16(fmask)).store(temp);
+    for (int i = 0; i < 16; i++) {
+        if (mask[i]) {
+            ASSERT(temp[i] != temp[i]); // All bits set, which is nan
+        }
+        else {
+            ASSERT_EQUAL(fvalues[i], temp[i]);
+        }
+    }
+}
+
+void testComparisons() {
+    fvec16 v1(1.0, 1.5, 3.0, 2.2, 10.0, 10.5, 13.0, 12.2, 1.0, 1.5, 3.0, 2.2, 10.0, 10.5, 13.0, 12.2);
+    fvec16 v2(1.1, 1.5, 3.0, 2.1, 10.1, 10.5, 13.0, 12.1, 1.1, 1.5, 3.0, 2.1, 10.1, 10.5, 13.0, 12.1);
+    ASSERT_EQUAL(0x6666, v1 == v2);
+    ASSERT_EQUAL(0x9999, v1 != v2);
+    ASSERT_EQUAL(0x1111, v1 < v2);
+    ASSERT_EQUAL(0x8888, v1 > v2);
+    ASSERT_EQUAL(0x7777, v1 <= v2);
+    ASSERT_EQUAL(0xEEEE, v1 >= v2);
+    ASSERT(any(v1 > 12.5f));
+    ASSERT(!any(v1 > 13.0f));
+    float expected[16];
+    for (int i = 0; i < 16; i++)
+        expected[i] = (i%4 == 0 ? 1.5f : 0.0f);
+    ASSERT_VEC16_EQUAL(blend(0.0f, 1.5f, v1 < v2), expected);
+}
+
+void testMathFunctions() {
+    float values[16] = {0.4, 1.9, -1.2, -3.8, 0.4, 1.9, -1.2, -3.8, 2.5, -2.5, 7.1, -0.1, 0.0, 3.5, -3.5, 8.9};
+    float other[16] = {1.1, 1.2, 1.3, -5.0, 1.1, 1.2, 1.3, -5.0, 2.0, -2.0, 7.5, 0.1, -1.0, 3.0, -4.0, 9.0};
+    fvec16 f1(values), f2(other);
+    float expected[16];
+    for (int i = 0; i < 16; i++)
+        expected[i] = std::floor(values[i]);
+    ASSERT_VEC16_EQUAL(floor(f1), expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = std::ceil(values[i]);
+    ASSERT_VEC16_EQUAL(ceil(f1), expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = std::abs(values[i]);
+    ASSERT_VEC16_EQUAL(abs(f1), expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = std::min(values[i], other[i]);
+    ASSERT_VEC16_EQUAL(min(f1, f2), expected);
+    for (int i = 0; i < 16; i++)
+        expected[i] = std::max(values[i], other[i]);
+    ASSERT_VEC16_EQUAL(max(f1, f2), expected);
+    ASSERT_EQUAL(0.0, round(fvec16(0.4f)).lowerVec().lowerVec()[0]);
+    ASSERT_EQUAL(2.0, round(fvec16(1.9f)).lowerVec().lowerVec()[0]);
+    ASSERT_EQUAL(-4.0, round(fvec16(-3.8f)).lowerVec().lowerVec()[0]);
+    float positive[16], roots[16], inverseRoots[16];
+    for (int i = 0; i < 16; i++) {
+        positive[i] = 0.5f+1.7f*i;
+        roots[i] = std::sqrt(positive[i]);
+        inverseRoots[i] = 1.0f/roots[i];
+    }
+    ASSERT_VEC16_EQUAL(sqrt(fvec16(positive)), roots);
+    ASSERT_VEC16_EQUAL(rsqrt(fvec16(positive)), inverseRoots);
+    double sum = 0, lowerSum = 0, dot = 0;
+    for (int i = 0; i < 16; i++) {
+        sum += values[i];
+        dot += values[i]*other[i];
+        if (i < 8)
+            lowerSum += values[i];
+    }
+    ASSERT_EQUAL_TOL(sum, reduceAdd(f1), 1e-6);
+    ASSERT_EQUAL_TOL(lowerSum, reduceAdd(f1, 0x00FF), 1e-6);
+    ASSERT_EQUAL_TOL(sum-lowerSum, reduceAdd(f1, 0xFF00), 1e-6);
+    ASSERT_EQUAL_TOL(dot, dot16(f1, f2), 1e-6);
+}
+
+void testGather() {
+    float table[100];
+    for (int i = 0; i < 100; i++)
+        table[i] = 0.5f*i;
+    int indices[16] = {0, 99, 3, 17, 17, 50, 2, 98, 31, 64, 5, 7, 11, 13, 1, 0};
+    float expected[16];
+    for (int i = 0; i < 16; i++)
+        expected[i] = table[indices[i]];
+    ASSERT_VEC16_EQUAL(gather(table, ivec16(indices)), expected);
+    int shifted[16] = {0, 98, 3, 17, 17, 50, 2, 97, 31, 64, 5, 7, 11, 13, 1, 0};
+    for (int i = 0; i < 16; i++)
+        expected[i] = table[shifted[i]+1];
+    ASSERT_VEC16_EQUAL(gather(table+1, ivec16(shifted)), expected);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    try {
+        if (!isVec16Supported()) {
+            cout << "CPU is not supported.  Exiting." << endl;
+            return 0;
+        }
+#ifdef __AVX512F__
+        testLoadStore();
+        testArithmetic();
+        testLogic();
+        testComparisons();
+        testMathFunctions();
+        testGather();
+#endif
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests WorkStealingRange and parallelFor().
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/internal/WorkStealingRange.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Count how many times each index is processed, recording it in a per-thread array so no
+ * synchronization is needed.
+ */
+class CountBody : public ParallelForBody {
+public:
+    CountBody(int size, int numThreads) : counts(numThreads, vector<int>(size, 0)) {
+    }
+    void execute(int start, int end, int threadIndex) {
+        for (int i = start; i < end; i++)
+            counts[threadIndex][i]++;
+    }
+    vector<vector<int> > counts;
+};
+
+void testParallelFor(int numThreads, int size, int grainSize) {
+    ThreadPool threads(numThreads);
+    CountBody body(size, numThreads);
+    parallelFor(threads, size, grainSize, body);
+    for (int i = 0; i < size; i++) {
+        int total = 0;
+        for (int j = 0; j < numThreads; j++)
+            total += body.counts[j][i];
+        ASSERT_EQUAL(1, total);
+    }
+}
+
+/**
+ * Process two ranges one after the other inside a single task, with no synchronization between them,
+ * and reuse the ranges for several tasks.
+ */
+class TwoRangeTask : public ThreadPool::Task {
+public:
+    TwoRangeTask(WorkStealingRange& range1, WorkStealingRange& range2, int size1, int size2, int numThreads) :
+            range1(range1), range2(range2), counts1(numThreads, vector<int>(size1, 0)), counts2(numThreads, vector<int>(size2, 0)) {
+    }
+    void execute(ThreadPool& threads, int threadIndex) {
+        int start, end;
+        while (range1.getNextChunk(threadIndex, start, end))
+            for (int i = start; i < end; i++)
+                counts1[threadIndex][i]++;
+        while (range2.getNextChunk(threadIndex, start, end))
+            for (int i = start; i < end; i++)
+                counts2[threadIndex][i]++;
+    }
+    WorkStealingRange& range1;
+    WorkStealingRange& range2;
+    vector<vector<int> > counts1, counts2;
+};
+
+void testMultipleRanges(int numThreads) {
+    ThreadPool threads(numThreads);
+    WorkStealingRange range1, range2;
+    const int size1 = 1000, size2 = 37;
+    TwoRangeTask task(range1, range2, size1, size2, numThreads);
+    const int numIterations = 10;
+    for (int iteration = 0; iteration < numIterations; iteration++) {
+        range1.reset(size1, 7, numThreads);
+        range2.reset(size2, 1, numThreads);
+        threads.execute(task);
+        threads.waitForThreads();
+    }
+    for (int i = 0; i < size1; i++) {
+        int total = 0;
+        for (int j = 0; j < numThreads; j++)
+            total += task.counts1[j][i];
+        ASSERT_EQUAL(numIterations, total);
+    }
+    for (int i = 0; i < size2; i++) {
+        int total = 0;
+        for (int j = 0; j < numThreads; j++)
+            total += task.counts2[j][i];
+        ASSERT_EQUAL(numIterations, total);
+    }
+}
+
+int main() {
+    try {
+        for (int numThreads = 1; numThreads <= 5; numThreads++) {
+            testParallelFor(numThreads, 0, 1);
+            testParallelFor(numThreads, 3, 1);
+            testParallelFor(numThreads, 1000, 1);
+            testParallelFor(numThreads, 1000, 16);
+            testParallelFor(numThreads, 1001, 2000);
+            testMultipleRanges(numThreads);
+        }
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
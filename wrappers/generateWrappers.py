@@ -67,8 +67,8 @@ class WrapperGenerator:
     """This is the parent class of generators for various API wrapper files.  It defines functions common to all of them."""
     
     def __init__(self, inputDirname, output):
-        self.skipClasses = ['OpenMM::Vec3', 'OpenMM::XmlSerializer', 'OpenMM::Kernel', 'OpenMM::KernelImpl', 'OpenMM::KernelFactory', 'OpenMM::ContextImpl', 'OpenMM::SerializationNode', 'OpenMM::SerializationProxy']
-        self.skipMethods = ['OpenMM::Context::getState', 'OpenMM::Platform::loadPluginsFromDirectory', 'OpenMM::Platform::getPluginLoadFailures', 'OpenMM::Context::createCheckpoint', 'OpenMM::Context::loadCheckpoint', 'OpenMM::Context::getMolecules']
+        self.skipClasses = ['OpenMM::Vec3', 'OpenMM::XmlSerializer', 'OpenMM::Kernel', 'OpenMM::KernelImpl', 'OpenMM::KernelFactory', 'OpenMM::ContextImpl', 'OpenMM::SerializationNode', 'OpenMM::SerializationProxy', 'OpenMM::CompressedCoordinates']
+        self.skipMethods = ['OpenMM::Context::getState', 'OpenMM::Platform::loadPluginsFromDirectory', 'OpenMM::Platform::getPluginLoadFailures', 'OpenMM::Context::createCheckpoint', 'OpenMM::Context::loadCheckpoint', 'OpenMM::Context::getMolecules', 'OpenMM::Context::getMoleculeImages', 'OpenMM::AsyncCheckpointWriter::createCheckpoint']
         self.hideClasses = ['Kernel', 'KernelImpl', 'KernelFactory', 'ContextImpl', 'SerializationNode', 'SerializationProxy']
         self.nodeByID={}
 
@@ -145,6 +145,12 @@ class WrapperGenerator:
                 type = getText('type/ref', node)
             if self.shouldHideType(type):
                 return True
+            if type.replace(' ', '') in ('double*', 'float*', 'constdouble*', 'constfloat*'):
+                # Raw buffers have no equivalent in the C and Fortran APIs.
+                return True
+            if type.replace('const', '').replace('&', '').strip() in ('std::istream', 'std::ostream'):
+                # Neither do C++ streams.
+                return True
         return False
 
 class CHeaderGenerator(WrapperGenerator):
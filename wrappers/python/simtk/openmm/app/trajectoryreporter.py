@@ -0,0 +1,104 @@
+"""
+trajectoryreporter.py: Outputs simulation trajectories in compressed OpenMM trajectory format
+
+This is part of the OpenMM molecular simulation toolkit originating from
+Simbios, the NIH National Center for Physics-Based Simulation of
+Biological Structures at Stanford, funded under the NIH Roadmap for
+Medical Research, grant U54 GM072970. See https://simtk.org.
+
+Portions copyright (c) 2016 Stanford University and the Authors.
+Authors: Peter Eastman
+Contributors:
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+USE OR OTHER DEALINGS IN THE SOFTWARE.
+"""
+from __future__ import absolute_import
+__author__ = "Peter Eastman"
+__version__ = "1.0"
+
+import simtk.openmm as mm
+
+class TrajectoryReporter(object):
+    """TrajectoryReporter outputs a series of frames from a Simulation to a compressed trajectory file
+    using TrajectoryWriter.  The file can be read back with TrajectoryReader.
+
+    To use it, create a TrajectoryReporter, then add it to the Simulation's list of reporters.  Frames
+    are recorded without retrieving a State, and are compressed and written on a background thread.
+    """
+
+    def __init__(self, file, reportInterval, atomSubset=None, precision=1000.0):
+        """Create a TrajectoryReporter.
+
+        Parameters
+        ----------
+        file : string
+            The file to write to.  Any current contents will be overwritten.
+        reportInterval : int
+            The interval (in time steps) at which to write frames
+        atomSubset : list
+            The indices of the atoms to write.  If this is None (the default), all atoms are written.
+        precision : float
+            Coordinates are stored to the nearest multiple of 1/precision nm
+        """
+        self._file = file
+        self._reportInterval = reportInterval
+        if atomSubset is None:
+            self._atomSubset = []
+        else:
+            self._atomSubset = list(atomSubset)
+        self._precision = precision
+        self._writer = None
+
+    def describeNextReport(self, simulation):
+        """Get information about the next report this object will generate.
+
+        Parameters
+        ----------
+        simulation : Simulation
+            The Simulation to generate a report for
+
+        Returns
+        -------
+        tuple
+            A five element tuple. The first element is the number of steps
+            until the next report. The remaining elements specify whether
+            that report will require positions, velocities, forces, and
+            energies respectively.
+        """
+        steps = self._reportInterval - simulation.currentStep%self._reportInterval
+        return (steps, False, False, False, False)
+
+    def report(self, simulation, state):
+        """Generate a report.
+
+        Parameters
+        ----------
+        simulation : Simulation
+            The Simulation to generate a report for
+        state : State
+            The current state of the simulation
+        """
+        if self._writer is None:
+            self._writer = mm.TrajectoryWriter(simulation.context, self._file, self._reportInterval, self._atomSubset, self._precision)
+        self._writer.writeFrame()
+
+    def flush(self):
+        """Block until all frames that have been recorded so far have been written to the file."""
+        if self._writer is not None:
+            self._writer.flush()
@@ -111,6 +111,19 @@ def findNodes(parent, path, **args):
             nodes.append(node)
     return nodes
 
+def hasStreamParam(memberNode):
+    # C++ streams cannot be created from Python, so methods that take them are
+    # not wrapped.  Classes that use streams also accept file names.
+    for pNode in findNodes(memberNode, 'param'):
+        try:
+            pType = getText('type', pNode)
+        except IndexError:
+            pType = getText('type/ref', pNode)
+        pType = pType.replace('const', '').replace('&', '').strip()
+        if pType in ('std::istream', 'std::ostream'):
+            return True
+    return False
+
 def getClassMethodList(classNode, skipMethods):
     className = getText("compoundname", classNode)
     shortClassName=stripOpenmmPrefix(className)
@@ -123,6 +136,7 @@ def getClassMethodList(classNode, skipMethods):
             if (shortClassName, methName) in skipMethods: continue
             numParams=len(findNodes(memberNode, 'param'))
             if (shortClassName, methName, numParams) in skipMethods: continue
+            if hasStreamParam(memberNode): continue
             for catchString in ['Factory', 'Impl', 'Info', 'Kernel']:
                 if shortClassName.endswith(catchString):
                     sys.stderr.write("Warning: Including class %s\n" %
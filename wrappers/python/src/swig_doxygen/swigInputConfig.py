@@ -78,6 +78,7 @@ SKIP_METHODS = [('State',),
                 ('RBTorsionInfo',),
                 ('RemoveCMMotionKernel',),
                 ('SplineFitter',),
+                ('CompressedCoordinates',),
                 ('StreamFactory',),
                 ('StretchBendInfo',),
                 ('TorsionInfo',),
@@ -87,10 +88,17 @@ SKIP_METHODS = [('State',),
                 ('UpdateTimeKernel',),
                 ('VdwInfo',),
                 ('WcaDispersionInfo',),
+                ('AsyncCheckpointWriter',  'createCheckpoint'),
                 ('Context',  'getState'),
                 ('Context',  'setState'),
                 ('Context',  'createCheckpoint'),
                 ('Context',  'loadCheckpoint'),
+                ('Context',  'getPositions'),
+                ('Context',  'setPositions', 3),
+                ('Context',  'getVelocities'),
+                ('Context',  'setVelocities', 3),
+                ('Context',  'getForces'),
+                ('Context',  'getMoleculeImages'),
                 ('CudaPlatform',),
                 ('Force',    'Force'),
                 ('ParticleParameterInfo',),
@@ -108,6 +116,10 @@ SKIP_METHODS = [('State',),
                 ('IntegrateDrudeSCFStepKernel',),
                 ('XmlSerializer',  'serialize'),
                 ('XmlSerializer',  'deserialize'),
+                ('SerializationNode',  'getDoubleArrayProperties'),
+                ('SerializationNode',  'getIntArrayProperties'),
+                ('SerializationProxy',  'serializeIncremental'),
+                ('SerializationProxy',  'deserializeIncremental'),
 ]
 
 # The build script assumes method args that are non-const references are
@@ -124,6 +136,10 @@ NO_OUTPUT_ARGS = [('LocalEnergyMinimizer', 'minimize', 'context'),
                   ('AmoebaMultipoleForce', 'setCovalentMap', 'covalentAtoms'),
                   ('AmoebaMultipoleForce', 'getElectrostaticPotential', 'context'),
                   ('AmoebaMultipoleForce', 'getInducedDipoles', 'context'),
+                  ('TrajectoryReader', 'getPeriodicBoxVectors', 'a'),
+                  ('TrajectoryReader', 'getPeriodicBoxVectors', 'b'),
+                  ('TrajectoryReader', 'getPeriodicBoxVectors', 'c'),
+                  ('TrajectoryReader', 'getPositions', 'positions'),
 ]
 
 # SWIG assumes the target language shadow class owns the C++ class
@@ -214,6 +230,8 @@ UNITS = {
 ("SerializationNode", "getStringProperty") : (None, ()),
 ("SerializationNode", "getIntProperty") : (None, ()),
 ("SerializationNode", "getDoubleProperty") : (None, ()),
+("SerializationNode", "getDoubleArrayProperty") : (None, ()),
+("SerializationNode", "getIntArrayProperty") : (None, ()),
 ("SerializationProxy", "getProxy") : (None, ()),
 ("SerializationProxy", "getTypeName") : (None, ()),
 
@@ -317,6 +335,10 @@ UNITS = {
 ("Context", "getParameter") : (None, ()),
 ("Context", "getParameters") : (None, ()),
 ("Context", "getMolecules") : (None, ()),
+("Context", "getTimingEnabled") : (None, ()),
+("Context", "getTimedOperations") : (None, ()),
+("Context", "getTimingStatistics") : (None, (None, 'unit.second', 'unit.second', 'unit.second')),
+("Context", "getTimingReport") : (None, ()),
 ("CMAPTorsionForce", "getMapParameters") : (None, (None, 'unit.kilojoule_per_mole')),
 ("CMAPTorsionForce", "getTorsionParameters") : (None, ()),
 ("CMMotionRemover", "getFrequency") : (None, ()),
@@ -424,6 +446,12 @@ UNITS = {
 ("System", "getConstraintParameters") : (None, (None, None, 'unit.nanometer')),
 ("System", "getForce") : (None, ()),
 ("System", "getVirtualSite") : (None, ()),
+("TrajectoryReader", "getPeriodicBoxVectors")
+ : (None, ('unit.nanometer', 'unit.nanometer', 'unit.nanometer')),
+("TrajectoryReader", "getPositions") : ("unit.nanometer", ()),
+("TrajectoryReader", "getPrecision") : (None, ()),
+("TrajectoryReader", "getTime") : ("unit.picosecond", ()),
+("TrajectoryWriter", "getPrecision") : (None, ()),
 ("DrudeLangevinIntegrator", "getDrudeTemperature") : ("unit.kelvin", ()),
 ("DrudeLangevinIntegrator", "getMaxDrudeDistance") : ("unit.nanometer", ()),
 ("MonteCarloMembraneBarostat", "getXYMode") : (None, ()),
@@ -228,6 +228,14 @@ class State(_object):
     self._integrator = args[1]
 %}
 
+%pythonappend OpenMM::AsyncCheckpointWriter::AsyncCheckpointWriter %{
+    self._context = args[0]
+%}
+
+%pythonappend OpenMM::TrajectoryWriter::TrajectoryWriter %{
+    self._context = args[0]
+%}
+
 %pythonprepend OpenMM::AmoebaAngleForce::addAngle %{
     try:
         length = args[3]
@@ -0,0 +1,48 @@
+import os
+import unittest
+import tempfile
+from simtk.openmm import app
+import simtk.openmm as mm
+from simtk import unit
+
+
+class TestTrajectoryReporter(unittest.TestCase):
+    def setUp(self):
+        with open('systems/alanine-dipeptide-implicit.pdb') as f:
+            pdb = app.PDBFile(f)
+        forcefield = app.ForceField('amber99sbildn.xml')
+        system = forcefield.createSystem(pdb.topology,
+            nonbondedMethod=app.CutoffNonPeriodic, nonbondedCutoff=1.0*unit.nanometers,
+            constraints=app.HBonds)
+        self.simulation = app.Simulation(pdb.topology, system, mm.VerletIntegrator(0.002*unit.picoseconds))
+        self.simulation.context.setPositions(pdb.positions)
+
+    def test_1(self):
+        file = tempfile.NamedTemporaryFile(delete=False)
+        file.close()
+        reporter = app.TrajectoryReporter(file.name, 2)
+        self.simulation.reporters.append(reporter)
+        positions = []
+        for i in range(3):
+            self.simulation.step(2)
+            positions.append(self.simulation.context.getState(getPositions=True).getPositions(asNumpy=True).value_in_unit(unit.nanometers))
+        reporter.flush()
+
+        # Read the frames back and compare them to the positions.
+
+        reader = mm.TrajectoryReader(file.name)
+        self.assertEqual(self.simulation.topology.getNumAtoms(), reader.getNumParticles())
+        for i in range(3):
+            self.assertTrue(reader.readFrame())
+            frame = reader.getPositions().value_in_unit(unit.nanometers)
+            for expected, found in zip(positions[i], frame):
+                for j in range(3):
+                    self.assertAlmostEqual(expected[j], found[j], delta=0.0005+1e-9)
+        self.assertFalse(reader.readFrame())
+        del reader
+        self.simulation.reporters.remove(reporter)
+        del reporter
+        os.unlink(file.name)
+
+if __name__ == '__main__':
+    unittest.main()